@@ -276,6 +276,7 @@ def envoy_dependencies(path = "@envoy_deps//", skip_targets = []):
     _com_google_protobuf()
     _com_github_envoyproxy_sqlparser()
     _com_googlesource_quiche()
+    _com_googlesource_code_re2()
 
     # Used for bundling gcovr into a relocatable .par file.
     _repository_impl("subpar")
@@ -500,6 +501,13 @@ def _com_github_nodejs_http_parser():
         actual = "@com_github_nodejs_http_parser//:http_parser",
     )
 
+def _com_googlesource_code_re2():
+    _repository_impl("com_googlesource_code_re2")
+    native.bind(
+        name = "re2",
+        actual = "@com_googlesource_code_re2//:re2",
+    )
+
 def _com_google_googletest():
     _repository_impl("com_google_googletest")
     native.bind(
@@ -111,6 +111,21 @@ public:
                              const Http::HeaderMap& response_headers,
                              const Http::HeaderMap& response_trailers,
                              const StreamInfo::StreamInfo& stream_info) const PURE;
+
+  /**
+   * Append a formatted access log line to an output string. Callers that reuse the output string
+   * avoid allocating for each line.
+   * @param request_headers supplies the request headers.
+   * @param response_headers supplies the response headers.
+   * @param response_trailers supplies the response trailers.
+   * @param stream_info supplies the stream info.
+   * @param output supplies the string the line is appended to.
+   */
+  virtual void formatInto(const Http::HeaderMap& request_headers,
+                          const Http::HeaderMap& response_headers,
+                          const Http::HeaderMap& response_trailers,
+                          const StreamInfo::StreamInfo& stream_info,
+                          std::string& output) const PURE;
 };
 
 using FormatterPtr = std::unique_ptr<Formatter>;
@@ -135,6 +150,20 @@ public:
                              const Http::HeaderMap& response_headers,
                              const Http::HeaderMap& response_trailers,
                              const StreamInfo::StreamInfo& stream_info) const PURE;
+
+  /**
+   * Append a value extracted from the provided headers/trailers/stream to an output string.
+   * @param request_headers supplies the request headers.
+   * @param response_headers supplies the response headers.
+   * @param response_trailers supplies the response trailers.
+   * @param stream_info supplies the stream info.
+   * @param output supplies the string the value is appended to.
+   */
+  virtual void formatInto(const Http::HeaderMap& request_headers,
+                          const Http::HeaderMap& response_headers,
+                          const Http::HeaderMap& response_trailers,
+                          const StreamInfo::StreamInfo& stream_info,
+                          std::string& output) const PURE;
 };
 
 using FormatterProviderPtr = std::unique_ptr<FormatterProvider>;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * Regular expression engines that patterns from the configuration can be compiled with.
+ */
+enum class Engine {
+  // ECMAScript std::regex. Supports the full ECMAScript grammar, but matching may backtrack and
+  // allocates on every match.
+  StdRegex,
+  // RE2. Matching runs in time linear in the length of the input, at the cost of not supporting
+  // backreferences and lookaround assertions.
+  Re2,
+};
+
+/**
+ * A regular expression compiled by one of the supported engines.
+ */
+class CompiledMatcher {
+public:
+  virtual ~CompiledMatcher() {}
+
+  /**
+   * @param value supplies the value to match.
+   * @return bool whether the regular expression matches the entire value.
+   */
+  virtual bool match(absl::string_view value) const PURE;
+};
+
+typedef std::unique_ptr<const CompiledMatcher> CompiledMatcherPtr;
+
+} // namespace Regex
+} // namespace Envoy
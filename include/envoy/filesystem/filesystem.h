@@ -34,6 +34,16 @@ public:
    */
   virtual Api::SysCallSizeResult write(absl::string_view buffer) PURE;
 
+  /**
+   * Write a set of buffers to the file with a single vectored write. The file must be explicitly
+   * opened before writing.
+   *
+   * @param iov the buffers to write, in order.
+   * @param num_iov the number of buffers in iov.
+   * @return ssize_t number of bytes written, or -1 for failure
+   */
+  virtual Api::SysCallSizeResult writev(const iovec* iov, int num_iov) PURE;
+
   /**
    * Close the file.
    *
@@ -368,6 +368,12 @@ public:
    * @return StreamEncoder& supplies the encoder to write the request into.
    */
   virtual StreamEncoder& newStream(StreamDecoder& response_decoder) PURE;
+
+  /**
+   * @return uint32_t the maximum number of concurrent streams the peer currently allows on this
+   *         connection. This is 1 for protocols that do not multiplex streams.
+   */
+  virtual uint32_t maxConcurrentStreams() PURE;
 };
 
 typedef std::unique_ptr<ClientConnection> ClientConnectionPtr;
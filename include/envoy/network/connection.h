@@ -186,6 +186,19 @@ public:
    */
   virtual const Ssl::Connection* ssl() const PURE;
 
+  /**
+   * @return true if the connection's transport socket passes bytes through unmodified (see
+   *         TransportSocket::passthrough()). Only then may data be moved through ioHandle().
+   */
+  virtual bool transportSocketIsPassthrough() const PURE;
+
+  /**
+   * @return the I/O handle of the connection's socket. Data moved through the socket directly
+   *         bypasses the connection's buffers, filters and transport socket, so this must only be
+   *         done while reads are disabled and nothing is buffered for writing.
+   */
+  virtual const IoHandle& ioHandle() const PURE;
+
   /**
    * @return requested server name (e.g. SNI in TLS), if any.
    */
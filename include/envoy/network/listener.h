@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
@@ -38,6 +40,22 @@ public:
   virtual Socket& socket() PURE;
   virtual const Socket& socket() const PURE;
 
+  /**
+   * @return std::vector<std::reference_wrapper<Socket>> all of the listen sockets, starting with
+   *         socket(). There is more than one when the listener binds a SO_REUSEPORT socket per
+   *         worker, or adopted such sockets from a hot restart parent.
+   */
+  virtual std::vector<std::reference_wrapper<Socket>> listenSockets() PURE;
+
+  /**
+   * @param worker_index supplies the index of the worker that accepts connections on the sockets.
+   * @return std::vector<std::reference_wrapper<Socket>> the listen sockets the worker should accept
+   *         connections on. This is just socket() unless the listener has more than one socket. A
+   *         worker shares a socket with other workers when there are fewer sockets than workers,
+   *         and accepts on more than one when there are more.
+   */
+  virtual std::vector<std::reference_wrapper<Socket>> workerSockets(uint32_t worker_index) PURE;
+
   /**
    * @return bool specifies whether the listener should actually listen on the port.
    *         A listener that doesn't listen on a port can only receive connections
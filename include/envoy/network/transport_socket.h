@@ -139,6 +139,12 @@ public:
    * @return the const SSL connection data if this is an SSL connection, or nullptr if it is not.
    */
   virtual const Ssl::Connection* ssl() const PURE;
+
+  /**
+   * @return true if the transport socket moves bytes between the socket and the connection's
+   *         buffers unmodified and without observing them, so that they can be relayed around it.
+   */
+  virtual bool passthrough() const PURE;
 };
 
 typedef std::unique_ptr<TransportSocket> TransportSocketPtr;
@@ -41,9 +41,15 @@ public:
    * Retrieve a listening socket on the specified address from the parent process. The socket will
    * be duplicated across process boundaries.
    * @param address supplies the address of the socket to duplicate, e.g. tcp://127.0.0.1:5000.
-   * @return int the fd or -1 if there is no bound listen port in the parent.
+   * @param socket_index supplies the index of the socket to duplicate when the parent listener has
+   *        more than one, e.g. a socket per worker.
+   * @param num_sockets will be set to the number of sockets the parent listener has, or 0 if there
+   *        is no bound listen port in the parent.
+   * @return int the fd or -1 if there is no bound listen port in the parent, or socket_index is
+   *         not below num_sockets.
    */
-  virtual int duplicateParentListenSocket(const std::string& address) PURE;
+  virtual int duplicateParentListenSocket(const std::string& address, uint32_t socket_index,
+                                          uint32_t& num_sockets) PURE;
 
   /**
    * Retrieve stats from our parent process.
@@ -47,12 +47,18 @@ public:
    * @param socket_type the type of socket (stream or datagram) to create.
    * @param options to be set on the created socket just before calling 'bind()'.
    * @param bind_to_port supplies whether to actually bind the socket.
+   * @param socket_index supplies the index of the socket when the listener has more than one, e.g.
+   *        a socket per worker, and 0 otherwise. The socket with the same index is duplicated
+   *        from a hot restart parent when it has one.
+   * @param num_parent_sockets will be set to the number of sockets a hot restart parent has bound
+   *        to the address, or 0 if there is none.
    * @return Network::SocketSharedPtr an initialized and potentially bound socket.
    */
   virtual Network::SocketSharedPtr
   createListenSocket(Network::Address::InstanceConstSharedPtr address,
                      Network::Address::SocketType socket_type,
-                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) PURE;
+                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port,
+                     uint32_t socket_index, uint32_t& num_parent_sockets) PURE;
 
   /**
    * Creates a list of filter factories.
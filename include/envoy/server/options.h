@@ -6,6 +6,7 @@
 
 #include "envoy/admin/v2alpha/server_info.pb.h"
 #include "envoy/common/pure.h"
+#include "envoy/common/regex.h"
 #include "envoy/network/address.h"
 #include "envoy/stats/stats_options.h"
 
@@ -133,6 +134,18 @@ public:
    */
   virtual std::chrono::milliseconds fileFlushIntervalMsec() const PURE;
 
+  /**
+   * @return uint32_t the number of KiB buffered for a log file that triggers a flush before the
+   *         flush interval elapses.
+   */
+  virtual uint32_t fileFlushSizeKb() const PURE;
+
+  /**
+   * @return uint32_t the number of KiB that may be buffered for a log file before further writes
+   *         are dropped. 0 means no limit.
+   */
+  virtual uint32_t fileBufferLimitKb() const PURE;
+
   /**
    * @return const std::string& the server's cluster.
    */
@@ -174,6 +187,22 @@ public:
    */
   virtual bool mutexTracingEnabled() const PURE;
 
+  /**
+   * @return bool indicating whether buffers use the libevent evbuffer implementation rather than
+   *         the native slice-based implementation.
+   */
+  virtual bool libeventBufferEnabled() const PURE;
+
+  /**
+   * @return Regex::Engine the engine used to compile regular expressions in the configuration.
+   */
+  virtual Regex::Engine regexEngine() const PURE;
+
+  /**
+   * @return uint32_t the largest RE2 program accepted when compiling regular expressions.
+   */
+  virtual uint32_t regexMaxProgramSize() const PURE;
+
   /**
    * Converts the Options in to CommandLineOptions proto message defined in server_info.proto.
    * @return CommandLineOptionsPtr the protobuf representation of the options.
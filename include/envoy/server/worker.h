@@ -83,9 +83,12 @@ public:
   virtual ~WorkerFactory() {}
 
   /**
+   * @param index supplies the index of the worker, which selects its listen sockets and names its
+   *        per worker listener stats.
+   * @param overload_manager supplies the server's overload manager.
    * @return WorkerPtr a new worker.
    */
-  virtual WorkerPtr createWorker(OverloadManager& overload_manager) PURE;
+  virtual WorkerPtr createWorker(uint32_t index, OverloadManager& overload_manager) PURE;
 };
 
 } // namespace Server
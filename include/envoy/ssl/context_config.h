@@ -119,6 +119,12 @@ public:
    * are candidates for decrypting received tickets.
    */
   virtual const std::vector<SessionTicketKey>& sessionTicketKeys() const PURE;
+
+  /**
+   * @return True if encryption of sent data should be offloaded to kernel TLS after the
+   * handshake, where the kernel and the negotiated cipher support it.
+   */
+  virtual bool kernelTlsOffload() const PURE;
 };
 
 typedef std::unique_ptr<ServerContextConfig> ServerContextConfigPtr;
@@ -7,9 +7,28 @@
 #include "envoy/common/pure.h"
 #include "envoy/stats/stats.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Stats {
 
+/**
+ * Supplies the bucket layout of each histogram.
+ */
+class HistogramSettings {
+public:
+  virtual ~HistogramSettings() {}
+
+  /**
+   * @param stat_name the full name of the histogram.
+   * @return the upper bounds of the buckets for the histogram, in increasing order. The returned
+   *         reference is valid for the lifetime of this object.
+   */
+  virtual const std::vector<double>& buckets(absl::string_view stat_name) const PURE;
+};
+
+typedef std::unique_ptr<const HistogramSettings> HistogramSettingsConstPtr;
+
 /**
  * Holds the computed statistics for a histogram.
  */
@@ -10,6 +10,7 @@
 
 #include "envoy/common/pure.h"
 #include "envoy/stats/stats.h"
+#include "envoy/stats/symbol_table.h"
 #include "envoy/stats/tag.h"
 
 #include "absl/strings/string_view.h"
@@ -31,27 +32,32 @@ public:
    * @param name the full name of the stat.
    * @param tag_extracted_name the name of the stat with tag-values stripped out.
    * @param tags the extracted tag values.
-   * @return CounterSharedPtr a counter, or nullptr if allocation failed, in which case
-   *     tag_extracted_name and tags are not moved.
+   * @return CounterSharedPtr a counter, or nullptr if allocation failed.
    */
-  virtual CounterSharedPtr makeCounter(absl::string_view name, std::string&& tag_extracted_name,
-                                       std::vector<Tag>&& tags) PURE;
+  virtual CounterSharedPtr makeCounter(StatName name, absl::string_view tag_extracted_name,
+                                       const std::vector<Tag>& tags) PURE;
 
   /**
    * @param name the full name of the stat.
    * @param tag_extracted_name the name of the stat with tag-values stripped out.
    * @param tags the extracted tag values.
-   * @return GaugeSharedPtr a gauge, or nullptr if allocation failed, in which case
-   *     tag_extracted_name and tags are not moved.
+   * @return GaugeSharedPtr a gauge, or nullptr if allocation failed.
    */
-  virtual GaugeSharedPtr makeGauge(absl::string_view name, std::string&& tag_extracted_name,
-                                   std::vector<Tag>&& tags) PURE;
+  virtual GaugeSharedPtr makeGauge(StatName name, absl::string_view tag_extracted_name,
+                                   const std::vector<Tag>& tags) PURE;
 
   /**
    * Determines whether this stats allocator requires bounded stat-name size.
    */
   virtual bool requiresBoundedStatNameSize() const PURE;
 
+  /**
+   * @return SymbolTable& the symbol table in which the names of allocated stats are encoded.
+   *     Names passed to makeCounter() and makeGauge() must be encoded in this table.
+   */
+  virtual SymbolTable& symbolTable() PURE;
+  virtual const SymbolTable& symbolTable() const PURE;
+
   // TODO(jmarantz): create a parallel mechanism to instantiate histograms. At
   // the moment, histograms don't fit the same pattern of counters and gauges
   // as they are not actually created in the context of a stats allocator.
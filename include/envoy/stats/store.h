@@ -5,10 +5,13 @@
 #include <vector>
 
 #include "envoy/common/pure.h"
+#include "envoy/stats/histogram.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_matcher.h"
 #include "envoy/stats/tag_producer.h"
 
+#include "absl/strings/string_view.h"
+
 namespace Envoy {
 namespace Event {
 
@@ -43,6 +46,26 @@ public:
    * @return a list of all known histograms.
    */
   virtual std::vector<ParentHistogramSharedPtr> histograms() const PURE;
+
+  /**
+   * @param prefix supplies the prefix that the names of the returned counters start with.
+   * @return a list of the known counters matching prefix. Implementations may skip whole scopes
+   *         whose names cannot match, so this is cheaper than filtering counters().
+   */
+  virtual std::vector<CounterSharedPtr> countersWithPrefix(absl::string_view prefix) const PURE;
+
+  /**
+   * @param prefix supplies the prefix that the names of the returned gauges start with.
+   * @return a list of the known gauges matching prefix.
+   */
+  virtual std::vector<GaugeSharedPtr> gaugesWithPrefix(absl::string_view prefix) const PURE;
+
+  /**
+   * @param prefix supplies the prefix that the names of the returned histograms start with.
+   * @return a list of the known histograms matching prefix.
+   */
+  virtual std::vector<ParentHistogramSharedPtr>
+  histogramsWithPrefix(absl::string_view prefix) const PURE;
 };
 
 typedef std::unique_ptr<Store> StorePtr;
@@ -74,6 +97,13 @@ public:
    */
   virtual void setStatsMatcher(StatsMatcherPtr&& stats_matcher) PURE;
 
+  /**
+   * Set the bucket layouts of histograms. Histograms keep the buckets they were created with, so
+   * this must be called before any histograms are created, and only once.
+   * @param histogram_settings supplies the buckets of each histogram.
+   */
+  virtual void setHistogramSettings(HistogramSettingsConstPtr&& histogram_settings) PURE;
+
   /**
    * Initialize the store for threading. This will be called once after all worker threads have
    * been initialized. At this point the store can initialize itself for multi-threaded operation.
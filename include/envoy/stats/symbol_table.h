@@ -29,6 +29,10 @@ class StatName;
  */
 class SymbolEncoding;
 
+// Holds its StatName inline in a variable-length allocation, so manages the
+// reference counts for it directly rather than through StatNameStorage.
+struct HeapStatData;
+
 /**
  * SymbolTable manages a namespace optimized for stat names, exploiting their
  * typical composition from "."-separated tokens, with a significant overlap
@@ -137,6 +141,7 @@ public:
 private:
   friend class StatNameStorage;
   friend class StatNameList;
+  friend struct HeapStatData;
 
   /**
    * Since SymbolTable does manual reference counting, a client of SymbolTable
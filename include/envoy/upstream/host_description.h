@@ -4,11 +4,14 @@
 #include <string>
 
 #include "envoy/api/v2/core/base.pb.h"
+#include "envoy/common/time.h"
 #include "envoy/network/address.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/upstream/health_check_host_monitor.h"
 #include "envoy/upstream/outlier_detection.h"
 
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -123,6 +126,23 @@ public:
    * Set the current priority.
    */
   virtual void priority(uint32_t) PURE;
+
+  /**
+   * Record the response time of a request to the host. This is only tracked for clusters using
+   * the PEAK_EWMA load balancing policy (see envoy.api.v2.Cluster.PeakEwmaLbConfig).
+   * @param response_time supplies the response time of the request.
+   * @param now supplies the time the response completed.
+   */
+  virtual void putResponseTime(std::chrono::microseconds response_time,
+                               MonotonicTime now) const PURE;
+
+  /**
+   * @param now supplies the current time.
+   * @return the peak exponentially weighted moving average of the host's response times in
+   *         (fractional) milliseconds, decayed to now, or absl::nullopt if no response time has
+   *         been recorded.
+   */
+  virtual absl::optional<double> responseTimeEwma(MonotonicTime now) const PURE;
 };
 
 typedef std::shared_ptr<const HostDescription> HostDescriptionConstSharedPtr;
@@ -83,6 +83,14 @@ public:
    *         or the cluster did not have enough hosts to run through success rate outlier ejection.
    */
   virtual double successRate() const PURE;
+
+  /**
+   * @return the p99 response time of the host in the last calculated interval, in milliseconds.
+   *         -1 means that latency outlier detection is not enabled, the host did not have enough
+   *         request volume, or the cluster did not have enough hosts to run through latency
+   *         outlier ejection.
+   */
+  virtual double latencyP99() const PURE;
 };
 
 typedef std::unique_ptr<DetectorHostMonitor> DetectorHostMonitorPtr;
@@ -121,6 +129,22 @@ public:
    *         proceed with success rate based outlier ejection.
    */
   virtual double successRateEjectionThreshold() const PURE;
+
+  /**
+   * Returns the median of the p99 response times of the hosts in the Detector for the last
+   * aggregation interval.
+   * @return the median p99 response time in milliseconds, or -1 if there were not enough hosts
+   *         with enough request volume to proceed with latency based outlier ejection.
+   */
+  virtual double latencyP99Median() const PURE;
+
+  /**
+   * Returns the p99 response time threshold used in the last interval. Hosts with a higher p99
+   * response time are ejected.
+   * @return the threshold in milliseconds, or -1 if there were not enough hosts with enough
+   *         request volume to proceed with latency based outlier ejection.
+   */
+  virtual double latencyEjectionThreshold() const PURE;
 };
 
 typedef std::shared_ptr<Detector> DetectorSharedPtr;
@@ -457,8 +457,11 @@ public:
   COUNTER  (upstream_cx_idle_timeout)                                                              \
   COUNTER  (upstream_cx_connect_attempts_exceeded)                                                 \
   COUNTER  (upstream_cx_overflow)                                                                  \
+  COUNTER  (upstream_cx_max_concurrent_streams)                                                    \
+  COUNTER  (upstream_cx_prefetch)                                                                  \
   HISTOGRAM(upstream_cx_connect_ms)                                                                \
   HISTOGRAM(upstream_cx_length_ms)                                                                 \
+  HISTOGRAM(upstream_cx_http2_peak_concurrent_streams)                                             \
   COUNTER  (upstream_cx_destroy)                                                                   \
   COUNTER  (upstream_cx_destroy_local)                                                             \
   COUNTER  (upstream_cx_destroy_remote)                                                            \
@@ -477,6 +480,7 @@ public:
   GAUGE    (upstream_rq_active)                                                                    \
   COUNTER  (upstream_rq_completed)                                                                 \
   COUNTER  (upstream_rq_pending_total)                                                             \
+  COUNTER  (upstream_rq_prefetch_hit)                                                              \
   COUNTER  (upstream_rq_pending_overflow)                                                          \
   COUNTER  (upstream_rq_pending_failure_eject)                                                     \
   GAUGE    (upstream_rq_pending_active)                                                            \
@@ -581,6 +585,8 @@ public:
     static const uint64_t USE_DOWNSTREAM_PROTOCOL = 0x2;
     // Whether connections should be immediately closed upon health failure.
     static const uint64_t CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE = 0x4;
+    // Whether HTTP/2 connections are owned by one worker and shared with all other workers.
+    static const uint64_t SHARE_HTTP2_CONNECTIONS_ACROSS_WORKERS = 0x8;
   };
 
   virtual ~ClusterInfo() {}
@@ -657,6 +663,12 @@ public:
   virtual const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>&
   lbRingHashConfig() const PURE;
 
+  /**
+   * @return configuration for peak EWMA load balancing, only set if LB type is peak EWMA.
+   */
+  virtual const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>&
+  lbPeakEwmaConfig() const PURE;
+
   /**
    * @return const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>& the configuration
    *         for the Original Destination load balancing policy, only used if type is set to
@@ -680,6 +692,17 @@ public:
    */
   virtual uint64_t maxRequestsPerConnection() const PURE;
 
+  /**
+   * @return double the number of connections a connection pool keeps open for every connection in
+   *         use. 1 disables ratio based prefetching.
+   */
+  virtual double perUpstreamPrefetchRatio() const PURE;
+
+  /**
+   * @return uint32_t the minimum number of connections a connection pool keeps open to its host.
+   */
+  virtual uint32_t minWarmConnections() const PURE;
+
   /**
    * @return the human readable name of the cluster.
    */
@@ -1,6 +1,8 @@
 #include "common/access_log/access_log_formatter.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -53,6 +55,67 @@ AccessLogFormatUtils::protocolToString(const absl::optional<Http::Protocol>& pro
   return UnspecifiedValueString;
 }
 
+namespace {
+
+bool needsJsonEscape(char c) {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+/**
+ * Append str to output as the contents of a JSON string, escaping as needed.
+ */
+void appendJsonEscaped(absl::string_view str, std::string& output) {
+  for (const char c : str) {
+    switch (c) {
+    case '"':
+      output.append("\\\"");
+      break;
+    case '\\':
+      output.append("\\\\");
+      break;
+    case '\b':
+      output.append("\\b");
+      break;
+    case '\f':
+      output.append("\\f");
+      break;
+    case '\n':
+      output.append("\\n");
+      break;
+    case '\r':
+      output.append("\\r");
+      break;
+    case '\t':
+      output.append("\\t");
+      break;
+    default:
+      if (needsJsonEscape(c)) {
+        output.append(fmt::format("\\u{:04x}", static_cast<unsigned char>(c)));
+      } else {
+        output.push_back(c);
+      }
+      break;
+    }
+  }
+}
+
+void appendDuration(const absl::optional<std::chrono::nanoseconds>& time, std::string& output) {
+  if (time) {
+    const fmt::format_int duration(
+        std::chrono::duration_cast<std::chrono::milliseconds>(time.value()).count());
+    output.append(duration.data(), duration.size());
+  } else {
+    output.append(UnspecifiedValueString);
+  }
+}
+
+template <class Integer> void appendInt(Integer value, std::string& output) {
+  const fmt::format_int formatted(value);
+  output.append(formatted.data(), formatted.size());
+}
+
+} // namespace
+
 FormatterImpl::FormatterImpl(const std::string& format) {
   providers_ = AccessLogFormatParser::parse(format);
 }
@@ -63,18 +126,31 @@ std::string FormatterImpl::format(const Http::HeaderMap& request_headers,
                                   const StreamInfo::StreamInfo& stream_info) const {
   std::string log_line;
   log_line.reserve(256);
+  formatInto(request_headers, response_headers, response_trailers, stream_info, log_line);
+  return log_line;
+}
 
+void FormatterImpl::formatInto(const Http::HeaderMap& request_headers,
+                               const Http::HeaderMap& response_headers,
+                               const Http::HeaderMap& response_trailers,
+                               const StreamInfo::StreamInfo& stream_info,
+                               std::string& output) const {
   for (const FormatterProviderPtr& provider : providers_) {
-    log_line += provider->format(request_headers, response_headers, response_trailers, stream_info);
+    provider->formatInto(request_headers, response_headers, response_trailers, stream_info,
+                         output);
   }
-
-  return log_line;
 }
 
 JsonFormatterImpl::JsonFormatterImpl(std::unordered_map<std::string, std::string>& format_mapping) {
-  for (const auto& pair : format_mapping) {
-    auto providers = AccessLogFormatParser::parse(pair.second);
-    json_output_format_.emplace(pair.first, FormatterPtr{new FormatterImpl(pair.second)});
+  // Sort the keys so the output is stable.
+  const std::map<std::string, std::string> sorted_mapping(format_mapping.begin(),
+                                                          format_mapping.end());
+  fields_.reserve(sorted_mapping.size());
+  for (const auto& pair : sorted_mapping) {
+    std::string prefix = fields_.empty() ? "{\"" : "\",\"";
+    appendJsonEscaped(pair.first, prefix);
+    prefix.append("\":\"");
+    fields_.emplace_back(std::move(prefix), FormatterImpl(pair.second));
   }
 }
 
@@ -82,34 +158,37 @@ std::string JsonFormatterImpl::format(const Http::HeaderMap& request_headers,
                                       const Http::HeaderMap& response_headers,
                                       const Http::HeaderMap& response_trailers,
                                       const StreamInfo::StreamInfo& stream_info) const {
-  const auto output_map = toMap(request_headers, response_headers, response_trailers, stream_info);
-
-  ProtobufWkt::Struct output_struct;
-  for (const auto& pair : output_map) {
-    ProtobufWkt::Value string_value;
-    string_value.set_string_value(pair.second);
-    (*output_struct.mutable_fields())[pair.first] = string_value;
-  }
+  std::string log_line;
+  log_line.reserve(256);
+  formatInto(request_headers, response_headers, response_trailers, stream_info, log_line);
+  return log_line;
+}
 
-  ProtobufTypes::String log_line;
-  const auto conversion_status = Protobuf::util::MessageToJsonString(output_struct, &log_line);
-  if (!conversion_status.ok()) {
-    log_line =
-        fmt::format("Error serializing access log to JSON: {}", conversion_status.ToString());
+void JsonFormatterImpl::formatInto(const Http::HeaderMap& request_headers,
+                                   const Http::HeaderMap& response_headers,
+                                   const Http::HeaderMap& response_trailers,
+                                   const StreamInfo::StreamInfo& stream_info,
+                                   std::string& output) const {
+  if (fields_.empty()) {
+    output.append("{}\n");
+    return;
   }
 
-  return absl::StrCat(log_line, "\n");
-}
-
-std::unordered_map<std::string, std::string> JsonFormatterImpl::toMap(
-    const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
-    const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo& stream_info) const {
-  std::unordered_map<std::string, std::string> output;
-  for (const auto& pair : json_output_format_) {
-    output.emplace(pair.first, pair.second->format(request_headers, response_headers,
-                                                   response_trailers, stream_info));
+  for (const auto& field : fields_) {
+    output.append(field.first);
+    const size_t value_start = output.size();
+    field.second.formatInto(request_headers, response_headers, response_trailers, stream_info,
+                            output);
+
+    // Values rarely need escaping, so only copy the value out when they do.
+    const absl::string_view value = absl::string_view(output).substr(value_start);
+    if (std::any_of(value.begin(), value.end(), needsJsonEscape)) {
+      const std::string raw_value(value);
+      output.resize(value_start);
+      appendJsonEscaped(raw_value, output);
+    }
   }
-  return output;
+  output.append("\"}\n");
 }
 
 void AccessLogFormatParser::parseCommandHeader(const std::string& token, const size_t start,
@@ -257,97 +336,95 @@ std::vector<FormatterProviderPtr> AccessLogFormatParser::parse(const std::string
 StreamInfoFormatter::StreamInfoFormatter(const std::string& field_name) {
 
   if (field_name == "REQUEST_DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::durationToString(stream_info.lastDownstreamRxByteReceived());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendDuration(stream_info.lastDownstreamRxByteReceived(), output);
     };
   } else if (field_name == "RESPONSE_DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::durationToString(stream_info.firstUpstreamRxByteReceived());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendDuration(stream_info.firstUpstreamRxByteReceived(), output);
     };
   } else if (field_name == "RESPONSE_TX_DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
       auto downstream = stream_info.lastDownstreamTxByteSent();
       auto upstream = stream_info.firstUpstreamRxByteReceived();
 
       if (downstream && upstream) {
-        auto val = downstream.value() - upstream.value();
-        return AccessLogFormatUtils::durationToString(val);
+        appendDuration(downstream.value() - upstream.value(), output);
+      } else {
+        output.append(UnspecifiedValueString);
       }
-
-      return UnspecifiedValueString;
     };
   } else if (field_name == "BYTES_RECEIVED") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return fmt::format_int(stream_info.bytesReceived()).str();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendInt(stream_info.bytesReceived(), output);
     };
   } else if (field_name == "PROTOCOL") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::protocolToString(stream_info.protocol());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output.append(AccessLogFormatUtils::protocolToString(stream_info.protocol()));
     };
   } else if (field_name == "RESPONSE_CODE") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.responseCode() ? fmt::format_int(stream_info.responseCode().value()).str()
-                                        : "0";
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendInt(stream_info.responseCode() ? stream_info.responseCode().value() : 0, output);
     };
   } else if (field_name == "BYTES_SENT") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return fmt::format_int(stream_info.bytesSent()).str();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendInt(stream_info.bytesSent(), output);
     };
   } else if (field_name == "DURATION") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return AccessLogFormatUtils::durationToString(stream_info.requestComplete());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      appendDuration(stream_info.requestComplete(), output);
     };
   } else if (field_name == "RESPONSE_FLAGS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return StreamInfo::ResponseFlagUtils::toShortString(stream_info);
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output.append(StreamInfo::ResponseFlagUtils::toShortString(stream_info));
     };
   } else if (field_name == "UPSTREAM_HOST") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
       if (stream_info.upstreamHost()) {
-        return stream_info.upstreamHost()->address()->asString();
+        output.append(stream_info.upstreamHost()->address()->asString());
       } else {
-        return UnspecifiedValueString;
+        output.append(UnspecifiedValueString);
       }
     };
   } else if (field_name == "UPSTREAM_CLUSTER") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      std::string upstream_cluster_name;
-      if (nullptr != stream_info.upstreamHost()) {
-        upstream_cluster_name = stream_info.upstreamHost()->cluster().name();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      if (nullptr != stream_info.upstreamHost() &&
+          !stream_info.upstreamHost()->cluster().name().empty()) {
+        output.append(stream_info.upstreamHost()->cluster().name());
+      } else {
+        output.append(UnspecifiedValueString);
       }
-
-      return upstream_cluster_name.empty() ? UnspecifiedValueString : upstream_cluster_name;
     };
   } else if (field_name == "UPSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.upstreamLocalAddress() != nullptr
-                 ? stream_info.upstreamLocalAddress()->asString()
-                 : UnspecifiedValueString;
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output.append(stream_info.upstreamLocalAddress() != nullptr
+                        ? stream_info.upstreamLocalAddress()->asString()
+                        : UnspecifiedValueString);
     };
   } else if (field_name == "DOWNSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.downstreamLocalAddress()->asString();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output.append(stream_info.downstreamLocalAddress()->asString());
     };
   } else if (field_name == "DOWNSTREAM_LOCAL_ADDRESS_WITHOUT_PORT") {
-    field_extractor_ = [](const Envoy::StreamInfo::StreamInfo& stream_info) {
-      return StreamInfo::Utility::formatDownstreamAddressNoPort(
-          *stream_info.downstreamLocalAddress());
+    field_extractor_ = [](const Envoy::StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output.append(StreamInfo::Utility::formatDownstreamAddressNoPort(
+          *stream_info.downstreamLocalAddress()));
     };
   } else if (field_name == "DOWNSTREAM_REMOTE_ADDRESS") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return stream_info.downstreamRemoteAddress()->asString();
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output.append(stream_info.downstreamRemoteAddress()->asString());
     };
   } else if (field_name == "DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
-      return StreamInfo::Utility::formatDownstreamAddressNoPort(
-          *stream_info.downstreamRemoteAddress());
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
+      output.append(StreamInfo::Utility::formatDownstreamAddressNoPort(
+          *stream_info.downstreamRemoteAddress()));
     };
   } else if (field_name == "REQUESTED_SERVER_NAME") {
-    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info) {
+    field_extractor_ = [](const StreamInfo::StreamInfo& stream_info, std::string& output) {
       if (!stream_info.requestedServerName().empty()) {
-        return stream_info.requestedServerName();
+        output.append(stream_info.requestedServerName());
       } else {
-        return UnspecifiedValueString;
+        output.append(UnspecifiedValueString);
       }
     };
   } else {
@@ -355,18 +432,28 @@ StreamInfoFormatter::StreamInfoFormatter(const std::string& field_name) {
   }
 }
 
-std::string StreamInfoFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                        const Http::HeaderMap&,
-                                        const StreamInfo::StreamInfo& stream_info) const {
-  return field_extractor_(stream_info);
+void StreamInfoFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                     const Http::HeaderMap&,
+                                     const StreamInfo::StreamInfo& stream_info,
+                                     std::string& output) const {
+  field_extractor_(stream_info, output);
+}
+
+std::string FormatterProviderBase::format(const Http::HeaderMap& request_headers,
+                                          const Http::HeaderMap& response_headers,
+                                          const Http::HeaderMap& response_trailers,
+                                          const StreamInfo::StreamInfo& stream_info) const {
+  std::string value;
+  formatInto(request_headers, response_headers, response_trailers, stream_info, value);
+  return value;
 }
 
 PlainStringFormatter::PlainStringFormatter(const std::string& str) : str_(str) {}
 
-std::string PlainStringFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                         const Http::HeaderMap&,
-                                         const StreamInfo::StreamInfo&) const {
-  return str_;
+void PlainStringFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                      const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                                      std::string& output) const {
+  output.append(str_);
 }
 
 HeaderFormatter::HeaderFormatter(const std::string& main_header,
@@ -375,24 +462,25 @@ HeaderFormatter::HeaderFormatter(const std::string& main_header,
     : main_header_(main_header), alternative_header_(alternative_header), max_length_(max_length) {}
 
 std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
+  std::string header_value_string;
+  formatInto(headers, header_value_string);
+  return header_value_string;
+}
+
+void HeaderFormatter::formatInto(const Http::HeaderMap& headers, std::string& output) const {
   const Http::HeaderEntry* header = headers.get(main_header_);
 
   if (!header && !alternative_header_.get().empty()) {
     header = headers.get(alternative_header_);
   }
 
-  std::string header_value_string;
-  if (!header) {
-    header_value_string = UnspecifiedValueString;
-  } else {
-    header_value_string = header->value().c_str();
+  absl::string_view header_value =
+      header ? header->value().getStringView() : absl::string_view(UnspecifiedValueString);
+  if (max_length_ && header_value.length() > max_length_.value()) {
+    header_value = header_value.substr(0, max_length_.value());
   }
 
-  if (max_length_ && header_value_string.length() > max_length_.value()) {
-    return header_value_string.substr(0, max_length_.value());
-  }
-
-  return header_value_string;
+  output.append(header_value.data(), header_value.size());
 }
 
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
@@ -400,11 +488,11 @@ ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
                                                  absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string ResponseHeaderFormatter::format(const Http::HeaderMap&,
-                                            const Http::HeaderMap& response_headers,
-                                            const Http::HeaderMap&,
-                                            const StreamInfo::StreamInfo&) const {
-  return HeaderFormatter::format(response_headers);
+void ResponseHeaderFormatter::formatInto(const Http::HeaderMap&,
+                                         const Http::HeaderMap& response_headers,
+                                         const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                                         std::string& output) const {
+  HeaderFormatter::formatInto(response_headers, output);
 }
 
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
@@ -412,10 +500,10 @@ RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string RequestHeaderFormatter::format(const Http::HeaderMap& request_headers,
-                                           const Http::HeaderMap&, const Http::HeaderMap&,
-                                           const StreamInfo::StreamInfo&) const {
-  return HeaderFormatter::format(request_headers);
+void RequestHeaderFormatter::formatInto(const Http::HeaderMap& request_headers,
+                                        const Http::HeaderMap&, const Http::HeaderMap&,
+                                        const StreamInfo::StreamInfo&, std::string& output) const {
+  HeaderFormatter::formatInto(request_headers, output);
 }
 
 ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_header,
@@ -423,10 +511,11 @@ ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_heade
                                                    absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string ResponseTrailerFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                             const Http::HeaderMap& response_trailers,
-                                             const StreamInfo::StreamInfo&) const {
-  return HeaderFormatter::format(response_trailers);
+void ResponseTrailerFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                          const Http::HeaderMap& response_trailers,
+                                          const StreamInfo::StreamInfo&,
+                                          std::string& output) const {
+  HeaderFormatter::formatInto(response_trailers, output);
 }
 
 MetadataFormatter::MetadataFormatter(const std::string& filter_namespace,
@@ -465,21 +554,23 @@ DynamicMetadataFormatter::DynamicMetadataFormatter(const std::string& filter_nam
                                                    absl::optional<size_t> max_length)
     : MetadataFormatter(filter_namespace, path, max_length) {}
 
-std::string DynamicMetadataFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                             const Http::HeaderMap&,
-                                             const StreamInfo::StreamInfo& stream_info) const {
-  return MetadataFormatter::format(stream_info.dynamicMetadata());
+void DynamicMetadataFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                          const Http::HeaderMap&,
+                                          const StreamInfo::StreamInfo& stream_info,
+                                          std::string& output) const {
+  output.append(MetadataFormatter::format(stream_info.dynamicMetadata()));
 }
 
 StartTimeFormatter::StartTimeFormatter(const std::string& format) : date_formatter_(format) {}
 
-std::string StartTimeFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                       const Http::HeaderMap&,
-                                       const StreamInfo::StreamInfo& stream_info) const {
+void StartTimeFormatter::formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                                    const Http::HeaderMap&,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    std::string& output) const {
   if (date_formatter_.formatString().empty()) {
-    return AccessLogDateTimeFormatter::fromTime(stream_info.startTime());
+    output.append(AccessLogDateTimeFormatter::fromTime(stream_info.startTime()));
   } else {
-    return date_formatter_.fromTime(stream_info.startTime());
+    output.append(date_formatter_.fromTime(stream_info.startTime()));
   }
 }
 
@@ -94,11 +94,19 @@ public:
                      const Http::HeaderMap& response_headers,
                      const Http::HeaderMap& response_trailers,
                      const StreamInfo::StreamInfo& stream_info) const override;
+  void formatInto(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                  const Http::HeaderMap& response_trailers,
+                  const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 
 private:
   std::vector<FormatterProviderPtr> providers_;
 };
 
+/**
+ * Formatter producing a JSON object with one string value per configured key. The object is
+ * written straight into the output: the key text around each value is prepared once at
+ * construction, and each value is formatted in place and then escaped.
+ */
 class JsonFormatterImpl : public Formatter {
 public:
   JsonFormatterImpl(std::unordered_map<std::string, std::string>& format_mapping);
@@ -108,27 +116,39 @@ public:
                      const Http::HeaderMap& response_headers,
                      const Http::HeaderMap& response_trailers,
                      const StreamInfo::StreamInfo& stream_info) const override;
+  void formatInto(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
+                  const Http::HeaderMap& response_trailers,
+                  const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 
 private:
-  std::vector<FormatterProviderPtr> providers_;
-  std::map<const std::string, Envoy::AccessLog::FormatterPtr> json_output_format_;
+  // Each field is the JSON text that precedes its value (e.g. `{"key":"` or `","key":"`) and the
+  // formatter for the value. Fields are in key order.
+  std::vector<std::pair<std::string, FormatterImpl>> fields_;
+};
 
-  std::unordered_map<std::string, std::string>
-  toMap(const Http::HeaderMap& request_headers, const Http::HeaderMap& response_headers,
-        const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo& stream_info) const;
+/**
+ * Base class for the providers below. They implement formatInto(), and format() is built on it.
+ */
+class FormatterProviderBase : public FormatterProvider {
+public:
+  // FormatterProvider
+  std::string format(const Http::HeaderMap& request_headers,
+                     const Http::HeaderMap& response_headers,
+                     const Http::HeaderMap& response_trailers,
+                     const StreamInfo::StreamInfo& stream_info) const override;
 };
 
 /**
  * Formatter for string literal. It ignores headers and stream info and returns string by which it
  * was initialized.
  */
-class PlainStringFormatter : public FormatterProvider {
+class PlainStringFormatter : public FormatterProviderBase {
 public:
   PlainStringFormatter(const std::string& str);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const StreamInfo::StreamInfo&, std::string& output) const override;
 
 private:
   std::string str_;
@@ -140,6 +160,7 @@ public:
                   absl::optional<size_t> max_length);
 
   std::string format(const Http::HeaderMap& headers) const;
+  void formatInto(const Http::HeaderMap& headers, std::string& output) const;
 
 private:
   Http::LowerCaseString main_header_;
@@ -150,56 +171,61 @@ private:
 /**
  * Formatter based on request header.
  */
-class RequestHeaderFormatter : public FormatterProvider, HeaderFormatter {
+class RequestHeaderFormatter : public FormatterProviderBase, HeaderFormatter {
 public:
   RequestHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                          absl::optional<size_t> max_length);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
-                     const Http::HeaderMap&, const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  using FormatterProviderBase::format;
+  void formatInto(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
+                  const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                  std::string& output) const override;
 };
 
 /**
  * Formatter based on the response header.
  */
-class ResponseHeaderFormatter : public FormatterProvider, HeaderFormatter {
+class ResponseHeaderFormatter : public FormatterProviderBase, HeaderFormatter {
 public:
   ResponseHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                           absl::optional<size_t> max_length);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
-                     const Http::HeaderMap&, const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  using FormatterProviderBase::format;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
+                  const Http::HeaderMap&, const StreamInfo::StreamInfo&,
+                  std::string& output) const override;
 };
 
 /**
  * Formatter based on the response trailer.
  */
-class ResponseTrailerFormatter : public FormatterProvider, HeaderFormatter {
+class ResponseTrailerFormatter : public FormatterProviderBase, HeaderFormatter {
 public:
   ResponseTrailerFormatter(const std::string& main_header, const std::string& alternative_header,
                            absl::optional<size_t> max_length);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&,
-                     const Http::HeaderMap& response_trailers,
-                     const StreamInfo::StreamInfo&) const override;
+  // FormatterProvider
+  using FormatterProviderBase::format;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&,
+                  const Http::HeaderMap& response_trailers, const StreamInfo::StreamInfo&,
+                  std::string& output) const override;
 };
 
 /**
  * Formatter based on the StreamInfo field.
  */
-class StreamInfoFormatter : public FormatterProvider {
+class StreamInfoFormatter : public FormatterProviderBase {
 public:
   StreamInfoFormatter(const std::string& field_name);
 
-  // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo& stream_info) const override;
+  // FormatterProvider
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 
 private:
-  std::function<std::string(const StreamInfo::StreamInfo&)> field_extractor_;
+  std::function<void(const StreamInfo::StreamInfo&, std::string&)> field_extractor_;
 };
 
 /**
@@ -221,24 +247,27 @@ private:
 /**
  * Formatter based on the DynamicMetadata from StreamInfo.
  */
-class DynamicMetadataFormatter : public FormatterProvider, MetadataFormatter {
+class DynamicMetadataFormatter : public FormatterProviderBase, MetadataFormatter {
 public:
   DynamicMetadataFormatter(const std::string& filter_namespace,
                            const std::vector<std::string>& path, absl::optional<size_t> max_length);
 
-  // FormatterProvider::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo& stream_info) const override;
+  // FormatterProvider
+  using FormatterProviderBase::format;
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 };
 
 /**
  * Formatter
  */
-class StartTimeFormatter : public FormatterProvider {
+class StartTimeFormatter : public FormatterProviderBase {
 public:
   StartTimeFormatter(const std::string& format);
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const StreamInfo::StreamInfo&) const override;
+
+  // FormatterProvider
+  void formatInto(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const StreamInfo::StreamInfo& stream_info, std::string& output) const override;
 
 private:
   const Envoy::DateFormatter date_formatter_;
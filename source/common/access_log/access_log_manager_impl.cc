@@ -1,6 +1,10 @@
 #include "common/access_log/access_log_manager_impl.h"
 
+#include <sys/uio.h>
+
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/fmt.h"
@@ -10,6 +14,101 @@
 namespace Envoy {
 namespace AccessLog {
 
+AccessLogFlusher::AccessLogFlusher(std::chrono::milliseconds flush_interval_msec, Api::Api& api,
+                                   Event::Dispatcher& dispatcher, Stats::Store& stats_store)
+    : flush_interval_msec_(flush_interval_msec), api_(api), dispatcher_(dispatcher),
+      stats_{ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "access_log_file."),
+                                   POOL_GAUGE_PREFIX(stats_store, "access_log_file."))} {}
+
+AccessLogFlusher::~AccessLogFlusher() {
+  {
+    Thread::LockGuard lock(lock_);
+    flush_thread_exit_ = true;
+    flush_event_.notifyOne();
+  }
+
+  if (flush_thread_ != nullptr) {
+    flush_thread_->join();
+  }
+}
+
+void AccessLogFlusher::addFile(AccessLogFileImpl& file) {
+  {
+    Thread::LockGuard lock(files_lock_);
+    files_.insert(&file);
+  }
+
+  if (flush_thread_ == nullptr) {
+    flush_timer_ = dispatcher_.createTimer([this]() -> void {
+      stats_.flushed_by_timer_.inc();
+      wakeup();
+      flush_timer_->enableTimer(flush_interval_msec_);
+    });
+    flush_timer_->enableTimer(flush_interval_msec_);
+    flush_thread_ = api_.threadFactory().createThread([this]() -> void { flushThreadFunc(); });
+  }
+}
+
+void AccessLogFlusher::removeFile(AccessLogFileImpl& file) {
+  Thread::LockGuard lock(files_lock_);
+  files_.erase(&file);
+  while (flushing_file_ == &file) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    flush_done_event_.wait(files_lock_);
+  }
+}
+
+void AccessLogFlusher::wakeup() {
+  Thread::LockGuard lock(lock_);
+  flush_pending_ = true;
+  flush_event_.notifyOne();
+}
+
+void AccessLogFlusher::flushThreadFunc() {
+  while (true) {
+    {
+      Thread::LockGuard lock(lock_);
+
+      // flush_event_ can be woken up either by a file with a large enough buffer or by timer.
+      // Either way all files are flushed; files with nothing buffered are skipped cheaply.
+      while (!flush_pending_ && !flush_thread_exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        flush_event_.wait(lock_);
+      }
+
+      if (flush_thread_exit_) {
+        return;
+      }
+
+      flush_pending_ = false;
+    }
+
+    // Disk writes happen without files_lock_ held, so that a slow disk does not block the main
+    // thread adding or removing files. Only the file currently being flushed is pinned.
+    std::vector<AccessLogFileImpl*> files;
+    {
+      Thread::LockGuard files_lock(files_lock_);
+      files.assign(files_.begin(), files_.end());
+    }
+
+    for (AccessLogFileImpl* file : files) {
+      {
+        Thread::LockGuard files_lock(files_lock_);
+        if (files_.count(file) == 0) {
+          continue;
+        }
+        flushing_file_ = file;
+      }
+
+      file->flushFromThread();
+
+      Thread::LockGuard files_lock(files_lock_);
+      flushing_file_ = nullptr;
+      flush_done_event_.notifyAll();
+    }
+  }
+}
+
 void AccessLogManagerImpl::reopen() {
   for (auto& access_log : access_logs_) {
     access_log.second->reopen();
@@ -22,23 +121,20 @@ AccessLogFileSharedPtr AccessLogManagerImpl::createAccessLog(const std::string&
   }
 
   access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
-      api_.fileSystem().createFile(file_name), dispatcher_, lock_, file_stats_,
-      file_flush_interval_msec_, api_.threadFactory());
+      api_.fileSystem().createFile(file_name), flusher_, lock_, file_flush_size_bytes_,
+      file_buffer_limit_bytes_);
   return access_logs_[file_name];
 }
 
-AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
-                                     Thread::BasicLockable& lock, AccessLogFileStats& stats,
-                                     std::chrono::milliseconds flush_interval_msec,
-                                     Thread::ThreadFactory& thread_factory)
-    : file_(std::move(file)), file_lock_(lock),
-      flush_timer_(dispatcher.createTimer([this]() -> void {
-        stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
-        flush_timer_->enableTimer(flush_interval_msec_);
-      })),
-      thread_factory_(thread_factory), flush_interval_msec_(flush_interval_msec), stats_(stats) {
+AccessLogFileImpl::AccessLogFileImpl(Filesystem::FilePtr&& file,
+                                     AccessLogFlusherSharedPtr flusher,
+                                     Thread::BasicLockable& lock, uint64_t flush_size_bytes,
+                                     uint64_t buffer_limit_bytes)
+    : file_(std::move(file)), flusher_(std::move(flusher)), file_lock_(lock),
+      flush_size_bytes_(flush_size_bytes), buffer_limit_bytes_(buffer_limit_bytes),
+      stats_(flusher_->stats()) {
   open();
+  flusher_->addFile(*this);
 }
 
 void AccessLogFileImpl::open() {
@@ -52,21 +148,12 @@ void AccessLogFileImpl::open() {
 void AccessLogFileImpl::reopen() { reopen_file_ = true; }
 
 AccessLogFileImpl::~AccessLogFileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
-  }
-
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
-  }
+  // Once removed, the flush thread is not flushing this file and never will again.
+  flusher_->removeFile(*this);
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (file_->isOpen()) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
-    }
+    flush();
 
     const Api::SysCallBoolResult result = file_->close();
     ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
@@ -74,6 +161,20 @@ AccessLogFileImpl::~AccessLogFileImpl() {
   }
 }
 
+uint32_t AccessLogFileImpl::shardIndex() {
+  static std::atomic<uint32_t> next_shard{0};
+  static thread_local const uint32_t shard = next_shard++ % NUM_SHARDS;
+  return shard;
+}
+
+void AccessLogFileImpl::collectShards() {
+  flush_requested_ = false;
+  for (Shard& shard : shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    about_to_write_buffer_.move(shard.buffer_);
+  }
+}
+
 void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
   STACK_ARRAY(slices, Buffer::RawSlice, num_slices);
@@ -89,104 +190,84 @@ void AccessLogFileImpl::doWrite(Buffer::Instance& buffer) {
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (const Buffer::RawSlice& slice : slices) {
-      absl::string_view data(static_cast<char*>(slice.mem_), slice.len_);
-      const Api::SysCallSizeResult result = file_->write(data);
-      ASSERT(result.rc_ == static_cast<ssize_t>(slice.len_));
+    iovec iov[MAX_SLICES_PER_WRITE];
+    for (uint64_t i = 0; i < num_slices; i += MAX_SLICES_PER_WRITE) {
+      const uint64_t num_iov = std::min(MAX_SLICES_PER_WRITE, num_slices - i);
+      ssize_t num_bytes = 0;
+      for (uint64_t j = 0; j < num_iov; j++) {
+        iov[j].iov_base = slices[i + j].mem_;
+        iov[j].iov_len = slices[i + j].len_;
+        num_bytes += slices[i + j].len_;
+      }
+      const Api::SysCallSizeResult result = file_->writev(iov, static_cast<int>(num_iov));
+      ASSERT(result.rc_ == num_bytes);
       stats_.write_completed_.inc();
     }
   }
 
   stats_.write_total_buffered_.sub(buffer.length());
+  buffered_bytes_ -= buffer.length();
   buffer.drain(buffer.length());
 }
 
-void AccessLogFileImpl::flushThreadFunc() {
-
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
+void AccessLogFileImpl::flushFromThread() {
+  Thread::LockGuard flush_lock(flush_lock_);
+  if (buffered_bytes_ == 0) {
+    return;
+  }
 
-    {
-      Thread::LockGuard write_lock(write_lock_);
+  collectShards();
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
-
-      if (flush_thread_exit_) {
-        return;
+  // if we failed to open file before, then simply ignore. The data stays buffered, and counts
+  // towards the buffer limit.
+  if (file_->isOpen()) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        const Api::SysCallBoolResult result = file_->close();
+        ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                       file_->errorToString(result.errno_)));
+        open();
       }
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      ASSERT(flush_buffer_.length() > 0);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
-    }
-
-    // if we failed to open file before, then simply ignore
-    if (file_->isOpen()) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          const Api::SysCallBoolResult result = file_->close();
-          ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
-                                         file_->errorToString(result.errno_)));
-          open();
-        }
-
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
-      }
+      doWrite(about_to_write_buffer_);
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
   }
 }
 
 void AccessLogFileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
-
-  {
-    Thread::LockGuard write_lock(write_lock_);
-
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+  // flush_lock_ must be held while collecting, or else it is possible that flushFromThread() has
+  // already moved data from the shards to about_to_write_buffer_ but has not yet completed
+  // doWrite(). This would allow flush() to return before the pending data has actually been
+  // written to disk.
+  Thread::LockGuard flush_lock(flush_lock_);
+  collectShards();
+  if (about_to_write_buffer_.length() > 0 && file_->isOpen()) {
+    doWrite(about_to_write_buffer_);
   }
-
-  doWrite(about_to_write_buffer_);
 }
 
 void AccessLogFileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
-
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  if (buffer_limit_bytes_ > 0 && buffered_bytes_ + data.size() > buffer_limit_bytes_) {
+    stats_.write_dropped_.inc();
+    return;
   }
 
+  // Account for the data before it is visible to the flush thread, which subtracts it once written.
+  const uint64_t buffered_bytes = buffered_bytes_.fetch_add(data.size()) + data.size();
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+  {
+    Shard& shard = shards_[shardIndex()];
+    Thread::LockGuard lock(shard.lock_);
+    shard.buffer_.add(data.data(), data.size());
   }
-}
 
-void AccessLogFileImpl::createFlushStructures() {
-  flush_thread_ = thread_factory_.createThread([this]() -> void { flushThreadFunc(); });
-  flush_timer_->enableTimer(flush_interval_msec_);
+  if (buffered_bytes > flush_size_bytes_ && !flush_requested_.exchange(true)) {
+    flusher_->wakeup();
+  }
 }
 
 } // namespace AccessLog
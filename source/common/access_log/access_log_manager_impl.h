@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/api/api.h"
@@ -21,6 +23,7 @@ namespace Envoy {
   COUNTER(write_completed)                                                                         \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
+  COUNTER(write_dropped)                                                                           \
   GAUGE  (write_total_buffered)
 // clang-format on
 
@@ -30,42 +33,108 @@ struct AccessLogFileStats {
 
 namespace AccessLog {
 
+class AccessLogFileImpl;
+
+/**
+ * Flushes every AccessLogFileImpl created by a manager from a single thread, so that the number of
+ * flush threads does not grow with the number of access log files. A flush pass runs each time the
+ * flush interval elapses, and as soon as any file has buffered more than its flush size. The
+ * flusher is shared with the files, which may outlive the manager that created them.
+ */
+class AccessLogFlusher {
+public:
+  AccessLogFlusher(std::chrono::milliseconds flush_interval_msec, Api::Api& api,
+                   Event::Dispatcher& dispatcher, Stats::Store& stats_store);
+  ~AccessLogFlusher();
+
+  AccessLogFileStats& stats() { return stats_; }
+
+  /**
+   * Register a file to be flushed. Starts the flush thread and timer on first use. Must be called
+   * from the main thread.
+   */
+  void addFile(AccessLogFileImpl& file);
+
+  /**
+   * Unregister a file. Waits for the file to finish flushing if the flush thread is writing it. On
+   * return the flush thread no longer references the file.
+   */
+  void removeFile(AccessLogFileImpl& file);
+
+  /**
+   * Request a flush pass. May be called from any thread.
+   */
+  void wakeup();
+
+private:
+  void flushThreadFunc();
+
+  const std::chrono::milliseconds flush_interval_msec_;
+  Api::Api& api_;
+  Event::Dispatcher& dispatcher_;
+  AccessLogFileStats stats_;
+
+  // lock_ guards the wakeup state. files_lock_ guards the registered files and the file being
+  // flushed, so that removeFile() can wait until that file is done. Neither is held while writing
+  // to disk.
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar flush_event_;
+  bool flush_pending_ GUARDED_BY(lock_){};
+  bool flush_thread_exit_ GUARDED_BY(lock_){};
+  Thread::MutexBasicLockable files_lock_;
+  Thread::CondVar flush_done_event_;
+  std::unordered_set<AccessLogFileImpl*> files_ GUARDED_BY(files_lock_);
+  AccessLogFileImpl* flushing_file_ GUARDED_BY(files_lock_){};
+  Event::TimerPtr flush_timer_;
+  Thread::ThreadPtr flush_thread_;
+};
+
+using AccessLogFlusherSharedPtr = std::shared_ptr<AccessLogFlusher>;
+
 class AccessLogManagerImpl : public AccessLogManager {
 public:
-  AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
-                       Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
+  /**
+   * @param file_flush_interval_msec the time between flushes of every access log file.
+   * @param file_flush_size_bytes the number of buffered bytes in one file that triggers a flush
+   *        before the interval elapses.
+   * @param file_buffer_limit_bytes the number of buffered bytes in one file above which further
+   *        writes are dropped, or 0 for no limit.
+   */
+  AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec,
+                       uint64_t file_flush_size_bytes, uint64_t file_buffer_limit_bytes,
+                       Api::Api& api, Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
                        Stats::Store& stats_store)
-      : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
-        lock_(lock), file_stats_{ACCESS_LOG_FILE_STATS(
-                         POOL_COUNTER_PREFIX(stats_store, "access_log_file."),
-                         POOL_GAUGE_PREFIX(stats_store, "access_log_file."))} {}
+      : file_flush_size_bytes_(file_flush_size_bytes),
+        file_buffer_limit_bytes_(file_buffer_limit_bytes), api_(api), lock_(lock),
+        flusher_(std::make_shared<AccessLogFlusher>(file_flush_interval_msec, api, dispatcher,
+                                                    stats_store)) {}
 
   // AccessLog::AccessLogManager
   void reopen() override;
   AccessLogFileSharedPtr createAccessLog(const std::string& file_name) override;
 
 private:
-  const std::chrono::milliseconds file_flush_interval_msec_;
+  const uint64_t file_flush_size_bytes_;
+  const uint64_t file_buffer_limit_bytes_;
   Api::Api& api_;
-  Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
-  AccessLogFileStats file_stats_;
+  AccessLogFlusherSharedPtr flusher_;
   std::unordered_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Writes are buffered in memory and written to disk by the AccessLogFlusher thread shared by all
+ * files of a manager. The buffer is split into shards picked by the writing thread, so that
+ * workers logging to the same file do not contend on a single lock. Lines are never split, but
+ * lines written by different threads within one flush interval may be reordered.
  */
 class AccessLogFileImpl : public AccessLogFile {
 public:
-  AccessLogFileImpl(Filesystem::FilePtr&& file, Event::Dispatcher& dispatcher,
-                    Thread::BasicLockable& lock, AccessLogFileStats& stats_,
-                    std::chrono::milliseconds flush_interval_msec,
-                    Thread::ThreadFactory& thread_factory);
+  AccessLogFileImpl(Filesystem::FilePtr&& file, AccessLogFlusherSharedPtr flusher,
+                    Thread::BasicLockable& lock, uint64_t flush_size_bytes,
+                    uint64_t buffer_limit_bytes);
   ~AccessLogFileImpl();
 
   // AccessLog::AccessLogFile
@@ -79,55 +148,63 @@ public:
   void reopen() override;
   void flush() override;
 
+  /**
+   * Write out all buffered data, reopening the file first if requested. Called by the flush
+   * thread.
+   */
+  void flushFromThread();
+
 private:
+  struct Shard {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ GUARDED_BY(lock_);
+  };
+
+  // Enough shards that the worker threads of a typical deployment each get their own.
+  static const uint32_t NUM_SHARDS = 16;
+  // Upper bound on the buffers passed to a single writev() call.
+  static const uint64_t MAX_SLICES_PER_WRITE = 128;
+
+  static uint32_t shardIndex();
+  void collectShards();
   void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
   void open();
-  void createFlushStructures();
-
-  // Minimum size before the flush thread will be told to flush.
-  static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
 
   Filesystem::FilePtr file_;
+  const AccessLogFlusherSharedPtr flusher_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
+  //    1) flush_lock_
+  //    2) a shard lock
   //    3) file_lock_
-  Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
-                                          // to disk. This is used to make sure that file blocks do
-                                          // not get interleaved by multiple processes writing to
-                                          // the same file during hot-restart.
+  Thread::BasicLockable& file_lock_;      // This lock is used only when writing to disk. This is
+                                          // used to make sure that file blocks do not get
+                                          // interleaved by multiple processes writing to the same
+                                          // file during hot-restart.
   Thread::MutexBasicLockable flush_lock_; // This lock is used to prevent simultaneous flushes from
                                           // the flush thread and a synchronous flush. This protects
                                           // concurrent access to the about_to_write_buffer_, fd_,
                                           // and all other data used during flushing and file
                                           // re-opening.
-  Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  // Filled by write(). Each thread always appends to the same shard, so the shard locks are rarely
+  // contended.
+  std::array<Shard, NUM_SHARDS> shards_;
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl
-      flush_buffer_ GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It gets
-                                             // filled and then flushed either when max size is
-                                             // reached or when a timer fires.
+  // Set once the flush size is exceeded, so that the flush thread is woken once per flush rather
+  // than once per write.
+  std::atomic<bool> flush_requested_{};
+  // Bytes written but not yet on disk.
+  std::atomic<uint64_t> buffered_bytes_{};
   // TODO(jmarantz): this should be GUARDED_BY(flush_lock_) but the analysis cannot poke through
   // the std::make_unique assignment. I do not believe it's possible to annotate this properly now
   // due to limitations in the clang thread annotation analysis.
-  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
-                                            // continue to fill. This buffer is then used for the
-                                            // final write to disk.
-  Event::TimerPtr flush_timer_;
-  Thread::ThreadFactory& thread_factory_;
-  const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
-                                                        // matter if it reached the MIN_FLUSH_SIZE
-                                                        // or not.
+  Buffer::OwnedImpl about_to_write_buffer_; // Data is moved here from the shards under
+                                            // flush_lock_ and written to disk, while the shards
+                                            // continue to fill.
+  const uint64_t flush_size_bytes_;   // Buffered size that triggers a flush before the flush
+                                      // interval elapses.
+  const uint64_t buffer_limit_bytes_; // Buffered size above which writes are dropped. 0 means no
+                                      // limit.
   AccessLogFileStats& stats_;
 };
 
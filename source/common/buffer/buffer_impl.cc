@@ -21,17 +21,49 @@ static_assert(offsetof(RawSlice, mem_) == offsetof(evbuffer_iovec, iov_base),
 static_assert(offsetof(RawSlice, len_) == offsetof(evbuffer_iovec, iov_len),
               "RawSlice != evbuffer_iovec");
 
-void OwnedImpl::add(const void* data, uint64_t size) { evbuffer_add(buffer_.get(), data, size); }
+namespace {
+// Slices smaller than this are copied rather than moved whole when the destination buffer has
+// room for them at the end. This keeps buffers built from many small writes from degenerating
+// into long chains of tiny slices.
+constexpr uint64_t CopyThreshold = 512;
+} // namespace
+
+bool OwnedImpl::use_old_impl_ = true;
+
+void OwnedImpl::useOldImpl(bool use_old_impl) { use_old_impl_ = use_old_impl; }
+
+void OwnedImpl::add(const void* data, uint64_t size) {
+  if (old_impl_) {
+    evbuffer_add(buffer_.get(), data, size);
+  } else {
+    const char* src = static_cast<const char*>(data);
+    bool new_slice_needed = slices_.empty();
+    while (size != 0) {
+      if (new_slice_needed) {
+        slices_.emplace_back(OwnedSlice::create(size));
+      }
+      const uint64_t copy_size = slices_.back()->append(src, size);
+      src += copy_size;
+      size -= copy_size;
+      length_ += copy_size;
+      new_slice_needed = true;
+    }
+  }
+}
 
 void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
-  evbuffer_add_reference(
-      buffer_.get(), fragment.data(), fragment.size(),
-      [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); }, &fragment);
+  if (old_impl_) {
+    evbuffer_add_reference(
+        buffer_.get(), fragment.data(), fragment.size(),
+        [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); },
+        &fragment);
+  } else {
+    length_ += fragment.size();
+    slices_.emplace_back(std::make_unique<UnownedSlice>(fragment));
+  }
 }
 
-void OwnedImpl::add(absl::string_view data) {
-  evbuffer_add(buffer_.get(), data.data(), data.size());
-}
+void OwnedImpl::add(absl::string_view data) { add(data.data(), data.size()); }
 
 void OwnedImpl::add(const Instance& data) {
   ASSERT(&data != this);
@@ -54,73 +86,295 @@ void OwnedImpl::prepend(absl::string_view data) {
   if (data.size() == 0) {
     return;
   }
-  evbuffer_prepend(buffer_.get(), data.data(), data.size());
+  if (old_impl_) {
+    evbuffer_prepend(buffer_.get(), data.data(), data.size());
+  } else {
+    const char* src = data.data();
+    uint64_t size = data.size();
+    bool new_slice_needed = slices_.empty();
+    while (size != 0) {
+      if (new_slice_needed) {
+        slices_.emplace_front(OwnedSlice::create(size));
+      }
+      const uint64_t copy_size = slices_.front()->prepend(src, size);
+      size -= copy_size;
+      length_ += copy_size;
+      new_slice_needed = true;
+    }
+  }
 }
 
 void OwnedImpl::prepend(Instance& data) {
   ASSERT(&data != this);
-  int rc =
-      evbuffer_prepend_buffer(buffer_.get(), static_cast<LibEventInstance&>(data).buffer().get());
-  ASSERT(rc == 0);
-  ASSERT(data.length() == 0);
+  if (!isSameBufferImpl(data)) {
+    prepend(data.toString());
+    data.drain(data.length());
+    return;
+  }
+  if (old_impl_) {
+    int rc =
+        evbuffer_prepend_buffer(buffer_.get(), static_cast<LibEventInstance&>(data).buffer().get());
+    ASSERT(rc == 0);
+    ASSERT(data.length() == 0);
+  } else {
+    OwnedImpl& other = static_cast<OwnedImpl&>(data);
+    while (!other.slices_.empty()) {
+      const uint64_t slice_size = other.slices_.back()->dataSize();
+      length_ += slice_size;
+      slices_.emplace_front(std::move(other.slices_.back()));
+      other.slices_.pop_back();
+      other.length_ -= slice_size;
+    }
+    ASSERT(other.length() == 0);
+  }
   static_cast<LibEventInstance&>(data).postProcess();
 }
 
 void OwnedImpl::commit(RawSlice* iovecs, uint64_t num_iovecs) {
-  int rc =
-      evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(rc == 0);
+  if (old_impl_) {
+    int rc =
+        evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(rc == 0);
+    return;
+  }
+
+  if (num_iovecs != 0 && !slices_.empty()) {
+    // Find the slices in the buffer that correspond to the iovecs. Reservations are made from
+    // the end of the buffer and out-of-order commits aren't supported, so first scan backward
+    // from the end to find the last slice containing any content; no slice before it can match.
+    ssize_t slice_index = static_cast<ssize_t>(slices_.size()) - 1;
+    while (slice_index > 0 && slices_[slice_index]->dataSize() == 0) {
+      slice_index--;
+    }
+
+    // Next, scan forward and attempt to match the slices against the iovecs.
+    uint64_t num_slices_committed = 0;
+    while (num_slices_committed < num_iovecs &&
+           slice_index < static_cast<ssize_t>(slices_.size())) {
+      if (slices_[slice_index]->commit(iovecs[num_slices_committed])) {
+        length_ += iovecs[num_slices_committed].len_;
+        num_slices_committed++;
+      }
+      slice_index++;
+    }
+    ASSERT(num_slices_committed > 0);
+  }
+
+  // Reserved slices that were not filled are removed from the end of the buffer.
+  while (!slices_.empty() && slices_.back()->dataSize() == 0) {
+    slices_.pop_back();
+  }
 }
 
 void OwnedImpl::copyOut(size_t start, uint64_t size, void* data) const {
   ASSERT(start + size <= length());
 
-  evbuffer_ptr start_ptr;
-  int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
-  ASSERT(rc != -1);
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
+    ASSERT(rc != -1);
 
-  ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
-  ASSERT(static_cast<uint64_t>(copied) == size);
+    ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
+    ASSERT(static_cast<uint64_t>(copied) == size);
+    return;
+  }
+
+  uint64_t bytes_to_skip = start;
+  uint8_t* dest = static_cast<uint8_t*>(data);
+  for (const auto& slice : slices_) {
+    if (size == 0) {
+      break;
+    }
+    uint64_t data_size = slice->dataSize();
+    if (data_size <= bytes_to_skip) {
+      // The offset where the caller wants to start copying is after the end of this slice,
+      // so just skip over this slice completely.
+      bytes_to_skip -= data_size;
+      continue;
+    }
+    uint64_t copy_size = std::min(size, data_size - bytes_to_skip);
+    memcpy(dest, slice->data() + bytes_to_skip, copy_size);
+    size -= copy_size;
+    dest += copy_size;
+    // Now that we've started copying, there are no bytes left to skip over. If there
+    // is any more data to be copied, the next iteration can start copying from the very
+    // beginning of the next slice.
+    bytes_to_skip = 0;
+  }
+  ASSERT(size == 0);
 }
 
 void OwnedImpl::drain(uint64_t size) {
   ASSERT(size <= length());
-  int rc = evbuffer_drain(buffer_.get(), size);
-  ASSERT(rc == 0);
+  if (old_impl_) {
+    int rc = evbuffer_drain(buffer_.get(), size);
+    ASSERT(rc == 0);
+  } else {
+    drainSlices(size);
+  }
+}
+
+void OwnedImpl::drainSlices(uint64_t size) {
+  while (size != 0 && !slices_.empty()) {
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= size) {
+      slices_.pop_front();
+      length_ -= slice_size;
+      size -= slice_size;
+    } else {
+      slices_.front()->drain(size);
+      length_ -= size;
+      size = 0;
+    }
+  }
+  // Make sure the buffer doesn't start with an empty slice, so that linearize() and friends can
+  // rely on the front slice holding data.
+  while (!slices_.empty() && slices_.front()->dataSize() == 0) {
+    slices_.pop_front();
+  }
 }
 
 uint64_t OwnedImpl::getRawSlices(RawSlice* out, uint64_t out_size) const {
-  return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
-                       out_size);
+  if (old_impl_) {
+    return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
+                         out_size);
+  }
+
+  uint64_t num_slices = 0;
+  for (const auto& slice : slices_) {
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    if (num_slices < out_size) {
+      out[num_slices].mem_ = slice->data();
+      out[num_slices].len_ = slice->dataSize();
+    }
+    // Per the definition of getRawSlices in include/envoy/buffer/buffer.h, we need to return
+    // the total number of slices needed to access all the data in the buffer, which can be
+    // larger than out_size. So we keep iterating and counting non-empty slices here, even
+    // if all the caller-supplied slices have been filled.
+    num_slices++;
+  }
+  return num_slices;
 }
 
-uint64_t OwnedImpl::length() const { return evbuffer_get_length(buffer_.get()); }
+uint64_t OwnedImpl::length() const {
+  if (old_impl_) {
+    return evbuffer_get_length(buffer_.get());
+  }
+  return length_;
+}
 
 void* OwnedImpl::linearize(uint32_t size) {
   ASSERT(size <= length());
-  void* const ret = evbuffer_pullup(buffer_.get(), size);
-  RELEASE_ASSERT(ret != nullptr || size == 0,
-                 "Failure to linearize may result in buffer overflow by the caller.");
-  return ret;
+  if (old_impl_) {
+    void* const ret = evbuffer_pullup(buffer_.get(), size);
+    RELEASE_ASSERT(ret != nullptr || size == 0,
+                   "Failure to linearize may result in buffer overflow by the caller.");
+    return ret;
+  }
+
+  if (size == 0 || slices_.empty()) {
+    return nullptr;
+  }
+  if (slices_.front()->dataSize() < size) {
+    // Copy the leading slices that cover the requested range into a single new slice. Whole
+    // slices are consumed so that the data after the linearized region is not split.
+    uint64_t linearized_size = 0;
+    for (const auto& slice : slices_) {
+      linearized_size += slice->dataSize();
+      if (linearized_size >= size) {
+        break;
+      }
+    }
+    SlicePtr new_slice = OwnedSlice::create(linearized_size);
+    Slice::Reservation reservation = new_slice->reserve(linearized_size);
+    RELEASE_ASSERT(reservation.mem_ != nullptr && reservation.len_ == linearized_size,
+                   "Failure to linearize may result in buffer overflow by the caller.");
+    copyOut(0, linearized_size, reservation.mem_);
+    new_slice->commit(reservation);
+    drainSlices(linearized_size);
+    length_ += linearized_size;
+    slices_.emplace_front(std::move(new_slice));
+  }
+  return slices_.front()->data();
+}
+
+void OwnedImpl::copyAndDrain(Instance& rhs, uint64_t length) {
+  // The buffers use different implementations, so their internals can't be shared; fall back
+  // to copying. This only happens if the implementation was switched while buffers were live.
+  std::unique_ptr<char[]> data(new char[length]);
+  rhs.copyOut(0, length, data.get());
+  add(data.get(), length);
+  rhs.drain(length);
 }
 
 void OwnedImpl::move(Instance& rhs) {
   ASSERT(&rhs != this);
-  // We do the static cast here because in practice we only have one buffer implementation right
-  // now and this is safe. Using the evbuffer move routines require having access to both evbuffers.
-  // This is a reasonable compromise in a high performance path where we want to maintain an
-  // abstraction in case we get rid of evbuffer later.
-  int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
-  ASSERT(rc == 0);
+  if (!isSameBufferImpl(rhs)) {
+    copyAndDrain(rhs, rhs.length());
+    return;
+  }
+  if (old_impl_) {
+    // We do the static cast here because in practice we only have one buffer implementation right
+    // now and this is safe. Using the evbuffer move routines require having access to both
+    // evbuffers. This is a reasonable compromise in a high performance path where we want to
+    // maintain an abstraction in case we get rid of evbuffer later.
+    int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
+    ASSERT(rc == 0);
+  } else {
+    // See above for why the static cast is safe. Whole slices are handed over, so moving a
+    // buffer costs O(number of slices) regardless of how much data they hold.
+    OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+    while (!other.slices_.empty()) {
+      SlicePtr& slice = other.slices_.front();
+      const uint64_t slice_size = slice->dataSize();
+      if (slice_size <= CopyThreshold && !slices_.empty() &&
+          slices_.back()->reservableSize() >= slice_size) {
+        slices_.back()->append(slice->data(), slice_size);
+      } else {
+        slices_.emplace_back(std::move(slice));
+      }
+      other.slices_.pop_front();
+      length_ += slice_size;
+      other.length_ -= slice_size;
+    }
+  }
   static_cast<LibEventInstance&>(rhs).postProcess();
 }
 
 void OwnedImpl::move(Instance& rhs, uint64_t length) {
   ASSERT(&rhs != this);
-  // See move() above for why we do the static cast.
-  int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(), buffer_.get(),
-                                  length);
-  ASSERT(static_cast<uint64_t>(rc) == length);
+  if (!isSameBufferImpl(rhs)) {
+    copyAndDrain(rhs, length);
+    return;
+  }
+  if (old_impl_) {
+    // See move() above for why we do the static cast.
+    int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(),
+                                    buffer_.get(), length);
+    ASSERT(static_cast<uint64_t>(rc) == length);
+  } else {
+    // See move() above for why we do the static cast.
+    OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+    while (length != 0 && !other.slices_.empty()) {
+      const uint64_t slice_size = other.slices_.front()->dataSize();
+      const uint64_t copy_size = std::min(slice_size, length);
+      if (copy_size == 0) {
+        other.slices_.pop_front();
+      } else if (copy_size < slice_size) {
+        add(other.slices_.front()->data(), copy_size);
+        other.slices_.front()->drain(copy_size);
+        other.length_ -= copy_size;
+      } else {
+        slices_.emplace_back(std::move(other.slices_.front()));
+        other.slices_.pop_front();
+        length_ += slice_size;
+        other.length_ -= slice_size;
+      }
+      length -= copy_size;
+    }
+  }
   static_cast<LibEventInstance&>(rhs).postProcess();
 }
 
@@ -166,22 +420,129 @@ Api::SysCallIntResult OwnedImpl::read(int fd, uint64_t max_length) {
 
 uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) {
   ASSERT(length > 0);
-  int ret = evbuffer_reserve_space(buffer_.get(), length, reinterpret_cast<evbuffer_iovec*>(iovecs),
-                                   num_iovecs);
-  RELEASE_ASSERT(ret >= 1, "Failure to allocate may result in callers writing to uninitialized "
-                           "memory, buffer overflows, etc");
-  return static_cast<uint64_t>(ret);
+  if (old_impl_) {
+    int ret = evbuffer_reserve_space(buffer_.get(), length,
+                                     reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    RELEASE_ASSERT(ret >= 1, "Failure to allocate may result in callers writing to uninitialized "
+                             "memory, buffer overflows, etc");
+    return static_cast<uint64_t>(ret);
+  }
+
+  if (num_iovecs == 0) {
+    return 0;
+  }
+
+  // Check whether there are any empty slices with reservable space at the end of the buffer.
+  size_t first_reservable_slice = slices_.size();
+  while (first_reservable_slice > 0) {
+    if (slices_[first_reservable_slice - 1]->reservableSize() == 0) {
+      break;
+    }
+    first_reservable_slice--;
+    if (slices_[first_reservable_slice]->dataSize() != 0) {
+      // There is some content in this slice, so anything in front of it is nonreservable.
+      break;
+    }
+  }
+
+  // Having found the sequence of reservable slices at the back of the buffer, reserve
+  // as much space as possible from each one.
+  uint64_t num_slices_used = 0;
+  uint64_t bytes_remaining = length;
+  size_t slice_index = first_reservable_slice;
+  while (slice_index < slices_.size() && bytes_remaining != 0 && num_slices_used < num_iovecs) {
+    auto& slice = slices_[slice_index];
+    const uint64_t reservation_size = std::min(slice->reservableSize(), bytes_remaining);
+    if (num_slices_used + 1 == num_iovecs && reservation_size < bytes_remaining) {
+      // There is only one iovec left, and this next slice does not have enough space to
+      // complete the reservation. Stop iterating, with last one iovec still unpopulated,
+      // so the code following this loop can allocate a new slice to hold the rest of the
+      // reservation.
+      break;
+    }
+    iovecs[num_slices_used] = slice->reserve(reservation_size);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+    slice_index++;
+  }
+
+  // If needed, allocate one more slice at the end to provide the remainder of the reservation.
+  if (bytes_remaining != 0) {
+    slices_.emplace_back(OwnedSlice::create(bytes_remaining));
+    iovecs[num_slices_used] = slices_.back()->reserve(bytes_remaining);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+  }
+
+  ASSERT(num_slices_used <= num_iovecs);
+  ASSERT(bytes_remaining == 0);
+  return num_slices_used;
 }
 
 ssize_t OwnedImpl::search(const void* data, uint64_t size, size_t start) const {
-  evbuffer_ptr start_ptr;
-  if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
-    return -1;
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+      return -1;
+    }
+
+    evbuffer_ptr result_ptr =
+        evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
+    return result_ptr.pos;
   }
 
-  evbuffer_ptr result_ptr =
-      evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
-  return result_ptr.pos;
+  // This implementation uses the same search algorithm as evbuffer_search(), a naive
+  // scan that requires O(M*N) comparisons in the worst case.
+  if (start > length_) {
+    return -1;
+  }
+  if (size == 0) {
+    return start;
+  }
+  const uint8_t* needle = static_cast<const uint8_t*>(data);
+  // Returns whether the needle is present at the given offset within the given slice,
+  // continuing the comparison into the following slices if needed.
+  auto match_at = [this, needle, size](size_t slice_index, uint64_t offset) -> bool {
+    uint64_t matched = 0;
+    for (; slice_index < slices_.size() && matched < size; slice_index++, offset = 0) {
+      const Slice& slice = *slices_[slice_index];
+      const uint64_t compare_size = std::min(size - matched, slice.dataSize() - offset);
+      if (memcmp(slice.data() + offset, needle + matched, compare_size) != 0) {
+        return false;
+      }
+      matched += compare_size;
+    }
+    return matched == size;
+  };
+
+  uint64_t slice_start = 0;
+  for (size_t slice_index = 0; slice_index < slices_.size(); slice_index++) {
+    const Slice& slice = *slices_[slice_index];
+    const uint64_t slice_size = slice.dataSize();
+    if (slice_start + slice_size <= start) {
+      slice_start += slice_size;
+      continue;
+    }
+    const uint8_t* slice_data = slice.data();
+    const uint8_t* slice_end = slice_data + slice_size;
+    const uint8_t* pos = slice_data + (start > slice_start ? start - slice_start : 0);
+    while (pos < slice_end) {
+      pos = static_cast<const uint8_t*>(memchr(pos, needle[0], slice_end - pos));
+      if (pos == nullptr) {
+        break;
+      }
+      const uint64_t match_start = slice_start + (pos - slice_data);
+      if (match_start + size > length_) {
+        return -1;
+      }
+      if (match_at(slice_index, pos - slice_data)) {
+        return match_start;
+      }
+      pos++;
+    }
+    slice_start += slice_size;
+  }
+  return -1;
 }
 
 Api::SysCallIntResult OwnedImpl::write(int fd) {
@@ -208,7 +569,8 @@ Api::SysCallIntResult OwnedImpl::write(int fd) {
   return {static_cast<int>(result.rc_), result.errno_};
 }
 
-OwnedImpl::OwnedImpl() : buffer_(evbuffer_new()) {}
+OwnedImpl::OwnedImpl()
+    : LibEventInstance(use_old_impl_), buffer_(old_impl_ ? evbuffer_new() : nullptr) {}
 
 OwnedImpl::OwnedImpl(absl::string_view data) : OwnedImpl() { add(data); }
 
@@ -216,6 +578,12 @@ OwnedImpl::OwnedImpl(const Instance& data) : OwnedImpl() { add(data); }
 
 OwnedImpl::OwnedImpl(const void* data, uint64_t size) : OwnedImpl() { add(data, size); }
 
+OwnedImpl::OwnedImpl(OwnedImpl&& rhs) noexcept
+    : LibEventInstance(rhs.old_impl_), slices_(std::move(rhs.slices_)), length_(rhs.length_),
+      buffer_(std::move(rhs.buffer_)) {
+  rhs.length_ = 0;
+}
+
 std::string OwnedImpl::toString() const {
   uint64_t num_slices = getRawSlices(nullptr, 0);
   STACK_ARRAY(slices, RawSlice, num_slices);
@@ -1,16 +1,406 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/buffer/slab_pool.h"
+#include "common/common/assert.h"
 #include "common/common/non_copyable.h"
 #include "common/event/libevent.h"
 
 namespace Envoy {
 namespace Buffer {
 
+/**
+ * A Slice manages a contiguous block of bytes.
+ * The block is arranged like this:
+ *                   |<- dataSize() ->|<- reservableSize() ->|
+ * +-----------------+----------------+----------------------+
+ * | Drained         | Data           | Reservable           |
+ * | Unused space    | Usable content | New content can be   |
+ * | that formerly   |                | added here with      |
+ * | was in the Data |                | reserve()/commit()   |
+ * | section         |                |                      |
+ * +-----------------+----------------+----------------------+
+ *                   ^
+ *                   |
+ *                   data()
+ */
+class Slice {
+public:
+  using Reservation = RawSlice;
+
+  virtual ~Slice() = default;
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  const uint8_t* data() const { return base_ + data_; }
+
+  /**
+   * @return a pointer to the start of the usable content.
+   */
+  uint8_t* data() { return base_ + data_; }
+
+  /**
+   * @return the size in bytes of the usable content.
+   */
+  uint64_t dataSize() const { return reservable_ - data_; }
+
+  /**
+   * Remove the first `size` bytes of usable content. Runs in O(1) time.
+   * @param size number of bytes to remove. If greater than data_size(), the result is undefined.
+   */
+  void drain(uint64_t size) {
+    ASSERT(data_ + size <= reservable_);
+    data_ += size;
+  }
+
+  /**
+   * @return the number of bytes available to be reserve()d.
+   * @note If reserve() has been called without a corresponding commit(), this method
+   *       should return 0.
+   * @note Read-only implementations of Slice should return zero from this method.
+   */
+  uint64_t reservableSize() const { return capacity_ - reservable_; }
+
+  /**
+   * Reserve `size` bytes that the caller can populate with content. The caller SHOULD then
+   * call commit() to add the newly populated content from the Reserved section to the Data
+   * section.
+   * @note If there is already an outstanding reservation (i.e., a reservation obtained
+   *       from reserve() that has not been released by calling commit()), this method will
+   *       return a new reservation that replaces it.
+   * @param size the number of bytes to reserve. The Slice implementation MAY reserve
+   *        fewer bytes than requested (for example, if it doesn't have enough room in the
+   *        Reservable section to fulfill the whole request).
+   * @return a tuple containing the address of the start of resulting reservation and the
+   *         reservation size in bytes. If the address is null, the reservation failed.
+   * @note Read-only implementations of Slice should return {nullptr, 0} from this method.
+   */
+  Reservation reserve(uint64_t size) {
+    if (size == 0) {
+      return {nullptr, 0};
+    }
+    const uint64_t reservable_size = reservableSize();
+    if (reservable_size == 0) {
+      return {nullptr, 0};
+    }
+    return {base_ + reservable_, std::min(size, reservable_size)};
+  }
+
+  /**
+   * Commit a Reservation that was previously obtained from a call to reserve().
+   * The Reservation's size is added to the Data section.
+   * @param reservation a reservation obtained from a previous call to reserve().
+   *        If the reservation is not from this Slice, commit() will return false.
+   *        If the caller is committing fewer bytes than provided by reserve(), it
+   *        should change the len_ field of the reservation before calling commit().
+   *        For example, if a caller reserve()s 4KB to do a nonblocking socket read,
+   *        and the read only returns two bytes, the caller should set
+   *        reservation.len_ = 2 and then call `commit(reservation)`.
+   * @return whether the Reservation was successfully committed to the Slice.
+   */
+  bool commit(const Reservation& reservation) {
+    if (static_cast<const uint8_t*>(reservation.mem_) != base_ + reservable_ ||
+        reservable_ + reservation.len_ > capacity_) {
+      // The reservation is not from this Slice.
+      return false;
+    }
+    reservable_ += reservation.len_;
+    return true;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the end of the slice.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero).
+   */
+  uint64_t append(const void* data, uint64_t size) {
+    const uint64_t copy_size = std::min(size, reservableSize());
+    if (copy_size == 0) {
+      return 0;
+    }
+    memcpy(base_ + reservable_, data, copy_size);
+    reservable_ += copy_size;
+    return copy_size;
+  }
+
+  /**
+   * Copy as much of the supplied data as possible to the front of the slice.
+   * If only part of the data will fit in the slice, the bytes from the _end_ are
+   * copied.
+   * @param data start of the data to copy.
+   * @param size number of bytes to copy.
+   * @return number of bytes copied (may be a smaller than size, may even be zero).
+   */
+  uint64_t prepend(const void* data, uint64_t size) {
+    const uint8_t* src = static_cast<const uint8_t*>(data);
+    uint64_t copy_size;
+    if (dataSize() == 0) {
+      // There is nothing in the slice, so put the data at the very end in case the caller
+      // later tries to prepend anything else in front of it.
+      copy_size = std::min(size, reservableSize());
+      if (copy_size == 0) {
+        return 0;
+      }
+      reservable_ = capacity_;
+      data_ = capacity_ - copy_size;
+    } else {
+      if (data_ == 0) {
+        // There is content in the slice, and no space in front of it to write anything.
+        return 0;
+      }
+      // Write into the space in front of the slice's current content.
+      copy_size = std::min(size, data_);
+      data_ -= copy_size;
+    }
+    memcpy(base_ + data_, src + size - copy_size, copy_size);
+    return copy_size;
+  }
+
+protected:
+  Slice(uint64_t data, uint64_t reservable, uint64_t capacity)
+      : data_(data), reservable_(reservable), capacity_(capacity) {}
+
+  /** Start of the slice - subclasses must set this */
+  uint8_t* base_{nullptr};
+
+  /** Offset in bytes from the start of the slice to the start of the Data section */
+  uint64_t data_;
+
+  /** Offset in bytes from the start of the slice to the start of the Reservable section */
+  uint64_t reservable_;
+
+  /** Total number of bytes in the slice */
+  uint64_t capacity_;
+};
+
+typedef std::unique_ptr<Slice> SlicePtr;
+
+/**
+ * A Slice that owns its storage, which is allocated inline with the Slice object itself so that
+ * creating a slice costs a single allocation. Capacities are rounded up so that the object plus
+ * its storage fills a whole number of pages; the memory comes from the current thread's SlabPool
+ * when one is installed, so slices released by a drained buffer are reused by the next one.
+ */
+class OwnedSlice : public Slice {
+public:
+  /**
+   * Create an empty OwnedSlice.
+   * @param capacity number of bytes of space the slice should have.
+   * @return an OwnedSlice with at least the specified capacity.
+   */
+  static SlicePtr create(uint64_t capacity) {
+    const uint64_t slice_capacity = sliceSize(capacity);
+    return SlicePtr(new (slice_capacity) OwnedSlice(slice_capacity));
+  }
+
+  /**
+   * Create an OwnedSlice and initialize it with a copy of the supplied copy.
+   * @param data the content to copy.
+   * @param size length of the content.
+   * @return an OwnedSlice containing a copy of the content, which may (dependent on
+   *         the internal implementation) have a nonzero amount of reservable space at the end.
+   */
+  static SlicePtr create(const void* data, uint64_t size) {
+    SlicePtr slice = create(size);
+    slice->append(data, size);
+    return slice;
+  }
+
+  // Custom delete operator to match the sized operator new below; without it the compiler would
+  // select the global operator delete(void*, size_t) for exception cleanup.
+  static void operator delete(void* address) { SlabPool::deallocate(address); }
+
+private:
+  static void* operator new(size_t object_size, size_t data_size) {
+    return SlabPool::allocate(object_size + data_size);
+  }
+
+  OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
+
+  /**
+   * Compute a slice size big enough to hold a specified amount of data.
+   * @param data_size the minimum amount of data the slice must be able to store, in bytes.
+   * @return a recommended slice size, in bytes.
+   */
+  static uint64_t sliceSize(uint64_t data_size) {
+    return SlabPool::usableSize(sizeof(OwnedSlice) + data_size) - sizeof(OwnedSlice);
+  }
+
+  uint8_t storage_[];
+};
+
+/**
+ * Queue of SlicePtr that supports efficient read and write access to both
+ * the front and the back of the queue.
+ * @note This class has similar properties to std::deque<T>. The reason for using
+ *       a custom deque implementation is that benchmark testing during development
+ *       revealed that std::deque was too slow to reach performance parity with the
+ *       prior evbuffer-based buffer implementation. The first InlineRingCapacity
+ *       slices are stored inside the object itself so that buffers holding only a
+ *       few slices never allocate a separate ring.
+ */
+class SliceDeque {
+public:
+  SliceDeque() : ring_(inline_ring_), capacity_(InlineRingCapacity) {}
+
+  // The inline ring is referenced by ring_, so a defaulted move would leave it dangling.
+  SliceDeque(SliceDeque&& rhs) noexcept : ring_(inline_ring_), capacity_(InlineRingCapacity) {
+    *this = std::move(rhs);
+  }
+
+  SliceDeque& operator=(SliceDeque&& rhs) noexcept {
+    if (this == &rhs) {
+      return *this;
+    }
+    std::move(rhs.inline_ring_, rhs.inline_ring_ + InlineRingCapacity, inline_ring_);
+    external_ring_ = std::move(rhs.external_ring_);
+    ring_ = (external_ring_ != nullptr) ? external_ring_.get() : inline_ring_;
+    start_ = rhs.start_;
+    size_ = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.ring_ = rhs.inline_ring_;
+    rhs.start_ = 0;
+    rhs.size_ = 0;
+    rhs.capacity_ = InlineRingCapacity;
+    return *this;
+  }
+
+  void emplace_back(SlicePtr&& slice) {
+    growRing();
+    const size_t index = internalIndex(size_);
+    ring_[index] = std::move(slice);
+    size_++;
+  }
+
+  void emplace_front(SlicePtr&& slice) {
+    growRing();
+    start_ = (start_ == 0) ? capacity_ - 1 : start_ - 1;
+    ring_[start_] = std::move(slice);
+    size_++;
+  }
+
+  bool empty() const { return size() == 0; }
+  size_t size() const { return size_; }
+
+  SlicePtr& front() { return ring_[start_]; }
+  const SlicePtr& front() const { return ring_[start_]; }
+  SlicePtr& back() { return ring_[internalIndex(size_ - 1)]; }
+  const SlicePtr& back() const { return ring_[internalIndex(size_ - 1)]; }
+
+  SlicePtr& operator[](size_t i) { return ring_[internalIndex(i)]; }
+  const SlicePtr& operator[](size_t i) const { return ring_[internalIndex(i)]; }
+
+  void pop_front() {
+    if (size() == 0) {
+      return;
+    }
+    front() = SlicePtr();
+    size_--;
+    start_++;
+    if (start_ == capacity_) {
+      start_ = 0;
+    }
+  }
+
+  void pop_back() {
+    if (size() == 0) {
+      return;
+    }
+    back() = SlicePtr();
+    size_--;
+  }
+
+  /**
+   * Forward const iterator for SliceDeque.
+   * @note this implementation currently supports the minimum functionality needed to support
+   *       the `for (const SlicePtr& slice : slice_deque)` idiom.
+   */
+  class ConstIterator {
+  public:
+    const SlicePtr& operator*() { return deque_[index_]; }
+
+    ConstIterator operator++() {
+      index_++;
+      return *this;
+    }
+
+    bool operator!=(const ConstIterator& rhs) const {
+      return &deque_ != &rhs.deque_ || index_ != rhs.index_;
+    }
+
+    friend class SliceDeque;
+
+  private:
+    ConstIterator(const SliceDeque& deque, size_t index) : deque_(deque), index_(index) {}
+    const SliceDeque& deque_;
+    size_t index_;
+  };
+
+  ConstIterator begin() const noexcept { return ConstIterator(*this, 0); }
+
+  ConstIterator end() const noexcept { return ConstIterator(*this, size_); }
+
+private:
+  constexpr static size_t InlineRingCapacity = 8;
+
+  size_t internalIndex(size_t index) const {
+    size_t internal_index = start_ + index;
+    if (internal_index >= capacity_) {
+      internal_index -= capacity_;
+      ASSERT(internal_index < capacity_);
+    }
+    return internal_index;
+  }
+
+  void growRing() {
+    if (size_ < capacity_) {
+      return;
+    }
+    const size_t new_capacity = capacity_ * 2;
+    auto new_ring = std::make_unique<SlicePtr[]>(new_capacity);
+    for (size_t i = 0; i < size_; i++) {
+      new_ring[i] = std::move(ring_[internalIndex(i)]);
+    }
+    external_ring_ = std::move(new_ring);
+    ring_ = external_ring_.get();
+    start_ = 0;
+    capacity_ = new_capacity;
+  }
+
+  SlicePtr inline_ring_[InlineRingCapacity];
+  std::unique_ptr<SlicePtr[]> external_ring_;
+  SlicePtr* ring_; // points to start of either inline or external ring.
+  size_t start_{0};
+  size_t size_{0};
+  size_t capacity_;
+};
+
+/**
+ * An immutable Slice that references data owned by a BufferFragment. The fragment's done() is
+ * called when the slice is destroyed.
+ */
+class UnownedSlice : public Slice {
+public:
+  UnownedSlice(BufferFragment& fragment)
+      : Slice(0, fragment.size(), fragment.size()), fragment_(fragment) {
+    base_ = static_cast<uint8_t*>(const_cast<void*>(fragment.data()));
+  }
+
+  ~UnownedSlice() override { fragment_.done(); }
+
+private:
+  BufferFragment& fragment_;
+};
+
 /**
  * An implementation of BufferFragment where a releasor callback is called when the data is
  * no longer needed.
@@ -52,10 +442,26 @@ public:
   virtual Event::Libevent::BufferPtr& buffer() PURE;
   // Called after accessing the memory in buffer() directly to allow any post-processing.
   virtual void postProcess() PURE;
+
+  /**
+   * @return whether this buffer uses the evbuffer-based implementation.
+   */
+  bool usesOldImpl() const { return old_impl_; }
+
+protected:
+  LibEventInstance(bool old_impl) : old_impl_(old_impl) {}
+
+  /**
+   * Whether this buffer uses the evbuffer-based implementation. Held here rather than behind a
+   * virtual call or RTTI, as move() checks it on every call.
+   */
+  const bool old_impl_;
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
+ * An owned buffer. Depending on the implementation selected at startup via useOldImpl(), the
+ * content is either held in an allocated and owned evbuffer, or in a deque of Slices managed
+ * natively by Envoy.
  *
  * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
  * compatible with non-LibEventInstance buffers.
@@ -66,6 +472,8 @@ public:
   OwnedImpl(absl::string_view data);
   OwnedImpl(const Instance& data);
   OwnedImpl(const void* data, uint64_t size);
+  // Leaves rhs empty so that its length() stays consistent with its (moved-from) slices.
+  OwnedImpl(OwnedImpl&& rhs) noexcept;
 
   // LibEventInstance
   void add(const void* data, uint64_t size) override;
@@ -91,7 +499,48 @@ public:
 
   Event::Libevent::BufferPtr& buffer() override { return buffer_; }
 
+  /**
+   * Select the buffer implementation used by OwnedImpl instances created after this call.
+   * This is intended to be called once at startup, before any buffers are created.
+   * @param use_old_impl whether to use the evbuffer-based implementation (true) or the native
+   *        slice-based implementation (false).
+   */
+  static void useOldImpl(bool use_old_impl);
+
 private:
+  /**
+   * @param rhs another buffer, which like any buffer passed to OwnedImpl must be a
+   *        LibEventInstance.
+   * @return whether the rhs buffer uses the same implementation as this buffer, such that its
+   *         internals can be accessed directly.
+   */
+  bool isSameBufferImpl(const Instance& rhs) const {
+    return old_impl_ == static_cast<const LibEventInstance&>(rhs).usesOldImpl();
+  }
+
+  /**
+   * Remove data from the front of the native slice deque without invoking any subclass hooks.
+   * @param size supplies the number of bytes to remove.
+   */
+  void drainSlices(uint64_t size);
+
+  /**
+   * Append the content of another buffer that uses a different implementation by copying it.
+   * @param rhs supplies the buffer to copy and then drain.
+   * @param length supplies the number of bytes to transfer.
+   */
+  void copyAndDrain(Instance& rhs, uint64_t length);
+
+  /** Selects the implementation used by newly created buffers. */
+  static bool use_old_impl_;
+
+  /** Ring buffer of slices, used by the native implementation. */
+  SliceDeque slices_;
+
+  /** Sum of the dataSize of all slices, used by the native implementation. */
+  uint64_t length_{0};
+
+  /** The evbuffer, used by the old implementation. */
   Event::Libevent::BufferPtr buffer_;
 };
 
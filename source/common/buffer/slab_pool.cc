@@ -0,0 +1,221 @@
+#include "common/buffer/slab_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Buffer {
+
+static_assert(SlabPool::HeaderSize >= sizeof(uint64_t), "header too small for the page count");
+static_assert(SlabPool::HeaderSize % alignof(std::max_align_t) == 0,
+              "header breaks block alignment");
+
+constexpr uint64_t SlabPool::PageSize;
+constexpr uint64_t SlabPool::MaxPooledPages;
+constexpr uint64_t SlabPool::HeaderSize;
+constexpr uint64_t SlabPool::DefaultMaxCachedBytes;
+
+thread_local SlabPool* SlabPool::thread_local_pool_ = nullptr;
+
+namespace {
+// The live pools, and the counts of pools that were destroyed, from which totals are summed.
+struct PoolRegistry {
+  Thread::MutexBasicLockable mutex_;
+  std::vector<const SlabPool*> pools_ GUARDED_BY(mutex_);
+  uint64_t retired_hits_ GUARDED_BY(mutex_){0};
+  uint64_t retired_misses_ GUARDED_BY(mutex_){0};
+  uint64_t retired_in_use_bytes_ GUARDED_BY(mutex_){0};
+  // Bytes in use that were allocated or released on a thread without a pool, which is rare.
+  std::atomic<uint64_t> unpooled_in_use_bytes_{0};
+};
+
+PoolRegistry& poolRegistry() {
+  // Never destroyed, as pools may outlive static destruction.
+  static PoolRegistry* registry = new PoolRegistry();
+  return *registry;
+}
+} // namespace
+
+SlabPool::SlabPool(uint64_t max_cached_bytes) : max_cached_bytes_(max_cached_bytes) {
+  PoolRegistry& registry = poolRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  registry.pools_.push_back(this);
+}
+
+SlabPool::~SlabPool() {
+  ASSERT(thread_local_pool_ != this);
+  release();
+
+  PoolRegistry& registry = poolRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  registry.retired_hits_ += hits();
+  registry.retired_misses_ += misses();
+  registry.retired_in_use_bytes_ += in_use_bytes_.load(std::memory_order_relaxed);
+  registry.pools_.erase(std::find(registry.pools_.begin(), registry.pools_.end(), this));
+}
+
+uint64_t SlabPool::totalHits() {
+  PoolRegistry& registry = poolRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  uint64_t hits = registry.retired_hits_;
+  for (const SlabPool* pool : registry.pools_) {
+    hits += pool->hits();
+  }
+  return hits;
+}
+
+uint64_t SlabPool::totalMisses() {
+  PoolRegistry& registry = poolRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  uint64_t misses = registry.retired_misses_;
+  for (const SlabPool* pool : registry.pools_) {
+    misses += pool->misses();
+  }
+  return misses;
+}
+
+uint64_t SlabPool::totalCachedBytes() {
+  PoolRegistry& registry = poolRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  uint64_t cached_bytes = 0;
+  for (const SlabPool* pool : registry.pools_) {
+    cached_bytes += pool->cachedBytes();
+  }
+  return cached_bytes;
+}
+
+uint64_t SlabPool::totalInUseBytes() {
+  PoolRegistry& registry = poolRegistry();
+  Thread::LockGuard lock(registry.mutex_);
+  uint64_t in_use_bytes = registry.retired_in_use_bytes_ +
+                          registry.unpooled_in_use_bytes_.load(std::memory_order_relaxed);
+  for (const SlabPool* pool : registry.pools_) {
+    in_use_bytes += pool->in_use_bytes_.load(std::memory_order_relaxed);
+  }
+  // A block moving between threads while the counts are read may make the sum briefly negative.
+  return static_cast<int64_t>(in_use_bytes) < 0 ? 0 : in_use_bytes;
+}
+
+SlabPool* SlabPool::setThreadLocal(SlabPool* pool) {
+  SlabPool* previous = thread_local_pool_;
+  thread_local_pool_ = pool;
+  return previous;
+}
+
+void* SlabPool::allocate(uint64_t size) {
+  const uint64_t num_pages = (size + HeaderSize + PageSize - 1) / PageSize;
+  void* header = nullptr;
+  SlabPool* pool = thread_local_pool_;
+  if (pool != nullptr && num_pages <= MaxPooledPages) {
+    header = pool->get(num_pages);
+    add(header != nullptr ? pool->hits_ : pool->misses_, 1);
+  }
+  if (header == nullptr) {
+    header = ::operator new(num_pages * PageSize);
+  }
+  if (pool != nullptr) {
+    add(pool->in_use_bytes_, num_pages * PageSize);
+  } else {
+    poolRegistry().unpooled_in_use_bytes_ += num_pages * PageSize;
+  }
+  *static_cast<uint64_t*>(header) = num_pages;
+  return static_cast<uint8_t*>(header) + HeaderSize;
+}
+
+void SlabPool::deallocate(void* block) {
+  if (block == nullptr) {
+    return;
+  }
+  void* header = static_cast<uint8_t*>(block) - HeaderSize;
+  const uint64_t num_pages = *static_cast<uint64_t*>(header);
+  SlabPool* pool = thread_local_pool_;
+  if (pool != nullptr) {
+    // Wraps below zero if the block was allocated on another thread, see in_use_bytes_.
+    add(pool->in_use_bytes_, -(num_pages * PageSize));
+  } else {
+    poolRegistry().unpooled_in_use_bytes_ -= num_pages * PageSize;
+  }
+  if (pool == nullptr || num_pages > MaxPooledPages || !pool->put(header, num_pages)) {
+    ::operator delete(header);
+  }
+}
+
+void SlabPool::onLowWatermark() {
+  SlabPool* pool = thread_local_pool_;
+  if (pool != nullptr) {
+    pool->releaseTo(pool->max_cached_bytes_ / 2);
+  }
+}
+
+void* SlabPool::get(uint64_t num_pages) {
+  std::vector<void*>& blocks = free_blocks_[num_pages - 1];
+  if (blocks.empty()) {
+    return nullptr;
+  }
+  void* header = blocks.back();
+  blocks.pop_back();
+  idle_blocks_[num_pages - 1] = std::min<uint64_t>(idle_blocks_[num_pages - 1], blocks.size());
+  cached_bytes_.store(cachedBytes() - num_pages * PageSize, std::memory_order_relaxed);
+  return header;
+}
+
+bool SlabPool::put(void* header, uint64_t num_pages) {
+  const uint64_t block_size = num_pages * PageSize;
+  if (cachedBytes() + block_size > max_cached_bytes_) {
+    return false;
+  }
+  free_blocks_[num_pages - 1].push_back(header);
+  add(cached_bytes_, block_size);
+  return true;
+}
+
+void SlabPool::release() {
+  for (std::vector<void*>& blocks : free_blocks_) {
+    for (void* header : blocks) {
+      ::operator delete(header);
+    }
+    blocks.clear();
+  }
+  std::fill(std::begin(idle_blocks_), std::end(idle_blocks_), 0);
+  cached_bytes_.store(0, std::memory_order_relaxed);
+}
+
+void SlabPool::releaseIdle() {
+  uint64_t released_bytes = 0;
+  for (uint64_t i = 0; i < MaxPooledPages; i++) {
+    std::vector<void*>& blocks = free_blocks_[i];
+    const auto idle_end = blocks.begin() + idle_blocks_[i];
+    for (auto it = blocks.begin(); it != idle_end; ++it) {
+      ::operator delete(*it);
+    }
+    blocks.erase(blocks.begin(), idle_end);
+    released_bytes += idle_blocks_[i] * (i + 1) * PageSize;
+    idle_blocks_[i] = blocks.size();
+  }
+  cached_bytes_.store(cachedBytes() - released_bytes, std::memory_order_relaxed);
+}
+
+void SlabPool::releaseTo(uint64_t target_bytes) {
+  // Release the largest blocks first, as they free the most memory per block.
+  uint64_t cached_bytes = cachedBytes();
+  for (uint64_t i = MaxPooledPages; i > 0 && cached_bytes > target_bytes; i--) {
+    std::vector<void*>& blocks = free_blocks_[i - 1];
+    auto it = blocks.begin();
+    for (; it != blocks.end() && cached_bytes > target_bytes; ++it) {
+      ::operator delete(*it);
+      cached_bytes -= i * PageSize;
+    }
+    const uint64_t num_released = it - blocks.begin();
+    blocks.erase(blocks.begin(), it);
+    idle_blocks_[i - 1] -= std::min(idle_blocks_[i - 1], num_released);
+  }
+  cached_bytes_.store(cached_bytes, std::memory_order_relaxed);
+}
+
+} // namespace Buffer
+} // namespace Envoy
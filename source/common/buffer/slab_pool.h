@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Buffer {
+
+/**
+ * A cache of page-multiple memory blocks used as backing storage for buffer slices. Each worker's
+ * dispatcher owns one pool and installs it as the current thread's pool while its event loop is
+ * running, so slice allocation and release on that thread never touch the shared heap as long as
+ * the pool has a block of the right size. Blocks released on a thread without a pool, and blocks
+ * released while the pool already caches its maximum number of bytes, go back to the heap.
+ *
+ * All blocks come from the global operator new and carry a small header recording their size, so
+ * a block allocated by one pool may safely be cached by another.
+ *
+ * A pool gives cached blocks back to the heap when they go unused: each worker periodically calls
+ * releaseIdle(), and a buffer draining below its low watermark calls onLowWatermark().
+ *
+ * Each pool counts its own hits, misses, cached bytes and bytes in use, written only by the thread
+ * it is installed on. The totals across pools are summed on demand, so that the allocation path
+ * never writes to memory shared between workers.
+ */
+class SlabPool : NonCopyable {
+public:
+  static constexpr uint64_t PageSize = 4096;
+  // Blocks larger than this many pages bypass the pool.
+  static constexpr uint64_t MaxPooledPages = 8;
+  // Size of the header in front of each block, chosen to preserve max_align_t alignment.
+  static constexpr uint64_t HeaderSize = 16;
+  static constexpr uint64_t DefaultMaxCachedBytes = 4 * 1024 * 1024;
+
+  /**
+   * @param max_cached_bytes supplies the maximum number of bytes of free blocks the pool retains.
+   *        Blocks released beyond this watermark are returned to the heap.
+   */
+  explicit SlabPool(uint64_t max_cached_bytes = DefaultMaxCachedBytes);
+  ~SlabPool();
+
+  /**
+   * Allocate a block through the current thread's pool, if any.
+   * @param size supplies the minimum number of usable bytes required.
+   * @return a pointer to at least usableSize(size) bytes.
+   */
+  static void* allocate(uint64_t size);
+
+  /**
+   * Release a block obtained from allocate() to the current thread's pool, if any.
+   * @param block supplies the block to release. May be nullptr.
+   */
+  static void deallocate(void* block);
+
+  /**
+   * @param size supplies the minimum number of usable bytes required.
+   * @return the number of usable bytes that allocate(size) provides. The block plus its header
+   *         fills a whole number of pages.
+   */
+  static uint64_t usableSize(uint64_t size) {
+    const uint64_t num_pages = (size + HeaderSize + PageSize - 1) / PageSize;
+    return num_pages * PageSize - HeaderSize;
+  }
+
+  /**
+   * @return the pool installed for the current thread, or nullptr.
+   */
+  static SlabPool* threadLocal() { return thread_local_pool_; }
+
+  /**
+   * Install a pool for the current thread.
+   * @param pool supplies the pool to install, or nullptr to stop pooling on this thread.
+   * @return the previously installed pool.
+   */
+  static SlabPool* setThreadLocal(SlabPool* pool);
+
+  /**
+   * @return the number of bytes of free blocks cached by this pool.
+   */
+  uint64_t cachedBytes() const { return cached_bytes_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the number of allocations served from a block cached by this pool.
+   */
+  uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return the number of allocations this pool had no cached block for.
+   */
+  uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+  /**
+   * Return all cached blocks to the heap.
+   */
+  void release();
+
+  /**
+   * Return to the heap the cached blocks that were not reused since the previous call, such as the
+   * slices released by connections that have since gone idle.
+   */
+  void releaseIdle();
+
+  /**
+   * Trim the current thread's pool, if any, to half its maximum number of cached bytes. Called
+   * when a buffer drains below its low watermark, as the burst that took it past its high
+   * watermark has just been returned to the pool.
+   */
+  static void onLowWatermark();
+
+  /**
+   * @return the number of allocations, across all pools including destroyed ones, served from a
+   *         cached block.
+   */
+  static uint64_t totalHits();
+
+  /**
+   * @return the number of allocations, across all pools including destroyed ones, that had to go
+   *         to the heap.
+   */
+  static uint64_t totalMisses();
+
+  /**
+   * @return the number of bytes of free blocks currently cached across all pools.
+   */
+  static uint64_t totalCachedBytes();
+
+  /**
+   * @return the number of bytes of blocks currently allocated by allocate() and not yet released,
+   *         whether or not a pool was installed.
+   */
+  static uint64_t totalInUseBytes();
+
+  /**
+   * @return the number of bytes of slice memory held, either in use or cached by a pool.
+   */
+  static uint64_t totalResidentBytes() { return totalInUseBytes() + totalCachedBytes(); }
+
+private:
+  void* get(uint64_t num_pages);
+  bool put(void* header, uint64_t num_pages);
+  // Returns cached blocks to the heap, largest and then oldest first, until at most target_bytes
+  // remain cached.
+  void releaseTo(uint64_t target_bytes);
+
+  // Adds to a counter that only the owning thread writes, without a locked read-modify-write.
+  static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  const uint64_t max_cached_bytes_;
+  // Counters are atomic only so that totals may be read from another thread.
+  std::atomic<uint64_t> cached_bytes_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  // Blocks allocated on this pool's thread less those released on it. A block may be released on
+  // another thread, so only the sum across pools is meaningful, modulo 2^64.
+  std::atomic<uint64_t> in_use_bytes_{0};
+  // Free blocks indexed by (page count - 1). Blocks are reused LIFO so that recently touched
+  // memory is handed out first.
+  std::vector<void*> free_blocks_[MaxPooledPages];
+  // The smallest size of each free list since the previous releaseIdle(). As blocks are reused
+  // from the back, that many blocks at the front of the list went unused.
+  uint64_t idle_blocks_[MaxPooledPages]{};
+
+  static thread_local SlabPool* thread_local_pool_;
+};
+
+} // namespace Buffer
+} // namespace Envoy
@@ -1,5 +1,6 @@
 #include "common/buffer/watermark_buffer.h"
 
+#include "common/buffer/slab_pool.h"
 #include "common/common/assert.h"
 
 namespace Envoy {
@@ -84,6 +85,8 @@ void WatermarkBuffer::checkLowWatermark() {
 
   above_high_watermark_called_ = false;
   below_low_watermark_();
+  // The slices that took this buffer past its high watermark are now cached, trim the pool back.
+  SlabPool::onLowWatermark();
 }
 
 void WatermarkBuffer::checkHighWatermark() {
@@ -73,7 +73,7 @@ bool StringMatcher::match(const absl::string_view value) const {
   case envoy::type::matcher::StringMatcher::kSuffix:
     return absl::EndsWith(value, matcher_.suffix());
   case envoy::type::matcher::StringMatcher::kRegex:
-    return std::regex_match(value.begin(), value.end(), regex_);
+    return regex_->match(value);
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "envoy/api/v2/core/base.pb.h"
@@ -8,6 +9,7 @@
 #include "envoy/type/matcher/string.pb.h"
 #include "envoy/type/matcher/value.pb.h"
 
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/protobuf/protobuf.h"
 
@@ -74,7 +76,7 @@ class StringMatcher : public ValueMatcher {
 public:
   StringMatcher(const envoy::type::matcher::StringMatcher& matcher) : matcher_(matcher) {
     if (matcher.match_pattern_case() == envoy::type::matcher::StringMatcher::kRegex) {
-      regex_ = RegexUtil::parseRegex(matcher_.regex());
+      regex_ = Regex::Utility::parseRegex(matcher_.regex());
     }
   }
 
@@ -84,7 +86,8 @@ public:
 
 private:
   const envoy::type::matcher::StringMatcher matcher_;
-  std::regex regex_;
+  // Shared so that StringMatcher stays copyable.
+  std::shared_ptr<const Regex::CompiledMatcher> regex_;
 };
 
 class LowerCaseStringMatcher : public ValueMatcher {
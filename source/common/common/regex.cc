@@ -0,0 +1,80 @@
+#include "common/common/regex.h"
+
+#include <regex>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/utility.h"
+
+#include "re2/re2.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+class CompiledStdMatcher : public CompiledMatcher {
+public:
+  CompiledStdMatcher(const std::string& regex) : regex_(RegexUtil::parseRegex(regex)) {}
+
+  // CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return std::regex_match(value.begin(), value.end(), regex_);
+  }
+
+private:
+  const std::regex regex_;
+};
+
+class CompiledRe2Matcher : public CompiledMatcher {
+public:
+  CompiledRe2Matcher(const std::string& regex) : regex_(regex, options()) {
+    if (!regex_.ok()) {
+      throw EnvoyException(fmt::format("Invalid regex '{}': {}", regex, regex_.error()));
+    }
+
+    const uint32_t program_size = static_cast<uint32_t>(regex_.ProgramSize());
+    if (program_size > Utility::maxProgramSize()) {
+      throw EnvoyException(fmt::format("regex '{}' RE2 program size of {} > max program size of {}",
+                                       regex, program_size, Utility::maxProgramSize()));
+    }
+  }
+
+  // CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return re2::RE2::FullMatch(re2::StringPiece(value.data(), value.size()), regex_);
+  }
+
+private:
+  static re2::RE2::Options options() {
+    re2::RE2::Options options;
+    // Errors are reported through the EnvoyException thrown above.
+    options.set_log_errors(false);
+    return options;
+  }
+
+  const re2::RE2 regex_;
+};
+
+} // namespace
+
+Engine Utility::engine_ = Engine::StdRegex;
+uint32_t Utility::max_program_size_ = Utility::DefaultMaxProgramSize;
+
+CompiledMatcherPtr Utility::parseRegex(const std::string& regex) {
+  return parseRegex(regex, engine_);
+}
+
+CompiledMatcherPtr Utility::parseRegex(const std::string& regex, Engine engine) {
+  switch (engine) {
+  case Engine::StdRegex:
+    return std::make_unique<CompiledStdMatcher>(regex);
+  case Engine::Re2:
+    return std::make_unique<CompiledRe2Matcher>(regex);
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+} // namespace Regex
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/common/regex.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * Utilities for compiling regular expressions with the process wide regex engine.
+ */
+class Utility {
+public:
+  /**
+   * Compiles a regular expression with the engine selected by setEngine().
+   * @param regex supplies the regular expression to compile.
+   * @return CompiledMatcherPtr the compiled regular expression.
+   * @throw EnvoyException if the regular expression is invalid or, for RE2, if its compiled
+   *        program is larger than the configured maximum program size.
+   */
+  static CompiledMatcherPtr parseRegex(const std::string& regex);
+
+  /**
+   * Compiles a regular expression with a specific engine.
+   * @param regex supplies the regular expression to compile.
+   * @param engine supplies the engine to compile the regular expression with.
+   * @return CompiledMatcherPtr the compiled regular expression.
+   * @throw EnvoyException under the same conditions as parseRegex(regex).
+   */
+  static CompiledMatcherPtr parseRegex(const std::string& regex, Engine engine);
+
+  /**
+   * Selects the engine used by parseRegex(). This must be called before any configuration is
+   * loaded, since already compiled expressions keep the engine they were compiled with.
+   * @param engine supplies the engine to use.
+   */
+  static void setEngine(Engine engine) { engine_ = engine; }
+
+  /**
+   * @return Engine the engine used by parseRegex().
+   */
+  static Engine engine() { return engine_; }
+
+  /**
+   * Sets the largest RE2 program accepted when compiling. RE2 program size is a measure of the
+   * cost of evaluating an expression, so this bounds the per-request work a pattern can cause.
+   * @param max_program_size supplies the maximum program size.
+   */
+  static void setMaxProgramSize(uint32_t max_program_size) {
+    max_program_size_ = max_program_size;
+  }
+
+  /**
+   * @return uint32_t the largest RE2 program accepted when compiling.
+   */
+  static uint32_t maxProgramSize() { return max_program_size_; }
+
+  static const uint32_t DefaultMaxProgramSize = 100;
+
+private:
+  static Engine engine_;
+  static uint32_t max_program_size_;
+};
+
+} // namespace Regex
+} // namespace Envoy
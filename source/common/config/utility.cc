@@ -15,6 +15,7 @@
 #include "common/json/config_schemas.h"
 #include "common/protobuf/protobuf.h"
 #include "common/protobuf/utility.h"
+#include "common/stats/histogram_impl.h"
 #include "common/stats/stats_matcher_impl.h"
 #include "common/stats/tag_producer_impl.h"
 
@@ -234,6 +235,11 @@ Utility::createStatsMatcher(const envoy::config::bootstrap::v2::Bootstrap& boots
   return std::make_unique<Stats::StatsMatcherImpl>(bootstrap.stats_config());
 }
 
+Stats::HistogramSettingsConstPtr
+Utility::createHistogramSettings(const envoy::config::bootstrap::v2::Bootstrap& bootstrap) {
+  return std::make_unique<Stats::HistogramSettingsImpl>(bootstrap.stats_config());
+}
+
 void Utility::checkObjNameLength(const std::string& error_prefix, const std::string& name,
                                  const Stats::StatsOptions& stats_options) {
   if (name.length() > stats_options.maxNameLength()) {
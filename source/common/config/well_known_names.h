@@ -86,17 +86,18 @@ public:
   TagNameValues();
 
   /**
-   * Represents a tag extraction. This structure may be extended to
-   * allow for an faster pattern-matching engine to be used as an
-   * alternative to regexes, on an individual tag basis. Some of the
-   * tags, such as "_rq_(\\d)xx$", will probably stay as regexes.
+   * Represents a tag extraction. When tokens_ is non-empty, it is a token pattern (see
+   * Stats::TagExtractorTokensImpl) making the same extraction as regex_, and is used in its
+   * place. Some of the tags, such as "_rq_(\\d)xx$", match within a token and stay as regexes.
    */
   struct Descriptor {
-    Descriptor(const std::string& name, const std::string& regex, const std::string& substr = "")
-        : name_(name), regex_(regex), substr_(substr) {}
+    Descriptor(const std::string& name, const std::string& regex, const std::string& substr = "",
+               const std::string& tokens = "")
+        : name_(name), regex_(regex), substr_(substr), tokens_(tokens) {}
     const std::string name_;
     const std::string regex_;
     const std::string substr_;
+    const std::string tokens_;
   };
 
   // Cluster name tag
@@ -153,7 +154,8 @@ public:
   const std::vector<Descriptor>& descriptorVec() const { return descriptor_vec_; }
 
 private:
-  void addRegex(const std::string& name, const std::string& regex, const std::string& substr = "");
+  void addRegex(const std::string& name, const std::string& regex, const std::string& substr = "",
+                const std::string& tokens = "");
 
   // Collection of tag descriptors.
   std::vector<Descriptor> descriptor_vec_;
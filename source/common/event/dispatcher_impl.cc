@@ -162,6 +162,10 @@ void DispatcherImpl::post(std::function<void()> callback) {
 void DispatcherImpl::run(RunType type) {
   run_tid_ = api_.threadFactory().currentThreadId();
 
+  // Install this dispatcher's slab pool for the duration of the loop, so that buffer slices
+  // allocated and released by events on this thread are recycled rather than returned to the heap.
+  Buffer::SlabPool* previous_pool = Buffer::SlabPool::setThreadLocal(&slab_pool_);
+
   // Flush all post callbacks before we run the event loop. We do this because there are post
   // callbacks that have to get run before the initial event loop starts running. libevent does
   // not guarantee that events are run in any particular order. So even if we post() and call
@@ -169,6 +173,8 @@ void DispatcherImpl::run(RunType type) {
   runPostCallbacks();
 
   event_base_loop(base_.get(), type == RunType::NonBlock ? EVLOOP_NONBLOCK : 0);
+
+  Buffer::SlabPool::setThreadLocal(previous_pool);
 }
 
 void DispatcherImpl::runPostCallbacks() {
@@ -11,6 +11,7 @@
 #include "envoy/event/dispatcher.h"
 #include "envoy/network/connection_handler.h"
 
+#include "common/buffer/slab_pool.h"
 #include "common/common/logger.h"
 #include "common/common/thread.h"
 #include "common/event/libevent.h"
@@ -71,6 +72,8 @@ private:
   bool isThreadSafe() const { return run_tid_ == nullptr || run_tid_->isCurrentThreadId(); }
 
   Api::Api& api_;
+  // Recycles buffer slice memory for buffers used by this dispatcher's event loop.
+  Buffer::SlabPool slab_pool_;
   Thread::ThreadIdPtr run_tid_;
   Buffer::WatermarkFactoryPtr buffer_factory_;
   Libevent::BasePtr base_;
@@ -3,6 +3,7 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <cstdlib>
@@ -51,6 +52,11 @@ Api::SysCallSizeResult FileImpl::write(absl::string_view buffer) {
   return {rc, errno};
 }
 
+Api::SysCallSizeResult FileImpl::writev(const iovec* iov, int num_iov) {
+  const ssize_t rc = ::writev(fd_, iov, num_iov);
+  return {rc, errno};
+}
+
 Api::SysCallBoolResult FileImpl::close() {
   ASSERT(isOpen());
 
@@ -16,6 +16,7 @@ public:
   // Filesystem::File
   Api::SysCallBoolResult open() override;
   Api::SysCallSizeResult write(absl::string_view buffer) override;
+  Api::SysCallSizeResult writev(const iovec* iov, int num_iov) override;
   Api::SysCallBoolResult close() override;
   bool isOpen() override;
   std::string path() override;
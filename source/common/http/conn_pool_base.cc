@@ -2,15 +2,26 @@
 
 namespace Envoy {
 namespace Http {
-ConnPoolImplBase::PendingRequest::PendingRequest(ConnPoolImplBase& parent, StreamDecoder& decoder,
-                                                 ConnectionPool::Callbacks& callbacks)
-    : parent_(parent), decoder_(decoder), callbacks_(callbacks) {
+ConnPoolImplBase::PendingRequest::~PendingRequest() {
+  if (callbacks_ != nullptr) {
+    deactivate();
+  }
+}
+
+void ConnPoolImplBase::PendingRequest::activate(StreamDecoder& decoder,
+                                                ConnectionPool::Callbacks& callbacks) {
+  ASSERT(callbacks_ == nullptr);
+  decoder_ = &decoder;
+  callbacks_ = &callbacks;
   parent_.host_->cluster().stats().upstream_rq_pending_total_.inc();
   parent_.host_->cluster().stats().upstream_rq_pending_active_.inc();
   parent_.host_->cluster().resourceManager(parent_.priority_).pendingRequests().inc();
 }
 
-ConnPoolImplBase::PendingRequest::~PendingRequest() {
+void ConnPoolImplBase::PendingRequest::deactivate() {
+  ASSERT(callbacks_ != nullptr);
+  decoder_ = nullptr;
+  callbacks_ = nullptr;
   parent_.host_->cluster().stats().upstream_rq_pending_active_.dec();
   parent_.host_->cluster().resourceManager(parent_.priority_).pendingRequests().dec();
 }
@@ -18,9 +29,31 @@ ConnPoolImplBase::PendingRequest::~PendingRequest() {
 ConnectionPool::Cancellable*
 ConnPoolImplBase::newPendingRequest(StreamDecoder& decoder, ConnectionPool::Callbacks& callbacks) {
   ENVOY_LOG(debug, "queueing request due to no available connections");
-  PendingRequestPtr pending_request(new PendingRequest(*this, decoder, callbacks));
-  pending_request->moveIntoList(std::move(pending_request), pending_requests_);
-  return pending_requests_.front().get();
+  if (free_pending_requests_.empty()) {
+    PendingRequestPtr pending_request(new PendingRequest(*this));
+    pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+  } else {
+    free_pending_requests_.front()->moveBetweenLists(free_pending_requests_, pending_requests_);
+  }
+
+  PendingRequest& request = *pending_requests_.front();
+  request.activate(decoder, callbacks);
+  return &request;
+}
+
+void ConnPoolImplBase::releasePendingRequest(PendingRequest& request) {
+  request.deactivate();
+  recyclePendingRequest(request, pending_requests_);
+}
+
+void ConnPoolImplBase::recyclePendingRequest(PendingRequest& request,
+                                             std::list<PendingRequestPtr>& list) {
+  // Keeping every request would hold on to the memory of a burst for the life of the pool.
+  if (free_pending_requests_.size() < MaxFreePendingRequests) {
+    request.moveBetweenLists(list, free_pending_requests_);
+  } else {
+    request.removeFromList(list);
+  }
 }
 
 void ConnPoolImplBase::purgePendingRequests(
@@ -29,17 +62,18 @@ void ConnPoolImplBase::purgePendingRequests(
   //       if retry logic submits a new request to the pool, we don't fail it inline.
   std::list<PendingRequestPtr> pending_requests_to_purge(std::move(pending_requests_));
   while (!pending_requests_to_purge.empty()) {
-    PendingRequestPtr request =
-        pending_requests_to_purge.front()->removeFromList(pending_requests_to_purge);
+    PendingRequest& request = *pending_requests_to_purge.front();
     host_->cluster().stats().upstream_rq_pending_failure_eject_.inc();
-    request->callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::ConnectionFailure,
+    request.callbacks_->onPoolFailure(ConnectionPool::PoolFailureReason::ConnectionFailure,
                                       host_description);
+    request.deactivate();
+    recyclePendingRequest(request, pending_requests_to_purge);
   }
 }
 
 void ConnPoolImplBase::onPendingRequestCancel(PendingRequest& request) {
   ENVOY_LOG(debug, "cancelling pending request");
-  request.removeFromList(pending_requests_);
+  releasePendingRequest(request);
   host_->cluster().stats().upstream_rq_cancelled_.inc();
   checkForDrained();
 }
@@ -14,24 +14,40 @@ protected:
       : host_(host), priority_(priority) {}
   virtual ~ConnPoolImplBase() = default;
 
+  // Pending requests are recycled through free_pending_requests_ rather than destroyed, so a
+  // request is bound to its caller by activate() and unbound by deactivate(). A caller must not
+  // use its handle once the request has been bound, failed or cancelled, as the same object may
+  // already be queued for another caller.
   struct PendingRequest : LinkedObject<PendingRequest>, public ConnectionPool::Cancellable {
-    PendingRequest(ConnPoolImplBase& parent, StreamDecoder& decoder,
-                   ConnectionPool::Callbacks& callbacks);
+    PendingRequest(ConnPoolImplBase& parent) : parent_(parent) {}
     ~PendingRequest();
 
+    void activate(StreamDecoder& decoder, ConnectionPool::Callbacks& callbacks);
+    void deactivate();
+
     // ConnectionPool::Cancellable
-    void cancel() override { parent_.onPendingRequestCancel(*this); }
+    void cancel() override {
+      // Catches a stale handle used before its request is reused.
+      ASSERT(callbacks_ != nullptr);
+      parent_.onPendingRequestCancel(*this);
+    }
 
     ConnPoolImplBase& parent_;
-    StreamDecoder& decoder_;
-    ConnectionPool::Callbacks& callbacks_;
+    StreamDecoder* decoder_{};
+    ConnectionPool::Callbacks* callbacks_{};
   };
 
   typedef std::unique_ptr<PendingRequest> PendingRequestPtr;
 
-  // Creates a new PendingRequest and enqueues it into the request queue.
+  // Enqueues a PendingRequest into the request queue, reusing a released one if there is one.
   ConnectionPool::Cancellable* newPendingRequest(StreamDecoder& decoder,
                                                  ConnectionPool::Callbacks& callbacks);
+  // Removes the PendingRequest from the request queue once it has been bound to a stream and keeps
+  // it for reuse.
+  void releasePendingRequest(PendingRequest& request);
+  // Moves a deactivated PendingRequest from list to free_pending_requests_, or destroys it if
+  // enough requests are already kept.
+  void recyclePendingRequest(PendingRequest& request, std::list<PendingRequestPtr>& list);
   // Removes the PendingRequest from the list of requests. Called when the PendingRequest is
   // cancelled, e.g. when the stream is reset before a connection has been established.
   void onPendingRequestCancel(PendingRequest& request);
@@ -45,6 +61,10 @@ protected:
   const Upstream::HostConstSharedPtr host_;
   const Upstream::ResourcePriority priority_;
   std::list<PendingRequestPtr> pending_requests_;
+  // Released requests. Pools are per worker, so once the pool has seen its peak number of pending
+  // requests, up to MaxFreePendingRequests, queueing a request no longer allocates.
+  static const size_t MaxFreePendingRequests = 64;
+  std::list<PendingRequestPtr> free_pending_requests_;
 };
 } // namespace Http
 } // namespace Envoy
@@ -335,6 +335,7 @@ public:
 
   // Http::ClientConnection
   StreamEncoder& newStream(StreamDecoder& response_decoder) override;
+  uint32_t maxConcurrentStreams() override { return 1; }
 
 private:
   struct PendingResponse {
@@ -1,5 +1,6 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <cmath>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -43,6 +44,9 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::drainConnections() {
+  // Don't reopen the drained connections to this host until it is picked for a request again.
+  prefetch_suppressed_ = true;
+
   while (!ready_clients_.empty()) {
     ready_clients_.front()->codec_client_->close();
   }
@@ -66,7 +70,11 @@ bool ConnPoolImpl::hasActiveConnections() const {
 void ConnPoolImpl::attachRequestToClient(ActiveClient& client, StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) {
   ASSERT(!client.stream_wrapper_);
-  client.stream_wrapper_ = std::make_unique<StreamWrapper>(response_decoder, client);
+  if (client.prefetched_) {
+    host_->cluster().stats().upstream_rq_prefetch_hit_.inc();
+    client.prefetched_ = false;
+  }
+  client.stream_wrapper_.emplace(response_decoder, client);
   callbacks.onPoolReady(*client.stream_wrapper_, client.real_host_description_);
 }
 
@@ -86,12 +94,15 @@ void ConnPoolImpl::createNewConnection() {
   ENVOY_LOG(debug, "creating a new connection");
   ActiveClientPtr client(new ActiveClient(*this));
   client->moveIntoList(std::move(client), busy_clients_);
+  connecting_clients_++;
 }
 
 ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_decoder,
                                                      ConnectionPool::Callbacks& callbacks) {
   host_->cluster().stats().upstream_rq_total_.inc();
   host_->stats().rq_total_.inc();
+  prefetch_suppressed_ = false;
+  schedulePrefetch();
   if (!ready_clients_.empty()) {
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
@@ -106,8 +117,12 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
       host_->cluster().stats().upstream_cx_overflow_.inc();
     }
 
-    // If we have no connections at all, make one no matter what so we don't starve.
-    if ((ready_clients_.size() == 0 && busy_clients_.size() == 0) || can_create_connection) {
+    // If we have no connections at all, make one no matter what so we don't starve. When
+    // prefetching, a connection that is still connecting and not yet spoken for by a pending
+    // request will serve this one.
+    if ((ready_clients_.size() == 0 && busy_clients_.size() == 0) ||
+        (can_create_connection &&
+         (!prefetchEnabled() || connecting_clients_ <= pending_requests_.size()))) {
       createNewConnection();
     }
 
@@ -171,11 +186,19 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
     if (check_for_drained) {
       checkForDrained();
     }
+
+    // Replace the connection if prefetching was keeping it open. Connections that failed to
+    // connect or were closed by the host are not replaced, so that a host refusing or resetting
+    // connections is not reconnected to on every dispatcher iteration.
+    if (event == Network::ConnectionEvent::LocalClose && !client.connect_timer_) {
+      schedulePrefetch();
+    }
   }
 
   if (client.connect_timer_) {
     client.connect_timer_->disableTimer();
     client.connect_timer_.reset();
+    connecting_clients_--;
   }
 
   // Note that the order in this function is important. Concretely, we must destroy the connect
@@ -220,11 +243,42 @@ void ConnPoolImpl::onUpstreamReady() {
     ENVOY_CONN_LOG(debug, "attaching to next request", *client.codec_client_);
     // There is work to do so bind a request to the client and move it to the busy list. Pending
     // requests are pushed onto the front, so pull from the back.
-    attachRequestToClient(client, pending_requests_.back()->decoder_,
-                          pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    PendingRequest& request = *pending_requests_.back();
+    attachRequestToClient(client, *request.decoder_, *request.callbacks_);
+    releasePendingRequest(request);
     client.moveBetweenLists(ready_clients_, busy_clients_);
   }
+
+  prefetchConnections();
+}
+
+bool ConnPoolImpl::prefetchEnabled() const {
+  // Hosts that fail health checks or have been ejected by outlier detection are not prefetched to,
+  // nor are hosts whose connections were drained and that have not been picked again since.
+  return (host_->cluster().perUpstreamPrefetchRatio() > 1.0 ||
+          host_->cluster().minWarmConnections() > 0) &&
+         !prefetch_suppressed_ && host_->health() != Upstream::Host::Health::Unhealthy;
+}
+
+void ConnPoolImpl::prefetchConnections() {
+  if (!prefetchEnabled() || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  // Connections in use, counting pending requests but not the connections being established for
+  // them, are scaled by the prefetch ratio to give the number of connections to keep open.
+  const uint64_t demand =
+      pending_requests_.size() + (busy_clients_.size() - connecting_clients_);
+  const uint64_t target =
+      std::max<uint64_t>(std::ceil(demand * host_->cluster().perUpstreamPrefetchRatio()),
+                         host_->cluster().minWarmConnections());
+  while (ready_clients_.size() + busy_clients_.size() < target &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a connection");
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+    createNewConnection();
+    busy_clients_.front()->prefetched_ = true;
+  }
 }
 
 void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
@@ -238,9 +292,9 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
     // There is work to do immediately so bind a request to the client and move it to the busy list.
     // Pending requests are pushed onto the front, so pull from the back.
     ENVOY_CONN_LOG(debug, "attaching to next request", *client.codec_client_);
-    attachRequestToClient(client, pending_requests_.back()->decoder_,
-                          pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    PendingRequest& request = *pending_requests_.back();
+    attachRequestToClient(client, *request.decoder_, *request.callbacks_);
+    releasePendingRequest(request);
   }
 
   if (delay && !pending_requests_.empty() && !upstream_ready_enabled_) {
@@ -251,6 +305,15 @@ void ConnPoolImpl::processIdleClient(ActiveClient& client, bool delay) {
   checkForDrained();
 }
 
+void ConnPoolImpl::schedulePrefetch() {
+  // Prefetching runs from the upstream ready timer so that new connections are established after
+  // the current request has been dispatched.
+  if (!upstream_ready_enabled_ && prefetchEnabled()) {
+    upstream_ready_enabled_ = true;
+    upstream_ready_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
 ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, ActiveClient& parent)
     : StreamEncoderWrapper(parent.codec_client_->newStream(*this)),
       StreamDecoderWrapper(response_decoder), parent_(parent) {
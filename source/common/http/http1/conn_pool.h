@@ -75,8 +75,6 @@ protected:
     bool decode_complete_{};
   };
 
-  typedef std::unique_ptr<StreamWrapper> StreamWrapperPtr;
-
   struct ActiveClient : LinkedObject<ActiveClient>,
                         public Network::ConnectionCallbacks,
                         public Event::DeferredDeletable {
@@ -95,10 +93,13 @@ protected:
     ConnPoolImpl& parent_;
     CodecClientPtr codec_client_;
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
-    StreamWrapperPtr stream_wrapper_;
+    // Held inline so that binding a request to a connection does not allocate.
+    absl::optional<StreamWrapper> stream_wrapper_;
     Event::TimerPtr connect_timer_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
+    // Set while a connection opened by prefetching has yet to serve its first request.
+    bool prefetched_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -111,16 +112,25 @@ protected:
   void onDownstreamReset(ActiveClient& client);
   void onResponseComplete(ActiveClient& client);
   void onUpstreamReady();
+  bool prefetchEnabled() const;
+  void prefetchConnections();
   void processIdleClient(ActiveClient& client, bool delay);
+  void schedulePrefetch();
 
   Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
+  // Idle clients are spliced onto the front and reused from the front, so the most recently used
+  // connection is always picked first.
   std::list<ActiveClientPtr> ready_clients_;
+  // Clients awaiting the connected event are kept here too; connecting_clients_ counts them.
   std::list<ActiveClientPtr> busy_clients_;
+  uint64_t connecting_clients_{};
   std::list<DrainedCb> drained_callbacks_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
+  // Set by drainConnections() until the next request, so that drained connections are not reopened.
+  bool prefetch_suppressed_{false};
 };
 
 /**
@@ -915,6 +915,11 @@ Http::StreamEncoder& ClientConnectionImpl::newStream(StreamDecoder& decoder) {
   return *active_streams_.front();
 }
 
+uint32_t ClientConnectionImpl::maxConcurrentStreams() {
+  // nghttp2 reports no limit until the peer's SETTINGS frame arrives.
+  return nghttp2_session_get_remote_settings(session_, NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
+}
+
 int ClientConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
   // The client code explicitly does not currently support push promise.
   RELEASE_ASSERT(frame->hd.type == NGHTTP2_HEADERS, "");
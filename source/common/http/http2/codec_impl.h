@@ -325,6 +325,7 @@ public:
 
   // Http::ClientConnection
   Http::StreamEncoder& newStream(StreamDecoder& response_decoder) override;
+  uint32_t maxConcurrentStreams() override;
 
 private:
   // ConnectionImpl
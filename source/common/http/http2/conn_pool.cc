@@ -1,5 +1,6 @@
 #include "common/http/http2/conn_pool.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 
@@ -22,12 +23,18 @@ ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSha
       socket_options_(options) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  destroying_ = true;
+
+  while (!ready_clients_.empty()) {
+    ready_clients_.front()->client_->close();
+  }
+
+  while (!busy_clients_.empty()) {
+    busy_clients_.front()->client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  while (!draining_clients_.empty()) {
+    draining_clients_.front()->client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -35,8 +42,12 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::ConnPoolImpl::drainConnections() {
-  if (primary_client_ != nullptr) {
-    movePrimaryClientToDraining();
+  while (!ready_clients_.empty()) {
+    moveClientToDraining(*ready_clients_.front());
+  }
+
+  while (!busy_clients_.empty()) {
+    moveClientToDraining(*busy_clients_.front());
   }
 }
 
@@ -46,15 +57,20 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 }
 
 bool ConnPoolImpl::hasActiveConnections() const {
-  if (primary_client_ && primary_client_->client_->numActiveRequests() > 0) {
+  if (!pending_requests_.empty()) {
     return true;
   }
 
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    return true;
+  for (const std::list<ActiveClientPtr>* clients :
+       {&ready_clients_, &busy_clients_, &draining_clients_}) {
+    for (const ActiveClientPtr& client : *clients) {
+      if (client->client_->numActiveRequests() > 0) {
+        return true;
+      }
+    }
   }
 
-  return !pending_requests_.empty();
+  return false;
 }
 
 void ConnPoolImpl::checkForDrained() {
@@ -62,22 +78,21 @@ void ConnPoolImpl::checkForDrained() {
     return;
   }
 
-  bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
-    } else {
-      drained = false;
+  // Close out idle clients. Draining clients close themselves once their last stream completes.
+  for (std::list<ActiveClientPtr>* clients : {&ready_clients_, &busy_clients_}) {
+    for (auto it = clients->begin(); it != clients->end();) {
+      ActiveClient& client = **it++;
+      if (client.client_->numActiveRequests() == 0) {
+        client.client_->close();
+      }
     }
   }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
-    drained = false;
-  }
-
-  if (drained) {
+  ASSERT(std::all_of(draining_clients_.begin(), draining_clients_.end(),
+                     [](const ActiveClientPtr& client) -> bool {
+                       return client->client_->numActiveRequests() > 0;
+                     }));
+  if (ready_clients_.empty() && busy_clients_.empty() && draining_clients_.empty()) {
     ENVOY_LOG(debug, "invoking drained callbacks");
     for (const DrainedCb& cb : drained_callbacks_) {
       cb();
@@ -85,60 +100,100 @@ void ConnPoolImpl::checkForDrained() {
   }
 }
 
-void ConnPoolImpl::newClientStream(Http::StreamDecoder& response_decoder,
+void ConnPoolImpl::createNewConnection() {
+  ENVOY_LOG(debug, "creating a new connection");
+  ActiveClientPtr client(new ActiveClient(*this));
+  client->moveIntoList(std::move(client), ready_clients_);
+}
+
+void ConnPoolImpl::newClientStream(ActiveClient& client, Http::StreamDecoder& response_decoder,
                                    ConnectionPool::Callbacks& callbacks) {
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
     ENVOY_LOG(debug, "max requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ENVOY_CONN_LOG(debug, "creating stream", *client.client_);
+    client.total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    StreamEncoder& encoder = client.client_->newStream(response_decoder);
+    client.peak_streams_ = std::max<uint64_t>(client.peak_streams_,
+                                              client.client_->numActiveRequests());
+    if (!client.hasStreamCapacity()) {
+      ENVOY_CONN_LOG(debug, "client reached its concurrent stream limit", *client.client_);
+      client.busy_ = true;
+      client.moveBetweenLists(ready_clients_, busy_clients_);
+    }
+    callbacks.onPoolReady(encoder, client.real_host_description_);
   }
 }
 
-ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& response_decoder,
-                                                     ConnectionPool::Callbacks& callbacks) {
-  ASSERT(drained_callbacks_.empty());
-
-  // First see if we need to handle max streams rollover.
+ConnPoolImpl::ActiveClient* ConnPoolImpl::pickReadyClient() {
   uint64_t max_streams = host_->cluster().maxRequestsPerConnection();
   if (max_streams == 0) {
     max_streams = maxTotalStreams();
   }
 
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
+  ActiveClient* least_loaded = nullptr;
+  for (auto it = ready_clients_.begin(); it != ready_clients_.end();) {
+    ActiveClient& client = **it++;
+    if (client.total_streams_ >= max_streams) {
+      // Handle max streams rollover.
+      moveClientToDraining(client);
+    } else if (client.upstream_ready_ && !client.hasStreamCapacity()) {
+      // The peer lowered its stream limit since this client was last used.
+      client.busy_ = true;
+      client.moveBetweenLists(ready_clients_, busy_clients_);
+    } else if (client.upstream_ready_ &&
+               (least_loaded == nullptr || client.client_->numActiveRequests() <
+                                               least_loaded->client_->numActiveRequests())) {
+      least_loaded = &client;
+    }
+  }
+
+  return least_loaded;
+}
+
+ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& response_decoder,
+                                                     ConnectionPool::Callbacks& callbacks) {
+  ASSERT(drained_callbacks_.empty());
+
+  ActiveClient* client = pickReadyClient();
+  if (client != nullptr) {
+    // We already have a client that's connected to upstream with spare capacity, so attempt to
+    // establish a new stream.
+    newClientStream(*client, response_decoder, callbacks);
+    return nullptr;
   }
 
-  if (!primary_client_) {
-    primary_client_ = std::make_unique<ActiveClient>(*this);
+  // If we're not allowed to enqueue more requests, fail fast.
+  if (!host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
+    ENVOY_LOG(debug, "max pending requests overflow");
+    callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
+    host_->cluster().stats().upstream_rq_pending_overflow_.inc();
+    return nullptr;
   }
 
-  // If the primary client is not connected yet, queue up the request.
-  if (!primary_client_->upstream_ready_) {
-    // If we're not allowed to enqueue more requests, fail fast.
-    if (!host_->cluster().resourceManager(priority_).pendingRequests().canCreate()) {
-      ENVOY_LOG(debug, "max pending requests overflow");
-      callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
-      host_->cluster().stats().upstream_rq_pending_overflow_.inc();
-      return nullptr;
+  if (ready_clients_.empty() && busy_clients_.empty()) {
+    // If we have no connections at all, make one no matter what so we don't starve.
+    createNewConnection();
+  } else if (pending_requests_.size() >=
+             ready_clients_.size() *
+                 static_cast<uint64_t>(host_->cluster().http2Settings().max_concurrent_streams_)) {
+    // Every connection is either at its stream limit or already spoken for by queued requests.
+    if (host_->cluster().resourceManager(priority_).connections().canCreate()) {
+      host_->cluster().stats().upstream_cx_max_concurrent_streams_.inc();
+      createNewConnection();
+    } else {
+      host_->cluster().stats().upstream_cx_overflow_.inc();
     }
-
-    return newPendingRequest(response_decoder, callbacks);
   }
 
-  // We already have an active client that's connected to upstream, so attempt to establish a
-  // new stream.
-  newClientStream(response_decoder, callbacks);
-  return nullptr;
+  return newPendingRequest(response_decoder, callbacks);
 }
 
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
@@ -168,12 +223,20 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       purgePendingRequests(client.real_host_description_);
     }
 
-    if (&client == primary_client_.get()) {
-      ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
-    } else {
-      ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+    ENVOY_CONN_LOG(debug, "destroying client", *client.client_);
+    dispatcher_.deferredDelete(client.removeFromList(owningList(client)));
+
+    // If we have pending requests and no connection left that could serve them, make a new one,
+    // subject to the same limits as in newStream().
+    if (!destroying_ && !pending_requests_.empty() && ready_clients_.empty()) {
+      if (busy_clients_.empty()) {
+        // With no connections at all, make one no matter what so we don't starve.
+        createNewConnection();
+      } else if (host_->cluster().resourceManager(priority_).connections().canCreate()) {
+        createNewConnection();
+      } else {
+        host_->cluster().stats().upstream_cx_overflow_.inc();
+      }
     }
 
     if (client.closed_with_active_rq_) {
@@ -182,7 +245,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 
   if (event == Network::ConnectionEvent::Connected) {
-    conn_connect_ms_->complete();
+    client.conn_connect_ms_->complete();
 
     client.upstream_ready_ = true;
     onUpstreamReady();
@@ -194,25 +257,25 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
+void ConnPoolImpl::moveClientToDraining(ActiveClient& client) {
+  ASSERT(!client.draining_);
+  ENVOY_CONN_LOG(debug, "moving client to draining", *client.client_);
+  if (client.client_->numActiveRequests() == 0) {
+    // If the client does not have any active requests just close it now.
+    client.client_->close();
+  } else {
+    client.moveBetweenLists(owningList(client), draining_clients_);
+    client.busy_ = false;
+    client.draining_ = true;
   }
+}
 
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
-    // If we are making a new connection and the primary does not have any active requests just
-    // close it now.
-    primary_client_->client_->close();
-  } else {
-    draining_client_ = std::move(primary_client_);
+std::list<ConnPoolImpl::ActiveClientPtr>& ConnPoolImpl::owningList(ActiveClient& client) {
+  if (client.draining_) {
+    return draining_clients_;
   }
 
-  ASSERT(!primary_client_);
+  return client.busy_ ? busy_clients_ : ready_clients_;
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -224,8 +287,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    moveClientToDraining(client);
   }
 }
 
@@ -235,9 +298,14 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (client.draining_ && client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
+  } else if (client.busy_ && !client.closed_with_active_rq_ && client.hasStreamCapacity()) {
+    // The client can take streams again, so hand it any requests that queued up meanwhile.
+    client.busy_ = false;
+    client.moveBetweenLists(busy_clients_, ready_clients_);
+    onUpstreamReady();
   }
 
   // If we are destroying this stream because of a disconnect, do not check for drain here. We will
@@ -261,17 +329,30 @@ void ConnPoolImpl::onStreamReset(ActiveClient& client, Http::StreamResetReason r
 }
 
 void ConnPoolImpl::onUpstreamReady() {
-  // Establishes new codec streams for each pending request.
+  // Establishes new codec streams for each pending request, as long as some client has capacity.
   while (!pending_requests_.empty()) {
-    newClientStream(pending_requests_.back()->decoder_, pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    ActiveClient* client = pickReadyClient();
+    if (client == nullptr) {
+      break;
+    }
+
+    PendingRequest& request = *pending_requests_.back();
+    newClientStream(*client, *request.decoder_, *request.callbacks_);
+    releasePendingRequest(request);
+  }
+
+  // The peer's stream limit may have left requests behind. Open another connection for them.
+  if (!pending_requests_.empty() && ready_clients_.empty() &&
+      host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    host_->cluster().stats().upstream_cx_max_concurrent_streams_.inc();
+    createNewConnection();
   }
 }
 
 ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
     : parent_(parent),
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })) {
-  parent_.conn_connect_ms_ = std::make_unique<Stats::Timespan>(
+  conn_connect_ms_ = std::make_unique<Stats::Timespan>(
       parent_.host_->cluster().stats().upstream_cx_connect_ms_, parent_.dispatcher_.timeSource());
   Upstream::Host::CreateConnectionData data =
       parent_.host_->createConnection(parent_.dispatcher_, parent_.socket_options_, nullptr);
@@ -287,6 +368,7 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
   parent_.host_->cluster().stats().upstream_cx_total_.inc();
   parent_.host_->cluster().stats().upstream_cx_active_.inc();
   parent_.host_->cluster().stats().upstream_cx_http2_total_.inc();
+  parent_.host_->cluster().resourceManager(parent_.priority_).connections().inc();
   conn_length_ = std::make_unique<Stats::Timespan>(
       parent_.host_->cluster().stats().upstream_cx_length_ms_, parent_.dispatcher_.timeSource());
 
@@ -300,7 +382,17 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
 ConnPoolImpl::ActiveClient::~ActiveClient() {
   parent_.host_->stats().cx_active_.dec();
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
+  parent_.host_->cluster().resourceManager(parent_.priority_).connections().dec();
   conn_length_->complete();
+  parent_.host_->cluster().stats().upstream_cx_http2_peak_concurrent_streams_.recordValue(
+      peak_streams_);
+}
+
+bool ConnPoolImpl::ActiveClient::hasStreamCapacity() {
+  const uint64_t stream_limit =
+      std::min<uint64_t>(parent_.host_->cluster().http2Settings().max_concurrent_streams_,
+                         client_->maxConcurrentStreams());
+  return client_->numActiveRequests() < stream_limit;
 }
 
 CodecClientPtr ProdConnPoolImpl::createCodecClient(Upstream::Host::CreateConnectionData& data) {
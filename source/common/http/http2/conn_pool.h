@@ -10,6 +10,7 @@
 #include "envoy/stats/timespan.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/linked_object.h"
 #include "common/http/codec_client.h"
 #include "common/http/conn_pool_base.h"
 
@@ -18,9 +19,12 @@ namespace Http {
 namespace Http2 {
 
 /**
- * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
- * shifting to a new connection if we reach max streams on the primary. This is a base class
- * used for both the prod implementation as well as the testing one.
+ * Implementation of a "connection pool" for HTTP/2. Streams are multiplexed over as few connections
+ * as possible: a new connection is only opened once every existing one has reached its concurrent
+ * stream limit, which is the lower of the cluster's configured HTTP/2 max concurrent streams and
+ * the peer's SETTINGS_MAX_CONCURRENT_STREAMS. New streams go to the least loaded connection with
+ * spare capacity. Connections that reach max streams or receive a GOAWAY are drained. This is a
+ * base class used for both the prod implementation as well as the testing one.
  */
 class ConnPoolImpl : public ConnectionPool::Instance, public ConnPoolImplBase {
 public:
@@ -38,7 +42,8 @@ public:
                                          ConnectionPool::Callbacks& callbacks) override;
 
 protected:
-  struct ActiveClient : public Network::ConnectionCallbacks,
+  struct ActiveClient : LinkedObject<ActiveClient>,
+                        public Network::ConnectionCallbacks,
                         public CodecClientCallbacks,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
@@ -63,12 +68,24 @@ protected:
     // Http::ConnectionCallbacks
     void onGoAway() override { parent_.onGoAway(*this); }
 
+    /**
+     * @return whether the client may take another stream without exceeding either the configured
+     *         or the peer's concurrent stream limit.
+     */
+    bool hasStreamCapacity();
+
     ConnPoolImpl& parent_;
     CodecClientPtr client_;
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
     uint64_t total_streams_{};
+    uint64_t peak_streams_{};
     Event::TimerPtr connect_timer_;
     bool upstream_ready_{};
+    // Set while the client is in busy_clients_.
+    bool busy_{};
+    // Set while the client is in draining_clients_.
+    bool draining_{};
+    Stats::TimespanPtr conn_connect_ms_;
     Stats::TimespanPtr conn_length_;
     bool closed_with_active_rq_{};
   };
@@ -80,21 +97,30 @@ protected:
 
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+  void createNewConnection();
+  void moveClientToDraining(ActiveClient& client);
+  std::list<ActiveClientPtr>& owningList(ActiveClient& client);
+  ActiveClient* pickReadyClient();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
   void onStreamDestroy(ActiveClient& client);
   void onStreamReset(ActiveClient& client, Http::StreamResetReason reason);
-  void newClientStream(Http::StreamDecoder& response_decoder, ConnectionPool::Callbacks& callbacks);
+  void newClientStream(ActiveClient& client, Http::StreamDecoder& response_decoder,
+                       ConnectionPool::Callbacks& callbacks);
   void onUpstreamReady();
 
-  Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  // Clients that are connecting, or connected with spare stream capacity.
+  std::list<ActiveClientPtr> ready_clients_;
+  // Connected clients that are at their concurrent stream limit.
+  std::list<ActiveClientPtr> busy_clients_;
+  // Clients that take no new streams and close once their last stream completes.
+  std::list<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
+  // Set by the destructor, so that closing the clients opens no replacements.
+  bool destroying_{};
 };
 
 /**
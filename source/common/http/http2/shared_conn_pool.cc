@@ -0,0 +1,355 @@
+#include "common/http/http2/shared_conn_pool.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+SharedConnPoolImpl::SharedConnPoolImpl(Event::Dispatcher& dispatcher,
+                                       Event::Dispatcher& owner_dispatcher, OwnerPoolCb owner_pool)
+    : dispatcher_(dispatcher), owner_dispatcher_(owner_dispatcher),
+      owner_pool_(std::move(owner_pool)) {}
+
+SharedConnPoolImpl::~SharedConnPoolImpl() {
+  // Streams still in flight end as they would if the pool's connections were closed.
+  while (!streams_.empty()) {
+    ActiveStream& stream = *streams_.front();
+    if (stream.ready_) {
+      stream.resetStream(StreamResetReason::ConnectionTermination);
+    } else {
+      stream.callbacks_.onPoolFailure(ConnectionPool::PoolFailureReason::ConnectionFailure,
+                                      nullptr);
+      stream.cancel();
+    }
+  }
+
+  // Make sure all streams are destroyed before we are destroyed.
+  dispatcher_.clearDeferredDeleteList();
+}
+
+void SharedConnPoolImpl::addDrainedCallback(DrainedCb cb) {
+  drained_callbacks_.push_back(cb);
+  checkForDrained();
+}
+
+void SharedConnPoolImpl::drainConnections() {
+  // The connections belong to the owning worker's pool, which is drained by that worker.
+}
+
+bool SharedConnPoolImpl::hasActiveConnections() const { return !streams_.empty(); }
+
+void SharedConnPoolImpl::checkForDrained() {
+  if (!drained_callbacks_.empty() && streams_.empty()) {
+    for (const DrainedCb& cb : drained_callbacks_) {
+      cb();
+    }
+  }
+}
+
+ConnectionPool::Cancellable* SharedConnPoolImpl::newStream(StreamDecoder& response_decoder,
+                                                           ConnectionPool::Callbacks& callbacks) {
+  ENVOY_LOG(debug, "handing off stream to owning worker");
+  ActiveStreamPtr stream(new ActiveStream(*this, response_decoder, callbacks));
+  stream->moveIntoList(std::move(stream), streams_);
+
+  // The pool may be gone by the time the owning worker runs this, so copy what it needs.
+  OwnerPoolCb owner_pool = owner_pool_;
+  streams_.front()->postToOwner(
+      [owner_pool](Handoff& handoff) -> void { handoff.start(owner_pool()); });
+  return streams_.front().get();
+}
+
+void SharedConnPoolImpl::onStreamClosed(ActiveStream& stream) {
+  dispatcher_.deferredDelete(stream.removeFromList(streams_));
+  checkForDrained();
+}
+
+void SharedConnPoolImpl::Handoff::start(ConnectionPool::Instance* pool) {
+  if (pool == nullptr) {
+    postToStream([](ActiveStream& stream) -> void {
+      stream.onPoolFailure(ConnectionPool::PoolFailureReason::ConnectionFailure, nullptr);
+    });
+    return;
+  }
+
+  self_ = shared_from_this();
+  // The handle is nullptr if the pool called back inline.
+  owner_handle_ = pool->newStream(*this, *this);
+}
+
+void SharedConnPoolImpl::Handoff::cancel() {
+  if (owner_handle_ != nullptr) {
+    owner_handle_->cancel();
+    finish();
+  } else {
+    // The stream was bound on the owning worker before the cancellation arrived.
+    resetStream(StreamResetReason::LocalReset);
+  }
+}
+
+void SharedConnPoolImpl::Handoff::resetStream(StreamResetReason reason) {
+  if (owner_encoder_ != nullptr) {
+    Stream& stream = owner_encoder_->getStream();
+    stream.removeCallbacks(*this);
+    stream.resetStream(reason);
+  }
+  finish();
+}
+
+void SharedConnPoolImpl::Handoff::checkComplete() {
+  if (owner_encode_complete_ && owner_decode_complete_) {
+    finish();
+  }
+}
+
+void SharedConnPoolImpl::Handoff::decode(std::function<void(StreamDecoder&)> cb,
+                                         bool end_stream) {
+  postToStream([cb, end_stream](ActiveStream& stream) -> void {
+    cb(stream.response_decoder_);
+    if (end_stream) {
+      stream.onDecodeComplete();
+    }
+  });
+
+  if (end_stream) {
+    owner_decode_complete_ = true;
+    checkComplete();
+  }
+}
+
+void SharedConnPoolImpl::Handoff::finish() {
+  owner_handle_ = nullptr;
+  owner_encoder_ = nullptr;
+  if (self_ != nullptr) {
+    // Drop the owning worker's reference once the current call stack has unwound.
+    owner_dispatcher_.post([handoff = std::move(self_)]() -> void {});
+  }
+}
+
+void SharedConnPoolImpl::Handoff::postToStream(std::function<void(ActiveStream&)> cb) {
+  dispatcher_.post([handoff = shared_from_this(), cb]() -> void {
+    if (handoff->stream_ != nullptr) {
+      cb(*handoff->stream_);
+    }
+  });
+}
+
+void SharedConnPoolImpl::Handoff::decode100ContinueHeaders(HeaderMapPtr&& headers) {
+  std::shared_ptr<HeaderMapPtr> shared_headers = std::make_shared<HeaderMapPtr>(std::move(headers));
+  decode(
+      [shared_headers](StreamDecoder& decoder) -> void {
+        decoder.decode100ContinueHeaders(std::move(*shared_headers));
+      },
+      false);
+}
+
+void SharedConnPoolImpl::Handoff::decodeHeaders(HeaderMapPtr&& headers, bool end_stream) {
+  std::shared_ptr<HeaderMapPtr> shared_headers = std::make_shared<HeaderMapPtr>(std::move(headers));
+  decode(
+      [shared_headers, end_stream](StreamDecoder& decoder) -> void {
+        decoder.decodeHeaders(std::move(*shared_headers), end_stream);
+      },
+      end_stream);
+}
+
+void SharedConnPoolImpl::Handoff::decodeData(Buffer::Instance& data, bool end_stream) {
+  std::shared_ptr<Buffer::OwnedImpl> shared_data = std::make_shared<Buffer::OwnedImpl>();
+  shared_data->move(data);
+  decode(
+      [shared_data, end_stream](StreamDecoder& decoder) -> void {
+        decoder.decodeData(*shared_data, end_stream);
+      },
+      end_stream);
+}
+
+void SharedConnPoolImpl::Handoff::decodeTrailers(HeaderMapPtr&& trailers) {
+  std::shared_ptr<HeaderMapPtr> shared_trailers =
+      std::make_shared<HeaderMapPtr>(std::move(trailers));
+  decode(
+      [shared_trailers](StreamDecoder& decoder) -> void {
+        decoder.decodeTrailers(std::move(*shared_trailers));
+      },
+      true);
+}
+
+void SharedConnPoolImpl::Handoff::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  std::shared_ptr<MetadataMapPtr> shared_metadata =
+      std::make_shared<MetadataMapPtr>(std::move(metadata_map));
+  decode(
+      [shared_metadata](StreamDecoder& decoder) -> void {
+        decoder.decodeMetadata(std::move(*shared_metadata));
+      },
+      false);
+}
+
+void SharedConnPoolImpl::Handoff::onResetStream(StreamResetReason reason) {
+  postToStream([reason](ActiveStream& stream) -> void { stream.onResetStream(reason); });
+  finish();
+}
+
+void SharedConnPoolImpl::Handoff::onAboveWriteBufferHighWatermark() {
+  postToStream([](ActiveStream& stream) -> void { stream.runHighWatermarkCallbacks(); });
+}
+
+void SharedConnPoolImpl::Handoff::onBelowWriteBufferLowWatermark() {
+  postToStream([](ActiveStream& stream) -> void { stream.runLowWatermarkCallbacks(); });
+}
+
+void SharedConnPoolImpl::Handoff::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                Upstream::HostDescriptionConstSharedPtr host) {
+  postToStream(
+      [reason, host](ActiveStream& stream) -> void { stream.onPoolFailure(reason, host); });
+  finish();
+}
+
+void SharedConnPoolImpl::Handoff::onPoolReady(StreamEncoder& encoder,
+                                              Upstream::HostDescriptionConstSharedPtr host) {
+  owner_handle_ = nullptr;
+  owner_encoder_ = &encoder;
+  encoder.getStream().addCallbacks(*this);
+  const uint32_t buffer_limit = encoder.getStream().bufferLimit();
+  postToStream([host, buffer_limit](ActiveStream& stream) -> void {
+    stream.onPoolReady(host, buffer_limit);
+  });
+}
+
+SharedConnPoolImpl::ActiveStream::ActiveStream(SharedConnPoolImpl& parent,
+                                               StreamDecoder& response_decoder,
+                                               ConnectionPool::Callbacks& callbacks)
+    : parent_(parent), response_decoder_(response_decoder), callbacks_(callbacks),
+      handoff_(std::make_shared<Handoff>(parent.dispatcher_, parent.owner_dispatcher_)) {
+  handoff_->stream_ = this;
+}
+
+void SharedConnPoolImpl::ActiveStream::close() {
+  if (closed_) {
+    return;
+  }
+
+  // Anything the owning worker posts from here on is dropped.
+  closed_ = true;
+  handoff_->stream_ = nullptr;
+  parent_.onStreamClosed(*this);
+}
+
+void SharedConnPoolImpl::ActiveStream::encode(std::function<void(StreamEncoder&)> cb,
+                                              bool end_stream) {
+  postToOwner([cb, end_stream](Handoff& handoff) -> void {
+    if (handoff.owner_encoder_ == nullptr) {
+      return;
+    }
+
+    cb(*handoff.owner_encoder_);
+    if (end_stream) {
+      handoff.owner_encode_complete_ = true;
+      handoff.checkComplete();
+    }
+  });
+
+  if (end_stream) {
+    local_end_stream_ = true;
+    if (decode_complete_) {
+      close();
+    }
+  }
+}
+
+void SharedConnPoolImpl::ActiveStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                                     Upstream::HostDescriptionConstSharedPtr host) {
+  callbacks_.onPoolFailure(reason, host);
+  close();
+}
+
+void SharedConnPoolImpl::ActiveStream::onPoolReady(Upstream::HostDescriptionConstSharedPtr host,
+                                                   uint32_t buffer_limit) {
+  ready_ = true;
+  buffer_limit_ = buffer_limit;
+  callbacks_.onPoolReady(*this, host);
+}
+
+void SharedConnPoolImpl::ActiveStream::onDecodeComplete() {
+  decode_complete_ = true;
+  if (local_end_stream_) {
+    close();
+  }
+}
+
+void SharedConnPoolImpl::ActiveStream::onResetStream(StreamResetReason reason) {
+  runResetCallbacks(reason);
+  close();
+}
+
+void SharedConnPoolImpl::ActiveStream::postToOwner(std::function<void(Handoff&)> cb) {
+  parent_.owner_dispatcher_.post([handoff = handoff_, cb]() -> void { cb(*handoff); });
+}
+
+void SharedConnPoolImpl::ActiveStream::cancel() {
+  postToOwner([](Handoff& handoff) -> void { handoff.cancel(); });
+  close();
+}
+
+void SharedConnPoolImpl::ActiveStream::encodeHeaders(const HeaderMap& headers, bool end_stream) {
+  std::shared_ptr<HeaderMapImpl> shared_headers = std::make_shared<HeaderMapImpl>(headers);
+  encode(
+      [shared_headers, end_stream](StreamEncoder& encoder) -> void {
+        encoder.encodeHeaders(*shared_headers, end_stream);
+      },
+      end_stream);
+}
+
+void SharedConnPoolImpl::ActiveStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  std::shared_ptr<Buffer::OwnedImpl> shared_data = std::make_shared<Buffer::OwnedImpl>();
+  shared_data->move(data);
+  encode(
+      [shared_data, end_stream](StreamEncoder& encoder) -> void {
+        encoder.encodeData(*shared_data, end_stream);
+      },
+      end_stream);
+}
+
+void SharedConnPoolImpl::ActiveStream::encodeTrailers(const HeaderMap& trailers) {
+  std::shared_ptr<HeaderMapImpl> shared_trailers = std::make_shared<HeaderMapImpl>(trailers);
+  encode(
+      [shared_trailers](StreamEncoder& encoder) -> void {
+        encoder.encodeTrailers(*shared_trailers);
+      },
+      true);
+}
+
+void SharedConnPoolImpl::ActiveStream::encodeMetadata(
+    const MetadataMapVector& metadata_map_vector) {
+  std::shared_ptr<MetadataMapVector> shared_metadata = std::make_shared<MetadataMapVector>();
+  for (const MetadataMapPtr& metadata_map : metadata_map_vector) {
+    shared_metadata->push_back(std::make_unique<MetadataMap>(*metadata_map));
+  }
+  encode(
+      [shared_metadata](StreamEncoder& encoder) -> void {
+        encoder.encodeMetadata(*shared_metadata);
+      },
+      false);
+}
+
+void SharedConnPoolImpl::ActiveStream::resetStream(StreamResetReason reason) {
+  postToOwner([reason](Handoff& handoff) -> void { handoff.resetStream(reason); });
+  runResetCallbacks(reason);
+  close();
+}
+
+void SharedConnPoolImpl::ActiveStream::readDisable(bool disable) {
+  postToOwner([disable](Handoff& handoff) -> void {
+    if (handoff.owner_encoder_ != nullptr) {
+      handoff.owner_encoder_->getStream().readDisable(disable);
+    }
+  });
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
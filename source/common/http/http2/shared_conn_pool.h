@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+#include "common/http/codec_helper.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * Returns the connection pool that carries shared streams to a host. It is called on the owning
+ * worker's dispatcher, and returns nullptr if the host's cluster is no longer available there.
+ */
+typedef std::function<ConnectionPool::Instance*()> OwnerPoolCb;
+
+/**
+ * An HTTP/2 connection pool that owns no connections. Each stream is handed off to the pool for the
+ * same host on an owning worker, and stream events are relayed between the two workers by posting
+ * to their dispatchers. This lets all workers multiplex their streams onto the owning worker's
+ * connections.
+ */
+class SharedConnPoolImpl : public ConnectionPool::Instance, Logger::Loggable<Logger::Id::pool> {
+public:
+  SharedConnPoolImpl(Event::Dispatcher& dispatcher, Event::Dispatcher& owner_dispatcher,
+                     OwnerPoolCb owner_pool);
+  ~SharedConnPoolImpl();
+
+  // ConnectionPool::Instance
+  Http::Protocol protocol() const override { return Http::Protocol::Http2; }
+  void addDrainedCallback(DrainedCb cb) override;
+  void drainConnections() override;
+  bool hasActiveConnections() const override;
+  ConnectionPool::Cancellable* newStream(StreamDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override;
+
+protected:
+  struct ActiveStream;
+
+  /**
+   * The state of a stream shared by both workers. The owner side acts as the decoder and pool
+   * callbacks of the stream on the owning worker. Fields are only accessed on the dispatcher of the
+   * side that they belong to.
+   */
+  struct Handoff : public std::enable_shared_from_this<Handoff>,
+                   public StreamDecoder,
+                   public StreamCallbacks,
+                   public ConnectionPool::Callbacks {
+    Handoff(Event::Dispatcher& dispatcher, Event::Dispatcher& owner_dispatcher)
+        : dispatcher_(dispatcher), owner_dispatcher_(owner_dispatcher) {}
+
+    // Called on the owning worker.
+    void start(ConnectionPool::Instance* pool);
+    void cancel();
+    void resetStream(StreamResetReason reason);
+    void checkComplete();
+    void decode(std::function<void(StreamDecoder&)> cb, bool end_stream);
+    void finish();
+
+    // Posts a call to the stream on the worker that created it. The call is dropped if the stream
+    // has been closed by then.
+    void postToStream(std::function<void(ActiveStream&)> cb);
+
+    // StreamDecoder
+    void decode100ContinueHeaders(HeaderMapPtr&& headers) override;
+    void decodeHeaders(HeaderMapPtr&& headers, bool end_stream) override;
+    void decodeData(Buffer::Instance& data, bool end_stream) override;
+    void decodeTrailers(HeaderMapPtr&& trailers) override;
+    void decodeMetadata(MetadataMapPtr&& metadata_map) override;
+
+    // StreamCallbacks
+    void onResetStream(StreamResetReason reason) override;
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
+
+    // ConnectionPool::Callbacks
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       Upstream::HostDescriptionConstSharedPtr host) override;
+    void onPoolReady(StreamEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host) override;
+
+    Event::Dispatcher& dispatcher_;
+    Event::Dispatcher& owner_dispatcher_;
+
+    // Worker side.
+    ActiveStream* stream_{};
+
+    // Owner side. The handoff keeps itself alive until the owning worker is done with the stream.
+    std::shared_ptr<Handoff> self_;
+    ConnectionPool::Cancellable* owner_handle_{};
+    StreamEncoder* owner_encoder_{};
+    bool owner_encode_complete_{};
+    bool owner_decode_complete_{};
+  };
+
+  typedef std::shared_ptr<Handoff> HandoffSharedPtr;
+
+  /**
+   * The worker side of a stream. It is returned to the caller both as the pending stream handle
+   * and as the stream encoder, and relays calls to the stream on the owning worker.
+   */
+  struct ActiveStream : LinkedObject<ActiveStream>,
+                        public Event::DeferredDeletable,
+                        public ConnectionPool::Cancellable,
+                        public StreamEncoder,
+                        public Stream,
+                        public StreamCallbackHelper {
+    ActiveStream(SharedConnPoolImpl& parent, StreamDecoder& response_decoder,
+                 ConnectionPool::Callbacks& callbacks);
+
+    void close();
+    void encode(std::function<void(StreamEncoder&)> cb, bool end_stream);
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       Upstream::HostDescriptionConstSharedPtr host);
+    void onPoolReady(Upstream::HostDescriptionConstSharedPtr host, uint32_t buffer_limit);
+    void onDecodeComplete();
+    void onResetStream(StreamResetReason reason);
+    void postToOwner(std::function<void(Handoff&)> cb);
+
+    // ConnectionPool::Cancellable
+    void cancel() override;
+
+    // StreamEncoder
+    void encode100ContinueHeaders(const HeaderMap&) override { NOT_REACHED_GCOVR_EXCL_LINE; }
+    void encodeHeaders(const HeaderMap& headers, bool end_stream) override;
+    void encodeData(Buffer::Instance& data, bool end_stream) override;
+    void encodeTrailers(const HeaderMap& trailers) override;
+    Stream& getStream() override { return *this; }
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector) override;
+
+    // Stream
+    void addCallbacks(StreamCallbacks& callbacks) override { addCallbacks_(callbacks); }
+    void removeCallbacks(StreamCallbacks& callbacks) override { removeCallbacks_(callbacks); }
+    void resetStream(StreamResetReason reason) override;
+    void readDisable(bool disable) override;
+    uint32_t bufferLimit() override { return buffer_limit_; }
+
+    SharedConnPoolImpl& parent_;
+    StreamDecoder& response_decoder_;
+    ConnectionPool::Callbacks& callbacks_;
+    HandoffSharedPtr handoff_;
+    uint32_t buffer_limit_{};
+    bool ready_{};
+    bool decode_complete_{};
+    bool closed_{};
+  };
+
+  typedef std::unique_ptr<ActiveStream> ActiveStreamPtr;
+
+  void checkForDrained();
+  void onStreamClosed(ActiveStream& stream);
+
+  Event::Dispatcher& dispatcher_;
+  Event::Dispatcher& owner_dispatcher_;
+  const OwnerPoolCb owner_pool_;
+  std::list<ActiveStreamPtr> streams_;
+  std::list<DrainedCb> drained_callbacks_;
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -82,6 +82,7 @@ public:
   }
   void setConnectionStats(const ConnectionStats& stats) override;
   const Ssl::Connection* ssl() const override { return transport_socket_->ssl(); }
+  bool transportSocketIsPassthrough() const override { return transport_socket_->passthrough(); }
   State state() const override;
   void write(Buffer::Instance& data, bool end_stream) override;
   void setBufferLimits(uint32_t limit) override;
@@ -1,5 +1,7 @@
 #include "common/network/raw_buffer_socket.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/http/headers.h"
@@ -7,6 +9,15 @@
 namespace Envoy {
 namespace Network {
 
+constexpr uint64_t RawBufferSocket::DefaultMaxReadSize;
+constexpr uint64_t RawBufferSocket::MinReadSize;
+
+RawBufferSocket::RawBufferSocket(uint64_t max_read_size, RawBufferSocketStats* stats)
+    : max_read_size_(max_read_size), read_size_(std::min(DefaultMaxReadSize, max_read_size)),
+      stats_(stats) {
+  ASSERT(max_read_size_ >= MinReadSize);
+}
+
 void RawBufferSocket::setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) {
   callbacks_ = &callbacks;
 }
@@ -14,11 +25,23 @@ void RawBufferSocket::setTransportSocketCallbacks(TransportSocketCallbacks& call
 IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
   PostIoAction action = PostIoAction::KeepOpen;
   uint64_t bytes_read = 0;
+  uint64_t reads = 0;
   bool end_stream = false;
+  const uint64_t buffer_limit = callbacks_->connection().bufferLimit();
   do {
-    // 16K read is arbitrary. TODO(mattklein123) PERF: Tune the read size.
-    Api::SysCallIntResult result = buffer.read(callbacks_->ioHandle().fd(), 16384);
+    // The read size adapts to the connection. It doubles whenever a read fills it, up to
+    // max_read_size_, so a bulk transfer needs fewer syscalls, and it halves after read events
+    // that return far less than it, so small messages don't reserve large slices. The read itself
+    // uses readv() into the free space of the last slice and a new slice for the rest.
+    uint64_t max_length = read_size_;
+    // A read never takes the buffer past the connection's buffer limit, so a large read size
+    // doesn't overshoot the limit by up to max_read_size_.
+    if (buffer_limit > 0 && buffer.length() < buffer_limit) {
+      max_length = std::min(max_length, buffer_limit - buffer.length());
+    }
+    Api::SysCallIntResult result = buffer.read(callbacks_->ioHandle().fd(), max_length);
     ENVOY_CONN_LOG(trace, "read returns: {}", callbacks_->connection(), result.rc_);
+    reads++;
 
     if (result.rc_ == 0) {
       // Remote close.
@@ -33,6 +56,9 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
       break;
     } else {
       bytes_read += result.rc_;
+      if (static_cast<uint64_t>(result.rc_) == read_size_) {
+        read_size_ = std::min(read_size_ * 2, max_read_size_);
+      }
       if (callbacks_->shouldDrainReadBuffer()) {
         callbacks_->setReadBufferReady();
         break;
@@ -40,6 +66,14 @@ IoResult RawBufferSocket::doRead(Buffer::Instance& buffer) {
     }
   } while (true);
 
+  if (bytes_read > 0 && bytes_read < read_size_ / 4) {
+    read_size_ = std::max(read_size_ / 2, MinReadSize);
+  }
+  if (stats_ != nullptr) {
+    stats_->read_events_.inc();
+    stats_->reads_.add(reads);
+  }
+
   return {action, bytes_read, end_stream};
 }
 
@@ -82,9 +116,14 @@ std::string RawBufferSocket::protocol() const { return EMPTY_STRING; }
 
 void RawBufferSocket::onConnected() { callbacks_->raiseEvent(ConnectionEvent::Connected); }
 
+RawBufferSocketFactory::RawBufferSocketFactory(uint64_t max_read_size, Stats::Scope& scope)
+    : max_read_size_(max_read_size),
+      stats_(new RawBufferSocketStats{
+          ALL_RAW_BUFFER_SOCKET_STATS(POOL_COUNTER_PREFIX(scope, "raw_buffer."))}) {}
+
 TransportSocketPtr
 RawBufferSocketFactory::createTransportSocket(TransportSocketOptionsSharedPtr) const {
-  return std::make_unique<RawBufferSocket>();
+  return std::make_unique<RawBufferSocket>(max_read_size_, stats_.get());
 }
 
 bool RawBufferSocketFactory::implementsSecureTransport() const { return false; }
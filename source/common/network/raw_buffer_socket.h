@@ -1,16 +1,50 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+
 #include "envoy/buffer/buffer.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 
 #include "common/common/logger.h"
 
 namespace Envoy {
 namespace Network {
 
+/**
+ * All raw buffer transport socket stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_RAW_BUFFER_SOCKET_STATS(COUNTER)                                                       \
+  COUNTER(read_events)                                                                             \
+  COUNTER(reads)
+// clang-format on
+
+/**
+ * Struct definition for all raw buffer transport socket stats. @see stats_macros.h
+ */
+struct RawBufferSocketStats {
+  ALL_RAW_BUFFER_SOCKET_STATS(GENERATE_COUNTER_STRUCT)
+};
+
 class RawBufferSocket : public TransportSocket, protected Logger::Loggable<Logger::Id::connection> {
 public:
+  // The read size that a connection starts with, and the default limit that it can grow to.
+  static constexpr uint64_t DefaultMaxReadSize = 16384;
+  // The read size never shrinks below this, so a burst after an idle period still reads a useful
+  // amount per syscall.
+  static constexpr uint64_t MinReadSize = 4096;
+
+  /**
+   * @param max_read_size the largest read the socket grows to while reads keep filling it.
+   * @param stats optional stats shared by all sockets of a factory.
+   */
+  RawBufferSocket(uint64_t max_read_size = DefaultMaxReadSize,
+                  RawBufferSocketStats* stats = nullptr);
+
   // Network::TransportSocket
   void setTransportSocketCallbacks(TransportSocketCallbacks& callbacks) override;
   std::string protocol() const override;
@@ -20,17 +54,35 @@ public:
   IoResult doRead(Buffer::Instance& buffer) override;
   IoResult doWrite(Buffer::Instance& buffer, bool end_stream) override;
   const Ssl::Connection* ssl() const override { return nullptr; }
+  bool passthrough() const override { return true; }
+
+  uint64_t readSize() const { return read_size_; }
 
 private:
   TransportSocketCallbacks* callbacks_{};
   bool shutdown_{};
+  const uint64_t max_read_size_;
+  uint64_t read_size_;
+  RawBufferSocketStats* const stats_;
 };
 
 class RawBufferSocketFactory : public TransportSocketFactory {
 public:
+  RawBufferSocketFactory() : max_read_size_(RawBufferSocket::DefaultMaxReadSize) {}
+
+  /**
+   * @param max_read_size the largest read that sockets created by the factory grow to.
+   * @param scope the scope that the socket stats are created in, with the "raw_buffer." prefix.
+   */
+  RawBufferSocketFactory(uint64_t max_read_size, Stats::Scope& scope);
+
   // Network::TransportSocketFactory
   TransportSocketPtr createTransportSocket(TransportSocketOptionsSharedPtr options) const override;
   bool implementsSecureTransport() const override;
+
+private:
+  const uint64_t max_read_size_;
+  std::unique_ptr<RawBufferSocketStats> stats_;
 };
 
 } // namespace Network
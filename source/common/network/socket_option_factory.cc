@@ -94,5 +94,13 @@ SocketOptionFactory::buildTcpFastOpenOptions(uint32_t queue_length) {
   return options;
 }
 
+std::unique_ptr<Socket::Options> SocketOptionFactory::buildReusePortOptions() {
+  std::unique_ptr<Socket::Options> options = std::make_unique<Socket::Options>();
+  // All sockets bound to the same port must set the option before binding.
+  options->push_back(std::make_shared<Network::SocketOptionImpl>(
+      envoy::api::v2::core::SocketOption::STATE_PREBIND, ENVOY_SOCKET_SO_REUSEPORT, 1));
+  return options;
+}
+
 } // namespace Network
 } // namespace Envoy
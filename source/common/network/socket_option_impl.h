@@ -46,6 +46,13 @@ namespace Network {
 #define ENVOY_SOCKET_SO_KEEPALIVE Network::SocketOptionName()
 #endif
 
+#ifdef SO_REUSEPORT
+#define ENVOY_SOCKET_SO_REUSEPORT                                                                  \
+  Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_REUSEPORT))
+#else
+#define ENVOY_SOCKET_SO_REUSEPORT Network::SocketOptionName()
+#endif
+
 #ifdef SO_MARK
 #define ENVOY_SOCKET_SO_MARK Network::SocketOptionName(std::make_pair(SOL_SOCKET, SO_MARK))
 #else
@@ -0,0 +1,80 @@
+#include "common/network/splice_pipe.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+SplicePipe::SplicePipe(int read_fd, int write_fd, uint64_t capacity)
+    : read_fd_(read_fd), write_fd_(write_fd), capacity_(capacity) {}
+
+SplicePipe::~SplicePipe() {
+  ::close(read_fd_);
+  ::close(write_fd_);
+}
+
+#ifdef __linux__
+
+SplicePipePtr SplicePipe::create(uint64_t capacity) {
+  int fds[2];
+  if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+    return nullptr;
+  }
+  // The kernel rounds the size up to a power of two number of pages, so use whatever it settled on.
+  ::fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(capacity));
+  const int size = ::fcntl(fds[1], F_GETPIPE_SZ);
+  if (size <= 0) {
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return nullptr;
+  }
+  return SplicePipePtr{new SplicePipe(fds[0], fds[1], size)};
+}
+
+Api::SysCallSizeResult SplicePipe::fill(int fd) {
+  ASSERT(!full());
+  const ssize_t rc = ::splice(fd, nullptr, write_fd_, nullptr, capacity_ - length_,
+                              SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (rc > 0) {
+    length_ += rc;
+  }
+  return {rc, errno};
+}
+
+Api::SysCallSizeResult SplicePipe::drain(int fd) {
+  ASSERT(length_ > 0);
+  const ssize_t rc =
+      ::splice(read_fd_, nullptr, fd, nullptr, length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (rc > 0) {
+    ASSERT(static_cast<uint64_t>(rc) <= length_);
+    length_ -= rc;
+  }
+  return {rc, errno};
+}
+
+#else
+
+SplicePipePtr SplicePipe::create(uint64_t) { return nullptr; }
+
+Api::SysCallSizeResult SplicePipe::fill(int) { NOT_REACHED_GCOVR_EXCL_LINE; }
+
+Api::SysCallSizeResult SplicePipe::drain(int) { NOT_REACHED_GCOVR_EXCL_LINE; }
+
+#endif
+
+void SplicePipe::moveTo(Buffer::Instance& buffer) {
+  while (length_ > 0) {
+    const Api::SysCallIntResult result = buffer.read(read_fd_, length_);
+    // Data in a pipe is always readable, so this can only fail on a bug.
+    RELEASE_ASSERT(result.rc_ > 0, "");
+    length_ -= result.rc_;
+  }
+}
+
+} // namespace Network
+} // namespace Envoy
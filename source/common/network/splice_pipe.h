@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/buffer/buffer.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+class SplicePipe;
+typedef std::unique_ptr<SplicePipe> SplicePipePtr;
+
+/**
+ * A pipe that moves data from one socket to another with splice(2), so that the data is never
+ * copied into user space. Only available on Linux.
+ */
+class SplicePipe : NonCopyable {
+public:
+  ~SplicePipe();
+
+  /**
+   * @param capacity supplies the size of the pipe's kernel buffer to ask for. The pipe keeps the
+   *        default size if the request is refused, e.g. because it is above the system limit.
+   * @return a new pipe, or nullptr if splice(2) is not supported or the pipe couldn't be created.
+   */
+  static SplicePipePtr create(uint64_t capacity);
+
+  /**
+   * Moves data from a socket into the pipe, up to the free space in the pipe. Must not be called
+   * when the pipe is full.
+   * @param fd supplies the non-blocking socket to read from.
+   * @return the number of bytes moved, 0 at end of stream, or -1 and the error.
+   */
+  Api::SysCallSizeResult fill(int fd);
+
+  /**
+   * Moves data from the pipe into a socket.
+   * @param fd supplies the non-blocking socket to write to.
+   * @return the number of bytes moved, or -1 and the error.
+   */
+  Api::SysCallSizeResult drain(int fd);
+
+  /**
+   * Reads the data left in the pipe into a buffer, for when the rest of the stream is handled in
+   * user space.
+   */
+  void moveTo(Buffer::Instance& buffer);
+
+  uint64_t length() const { return length_; }
+  uint64_t capacity() const { return capacity_; }
+  bool full() const { return length_ >= capacity_; }
+
+private:
+  SplicePipe(int read_fd, int write_fd, uint64_t capacity);
+
+  const int read_fd_;
+  const int write_fd_;
+  const uint64_t capacity_;
+  uint64_t length_{};
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -5,7 +5,6 @@
 #include <cstdint>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <vector>
 
@@ -20,6 +19,7 @@
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
 #include "common/common/logger.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -128,7 +128,7 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config,
     allow_origin_.push_back(origin);
   }
   for (const auto& regex : config.allow_origin_regex()) {
-    allow_origin_regex_.push_back(RegexUtil::parseRegex(regex));
+    allow_origin_regex_.push_back(Regex::Utility::parseRegex(regex));
   }
   allow_methods_ = config.allow_methods();
   allow_headers_ = config.allow_headers();
@@ -827,7 +827,8 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::route::Route& route,
                                          Server::Configuration::FactoryContext& factory_context)
     : RouteEntryImplBase(vhost, route, factory_context),
-      regex_(RegexUtil::parseRegex(route.match().regex())), regex_str_(route.match().regex()) {}
+      regex_(Regex::Utility::parseRegex(route.match().regex())),
+      regex_str_(route.match().regex()) {}
 
 void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
                                             bool insert_envoy_original_path) const {
@@ -835,7 +836,7 @@ void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
   // TODO(yuval-k): This ASSERT can happen if the path was changed by a filter without clearing the
   // route cache. We should consider if ASSERT-ing is the desired behavior in this case.
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str())));
   std::string matched_path(path.c_str(), query_string_start);
 
   finalizePathHeader(headers, matched_path, insert_envoy_original_path);
@@ -846,7 +847,7 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
   if (RouteEntryImplBase::matchRoute(headers, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str()))) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -915,6 +916,25 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
     }
   }
 
+  if (routes_.size() >= MIN_INDEXED_ROUTES) {
+    auto route_index = std::make_unique<RouteMatchIndex>();
+    for (uint32_t i = 0; i < routes_.size(); ++i) {
+      const RouteEntryImplBase& route = *routes_[i];
+      switch (route.matchType()) {
+      case PathMatchType::Exact:
+        route_index->addExact(route.matcher(), route.caseSensitive(), i);
+        break;
+      case PathMatchType::Prefix:
+        route_index->addPrefix(route.matcher(), route.caseSensitive(), i);
+        break;
+      default:
+        route_index->addUnindexed(i);
+        break;
+      }
+    }
+    route_index_ = std::move(route_index);
+  }
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(VirtualClusterEntry(virtual_cluster));
   }
@@ -931,7 +951,7 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   }
 
   const std::string pattern = virtual_cluster.pattern();
-  pattern_ = RegexUtil::parseRegex(pattern);
+  pattern_ = Regex::Utility::parseRegex(pattern);
   name_ = virtual_cluster.name();
 }
 
@@ -1000,8 +1020,23 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
   }
 
   // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+  if (route_index_ == nullptr) {
+    for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
+      RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+      if (nullptr != route_entry) {
+        return route_entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // The index narrows the routes down to those whose path criterion can match. The remaining
+  // criteria are checked by the full match, in route table order, so the first matching route
+  // still wins.
+  RouteMatchIndex::CandidateVector candidates;
+  route_index_->candidates(headers.Path()->value().getStringView(), candidates);
+  for (const uint32_t i : candidates) {
+    RouteConstSharedPtr route_entry = routes_[i]->matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -1043,6 +1078,7 @@ RouteConstSharedPtr RouteMatcher::route(const Http::HeaderMap& headers,
 }
 
 const VirtualHostImpl::CatchAllVirtualCluster VirtualHostImpl::VIRTUAL_CLUSTER_CATCH_ALL;
+const size_t VirtualHostImpl::MIN_INDEXED_ROUTES = 8;
 const SslRedirector SslRedirectRoute::SSL_REDIRECTOR;
 const std::shared_ptr<const SslRedirectRoute> VirtualHostImpl::SSL_REDIRECT_ROUTE{
     new SslRedirectRoute()};
@@ -1053,7 +1089,7 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
     bool method_matches =
         !entry.method_ || headers.Method()->value().c_str() == entry.method_.value();
 
-    if (method_matches && std::regex_match(headers.Path()->value().c_str(), entry.pattern_)) {
+    if (method_matches && entry.pattern_->match(headers.Path()->value().getStringView())) {
       return &entry;
     }
   }
@@ -5,7 +5,6 @@
 #include <list>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -17,12 +16,14 @@
 #include "envoy/server/filter_config.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/regex.h"
 #include "common/config/metadata.h"
 #include "common/http/header_utility.h"
 #include "common/router/config_utility.h"
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/route_match_index.h"
 #include "common/router/router_ratelimit.h"
 
 #include "absl/types/optional.h"
@@ -99,7 +100,9 @@ public:
 
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; }
+  const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  }
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -126,7 +129,7 @@ private:
   const envoy::api::v2::route::CorsPolicy config_;
   Runtime::Loader& loader_;
   std::list<std::string> allow_origin_;
-  std::list<std::regex> allow_origin_regex_;
+  std::vector<Regex::CompiledMatcherPtr> allow_origin_regex_;
   std::string allow_methods_;
   std::string allow_headers_;
   std::string expose_headers_;
@@ -175,7 +178,7 @@ private:
     // Router::VirtualCluster
     const std::string& name() const override { return name_; }
 
-    std::regex pattern_;
+    Regex::CompiledMatcherPtr pattern_;
     absl::optional<std::string> method_;
     std::string name_;
   };
@@ -189,9 +192,12 @@ private:
 
   static const CatchAllVirtualCluster VIRTUAL_CLUSTER_CATCH_ALL;
   static const std::shared_ptr<const SslRedirectRoute> SSL_REDIRECT_ROUTE;
+  // Below this many routes a linear scan is cheaper than consulting the route match index.
+  static const size_t MIN_INDEXED_ROUTES;
 
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  std::unique_ptr<const RouteMatchIndex> route_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
@@ -359,6 +365,7 @@ public:
 
   bool matchRoute(const Http::HeaderMap& headers, uint64_t random_value) const;
   void validateClusters(Upstream::ClusterManager& cm) const;
+  bool caseSensitive() const { return case_sensitive_; }
 
   // Router::RouteEntry
   const std::string& clusterName() const override;
@@ -704,7 +711,7 @@ public:
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
 
 private:
-  const std::regex regex_;
+  const Regex::CompiledMatcherPtr regex_;
   const std::string regex_str_;
 };
 
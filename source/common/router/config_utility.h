@@ -2,7 +2,7 @@
 
 #include <inttypes.h>
 
-#include <regex>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -12,6 +12,7 @@
 #include "envoy/upstream/resource_manager.h"
 
 #include "common/common/empty_string.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/rds_json.h"
 #include "common/http/headers.h"
@@ -36,7 +37,7 @@ public:
     QueryParameterMatcher(const envoy::api::v2::route::QueryParameterMatcher& config)
         : name_(config.name()), value_(config.value()),
           is_regex_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, regex, false)),
-          regex_pattern_(is_regex_ ? RegexUtil::parseRegex(value_) : std::regex()) {}
+          regex_pattern_(is_regex_ ? Regex::Utility::parseRegex(value_) : nullptr) {}
 
     /**
      * Check if the query parameters for a request contain a match for this
@@ -50,7 +51,8 @@ public:
     const std::string name_;
     const std::string value_;
     const bool is_regex_;
-    const std::regex regex_pattern_;
+    // Shared so that QueryParameterMatcher stays copyable.
+    const std::shared_ptr<const Regex::CompiledMatcher> regex_pattern_;
   };
 
   /**
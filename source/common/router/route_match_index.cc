@@ -0,0 +1,107 @@
+#include "common/router/route_match_index.h"
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+void RouteMatchIndex::addExact(absl::string_view path, bool case_sensitive, uint32_t route_index) {
+  if (case_sensitive) {
+    exact_[std::string(path)].push_back(route_index);
+  } else {
+    exact_ignore_case_[absl::AsciiStrToLower(path)].push_back(route_index);
+  }
+}
+
+void RouteMatchIndex::addPrefix(absl::string_view prefix, bool case_sensitive,
+                                uint32_t route_index) {
+  if (case_sensitive) {
+    prefixes_.add(prefix, route_index);
+  } else {
+    prefixes_ignore_case_.add(absl::AsciiStrToLower(prefix), route_index);
+  }
+}
+
+void RouteMatchIndex::addUnindexed(uint32_t route_index) { unindexed_.push_back(route_index); }
+
+void RouteMatchIndex::candidates(absl::string_view path, CandidateVector& candidates) const {
+  candidates.clear();
+  candidates.insert(candidates.end(), unindexed_.begin(), unindexed_.end());
+  prefixes_.find(path, false, candidates);
+  if (!prefixes_ignore_case_.empty()) {
+    prefixes_ignore_case_.find(path, true, candidates);
+  }
+
+  // Exact path routes ignore the query string.
+  const absl::string_view path_section = path.substr(0, path.find('?'));
+  findExact(exact_, path_section, candidates);
+  if (!exact_ignore_case_.empty()) {
+    // Paths are almost always short enough for this to stay on the stack.
+    absl::InlinedVector<char, 256> lower(path_section.begin(), path_section.end());
+    for (char& c : lower) {
+      c = absl::ascii_tolower(c);
+    }
+    findExact(exact_ignore_case_, absl::string_view(lower.data(), lower.size()), candidates);
+  }
+
+  // Each route lives in exactly one structure, so sorting is enough to restore route table order.
+  std::sort(candidates.begin(), candidates.end());
+}
+
+void RouteMatchIndex::findExact(const ExactMap& map, absl::string_view path,
+                                CandidateVector& candidates) {
+  if (map.empty()) {
+    return;
+  }
+  const auto it = map.find(path);
+  if (it != map.end()) {
+    candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+  }
+}
+
+void RouteMatchIndex::PrefixTrie::add(absl::string_view prefix, uint32_t route_index) {
+  uint32_t node = 0;
+  for (const char c : prefix) {
+    uint32_t next = child(node, c);
+    if (next == 0) {
+      next = nodes_.size();
+      nodes_.emplace_back();
+      auto& children = nodes_[node].children_;
+      children.insert(std::lower_bound(children.begin(), children.end(),
+                                       std::make_pair(c, uint32_t(0))),
+                      std::make_pair(c, next));
+    }
+    node = next;
+  }
+  nodes_[node].routes_.push_back(route_index);
+}
+
+void RouteMatchIndex::PrefixTrie::find(absl::string_view path, bool ignore_case,
+                                       CandidateVector& candidates) const {
+  uint32_t node = 0;
+  for (size_t i = 0;; ++i) {
+    const auto& routes = nodes_[node].routes_;
+    candidates.insert(candidates.end(), routes.begin(), routes.end());
+    if (i == path.size()) {
+      return;
+    }
+    node = child(node, ignore_case ? absl::ascii_tolower(path[i]) : path[i]);
+    if (node == 0) {
+      return;
+    }
+  }
+}
+
+uint32_t RouteMatchIndex::PrefixTrie::child(uint32_t node, char c) const {
+  // The root is never a child, so 0 doubles as "not found".
+  const auto& children = nodes_[node].children_;
+  const auto it = std::lower_bound(
+      children.begin(), children.end(), c,
+      [](const std::pair<char, uint32_t>& entry, char value) { return entry.first < value; });
+  return it != children.end() && it->first == c ? it->second : 0;
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the path criteria of the routes of a single virtual host. Routes are identified by
+ * their position in the virtual host's route table. Exact path routes are kept in a hash table
+ * keyed by path and prefix routes in a trie, so that the set of routes whose path criterion can
+ * match a request is found in time proportional to the length of the path rather than the
+ * number of routes. Routes that cannot be indexed by path (e.g. regex routes) are always
+ * returned as candidates.
+ *
+ * The index only narrows the set of routes to evaluate. The caller must still run the full match
+ * (headers, query parameters, runtime, etc.) on each candidate in the order returned to preserve
+ * first-match semantics.
+ */
+class RouteMatchIndex {
+public:
+  typedef absl::InlinedVector<uint32_t, 16> CandidateVector;
+
+  /**
+   * Add a route matching the path (excluding the query string) exactly.
+   * @param path supplies the path to match.
+   * @param case_sensitive supplies whether the comparison is case sensitive.
+   * @param route_index supplies the position of the route in the route table.
+   */
+  void addExact(absl::string_view path, bool case_sensitive, uint32_t route_index);
+
+  /**
+   * Add a route matching any path starting with prefix.
+   * @param prefix supplies the prefix to match.
+   * @param case_sensitive supplies whether the comparison is case sensitive.
+   * @param route_index supplies the position of the route in the route table.
+   */
+  void addPrefix(absl::string_view prefix, bool case_sensitive, uint32_t route_index);
+
+  /**
+   * Add a route that must be evaluated for every request.
+   * @param route_index supplies the position of the route in the route table.
+   */
+  void addUnindexed(uint32_t route_index);
+
+  /**
+   * Find the routes whose path criterion may match a request path.
+   * @param path supplies the request path, including any query string.
+   * @param candidates is filled with the matching route positions in ascending order.
+   */
+  void candidates(absl::string_view path, CandidateVector& candidates) const;
+
+private:
+  /**
+   * Byte-wise trie over route prefixes. Nodes are stored in a flat vector and children are kept
+   * sorted by byte, which keeps the memory footprint proportional to the total prefix length.
+   */
+  class PrefixTrie {
+  public:
+    PrefixTrie() : nodes_(1) {}
+
+    void add(absl::string_view prefix, uint32_t route_index);
+    void find(absl::string_view path, bool ignore_case, CandidateVector& candidates) const;
+    bool empty() const { return nodes_.size() == 1 && nodes_[0].routes_.empty(); }
+
+  private:
+    struct Node {
+      std::vector<std::pair<char, uint32_t>> children_;
+      std::vector<uint32_t> routes_;
+    };
+
+    uint32_t child(uint32_t node, char c) const;
+
+    std::vector<Node> nodes_;
+  };
+
+  typedef absl::flat_hash_map<std::string, std::vector<uint32_t>> ExactMap;
+
+  static void findExact(const ExactMap& map, absl::string_view path, CandidateVector& candidates);
+
+  ExactMap exact_;
+  ExactMap exact_ignore_case_;
+  PrefixTrie prefixes_;
+  PrefixTrie prefixes_ignore_case_;
+  std::vector<uint32_t> unindexed_;
+};
+
+} // namespace Router
+} // namespace Envoy
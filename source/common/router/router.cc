@@ -801,49 +801,58 @@ void Filter::onUpstreamComplete() {
     upstream_request_->resetStream();
   }
 
-  if (config_.emit_dynamic_stats_ && !callbacks_->streamInfo().healthCheck() &&
+  if (!callbacks_->streamInfo().healthCheck() &&
       DateUtil::timePointValid(downstream_request_complete_time_)) {
     Event::Dispatcher& dispatcher = callbacks_->dispatcher();
-    std::chrono::milliseconds response_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-        dispatcher.timeSource().monotonicTime() - downstream_request_complete_time_);
+    const MonotonicTime now = dispatcher.timeSource().monotonicTime();
+    const MonotonicTime::duration elapsed = now - downstream_request_complete_time_;
+    std::chrono::milliseconds response_time =
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed);
 
+    // The peak EWMA load balancer and outlier latency ejection need response times whether or not
+    // dynamic stats are emitted.
     upstream_request_->upstream_host_->outlierDetector().putResponseTime(response_time);
+    upstream_request_->upstream_host_->putResponseTime(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed), now);
 
-    const Http::HeaderEntry* internal_request_header = downstream_headers_->EnvoyInternalRequest();
-    const bool internal_request =
-        internal_request_header && internal_request_header->value() == "true";
+    if (config_.emit_dynamic_stats_) {
+      const Http::HeaderEntry* internal_request_header =
+          downstream_headers_->EnvoyInternalRequest();
+      const bool internal_request =
+          internal_request_header && internal_request_header->value() == "true";
 
-    // TODO(mattklein123): Remove copy when G string compat issues are fixed.
-    const std::string zone_name = config_.local_info_.zoneName();
-
-    Http::CodeStats& code_stats = httpContext().codeStats();
-    Http::CodeStats::ResponseTimingInfo info{config_.scope_,
-                                             cluster_->statsScope(),
-                                             EMPTY_STRING,
-                                             response_time,
-                                             upstream_request_->upstream_canary_,
-                                             internal_request,
-                                             route_entry_->virtualHost().name(),
-                                             request_vcluster_ ? request_vcluster_->name()
-                                                               : EMPTY_STRING,
-                                             zone_name,
-                                             upstreamZone(upstream_request_->upstream_host_)};
-
-    code_stats.chargeResponseTiming(info);
+      // TODO(mattklein123): Remove copy when G string compat issues are fixed.
+      const std::string zone_name = config_.local_info_.zoneName();
 
-    if (!alt_stat_prefix_.empty()) {
+      Http::CodeStats& code_stats = httpContext().codeStats();
       Http::CodeStats::ResponseTimingInfo info{config_.scope_,
                                                cluster_->statsScope(),
-                                               alt_stat_prefix_,
+                                               EMPTY_STRING,
                                                response_time,
                                                upstream_request_->upstream_canary_,
                                                internal_request,
-                                               EMPTY_STRING,
-                                               EMPTY_STRING,
+                                               route_entry_->virtualHost().name(),
+                                               request_vcluster_ ? request_vcluster_->name()
+                                                                 : EMPTY_STRING,
                                                zone_name,
                                                upstreamZone(upstream_request_->upstream_host_)};
 
       code_stats.chargeResponseTiming(info);
+
+      if (!alt_stat_prefix_.empty()) {
+        Http::CodeStats::ResponseTimingInfo info{config_.scope_,
+                                                 cluster_->statsScope(),
+                                                 alt_stat_prefix_,
+                                                 response_time,
+                                                 upstream_request_->upstream_canary_,
+                                                 internal_request,
+                                                 EMPTY_STRING,
+                                                 EMPTY_STRING,
+                                                 zone_name,
+                                                 upstreamZone(upstream_request_->upstream_host_)};
+
+        code_stats.chargeResponseTiming(info);
+      }
     }
   }
 
@@ -7,31 +7,29 @@
 namespace Envoy {
 namespace Stats {
 
-HeapStatData::HeapStatData(absl::string_view key) {
-  StringUtil::strlcpy(name_, key.data(), key.size() + 1);
-}
+HeapStatData::HeapStatData(StatName stat_name) { stat_name.copyToStorage(symbol_storage_); }
 
-HeapStatDataAllocator::HeapStatDataAllocator() {}
+HeapStatDataAllocator::HeapStatDataAllocator(SymbolTable& symbol_table)
+    : StatDataAllocatorImpl(symbol_table) {}
 
 HeapStatDataAllocator::~HeapStatDataAllocator() { ASSERT(stats_.empty()); }
 
-HeapStatData* HeapStatDataAllocator::alloc(absl::string_view name) {
+HeapStatData* HeapStatDataAllocator::alloc(StatName name) {
   // Any expected truncation of name is done at the callsite. No truncation is
-  // required to use this allocator. Note that data must be freed by calling
-  // its free() method, and not by destruction, thus the more complex use of
-  // unique_ptr.
-  std::unique_ptr<HeapStatData, std::function<void(HeapStatData * d)>> data(
-      HeapStatData::alloc(name), [](HeapStatData* d) { d->free(); });
-  Thread::ReleasableLockGuard lock(mutex_);
-  auto ret = stats_.insert(data.get());
-  HeapStatData* existing_data = *ret.first;
-  lock.release();
-
-  if (ret.second) {
-    return data.release();
+  // required to use this allocator. Looking up the name before allocating
+  // avoids copying the name and bumping its symbols' reference counts in the
+  // common case where the stat already exists in another scope.
+  Thread::LockGuard lock(mutex_);
+  auto iter = stats_.find(name);
+  if (iter != stats_.end()) {
+    HeapStatData* existing_data = *iter;
+    ++existing_data->ref_count_;
+    return existing_data;
   }
-  ++existing_data->ref_count_;
-  return existing_data;
+
+  HeapStatData* data = HeapStatData::alloc(name, symbolTable());
+  stats_.insert(data);
+  return data;
 }
 
 void HeapStatDataAllocator::free(HeapStatData& data) {
@@ -46,16 +44,19 @@ void HeapStatDataAllocator::free(HeapStatData& data) {
     ASSERT(key_removed == 1);
   }
 
-  data.free();
+  data.free(symbolTable());
 }
 
-HeapStatData* HeapStatData::alloc(absl::string_view name) {
-  void* memory = ::malloc(sizeof(HeapStatData) + name.size() + 1);
+HeapStatData* HeapStatData::alloc(StatName stat_name, SymbolTable& symbol_table) {
+  void* memory = ::malloc(sizeof(HeapStatData) + stat_name.size());
   ASSERT(memory);
-  return new (memory) HeapStatData(name);
+  HeapStatData* data = new (memory) HeapStatData(stat_name);
+  symbol_table.incRefCount(data->statName());
+  return data;
 }
 
-void HeapStatData::free() {
+void HeapStatData::free(SymbolTable& symbol_table) {
+  symbol_table.free(statName());
   this->~HeapStatData();
   ::free(this); // matches malloc() call above.
 }
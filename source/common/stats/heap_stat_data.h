@@ -8,6 +8,7 @@
 #include "common/common/thread.h"
 #include "common/common/thread_annotations.h"
 #include "common/stats/stat_data_allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "absl/container/flat_hash_set.h"
 
@@ -16,34 +17,37 @@ namespace Stats {
 
 /**
  * This structure is an alternate backing store for both CounterImpl and GaugeImpl. It is designed
- * so that it can be allocated efficiently from the heap on demand.
+ * so that it can be allocated efficiently from the heap on demand. The name is stored inline as
+ * a StatName, so each token of it costs a byte or two rather than a copy of its characters.
  */
 struct HeapStatData {
   /**
-   * @returns absl::string_view the name as a string_view.
+   * @returns StatName the name of the stat.
    */
-  absl::string_view key() const { return name_; }
+  StatName statName() const { return StatName(symbol_storage_); }
 
   /**
-   * @returns std::string the name as a const char*.
+   * Allocates a HeapStatData holding a copy of stat_name, taking a reference to its symbols.
    */
-  const char* name() const { return name_; }
+  static HeapStatData* alloc(StatName stat_name, SymbolTable& symbol_table);
 
-  static HeapStatData* alloc(absl::string_view name);
-  void free();
+  /**
+   * Releases the symbols of the name and frees the memory.
+   */
+  void free(SymbolTable& symbol_table);
 
   std::atomic<uint64_t> value_{0};
   std::atomic<uint64_t> pending_increment_{0};
   std::atomic<uint16_t> flags_{0};
   std::atomic<uint16_t> ref_count_{1};
-  char name_[];
+  uint8_t symbol_storage_[];
 
 private:
   /**
    * You cannot construct/destruct a HeapStatData directly with new/delete as
    * it's variable-size. Use alloc()/free() methods above.
    */
-  explicit HeapStatData(absl::string_view name);
+  explicit HeapStatData(StatName stat_name);
   ~HeapStatData() {}
 };
 
@@ -53,33 +57,38 @@ private:
  */
 class HeapStatDataAllocator : public StatDataAllocatorImpl<HeapStatData> {
 public:
-  HeapStatDataAllocator();
+  explicit HeapStatDataAllocator(SymbolTable& symbol_table);
   ~HeapStatDataAllocator();
 
   // StatDataAllocatorImpl
-  HeapStatData* alloc(absl::string_view name) override;
+  HeapStatData* alloc(StatName name) override;
   void free(HeapStatData& data) override;
+  StatName statName(const HeapStatData& data) const override { return data.statName(); }
 
   // StatDataAllocator
   bool requiresBoundedStatNameSize() const override { return false; }
 
 private:
+  // The hasher and comparator are transparent, so that an existing HeapStatData can be found by
+  // StatName without first allocating one.
   struct HeapStatHash {
-    size_t operator()(const HeapStatData* a) const { return HashUtil::xxHash64(a->key()); }
+    using is_transparent = void;
+    size_t operator()(const HeapStatData* a) const { return a->statName().hash(); }
+    size_t operator()(StatName a) const { return a.hash(); }
   };
   struct HeapStatCompare {
+    using is_transparent = void;
     bool operator()(const HeapStatData* a, const HeapStatData* b) const {
-      return (a->key() == b->key());
+      return (a->statName() == b->statName());
     }
+    bool operator()(const HeapStatData* a, StatName b) const { return (a->statName() == b); }
+    bool operator()(StatName a, const HeapStatData* b) const { return (a == b->statName()); }
   };
 
-  // TODO(jmarantz): See https://github.com/envoyproxy/envoy/pull/3927 and
-  //  https://github.com/envoyproxy/envoy/issues/3585, which can help reorganize
-  // the heap stats using a ref-counted symbol table to compress the stat strings.
   using StatSet = absl::flat_hash_set<HeapStatData*, HeapStatHash, HeapStatCompare>;
 
-  // An unordered set of HeapStatData pointers which keys off the key()
-  // field in each object. This necessitates a custom comparator and hasher.
+  // An unordered set of HeapStatData pointers which keys off the statName()
+  // of each object. This necessitates a custom comparator and hasher.
   StatSet stats_ GUARDED_BY(mutex_);
   // A mutex is needed here to protect the stats_ object from both alloc() and free() operations.
   // Although alloc() operations are called under existing locking, free() operations are made from
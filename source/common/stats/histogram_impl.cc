@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <string>
 
+#include "envoy/common/exception.h"
+
 #include "common/common/utility.h"
 
 #include "absl/strings/str_join.h"
@@ -10,17 +12,51 @@
 namespace Envoy {
 namespace Stats {
 
-HistogramStatisticsImpl::HistogramStatisticsImpl(const histogram_t* histogram_ptr)
-    : computed_quantiles_(supportedQuantiles().size(), 0.0) {
+HistogramSettingsImpl::HistogramSettingsImpl(
+    const envoy::config::metrics::v2::StatsConfig& config) {
+  configs_.reserve(config.histogram_bucket_settings_size());
+  for (const auto& bucket_settings : config.histogram_bucket_settings()) {
+    std::vector<double> buckets{bucket_settings.buckets().begin(),
+                                bucket_settings.buckets().end()};
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      if (buckets[i] <= 0 || (i > 0 && buckets[i] <= buckets[i - 1])) {
+        throw EnvoyException(
+            fmt::format("histogram buckets must be positive and strictly increasing: [{}]",
+                        absl::StrJoin(buckets, ", ")));
+      }
+    }
+    configs_.emplace_back(Matchers::StringMatcher(bucket_settings.match()), std::move(buckets));
+  }
+}
+
+const std::vector<double>& HistogramSettingsImpl::buckets(absl::string_view stat_name) const {
+  for (const auto& config : configs_) {
+    if (config.first.match(stat_name)) {
+      return config.second;
+    }
+  }
+  return defaultBuckets();
+}
+
+const std::vector<double>& HistogramSettingsImpl::defaultBuckets() {
+  static const std::vector<double> default_buckets = {
+      0.5,  1,    5,     10,    25,    50,     100,    250,     500,    1000,
+      2500, 5000, 10000, 30000, 60000, 300000, 600000, 1800000, 3600000};
+  return default_buckets;
+}
+
+HistogramStatisticsImpl::HistogramStatisticsImpl(const histogram_t* histogram_ptr,
+                                                 const std::vector<double>& supported_buckets)
+    : computed_quantiles_(supportedQuantiles().size(), 0.0),
+      supported_buckets_(supported_buckets) {
   hist_approx_quantile(histogram_ptr, supportedQuantiles().data(), supportedQuantiles().size(),
                        computed_quantiles_.data());
 
   sample_count_ = hist_sample_count(histogram_ptr);
   sample_sum_ = hist_approx_sum(histogram_ptr);
 
-  const std::vector<double>& supported_buckets = supportedBuckets();
-  computed_buckets_.reserve(supported_buckets.size());
-  for (const auto bucket : supported_buckets) {
+  computed_buckets_.reserve(supported_buckets_.size());
+  for (const auto bucket : supported_buckets_) {
     computed_buckets_.emplace_back(hist_approx_count_below(histogram_ptr, bucket));
   }
 }
@@ -31,13 +67,6 @@ const std::vector<double>& HistogramStatisticsImpl::supportedQuantiles() const {
   return supported_quantiles;
 }
 
-const std::vector<double>& HistogramStatisticsImpl::supportedBuckets() const {
-  static const std::vector<double> supported_buckets = {
-      0.5,  1,    5,     10,    25,    50,     100,    250,     500,    1000,
-      2500, 5000, 10000, 30000, 60000, 300000, 600000, 1800000, 3600000};
-  return supported_buckets;
-}
-
 std::string HistogramStatisticsImpl::quantileSummary() const {
   std::vector<std::string> summary;
   const std::vector<double>& supported_quantiles = supportedQuantiles();
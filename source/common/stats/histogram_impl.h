@@ -3,30 +3,59 @@
 #include <cstdint>
 #include <string>
 
+#include "envoy/config/metrics/v2/stats.pb.h"
 #include "envoy/stats/histogram.h"
 #include "envoy/stats/stats.h"
 #include "envoy/stats/store.h"
 
+#include "common/common/matchers.h"
 #include "common/common/non_copyable.h"
 #include "common/stats/metric_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "circllhist.h"
 
 namespace Envoy {
 namespace Stats {
 
+/**
+ * Supplies histogram buckets from the histogram_bucket_settings of a StatsConfig, falling back to
+ * defaultBuckets() for histograms that match no setting.
+ */
+class HistogramSettingsImpl : public HistogramSettings {
+public:
+  HistogramSettingsImpl() {}
+  explicit HistogramSettingsImpl(const envoy::config::metrics::v2::StatsConfig& config);
+
+  // HistogramSettings
+  const std::vector<double>& buckets(absl::string_view stat_name) const override;
+
+  /**
+   * @return the buckets of histograms with no configured layout.
+   */
+  static const std::vector<double>& defaultBuckets();
+
+private:
+  std::vector<std::pair<Matchers::StringMatcher, std::vector<double>>> configs_;
+};
+
 /**
  * Implementation of HistogramStatistics for circllhist.
  */
 class HistogramStatisticsImpl : public HistogramStatistics, NonCopyable {
 public:
-  HistogramStatisticsImpl() : computed_quantiles_(supportedQuantiles().size(), 0.0) {}
+  HistogramStatisticsImpl()
+      : computed_quantiles_(supportedQuantiles().size(), 0.0),
+        supported_buckets_(HistogramSettingsImpl::defaultBuckets()) {}
   /**
    * HistogramStatisticsImpl object is constructed using the passed in histogram.
    * @param histogram_ptr pointer to the histogram for which stats will be calculated. This pointer
    * will not be retained.
+   * @param supported_buckets the bucket upper bounds for which counts are computed.
    */
-  HistogramStatisticsImpl(const histogram_t* histogram_ptr);
+  HistogramStatisticsImpl(
+      const histogram_t* histogram_ptr,
+      const std::vector<double>& supported_buckets = HistogramSettingsImpl::defaultBuckets());
 
   void refresh(const histogram_t* new_histogram_ptr);
 
@@ -35,13 +64,15 @@ public:
   std::string bucketSummary() const override;
   const std::vector<double>& supportedQuantiles() const override;
   const std::vector<double>& computedQuantiles() const override { return computed_quantiles_; }
-  const std::vector<double>& supportedBuckets() const override;
+  const std::vector<double>& supportedBuckets() const override { return supported_buckets_; }
   const std::vector<uint64_t>& computedBuckets() const override { return computed_buckets_; }
   double sampleCount() const override { return sample_count_; }
   double sampleSum() const override { return sample_sum_; }
 
 private:
   std::vector<double> computed_quantiles_;
+  // Copied, as the HistogramSettings that supplied the buckets may be replaced.
+  const std::vector<double> supported_buckets_;
   std::vector<uint64_t> computed_buckets_;
   double sample_count_;
   double sample_sum_;
@@ -52,40 +83,44 @@ private:
  */
 class HistogramImpl : public Histogram, public MetricImpl {
 public:
-  HistogramImpl(const std::string& name, Store& parent, std::string&& tag_extracted_name,
-                std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), parent_(parent), name_(name) {}
+  HistogramImpl(StatName name, Store& parent, absl::string_view tag_extracted_name,
+                const std::vector<Tag>& tags, SymbolTable& symbol_table)
+      : MetricImpl(tag_extracted_name, tags, symbol_table), parent_(parent),
+        name_(name, symbol_table), symbol_table_(symbol_table) {}
+  ~HistogramImpl() {
+    name_.free(symbol_table_);
+    MetricImpl::clear();
+  }
 
   // Stats:;Metric
-  std::string name() const override { return name_; }
-  const char* nameCStr() const override { return name_.c_str(); }
+  StatName statName() const override { return name_.statName(); }
 
   // Stats::Histogram
   void recordValue(uint64_t value) override { parent_.deliverHistogramToSinks(*this, value); }
 
   bool used() const override { return true; }
 
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return symbol_table_; }
+
 private:
   // This is used for delivering the histogram data to sinks.
   Store& parent_;
 
-  const std::string name_;
+  StatNameStorage name_;
+  SymbolTable& symbol_table_;
 };
 
 /**
  * Null histogram implementation.
  * No-ops on all calls and requires no underlying metric or data.
  */
-class NullHistogramImpl : public Histogram {
+class NullHistogramImpl : public Histogram, public NullMetricImpl {
 public:
   NullHistogramImpl() {}
   ~NullHistogramImpl() {}
-  std::string name() const override { return ""; }
-  const char* nameCStr() const override { return ""; }
-  const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
-  const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
   void recordValue(uint64_t) override {}
-  bool used() const override { return false; }
 };
 
 } // namespace Stats
@@ -13,18 +13,18 @@ namespace Envoy {
 namespace Stats {
 
 IsolatedStoreImpl::IsolatedStoreImpl()
-    : counters_([this](const std::string& name) -> CounterSharedPtr {
-        std::string tag_extracted_name = name;
-        std::vector<Tag> tags;
-        return alloc_.makeCounter(name, std::move(tag_extracted_name), std::move(tags));
+    : alloc_(symbol_table_), counters_([this](const std::string& name) -> CounterSharedPtr {
+        StatNameTempStorage stat_name(name, symbol_table_);
+        return alloc_.makeCounter(stat_name.statName(), name, std::vector<Tag>());
       }),
       gauges_([this](const std::string& name) -> GaugeSharedPtr {
-        std::string tag_extracted_name = name;
-        std::vector<Tag> tags;
-        return alloc_.makeGauge(name, std::move(tag_extracted_name), std::move(tags));
+        StatNameTempStorage stat_name(name, symbol_table_);
+        return alloc_.makeGauge(stat_name.statName(), name, std::vector<Tag>());
       }),
       histograms_([this](const std::string& name) -> HistogramSharedPtr {
-        return std::make_shared<HistogramImpl>(name, *this, std::string(name), std::vector<Tag>());
+        StatNameTempStorage stat_name(name, symbol_table_);
+        return std::make_shared<HistogramImpl>(stat_name.statName(), *this, name,
+                                               std::vector<Tag>(), symbol_table_);
       }) {}
 
 struct IsolatedScopeImpl : public Scope {
@@ -12,8 +12,11 @@
 #include "common/common/utility.h"
 #include "common/stats/heap_stat_data.h"
 #include "common/stats/stats_options_impl.h"
+#include "common/stats/symbol_table_impl.h"
 #include "common/stats/utility.h"
 
+#include "absl/strings/match.h"
+
 namespace Envoy {
 namespace Stats {
 
@@ -47,6 +50,17 @@ public:
     return vec;
   }
 
+  std::vector<std::shared_ptr<Base>> toVector(absl::string_view prefix) const {
+    std::vector<std::shared_ptr<Base>> vec;
+    for (auto& stat : stats_) {
+      if (absl::StartsWith(stat.first, prefix)) {
+        vec.push_back(stat.second);
+      }
+    }
+
+    return vec;
+  }
+
 private:
   std::unordered_map<std::string, std::shared_ptr<Base>> stats_;
   Allocator alloc_;
@@ -73,8 +87,18 @@ public:
   std::vector<ParentHistogramSharedPtr> histograms() const override {
     return std::vector<ParentHistogramSharedPtr>{};
   }
+  std::vector<CounterSharedPtr> countersWithPrefix(absl::string_view prefix) const override {
+    return counters_.toVector(prefix);
+  }
+  std::vector<GaugeSharedPtr> gaugesWithPrefix(absl::string_view prefix) const override {
+    return gauges_.toVector(prefix);
+  }
+  std::vector<ParentHistogramSharedPtr> histogramsWithPrefix(absl::string_view) const override {
+    return std::vector<ParentHistogramSharedPtr>{};
+  }
 
 private:
+  SymbolTableImpl symbol_table_;
   HeapStatDataAllocator alloc_;
   IsolatedStatsCache<Counter> counters_;
   IsolatedStatsCache<Gauge> gauges_;
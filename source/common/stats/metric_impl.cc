@@ -0,0 +1,49 @@
+#include "common/stats/metric_impl.h"
+
+#include "envoy/stats/tag.h"
+
+namespace Envoy {
+namespace Stats {
+
+MetricImpl::MetricImpl(absl::string_view tag_extracted_name, const std::vector<Tag>& tags,
+                       SymbolTable& symbol_table) {
+  std::vector<absl::string_view> names;
+  names.reserve(1 + 2 * tags.size());
+  names.push_back(tag_extracted_name);
+  for (const Tag& tag : tags) {
+    names.push_back(tag.name_);
+    names.push_back(tag.value_);
+  }
+  stat_names_.populate(names, symbol_table);
+}
+
+std::string MetricImpl::tagExtractedName() const {
+  std::string tag_extracted_name;
+  stat_names_.iterate([this, &tag_extracted_name](StatName stat_name) -> bool {
+    tag_extracted_name = symbolTable().toString(stat_name);
+    return false; // The tag-extracted name is the first in the list.
+  });
+  return tag_extracted_name;
+}
+
+std::vector<Tag> MetricImpl::tags() const {
+  std::vector<Tag> tags;
+  uint32_t index = 0;
+  stat_names_.iterate([this, &tags, &index](StatName stat_name) -> bool {
+    // The tag-extracted name at index 0 is followed by alternating tag names and values.
+    if (index > 0) {
+      if (index % 2 == 1) {
+        tags.emplace_back();
+        tags.back().name_ = symbolTable().toString(stat_name);
+      } else {
+        tags.back().value_ = symbolTable().toString(stat_name);
+      }
+    }
+    ++index;
+    return true;
+  });
+  return tags;
+}
+
+} // namespace Stats
+} // namespace Envoy
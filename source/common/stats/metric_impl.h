@@ -4,9 +4,13 @@
 #include <vector>
 
 #include "envoy/stats/stats.h"
+#include "envoy/stats/symbol_table.h"
 #include "envoy/stats/tag.h"
 
 #include "common/common/assert.h"
+#include "common/stats/symbol_table_impl.h"
+
+#include "absl/strings/string_view.h"
 
 namespace Envoy {
 namespace Stats {
@@ -15,16 +19,23 @@ namespace Stats {
  * Implementation of the Metric interface. Virtual inheritance is used because the interfaces that
  * will inherit from Metric will have other base classes that will also inherit from Metric.
  *
- * MetricImpl is not meant to be instantiated as-is. For performance reasons we keep name() virtual
- * and expect child classes to implement it.
+ * MetricImpl is not meant to be instantiated as-is. For performance reasons we keep statName()
+ * virtual and expect child classes to implement it, along with symbolTable().
+ *
+ * The tag-extracted name and the tags are encoded into a single StatNameList, so that the
+ * tokens they share with other stats, such as cluster names, are stored once in the SymbolTable.
+ * To avoid holding a SymbolTable& in every metric, child classes must call clear() from their
+ * destructors.
  */
 class MetricImpl : public virtual Metric {
 public:
-  MetricImpl(std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : tag_extracted_name_(std::move(tag_extracted_name)), tags_(std::move(tags)) {}
+  MetricImpl(absl::string_view tag_extracted_name, const std::vector<Tag>& tags,
+             SymbolTable& symbol_table);
 
-  const std::string& tagExtractedName() const override { return tag_extracted_name_; }
-  const std::vector<Tag>& tags() const override { return tags_; }
+  // Stats::Metric
+  std::string name() const override { return symbolTable().toString(statName()); }
+  std::string tagExtractedName() const override;
+  std::vector<Tag> tags() const override;
 
 protected:
   /**
@@ -34,9 +45,38 @@ protected:
     static const uint8_t Used = 0x1;
   };
 
+  /**
+   * @return SymbolTable& the symbol table in which this metric's names are encoded.
+   */
+  virtual SymbolTable& symbolTable() const PURE;
+
+  /**
+   * Releases the symbols held for the tag-extracted name and tags. This must be called before
+   * destruction, while symbolTable() is still available.
+   */
+  void clear() { stat_names_.clear(symbolTable()); }
+
+private:
+  // The tag-extracted name, followed by the name and value of each tag.
+  StatNameList stat_names_;
+};
+
+/**
+ * Partial implementation of the Metric interface for null stats, which have no name and record
+ * nothing.
+ */
+class NullMetricImpl : public virtual Metric {
+public:
+  // Stats::Metric
+  std::string name() const override { return ""; }
+  StatName statName() const override { return StatName(empty_stat_name_); }
+  std::string tagExtractedName() const override { return ""; }
+  std::vector<Tag> tags() const override { return {}; }
+  bool used() const override { return false; }
+
 private:
-  const std::string tag_extracted_name_;
-  const std::vector<Tag> tags_;
+  // The encoding of the empty stat name: a zero length, with no symbols.
+  const uint8_t empty_stat_name_[StatNameSizeEncodingBytes] = {0, 0};
 };
 
 } // namespace Stats
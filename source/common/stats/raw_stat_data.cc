@@ -43,31 +43,63 @@ void RawStatData::initialize(absl::string_view key, const StatsOptions& stats_op
   name_[key.size()] = '\0';
 }
 
+RawStatDataAllocator::~RawStatDataAllocator() {
+  Thread::LockGuard lock(names_mutex_);
+  ASSERT(names_.empty());
+}
+
+Stats::RawStatData* RawStatDataAllocator::alloc(StatName name) {
+  return alloc(symbolTable().toString(name));
+}
+
 Stats::RawStatData* RawStatDataAllocator::alloc(absl::string_view name) {
   // Try to find the existing slot in shared memory, otherwise allocate a new one.
-  Thread::LockGuard lock(mutex_);
-  if (name.length() > options_.maxNameLength()) {
-    ENVOY_LOG_MISC(
-        warn,
-        "Statistic '{}' is too long with {} characters, it will be truncated to {} characters",
-        name, name.size(), options_.maxNameLength());
-    name = name.substr(0, options_.maxNameLength());
-  }
-  auto value_created = stats_set_.insert(name);
-  Stats::RawStatData* data = value_created.first;
-  if (data == nullptr) {
-    return nullptr;
+  Stats::RawStatData* data;
+  {
+    Thread::LockGuard lock(mutex_);
+    if (name.length() > options_.maxNameLength()) {
+      ENVOY_LOG_MISC(
+          warn,
+          "Statistic '{}' is too long with {} characters, it will be truncated to {} characters",
+          name, name.size(), options_.maxNameLength());
+      name = name.substr(0, options_.maxNameLength());
+    }
+    auto value_created = stats_set_.insert(name);
+    data = value_created.first;
+    if (data == nullptr) {
+      return nullptr;
+    }
+    // For new entries (value-created.second==true), BlockMemoryHashSet calls Value::initialize()
+    // automatically, but on recycled entries (value-created.second==false) we need to bump the
+    // ref-count.
+    if (!value_created.second) {
+      ++data->ref_count_;
+    }
   }
-  // For new entries (value-created.second==true), BlockMemoryHashSet calls Value::initialize()
-  // automatically, but on recycled entries (value-created.second==false) we need to bump the
-  // ref-count.
-  if (!value_created.second) {
-    ++data->ref_count_;
+
+  // The data may have been created by another process, so it is the first reference in this
+  // process, rather than its creation, that encodes the name.
+  Thread::LockGuard lock(names_mutex_);
+  auto iter = names_.find(data);
+  if (iter != names_.end()) {
+    ++iter->second.ref_count_;
+  } else {
+    names_.emplace(data, EncodedName(StatNameStorage(name, symbolTable())));
   }
   return data;
 }
 
 void RawStatDataAllocator::free(Stats::RawStatData& data) {
+  {
+    Thread::LockGuard lock(names_mutex_);
+    auto iter = names_.find(&data);
+    ASSERT(iter != names_.end());
+    if (--iter->second.ref_count_ == 0) {
+      iter->second.storage_.free(symbolTable());
+      names_.erase(iter);
+    }
+  }
+
   // We must hold the lock since the reference decrement can race with an initialize above.
   Thread::LockGuard lock(mutex_);
   ASSERT(data.ref_count_ > 0);
@@ -80,6 +112,13 @@ void RawStatDataAllocator::free(Stats::RawStatData& data) {
   memset(static_cast<void*>(&data), 0, Stats::RawStatData::structSizeWithOptions(options_));
 }
 
+StatName RawStatDataAllocator::statName(const RawStatData& data) const {
+  Thread::LockGuard lock(names_mutex_);
+  auto iter = names_.find(&data);
+  ASSERT(iter != names_.end());
+  return iter->second.storage_.statName();
+}
+
 template class StatDataAllocatorImpl<RawStatData>;
 
 } // namespace Stats
@@ -19,7 +19,9 @@
 #include "common/common/hash.h"
 #include "common/common/thread.h"
 #include "common/stats/stat_data_allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -94,21 +96,51 @@ struct RawStatData {
 
 using RawStatDataSet = BlockMemoryHashSet<Stats::RawStatData>;
 
+/**
+ * Implementation of StatDataAllocator that allocates stats from a BlockMemoryHashSet, which may
+ * be shared with other processes for hot restart. Names are stored in RawStatData as characters,
+ * as the symbols of a SymbolTable are private to a process; each stat's name is additionally
+ * encoded into the process's SymbolTable so it can be returned as a StatName.
+ */
 class RawStatDataAllocator : public StatDataAllocatorImpl<RawStatData> {
 public:
   RawStatDataAllocator(Thread::BasicLockable& mutex, RawStatDataSet& stats_set,
-                       const StatsOptions& options)
-      : mutex_(mutex), stats_set_(stats_set), options_(options) {}
+                       const StatsOptions& options, SymbolTable& symbol_table)
+      : StatDataAllocatorImpl(symbol_table), mutex_(mutex), stats_set_(stats_set),
+        options_(options) {}
+  ~RawStatDataAllocator();
+
+  /**
+   * Same as alloc(StatName), but for a name that has not been encoded.
+   * @param name the full name of the stat, which is truncated if it is too long.
+   * @return RawStatData* the data for the name, or nullptr if there is no more memory available.
+   */
+  virtual RawStatData* alloc(absl::string_view name);
 
   // StatDataAllocator
   bool requiresBoundedStatNameSize() const override { return true; }
-  Stats::RawStatData* alloc(absl::string_view name) override;
-  void free(Stats::RawStatData& data) override;
+
+  // StatDataAllocatorImpl
+  RawStatData* alloc(StatName name) override;
+  void free(RawStatData& data) override;
+  StatName statName(const RawStatData& data) const override;
 
 private:
+  // The process-local encoding of a RawStatData's name, which is referenced by each
+  // RawStatData returned from alloc() in this process. The RawStatData's own ref_count_ can't be
+  // used to release it, as it also counts references from other processes.
+  struct EncodedName {
+    EncodedName(StatNameStorage&& storage) : storage_(std::move(storage)) {}
+
+    StatNameStorage storage_;
+    uint64_t ref_count_{1};
+  };
+
   Thread::BasicLockable& mutex_;
   RawStatDataSet& stats_set_ GUARDED_BY(mutex_);
   const StatsOptions& options_;
+  mutable Thread::MutexBasicLockable names_mutex_;
+  absl::flat_hash_map<const RawStatData*, EncodedName> names_ GUARDED_BY(names_mutex_);
 };
 
 } // namespace Stats
@@ -8,6 +8,7 @@
 
 #include "common/common/assert.h"
 #include "common/stats/metric_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "absl/strings/string_view.h"
 
@@ -29,20 +30,24 @@ namespace Stats {
 // available. This could be resolved with placed new, or another nesting level.
 template <class StatData> class StatDataAllocatorImpl : public StatDataAllocator {
 public:
+  explicit StatDataAllocatorImpl(SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
+
   // StatDataAllocator
-  CounterSharedPtr makeCounter(absl::string_view name, std::string&& tag_extracted_name,
-                               std::vector<Tag>&& tags) override;
-  GaugeSharedPtr makeGauge(absl::string_view name, std::string&& tag_extracted_name,
-                           std::vector<Tag>&& tags) override;
+  CounterSharedPtr makeCounter(StatName name, absl::string_view tag_extracted_name,
+                               const std::vector<Tag>& tags) override;
+  GaugeSharedPtr makeGauge(StatName name, absl::string_view tag_extracted_name,
+                           const std::vector<Tag>& tags) override;
+  SymbolTable& symbolTable() override { return symbol_table_; }
+  const SymbolTable& symbolTable() const override { return symbol_table_; }
 
   /**
-   * @param name the full name of the stat.
+   * @param name the full name of the stat, encoded in symbolTable().
    * @return StatData* a data block for a given stat name or nullptr if there is no more memory
    *         available for stats. The allocator should return a reference counted data location
    *         by name if one already exists with the same name. This is used for intra-process
    *         scope swapping as well as inter-process hot restart.
    */
-  virtual StatData* alloc(absl::string_view name) PURE;
+  virtual StatData* alloc(StatName name) PURE;
 
   /**
    * Free a raw stat data block. The allocator should handle reference counting and only truly
@@ -50,6 +55,16 @@ public:
    * @param data the data returned by alloc().
    */
   virtual void free(StatData& data) PURE;
+
+  /**
+   * @param data the data returned by alloc().
+   * @return StatName the name of the stat, encoded in symbolTable(). This remains valid until
+   *         data is freed. Stats call this once, when they are made.
+   */
+  virtual StatName statName(const StatData& data) const PURE;
+
+private:
+  SymbolTable& symbol_table_;
 };
 
 /**
@@ -62,13 +77,16 @@ public:
 template <class StatData> class CounterImpl : public Counter, public MetricImpl {
 public:
   CounterImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
-              std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), data_(data), alloc_(alloc) {}
-  ~CounterImpl() { alloc_.free(data_); }
+              absl::string_view tag_extracted_name, const std::vector<Tag>& tags)
+      : MetricImpl(tag_extracted_name, tags, alloc.symbolTable()), data_(data), alloc_(alloc),
+        stat_name_(alloc.statName(data)) {}
+  ~CounterImpl() {
+    alloc_.free(data_);
+    MetricImpl::clear();
+  }
 
   // Stats::Metric
-  std::string name() const override { return std::string(data_.name()); }
-  const char* nameCStr() const override { return data_.name(); }
+  StatName statName() const override { return stat_name_; }
 
   // Stats::Counter
   void add(uint64_t amount) override {
@@ -83,28 +101,29 @@ public:
   bool used() const override { return data_.flags_ & Flags::Used; }
   uint64_t value() const override { return data_.value_; }
 
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return alloc_.symbolTable(); }
+
 private:
   StatData& data_;
   StatDataAllocatorImpl<StatData>& alloc_;
+  // Looked up once, as the allocator may need a lock to find it.
+  const StatName stat_name_;
 };
 
 /**
  * Null counter implementation.
  * No-ops on all calls and requires no underlying metric or data.
  */
-class NullCounterImpl : public Counter {
+class NullCounterImpl : public Counter, public NullMetricImpl {
 public:
   NullCounterImpl() {}
   ~NullCounterImpl() {}
-  std::string name() const override { return ""; }
-  const char* nameCStr() const override { return ""; }
-  const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
-  const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
   void add(uint64_t) override {}
   void inc() override {}
   uint64_t latch() override { return 0; }
   void reset() override {}
-  bool used() const override { return false; }
   uint64_t value() const override { return 0; }
 };
 
@@ -114,13 +133,16 @@ public:
 template <class StatData> class GaugeImpl : public Gauge, public MetricImpl {
 public:
   GaugeImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
-            std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(std::move(tag_extracted_name), std::move(tags)), data_(data), alloc_(alloc) {}
-  ~GaugeImpl() { alloc_.free(data_); }
+            absl::string_view tag_extracted_name, const std::vector<Tag>& tags)
+      : MetricImpl(tag_extracted_name, tags, alloc.symbolTable()), data_(data), alloc_(alloc),
+        stat_name_(alloc.statName(data)) {}
+  ~GaugeImpl() {
+    alloc_.free(data_);
+    MetricImpl::clear();
+  }
 
   // Stats::Metric
-  std::string name() const override { return std::string(data_.name()); }
-  const char* nameCStr() const override { return data_.name(); }
+  StatName statName() const override { return stat_name_; }
 
   // Stats::Gauge
   virtual void add(uint64_t amount) override {
@@ -141,54 +163,53 @@ public:
   virtual uint64_t value() const override { return data_.value_; }
   bool used() const override { return data_.flags_ & Flags::Used; }
 
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return alloc_.symbolTable(); }
+
 private:
   StatData& data_;
   StatDataAllocatorImpl<StatData>& alloc_;
+  // Looked up once, as the allocator may need a lock to find it.
+  const StatName stat_name_;
 };
 
 /**
  * Null gauge implementation.
  * No-ops on all calls and requires no underlying metric or data.
  */
-class NullGaugeImpl : public Gauge {
+class NullGaugeImpl : public Gauge, public NullMetricImpl {
 public:
   NullGaugeImpl() {}
   ~NullGaugeImpl() {}
-  std::string name() const override { return ""; }
-  const char* nameCStr() const override { return ""; }
-  const std::string& tagExtractedName() const override { CONSTRUCT_ON_FIRST_USE(std::string, ""); }
-  const std::vector<Tag>& tags() const override { CONSTRUCT_ON_FIRST_USE(std::vector<Tag>, {}); }
   void add(uint64_t) override {}
   void inc() override {}
   void dec() override {}
   void set(uint64_t) override {}
   void sub(uint64_t) override {}
-  bool used() const override { return false; }
   uint64_t value() const override { return 0; }
 };
 
 template <class StatData>
-CounterSharedPtr StatDataAllocatorImpl<StatData>::makeCounter(absl::string_view name,
-                                                              std::string&& tag_extracted_name,
-                                                              std::vector<Tag>&& tags) {
+CounterSharedPtr StatDataAllocatorImpl<StatData>::makeCounter(StatName name,
+                                                              absl::string_view tag_extracted_name,
+                                                              const std::vector<Tag>& tags) {
   StatData* data = alloc(name);
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<CounterImpl<StatData>>(*data, *this, std::move(tag_extracted_name),
-                                                 std::move(tags));
+  return std::make_shared<CounterImpl<StatData>>(*data, *this, tag_extracted_name, tags);
 }
 
 template <class StatData>
-GaugeSharedPtr StatDataAllocatorImpl<StatData>::makeGauge(absl::string_view name,
-                                                          std::string&& tag_extracted_name,
-                                                          std::vector<Tag>&& tags) {
+GaugeSharedPtr StatDataAllocatorImpl<StatData>::makeGauge(StatName name,
+                                                          absl::string_view tag_extracted_name,
+                                                          const std::vector<Tag>& tags) {
   StatData* data = alloc(name);
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<GaugeImpl<StatData>>(*data, *this, std::move(tag_extracted_name),
-                                               std::move(tags));
+  return std::make_shared<GaugeImpl<StatData>>(*data, *this, tag_extracted_name, tags);
 }
 
 } // namespace Stats
@@ -139,7 +139,7 @@ SymbolEncoding SymbolTableImpl::encode(const absl::string_view name) {
   // Now take the lock and populate the Symbol objects, which involves bumping
   // ref-counts in this.
   {
-    Thread::LockGuard lock(lock_);
+    absl::MutexLock lock(&lock_);
     for (auto& token : tokens) {
       symbols.push_back(toSymbol(token));
     }
@@ -153,7 +153,7 @@ SymbolEncoding SymbolTableImpl::encode(const absl::string_view name) {
 }
 
 uint64_t SymbolTableImpl::numSymbols() const {
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   ASSERT(encode_map_.size() == decode_map_.size());
   return encode_map_.size();
 }
@@ -167,7 +167,7 @@ std::string SymbolTableImpl::decodeSymbolVec(const SymbolVec& symbols) const {
   name_tokens.reserve(symbols.size());
   {
     // Hold the lock only while decoding symbols.
-    Thread::LockGuard lock(lock_);
+    absl::ReaderMutexLock lock(&lock_);
     for (Symbol symbol : symbols) {
       name_tokens.push_back(fromSymbol(symbol));
     }
@@ -179,7 +179,7 @@ void SymbolTableImpl::incRefCount(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   SymbolVec symbols = SymbolEncoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
+  absl::MutexLock lock(&lock_);
   for (Symbol symbol : symbols) {
     auto decode_search = decode_map_.find(symbol);
     ASSERT(decode_search != decode_map_.end());
@@ -195,7 +195,7 @@ void SymbolTableImpl::free(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   SymbolVec symbols = SymbolEncoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
+  absl::MutexLock lock(&lock_);
   for (Symbol symbol : symbols) {
     auto decode_search = decode_map_.find(symbol);
     ASSERT(decode_search != decode_map_.end());
@@ -243,7 +243,7 @@ Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
 }
 
 absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const
-    EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    SHARED_LOCKS_REQUIRED(lock_) {
   auto search = decode_map_.find(symbol);
   RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
   return {*search->second};
@@ -270,7 +270,7 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
   // Calling fromSymbol requires holding the lock, as it needs read-access to
   // the maps that are written when adding new symbols.
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   for (uint64_t i = 0, n = std::min(av.size(), bv.size()); i < n; ++i) {
     if (av[i] != bv[i]) {
       bool ret = fromSymbol(av[i]) < fromSymbol(bv[i]);
@@ -282,7 +282,7 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTableImpl::debugPrint() const {
-  Thread::LockGuard lock(lock_);
+  absl::ReaderMutexLock lock(&lock_);
   std::vector<Symbol> symbols;
   for (const auto& p : decode_map_) {
     symbols.push_back(p.first);
@@ -13,14 +13,14 @@
 
 #include "common/common/assert.h"
 #include "common/common/hash.h"
-#include "common/common/lock_guard.h"
 #include "common/common/non_copyable.h"
-#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/common/utility.h"
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 
 namespace Envoy {
 namespace Stats {
@@ -157,8 +157,10 @@ private:
     uint32_t ref_count_;
   };
 
-  // This must be called during both encode() and free().
-  mutable Thread::MutexBasicLockable lock_;
+  // This must be held exclusively during both encode() and free(). Decoding only reads the maps,
+  // so it holds the lock shared, and the decoding of names, such as by Metric::name() when stats
+  // are flushed or listed, does not serialize threads against each other.
+  mutable absl::Mutex lock_;
 
   /**
    * Decodes a vector of symbols back into its period-delimited stat name. If
@@ -185,13 +187,13 @@ private:
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const SHARED_LOCKS_REQUIRED(lock_);
 
   // Stages a new symbol for use. To be called after a successful insertion.
   void newSymbol();
 
   Symbol monotonicCounter() {
-    Thread::LockGuard lock(lock_);
+    absl::MutexLock lock(&lock_);
     return monotonic_counter_;
   }
 
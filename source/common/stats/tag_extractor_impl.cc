@@ -2,15 +2,18 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <string>
 
 #include "envoy/common/exception.h"
 
+#include "common/common/assert.h"
 #include "common/common/perf_annotation.h"
 #include "common/common/utility.h"
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_split.h"
 
 namespace Envoy {
 namespace Stats {
@@ -103,5 +106,141 @@ bool TagExtractorImpl::extractTag(const std::string& stat_name, std::vector<Tag>
   return false;
 }
 
+TokenizedStatName::TokenizedStatName(absl::string_view name)
+    : name_(name), tokens_(absl::StrSplit(name, '.')) {}
+
+TagExtractorTokensImpl::TagExtractorTokensImpl(const std::string& name,
+                                               const std::string& pattern)
+    : name_(name) {
+  if (name.empty()) {
+    throw EnvoyException("tag_name cannot be empty");
+  }
+
+  uint32_t num_captures = 0;
+  for (absl::string_view element : absl::StrSplit(pattern, '.')) {
+    if (element == "*") {
+      elements_.push_back({ElementType::Any, {}});
+    } else if (element == "**") {
+      elements_.push_back({ElementType::AnyRun, {}});
+    } else if (element == "#") {
+      elements_.push_back({ElementType::Word, {}});
+    } else if (element == "$") {
+      elements_.push_back({ElementType::Value, {}});
+      ++num_captures;
+    } else if (element == "$$") {
+      elements_.push_back({ElementType::ValueRun, {}});
+      ++num_captures;
+    } else {
+      elements_.push_back({ElementType::Literal, absl::StrSplit(element, '|')});
+    }
+  }
+
+  const Element& front = elements_.front();
+  if (front.type_ != ElementType::Literal || front.literals_.size() != 1 ||
+      front.literals_[0].empty()) {
+    throw EnvoyException(
+        fmt::format("Tag pattern '{}' for '{}' must start with a literal token", pattern, name));
+  }
+  if (num_captures != 1) {
+    throw EnvoyException(
+        fmt::format("Tag pattern '{}' for '{}' must capture exactly one value", pattern, name));
+  }
+  prefix_ = front.literals_[0];
+}
+
+bool TagExtractorTokensImpl::isWord(absl::string_view token) {
+  if (token.empty()) {
+    return false;
+  }
+  for (const char c : token) {
+    if (!absl::ascii_isalnum(c) && c != '_') {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TagExtractorTokensImpl::match(size_t element, size_t token,
+                                   const TokenizedStatName::TokenVector& tokens,
+                                   size_t& value_begin, size_t& value_end) const {
+  if (element == elements_.size()) {
+    return token == tokens.size();
+  }
+
+  const Element& e = elements_[element];
+  switch (e.type_) {
+  case ElementType::Literal:
+    return token < tokens.size() &&
+           std::find(e.literals_.begin(), e.literals_.end(), tokens[token]) != e.literals_.end() &&
+           match(element + 1, token + 1, tokens, value_begin, value_end);
+  case ElementType::Any:
+    return token < tokens.size() && match(element + 1, token + 1, tokens, value_begin, value_end);
+  case ElementType::Word:
+    return token < tokens.size() && isWord(tokens[token]) &&
+           match(element + 1, token + 1, tokens, value_begin, value_end);
+  case ElementType::Value:
+    if (token < tokens.size() && match(element + 1, token + 1, tokens, value_begin, value_end)) {
+      value_begin = token;
+      value_end = token + 1;
+      return true;
+    }
+    return false;
+  case ElementType::AnyRun:
+    for (size_t end = token; end <= tokens.size(); ++end) {
+      if (match(element + 1, end, tokens, value_begin, value_end)) {
+        return true;
+      }
+    }
+    return false;
+  case ElementType::ValueRun:
+    for (size_t end = token + 1; end <= tokens.size(); ++end) {
+      if (match(element + 1, end, tokens, value_begin, value_end)) {
+        value_begin = token;
+        value_end = end;
+        return true;
+      }
+    }
+    return false;
+  }
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+bool TagExtractorTokensImpl::extractTag(const std::string& stat_name, std::vector<Tag>& tags,
+                                        IntervalSet<size_t>& remove_characters) const {
+  return extractTag(TokenizedStatName(stat_name), tags, remove_characters);
+}
+
+bool TagExtractorTokensImpl::extractTag(const TokenizedStatName& stat_name,
+                                        std::vector<Tag>& tags,
+                                        IntervalSet<size_t>& remove_characters) const {
+  PERF_OPERATION(perf);
+
+  const TokenizedStatName::TokenVector& tokens = stat_name.tokens();
+  size_t value_begin;
+  size_t value_end;
+  if (tokens[0] != prefix_ || !match(1, 1, tokens, value_begin, value_end)) {
+    PERF_RECORD(perf, "tokens-miss", name_);
+    return false;
+  }
+
+  const size_t start = stat_name.offset(value_begin);
+  const size_t end = stat_name.offset(value_end - 1) + tokens[value_end - 1].size();
+
+  tags.emplace_back();
+  Tag& tag = tags.back();
+  tag.name_ = name_;
+  tag.value_ = std::string(stat_name.name().substr(start, end - start));
+
+  // Remove the '.' that separates the value from the rest of the name, keeping the name's other
+  // tokens separated. The first token is always the literal prefix, so start > 0.
+  if (value_end < tokens.size()) {
+    remove_characters.insert(start, end + 1);
+  } else {
+    remove_characters.insert(start - 1, end);
+  }
+  PERF_RECORD(perf, "tokens-match", name_);
+  return true;
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -1,11 +1,13 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <regex>
 #include <string>
 
 #include "envoy/stats/tag_extractor.h"
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -53,5 +55,105 @@ private:
   const std::regex regex_;
 };
 
+/**
+ * A stat name split into its '.'-separated tokens, which are the same tokens SymbolTable encodes
+ * as symbols. The tokens refer to the storage of the name, which must outlive this object.
+ */
+class TokenizedStatName {
+public:
+  typedef absl::InlinedVector<absl::string_view, 16> TokenVector;
+
+  explicit TokenizedStatName(absl::string_view name);
+
+  /**
+   * @return absl::string_view the name that was tokenized.
+   */
+  absl::string_view name() const { return name_; }
+
+  /**
+   * @return const TokenVector& the tokens of the name, in order.
+   */
+  const TokenVector& tokens() const { return tokens_; }
+
+  /**
+   * @param index supplies the index of a token.
+   * @return size_t the character offset of the token in the name.
+   */
+  size_t offset(size_t index) const { return tokens_[index].data() - name_.data(); }
+
+private:
+  const absl::string_view name_;
+  TokenVector tokens_;
+};
+
+/**
+ * Tag extractor that matches a pattern against the tokens of a stat name, rather than running a
+ * regex over its characters. Patterns are '.'-separated elements, each of which is one of:
+ *   literal  matches a token equal to the literal. Alternatives may be separated by '|', as in
+ *            "table|error", to match a token equal to any of them.
+ *   *        matches any one token.
+ *   **       matches zero or more tokens, preferring as few as possible.
+ *   #        matches one non-empty token made of alphanumerics and underscores.
+ *   $        matches any one token and captures it as the tag value.
+ *   $$       matches one or more tokens, preferring as few as possible, and captures them
+ *            joined by '.' as the tag value.
+ * The pattern must match the whole name, must start with a literal without alternatives, and
+ * must capture exactly once. Unlike a regex, elements only ever match whole tokens. The captured
+ * tokens are removed from the name along with the '.' that follows them or, when they end the
+ * name, the '.' that precedes them.
+ *
+ * For example "cluster.$.*.**" extracts "foo" from "cluster.foo.upstream_rq_total", which is the
+ * same extraction that the regex "^cluster\\.((.*?)\\.)" makes.
+ */
+class TagExtractorTokensImpl : public TagExtractor {
+public:
+  /**
+   * @param name name for tag extractor.
+   * @param pattern token pattern, in the syntax described above.
+   * @throw EnvoyException if the pattern is invalid.
+   */
+  TagExtractorTokensImpl(const std::string& name, const std::string& pattern);
+
+  std::string name() const override { return name_; }
+  bool extractTag(const std::string& stat_name, std::vector<Tag>& tags,
+                  IntervalSet<size_t>& remove_characters) const override;
+  absl::string_view prefixToken() const override { return prefix_; }
+
+  /**
+   * Same as extractTag(const std::string&, ...), but for a name that has already been tokenized,
+   * so that all of the extractors applied to a name can share one tokenization.
+   * @param stat_name the tokenized stat name.
+   * @param tags list of tags updated with the tag name and value if found in the name.
+   * @param remove_characters set of intervals of character-indices to be removed from name.
+   * @return bool indicates whether a tag was found in the name.
+   */
+  bool extractTag(const TokenizedStatName& stat_name, std::vector<Tag>& tags,
+                  IntervalSet<size_t>& remove_characters) const;
+
+private:
+  enum class ElementType { Literal, Any, AnyRun, Word, Value, ValueRun };
+
+  struct Element {
+    ElementType type_;
+    std::vector<std::string> literals_;
+  };
+
+  /**
+   * Matches elements_[element...] against tokens[token...].
+   * @return bool whether the rest of the pattern matches the rest of the tokens. On a match,
+   *         [value_begin, value_end) is set to the range of captured tokens.
+   */
+  bool match(size_t element, size_t token, const TokenizedStatName::TokenVector& tokens,
+             size_t& value_begin, size_t& value_end) const;
+
+  static bool isWord(absl::string_view token);
+
+  const std::string name_;
+  std::vector<Element> elements_;
+  std::string prefix_;
+};
+
+typedef std::unique_ptr<const TagExtractorTokensImpl> TagExtractorTokensPtr;
+
 } // namespace Stats
 } // namespace Envoy
@@ -45,8 +45,7 @@ int TagProducerImpl::addExtractorsMatching(absl::string_view name) {
   int num_found = 0;
   for (const auto& desc : Config::TagNames::get().descriptorVec()) {
     if (desc.name_ == name) {
-      addExtractor(
-          Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+      addDefaultExtractor(desc);
       ++num_found;
     }
   }
@@ -58,23 +57,44 @@ void TagProducerImpl::addExtractor(TagExtractorPtr extractor) {
   if (prefix.empty()) {
     tag_extractors_without_prefix_.emplace_back(std::move(extractor));
   } else {
-    tag_extractor_prefix_map_[prefix].emplace_back(std::move(extractor));
+    PrefixExtractor entry;
+    entry.regex_extractor_ = std::move(extractor);
+    tag_extractor_prefix_map_[prefix].emplace_back(std::move(entry));
   }
 }
 
-void TagProducerImpl::forEachExtractorMatching(
-    const std::string& stat_name, std::function<void(const TagExtractorPtr&)> f) const {
-  IntervalSetImpl<size_t> remove_characters;
+void TagProducerImpl::addExtractor(TagExtractorTokensPtr extractor) {
+  const absl::string_view prefix = extractor->prefixToken();
+  PrefixExtractor entry;
+  entry.token_extractor_ = std::move(extractor);
+  tag_extractor_prefix_map_[prefix].emplace_back(std::move(entry));
+}
+
+void TagProducerImpl::addDefaultExtractor(const Config::TagNameValues::Descriptor& desc) {
+  if (desc.tokens_.empty()) {
+    addExtractor(
+        Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+  } else {
+    addExtractor(std::make_unique<const TagExtractorTokensImpl>(desc.name_, desc.tokens_));
+  }
+}
+
+void TagProducerImpl::forEachExtractorMatching(const std::string& stat_name,
+                                               std::function<void(const TagExtractor&)> f) const {
   for (const TagExtractorPtr& tag_extractor : tag_extractors_without_prefix_) {
-    f(tag_extractor);
+    f(*tag_extractor);
   }
   const std::string::size_type dot = stat_name.find('.');
   if (dot != std::string::npos) {
     const absl::string_view token = absl::string_view(stat_name.data(), dot);
     const auto iter = tag_extractor_prefix_map_.find(token);
     if (iter != tag_extractor_prefix_map_.end()) {
-      for (const TagExtractorPtr& tag_extractor : iter->second) {
-        f(tag_extractor);
+      for (const PrefixExtractor& entry : iter->second) {
+        if (entry.regex_extractor_ != nullptr) {
+          f(*entry.regex_extractor_);
+        } else {
+          f(*entry.token_extractor_);
+        }
       }
     }
   }
@@ -84,10 +104,28 @@ std::string TagProducerImpl::produceTags(const std::string& metric_name,
                                          std::vector<Tag>& tags) const {
   tags.insert(tags.end(), default_tags_.begin(), default_tags_.end());
   IntervalSetImpl<size_t> remove_characters;
-  forEachExtractorMatching(
-      metric_name, [&remove_characters, &tags, &metric_name](const TagExtractorPtr& tag_extractor) {
-        tag_extractor->extractTag(metric_name, tags, remove_characters);
-      });
+  for (const TagExtractorPtr& tag_extractor : tag_extractors_without_prefix_) {
+    tag_extractor->extractTag(metric_name, tags, remove_characters);
+  }
+  const std::string::size_type dot = metric_name.find('.');
+  if (dot != std::string::npos) {
+    const absl::string_view token = absl::string_view(metric_name.data(), dot);
+    const auto iter = tag_extractor_prefix_map_.find(token);
+    if (iter != tag_extractor_prefix_map_.end()) {
+      // Tokenize the name at most once, and only if a token-pattern extractor needs it.
+      absl::optional<TokenizedStatName> tokenized_name;
+      for (const PrefixExtractor& entry : iter->second) {
+        if (entry.regex_extractor_ != nullptr) {
+          entry.regex_extractor_->extractTag(metric_name, tags, remove_characters);
+        } else {
+          if (!tokenized_name) {
+            tokenized_name.emplace(metric_name);
+          }
+          entry.token_extractor_->extractTag(*tokenized_name, tags, remove_characters);
+        }
+      }
+    }
+  }
   return StringUtil::removeCharacters(metric_name, remove_characters);
 }
 
@@ -101,8 +139,7 @@ TagProducerImpl::addDefaultExtractors(const envoy::config::metrics::v2::StatsCon
   if (!config.has_use_all_default_tags() || config.use_all_default_tags().value()) {
     for (const auto& desc : Config::TagNames::get().descriptorVec()) {
       names.emplace(desc.name_);
-      addExtractor(
-          Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+      addDefaultExtractor(desc);
     }
   }
   return names;
@@ -16,8 +16,10 @@
 #include "common/common/utility.h"
 #include "common/config/well_known_names.h"
 #include "common/protobuf/protobuf.h"
+#include "common/stats/tag_extractor_impl.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Stats {
@@ -49,6 +51,21 @@ private:
    */
   void addExtractor(TagExtractorPtr extractor);
 
+  /**
+   * Adds a token-pattern TagExtractor. These always have a prefix, and are applied to a stat
+   * name in the order they were added relative to the regex extractors for the same prefix. All
+   * token-pattern extractors for a name share a single tokenization.
+   * @param extractor TagExtractorTokensPtr the extractor to add.
+   */
+  void addExtractor(TagExtractorTokensPtr extractor);
+
+  /**
+   * Adds the extractor for a default tag descriptor, using its token pattern if it has one and
+   * its regex otherwise.
+   * @param desc const Config::TagNameValues::Descriptor& the descriptor.
+   */
+  void addDefaultExtractor(const Config::TagNameValues::Descriptor& desc);
+
   /**
    * Adds all default extractors matching the specified tag name. In this model,
    * more than one TagExtractor can be used to generate a given tag. The default
@@ -81,23 +98,34 @@ private:
    * during testing, where we want to verify that extraction is order-independent.
    * The possibly-matching-extractors list is computed by:
    *   1. Finding the first '.' separated token in stat_name.
-   *   2. Collecting the TagExtractors whose regexes have that same prefix "^prefix\\."
+   *   2. Collecting the TagExtractors whose regexes or token patterns have that same prefix.
    *   3. Collecting also the TagExtractors whose regexes don't start with any prefix.
-   * In the future, we may also do substring searches in some cases.
-   * See DefaultTagRegexTester::produceTagsReverse in test/common/stats/stats_impl_test.cc.
+   * produceTags does not use this, so that it can share one tokenization of the stat name
+   * between all the token-pattern extractors.
+   * See DefaultTagRegexTester::produceTagsReverse in test/common/stats/tag_extractor_impl_test.cc.
    *
    * @param stat_name const std::string& the stat name.
-   * @param f std::function<void(const TagExtractorPtr&)> function to call for each extractor.
+   * @param f std::function<void(const TagExtractor&)> function to call for each extractor.
    */
   void forEachExtractorMatching(const std::string& stat_name,
-                                std::function<void(const TagExtractorPtr&)> f) const;
+                                std::function<void(const TagExtractor&)> f) const;
+
+  /**
+   * One extractor sharing a prefix token. Exactly one of the two pointers is set, so that regex
+   * and token-pattern extractors keep the order in which they were added.
+   */
+  struct PrefixExtractor {
+    TagExtractorPtr regex_extractor_;
+    TagExtractorTokensPtr token_extractor_;
+  };
+  typedef std::vector<PrefixExtractor> PrefixExtractors;
 
   std::vector<TagExtractorPtr> tag_extractors_without_prefix_;
 
-  // Maps a prefix word extracted out of a regex to a vector of TagExtractors. Note that
-  // the storage for the prefix string is owned by the TagExtractor, which, depending on
-  // implementation, may need make a copy of the prefix.
-  std::unordered_map<absl::string_view, std::vector<TagExtractorPtr>, StringViewHash>
+  // Maps a prefix word extracted out of a regex or token pattern to the TagExtractors with that
+  // prefix. Note that the storage for the prefix string is owned by the TagExtractor, which,
+  // depending on implementation, may need make a copy of the prefix.
+  std::unordered_map<absl::string_view, PrefixExtractors, StringViewHash>
       tag_extractor_prefix_map_;
   std::vector<Tag> default_tags_;
 };
@@ -16,6 +16,7 @@
 #include "common/stats/stats_matcher_impl.h"
 #include "common/stats/tag_producer_impl.h"
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 
 namespace Envoy {
@@ -26,7 +27,9 @@ ThreadLocalStoreImpl::ThreadLocalStoreImpl(const StatsOptions& stats_options,
     : stats_options_(stats_options), alloc_(alloc), default_scope_(createScope("")),
       tag_producer_(std::make_unique<TagProducerImpl>()),
       stats_matcher_(std::make_unique<StatsMatcherImpl>()),
-      num_last_resort_stats_(default_scope_->counter("stats.overflow")), source_(*this) {}
+      histogram_settings_(std::make_unique<HistogramSettingsImpl>()),
+      num_last_resort_stats_(default_scope_->counter("stats.overflow")),
+      heap_allocator_(alloc.symbolTable()), source_(*this) {}
 
 ThreadLocalStoreImpl::~ThreadLocalStoreImpl() {
   ASSERT(shutting_down_);
@@ -51,13 +54,13 @@ void ThreadLocalStoreImpl::setStatsMatcher(StatsMatcherPtr&& stats_matcher) {
 
 template <class StatMapClass, class StatListClass>
 void ThreadLocalStoreImpl::removeRejectedStats(StatMapClass& map, StatListClass& list) {
-  std::vector<const char*> remove_list;
+  std::vector<StatName> remove_list;
   for (auto& stat : map) {
-    if (rejects(stat.first)) {
+    if (rejects(stat.second->name())) {
       remove_list.push_back(stat.first);
     }
   }
-  for (const char* stat_name : remove_list) {
+  for (StatName stat_name : remove_list) {
     auto p = map.find(stat_name);
     ASSERT(p != map.end());
     list.push_back(p->second); // Save SharedPtr to the list to avoid invalidating refs to stat.
@@ -72,15 +75,25 @@ bool ThreadLocalStoreImpl::rejects(const std::string& name) const {
   return stats_matcher_->rejects(name);
 }
 
-std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
-  // Handle de-dup due to overlapping scopes.
-  std::vector<CounterSharedPtr> ret;
-  CharStarHashSet names;
+template <class StatType, class GetStatMapFn>
+std::vector<std::shared_ptr<StatType>>
+ThreadLocalStoreImpl::statsWithPrefix(absl::string_view prefix, bool dedup,
+                                      GetStatMapFn get_stat_map) const {
+  std::vector<std::shared_ptr<StatType>> ret;
+  StatNameHashSet names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
-    for (auto& counter : scope->central_cache_.counters_) {
-      if (names.insert(counter.first).second) {
-        ret.push_back(counter.second);
+    // Every stat in a scope is named with the scope's prefix, so a scope can only hold matching
+    // stats if one of the two prefixes extends the other, and when the scope's prefix extends the
+    // requested one, all of its stats match without looking at their names.
+    const bool all_match = absl::StartsWith(scope->prefix_, prefix);
+    if (!all_match && !absl::StartsWith(prefix, scope->prefix_)) {
+      continue;
+    }
+    for (const auto& stat : get_stat_map(scope->central_cache_)) {
+      if ((all_match || absl::StartsWith(stat.second->name(), prefix)) &&
+          (!dedup || names.insert(stat.first).second)) {
+        ret.push_back(stat.second);
       }
     }
   }
@@ -88,6 +101,15 @@ std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
   return ret;
 }
 
+std::vector<CounterSharedPtr>
+ThreadLocalStoreImpl::countersWithPrefix(absl::string_view prefix) const {
+  // Handle de-dup due to overlapping scopes.
+  return statsWithPrefix<Counter>(
+      prefix, true, [](const CentralCacheEntry& entry) -> const StatMap<CounterSharedPtr>& {
+        return entry.counters_;
+      });
+}
+
 ScopePtr ThreadLocalStoreImpl::createScope(const std::string& name) {
   std::unique_ptr<ScopeImpl> new_scope(new ScopeImpl(*this, name));
   Thread::LockGuard lock(lock_);
@@ -95,38 +117,26 @@ ScopePtr ThreadLocalStoreImpl::createScope(const std::string& name) {
   return std::move(new_scope);
 }
 
-std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
+std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gaugesWithPrefix(absl::string_view prefix) const {
   // Handle de-dup due to overlapping scopes.
-  std::vector<GaugeSharedPtr> ret;
-  CharStarHashSet names;
-  Thread::LockGuard lock(lock_);
-  for (ScopeImpl* scope : scopes_) {
-    for (auto& gauge : scope->central_cache_.gauges_) {
-      if (names.insert(gauge.first).second) {
-        ret.push_back(gauge.second);
-      }
-    }
-  }
-
-  return ret;
+  return statsWithPrefix<Gauge>(
+      prefix, true, [](const CentralCacheEntry& entry) -> const StatMap<GaugeSharedPtr>& {
+        return entry.gauges_;
+      });
 }
 
-std::vector<ParentHistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
-  std::vector<ParentHistogramSharedPtr> ret;
-  Thread::LockGuard lock(lock_);
+std::vector<ParentHistogramSharedPtr>
+ThreadLocalStoreImpl::histogramsWithPrefix(absl::string_view prefix) const {
   // TODO(ramaraochavali): As histograms don't share storage, there is a chance of duplicate names
   // here. We need to create global storage for histograms similar to how we have a central storage
   // in shared memory for counters/gauges. In the interim, no de-dup is done here. This may result
   // in histograms with duplicate names, but until shared storage is implemented it's ultimately
   // less confusing for users who have such configs.
-  for (ScopeImpl* scope : scopes_) {
-    for (const auto& name_histogram_pair : scope->central_cache_.histograms_) {
-      const ParentHistogramSharedPtr& parent_hist = name_histogram_pair.second;
-      ret.push_back(parent_hist);
-    }
-  }
-
-  return ret;
+  return statsWithPrefix<ParentHistogram>(
+      prefix, false,
+      [](const CentralCacheEntry& entry) -> const StatMap<ParentHistogramImplSharedPtr>& {
+        return entry.histograms_;
+      });
 }
 
 void ThreadLocalStoreImpl::initializeThreading(Event::Dispatcher& main_thread_dispatcher,
@@ -147,13 +157,15 @@ void ThreadLocalStoreImpl::mergeHistograms(PostMergeCb merge_complete_cb) {
   if (!shutting_down_) {
     ASSERT(!merge_in_progress_);
     merge_in_progress_ = true;
+    // Each thread merges its own histograms, so the merge work is spread across the workers
+    // rather than done on the main thread, and recording never has to lock.
     tls_->runOnAllThreads(
         [this]() -> void {
           for (const auto& scope : tls_->getTyped<TlsCache>().scope_cache_) {
             const TlsCacheEntry& tls_cache_entry = scope.second;
             for (const auto& name_histogram_pair : tls_cache_entry.histograms_) {
               const TlsHistogramSharedPtr& tls_hist = name_histogram_pair.second;
-              tls_hist->beginMerge();
+              tls_hist->merge();
             }
           }
         },
@@ -222,17 +234,15 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     const std::string& name, StatMap<std::shared_ptr<StatType>>& central_cache_map,
     MakeStatFn<StatType> make_stat, StatMap<std::shared_ptr<StatType>>* tls_cache) {
 
-  const char* stat_key = name.c_str();
-  std::unique_ptr<std::string> truncation_buffer;
+  // The caches are keyed by the encoding of the truncated name, so that all names that truncate
+  // to the same prefix share a stat.
   absl::string_view truncated_name = parent_.truncateStatNameIfNeeded(name);
-  if (truncated_name.size() < name.size()) {
-    truncation_buffer = std::make_unique<std::string>(std::string(truncated_name));
-    stat_key = truncation_buffer->c_str(); // must be nul-terminated.
-  }
+  StatNameTempStorage stat_name_storage(truncated_name, symbolTable());
+  StatName stat_name = stat_name_storage.statName();
 
   // If we have a valid cache entry, return it.
   if (tls_cache) {
-    auto pos = tls_cache->find(stat_key);
+    auto pos = tls_cache->find(stat_name);
     if (pos != tls_cache->end()) {
       return *pos->second;
     }
@@ -241,17 +251,17 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
   // We must now look in the central store so we must be locked. We grab a reference to the
   // central store location. It might contain nothing. In this case, we allocate a new stat.
   Thread::LockGuard lock(parent_.lock_);
-  auto p = central_cache_map.find(stat_key);
+  auto p = central_cache_map.find(stat_name);
   std::shared_ptr<StatType>* central_ref = nullptr;
   if (p != central_cache_map.end()) {
     central_ref = &(p->second);
   } else {
     // If we had to truncate, warn now that we've missed all caches.
-    if (truncation_buffer != nullptr) {
+    if (truncated_name.size() < name.size()) {
       ENVOY_LOG_MISC(
           warn,
           "Statistic '{}' is too long with {} characters, it will be truncated to {} characters",
-          name, name.size(), truncation_buffer->size());
+          name, name.size(), truncated_name.size());
     }
 
     std::vector<Tag> tags;
@@ -259,25 +269,19 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     // Tag extraction occurs on the original, untruncated name so the extraction
     // can complete properly, even if the tag values are partially truncated.
     std::string tag_extracted_name = parent_.getTagsForName(name, tags);
-    std::shared_ptr<StatType> stat =
-        make_stat(parent_.alloc_, truncated_name, std::move(tag_extracted_name), std::move(tags));
+    std::shared_ptr<StatType> stat = make_stat(parent_.alloc_, stat_name, tag_extracted_name, tags);
     if (stat == nullptr) {
-      // TODO(jmarantz): If make_stat fails, the actual move does not actually occur
-      // for tag_extracted_name and tags, so there is no use-after-move problem.
-      // In order to increase the readability of the code, refactoring is done here.
       parent_.num_last_resort_stats_.inc();
-      stat = make_stat(parent_.heap_allocator_, truncated_name,
-                       std::move(tag_extracted_name), // NOLINT(bugprone-use-after-move)
-                       std::move(tags));              // NOLINT(bugprone-use-after-move)
+      stat = make_stat(parent_.heap_allocator_, stat_name, tag_extracted_name, tags);
       ASSERT(stat != nullptr);
     }
-    central_ref = &central_cache_map[stat->nameCStr()];
+    central_ref = &central_cache_map[stat->statName()];
     *central_ref = stat;
   }
 
   // If we have a TLS cache, insert the stat.
   if (tls_cache) {
-    tls_cache->insert(std::make_pair((*central_ref)->nameCStr(), *central_ref));
+    tls_cache->insert(std::make_pair((*central_ref)->statName(), *central_ref));
   }
 
   // Finally we return the reference.
@@ -287,13 +291,14 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
 Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
   // Determine the final name based on the prefix and the passed name.
   //
-  // Note that we can do map.find(final_name.c_str()), but we cannot do
-  // map[final_name.c_str()] as the char*-keyed maps would then save the pointer
-  // to a temporary, and address sanitization errors would follow. Instead we
-  // must do a find() first, using the value if it succeeds. If it fails, then
-  // after we construct the stat we can insert it into the required maps. This
-  // strategy costs an extra hash lookup for each miss, but saves time
-  // re-copying the string and significant memory overhead.
+  // Note that the maps are keyed by StatNames that refer to storage held by
+  // the stats themselves. The StatName encoded for the lookup is a temporary,
+  // so we cannot do map[stat_name] with it, as the map would then save a
+  // reference to the temporary storage. Instead we must do a find() first,
+  // using the value if it succeeds. If it fails, then after we construct the
+  // stat we can insert it into the required maps, keyed by its own statName().
+  // This strategy costs an extra hash lookup for each miss, but saves
+  // significant memory overhead.
   std::string final_name = prefix_ + name;
   if (parent_.rejects(final_name)) {
     return null_counter_;
@@ -308,9 +313,9 @@ Counter& ThreadLocalStoreImpl::ScopeImpl::counter(const std::string& name) {
 
   return safeMakeStat<Counter>(
       final_name, central_cache_.counters_,
-      [](StatDataAllocator& allocator, absl::string_view name, std::string&& tag_extracted_name,
-         std::vector<Tag>&& tags) -> CounterSharedPtr {
-        return allocator.makeCounter(name, std::move(tag_extracted_name), std::move(tags));
+      [](StatDataAllocator& allocator, StatName name, absl::string_view tag_extracted_name,
+         const std::vector<Tag>& tags) -> CounterSharedPtr {
+        return allocator.makeCounter(name, tag_extracted_name, tags);
       },
       tls_cache);
 }
@@ -334,12 +339,6 @@ void ThreadLocalStoreImpl::ScopeImpl::deliverHistogramToSinks(const Histogram& h
 Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
-  //
-  // Note that we can do map.find(final_name.c_str()), but we cannot do
-  // map[final_name.c_str()] as the char*-keyed maps would then save the pointer to
-  // a temporary, and address sanitization errors would follow. Instead we must
-  // do a find() first, using that if it succeeds. If it fails, then after we
-  // construct the stat we can insert it into the required maps.
   std::string final_name = prefix_ + name;
   if (parent_.rejects(final_name)) {
     return null_gauge_;
@@ -352,9 +351,9 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
 
   return safeMakeStat<Gauge>(
       final_name, central_cache_.gauges_,
-      [](StatDataAllocator& allocator, absl::string_view name, std::string&& tag_extracted_name,
-         std::vector<Tag>&& tags) -> GaugeSharedPtr {
-        return allocator.makeGauge(name, std::move(tag_extracted_name), std::move(tags));
+      [](StatDataAllocator& allocator, StatName name, absl::string_view tag_extracted_name,
+         const std::vector<Tag>& tags) -> GaugeSharedPtr {
+        return allocator.makeGauge(name, tag_extracted_name, tags);
       },
       tls_cache);
 }
@@ -362,29 +361,26 @@ Gauge& ThreadLocalStoreImpl::ScopeImpl::gauge(const std::string& name) {
 Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
   // See comments in counter(). There is no super clean way (via templates or otherwise) to
   // share this code so I'm leaving it largely duplicated for now.
-  //
-  // Note that we can do map.find(final_name.c_str()), but we cannot do
-  // map[final_name.c_str()] as the char*-keyed maps would then save the pointer to
-  // a temporary, and address sanitization errors would follow. Instead we must
-  // do a find() first, using that if it succeeds. If it fails, then after we
-  // construct the stat we can insert it into the required maps.
   std::string final_name = prefix_ + name;
   if (parent_.rejects(final_name)) {
     return null_histogram_;
   }
 
+  StatNameTempStorage stat_name_storage(final_name, symbolTable());
+  StatName stat_name = stat_name_storage.statName();
+
   StatMap<ParentHistogramSharedPtr>* tls_cache = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
     tls_cache =
         &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].parent_histograms_;
-    auto p = tls_cache->find(final_name.c_str());
+    auto p = tls_cache->find(stat_name);
     if (p != tls_cache->end()) {
       return *p->second;
     }
   }
 
   Thread::LockGuard lock(parent_.lock_);
-  auto p = central_cache_.histograms_.find(final_name.c_str());
+  auto p = central_cache_.histograms_.find(stat_name);
   ParentHistogramImplSharedPtr* central_ref = nullptr;
   if (p != central_cache_.histograms_.end()) {
     central_ref = &p->second;
@@ -392,88 +388,123 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
     std::vector<Tag> tags;
     std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
     auto stat = std::make_shared<ParentHistogramImpl>(
-        final_name, parent_, *this, std::move(tag_extracted_name), std::move(tags));
-    central_ref = &central_cache_.histograms_[stat->nameCStr()];
+        stat_name, parent_, *this, tag_extracted_name, tags, symbolTable(),
+        parent_.histogram_settings_->buckets(final_name));
+    central_ref = &central_cache_.histograms_[stat->statName()];
     *central_ref = stat;
   }
 
   if (tls_cache != nullptr) {
-    tls_cache->insert(std::make_pair((*central_ref)->nameCStr(), *central_ref));
+    tls_cache->insert(std::make_pair((*central_ref)->statName(), *central_ref));
   }
   return **central_ref;
 }
 
-Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(const std::string& name,
+Histogram& ThreadLocalStoreImpl::ScopeImpl::tlsHistogram(StatName name,
                                                          ParentHistogramImpl& parent) {
-  if (parent_.rejects(name)) {
-    return null_histogram_;
-  }
-
   // See comments in counter() which explains the logic here.
 
   StatMap<TlsHistogramSharedPtr>* tls_cache = nullptr;
   if (!parent_.shutting_down_ && parent_.tls_) {
     tls_cache = &parent_.tls_->getTyped<TlsCache>().scope_cache_[this->scope_id_].histograms_;
-    auto p = tls_cache->find(name.c_str());
+    auto p = tls_cache->find(name);
     if (p != tls_cache->end()) {
       return *p->second;
     }
   }
 
-  std::vector<Tag> tags;
-  std::string tag_extracted_name = parent_.getTagsForName(name, tags);
+  // The name is only elaborated on a miss, as recordValue() calls this for every value.
+  if (parent_.rejects(parent.name())) {
+    return null_histogram_;
+  }
+
   TlsHistogramSharedPtr hist_tls_ptr = std::make_shared<ThreadLocalHistogramImpl>(
-      name, std::move(tag_extracted_name), std::move(tags));
+      name, parent.tagExtractedName(), parent.tags(), symbolTable(), parent.accumulator());
 
   parent.addTlsHistogram(hist_tls_ptr);
 
   if (tls_cache) {
-    tls_cache->insert(std::make_pair(hist_tls_ptr->nameCStr(), hist_tls_ptr));
+    tls_cache->insert(std::make_pair(hist_tls_ptr->statName(), hist_tls_ptr));
   }
   return *hist_tls_ptr;
 }
 
-ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(const std::string& name,
-                                                   std::string&& tag_extracted_name,
-                                                   std::vector<Tag>&& tags)
-    : MetricImpl(std::move(tag_extracted_name), std::move(tags)), current_active_(0), flags_(0),
-      created_thread_id_(std::this_thread::get_id()), name_(name) {
-  histograms_[0] = hist_alloc();
-  histograms_[1] = hist_alloc();
+void HistogramAccumulator::accumulate(histogram_t* tls_histogram) {
+  Thread::LockGuard lock(lock_);
+  hist_accumulate(histogram_, &tls_histogram, 1);
+  pending_ = true;
+  used_ = true;
 }
 
+bool HistogramAccumulator::moveTo(histogram_t*& target) {
+  Thread::LockGuard lock(lock_);
+  std::swap(histogram_, target);
+  hist_clear(histogram_);
+  const bool pending = pending_;
+  pending_ = false;
+  return pending;
+}
+
+ThreadLocalHistogramImpl::ThreadLocalHistogramImpl(StatName name,
+                                                   absl::string_view tag_extracted_name,
+                                                   const std::vector<Tag>& tags,
+                                                   SymbolTable& symbol_table,
+                                                   HistogramAccumulatorSharedPtr accumulator)
+    : MetricImpl(tag_extracted_name, tags, symbol_table), histogram_(hist_alloc()),
+      accumulator_(std::move(accumulator)), flags_(0),
+      created_thread_id_(std::this_thread::get_id()), name_(name, symbol_table),
+      symbol_table_(symbol_table) {}
+
 ThreadLocalHistogramImpl::~ThreadLocalHistogramImpl() {
-  hist_free(histograms_[0]);
-  hist_free(histograms_[1]);
+  // The owning thread may be gone, but nothing else references the histogram by now, so merging
+  // from this thread is safe.
+  if (recorded_) {
+    accumulator_->accumulate(histogram_);
+  }
+  hist_free(histogram_);
+  name_.free(symbol_table_);
+  MetricImpl::clear();
 }
 
 void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   ASSERT(std::this_thread::get_id() == created_thread_id_);
-  hist_insert_intscale(histograms_[current_active_], value, 0, 1);
+  hist_insert_intscale(histogram_, value, 0, 1);
+  recorded_ = true;
   flags_ |= Flags::Used;
 }
 
-void ThreadLocalHistogramImpl::merge(histogram_t* target) {
-  histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
-  hist_accumulate(target, other_histogram, 1);
-  hist_clear(*other_histogram);
+void ThreadLocalHistogramImpl::merge() {
+  ASSERT(std::this_thread::get_id() == created_thread_id_);
+  // Most histograms record nothing in a given interval, and those need not touch the accumulator.
+  // The bucket count can't tell, as hist_clear() keeps the buckets and only zeroes their counts.
+  if (!recorded_) {
+    return;
+  }
+  accumulator_->accumulate(histogram_);
+  hist_clear(histogram_);
+  recorded_ = false;
 }
 
-ParentHistogramImpl::ParentHistogramImpl(const std::string& name, Store& parent,
-                                         TlsScope& tls_scope, std::string&& tag_extracted_name,
-                                         std::vector<Tag>&& tags)
-    : MetricImpl(std::move(tag_extracted_name), std::move(tags)), parent_(parent),
-      tls_scope_(tls_scope), interval_histogram_(hist_alloc()), cumulative_histogram_(hist_alloc()),
-      interval_statistics_(interval_histogram_), cumulative_statistics_(cumulative_histogram_),
-      merged_(false), name_(name) {}
+ParentHistogramImpl::ParentHistogramImpl(StatName name, Store& parent, TlsScope& tls_scope,
+                                         absl::string_view tag_extracted_name,
+                                         const std::vector<Tag>& tags, SymbolTable& symbol_table,
+                                         const std::vector<double>& supported_buckets)
+    : MetricImpl(tag_extracted_name, tags, symbol_table), parent_(parent), tls_scope_(tls_scope),
+      interval_histogram_(hist_alloc()), cumulative_histogram_(hist_alloc()),
+      interval_statistics_(interval_histogram_, supported_buckets),
+      cumulative_statistics_(cumulative_histogram_, supported_buckets),
+      accumulator_(std::make_shared<HistogramAccumulator>()), merged_(false),
+      name_(name, symbol_table), symbol_table_(symbol_table) {}
 
 ParentHistogramImpl::~ParentHistogramImpl() {
   hist_free(interval_histogram_);
   hist_free(cumulative_histogram_);
+  name_.free(symbol_table_);
+  MetricImpl::clear();
 }
 
 void ParentHistogramImpl::recordValue(uint64_t value) {
-  Histogram& tls_histogram = tls_scope_.tlsHistogram(name(), *this);
+  Histogram& tls_histogram = tls_scope_.tlsHistogram(statName(), *this);
   tls_histogram.recordValue(value);
   parent_.deliverHistogramToSinks(*this, value);
 }
@@ -484,20 +515,13 @@ bool ParentHistogramImpl::used() const {
 }
 
 void ParentHistogramImpl::merge() {
-  Thread::ReleasableLockGuard lock(merge_lock_);
-  if (merged_ || usedLockHeld()) {
-    hist_clear(interval_histogram_);
-    // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
-    // then release the lock before we do the actual merge. However it is not a big deal
-    // because the tls_histogram merge is not that expensive as it is a single histogram
-    // merge and adding TLS histograms is rare.
-    for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
+  if (merged_ || accumulator_->used()) {
+    // The accumulated values become the interval histogram, and the accumulator starts over with
+    // the storage of the previous interval.
+    if (accumulator_->moveTo(interval_histogram_)) {
+      hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
+      cumulative_statistics_.refresh(cumulative_histogram_);
     }
-    // Since TLS merge is done, we can release the lock here.
-    lock.release();
-    hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
-    cumulative_statistics_.refresh(cumulative_histogram_);
     interval_statistics_.refresh(interval_histogram_);
     merged_ = true;
   }
@@ -540,14 +564,5 @@ void ParentHistogramImpl::addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr)
   tls_histograms_.emplace_back(hist_ptr);
 }
 
-bool ParentHistogramImpl::usedLockHeld() const {
-  for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-    if (tls_histogram->used()) {
-      return true;
-    }
-  }
-  return false;
-}
-
 } // namespace Stats
 } // namespace Envoy
@@ -9,9 +9,11 @@
 #include "envoy/thread_local/thread_local.h"
 
 #include "common/common/hash.h"
+#include "common/common/non_copyable.h"
 #include "common/stats/heap_stat_data.h"
 #include "common/stats/histogram_impl.h"
 #include "common/stats/source_impl.h"
+#include "common/stats/symbol_table_impl.h"
 #include "common/stats/utility.h"
 
 #include "absl/container/flat_hash_map.h"
@@ -22,43 +24,87 @@ namespace Envoy {
 namespace Stats {
 
 /**
- * A histogram that is stored in TLS and used to record values per thread. This holds two
- * histograms, one to collect the values and other as backup that is used for merge process. The
- * swap happens during the merge process.
+ * Collects the values recorded by all the ThreadLocalHistogramImpls of a ParentHistogramImpl
+ * during a flush interval. Each thread merges its own values in during the flush, so the main
+ * thread only consumes one histogram per ParentHistogramImpl, rather than one per thread. The
+ * ThreadLocalHistogramImpls share ownership of it, so that a merge never references a parent which
+ * the main thread may have already released.
+ *
+ * Merging takes a per-accumulator mutex rather than being wait-free. The mutex is never taken when
+ * recording, only by workers merging the same histogram during a flush and by the main thread
+ * collecting it afterwards, so it is rarely contended and is held for one hist_accumulate().
+ */
+class HistogramAccumulator : NonCopyable {
+public:
+  HistogramAccumulator() : histogram_(hist_alloc()) {}
+  ~HistogramAccumulator() { hist_free(histogram_); }
+
+  /**
+   * Adds the values of a thread's histogram to the accumulated values.
+   * @param tls_histogram the thread's histogram, which is not modified.
+   */
+  void accumulate(histogram_t* tls_histogram);
+
+  /**
+   * Exchanges the accumulated values with target, and then clears the accumulator.
+   * @param target the histogram receiving the accumulated values; its previous values are dropped.
+   * @return whether any values were accumulated since the previous call.
+   */
+  bool moveTo(histogram_t*& target);
+
+  /**
+   * @return whether any values have ever been accumulated.
+   */
+  bool used() const { return used_; }
+
+private:
+  Thread::MutexBasicLockable lock_;
+  histogram_t* histogram_ GUARDED_BY(lock_);
+  bool pending_ GUARDED_BY(lock_){false};
+  std::atomic<bool> used_{false};
+};
+
+typedef std::shared_ptr<HistogramAccumulator> HistogramAccumulatorSharedPtr;
+
+/**
+ * A histogram that is stored in TLS and used to record values per thread. Recording never locks;
+ * during the flush the owning thread merges the values into the parent's HistogramAccumulator and
+ * starts over, so no second buffer is needed. Values not yet merged when the histogram is destroyed
+ * are merged by the destructor.
  */
 class ThreadLocalHistogramImpl : public Histogram, public MetricImpl {
 public:
-  ThreadLocalHistogramImpl(const std::string& name, std::string&& tag_extracted_name,
-                           std::vector<Tag>&& tags);
+  ThreadLocalHistogramImpl(StatName name, absl::string_view tag_extracted_name,
+                           const std::vector<Tag>& tags, SymbolTable& symbol_table,
+                           HistogramAccumulatorSharedPtr accumulator);
   ~ThreadLocalHistogramImpl();
 
-  void merge(histogram_t* target);
-
   /**
-   * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
-   * not have to lock the histogram in high throughput TLS writes.
+   * Called on the owning thread during the flush. Moves the values recorded since the previous
+   * merge into the accumulator shared with the parent histogram.
    */
-  void beginMerge() {
-    // This switches the current_active_ between 1 and 0.
-    ASSERT(std::this_thread::get_id() == created_thread_id_);
-    current_active_ = otherHistogramIndex();
-  }
+  void merge();
 
   // Stats::Histogram
   void recordValue(uint64_t value) override;
   bool used() const override { return flags_ & Flags::Used; }
 
   // Stats::Metric
-  std::string name() const override { return name_; }
-  const char* nameCStr() const override { return name_.c_str(); }
+  StatName statName() const override { return name_.statName(); }
+
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return symbol_table_; }
 
 private:
-  uint64_t otherHistogramIndex() const { return 1 - current_active_; }
-  uint64_t current_active_;
-  histogram_t* histograms_[2];
+  histogram_t* histogram_;
+  const HistogramAccumulatorSharedPtr accumulator_;
   std::atomic<uint16_t> flags_;
+  // Whether a value was recorded since the last merge. Only accessed by the owning thread.
+  bool recorded_{false};
   std::thread::id created_thread_id_;
-  const std::string name_;
+  StatNameStorage name_;
+  SymbolTable& symbol_table_;
 };
 
 typedef std::shared_ptr<ThreadLocalHistogramImpl> TlsHistogramSharedPtr;
@@ -70,19 +116,20 @@ class TlsScope;
  */
 class ParentHistogramImpl : public ParentHistogram, public MetricImpl {
 public:
-  ParentHistogramImpl(const std::string& name, Store& parent, TlsScope& tlsScope,
-                      std::string&& tag_extracted_name, std::vector<Tag>&& tags);
+  ParentHistogramImpl(StatName name, Store& parent, TlsScope& tlsScope,
+                      absl::string_view tag_extracted_name, const std::vector<Tag>& tags,
+                      SymbolTable& symbol_table, const std::vector<double>& supported_buckets);
   ~ParentHistogramImpl();
 
   void addTlsHistogram(const TlsHistogramSharedPtr& hist_ptr);
+  const HistogramAccumulatorSharedPtr& accumulator() const { return accumulator_; }
   bool used() const override;
   void recordValue(uint64_t value) override;
 
   /**
-   * This method is called during the main stats flush process for each of the histograms. It
-   * iterates through the TLS histograms and collects the histogram data of all of them
-   * in to "interval_histogram". Then the collected "interval_histogram" is merged to a
-   * "cumulative_histogram".
+   * This method is called during the main stats flush process for each of the histograms, after
+   * each thread has merged its TLS histograms into the accumulator. The accumulated values become
+   * the "interval_histogram", which is then merged to the "cumulative_histogram".
    */
   void merge() override;
 
@@ -94,22 +141,27 @@ public:
   const std::string bucketSummary() const override;
 
   // Stats::Metric
-  std::string name() const override { return name_; }
-  const char* nameCStr() const override { return name_.c_str(); }
+  StatName statName() const override { return name_.statName(); }
 
-private:
-  bool usedLockHeld() const EXCLUSIVE_LOCKS_REQUIRED(merge_lock_);
+protected:
+  // MetricImpl
+  SymbolTable& symbolTable() const override { return symbol_table_; }
 
+private:
   Store& parent_;
   TlsScope& tls_scope_;
   histogram_t* interval_histogram_;
   histogram_t* cumulative_histogram_;
   HistogramStatisticsImpl interval_statistics_;
   HistogramStatisticsImpl cumulative_statistics_;
+  const HistogramAccumulatorSharedPtr accumulator_;
+  // Owns the TLS histograms, which are referenced by the TLS caches and by callers that record
+  // values before threading is initialized.
   mutable Thread::MutexBasicLockable merge_lock_;
   std::list<TlsHistogramSharedPtr> tls_histograms_ GUARDED_BY(merge_lock_);
   bool merged_;
-  const std::string name_;
+  StatNameStorage name_;
+  SymbolTable& symbol_table_;
 };
 
 typedef std::shared_ptr<ParentHistogramImpl> ParentHistogramImplSharedPtr;
@@ -125,8 +177,9 @@ public:
   /**
    * @return a ThreadLocalHistogram within the scope's namespace.
    * @param name name of the histogram with scope prefix attached.
+   * @param parent the parent histogram, from which a new ThreadLocalHistogram copies its tags.
    */
-  virtual Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) PURE;
+  virtual Histogram& tlsHistogram(StatName name, ParentHistogramImpl& parent) PURE;
 };
 
 /**
@@ -150,9 +203,15 @@ public:
   };
 
   // Stats::Store
-  std::vector<CounterSharedPtr> counters() const override;
-  std::vector<GaugeSharedPtr> gauges() const override;
-  std::vector<ParentHistogramSharedPtr> histograms() const override;
+  std::vector<CounterSharedPtr> counters() const override { return countersWithPrefix(""); }
+  std::vector<GaugeSharedPtr> gauges() const override { return gaugesWithPrefix(""); }
+  std::vector<ParentHistogramSharedPtr> histograms() const override {
+    return histogramsWithPrefix("");
+  }
+  std::vector<CounterSharedPtr> countersWithPrefix(absl::string_view prefix) const override;
+  std::vector<GaugeSharedPtr> gaugesWithPrefix(absl::string_view prefix) const override;
+  std::vector<ParentHistogramSharedPtr>
+  histogramsWithPrefix(absl::string_view prefix) const override;
 
   // Stats::StoreRoot
   void addSink(Sink& sink) override { timer_sinks_.push_back(sink); }
@@ -160,6 +219,9 @@ public:
     tag_producer_ = std::move(tag_producer);
   }
   void setStatsMatcher(StatsMatcherPtr&& stats_matcher) override;
+  void setHistogramSettings(HistogramSettingsConstPtr&& histogram_settings) override {
+    histogram_settings_ = std::move(histogram_settings);
+  }
   void initializeThreading(Event::Dispatcher& main_thread_dispatcher,
                            ThreadLocal::Instance& tls) override;
   void shutdownThreading() override;
@@ -171,7 +233,9 @@ public:
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
 
 private:
-  template <class Stat> using StatMap = CharStarHashMap<Stat>;
+  // Stats are keyed by their StatName, which refers to storage held by the stat itself, so the
+  // maps do not hold their own copies of the names.
+  template <class Stat> using StatMap = StatNameHashMap<Stat>;
 
   struct TlsCacheEntry {
     StatMap<CounterSharedPtr> counters_;
@@ -200,14 +264,13 @@ private:
     void deliverHistogramToSinks(const Histogram& histogram, uint64_t value) override;
     Gauge& gauge(const std::string& name) override;
     Histogram& histogram(const std::string& name) override;
-    Histogram& tlsHistogram(const std::string& name, ParentHistogramImpl& parent) override;
+    Histogram& tlsHistogram(StatName name, ParentHistogramImpl& parent) override;
     const Stats::StatsOptions& statsOptions() const override { return parent_.statsOptions(); }
 
     template <class StatType>
-    using MakeStatFn =
-        std::function<std::shared_ptr<StatType>(StatDataAllocator&, absl::string_view name,
-                                                std::string&& tag_extracted_name,
-                                                std::vector<Tag>&& tags)>;
+    using MakeStatFn = std::function<std::shared_ptr<StatType>(
+        StatDataAllocator&, StatName name, absl::string_view tag_extracted_name,
+        const std::vector<Tag>& tags)>;
 
     /**
      * Makes a stat either by looking it up in the central cache,
@@ -225,6 +288,8 @@ private:
     safeMakeStat(const std::string& name, StatMap<std::shared_ptr<StatType>>& central_cache_map,
                  MakeStatFn<StatType> make_stat, StatMap<std::shared_ptr<StatType>>* tls_cache);
 
+    SymbolTable& symbolTable() { return parent_.symbolTable(); }
+
     static std::atomic<uint64_t> next_scope_id_;
 
     const uint64_t scope_id_;
@@ -248,6 +313,10 @@ private:
     absl::flat_hash_map<uint64_t, TlsCacheEntry> scope_cache_;
   };
 
+  SymbolTable& symbolTable() { return alloc_.symbolTable(); }
+  template <class StatType, class GetStatMapFn>
+  std::vector<std::shared_ptr<StatType>> statsWithPrefix(absl::string_view prefix, bool dedup,
+                                                         GetStatMapFn get_stat_map) const;
   std::string getTagsForName(const std::string& name, std::vector<Tag>& tags) const;
   void clearScopeFromCaches(uint64_t scope_id);
   void releaseScopeCrossThread(ScopeImpl* scope);
@@ -267,6 +336,7 @@ private:
   std::list<std::reference_wrapper<Sink>> timer_sinks_;
   TagProducerPtr tag_producer_;
   StatsMatcherPtr stats_matcher_;
+  HistogramSettingsConstPtr histogram_settings_;
   std::atomic<bool> shutting_down_{};
   std::atomic<bool> merge_in_progress_{};
   Counter& num_last_resort_stats_;
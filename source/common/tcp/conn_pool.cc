@@ -1,5 +1,6 @@
 #include "common/tcp/conn_pool.h"
 
+#include <cmath>
 #include <memory>
 
 #include "envoy/event/dispatcher.h"
@@ -35,6 +36,9 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::drainConnections() {
+  // Don't reopen the drained connections to this host until it is picked for a request again.
+  prefetch_suppressed_ = true;
+
   while (!ready_conns_.empty()) {
     ready_conns_.front()->conn_->close(Network::ConnectionCloseType::NoFlush);
   }
@@ -57,6 +61,10 @@ void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
 
 void ConnPoolImpl::assignConnection(ActiveConn& conn, ConnectionPool::Callbacks& callbacks) {
   ASSERT(conn.wrapper_ == nullptr);
+  if (conn.prefetched_) {
+    host_->cluster().stats().upstream_rq_prefetch_hit_.inc();
+    conn.prefetched_ = false;
+  }
   conn.wrapper_ = std::make_shared<ConnectionWrapper>(conn);
 
   callbacks.onPoolReady(std::make_unique<ConnectionDataImpl>(conn.wrapper_),
@@ -83,6 +91,8 @@ void ConnPoolImpl::createNewConnection() {
 }
 
 ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbacks& callbacks) {
+  prefetch_suppressed_ = false;
+  schedulePrefetch();
   if (!ready_conns_.empty()) {
     ready_conns_.front()->moveBetweenLists(ready_conns_, busy_conns_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_conns_.front()->conn_);
@@ -97,16 +107,26 @@ ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbac
       host_->cluster().stats().upstream_cx_overflow_.inc();
     }
 
-    // If we have no connections at all, make one no matter what so we don't starve.
+    // If we have no connections at all, make one no matter what so we don't starve. When
+    // prefetching, a pending connection not yet spoken for by a pending request will serve this
+    // one.
     if ((ready_conns_.empty() && busy_conns_.empty() && pending_conns_.empty()) ||
-        can_create_connection) {
+        (can_create_connection &&
+         (!prefetchEnabled() || pending_conns_.size() <= pending_requests_.size()))) {
       createNewConnection();
     }
 
     ENVOY_LOG(debug, "queueing request due to no available connections");
-    PendingRequestPtr pending_request(new PendingRequest(*this, callbacks));
-    pending_request->moveIntoList(std::move(pending_request), pending_requests_);
-    return pending_requests_.front().get();
+    if (free_pending_requests_.empty()) {
+      PendingRequestPtr pending_request(new PendingRequest(*this));
+      pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+    } else {
+      free_pending_requests_.front()->moveBetweenLists(free_pending_requests_, pending_requests_);
+    }
+
+    PendingRequest& request = *pending_requests_.front();
+    request.activate(callbacks);
+    return &request;
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
@@ -172,10 +192,11 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
 
       std::list<PendingRequestPtr> pending_requests_to_purge(std::move(pending_requests_));
       while (!pending_requests_to_purge.empty()) {
-        PendingRequestPtr request =
-            pending_requests_to_purge.front()->removeFromList(pending_requests_to_purge);
+        PendingRequest& request = *pending_requests_to_purge.front();
         host_->cluster().stats().upstream_rq_pending_failure_eject_.inc();
-        request->callbacks_.onPoolFailure(reason, conn.real_host_description_);
+        request.callbacks_->onPoolFailure(reason, conn.real_host_description_);
+        request.deactivate();
+        recyclePendingRequest(request, pending_requests_to_purge);
       }
     }
 
@@ -190,6 +211,13 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
     if (check_for_drained) {
       checkForDrained();
     }
+
+    // Replace the connection if prefetching was keeping it open. Connections that failed to
+    // connect or were closed by the host are not replaced, so that a host refusing or resetting
+    // connections is not reconnected to on every dispatcher iteration.
+    if (event == Network::ConnectionEvent::LocalClose && !conn.connect_timer_) {
+      schedulePrefetch();
+    }
   }
 
   if (conn.connect_timer_) {
@@ -211,7 +239,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
 void ConnPoolImpl::onPendingRequestCancel(PendingRequest& request,
                                           ConnectionPool::CancelPolicy cancel_policy) {
   ENVOY_LOG(debug, "canceling pending request");
-  request.removeFromList(pending_requests_);
+  releasePendingRequest(request);
   host_->cluster().stats().upstream_rq_cancelled_.inc();
 
   // If the cancel requests closure of excess connections and there are more pending connections
@@ -225,6 +253,21 @@ void ConnPoolImpl::onPendingRequestCancel(PendingRequest& request,
   checkForDrained();
 }
 
+void ConnPoolImpl::releasePendingRequest(PendingRequest& request) {
+  request.deactivate();
+  recyclePendingRequest(request, pending_requests_);
+}
+
+void ConnPoolImpl::recyclePendingRequest(PendingRequest& request,
+                                         std::list<PendingRequestPtr>& list) {
+  // Keeping every request would hold on to the memory of a burst for the life of the pool.
+  if (free_pending_requests_.size() < MaxFreePendingRequests) {
+    request.moveBetweenLists(list, free_pending_requests_);
+  } else {
+    request.removeFromList(list);
+  }
+}
+
 void ConnPoolImpl::onConnReleased(ActiveConn& conn) {
   ENVOY_CONN_LOG(debug, "connection released", *conn.conn_);
 
@@ -253,8 +296,39 @@ void ConnPoolImpl::onUpstreamReady() {
     // There is work to do so bind a connection to the caller and move it to the busy list. Pending
     // requests are pushed onto the front, so pull from the back.
     conn.moveBetweenLists(ready_conns_, busy_conns_);
-    assignConnection(conn, pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    PendingRequest& request = *pending_requests_.back();
+    assignConnection(conn, *request.callbacks_);
+    releasePendingRequest(request);
+  }
+
+  prefetchConnections();
+}
+
+bool ConnPoolImpl::prefetchEnabled() const {
+  // Hosts that fail health checks or have been ejected by outlier detection are not prefetched to,
+  // nor are hosts whose connections were drained and that have not been picked again since.
+  return (host_->cluster().perUpstreamPrefetchRatio() > 1.0 ||
+          host_->cluster().minWarmConnections() > 0) &&
+         !prefetch_suppressed_ && host_->health() != Upstream::Host::Health::Unhealthy;
+}
+
+void ConnPoolImpl::prefetchConnections() {
+  if (!prefetchEnabled() || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  // Connections in use, counting pending requests, are scaled by the prefetch ratio to give the
+  // number of connections to keep open.
+  const uint64_t demand = busy_conns_.size() + pending_requests_.size();
+  const uint64_t target =
+      std::max<uint64_t>(std::ceil(demand * host_->cluster().perUpstreamPrefetchRatio()),
+                         host_->cluster().minWarmConnections());
+  while (ready_conns_.size() + busy_conns_.size() + pending_conns_.size() < target &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    ENVOY_LOG(debug, "prefetching a connection");
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+    createNewConnection();
+    pending_conns_.front()->prefetched_ = true;
   }
 }
 
@@ -293,8 +367,9 @@ void ConnPoolImpl::processIdleConnection(ActiveConn& conn, bool new_connection,
     if (new_connection) {
       conn.moveBetweenLists(pending_conns_, busy_conns_);
     }
-    assignConnection(conn, pending_requests_.back()->callbacks_);
-    pending_requests_.pop_back();
+    PendingRequest& request = *pending_requests_.back();
+    assignConnection(conn, *request.callbacks_);
+    releasePendingRequest(request);
   }
 
   if (delay && !pending_requests_.empty() && !upstream_ready_enabled_) {
@@ -305,6 +380,15 @@ void ConnPoolImpl::processIdleConnection(ActiveConn& conn, bool new_connection,
   checkForDrained();
 }
 
+void ConnPoolImpl::schedulePrefetch() {
+  // Prefetching runs from the upstream ready timer so that new connections are established after
+  // the current caller has been served.
+  if (!upstream_ready_enabled_ && prefetchEnabled()) {
+    upstream_ready_enabled_ = true;
+    upstream_ready_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
 ConnPoolImpl::ConnectionWrapper::ConnectionWrapper(ActiveConn& parent) : parent_(parent) {
   parent_.parent_.host_->cluster().stats().upstream_rq_total_.inc();
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.inc();
@@ -337,15 +421,23 @@ void ConnPoolImpl::ConnectionWrapper::release(bool closed) {
   }
 }
 
-ConnPoolImpl::PendingRequest::PendingRequest(ConnPoolImpl& parent,
-                                             ConnectionPool::Callbacks& callbacks)
-    : parent_(parent), callbacks_(callbacks) {
+ConnPoolImpl::PendingRequest::~PendingRequest() {
+  if (callbacks_ != nullptr) {
+    deactivate();
+  }
+}
+
+void ConnPoolImpl::PendingRequest::activate(ConnectionPool::Callbacks& callbacks) {
+  ASSERT(callbacks_ == nullptr);
+  callbacks_ = &callbacks;
   parent_.host_->cluster().stats().upstream_rq_pending_total_.inc();
   parent_.host_->cluster().stats().upstream_rq_pending_active_.inc();
   parent_.host_->cluster().resourceManager(parent_.priority_).pendingRequests().inc();
 }
 
-ConnPoolImpl::PendingRequest::~PendingRequest() {
+void ConnPoolImpl::PendingRequest::deactivate() {
+  ASSERT(callbacks_ != nullptr);
+  callbacks_ = nullptr;
   parent_.host_->cluster().stats().upstream_rq_pending_active_.dec();
   parent_.host_->cluster().resourceManager(parent_.priority_).pendingRequests().dec();
 }
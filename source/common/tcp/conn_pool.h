@@ -116,21 +116,32 @@ protected:
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
     bool timed_out_;
+    // Set while a connection opened by prefetching has yet to be assigned.
+    bool prefetched_{};
   };
 
   typedef std::unique_ptr<ActiveConn> ActiveConnPtr;
 
+  // Pending requests are recycled through free_pending_requests_ rather than destroyed, so a
+  // request is bound to its caller by activate() and unbound by deactivate(). A caller must not
+  // use its handle once the request has been assigned, failed or cancelled, as the same object may
+  // already be queued for another caller.
   struct PendingRequest : LinkedObject<PendingRequest>, public ConnectionPool::Cancellable {
-    PendingRequest(ConnPoolImpl& parent, ConnectionPool::Callbacks& callbacks);
+    PendingRequest(ConnPoolImpl& parent) : parent_(parent) {}
     ~PendingRequest();
 
+    void activate(ConnectionPool::Callbacks& callbacks);
+    void deactivate();
+
     // ConnectionPool::Cancellable
     void cancel(ConnectionPool::CancelPolicy cancel_policy) override {
+      // Catches a stale handle used before its request is reused.
+      ASSERT(callbacks_ != nullptr);
       parent_.onPendingRequestCancel(*this, cancel_policy);
     }
 
     ConnPoolImpl& parent_;
-    ConnectionPool::Callbacks& callbacks_;
+    ConnectionPool::Callbacks* callbacks_{};
   };
 
   typedef std::unique_ptr<PendingRequest> PendingRequestPtr;
@@ -139,10 +150,15 @@ protected:
   void createNewConnection();
   void onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent event);
   void onPendingRequestCancel(PendingRequest& request, ConnectionPool::CancelPolicy cancel_policy);
+  void releasePendingRequest(PendingRequest& request);
+  void recyclePendingRequest(PendingRequest& request, std::list<PendingRequestPtr>& list);
   virtual void onConnReleased(ActiveConn& conn);
   virtual void onConnDestroyed(ActiveConn& conn);
   void onUpstreamReady();
+  bool prefetchEnabled() const;
+  void prefetchConnections();
   void processIdleConnection(ActiveConn& conn, bool new_connection, bool delay);
+  void schedulePrefetch();
   void checkForDrained();
 
   Event::Dispatcher& dispatcher_;
@@ -152,13 +168,18 @@ protected:
   Network::TransportSocketOptionsSharedPtr transport_socket_options_;
 
   std::list<ActiveConnPtr> pending_conns_; // conns awaiting connected event
-  std::list<ActiveConnPtr> ready_conns_;   // conns ready for assignment
+  std::list<ActiveConnPtr> ready_conns_;   // conns ready for assignment, most recently used first
   std::list<ActiveConnPtr> busy_conns_;    // conns assigned
   std::list<PendingRequestPtr> pending_requests_;
+  // Released requests kept for reuse, at most MaxFreePendingRequests of them.
+  static const size_t MaxFreePendingRequests = 64;
+  std::list<PendingRequestPtr> free_pending_requests_;
   std::list<DrainedCb> drained_callbacks_;
   Stats::TimespanPtr conn_connect_ms_;
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
+  // Set by drainConnections() until the next request, so that drained connections are not reopened.
+  bool prefetch_suppressed_{false};
 };
 
 } // namespace Tcp
@@ -1,5 +1,8 @@
 #include "common/tcp_proxy/tcp_proxy.h"
 
+#include <unistd.h>
+
+#include <cerrno>
 #include <cstdint>
 #include <string>
 
@@ -66,6 +69,7 @@ Config::SharedConfig::SharedConfig(
 Config::Config(const envoy::config::filter::network::tcp_proxy::v2::TcpProxy& config,
                Server::Configuration::FactoryContext& context)
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
+      splice_(config.splice()),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
       shared_config_(std::make_shared<SharedConfig>(config, context)),
       random_generator_(context.random()) {
@@ -169,6 +173,219 @@ UpstreamDrainManager& Config::drainManager() {
   return upstream_drain_manager_slot_->getTyped<UpstreamDrainManager>();
 }
 
+namespace {
+// The pipe size used when the connection that a pipe drains into has no buffer limit. This is the
+// default size of a Linux pipe.
+constexpr uint64_t DefaultSplicePipeCapacity = 64 * 1024;
+
+uint64_t splicePipeCapacity(const Network::Connection& destination) {
+  return destination.bufferLimit() > 0 ? destination.bufferLimit() : DefaultSplicePipeCapacity;
+}
+} // namespace
+
+SplicerPtr Splicer::create(Network::Connection& downstream, Network::Connection& upstream,
+                           const TcpProxyStats& stats, Upstream::ClusterStats& cluster_stats,
+                           StreamInfo::StreamInfo& stream_info, ActivityCb activity_cb) {
+  // Only bytes that no transport socket needs to see or transform can bypass the connections. A
+  // null ssl() isn't enough, as e.g. ALTS and not yet ready SDS sockets don't expose one.
+  if (!downstream.transportSocketIsPassthrough() || !upstream.transportSocketIsPassthrough() ||
+      downstream.state() != Network::Connection::State::Open ||
+      upstream.state() != Network::Connection::State::Open) {
+    return nullptr;
+  }
+
+  Network::SplicePipePtr to_upstream_pipe =
+      Network::SplicePipe::create(splicePipeCapacity(upstream));
+  Network::SplicePipePtr to_downstream_pipe =
+      Network::SplicePipe::create(splicePipeCapacity(downstream));
+  if (to_upstream_pipe == nullptr || to_downstream_pipe == nullptr) {
+    return nullptr;
+  }
+
+  const int downstream_fd = ::dup(downstream.ioHandle().fd());
+  if (downstream_fd == -1) {
+    return nullptr;
+  }
+  const int upstream_fd = ::dup(upstream.ioHandle().fd());
+  if (upstream_fd == -1) {
+    ::close(downstream_fd);
+    return nullptr;
+  }
+
+  SplicerPtr splicer(
+      new Splicer(downstream, stream_info, std::move(activity_cb), downstream_fd, upstream_fd));
+  splicer->to_upstream_ = std::make_unique<Direction>(
+      downstream, upstream, downstream_fd, upstream_fd, std::move(to_upstream_pipe),
+      stats.downstream_cx_rx_bytes_total_, cluster_stats.upstream_cx_tx_bytes_total_,
+      stats.downstream_flow_control_paused_reading_total_,
+      stats.downstream_flow_control_resumed_reading_total_, true);
+  splicer->to_downstream_ = std::make_unique<Direction>(
+      upstream, downstream, upstream_fd, downstream_fd, std::move(to_downstream_pipe),
+      cluster_stats.upstream_cx_rx_bytes_total_, stats.downstream_cx_tx_bytes_total_,
+      cluster_stats.upstream_flow_control_paused_reading_total_,
+      cluster_stats.upstream_flow_control_resumed_reading_total_, false);
+
+  // The connections stay read disabled until their direction stops, so that they never read the
+  // sockets at the same time as the splicer.
+  downstream.readDisable(true);
+  upstream.readDisable(true);
+
+  Splicer* raw_splicer = splicer.get();
+  splicer->downstream_event_ = downstream.dispatcher().createFileEvent(
+      downstream_fd,
+      [raw_splicer](uint32_t events) -> void {
+        raw_splicer->onFileEvent(events, raw_splicer->to_upstream_, raw_splicer->to_downstream_);
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  splicer->upstream_event_ = downstream.dispatcher().createFileEvent(
+      upstream_fd,
+      [raw_splicer](uint32_t events) -> void {
+        raw_splicer->onFileEvent(events, raw_splicer->to_downstream_, raw_splicer->to_upstream_);
+      },
+      Event::FileTriggerType::Edge, Event::FileReadyType::Read | Event::FileReadyType::Write);
+  return splicer;
+}
+
+Splicer::Splicer(Network::Connection& downstream, StreamInfo::StreamInfo& stream_info,
+                 ActivityCb activity_cb, int downstream_fd, int upstream_fd)
+    : downstream_(downstream), stream_info_(stream_info), activity_cb_(std::move(activity_cb)),
+      downstream_fd_(downstream_fd), upstream_fd_(upstream_fd) {}
+
+Splicer::~Splicer() {
+  downstream_event_.reset();
+  upstream_event_.reset();
+  ::close(downstream_fd_);
+  ::close(upstream_fd_);
+}
+
+bool Splicer::onData(Network::Connection& source, Buffer::Instance& data, bool end_stream) {
+  DirectionPtr& direction = &source == &downstream_ ? to_upstream_ : to_downstream_;
+  if (direction == nullptr) {
+    return false;
+  }
+  if (end_stream) {
+    stop(direction);
+    return false;
+  }
+
+  // The source connection only reads before splicing starts, so nothing has been spliced yet.
+  ASSERT(direction->pipe_->length() == 0);
+  direction->pending_.move(data);
+  relay(direction);
+  return true;
+}
+
+void Splicer::stop() {
+  if (to_upstream_ != nullptr) {
+    stop(to_upstream_);
+  }
+  if (to_downstream_ != nullptr) {
+    stop(to_downstream_);
+  }
+}
+
+void Splicer::onFileEvent(uint32_t events, DirectionPtr& reading, DirectionPtr& writing) {
+  if ((events & Event::FileReadyType::Read) && reading != nullptr) {
+    relay(reading);
+  }
+  if ((events & Event::FileReadyType::Write) && writing != nullptr) {
+    relay(writing);
+  }
+}
+
+bool Splicer::flushPending(DirectionPtr& direction) {
+  while (direction->pending_.length() > 0) {
+    const Api::SysCallIntResult result = direction->pending_.write(direction->destination_fd_);
+    if (result.rc_ == -1) {
+      if (result.errno_ != EAGAIN) {
+        stop(direction);
+      }
+      return false;
+    }
+    onSent(*direction, result.rc_);
+  }
+  return true;
+}
+
+void Splicer::relay(DirectionPtr& direction) {
+  if (!flushPending(direction)) {
+    return;
+  }
+
+  Network::SplicePipe& pipe = *direction->pipe_;
+  while (true) {
+    if (!pipe.full()) {
+      const Api::SysCallSizeResult result = pipe.fill(direction->source_fd_);
+      ENVOY_CONN_LOG(trace, "splice read returns: {}", direction->source_, result.rc_);
+      if (result.rc_ == 0 || (result.rc_ == -1 && result.errno_ != EAGAIN)) {
+        // The source connection reads the end of stream or the error again once it is handed
+        // back, and deals with it as usual.
+        stop(direction);
+        return;
+      }
+      if (result.rc_ > 0) {
+        direction->rx_bytes_.add(result.rc_);
+        if (direction->downstream_source_) {
+          stream_info_.addBytesReceived(result.rc_);
+        } else {
+          stream_info_.addBytesSent(result.rc_);
+        }
+        activity_cb_();
+      }
+    }
+
+    if (pipe.length() == 0) {
+      return;
+    }
+
+    const Api::SysCallSizeResult result = pipe.drain(direction->destination_fd_);
+    ENVOY_CONN_LOG(trace, "splice write returns: {}", direction->destination_, result.rc_);
+    if (result.rc_ == -1) {
+      if (result.errno_ != EAGAIN) {
+        stop(direction);
+      } else if (pipe.full() && !direction->paused_) {
+        // Reading the source waits for the destination to take data, which is what a connection
+        // does when the write buffer of its peer is above the high watermark.
+        direction->paused_ = true;
+        direction->paused_reading_.inc();
+      }
+      return;
+    }
+    onSent(*direction, result.rc_);
+  }
+}
+
+void Splicer::onSent(Direction& direction, uint64_t bytes) {
+  direction.tx_bytes_.add(bytes);
+  if (direction.paused_ && !direction.pipe_->full()) {
+    direction.paused_ = false;
+    direction.resumed_reading_.inc();
+  }
+  activity_cb_();
+}
+
+void Splicer::stop(DirectionPtr& direction) {
+  ENVOY_CONN_LOG(debug, "stopped splicing", direction->source_);
+  if (direction->paused_) {
+    direction->resumed_reading_.inc();
+  }
+
+  // Data that was read but not sent yet goes ahead of anything the source connection reads from
+  // now on.
+  Buffer::OwnedImpl data;
+  data.move(direction->pending_);
+  direction->pipe_->moveTo(data);
+  if (data.length() > 0 && direction->destination_.state() == Network::Connection::State::Open) {
+    direction->destination_.write(data, false);
+  }
+
+  Network::Connection& source = direction->source_;
+  direction.reset();
+  if (source.state() == Network::Connection::State::Open) {
+    source.readDisable(false);
+  }
+}
+
 Filter::Filter(ConfigSharedPtr config, Upstream::ClusterManager& cluster_manager,
                TimeSource& time_source)
     : config_(config), cluster_manager_(cluster_manager), downstream_callbacks_(*this),
@@ -441,6 +658,12 @@ void Filter::onPoolReady(Tcp::ConnectionPool::ConnectionDataPtr&& conn_data,
   // Simulate the event that onPoolReady represents.
   upstream_callbacks_->onEvent(Network::ConnectionEvent::Connected);
 
+  // Splicing starts before any downstream data is relayed, so that the splicer sends all of it in
+  // order.
+  if (config_->splice()) {
+    startSplice();
+  }
+
   read_callbacks_->continueReading();
 }
 
@@ -457,13 +680,20 @@ Network::FilterStatus Filter::onData(Buffer::Instance& data, bool end_stream) {
   ENVOY_CONN_LOG(trace, "downstream connection received {} bytes, end_stream={}",
                  read_callbacks_->connection(), data.length(), end_stream);
   getStreamInfo().addBytesReceived(data.length());
-  upstream_conn_data_->connection().write(data, end_stream);
+  if (splicer_ == nullptr || !splicer_->onData(read_callbacks_->connection(), data, end_stream)) {
+    upstream_conn_data_->connection().write(data, end_stream);
+  }
   ASSERT(0 == data.length());
   resetIdleTimer(); // TODO(ggreenway) PERF: do we need to reset timer on both send and receive?
   return Network::FilterStatus::StopIteration;
 }
 
 void Filter::onDownstreamEvent(Network::ConnectionEvent event) {
+  if (event == Network::ConnectionEvent::RemoteClose ||
+      event == Network::ConnectionEvent::LocalClose) {
+    stopSplice();
+  }
+
   if (upstream_conn_data_) {
     if (event == Network::ConnectionEvent::RemoteClose) {
       upstream_conn_data_->connection().close(Network::ConnectionCloseType::FlushWrite);
@@ -499,7 +729,10 @@ void Filter::onUpstreamData(Buffer::Instance& data, bool end_stream) {
   ENVOY_CONN_LOG(trace, "upstream connection received {} bytes, end_stream={}",
                  read_callbacks_->connection(), data.length(), end_stream);
   getStreamInfo().addBytesSent(data.length());
-  read_callbacks_->connection().write(data, end_stream);
+  if (splicer_ == nullptr ||
+      !splicer_->onData(upstream_conn_data_->connection(), data, end_stream)) {
+    read_callbacks_->connection().write(data, end_stream);
+  }
   ASSERT(0 == data.length());
   resetIdleTimer(); // TODO(ggreenway) PERF: do we need to reset timer on both send and receive?
 }
@@ -512,6 +745,7 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
 
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
+    stopSplice();
     upstream_conn_data_.reset();
     disableIdleTimer();
 
@@ -564,6 +798,25 @@ void Filter::onIdleTimeout() {
   read_callbacks_->connection().close(Network::ConnectionCloseType::NoFlush);
 }
 
+void Filter::startSplice() {
+  splicer_ = Splicer::create(read_callbacks_->connection(), upstream_conn_data_->connection(),
+                             config_->stats(), read_callbacks_->upstreamHost()->cluster().stats(),
+                             getStreamInfo(), [this]() -> void { resetIdleTimer(); });
+  if (splicer_ != nullptr) {
+    ENVOY_CONN_LOG(debug, "splicing data to and from upstream", read_callbacks_->connection());
+    config_->stats().splice_total_.inc();
+  } else {
+    config_->stats().splice_fallback_.inc();
+  }
+}
+
+void Filter::stopSplice() {
+  if (splicer_ != nullptr) {
+    splicer_->stop();
+    splicer_.reset();
+  }
+}
+
 void Filter::resetIdleTimer() {
   if (idle_timer_ != nullptr) {
     ASSERT(config_->idleTimeout());
@@ -8,6 +8,7 @@
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/config/filter/network/tcp_proxy/v2/tcp_proxy.pb.h"
+#include "envoy/event/file_event.h"
 #include "envoy/event/timer.h"
 #include "envoy/network/connection.h"
 #include "envoy/network/filter.h"
@@ -21,9 +22,11 @@
 #include "envoy/upstream/cluster_manager.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
 #include "common/network/cidr_range.h"
 #include "common/network/filter_impl.h"
+#include "common/network/splice_pipe.h"
 #include "common/network/utility.h"
 #include "common/stream_info/stream_info_impl.h"
 #include "common/upstream/load_balancer_impl.h"
@@ -45,6 +48,8 @@ namespace TcpProxy {
   COUNTER(downstream_flow_control_paused_reading_total)                                            \
   COUNTER(downstream_flow_control_resumed_reading_total)                                           \
   COUNTER(idle_timeout)                                                                            \
+  COUNTER(splice_total)                                                                            \
+  COUNTER(splice_fallback)                                                                         \
   COUNTER(upstream_flush_total)                                                                    \
   GAUGE  (upstream_flush_active)
 // clang-format on
@@ -107,6 +112,7 @@ public:
   const TcpProxyStats& stats() { return shared_config_->stats(); }
   const std::vector<AccessLog::InstanceSharedPtr>& accessLogs() { return access_logs_; }
   uint32_t maxConnectAttempts() const { return max_connect_attempts_; }
+  bool splice() const { return splice_; }
   const absl::optional<std::chrono::milliseconds>& idleTimeout() {
     return shared_config_->idleTimeout();
   }
@@ -147,6 +153,7 @@ private:
   uint64_t total_cluster_weight_;
   std::vector<AccessLog::InstanceSharedPtr> access_logs_;
   const uint32_t max_connect_attempts_;
+  const bool splice_;
   ThreadLocal::SlotPtr upstream_drain_manager_slot_;
   SharedConfigSharedPtr shared_config_;
   std::unique_ptr<const Router::MetadataMatchCriteria> cluster_metadata_match_criteria_;
@@ -168,6 +175,103 @@ private:
   const std::string cluster_;
 };
 
+/**
+ * Relays the data of a TCP proxy session between the downstream and upstream sockets with
+ * splice(2), so that it is never copied into user space. Each direction goes through its own pipe
+ * until it reaches end of stream or an error. The rest of that direction is then handed back to
+ * the connections, which read and write it as usual.
+ *
+ * While a direction is spliced its source connection is read disabled, and the splicer keeps the
+ * stats of both connections as they would have been kept by the connections themselves.
+ */
+class Splicer : Logger::Loggable<Logger::Id::filter> {
+public:
+  typedef std::function<void()> ActivityCb;
+
+  /**
+   * @param downstream supplies the downstream connection.
+   * @param upstream supplies the established upstream connection.
+   * @param stats supplies the TCP proxy stats, which hold the downstream connection stats.
+   * @param cluster_stats supplies the stats of the upstream cluster.
+   * @param stream_info supplies the stream info that counts the bytes relayed.
+   * @param activity_cb supplies the callback to invoke whenever data is relayed.
+   * @return a splicer relaying both directions, or nullptr if the sockets can't be spliced.
+   */
+  static std::unique_ptr<Splicer> create(Network::Connection& downstream,
+                                         Network::Connection& upstream, const TcpProxyStats& stats,
+                                         Upstream::ClusterStats& cluster_stats,
+                                         StreamInfo::StreamInfo& stream_info,
+                                         ActivityCb activity_cb);
+  ~Splicer();
+
+  /**
+   * Takes data that a connection read before splicing started, to be sent ahead of the data
+   * spliced in the same direction. Data that ends the stream stops splicing that direction.
+   * @param source supplies the connection that read the data.
+   * @param data supplies the data, which is drained if the splicer takes it.
+   * @param end_stream supplies whether the data ends the stream.
+   * @return true if the data was taken. Otherwise the direction is no longer spliced and the
+   *         caller relays the data as usual.
+   */
+  bool onData(Network::Connection& source, Buffer::Instance& data, bool end_stream);
+
+  /**
+   * Stops splicing both directions. Data that was read but not yet sent is handed to the
+   * destination connections, which are left to flush it.
+   */
+  void stop();
+
+private:
+  struct Direction {
+    Direction(Network::Connection& source, Network::Connection& destination, int source_fd,
+              int destination_fd, Network::SplicePipePtr&& pipe, Stats::Counter& rx_bytes,
+              Stats::Counter& tx_bytes, Stats::Counter& paused_reading,
+              Stats::Counter& resumed_reading, bool downstream_source)
+        : source_(source), destination_(destination), source_fd_(source_fd),
+          destination_fd_(destination_fd), pipe_(std::move(pipe)), rx_bytes_(rx_bytes),
+          tx_bytes_(tx_bytes), paused_reading_(paused_reading), resumed_reading_(resumed_reading),
+          downstream_source_(downstream_source) {}
+
+    Network::Connection& source_;
+    Network::Connection& destination_;
+    const int source_fd_;
+    const int destination_fd_;
+    Network::SplicePipePtr pipe_;
+    // Data read by the source connection before splicing started, which goes out first.
+    Buffer::OwnedImpl pending_;
+    Stats::Counter& rx_bytes_;
+    Stats::Counter& tx_bytes_;
+    Stats::Counter& paused_reading_;
+    Stats::Counter& resumed_reading_;
+    const bool downstream_source_;
+    bool paused_{};
+  };
+  typedef std::unique_ptr<Direction> DirectionPtr;
+
+  Splicer(Network::Connection& downstream, StreamInfo::StreamInfo& stream_info,
+          ActivityCb activity_cb, int downstream_fd, int upstream_fd);
+
+  void onFileEvent(uint32_t events, DirectionPtr& reading, DirectionPtr& writing);
+  bool flushPending(DirectionPtr& direction);
+  void relay(DirectionPtr& direction);
+  void onSent(Direction& direction, uint64_t bytes);
+  void stop(DirectionPtr& direction);
+
+  Network::Connection& downstream_;
+  StreamInfo::StreamInfo& stream_info_;
+  const ActivityCb activity_cb_;
+  // Duplicates of the connections' sockets, so that the events registered on them can never fire
+  // for a socket that reuses the descriptor after a connection closes its own.
+  const int downstream_fd_;
+  const int upstream_fd_;
+  DirectionPtr to_upstream_;
+  DirectionPtr to_downstream_;
+  Event::FileEventPtr downstream_event_;
+  Event::FileEventPtr upstream_event_;
+};
+
+typedef std::unique_ptr<Splicer> SplicerPtr;
+
 /**
  * An implementation of a TCP (L3/L4) proxy. This filter will instantiate a new outgoing TCP
  * connection using the defined load balancing proxy for the configured cluster. All data will
@@ -273,6 +377,8 @@ protected:
   void onIdleTimeout();
   void resetIdleTimer();
   void disableIdleTimer();
+  void startSplice();
+  void stopSplice();
 
   const ConfigSharedPtr config_;
   Upstream::ClusterManager& cluster_manager_;
@@ -284,6 +390,7 @@ protected:
   std::shared_ptr<UpstreamCallbacks> upstream_callbacks_; // shared_ptr required for passing as a
                                                           // read filter.
   StreamInfo::StreamInfoImpl stream_info_;
+  SplicerPtr splicer_;
   uint32_t connect_attempts_{};
   bool connecting_{};
 };
@@ -1,11 +1,13 @@
 #include "common/upstream/cluster_manager_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "envoy/admin/v2alpha/config_dump.pb.h"
@@ -24,6 +26,7 @@
 #include "common/http/async_client_impl.h"
 #include "common/http/http1/conn_pool.h"
 #include "common/http/http2/conn_pool.h"
+#include "common/http/http2/shared_conn_pool.h"
 #include "common/json/config_schemas.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/utility.h"
@@ -41,6 +44,48 @@
 namespace Envoy {
 namespace Upstream {
 
+namespace {
+
+uint64_t updateMergeWindowMs(const ClusterInfo& info) {
+  return PROTOBUF_GET_MS_OR_DEFAULT(info.lbConfig(), update_merge_window, 1000);
+}
+
+// Membership changes are only merged if there is a merge window to merge them in.
+bool mergesMembershipUpdates(const ClusterInfo& info) {
+  return info.lbConfig().merge_membership_updates() && updateMergeWindowMs(info) > 0;
+}
+
+// Appends `hosts` to `pending`, except for the hosts found in `opposite`: those cancel out with
+// the earlier change the workers have not seen yet, so they are dropped from `opposite` instead.
+void mergeHostChange(const HostVector& hosts, HostVector& pending, HostVector& opposite) {
+  if (opposite.empty()) {
+    pending.insert(pending.end(), hosts.begin(), hosts.end());
+    return;
+  }
+
+  std::unordered_set<const Host*> opposite_hosts;
+  for (const auto& host : opposite) {
+    opposite_hosts.insert(host.get());
+  }
+  std::unordered_set<const Host*> cancelled;
+  for (const auto& host : hosts) {
+    if (opposite_hosts.count(host.get()) > 0) {
+      cancelled.insert(host.get());
+    } else {
+      pending.push_back(host);
+    }
+  }
+  if (!cancelled.empty()) {
+    opposite.erase(std::remove_if(opposite.begin(), opposite.end(),
+                                  [&cancelled](const HostSharedPtr& host) {
+                                    return cancelled.count(host.get()) > 0;
+                                  }),
+                   opposite.end());
+  }
+}
+
+} // namespace
+
 void ClusterManagerInitHelper::addCluster(Cluster& cluster) {
   // See comments in ClusterManagerImpl::addOrUpdateCluster() for why this is only called during
   // server initialization.
@@ -300,11 +345,10 @@ void ClusterManagerImpl::onClusterInit(Cluster& cluster) {
   // Now setup for cross-thread updates.
   cluster.prioritySet().addMemberUpdateCb(
       [&cluster, this](const HostVector&, const HostVector& hosts_removed) -> void {
-        // TODO(snowp): Should this be subject to merge windows?
-
         // Whenever hosts are removed from the cluster, we make each TLS cluster drain it's
-        // connection pools for the removed hosts.
-        if (!hosts_removed.empty()) {
+        // connection pools for the removed hosts. If membership updates are merged, this is
+        // done when the merged update is delivered instead (see postPendingUpdates()).
+        if (!hosts_removed.empty() && !mergesMembershipUpdates(*cluster.info())) {
           postThreadLocalHostRemoval(cluster, hosts_removed);
         }
       });
@@ -317,26 +361,25 @@ void ClusterManagerImpl::onClusterInit(Cluster& cluster) {
 
     // Should we save this update and merge it with other updates?
     //
-    // Note that we can only _safely_ merge updates that have no added/removed hosts. That is,
-    // only those updates that signal a change in host healthcheck state, weight or metadata.
+    // By default we only merge updates that have no added/removed hosts. That is, only those
+    // updates that signal a change in host healthcheck state, weight or metadata.
     //
-    // We've discussed merging updates related to hosts being added/removed, but it's really
-    // tricky to merge those given that downstream consumers of these updates expect to see the
-    // full list of updates, not a condensed one. This is because they use the broadcasted
-    // HostSharedPtrs within internal maps to track hosts. If we fail to broadcast the entire list
-    // of removals, these maps will leak those HostSharedPtrs.
-    //
-    // See https://github.com/envoyproxy/envoy/pull/3941 for more context.
+    // Downstream consumers of these updates use the broadcasted HostSharedPtrs within internal
+    // maps to track hosts, so if we fail to broadcast a removal these maps will leak those
+    // HostSharedPtrs (see https://github.com/envoyproxy/envoy/pull/3941 for more context). When
+    // `merge_membership_updates` is set, the added/removed hosts are folded into a single net
+    // change per merge window instead, so that every host the workers have seen being added is
+    // eventually seen being removed.
     bool scheduled = false;
-    const auto merge_timeout =
-        PROTOBUF_GET_MS_OR_DEFAULT(cluster.info()->lbConfig(), update_merge_window, 1000);
-    // Remember: we only merge updates with no adds/removes — just hc/weight/metadata changes.
-    const bool is_mergeable = !hosts_added.size() && !hosts_removed.size();
+    const auto merge_timeout = updateMergeWindowMs(*cluster.info());
+    const bool is_mergeable = mergesMembershipUpdates(*cluster.info()) ||
+                              (!hosts_added.size() && !hosts_removed.size());
 
     if (merge_timeout > 0) {
       // If this is not mergeable, we should cancel any scheduled updates since
       // we'll deliver it immediately.
-      scheduled = scheduleUpdate(cluster, priority, is_mergeable, merge_timeout);
+      scheduled = scheduleUpdate(cluster, priority, is_mergeable, merge_timeout, hosts_added,
+                                 hosts_removed);
     }
 
     // If an update was not scheduled for later, deliver it immediately.
@@ -356,8 +399,15 @@ void ClusterManagerImpl::onClusterInit(Cluster& cluster) {
   }
 }
 
+void ClusterManagerImpl::PendingUpdates::mergeMembership(const HostVector& hosts_added,
+                                                         const HostVector& hosts_removed) {
+  mergeHostChange(hosts_removed, hosts_removed_, hosts_added_);
+  mergeHostChange(hosts_added, hosts_added_, hosts_removed_);
+}
+
 bool ClusterManagerImpl::scheduleUpdate(const Cluster& cluster, uint32_t priority, bool mergeable,
-                                        const uint64_t timeout) {
+                                        const uint64_t timeout, const HostVector& hosts_added,
+                                        const HostVector& hosts_removed) {
   // Find pending updates for this cluster.
   auto& updates_by_prio = updates_map_[cluster.info()->name()];
   if (!updates_by_prio) {
@@ -396,9 +446,23 @@ bool ClusterManagerImpl::scheduleUpdate(const Cluster& cluster, uint32_t priorit
     }
 
     updates->last_updated_ = time_source_.monotonicTime();
+
+    // With merged membership updates, removals were not broadcast when they happened, and
+    // there may be adds/removes left over from the cancelled window: deliver all of it here.
+    if (mergesMembershipUpdates(*cluster.info())) {
+      updates->mergeMembership(hosts_added, hosts_removed);
+      cm_stats_.cluster_updated_.inc();
+      postPendingUpdates(cluster, priority, *updates);
+      return true;
+    }
     return false;
   }
 
+  updates->mergeMembership(hosts_added, hosts_removed);
+  if (updates->timer_enabled_) {
+    cm_stats_.update_merged_.inc();
+  }
+
   // If there's no timer, create one.
   if (updates->timer_ == nullptr) {
     updates->timer_ = dispatcher_.createTimer([this, &cluster, priority, &updates]() -> void {
@@ -417,14 +481,7 @@ bool ClusterManagerImpl::scheduleUpdate(const Cluster& cluster, uint32_t priorit
 void ClusterManagerImpl::applyUpdates(const Cluster& cluster, uint32_t priority,
                                       PendingUpdates& updates) {
   // Deliver pending updates.
-
-  // Remember that these merged updates are _only_ for updates related to
-  // HC/weight/metadata changes. That's why added/removed are empty. All
-  // adds/removals were already immediately broadcasted.
-  static const HostVector hosts_added;
-  static const HostVector hosts_removed;
-
-  postThreadLocalClusterUpdate(cluster, priority, hosts_added, hosts_removed);
+  postPendingUpdates(cluster, priority, updates);
 
   cm_stats_.cluster_updated_via_merge_.inc();
   updates.timer_enabled_ = false;
@@ -671,6 +728,22 @@ void ClusterManagerImpl::postThreadLocalHostRemoval(const Cluster& cluster,
   });
 }
 
+void ClusterManagerImpl::postPendingUpdates(const Cluster& cluster, uint32_t priority,
+                                            PendingUpdates& updates) {
+  // Unless membership updates are merged, the added/removed lists are empty: the merged updates
+  // are then _only_ for HC/weight/metadata changes, and all adds/removals were already
+  // immediately broadcasted.
+  HostVector hosts_added;
+  HostVector hosts_removed;
+  hosts_added.swap(updates.hosts_added_);
+  hosts_removed.swap(updates.hosts_removed_);
+
+  if (!hosts_removed.empty()) {
+    postThreadLocalHostRemoval(cluster, hosts_removed);
+  }
+  postThreadLocalClusterUpdate(cluster, priority, hosts_added, hosts_removed);
+}
+
 void ClusterManagerImpl::postThreadLocalClusterUpdate(const Cluster& cluster, uint32_t priority,
                                                       const HostVector& hosts_added,
                                                       const HostVector& hosts_removed) {
@@ -796,6 +869,11 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
     const absl::optional<std::string>& local_cluster_name)
     : parent_(parent), thread_local_dispatcher_(dispatcher) {
+  if (&dispatcher != &parent.dispatcher_) {
+    Event::Dispatcher* no_owner = nullptr;
+    parent.shared_http2_dispatcher_.compare_exchange_strong(no_owner, &dispatcher);
+  }
+
   // If local cluster is defined then we need to initialize it first.
   if (local_cluster_name) {
     ENVOY_LOG(debug, "adding TLS local cluster {}", local_cluster_name.value());
@@ -1078,6 +1156,14 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::ClusterEntry(
           parent.parent_.random_, cluster->lbConfig(), cluster->lbLeastRequestConfig());
       break;
     }
+    case LoadBalancerType::PeakEwma: {
+      ASSERT(lb_factory_ == nullptr);
+      lb_ = std::make_unique<PeakEwmaLoadBalancer>(
+          priority_set_, parent_.local_priority_set_, cluster->stats(), parent.parent_.runtime_,
+          parent.parent_.random_, parent.thread_local_dispatcher_.timeSource(), cluster->lbConfig(),
+          cluster->lbPeakEwmaConfig());
+      break;
+    }
     case LoadBalancerType::Random: {
       ASSERT(lb_factory_ == nullptr);
       lb_ = std::make_unique<RandomLoadBalancer>(priority_set_, parent_.local_priority_set_,
@@ -1121,6 +1207,38 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::~ClusterEntry()
   }
 }
 
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::sharedHttp2ConnPool(
+    const HostConstSharedPtr& host, ResourcePriority priority) {
+  // On the owning worker this is also reached from other workers' handoffs, which may arrive after
+  // the cluster has been removed.
+  if (destroying_ || thread_local_clusters_.count(host->cluster().name()) == 0) {
+    return nullptr;
+  }
+
+  Event::Dispatcher* owner_dispatcher = parent_.shared_http2_dispatcher_;
+  ASSERT(owner_dispatcher != nullptr);
+  const std::vector<uint8_t> hash_key = {uint8_t(Http::Protocol::Http2), uint8_t(priority)};
+  ConnPoolsContainer& container = *getHttpConnPoolsContainer(host, true);
+  ConnPoolsContainer::ConnPools::OptPoolRef pool =
+      container.pools_->getPool(hash_key, [&]() -> Http::ConnectionPool::InstancePtr {
+        if (owner_dispatcher == &thread_local_dispatcher_) {
+          return parent_.factory_.allocateConnPool(thread_local_dispatcher_, host, priority,
+                                                   Http::Protocol::Http2, nullptr);
+        }
+
+        ClusterManagerImpl& cluster_manager = parent_;
+        return std::make_unique<Http::Http2::SharedConnPoolImpl>(
+            thread_local_dispatcher_, *owner_dispatcher,
+            [&cluster_manager, host, priority]() -> Http::ConnectionPool::Instance* {
+              return cluster_manager.tls_->getTyped<ThreadLocalClusterManagerImpl>()
+                  .sharedHttp2ConnPool(host, priority);
+            });
+      });
+  ASSERT(pool.has_value(), "Pool allocation should never fail");
+  return &(pool.value().get());
+}
+
 Http::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     ResourcePriority priority, Http::Protocol protocol, LoadBalancerContext* context) {
@@ -1131,6 +1249,12 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     return nullptr;
   }
 
+  if (protocol == Http::Protocol::Http2 &&
+      (cluster_info_->features() & ClusterInfo::Features::SHARE_HTTP2_CONNECTIONS_ACROSS_WORKERS) &&
+      parent_.parent_.shared_http2_dispatcher_ != nullptr) {
+    return parent_.sharedHttp2ConnPool(host, priority);
+  }
+
   // Inherit socket options from downstream connection, if set.
   std::vector<uint8_t> hash_key = {uint8_t(protocol), uint8_t(priority)};
 
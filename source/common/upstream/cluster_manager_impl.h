@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <list>
@@ -146,6 +147,7 @@ private:
   COUNTER(cluster_updated)                                                                         \
   COUNTER(cluster_updated_via_merge)                                                               \
   COUNTER(update_merge_cancelled)                                                                  \
+  COUNTER(update_merged)                                                                           \
   COUNTER(update_out_of_merge_window)                                                              \
   GAUGE  (active_clusters)                                                                         \
   GAUGE  (warming_clusters)
@@ -331,6 +333,8 @@ private:
 
     ConnPoolsContainer* getHttpConnPoolsContainer(const HostConstSharedPtr& host,
                                                   bool allocate = false);
+    Http::ConnectionPool::Instance* sharedHttp2ConnPool(const HostConstSharedPtr& host,
+                                                        ResourcePriority priority);
 
     ClusterManagerImpl& parent_;
     Event::Dispatcher& thread_local_dispatcher_;
@@ -405,6 +409,10 @@ private:
       }
       return was_enabled;
     }
+    void mergeMembership(const HostVector& hosts_added, const HostVector& hosts_removed);
+    bool hasMembershipChanges() const {
+      return !hosts_added_.empty() || !hosts_removed_.empty();
+    }
 
     Event::TimerPtr timer_;
     // TODO(rgs1): this should be part of Event::Timer's interface.
@@ -416,6 +424,10 @@ private:
     // `Cluster.CommonLbConfig.update_merge_window`, the first update will trigger immediately
     // (the expected behavior).
     MonotonicTime last_updated_;
+    // Net membership change not yet delivered to the workers. Only used when
+    // `Cluster.CommonLbConfig.merge_membership_updates` is set.
+    HostVector hosts_added_;
+    HostVector hosts_removed_;
   };
   using PendingUpdatesPtr = std::unique_ptr<PendingUpdates>;
   using PendingUpdatesByPriorityMap = std::unordered_map<uint32_t, PendingUpdatesPtr>;
@@ -423,8 +435,10 @@ private:
   using ClusterUpdatesMap = std::unordered_map<std::string, PendingUpdatesByPriorityMapPtr>;
 
   void applyUpdates(const Cluster& cluster, uint32_t priority, PendingUpdates& updates);
+  void postPendingUpdates(const Cluster& cluster, uint32_t priority, PendingUpdates& updates);
   bool scheduleUpdate(const Cluster& cluster, uint32_t priority, bool mergeable,
-                      const uint64_t timeout);
+                      const uint64_t timeout, const HostVector& hosts_added,
+                      const HostVector& hosts_removed);
   void createOrUpdateThreadLocalCluster(ClusterData& cluster);
   ProtobufTypes::MessagePtr dumpClusterConfigs();
   static ClusterManagerStats generateStats(Stats::Scope& scope);
@@ -461,6 +475,9 @@ private:
   ClusterUpdatesMap updates_map_;
   Event::Dispatcher& dispatcher_;
   Http::Context& http_context_;
+  // The worker that owns the connections of clusters that share HTTP/2 connections across workers.
+  // This is the first worker to set up its thread local cluster manager.
+  std::atomic<Event::Dispatcher*> shared_http2_dispatcher_{};
 };
 
 } // namespace Upstream
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
-#include <queue>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "common/common/assert.h"
 
@@ -22,7 +26,8 @@ namespace Upstream {
 // (https://en.wikipedia.org/wiki/Earliest_deadline_first_scheduling) used for weighted round robin.
 // Each pick from the schedule has the earliest deadline entry selected. Entries have deadlines set
 // at current time + 1 / weight, providing weighted round robin behavior with floating point
-// weights and an O(log n) pick time.
+// weights and an O(log n) pick time. Entries can be removed in O(1); they are discarded when they
+// next reach the front of the queue.
 template <class C> class EdfScheduler {
 public:
   /**
@@ -37,17 +42,17 @@ public:
         EDF_TRACE("Queue is empty.");
         return nullptr;
       }
-      const EdfEntry& edf_entry = queue_.top();
-      // Entry has been removed, let's see if there's another one.
-      if (edf_entry.entry_.expired()) {
-        EDF_TRACE("Entry has expired, repick.");
-        queue_.pop();
+      const EdfEntry& edf_entry = queue_.front();
+      std::shared_ptr<C> ret = edf_entry.entry_.lock();
+      // Entry has expired or has been removed, let's see if there's another one.
+      if (ret == nullptr || (!removed_.empty() && removed_.erase(ret.get()) > 0)) {
+        EDF_TRACE("Entry has expired or been removed, repick.");
+        pop();
         continue;
       }
-      std::shared_ptr<C> ret{edf_entry.entry_};
       ASSERT(edf_entry.deadline_ >= current_time_);
       current_time_ = edf_entry.deadline_;
-      queue_.pop();
+      pop();
       EDF_TRACE("Picked {}, current_time_={}.", static_cast<const void*>(ret.get()), current_time_);
       return ret;
     }
@@ -60,11 +65,42 @@ public:
    */
   void add(double weight, std::shared_ptr<C> entry) {
     ASSERT(weight > 0);
+    // An entry that was removed but is still queued keeps its existing deadline.
+    if (!removed_.empty() && removed_.erase(entry.get()) > 0) {
+      EDF_TRACE("Reinstated {} in queue.", static_cast<const void*>(entry.get()));
+      return;
+    }
     const double deadline = current_time_ + 1.0 / weight;
     EDF_TRACE("Insertion {} in queue with deadline {} and weight {}.",
               static_cast<const void*>(entry.get()), deadline, weight);
-    queue_.push({deadline, order_offset_++, entry});
-    ASSERT(queue_.top().deadline_ >= current_time_);
+    queue_.push_back({deadline, order_offset_++, entry});
+    std::push_heap(queue_.begin(), queue_.end());
+    ASSERT(queue_.front().deadline_ >= current_time_);
+  }
+
+  /**
+   * Remove an entry from the queue. The entry is discarded the next time it reaches the front of
+   * the queue, and a reference to it is retained until then.
+   * @param entry shared pointer to an entry currently in the queue.
+   */
+  void remove(std::shared_ptr<C> entry) {
+    EDF_TRACE("Removal of {} from queue.", static_cast<const void*>(entry.get()));
+    C* key = entry.get();
+    removed_.emplace(key, std::move(entry));
+  }
+
+  /**
+   * Invoke a callback for each entry in the queue that has neither expired nor been removed, in
+   * no particular order.
+   * @param cb supplies the callback to invoke.
+   */
+  void forEach(const std::function<void(const std::shared_ptr<C>&)>& cb) const {
+    for (const EdfEntry& edf_entry : queue_) {
+      const std::shared_ptr<C> entry = edf_entry.entry_.lock();
+      if (entry != nullptr && removed_.count(entry.get()) == 0) {
+        cb(entry);
+      }
+    }
   }
 
   /**
@@ -73,13 +109,24 @@ public:
    */
   bool empty() const { return queue_.empty(); }
 
+  /**
+   * @return size_t the number of entries in the internal queue, including expired and removed
+   *         entries that have not been discarded yet.
+   */
+  size_t size() const { return queue_.size(); }
+
 private:
+  void pop() {
+    std::pop_heap(queue_.begin(), queue_.end());
+    queue_.pop_back();
+  }
+
   struct EdfEntry {
     double deadline_;
     // Tie breaker for entries with the same deadline. This is used to provide FIFO behavior.
     uint64_t order_offset_;
-    // We only hold a weak pointer, since we don't support a remove operator. This allows entries to
-    // be lazily unloaded from the queue.
+    // We only hold a weak pointer, which allows entries to be lazily unloaded from the queue when
+    // they are destroyed.
     std::weak_ptr<C> entry_;
 
     // Flip < direction to make this a min queue.
@@ -96,8 +143,11 @@ private:
   // Offset used during addition to break ties when entries have the same weight but should reflect
   // FIFO insertion order in picks.
   uint64_t order_offset_{};
-  // Min priority queue for EDF.
-  std::priority_queue<EdfEntry> queue_;
+  // Min priority queue for EDF, kept as a heap so that the entries can be iterated.
+  std::vector<EdfEntry> queue_;
+  // Entries removed from the queue but not discarded yet. Holding a reference ensures that a new
+  // entry can't be allocated at the address of a removed one while it is still queued.
+  std::unordered_map<const C*, std::shared_ptr<C>> removed_;
 };
 
 #undef EDF_DEBUG
@@ -597,11 +597,9 @@ EdfLoadBalancerBase::EdfLoadBalancerBase(
     : ZoneAwareLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
                                 common_config),
       seed_(random_.random()) {
-  // We fully recompute the schedulers for a given host set here on membership change, which is
-  // consistent with what other LB implementations do (e.g. thread aware).
-  // The downside of a full recompute is that time complexity is O(n * log n),
-  // so we will need to do better at delta tracking to scale (see
-  // https://github.com/envoyproxy/envoy/issues/2874).
+  // We recompute the schedulers for a given host set here on membership change. Health changes
+  // don't come with a list of added/removed hosts, so refresh() works out the delta for each
+  // host source itself (see https://github.com/envoyproxy/envoy/issues/2874).
   priority_set.addPriorityUpdateCb(
       [this](uint32_t priority, const HostVector&, const HostVector&) { refresh(priority); });
 }
@@ -614,31 +612,10 @@ void EdfLoadBalancerBase::initialize() {
 
 void EdfLoadBalancerBase::refresh(uint32_t priority) {
   const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
-    // Nuke existing scheduler if it exists.
-    auto& scheduler = scheduler_[source] = Scheduler{};
     refreshHostSource(source);
-
-    // Populate scheduler with host list.
-    // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
-    // weighted 1. This is because currently we don't refresh host sets if only weights change.
-    // We should probably change this to refresh at all times. See the comment in
-    // BaseDynamicClusterImpl::updateDynamicHostList about this.
-    for (const auto& host : hosts) {
-      // We use a fixed weight here. While the weight may change without
-      // notification, this will only be stale until this host is next picked,
-      // at which point it is reinserted into the EdfScheduler with its new
-      // weight in chooseHost().
-      scheduler.edf_.add(hostWeight(*host), host);
-    }
-
-    // Cycle through hosts to achieve the intended offset behavior.
-    // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
-    // refreshes for the weighted case.
-    if (!hosts.empty()) {
-      for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
-        auto host = scheduler.edf_.pick();
-        scheduler.edf_.add(hostWeight(*host), host);
-      }
+    auto& scheduler = scheduler_[source];
+    if (!updateScheduler(scheduler, hosts)) {
+      rebuildScheduler(scheduler, hosts);
     }
   };
 
@@ -663,6 +640,68 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
   }
 }
 
+bool EdfLoadBalancerBase::updateScheduler(Scheduler& scheduler, const HostVector& hosts) {
+  // Past this many stale entries (removed hosts that haven't been picked yet), rebuilding is
+  // preferable to growing the queue further. This also bounds the queue of host sources which
+  // are rarely picked from.
+  if (hosts.size() < MinHostsForIncrementalRefresh || scheduler.edf_.size() > 2 * hosts.size()) {
+    return false;
+  }
+
+  std::unordered_map<const Host*, HostConstSharedPtr> previous_hosts;
+  previous_hosts.reserve(scheduler.edf_.size());
+  scheduler.edf_.forEach([&previous_hosts](const HostConstSharedPtr& host) {
+    previous_hosts.emplace(host.get(), host);
+  });
+  HostVector hosts_added;
+  for (const auto& host : hosts) {
+    if (previous_hosts.erase(host.get()) == 0) {
+      hosts_added.push_back(host);
+    }
+  }
+
+  // What is left over in previous_hosts was removed. If most of the schedule changed, a rebuild
+  // is cheaper and gives an evenly spread schedule.
+  if (2 * (hosts_added.size() + previous_hosts.size()) > hosts.size()) {
+    return false;
+  }
+  for (auto& host : previous_hosts) {
+    scheduler.edf_.remove(std::move(host.second));
+  }
+  for (const auto& host : hosts_added) {
+    scheduler.edf_.add(hostWeight(*host), host);
+  }
+  return true;
+}
+
+void EdfLoadBalancerBase::rebuildScheduler(Scheduler& scheduler, const HostVector& hosts) {
+  // Nuke existing scheduler if it exists.
+  scheduler = Scheduler{};
+
+  // Populate scheduler with host list.
+  // TODO(mattklein123): We must build the EDF schedule even if all of the hosts are currently
+  // weighted 1. This is because currently we don't refresh host sets if only weights change.
+  // We should probably change this to refresh at all times. See the comment in
+  // BaseDynamicClusterImpl::updateDynamicHostList about this.
+  for (const auto& host : hosts) {
+    // We use a fixed weight here. While the weight may change without
+    // notification, this will only be stale until this host is next picked,
+    // at which point it is reinserted into the EdfScheduler with its new
+    // weight in chooseHost().
+    scheduler.edf_.add(hostWeight(*host), host);
+  }
+
+  // Cycle through hosts to achieve the intended offset behavior.
+  // TODO(htuch): Consider how we can avoid biasing towards earlier hosts in the schedule across
+  // refreshes for the weighted case.
+  if (!hosts.empty()) {
+    for (uint32_t i = 0; i < seed_ % hosts.size(); ++i) {
+      auto host = scheduler.edf_.pick();
+      scheduler.edf_.add(hostWeight(*host), host);
+    }
+  }
+}
+
 HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* context) {
   const HostsSource hosts_source = hostSourceToUse(context);
   auto scheduler_it = scheduler_.find(hosts_source);
@@ -716,6 +755,41 @@ HostConstSharedPtr LeastRequestLoadBalancer::unweightedHostPick(const HostVector
   return candidate_host;
 }
 
+namespace {
+// Cost of a host with active requests but no response time yet. It is above the cost of any host
+// with a realistic response time and request count, and grows with the host's active requests so
+// that such hosts are still compared with each other.
+constexpr double UnmeasuredHostPenalty = 1e12;
+} // namespace
+
+double PeakEwmaLoadBalancer::hostCost(const Host& host, MonotonicTime now) {
+  const double active_rq = host.stats().rq_active_.value();
+  const absl::optional<double> response_time = host.responseTimeEwma(now);
+  if (!response_time.has_value()) {
+    return active_rq > 0 ? UnmeasuredHostPenalty + active_rq : 0;
+  }
+  return response_time.value() * (active_rq + 1);
+}
+
+HostConstSharedPtr PeakEwmaLoadBalancer::unweightedHostPick(const HostVector& hosts_to_use,
+                                                            const HostsSource&) {
+  const MonotonicTime now = time_source_.monotonicTime();
+  HostSharedPtr candidate_host = nullptr;
+  double candidate_cost = 0;
+  for (uint32_t choice_idx = 0; choice_idx < choice_count_; ++choice_idx) {
+    const int rand_idx = random_.random() % hosts_to_use.size();
+    HostSharedPtr sampled_host = hosts_to_use[rand_idx];
+    const double sampled_cost = hostCost(*sampled_host, now);
+
+    if (candidate_host == nullptr || sampled_cost < candidate_cost) {
+      candidate_host = sampled_host;
+      candidate_cost = sampled_cost;
+    }
+  }
+
+  return candidate_host;
+}
+
 HostConstSharedPtr RandomLoadBalancer::chooseHostOnce(LoadBalancerContext* context) {
   const HostVector& hosts_to_use = hostSourceToHosts(hostSourceToUse(context));
   if (hosts_to_use.empty()) {
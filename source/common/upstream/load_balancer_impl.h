@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "envoy/api/v2/cds.pb.h"
+#include "envoy/common/time.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/upstream/load_balancer.h"
 #include "envoy/upstream/upstream.h"
@@ -322,7 +323,9 @@ private:
  * with 1 / weight deadline, we will achieve the desired pick frequency for weighted RR in a given
  * interval. Naive implementations of weighted RR are either O(n) pick time or O(m * n) memory use,
  * where m is the weight range. We also explicitly check for the unweighted special case and use a
- * simple index to achieve O(1) scheduling in that case.
+ * simple index to achieve O(1) scheduling in that case. On host set changes, the schedulers of
+ * large host sources are updated in place with the hosts added and removed, in
+ * O(n + m * log n) time for m changes, rather than rebuilt in O(n * log n) time.
  * TODO(htuch): We use EDF at Google, but the EDF scheduler may be overkill if we don't want to
  * support large ranges of weights or arbitrary precision floating weights, we could construct an
  * explicit schedule, since m will be a small constant factor in O(m * n). This
@@ -358,7 +361,13 @@ protected:
   const uint64_t seed_;
 
 private:
+  // Host sources with fewer hosts than this always have their scheduler rebuilt, since diffing
+  // against the previous schedule isn't any cheaper.
+  static constexpr size_t MinHostsForIncrementalRefresh = 64;
+
   void refresh(uint32_t priority);
+  bool updateScheduler(Scheduler& scheduler, const HostVector& hosts);
+  void rebuildScheduler(Scheduler& scheduler, const HostVector& hosts);
   virtual void refreshHostSource(const HostsSource& source) PURE;
   virtual double hostWeight(const Host& host) PURE;
   virtual HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
@@ -456,6 +465,52 @@ private:
   const uint32_t choice_count_;
 };
 
+/**
+ * Peak EWMA load balancer, a latency aware variant of the least request load balancer.
+ *
+ * The cost of a host is the peak exponentially weighted moving average of its response times (see
+ * Host::responseTimeEwma()) multiplied by its number of active requests plus one. A host whose
+ * response times spike is avoided right away, and the spike is forgotten over the configured
+ * decay time. When all hosts have the same weight of 1 it randomly picks N healthy hosts (where N
+ * is specified in the LB configuration) and chooses the cheapest, as the least request load
+ * balancer does with active requests. Otherwise, an EDF schedule is used with host weight divided
+ * by cost at pick/insert time.
+ *
+ * A host without a response time yet costs nothing while it is idle, so that new hosts are tried,
+ * and is assumed to be slower than any measured host while it has requests outstanding.
+ */
+class PeakEwmaLoadBalancer : public EdfLoadBalancerBase {
+public:
+  PeakEwmaLoadBalancer(
+      const PrioritySet& priority_set, const PrioritySet* local_priority_set, ClusterStats& stats,
+      Runtime::Loader& runtime, Runtime::RandomGenerator& random, TimeSource& time_source,
+      const envoy::api::v2::Cluster::CommonLbConfig& common_config,
+      const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig> peak_ewma_config)
+      : EdfLoadBalancerBase(priority_set, local_priority_set, stats, runtime, random,
+                            common_config),
+        time_source_(time_source),
+        choice_count_(
+            peak_ewma_config.has_value()
+                ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(peak_ewma_config.value(), choice_count, 2)
+                : 2) {
+    initialize();
+  }
+
+private:
+  static double hostCost(const Host& host, MonotonicTime now);
+
+  void refreshHostSource(const HostsSource&) override {}
+  double hostWeight(const Host& host) override {
+    // Add 1 to avoid division by 0 for idle hosts.
+    return host.weight() / (hostCost(host, time_source_.monotonicTime()) + 1);
+  }
+  HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
+                                        const HostsSource& source) override;
+
+  TimeSource& time_source_;
+  const uint32_t choice_count_;
+};
+
 /**
  * Random load balancer that picks a random host out of all hosts.
  */
@@ -99,6 +99,13 @@ private:
       return logical_host_->outlierDetector();
     }
     const HostStats& stats() const override { return logical_host_->stats(); }
+    void putResponseTime(std::chrono::microseconds response_time,
+                         MonotonicTime now) const override {
+      logical_host_->putResponseTime(response_time, now);
+    }
+    absl::optional<double> responseTimeEwma(MonotonicTime now) const override {
+      return logical_host_->responseTimeEwma(now);
+    }
     const std::string& hostname() const override { return logical_host_->hostname(); }
     Network::Address::InstanceConstSharedPtr address() const override { return address_; }
     const envoy::api::v2::core::Locality& locality() const override {
@@ -20,17 +20,20 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
   }
 
   // Implementation of pseudocode listing 1 in the paper (see header file for more info).
+  // Table build entries are in the same order as hosts_.
   std::vector<TableBuildEntry> table_build_entries;
   table_build_entries.reserve(normalized_host_weights.size());
+  hosts_.reserve(normalized_host_weights.size());
   for (const auto& host_weight : normalized_host_weights) {
     const auto& host = host_weight.first;
     const std::string& address = host->address()->asString();
-    table_build_entries.emplace_back(host, HashUtil::xxHash64(address) % table_size_,
+    table_build_entries.emplace_back(HashUtil::xxHash64(address) % table_size_,
                                      (HashUtil::xxHash64(address, 1) % (table_size_ - 1)) + 1,
                                      host_weight.second);
+    hosts_.push_back(host);
   }
 
-  table_.resize(table_size_);
+  table_.resize(table_size_, UnassignedIndex);
 
   // Iterate through the table build entries as many times as it takes to fill up the table.
   uint64_t table_index = 0;
@@ -46,12 +49,12 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
       }
       entry.target_weight_ += max_normalized_weight;
       uint64_t c = permutation(entry);
-      while (table_[c] != nullptr) {
+      while (table_[c] != UnassignedIndex) {
         entry.next_++;
         c = permutation(entry);
       }
 
-      table_[c] = entry.host_;
+      table_[c] = i;
       entry.next_++;
       entry.count_++;
       table_index++;
@@ -69,7 +72,7 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
 
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (uint64_t i = 0; i < table_.size(); i++) {
-      ENVOY_LOG(trace, "maglev: i={} host={}", i, table_[i]->address()->asString());
+      ENVOY_LOG(trace, "maglev: i={} host={}", i, hosts_[table_[i]]->address()->asString());
     }
   }
 }
@@ -79,7 +82,7 @@ HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash) const {
     return nullptr;
   }
 
-  return table_[hash % table_size_];
+  return hosts_[table_[hash % table_size_]];
 }
 
 uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
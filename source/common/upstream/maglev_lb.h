@@ -1,5 +1,7 @@
 #pragma once
 
+#include <limits>
+
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
@@ -30,6 +32,10 @@ struct MaglevLoadBalancerStats {
  * https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/44824.pdf
  * section 3.4. Specifically, the algorithm shown in pseudocode listening 1 is implemented
  * with a fixed table size of 65537. This is the recommended table size in section 5.3.
+ *
+ * The table is always rebuilt in full, since each slot depends on the whole host set. It stores
+ * an index into the host list rather than a host pointer, which keeps it compact and avoids a
+ * reference count update per slot when it is built.
  */
 class MaglevTable : public ThreadAwareLoadBalancerBase::HashingLoadBalancer,
                     Logger::Loggable<Logger::Id::upstream> {
@@ -45,10 +51,9 @@ public:
 
 private:
   struct TableBuildEntry {
-    TableBuildEntry(const HostConstSharedPtr& host, uint64_t offset, uint64_t skip, double weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+    TableBuildEntry(uint64_t offset, uint64_t skip, double weight)
+        : offset_(offset), skip_(skip), weight_(weight) {}
 
-    HostConstSharedPtr host_;
     const uint64_t offset_;
     const uint64_t skip_;
     const double weight_;
@@ -59,8 +64,13 @@ private:
 
   uint64_t permutation(const TableBuildEntry& entry);
 
+  // Marks a table slot which hasn't been assigned a host yet during the build.
+  static const uint32_t UnassignedIndex = std::numeric_limits<uint32_t>::max();
+
   const uint64_t table_size_;
-  std::vector<HostConstSharedPtr> table_;
+  std::vector<HostConstSharedPtr> hosts_;
+  // Index into hosts_ for each slot.
+  std::vector<uint32_t> table_;
   MaglevLoadBalancerStats& stats_;
 };
 
@@ -80,7 +90,8 @@ private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
   createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double /* min_normalized_weight */, double max_normalized_weight) override {
+                     double /* min_normalized_weight */, double max_normalized_weight,
+                     const HashingLoadBalancerSharedPtr& /* previous_lb */) override {
     return std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight,
                                          table_size_, stats_);
   }
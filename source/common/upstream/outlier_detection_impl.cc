@@ -1,5 +1,6 @@
 #include "common/upstream/outlier_detection_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <memory>
@@ -33,6 +34,18 @@ DetectorSharedPtr DetectorImplFactory::createForCluster(
   }
 }
 
+DetectorHostMonitorImpl::DetectorHostMonitorImpl(std::shared_ptr<DetectorImpl> detector,
+                                                 HostSharedPtr host, uint32_t slot,
+                                                 bool track_latency)
+    : detector_(detector), host_(host), slot_(slot) {
+  // Point the success_rate_accumulator_bucket_ pointer to a bucket.
+  updateCurrentSuccessRateBucket();
+  if (track_latency) {
+    latency_accumulator_ = std::make_unique<LatencyAccumulator>();
+    updateCurrentLatencyBucket();
+  }
+}
+
 void DetectorHostMonitorImpl::eject(MonotonicTime ejection_time) {
   ASSERT(!host_.lock()->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
   host_.lock()->healthFlagSet(Host::HealthFlag::FAILED_OUTLIER_CHECK);
@@ -48,6 +61,20 @@ void DetectorHostMonitorImpl::updateCurrentSuccessRateBucket() {
   success_rate_accumulator_bucket_.store(success_rate_accumulator_.updateCurrentWriter());
 }
 
+void DetectorHostMonitorImpl::updateCurrentLatencyBucket() {
+  if (latency_accumulator_ != nullptr) {
+    latency_accumulator_bucket_.store(latency_accumulator_->updateCurrentWriter());
+  }
+}
+
+void DetectorHostMonitorImpl::putResponseTime(std::chrono::milliseconds response_time) {
+  LatencyAccumulatorBucket* bucket = latency_accumulator_bucket_.load();
+  if (bucket != nullptr) {
+    bucket->counters_[LatencyAccumulator::counterIndex(
+        static_cast<uint64_t>(std::max<int64_t>(0, response_time.count())))]++;
+  }
+}
+
 void DetectorHostMonitorImpl::putHttpResponseCode(uint64_t response_code) {
   success_rate_accumulator_bucket_.load()->total_request_counter_++;
   if (Http::CodeUtility::is5xx(response_code)) {
@@ -127,7 +154,11 @@ DetectorConfig::DetectorConfig(const envoy::api::v2::cluster::OutlierDetection&
       enforcing_consecutive_gateway_failure_(static_cast<uint64_t>(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_consecutive_gateway_failure, 0))),
       enforcing_success_rate_(static_cast<uint64_t>(
-          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_success_rate, 100))) {}
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_success_rate, 100))),
+      latency_p99_factor_(
+          static_cast<uint64_t>(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, latency_p99_factor, 0))),
+      enforcing_latency_(
+          static_cast<uint64_t>(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, enforcing_latency, 100))) {}
 
 DetectorImpl::DetectorImpl(const Cluster& cluster,
                            const envoy::api::v2::cluster::OutlierDetection& config,
@@ -140,8 +171,8 @@ DetectorImpl::DetectorImpl(const Cluster& cluster,
 }
 
 DetectorImpl::~DetectorImpl() {
-  for (auto host : host_monitors_) {
-    if (host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+  for (const HostSharedPtr& host : slot_hosts_) {
+    if (host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
       ASSERT(stats_.ejections_active_.value() > 0);
       stats_.ejections_active_.dec();
     }
@@ -172,13 +203,7 @@ void DetectorImpl::initialize(const Cluster& cluster) {
         }
 
         for (const HostSharedPtr& host : hosts_removed) {
-          ASSERT(host_monitors_.count(host) == 1);
-          if (host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
-            ASSERT(stats_.ejections_active_.value() > 0);
-            stats_.ejections_active_.dec();
-          }
-
-          host_monitors_.erase(host);
+          removeHostMonitor(host);
         }
       });
 
@@ -187,11 +212,33 @@ void DetectorImpl::initialize(const Cluster& cluster) {
 
 void DetectorImpl::addHostMonitor(HostSharedPtr host) {
   ASSERT(host_monitors_.count(host) == 0);
-  DetectorHostMonitorImpl* monitor = new DetectorHostMonitorImpl(shared_from_this(), host);
+  DetectorHostMonitorImpl* monitor = new DetectorHostMonitorImpl(
+      shared_from_this(), host, slot_hosts_.size(), config_.latencyP99Factor() > 0);
   host_monitors_[host] = monitor;
+  slot_hosts_.push_back(host);
+  slot_monitors_.push_back(monitor);
   host->setOutlierDetector(DetectorHostMonitorPtr{monitor});
 }
 
+void DetectorImpl::removeHostMonitor(HostSharedPtr host) {
+  ASSERT(host_monitors_.count(host) == 1);
+  if (host->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+    ASSERT(stats_.ejections_active_.value() > 0);
+    stats_.ejections_active_.dec();
+  }
+
+  // Move the host in the last slot into the removed host's slot.
+  const uint32_t slot = host_monitors_[host]->slot();
+  ASSERT(slot_hosts_[slot] == host);
+  slot_hosts_[slot] = slot_hosts_.back();
+  slot_monitors_[slot] = slot_monitors_.back();
+  slot_monitors_[slot]->slot(slot);
+  slot_hosts_.pop_back();
+  slot_monitors_.pop_back();
+
+  host_monitors_.erase(host);
+}
+
 void DetectorImpl::armIntervalTimer() {
   interval_timer_->enableTimer(std::chrono::milliseconds(
       runtime_.snapshot().getInteger("outlier_detection.interval_ms", config_.intervalMs())));
@@ -235,6 +282,9 @@ bool DetectorImpl::enforceEjection(envoy::data::cluster::v2alpha::OutlierEjectio
   case envoy::data::cluster::v2alpha::OutlierEjectionType::SUCCESS_RATE:
     return runtime_.snapshot().featureEnabled("outlier_detection.enforcing_success_rate",
                                               config_.enforcingSuccessRate());
+  case envoy::data::cluster::v2alpha::OutlierEjectionType::LATENCY:
+    return runtime_.snapshot().featureEnabled("outlier_detection.enforcing_latency",
+                                              config_.enforcingLatency());
   default:
     // Checked by schema.
     NOT_REACHED_GCOVR_EXCL_LINE;
@@ -256,6 +306,9 @@ void DetectorImpl::updateEnforcedEjectionStats(
   case envoy::data::cluster::v2alpha::OutlierEjectionType::CONSECUTIVE_GATEWAY_FAILURE:
     stats_.ejections_enforced_consecutive_gateway_failure_.inc();
     break;
+  case envoy::data::cluster::v2alpha::OutlierEjectionType::LATENCY:
+    stats_.ejections_enforced_latency_.inc();
+    break;
   default:
     // Checked by schema.
     NOT_REACHED_GCOVR_EXCL_LINE;
@@ -363,9 +416,10 @@ void DetectorImpl::onConsecutiveErrorWorker(
   }
 }
 
-Utility::EjectionPair Utility::successRateEjectionThreshold(
-    double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-    double success_rate_stdev_factor) {
+Utility::EjectionPair
+Utility::successRateEjectionThreshold(const std::vector<double>& success_rates,
+                                      uint64_t valid_success_rate_hosts,
+                                      double success_rate_stdev_factor) {
   // This function is using mean and standard deviation as statistical measures for outlier
   // detection. First the mean is calculated by dividing the sum of success rate data over the
   // number of data points. Then variance is calculated by taking the mean of the
@@ -381,88 +435,164 @@ Utility::EjectionPair Utility::successRateEjectionThreshold(
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
+  //
+  // Both passes run straight over the array, masking out invalid data points rather than
+  // branching around them.
+  double success_rate_sum = 0;
+  for (const double success_rate : success_rates) {
+    success_rate_sum += success_rate >= 0 ? success_rate : 0;
+  }
+  double mean = success_rate_sum / valid_success_rate_hosts;
   double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
+  for (const double success_rate : success_rates) {
+    const double deviation = success_rate >= 0 ? success_rate - mean : 0;
+    variance += deviation * deviation;
+  }
+  variance /= valid_success_rate_hosts;
   double stdev = std::sqrt(variance);
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
 
+void DetectorImpl::updateHostSlots() {
+  uint64_t request_volume = runtime_.snapshot().getInteger(
+      "outlier_detection.success_rate_request_volume", config_.successRateRequestVolume());
+
+  // Copy each host's results for the last interval out of its monitor once, so that the ejection
+  // passes work on contiguous arrays instead of chasing a pointer per host.
+  slot_success_rates_.assign(slot_hosts_.size(), -1);
+  slot_latency_p99s_.assign(slot_hosts_.size(), -1);
+  for (uint32_t slot = 0; slot < slot_hosts_.size(); slot++) {
+    // Don't do work if the host is already ejected.
+    if (slot_hosts_[slot]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+      continue;
+    }
+
+    DetectorHostMonitorImpl* monitor = slot_monitors_[slot];
+    absl::optional<double> host_success_rate =
+        monitor->successRateAccumulator().getSuccessRate(request_volume);
+    if (host_success_rate) {
+      slot_success_rates_[slot] = host_success_rate.value();
+    }
+
+    if (monitor->latencyAccumulator() != nullptr) {
+      absl::optional<double> host_latency_p99 =
+          monitor->latencyAccumulator()->getLatencyP99(request_volume);
+      if (host_latency_p99) {
+        slot_latency_p99s_[slot] = host_latency_p99.value();
+      }
+    }
+  }
+}
+
 void DetectorImpl::processSuccessRateEjections() {
   uint64_t success_rate_minimum_hosts = runtime_.snapshot().getInteger(
       "outlier_detection.success_rate_minimum_hosts", config_.successRateMinimumHosts());
-  uint64_t success_rate_request_volume = runtime_.snapshot().getInteger(
-      "outlier_detection.success_rate_request_volume", config_.successRateRequestVolume());
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  double success_rate_sum = 0;
+  uint64_t valid_success_rate_hosts = 0;
 
   // Reset the Detector's success rate mean and stdev.
   success_rate_average_ = -1;
   success_rate_ejection_threshold_ = -1;
 
   // Exit early if there are not enough hosts.
-  if (host_monitors_.size() < success_rate_minimum_hosts) {
+  if (slot_hosts_.size() < success_rate_minimum_hosts) {
     return;
   }
 
-  // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-
-  for (const auto& host : host_monitors_) {
-    // Don't do work if the host is already ejected.
-    if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
-      absl::optional<double> host_success_rate =
-          host.second->successRateAccumulator().getSuccessRate(success_rate_request_volume);
-
-      if (host_success_rate) {
-        valid_success_rate_hosts.emplace_back(
-            HostSuccessRatePair(host.first, host_success_rate.value()));
-        success_rate_sum += host_success_rate.value();
-        host.second->successRate(host_success_rate.value());
-      }
+  for (uint32_t slot = 0; slot < slot_success_rates_.size(); slot++) {
+    if (slot_success_rates_[slot] >= 0) {
+      valid_success_rate_hosts++;
+      slot_monitors_[slot]->successRate(slot_success_rates_[slot]);
     }
   }
 
-  if (!valid_success_rate_hosts.empty() &&
-      valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
+  if (valid_success_rate_hosts > 0 && valid_success_rate_hosts >= success_rate_minimum_hosts) {
     double success_rate_stdev_factor =
         runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
                                        config_.successRateStdevFactor()) /
         1000.0;
     Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
+        slot_success_rates_, valid_success_rate_hosts, success_rate_stdev_factor);
     success_rate_average_ = ejection_pair.success_rate_average_;
     success_rate_ejection_threshold_ = ejection_pair.ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
-      if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold_) {
+    for (uint32_t slot = 0; slot < slot_success_rates_.size(); slot++) {
+      if (slot_success_rates_[slot] >= 0 &&
+          slot_success_rates_[slot] < success_rate_ejection_threshold_) {
         stats_.ejections_success_rate_.inc(); // Deprecated.
         stats_.ejections_detected_success_rate_.inc();
-        ejectHost(host_success_rate_pair.host_,
+        ejectHost(slot_hosts_[slot],
                   envoy::data::cluster::v2alpha::OutlierEjectionType::SUCCESS_RATE);
       }
     }
   }
 }
 
+void DetectorImpl::processLatencyEjections() {
+  // Reset the Detector's latency median and threshold.
+  latency_p99_median_ = -1;
+  latency_ejection_threshold_ = -1;
+
+  // Latency is only tracked if it is enabled in the config. The minimum hosts setting is shared
+  // with success rate outlier detection.
+  uint64_t minimum_hosts = runtime_.snapshot().getInteger(
+      "outlier_detection.success_rate_minimum_hosts", config_.successRateMinimumHosts());
+  if (config_.latencyP99Factor() == 0 || slot_hosts_.size() < minimum_hosts) {
+    return;
+  }
+
+  std::vector<double> latency_p99s;
+  latency_p99s.reserve(slot_latency_p99s_.size());
+  for (uint32_t slot = 0; slot < slot_latency_p99s_.size(); slot++) {
+    if (slot_latency_p99s_[slot] >= 0) {
+      latency_p99s.push_back(slot_latency_p99s_[slot]);
+      slot_monitors_[slot]->latencyP99(slot_latency_p99s_[slot]);
+    }
+  }
+
+  if (latency_p99s.empty() || latency_p99s.size() < minimum_hosts) {
+    return;
+  }
+
+  // The median is used rather than the mean so that a few very slow hosts do not raise the
+  // threshold enough to hide themselves.
+  auto median = latency_p99s.begin() + latency_p99s.size() / 2;
+  std::nth_element(latency_p99s.begin(), median, latency_p99s.end());
+  double latency_p99_factor = runtime_.snapshot().getInteger("outlier_detection.latency_p99_factor",
+                                                             config_.latencyP99Factor()) /
+                              100.0;
+  latency_p99_median_ = *median;
+  // With a median of 0ms, any host with a non-zero response time would be an outlier.
+  latency_ejection_threshold_ = std::max(latency_p99_median_, 1.0) * latency_p99_factor;
+  for (uint32_t slot = 0; slot < slot_latency_p99s_.size(); slot++) {
+    // Hosts may have been ejected by the success rate pass of this interval.
+    if (slot_latency_p99s_[slot] > latency_ejection_threshold_ &&
+        !slot_hosts_[slot]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+      stats_.ejections_detected_latency_.inc();
+      ejectHost(slot_hosts_[slot], envoy::data::cluster::v2alpha::OutlierEjectionType::LATENCY);
+    }
+  }
+}
+
 void DetectorImpl::onIntervalTimer() {
   MonotonicTime now = time_source_.monotonicTime();
 
-  for (auto host : host_monitors_) {
-    checkHostForUneject(host.first, host.second, now);
-
-    // Need to update the writer bucket to keep the data valid.
-    host.second->updateCurrentSuccessRateBucket();
-    // Refresh host success rate stat for the /clusters endpoint. If there is a new valid value, it
-    // will get updated in processSuccessRateEjections().
-    host.second->successRate(-1);
+  for (uint32_t slot = 0; slot < slot_hosts_.size(); slot++) {
+    DetectorHostMonitorImpl* monitor = slot_monitors_[slot];
+    checkHostForUneject(slot_hosts_[slot], monitor, now);
+
+    // Need to update the writer buckets to keep the data valid.
+    monitor->updateCurrentSuccessRateBucket();
+    monitor->updateCurrentLatencyBucket();
+    // Refresh host success rate and latency stats for the /clusters endpoint. If there are new
+    // valid values, they will get updated in processSuccessRateEjections() and
+    // processLatencyEjections().
+    monitor->successRate(-1);
+    monitor->latencyP99(-1);
   }
 
+  updateHostSlots();
   processSuccessRateEjections();
+  processLatencyEjections();
 
   armIntervalTimer();
 }
@@ -493,6 +623,13 @@ void EventLoggerImpl::logEject(const HostDescriptionConstSharedPtr& host, Detect
         detector.successRateEjectionThreshold());
     event.mutable_eject_success_rate_event()->set_host_success_rate(
         host->outlierDetector().successRate());
+  } else if (type == envoy::data::cluster::v2alpha::OutlierEjectionType::LATENCY) {
+    event.mutable_eject_latency_event()->set_host_latency_p99_ms(
+        host->outlierDetector().latencyP99());
+    event.mutable_eject_latency_event()->set_cluster_median_latency_p99_ms(
+        detector.latencyP99Median());
+    event.mutable_eject_latency_event()->set_cluster_latency_ejection_threshold_ms(
+        detector.latencyEjectionThreshold());
   } else {
     event.mutable_eject_consecutive_event();
   }
@@ -550,6 +687,65 @@ SuccessRateAccumulator::getSuccessRate(uint64_t success_rate_request_volume) {
                                 backup_success_rate_bucket_->total_request_counter_);
 }
 
+LatencyAccumulatorBucket* LatencyAccumulator::updateCurrentWriter() {
+  // Right now current is being written to and backup is not. Flush the backup and swap.
+  for (std::atomic<uint32_t>& counter : backup_latency_bucket_->counters_) {
+    counter = 0;
+  }
+
+  current_latency_bucket_.swap(backup_latency_bucket_);
+
+  return current_latency_bucket_.get();
+}
+
+absl::optional<double> LatencyAccumulator::getLatencyP99(uint64_t request_volume) {
+  uint64_t total_request_counter = 0;
+  for (const std::atomic<uint32_t>& counter : backup_latency_bucket_->counters_) {
+    total_request_counter += counter;
+  }
+  if (total_request_counter == 0 || total_request_counter < request_volume) {
+    return absl::optional<double>();
+  }
+
+  // The p99 is the response time that at least 99% of the requests did not exceed.
+  const uint64_t rank = total_request_counter - total_request_counter / 100;
+  uint64_t request_counter = 0;
+  for (uint32_t index = 0; index < LatencyAccumulatorBucket::NumCounters; index++) {
+    request_counter += backup_latency_bucket_->counters_[index];
+    if (request_counter >= rank) {
+      return absl::optional<double>(counterUpperBound(index));
+    }
+  }
+
+  return absl::optional<double>(counterUpperBound(LatencyAccumulatorBucket::NumCounters - 1));
+}
+
+uint32_t LatencyAccumulator::counterIndex(uint64_t response_time_ms) {
+  // Response times under 4ms have a counter each. Above that, each range between two powers of two
+  // is split into four counters by the two bits below the most significant bit. Response times
+  // beyond the last counter are counted in it.
+  if (response_time_ms < 4) {
+    return response_time_ms;
+  }
+
+  uint32_t exponent = 2;
+  while ((response_time_ms >> (exponent + 1)) != 0) {
+    exponent++;
+  }
+  const uint64_t index = (exponent - 1) * 4 + ((response_time_ms >> (exponent - 2)) & 3);
+  return std::min<uint64_t>(index, LatencyAccumulatorBucket::NumCounters - 1);
+}
+
+uint64_t LatencyAccumulator::counterUpperBound(uint32_t index) {
+  if (index < 4) {
+    return index;
+  }
+
+  const uint32_t exponent = index / 4 + 1;
+  const uint64_t width = 1ULL << (exponent - 2);
+  return (4 + index % 4) * width + width - 1;
+}
+
 } // namespace Outlier
 } // namespace Upstream
 } // namespace Envoy
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -36,6 +37,7 @@ public:
   const absl::optional<MonotonicTime>& lastEjectionTime() override { return time_; }
   const absl::optional<MonotonicTime>& lastUnejectionTime() override { return time_; }
   double successRate() const override { return -1; }
+  double latencyP99() const override { return -1; }
 
 private:
   const absl::optional<MonotonicTime> time_;
@@ -52,16 +54,6 @@ public:
                                             EventLoggerSharedPtr event_logger);
 };
 
-/**
- * Thin struct to facilitate calculations for success rate outlier detection.
- */
-struct HostSuccessRatePair {
-  HostSuccessRatePair(HostSharedPtr host, double success_rate)
-      : host_(host), success_rate_(success_rate) {}
-  HostSharedPtr host_;
-  double success_rate_;
-};
-
 struct SuccessRateAccumulatorBucket {
   std::atomic<uint64_t> success_request_counter_;
   std::atomic<uint64_t> total_request_counter_;
@@ -99,6 +91,56 @@ private:
   std::unique_ptr<SuccessRateAccumulatorBucket> backup_success_rate_bucket_;
 };
 
+/**
+ * Response time counts for one interval. Response times are counted in buckets that are a quarter
+ * of a power of two wide, so a percentile read back from the counts is at most 25% above the
+ * actual response time.
+ */
+struct LatencyAccumulatorBucket {
+  static const uint32_t NumCounters = 60;
+  std::array<std::atomic<uint32_t>, NumCounters> counters_{};
+};
+
+/**
+ * The LatencyAccumulator uses the LatencyAccumulatorBucket to get per host response time
+ * percentiles. Like the SuccessRateAccumulator it has a bucket to write to, and a bucket holding
+ * the last complete interval.
+ */
+class LatencyAccumulator {
+public:
+  LatencyAccumulator()
+      : current_latency_bucket_(new LatencyAccumulatorBucket()),
+        backup_latency_bucket_(new LatencyAccumulatorBucket()) {}
+
+  /**
+   * This function updates the bucket to write data to.
+   * @return a pointer to the LatencyAccumulatorBucket.
+   */
+  LatencyAccumulatorBucket* updateCurrentWriter();
+  /**
+   * This function returns the p99 response time of a host over the last complete interval if the
+   * request volume is high enough.
+   * @param request_volume the threshold of requests an accumulator has to have in order to be able
+   *                       to return a significant p99 value.
+   * @return a valid absl::optional<double> with the p99 response time in milliseconds. If there
+   * were not enough requests, an invalid absl::optional<double> is returned.
+   */
+  absl::optional<double> getLatencyP99(uint64_t request_volume);
+
+  /**
+   * @return the index of the counter for a response time in milliseconds.
+   */
+  static uint32_t counterIndex(uint64_t response_time_ms);
+  /**
+   * @return the largest response time in milliseconds counted by a counter.
+   */
+  static uint64_t counterUpperBound(uint32_t index);
+
+private:
+  std::unique_ptr<LatencyAccumulatorBucket> current_latency_bucket_;
+  std::unique_ptr<LatencyAccumulatorBucket> backup_latency_bucket_;
+};
+
 class DetectorImpl;
 
 /**
@@ -106,17 +148,19 @@ class DetectorImpl;
  */
 class DetectorHostMonitorImpl : public DetectorHostMonitor {
 public:
-  DetectorHostMonitorImpl(std::shared_ptr<DetectorImpl> detector, HostSharedPtr host)
-      : detector_(detector), host_(host), success_rate_(-1) {
-    // Point the success_rate_accumulator_bucket_ pointer to a bucket.
-    updateCurrentSuccessRateBucket();
-  }
+  DetectorHostMonitorImpl(std::shared_ptr<DetectorImpl> detector, HostSharedPtr host,
+                          uint32_t slot, bool track_latency);
 
   void eject(MonotonicTime ejection_time);
   void uneject(MonotonicTime ejection_time);
   void updateCurrentSuccessRateBucket();
+  void updateCurrentLatencyBucket();
   SuccessRateAccumulator& successRateAccumulator() { return success_rate_accumulator_; }
+  LatencyAccumulator* latencyAccumulator() { return latency_accumulator_.get(); }
   void successRate(double new_success_rate) { success_rate_ = new_success_rate; }
+  void latencyP99(double new_latency_p99) { latency_p99_ = new_latency_p99; }
+  uint32_t slot() const { return slot_; }
+  void slot(uint32_t new_slot) { slot_ = new_slot; }
   void resetConsecutive5xx() { consecutive_5xx_ = 0; }
   void resetConsecutiveGatewayFailure() { consecutive_gateway_failure_ = 0; }
   static Http::Code resultToHttpCode(Result result);
@@ -125,12 +169,13 @@ public:
   uint32_t numEjections() override { return num_ejections_; }
   void putHttpResponseCode(uint64_t response_code) override;
   void putResult(Result result) override;
-  void putResponseTime(std::chrono::milliseconds) override {}
+  void putResponseTime(std::chrono::milliseconds response_time) override;
   const absl::optional<MonotonicTime>& lastEjectionTime() override { return last_ejection_time_; }
   const absl::optional<MonotonicTime>& lastUnejectionTime() override {
     return last_unejection_time_;
   }
   double successRate() const override { return success_rate_; }
+  double latencyP99() const override { return latency_p99_; }
 
 private:
   std::weak_ptr<DetectorImpl> detector_;
@@ -142,7 +187,12 @@ private:
   uint32_t num_ejections_{};
   SuccessRateAccumulator success_rate_accumulator_;
   std::atomic<SuccessRateAccumulatorBucket*> success_rate_accumulator_bucket_;
-  double success_rate_;
+  // Only allocated if latency outlier detection is enabled.
+  std::unique_ptr<LatencyAccumulator> latency_accumulator_;
+  std::atomic<LatencyAccumulatorBucket*> latency_accumulator_bucket_{};
+  double success_rate_{-1};
+  double latency_p99_{-1};
+  uint32_t slot_;
 };
 
 /**
@@ -161,7 +211,9 @@ private:
   COUNTER(ejections_detected_success_rate)                                                         \
   COUNTER(ejections_enforced_success_rate)                                                         \
   COUNTER(ejections_detected_consecutive_gateway_failure)                                          \
-  COUNTER(ejections_enforced_consecutive_gateway_failure)
+  COUNTER(ejections_enforced_consecutive_gateway_failure)                                          \
+  COUNTER(ejections_detected_latency)                                                              \
+  COUNTER(ejections_enforced_latency)
 // clang-format on
 
 /**
@@ -189,6 +241,8 @@ public:
   uint64_t enforcingConsecutive5xx() { return enforcing_consecutive_5xx_; }
   uint64_t enforcingConsecutiveGatewayFailure() { return enforcing_consecutive_gateway_failure_; }
   uint64_t enforcingSuccessRate() { return enforcing_success_rate_; }
+  uint64_t latencyP99Factor() { return latency_p99_factor_; }
+  uint64_t enforcingLatency() { return enforcing_latency_; }
 
 private:
   const uint64_t interval_ms_;
@@ -202,6 +256,8 @@ private:
   const uint64_t enforcing_consecutive_5xx_;
   const uint64_t enforcing_consecutive_gateway_failure_;
   const uint64_t enforcing_success_rate_;
+  const uint64_t latency_p99_factor_;
+  const uint64_t enforcing_latency_;
 };
 
 /**
@@ -226,6 +282,8 @@ public:
   void addChangedStateCb(ChangeStateCb cb) override { callbacks_.push_back(cb); }
   double successRateAverage() const override { return success_rate_average_; }
   double successRateEjectionThreshold() const override { return success_rate_ejection_threshold_; }
+  double latencyP99Median() const override { return latency_p99_median_; }
+  double latencyEjectionThreshold() const override { return latency_ejection_threshold_; }
 
 private:
   DetectorImpl(const Cluster& cluster, const envoy::api::v2::cluster::OutlierDetection& config,
@@ -233,6 +291,7 @@ private:
                EventLoggerSharedPtr event_logger);
 
   void addHostMonitor(HostSharedPtr host);
+  void removeHostMonitor(HostSharedPtr host);
   void armIntervalTimer();
   void checkHostForUneject(HostSharedPtr host, DetectorHostMonitorImpl* monitor, MonotonicTime now);
   void ejectHost(HostSharedPtr host, envoy::data::cluster::v2alpha::OutlierEjectionType type);
@@ -246,7 +305,9 @@ private:
   void runCallbacks(HostSharedPtr host);
   bool enforceEjection(envoy::data::cluster::v2alpha::OutlierEjectionType type);
   void updateEnforcedEjectionStats(envoy::data::cluster::v2alpha::OutlierEjectionType type);
+  void updateHostSlots();
   void processSuccessRateEjections();
+  void processLatencyEjections();
 
   DetectorConfig config_;
   Event::Dispatcher& dispatcher_;
@@ -256,9 +317,19 @@ private:
   Event::TimerPtr interval_timer_;
   std::list<ChangeStateCb> callbacks_;
   std::unordered_map<HostSharedPtr, DetectorHostMonitorImpl*> host_monitors_;
+  // The hosts and their monitors by slot. Slots are kept dense by moving the last host into the
+  // slot of a removed host, so the interval passes run over contiguous arrays.
+  std::vector<HostSharedPtr> slot_hosts_;
+  std::vector<DetectorHostMonitorImpl*> slot_monitors_;
+  // The results of the last interval by slot, copied out of the monitors once per interval. -1
+  // means that the host was ejected or did not have enough request volume.
+  std::vector<double> slot_success_rates_;
+  std::vector<double> slot_latency_p99s_;
   EventLoggerSharedPtr event_logger_;
   double success_rate_average_;
   double success_rate_ejection_threshold_;
+  double latency_p99_median_{-1};
+  double latency_ejection_threshold_{-1};
 };
 
 class EventLoggerImpl : public EventLogger {
@@ -296,15 +367,14 @@ public:
    * This function returns an EjectionPair for success rate outlier detection. The pair contains
    * the average success rate of all valid hosts in the cluster and the ejection threshold.
    * If a host's success rate is under this threshold, the host is an outlier.
-   * @param success_rate_sum is the sum of the data in the success_rate_data vector.
-   * @param valid_success_rate_hosts is the vector containing the individual success rate data
-   *        points.
+   * @param success_rates is the vector containing the individual success rate data points. Negative
+   *        entries are not valid data points and are skipped.
+   * @param valid_success_rate_hosts is the number of valid data points in success_rates.
    * @return EjectionPair.
    */
-  static EjectionPair
-  successRateEjectionThreshold(double success_rate_sum,
-                               const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-                               double success_rate_stdev_factor);
+  static EjectionPair successRateEjectionThreshold(const std::vector<double>& success_rates,
+                                                   uint64_t valid_success_rate_hosts,
+                                                   double success_rate_stdev_factor);
 };
 
 } // namespace Outlier
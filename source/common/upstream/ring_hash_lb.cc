@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "common/common/assert.h"
@@ -58,14 +61,14 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
     int64_t midp = (lowp + highp) / 2;
 
     if (midp == static_cast<int64_t>(ring_.size())) {
-      return ring_[0].host_;
+      return hosts_[ring_[0].host_index_];
     }
 
     uint64_t midval = ring_[midp].hash_;
     uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
 
     if (h <= midval && h > midval1) {
-      return ring_[midp].host_;
+      return hosts_[ring_[midp].host_index_];
     }
 
     if (midval < h) {
@@ -75,16 +78,70 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h) const {
     }
 
     if (lowp > highp) {
-      return ring_[0].host_;
+      return hosts_[ring_[0].host_index_];
     }
   }
 }
 
 using HashFunction = envoy::api::v2::Cluster_RingHashLbConfig_HashFunction;
+
+namespace {
+
+/**
+ * Computes the ring hashes of a host. The i-th hash of a host is the hash of "<address>_<i>".
+ */
+class HostHasher {
+public:
+  HostHasher(const Host& host, bool use_std_hash, HashFunction hash_function)
+      : use_std_hash_(use_std_hash), hash_function_(hash_function) {
+    const std::string& address_string = host.address()->asString();
+    offset_ = address_string.size();
+
+    // Currently, we support both IP and UDS addresses. The UDS max path length is ~108 on all Unix
+    // platforms that I know of. Given that, we can use a 196 char buffer which is plenty of room
+    // for UDS, '_', and up to 21 characters for the node ID. To be on the super safe side, there
+    // is a RELEASE_ASSERT here that checks this, in case someone in the future adds some type of
+    // new address that is larger, or runs on a platform where UDS is larger. I don't think it's
+    // worth the defensive coding to deal with the heap allocation case (e.g. via
+    // absl::InlinedVector) at the current time.
+    RELEASE_ASSERT(
+        address_string.size() + 1 + StringUtil::MIN_ITOA_OUT_LEN <= sizeof(hash_key_buffer_), "");
+    memcpy(hash_key_buffer_, address_string.c_str(), offset_);
+    hash_key_buffer_[offset_++] = '_';
+  }
+
+  uint64_t hash(uint64_t i) {
+    const uint64_t total_hash_key_len =
+        offset_ + StringUtil::itoa(hash_key_buffer_ + offset_, StringUtil::MIN_ITOA_OUT_LEN, i);
+    absl::string_view hash_key(hash_key_buffer_, total_hash_key_len);
+
+    // Sadly std::hash provides no mechanism for hashing arbitrary bytes so we must copy here.
+    // xxHash is done without copies.
+    const uint64_t hash =
+        use_std_hash_
+            ? std::hash<std::string>()(std::string(hash_key))
+            : (hash_function_ == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
+                  ? MurmurHash::murmurHash2_64(hash_key, MurmurHash::STD_HASH_SEED)
+                  : HashUtil::xxHash64(hash_key);
+
+    ENVOY_LOG_MISC(trace, "ring hash: hash_key={} hash={}", hash_key, hash);
+    return hash;
+  }
+
+private:
+  const bool use_std_hash_;
+  const HashFunction hash_function_;
+  char hash_key_buffer_[196];
+  uint64_t offset_;
+};
+
+} // namespace
+
 RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_host_weights,
                                  double min_normalized_weight, uint64_t min_ring_size,
                                  uint64_t max_ring_size, bool use_std_hash,
-                                 HashFunction hash_function, RingHashLoadBalancerStats& stats)
+                                 HashFunction hash_function, RingHashLoadBalancerStats& stats,
+                                 const Ring* previous)
     : stats_(stats) {
   ENVOY_LOG(trace, "ring hash: building ring");
 
@@ -101,15 +158,12 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   const double scale =
       std::min(std::ceil(min_normalized_weight * min_ring_size) / min_normalized_weight,
                static_cast<double>(max_ring_size));
-
-  // Reserve memory for the entire ring up front.
   const uint64_t ring_size = std::ceil(scale);
-  ring_.reserve(ring_size);
 
-  // Populate the hash ring by walking through the (host, weight) pairs in normalized_host_weights,
-  // and generating (scale * weight) hashes for each host. Since these aren't necessarily whole
-  // numbers, we maintain running sums -- current_hashes and target_hashes -- which allows us to
-  // populate the ring in a mostly stable way.
+  // Work out the number of hashes for each host by walking through the (host, weight) pairs in
+  // normalized_host_weights, and generating (scale * weight) hashes for each host. Since these
+  // aren't necessarily whole numbers, we maintain running sums -- current_hashes and target_hashes
+  // -- which allows us to populate the ring in a mostly stable way.
   //
   // For example, suppose we have 4 hosts, each with a normalized weight of 0.25, and a scale of
   // 6.0 (because the max_ring_size is 6). That means we want to generate 1.5 hashes per host.
@@ -123,63 +177,34 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   // For stats reporting, keep track of the minimum and maximum actual number of hashes per host.
   // Users should hopefully pay attention to these numbers and alert if min_hashes_per_host is too
   // low, since that implies an inaccurate request distribution.
-  char hash_key_buffer[196];
+  hosts_.reserve(normalized_host_weights.size());
+  hashes_per_host_.reserve(normalized_host_weights.size());
   double current_hashes = 0.0;
   double target_hashes = 0.0;
   uint64_t min_hashes_per_host = ring_size;
   uint64_t max_hashes_per_host = 0;
   for (const auto& entry : normalized_host_weights) {
-    const auto& host = entry.first;
-    const std::string& address_string = host->address()->asString();
-    uint64_t offset_start = address_string.size();
-
-    // Currently, we support both IP and UDS addresses. The UDS max path length is ~108 on all Unix
-    // platforms that I know of. Given that, we can use a 196 char buffer which is plenty of room
-    // for UDS, '_', and up to 21 characters for the node ID. To be on the super safe side, there
-    // is a RELEASE_ASSERT here that checks this, in case someone in the future adds some type of
-    // new address that is larger, or runs on a platform where UDS is larger. I don't think it's
-    // worth the defensive coding to deal with the heap allocation case (e.g. via
-    // absl::InlinedVector) at the current time.
-    RELEASE_ASSERT(
-        address_string.size() + 1 + StringUtil::MIN_ITOA_OUT_LEN <= sizeof(hash_key_buffer), "");
-    memcpy(hash_key_buffer, address_string.c_str(), offset_start);
-    hash_key_buffer[offset_start++] = '_';
-
-    // As noted above: maintain current_hashes and target_hashes as running sums across the entire
-    // host set. `i` is needed only to construct the hash key, and tally min/max hashes per host.
     target_hashes += scale * entry.second;
     uint64_t i = 0;
     while (current_hashes < target_hashes) {
-      const uint64_t total_hash_key_len =
-          offset_start +
-          StringUtil::itoa(hash_key_buffer + offset_start, StringUtil::MIN_ITOA_OUT_LEN, i);
-      absl::string_view hash_key(hash_key_buffer, total_hash_key_len);
-
-      // Sadly std::hash provides no mechanism for hashing arbitrary bytes so we must copy here.
-      // xxHash is done without copies.
-      const uint64_t hash =
-          use_std_hash
-              ? std::hash<std::string>()(std::string(hash_key))
-              : (hash_function == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
-                    ? MurmurHash::murmurHash2_64(hash_key, MurmurHash::STD_HASH_SEED)
-                    : HashUtil::xxHash64(hash_key);
-
-      ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
       ++i;
       ++current_hashes;
     }
+    hosts_.push_back(entry.first);
+    hashes_per_host_.push_back(i);
     min_hashes_per_host = std::min(i, min_hashes_per_host);
     max_hashes_per_host = std::max(i, max_hashes_per_host);
   }
+  RELEASE_ASSERT(hosts_.size() < std::numeric_limits<uint32_t>::max(), "");
+
+  if (previous == nullptr || !updateRing(*previous, use_std_hash, hash_function)) {
+    buildRing(use_std_hash, hash_function);
+  }
 
-  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
-    return lhs.hash_ < rhs.hash_;
-  });
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
     for (const auto& entry : ring_) {
-      ENVOY_LOG(trace, "ring hash: host={} hash={}", entry.host_->address()->asString(),
-                entry.hash_);
+      ENVOY_LOG(trace, "ring hash: host={} hash={}",
+                hosts_[entry.host_index_]->address()->asString(), entry.hash_);
     }
   }
 
@@ -188,5 +213,111 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   stats_.max_hashes_per_host_.set(max_hashes_per_host);
 }
 
+void RingHashLoadBalancer::Ring::buildRing(bool use_std_hash, HashFunction hash_function) {
+  // Reserve memory for the entire ring up front.
+  ring_.reserve(std::accumulate(hashes_per_host_.begin(), hashes_per_host_.end(), uint64_t(0)));
+
+  for (uint32_t host_index = 0; host_index < hosts_.size(); ++host_index) {
+    HostHasher hasher(*hosts_[host_index], use_std_hash, hash_function);
+    for (uint64_t i = 0; i < hashes_per_host_[host_index]; ++i) {
+      ring_.push_back({hasher.hash(i), host_index});
+    }
+  }
+
+  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
+    return lhs.hash_ < rhs.hash_;
+  });
+}
+
+bool RingHashLoadBalancer::Ring::updateRing(const Ring& previous, bool use_std_hash,
+                                            HashFunction hash_function) {
+  static const uint32_t RemovedHostIndex = std::numeric_limits<uint32_t>::max();
+
+  // A host keeps the hashes [0, n) it already had and gains or loses the ones past n, so only
+  // hashes of hosts whose count changed need to be computed. Start by mapping the previous host
+  // indices onto the new ones and counting the hashes that change.
+  std::unordered_map<const Host*, uint32_t> new_host_indices;
+  new_host_indices.reserve(hosts_.size());
+  for (uint32_t host_index = 0; host_index < hosts_.size(); ++host_index) {
+    new_host_indices.emplace(hosts_[host_index].get(), host_index);
+  }
+
+  std::vector<uint32_t> host_index_map(previous.hosts_.size(), RemovedHostIndex);
+  std::vector<uint64_t> previous_hashes_per_host(hosts_.size(), 0);
+  uint64_t changed_hashes = 0;
+  for (uint32_t previous_index = 0; previous_index < previous.hosts_.size(); ++previous_index) {
+    const auto it = new_host_indices.find(previous.hosts_[previous_index].get());
+    const uint64_t previous_hashes = previous.hashes_per_host_[previous_index];
+    if (it == new_host_indices.end()) {
+      changed_hashes += previous_hashes;
+      continue;
+    }
+    host_index_map[previous_index] = it->second;
+    previous_hashes_per_host[it->second] = previous_hashes;
+  }
+  for (uint32_t host_index = 0; host_index < hosts_.size(); ++host_index) {
+    const uint64_t previous_hashes = previous_hashes_per_host[host_index];
+    const uint64_t hashes = hashes_per_host_[host_index];
+    changed_hashes +=
+        hashes > previous_hashes ? hashes - previous_hashes : previous_hashes - hashes;
+  }
+
+  // Once a large part of the ring changes (e.g. because the scale changed), sorting the whole ring
+  // again is cheaper.
+  if (changed_hashes * 2 > previous.ring_.size()) {
+    return false;
+  }
+
+  std::vector<RingEntry> added;
+  std::unordered_multimap<uint64_t, uint32_t> trimmed;
+  for (uint32_t host_index = 0; host_index < hosts_.size(); ++host_index) {
+    const uint64_t previous_hashes = previous_hashes_per_host[host_index];
+    const uint64_t hashes = hashes_per_host_[host_index];
+    if (hashes == previous_hashes) {
+      continue;
+    }
+    HostHasher hasher(*hosts_[host_index], use_std_hash, hash_function);
+    for (uint64_t i = previous_hashes; i < hashes; ++i) {
+      added.push_back({hasher.hash(i), host_index});
+    }
+    for (uint64_t i = hashes; i < previous_hashes; ++i) {
+      trimmed.emplace(hasher.hash(i), host_index);
+    }
+  }
+  std::sort(added.begin(), added.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
+    return lhs.hash_ < rhs.hash_;
+  });
+
+  // Merge the surviving entries of the previous ring with the added ones, keeping the ring sorted.
+  ring_.reserve(previous.ring_.size() + added.size());
+  auto added_it = added.begin();
+  for (const RingEntry& entry : previous.ring_) {
+    const uint32_t host_index = host_index_map[entry.host_index_];
+    if (host_index == RemovedHostIndex) {
+      continue;
+    }
+    if (!trimmed.empty()) {
+      const auto range = trimmed.equal_range(entry.hash_);
+      const auto it = std::find_if(range.first, range.second,
+                                   [host_index](const std::pair<const uint64_t, uint32_t>& e) {
+                                     return e.second == host_index;
+                                   });
+      if (it != range.second) {
+        trimmed.erase(it);
+        continue;
+      }
+    }
+    while (added_it != added.end() && added_it->hash_ < entry.hash_) {
+      ring_.push_back(*added_it++);
+    }
+    ring_.push_back({entry.hash_, host_index});
+  }
+  ring_.insert(ring_.end(), added_it, added.end());
+
+  ENVOY_LOG(debug, "ring hash: updated ring with {} added and {} removed hashes", added.size(),
+            changed_hashes - added.size());
+  return true;
+}
+
 } // namespace Upstream
 } // namespace Envoy
@@ -33,6 +33,9 @@ struct RingHashLoadBalancerStats {
  * A load balancer that implements consistent modulo hashing ("ketama"). Currently, zone aware
  * routing is not supported. A ring is kept for all hosts as well as a ring for healthy hosts.
  * Unless we are in panic mode, the healthy host ring is used.
+ * When the host set changes, the new ring is derived from the previous one by removing and adding
+ * only the hashes of hosts whose share of the ring changed, falling back to a full build when most
+ * of the ring changes. Either way the resulting ring is the same.
  * In the future it would be nice to support:
  * 1) Weighting.
  * 2) Per-zone rings and optional zone aware routing (not all applications will want this).
@@ -53,17 +56,28 @@ private:
 
   struct RingEntry {
     uint64_t hash_;
-    HostConstSharedPtr host_;
+    // Index into Ring::hosts_.
+    uint32_t host_index_;
   };
 
   struct Ring : public HashingLoadBalancer {
+    /**
+     * @param previous supplies the ring previously built by the same load balancer, if any. Only
+     *        the hashes of hosts whose number of hashes changed are recomputed.
+     */
     Ring(const NormalizedHostWeightVector& normalized_host_weights, double min_normalized_weight,
          uint64_t min_ring_size, uint64_t max_ring_size, bool use_std_hash,
-         HashFunction hash_function, RingHashLoadBalancerStats& stats);
+         HashFunction hash_function, RingHashLoadBalancerStats& stats, const Ring* previous);
 
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostConstSharedPtr chooseHost(uint64_t hash) const override;
 
+    void buildRing(bool use_std_hash, HashFunction hash_function);
+    bool updateRing(const Ring& previous, bool use_std_hash, HashFunction hash_function);
+
+    // Hosts in the order they were supplied, along with the number of hashes each has on the ring.
+    std::vector<HostConstSharedPtr> hosts_;
+    std::vector<uint64_t> hashes_per_host_;
     std::vector<RingEntry> ring_;
 
     RingHashLoadBalancerStats& stats_;
@@ -73,9 +87,11 @@ private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
   createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double /* max_normalized_weight */) override {
+                     double min_normalized_weight, double /* max_normalized_weight */,
+                     const HashingLoadBalancerSharedPtr& previous_lb) override {
     return std::make_shared<Ring>(normalized_host_weights, min_normalized_weight, min_ring_size_,
-                                  max_ring_size_, use_std_hash_, hash_function_, stats_);
+                                  max_ring_size_, use_std_hash_, hash_function_, stats_,
+                                  dynamic_cast<const Ring*>(previous_lb.get()));
   }
 
   static RingHashLoadBalancerStats generateStats(Stats::Scope& scope);
@@ -1,5 +1,6 @@
 #include "common/upstream/subset_lb.h"
 
+#include <algorithm>
 #include <memory>
 #include <unordered_set>
 
@@ -7,6 +8,7 @@
 #include "envoy/runtime/runtime.h"
 
 #include "common/common/assert.h"
+#include "common/common/hash.h"
 #include "common/config/metadata.h"
 #include "common/config/well_known_names.h"
 #include "common/protobuf/utility.h"
@@ -17,6 +19,17 @@
 namespace Envoy {
 namespace Upstream {
 
+namespace {
+
+// Folds a key and the hash of its value into the hash of a subset's metadata. Subsets are hashed
+// by their key-value pairs in key order, which is the order of both the metadata extracted from
+// hosts and a route's metadata match criteria.
+uint64_t hashKeyValue(uint64_t hash, const std::string& key, std::size_t value_hash) {
+  return HashUtil::xxHash64(key, hash ^ value_hash);
+}
+
+} // namespace
+
 SubsetLoadBalancer::SubsetLoadBalancer(
     LoadBalancerType lb_type, PrioritySet& priority_set, const PrioritySet* local_priority_set,
     ClusterStats& stats, Stats::Scope& scope, Runtime::Loader& runtime,
@@ -46,23 +59,11 @@ SubsetLoadBalancer::SubsetLoadBalancer(
   // Create filtered default subset (if necessary) and other subsets based on current hosts.
   refreshSubsets();
 
-  // Configure future updates.
+  // Configure future updates. Hosts whose metadata changed are not part of the deltas, update()
+  // finds them itself.
   original_priority_set_callback_handle_ = priority_set.addPriorityUpdateCb(
       [this](uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed) {
-        if (!hosts_added.size() && !hosts_removed.size()) {
-          // It's possible that metadata changed, without hosts being added nor removed.
-          // If so we need to add any new subsets, remove unused ones, and regroup hosts into
-          // the right subsets.
-          //
-          // Note, note, note: if metadata for existing endpoints changed _and_ hosts were also
-          // added or removed, we don't need to hit this path. That's fine, given that
-          // findOrCreateSubset() will be called from processSubsets because it'll be triggered by
-          // either hosts_added or hosts_removed. That's where the new subsets will be created.
-          refreshSubsets(priority);
-        } else {
-          // This is a regular update with deltas.
-          update(priority, hosts_added, hosts_removed);
-        }
+        update(priority, hosts_added, hosts_removed);
       });
 }
 
@@ -70,7 +71,7 @@ SubsetLoadBalancer::~SubsetLoadBalancer() {
   original_priority_set_callback_handle_->remove();
 
   // Ensure gauges reflect correct values.
-  forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
+  forEachSubset([&](LbSubsetEntryPtr entry) {
     if (entry->initialized() && entry->active()) {
       stats_.lb_subsets_removed_.inc();
       stats_.lb_subsets_active_.dec();
@@ -84,12 +85,6 @@ void SubsetLoadBalancer::refreshSubsets() {
   }
 }
 
-void SubsetLoadBalancer::refreshSubsets(uint32_t priority) {
-  const auto& host_sets = original_priority_set_.hostSetsPerPriority();
-  ASSERT(priority < host_sets.size());
-  update(priority, host_sets[priority]->hosts(), {});
-}
-
 HostConstSharedPtr SubsetLoadBalancer::chooseHost(LoadBalancerContext* context) {
   if (context) {
     bool host_chosen;
@@ -145,40 +140,30 @@ HostConstSharedPtr SubsetLoadBalancer::tryChooseHostFromContext(LoadBalancerCont
   return entry->priority_subset_->lb_->chooseHost(context);
 }
 
-// Iterates over the given metadata match criteria (which must be lexically sorted by key) and find
-// a matching LbSubsetEntryPtr, if any.
+// Finds the LbSubsetEntryPtr matching the given metadata match criteria (which must be lexically
+// sorted by key), if any.
 SubsetLoadBalancer::LbSubsetEntryPtr SubsetLoadBalancer::findSubset(
     const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& match_criteria) {
-  const LbSubsetMap* subsets = &subsets_;
-
-  // Because the match_criteria and the host metadata used to populate subsets_ are sorted in the
-  // same order, we can iterate over the criteria and perform a lookup for each key and value,
-  // starting with the root LbSubsetMap and using the previous iteration's LbSubsetMap thereafter
-  // (tracked in subsets). If ever a criterion's key or value is not found, there is no subset for
-  // this criteria. If we reach the last criterion, we've found the LbSubsetEntry for the criteria,
-  // which may or may not have a subset attached to it.
-  for (uint32_t i = 0; i < match_criteria.size(); i++) {
-    const Router::MetadataMatchCriterion& match_criterion = *match_criteria[i];
-    const auto& subset_it = subsets->find(match_criterion.name());
-    if (subset_it == subsets->end()) {
-      // No subsets with this key (at this level in the hierarchy).
-      break;
-    }
+  uint64_t hash = 0;
+  for (const auto& match_criterion : match_criteria) {
+    hash = hashKeyValue(hash, match_criterion->name(), match_criterion->value().hash());
+  }
 
-    const ValueSubsetMap& vs_map = subset_it->second;
-    const auto& vs_it = vs_map.find(match_criterion.value());
-    if (vs_it == vs_map.end()) {
-      // No subsets with this value.
-      break;
+  const auto range = subsets_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const SubsetMetadata& kvs = it->second->kvs_;
+    if (kvs.size() != match_criteria.size()) {
+      continue;
     }
 
-    const LbSubsetEntryPtr& entry = vs_it->second;
-    if (i + 1 == match_criteria.size()) {
-      // We've reached the end of the criteria, and they all matched.
-      return entry;
+    bool matches = true;
+    for (uint32_t i = 0; i < kvs.size() && matches; i++) {
+      matches = kvs[i].first == match_criteria[i]->name() &&
+                ValueUtil::equal(kvs[i].second, match_criteria[i]->value().value());
+    }
+    if (matches) {
+      return it->second;
     }
-
-    subsets = &entry->children_;
   }
 
   return nullptr;
@@ -216,96 +201,125 @@ void SubsetLoadBalancer::updateFallbackSubset(uint32_t priority, const HostVecto
   fallback_subset_->priority_subset_->update(priority, hosts_added, hosts_removed);
 }
 
-// Iterates over the added and removed hosts, looking up an LbSubsetEntryPtr for each. For every
-// unique LbSubsetEntryPtr found, it either invokes new_cb or update_cb depending on whether the
-// LbSubsetEntryPtr is already initialized (update_cb) or not (new_cb). In addition, update_cb is
-// invoked for any otherwise unmodified but active and initialized LbSubsetEntryPtr to allow host
-// health to be updated.
-void SubsetLoadBalancer::processSubsets(
-    const HostVector& hosts_added, const HostVector& hosts_removed,
-    std::function<void(LbSubsetEntryPtr)> update_cb,
-    std::function<void(LbSubsetEntryPtr, HostPredicate, const SubsetMetadata&, bool)> new_cb) {
-  std::unordered_set<LbSubsetEntryPtr> subsets_modified;
-
-  std::pair<const HostVector&, bool> steps[] = {{hosts_added, true}, {hosts_removed, false}};
-  for (const auto& step : steps) {
-    const auto& hosts = step.first;
-    const bool adding_hosts = step.second;
-
-    for (const auto& host : hosts) {
-      for (const auto& keys : subset_keys_) {
-        // For each host, for each subset key, attempt to extract the metadata corresponding to the
-        // key from the host.
-        SubsetMetadata kvs = extractSubsetMetadata(keys, *host);
-        if (!kvs.empty()) {
-          // The host has metadata for each key, find or create its subset.
-          LbSubsetEntryPtr entry = findOrCreateSubset(subsets_, kvs, 0);
-          if (subsets_modified.find(entry) != subsets_modified.end()) {
-            // We've already invoked the callback for this entry.
-            continue;
-          }
-          subsets_modified.emplace(entry);
-
-          if (entry->initialized()) {
-            update_cb(entry);
-          } else {
-            HostPredicate predicate =
-                std::bind(&SubsetLoadBalancer::hostMatches, this, kvs, std::placeholders::_1);
-
-            new_cb(entry, predicate, kvs, adding_hosts);
-          }
-        }
-      }
+// Given the addition and/or removal of hosts, update all subsets for this priority level, creating
+// new subsets as necessary. Only the subsets of hosts which were added, removed or had their
+// metadata changed are refiltered; other active subsets just pick up host health changes.
+void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added,
+                                const HostVector& hosts_removed) {
+  if (host_subsets_.size() <= priority) {
+    host_subsets_.resize(priority + 1);
+  }
+  auto& host_subsets = host_subsets_[priority];
+  std::unordered_map<LbSubsetEntryPtr, SubsetDelta> deltas;
+
+  for (const auto& host : hosts_removed) {
+    const auto it = host_subsets.find(host);
+    if (it == host_subsets.end()) {
+      continue;
+    }
+    for (const auto& entry : it->second.subsets_) {
+      deltas[entry].hosts_removed_.emplace_back(host);
+    }
+    host_subsets.erase(it);
+  }
+
+  // Metadata is replaced rather than modified in place, so a host whose metadata pointer changed
+  // since it was placed may belong to different subsets now. Such hosts are moved as though they
+  // were removed and added back.
+  HostVector hosts_moved;
+  for (const auto& host : original_priority_set_.hostSetsPerPriority()[priority]->hosts()) {
+    const auto it = host_subsets.find(host);
+    if (it == host_subsets.end() || it->second.metadata_ == host->metadata()) {
+      continue;
+    }
+    for (const auto& entry : it->second.subsets_) {
+      deltas[entry].hosts_removed_.emplace_back(host);
+    }
+    it->second.subsets_.clear();
+    placeHost(host, it->second, deltas);
+    hosts_moved.emplace_back(host);
+  }
+
+  for (const auto& host : hosts_added) {
+    placeHost(host, host_subsets[host], deltas);
+  }
+
+  if (hosts_moved.empty()) {
+    updateFallbackSubset(priority, hosts_added, hosts_removed);
+  } else {
+    HostVector fallback_added = hosts_moved;
+    fallback_added.insert(fallback_added.end(), hosts_added.begin(), hosts_added.end());
+    HostVector fallback_removed = hosts_moved;
+    fallback_removed.insert(fallback_removed.end(), hosts_removed.begin(), hosts_removed.end());
+    updateFallbackSubset(priority, fallback_added, fallback_removed);
+  }
+
+  const auto update_entry = [&](const LbSubsetEntryPtr& entry, const HostVector& added,
+                                const HostVector& removed) {
+    const bool active_before = entry->active();
+    entry->priority_subset_->update(priority, added, removed);
+
+    if (active_before && !entry->active()) {
+      stats_.lb_subsets_active_.dec();
+      stats_.lb_subsets_removed_.inc();
+    } else if (!active_before && entry->active()) {
+      stats_.lb_subsets_active_.inc();
+      stats_.lb_subsets_created_.inc();
+    }
+  };
+
+  for (const auto& it : deltas) {
+    const LbSubsetEntryPtr& entry = it.first;
+    if (entry->initialized()) {
+      update_entry(entry, it.second.hosts_added_, it.second.hosts_removed_);
+    } else if (!it.second.hosts_added_.empty()) {
+      ENVOY_LOG(debug, "subset lb: creating load balancer for {}", describeMetadata(entry->kvs_));
+
+      // Initialize new entry with hosts and update stats. (An uninitialized entry with only
+      // removed hosts is a degenerate case and we leave the entry uninitialized.)
+      HostPredicate predicate =
+          std::bind(&SubsetLoadBalancer::hostMatches, this, entry->kvs_, std::placeholders::_1);
+      entry->priority_subset_.reset(
+          new PrioritySubsetImpl(*this, predicate, locality_weight_aware_, scale_locality_weight_));
+      stats_.lb_subsets_active_.inc();
+      stats_.lb_subsets_created_.inc();
     }
   }
 
-  forEachSubset(subsets_, [&](LbSubsetEntryPtr entry) {
-    if (subsets_modified.find(entry) != subsets_modified.end()) {
+  forEachSubset([&](LbSubsetEntryPtr entry) {
+    if (deltas.find(entry) != deltas.end()) {
       // Already handled due to hosts being added or removed.
       return;
     }
 
     if (entry->initialized() && entry->active()) {
-      update_cb(entry);
+      update_entry(entry, {}, {});
     }
   });
 }
 
-// Given the addition and/or removal of hosts, update all subsets for this priority level, creating
-// new subsets as necessary.
-void SubsetLoadBalancer::update(uint32_t priority, const HostVector& hosts_added,
-                                const HostVector& hosts_removed) {
-  updateFallbackSubset(priority, hosts_added, hosts_removed);
-
-  processSubsets(hosts_added, hosts_removed,
-                 [&](LbSubsetEntryPtr entry) {
-                   const bool active_before = entry->active();
-                   entry->priority_subset_->update(priority, hosts_added, hosts_removed);
-
-                   if (active_before && !entry->active()) {
-                     stats_.lb_subsets_active_.dec();
-                     stats_.lb_subsets_removed_.inc();
-                   } else if (!active_before && entry->active()) {
-                     stats_.lb_subsets_active_.inc();
-                     stats_.lb_subsets_created_.inc();
-                   }
-                 },
-                 [&](LbSubsetEntryPtr entry, HostPredicate predicate, const SubsetMetadata& kvs,
-                     bool adding_host) {
-                   UNREFERENCED_PARAMETER(kvs);
-                   if (adding_host) {
-                     ENVOY_LOG(debug, "subset lb: creating load balancer for {}",
-                               describeMetadata(kvs));
-
-                     // Initialize new entry with hosts and update stats. (An uninitialized entry
-                     // with only removed hosts is a degenerate case and we leave the entry
-                     // uninitialized.)
-                     entry->priority_subset_.reset(new PrioritySubsetImpl(
-                         *this, predicate, locality_weight_aware_, scale_locality_weight_));
-                     stats_.lb_subsets_active_.inc();
-                     stats_.lb_subsets_created_.inc();
-                   }
-                 });
+// Finds or creates the subsets the host belongs in, recording them in host_subsets and adding the
+// host to each subset's delta.
+void SubsetLoadBalancer::placeHost(const HostSharedPtr& host, HostSubsets& host_subsets,
+                                   std::unordered_map<LbSubsetEntryPtr, SubsetDelta>& deltas) {
+  host_subsets.metadata_ = host->metadata();
+  for (const auto& keys : subset_keys_) {
+    // For each subset key, attempt to extract the metadata corresponding to the key from the host.
+    SubsetMetadata kvs = extractSubsetMetadata(keys, *host);
+    if (kvs.empty()) {
+      continue;
+    }
+
+    // The host has metadata for each key, find or create its subset. Duplicate subset keys lead
+    // to the same subset.
+    LbSubsetEntryPtr entry = findOrCreateSubset(kvs);
+    if (std::find(host_subsets.subsets_.begin(), host_subsets.subsets_.end(), entry) !=
+        host_subsets.subsets_.end()) {
+      continue;
+    }
+    host_subsets.subsets_.emplace_back(entry);
+    deltas[entry].hosts_added_.emplace_back(host);
+  }
 }
 
 bool SubsetLoadBalancer::hostMatches(const SubsetMetadata& kvs, const Host& host) {
@@ -383,57 +397,38 @@ std::string SubsetLoadBalancer::describeMetadata(const SubsetLoadBalancer::Subse
   return buf.str();
 }
 
-// Given a vector of key-values (from extractSubsetMetadata), recursively finds the matching
-// LbSubsetEntryPtr.
+// Given a vector of key-values (from extractSubsetMetadata), finds the matching LbSubsetEntryPtr,
+// creating an uninitialized one if there is none.
 SubsetLoadBalancer::LbSubsetEntryPtr
-SubsetLoadBalancer::findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadata& kvs,
-                                       uint32_t idx) {
-  ASSERT(idx < kvs.size());
-
-  const std::string& name = kvs[idx].first;
-  const ProtobufWkt::Value& pb_value = kvs[idx].second;
-  const HashedValue value(pb_value);
-  LbSubsetEntryPtr entry;
-
-  const auto& kv_it = subsets.find(name);
-  if (kv_it != subsets.end()) {
-    ValueSubsetMap& value_subset_map = kv_it->second;
-    const auto vs_it = value_subset_map.find(value);
-    if (vs_it != value_subset_map.end()) {
-      entry = vs_it->second;
-    }
-  }
+SubsetLoadBalancer::findOrCreateSubset(const SubsetMetadata& kvs) {
+  ASSERT(!kvs.empty());
 
-  if (!entry) {
-    // Not found. Create an uninitialized entry.
-    entry.reset(new LbSubsetEntry());
-    if (kv_it != subsets.end()) {
-      ValueSubsetMap& value_subset_map = kv_it->second;
-      value_subset_map.emplace(value, entry);
-    } else {
-      ValueSubsetMap value_subset_map = {{value, entry}};
-      subsets.emplace(name, value_subset_map);
-    }
+  uint64_t hash = 0;
+  for (const auto& kv : kvs) {
+    hash = hashKeyValue(hash, kv.first, ValueUtil::hash(kv.second));
   }
 
-  idx++;
-  if (idx == kvs.size()) {
-    // We've matched all the key-values, return the entry.
-    return entry;
+  const auto range = subsets_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const SubsetMetadata& entry_kvs = it->second->kvs_;
+    if (std::equal(kvs.begin(), kvs.end(), entry_kvs.begin(), entry_kvs.end(),
+                   [](const SubsetMetadata::value_type& a, const SubsetMetadata::value_type& b) {
+                     return a.first == b.first && ValueUtil::equal(a.second, b.second);
+                   })) {
+      return it->second;
+    }
   }
 
-  return findOrCreateSubset(entry->children_, kvs, idx);
+  // Not found. Create an uninitialized entry.
+  LbSubsetEntryPtr entry = std::make_shared<LbSubsetEntry>(kvs);
+  subsets_.emplace(hash, entry);
+  return entry;
 }
 
-// Invokes cb for each LbSubsetEntryPtr in subsets.
-void SubsetLoadBalancer::forEachSubset(LbSubsetMap& subsets,
-                                       std::function<void(LbSubsetEntryPtr)> cb) {
-  for (auto& vsm : subsets) {
-    for (auto& em : vsm.second) {
-      LbSubsetEntryPtr entry = em.second;
-      cb(entry);
-      forEachSubset(entry->children_, cb);
-    }
+// Invokes cb for each LbSubsetEntryPtr in subsets_.
+void SubsetLoadBalancer::forEachSubset(std::function<void(LbSubsetEntryPtr)> cb) {
+  for (const auto& it : subsets_) {
+    cb(it.second);
   }
 }
 
@@ -498,73 +493,92 @@ SubsetLoadBalancer::PrioritySubsetImpl::PrioritySubsetImpl(const SubsetLoadBalan
 
   case LoadBalancerType::OriginalDst:
     NOT_REACHED_GCOVR_EXCL_LINE;
+
+  case LoadBalancerType::PeakEwma:
+    // Peak EWMA can't be configured with subsets, see ClusterInfoImpl.
+    NOT_REACHED_GCOVR_EXCL_LINE;
   }
 
   triggerCallbacks();
 }
 
-// Given hosts_added and hosts_removed, update the underlying HostSet. The hosts_added Hosts must
-// be filtered to match hosts that belong in this subset. The hosts_removed Hosts are ignored if
-// they are not currently a member of this subset.
+// Given hosts_added and hosts_removed, update the underlying HostSet. The hosts_added Hosts are
+// filtered with the predicate. The hosts_removed Hosts are ignored if they are not currently a
+// member of this subset. Hosts that are already members aren't filtered again, since calling
+// predicate() is expensive as it involves metadata lookups.
 void SubsetLoadBalancer::HostSubsetImpl::update(const HostVector& hosts_added,
                                                 const HostVector& hosts_removed,
                                                 std::function<bool(const Host&)> predicate) {
-  std::unordered_set<HostSharedPtr> predicate_added;
+  std::unordered_set<const Host*> members;
+  for (const auto& host : hosts()) {
+    members.insert(host.get());
+  }
+
+  std::unordered_set<const Host*> removed;
+  for (const auto& host : hosts_removed) {
+    if (members.count(host.get()) == 1) {
+      removed.insert(host.get());
+    }
+  }
 
+  // A host that is removed and added back in the same update (e.g. when its metadata changed
+  // but it still matches) stays a member, and is reported as neither added nor removed.
   HostVector filtered_added;
-  for (const auto host : hosts_added) {
-    if (predicate(*host)) {
-      predicate_added.insert(host);
+  for (const auto& host : hosts_added) {
+    if (predicate(*host) && removed.erase(host.get()) == 0 && members.insert(host.get()).second) {
       filtered_added.emplace_back(host);
     }
   }
 
   HostVector filtered_removed;
-  for (const auto host : hosts_removed) {
-    if (predicate(*host)) {
+  for (const auto& host : hosts_removed) {
+    if (removed.count(host.get()) == 1 && members.erase(host.get()) == 1) {
       filtered_removed.emplace_back(host);
     }
   }
 
+  const auto is_member = [&members](const Host& host) { return members.count(&host) == 1; };
+  const HostsPerLocality& original_hosts_per_locality = original_host_set_.hostsPerLocality();
+
+  // When hosts were only removed, the remaining members are already in the original order.
+  // Otherwise the original hosts are walked to keep it, which only costs a set lookup per host.
+  const bool from_original =
+      !filtered_added.empty() ||
+      hostsPerLocality().get().size() != original_hosts_per_locality.get().size();
   HostVectorSharedPtr hosts(new HostVector());
   HostVectorSharedPtr healthy_hosts(new HostVector());
   HostVectorSharedPtr degraded_hosts(new HostVector());
+  for (const auto& host : from_original ? original_host_set_.hosts() : this->hosts()) {
+    if (!is_member(*host)) {
+      continue;
+    }
 
-  // It's possible that hosts_added == original_host_set_.hosts(), e.g.: when
-  // calling refreshSubsets() if only metadata change. If so, we can avoid the
-  // predicate() call.
-  for (const auto host : original_host_set_.hosts()) {
-    bool host_seen = predicate_added.count(host) == 1;
-    if (host_seen || predicate(*host)) {
-      hosts->emplace_back(host);
-      switch (host->health()) {
-      case Host::Health::Healthy:
-        healthy_hosts->emplace_back(host);
-        break;
-      case Host::Health::Degraded:
-        degraded_hosts->emplace_back(host);
-        break;
-      case Host::Health::Unhealthy:
-        break;
-      }
+    hosts->emplace_back(host);
+    switch (host->health()) {
+    case Host::Health::Healthy:
+      healthy_hosts->emplace_back(host);
+      break;
+    case Host::Health::Degraded:
+      degraded_hosts->emplace_back(host);
+      break;
+    case Host::Health::Unhealthy:
+      break;
     }
   }
 
-  // Calling predicate() is expensive since it involves metadata lookups; so we
-  // avoid it in the 2nd call to filter() by using the result from the first call
-  // to filter() as the starting point.
-  //
-  // Also, if we only have one locality we can avoid the first call to filter() by
-  // just creating a new HostsPerLocality from the list of all hosts.
+  // If we only have one locality we can avoid filtering by just creating a new HostsPerLocality
+  // from the list of all hosts.
   //
   // TODO(rgs1): merge these two filter() calls in one loop.
   HostsPerLocalityConstSharedPtr hosts_per_locality;
 
-  if (original_host_set_.hostsPerLocality().get().size() == 1) {
+  if (original_hosts_per_locality.get().size() == 1) {
     hosts_per_locality.reset(
-        new HostsPerLocalityImpl(*hosts, original_host_set_.hostsPerLocality().hasLocalLocality()));
+        new HostsPerLocalityImpl(*hosts, original_hosts_per_locality.hasLocalLocality()));
+  } else if (from_original) {
+    hosts_per_locality = original_hosts_per_locality.filter(is_member);
   } else {
-    hosts_per_locality = original_host_set_.hostsPerLocality().filter(predicate);
+    hosts_per_locality = hostsPerLocality().filter(is_member);
   }
 
   HostsPerLocalityConstSharedPtr healthy_hosts_per_locality = hosts_per_locality->filter(
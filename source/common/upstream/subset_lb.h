@@ -5,6 +5,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
@@ -46,6 +47,8 @@ private:
           original_host_set_(original_host_set), locality_weight_aware_(locality_weight_aware),
           scale_locality_weight_(scale_locality_weight) {}
 
+    // Only hosts_added are checked against the predicate: existing hosts stay members until they
+    // are removed. A host whose metadata changed must be passed as both removed and added.
     void update(const HostVector& hosts_added, const HostVector& hosts_removed,
                 HostPredicate predicate);
     LocalityWeightsConstSharedPtr
@@ -110,38 +113,47 @@ private:
 
   typedef std::vector<std::pair<std::string, ProtobufWkt::Value>> SubsetMetadata;
 
-  class LbSubsetEntry;
-  typedef std::shared_ptr<LbSubsetEntry> LbSubsetEntryPtr;
-  typedef std::unordered_map<HashedValue, LbSubsetEntryPtr> ValueSubsetMap;
-  typedef std::unordered_map<std::string, ValueSubsetMap> LbSubsetMap;
-
-  // Entry in the subset hierarchy.
+  // Entry in the subset index.
   class LbSubsetEntry {
   public:
     LbSubsetEntry() {}
+    LbSubsetEntry(const SubsetMetadata& kvs) : kvs_(kvs) {}
 
     bool initialized() const { return priority_subset_ != nullptr; }
     bool active() const { return initialized() && !priority_subset_->empty(); }
 
-    LbSubsetMap children_;
+    // The metadata of the subset's hosts, sorted by key. Empty for the fallback and panic mode
+    // subsets.
+    const SubsetMetadata kvs_;
 
-    // Only initialized if a match exists at this level.
+    // Only initialized once a host has been added to the subset.
     PrioritySubsetImplPtr priority_subset_;
   };
 
+  typedef std::shared_ptr<LbSubsetEntry> LbSubsetEntryPtr;
+
+  // The subsets a host was placed in, and the metadata it was placed by.
+  struct HostSubsets {
+    std::shared_ptr<envoy::api::v2::core::Metadata> metadata_;
+    std::vector<LbSubsetEntryPtr> subsets_;
+  };
+
+  // The hosts added to and removed from a subset by an update.
+  struct SubsetDelta {
+    HostVector hosts_added_;
+    HostVector hosts_removed_;
+  };
+
   // Create filtered default subset (if necessary) and other subsets based on current hosts.
   void refreshSubsets();
-  void refreshSubsets(uint32_t priority);
 
   // Called by HostSet::MemberUpdateCb
   void update(uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed);
 
   void updateFallbackSubset(uint32_t priority, const HostVector& hosts_added,
                             const HostVector& hosts_removed);
-  void processSubsets(
-      const HostVector& hosts_added, const HostVector& hosts_removed,
-      std::function<void(LbSubsetEntryPtr)> update_cb,
-      std::function<void(LbSubsetEntryPtr, HostPredicate, const SubsetMetadata&, bool)> cb);
+  void placeHost(const HostSharedPtr& host, HostSubsets& host_subsets,
+                 std::unordered_map<LbSubsetEntryPtr, SubsetDelta>& deltas);
 
   HostConstSharedPtr tryChooseHostFromContext(LoadBalancerContext* context, bool& host_chosen);
 
@@ -150,9 +162,8 @@ private:
   LbSubsetEntryPtr
   findSubset(const std::vector<Router::MetadataMatchCriterionConstSharedPtr>& matches);
 
-  LbSubsetEntryPtr findOrCreateSubset(LbSubsetMap& subsets, const SubsetMetadata& kvs,
-                                      uint32_t idx);
-  void forEachSubset(LbSubsetMap& subsets, std::function<void(LbSubsetEntryPtr)> cb);
+  LbSubsetEntryPtr findOrCreateSubset(const SubsetMetadata& kvs);
+  void forEachSubset(std::function<void(LbSubsetEntryPtr)> cb);
 
   SubsetMetadata extractSubsetMetadata(const std::set<std::string>& subset_keys, const Host& host);
   std::string describeMetadata(const SubsetMetadata& kvs);
@@ -177,8 +188,13 @@ private:
   LbSubsetEntryPtr fallback_subset_;
   LbSubsetEntryPtr panic_mode_subset_;
 
-  // Forms a trie-like structure. Requires lexically sorted Host and Route metadata.
-  LbSubsetMap subsets_;
+  // Subsets keyed by a hash of their metadata, see findSubset(). Requires lexically sorted Host
+  // and Route metadata. Subsets with colliding hashes are told apart by their metadata.
+  std::unordered_multimap<uint64_t, LbSubsetEntryPtr> subsets_;
+
+  // Per priority, the subsets each host is in. Lets an update touch only the subsets of the hosts
+  // it adds, removes or changes the metadata of.
+  std::vector<std::unordered_map<HostSharedPtr, HostSubsets>> host_subsets_;
 
   const bool locality_weight_aware_;
   const bool scale_locality_weight_;
@@ -86,6 +86,13 @@ void ThreadAwareLoadBalancerBase::initialize() {
 }
 
 void ThreadAwareLoadBalancerBase::refresh() {
+  // Only the main thread writes per_priority_state_, so it can't change after it is read here.
+  std::shared_ptr<std::vector<PerPriorityStatePtr>> previous_per_priority_state;
+  {
+    absl::ReaderMutexLock lock(&factory_->mutex_);
+    previous_per_priority_state = factory_->per_priority_state_;
+  }
+
   auto per_priority_state_vector = std::make_shared<std::vector<PerPriorityStatePtr>>(
       priority_set_.hostSetsPerPriority().size());
   auto healthy_per_priority_load =
@@ -107,8 +114,12 @@ void ThreadAwareLoadBalancerBase::refresh() {
     double max_normalized_weight = 0.0;
     normalizeWeights(*host_set, per_priority_state->global_panic_, normalized_host_weights,
                      min_normalized_weight, max_normalized_weight);
-    per_priority_state->current_lb_ =
-        createLoadBalancer(normalized_host_weights, min_normalized_weight, max_normalized_weight);
+    const HashingLoadBalancerSharedPtr previous_lb =
+        previous_per_priority_state != nullptr && priority < previous_per_priority_state->size()
+            ? (*previous_per_priority_state)[priority]->current_lb_
+            : nullptr;
+    per_priority_state->current_lb_ = createLoadBalancer(
+        normalized_host_weights, min_normalized_weight, max_normalized_weight, previous_lb);
   }
 
   {
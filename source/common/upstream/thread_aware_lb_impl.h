@@ -79,9 +79,19 @@ private:
     std::shared_ptr<DegradedLoad> degraded_per_priority_load_ GUARDED_BY(mutex_);
   };
 
+  /**
+   * Create the hashing load balancer for a priority level.
+   * @param normalized_host_weights supplies the hosts and their weights, which sum up to 1.
+   * @param min_normalized_weight supplies the smallest weight in normalized_host_weights.
+   * @param max_normalized_weight supplies the largest weight in normalized_host_weights.
+   * @param previous_lb supplies the load balancer previously created for the same priority level,
+   *        if any. Implementations may reuse its state to avoid a full rebuild; it is immutable
+   *        and may still be in use by workers.
+   */
   virtual HashingLoadBalancerSharedPtr
   createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double max_normalized_weight) PURE;
+                     double min_normalized_weight, double max_normalized_weight,
+                     const HashingLoadBalancerSharedPtr& previous_lb) PURE;
   void refresh();
 
   std::shared_ptr<LoadBalancerFactoryImpl> factory_;
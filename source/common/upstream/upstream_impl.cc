@@ -1,6 +1,7 @@
 #include "common/upstream/upstream_impl.h"
 
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -70,6 +71,9 @@ uint64_t parseFeatures(const envoy::api::v2::Cluster& config) {
   if (config.close_connections_on_host_health_failure()) {
     features |= ClusterInfoImpl::Features::CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE;
   }
+  if (config.share_http2_connections_across_workers()) {
+    features |= ClusterInfoImpl::Features::SHARE_HTTP2_CONNECTIONS_ACROSS_WORKERS;
+  }
   return features;
 }
 
@@ -270,6 +274,48 @@ HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& clu
 
 void HostImpl::weight(uint32_t new_weight) { weight_ = std::max(1U, std::min(128U, new_weight)); }
 
+void HostDescriptionImpl::putResponseTime(std::chrono::microseconds response_time,
+                                          MonotonicTime now) const {
+  const auto& config = cluster().lbPeakEwmaConfig();
+  if (!config.has_value()) {
+    return;
+  }
+
+  // Responses completing on different workers may race here and drop a sample. That only perturbs
+  // the estimate slightly, and keeps locks off the request path.
+  // Samples are kept in fractional milliseconds so that sub-millisecond upstreams are measured.
+  const double sample = std::chrono::duration<double, std::milli>(response_time).count();
+  const double ewma = response_time_ewma_.load(std::memory_order_relaxed);
+  const double decay = responseTimeDecay(config.value(), now);
+  // The average jumps straight to a response time above it, so that a host which slows down is
+  // avoided right away, and only decays towards lower ones.
+  response_time_ewma_.store(sample > ewma ? sample : ewma * decay + sample * (1 - decay),
+                            std::memory_order_relaxed);
+  response_time_ewma_updated_.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+  has_response_time_.store(true, std::memory_order_relaxed);
+}
+
+absl::optional<double> HostDescriptionImpl::responseTimeEwma(MonotonicTime now) const {
+  const auto& config = cluster().lbPeakEwmaConfig();
+  if (!config.has_value() || !has_response_time_.load(std::memory_order_relaxed)) {
+    return absl::nullopt;
+  }
+
+  return response_time_ewma_.load(std::memory_order_relaxed) *
+         responseTimeDecay(config.value(), now);
+}
+
+double HostDescriptionImpl::responseTimeDecay(
+    const envoy::api::v2::Cluster::PeakEwmaLbConfig& config, MonotonicTime now) const {
+  const MonotonicTime updated{
+      MonotonicTime::duration(response_time_ewma_updated_.load(std::memory_order_relaxed))};
+  const double elapsed_ms = std::chrono::duration<double, std::milli>(now - updated).count();
+  if (elapsed_ms <= 0) {
+    return 1;
+  }
+  return std::exp(-elapsed_ms / PROTOBUF_GET_MS_OR_DEFAULT(config, decay_time, 10000));
+}
+
 HostsPerLocalityConstSharedPtr
 HostsPerLocalityImpl::filter(std::function<bool(const Host&)> predicate) const {
   auto* filtered_clone = new HostsPerLocalityImpl();
@@ -517,6 +563,10 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
     : runtime_(runtime), name_(config.name()), type_(config.type()),
       max_requests_per_connection_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_requests_per_connection, 0)),
+      per_upstream_prefetch_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.prefetch_policy(), per_upstream_prefetch_ratio, 1.0)),
+      min_warm_connections_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.prefetch_policy(), min_warm_connections, 0)),
       connect_timeout_(
           std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(config, connect_timeout))),
       per_connection_buffer_limit_bytes_(
@@ -561,6 +611,15 @@ ClusterInfoImpl::ClusterInfoImpl(const envoy::api::v2::Cluster& config,
   case envoy::api::v2::Cluster::MAGLEV:
     lb_type_ = LoadBalancerType::Maglev;
     break;
+  case envoy::api::v2::Cluster::PEAK_EWMA:
+    // The subset load balancer doesn't have a time source to hand to the peak EWMA load balancer.
+    if (lb_subset_.isEnabled()) {
+      throw EnvoyException(
+          fmt::format("cluster: LB type 'peak_ewma' may not be used with lb_subset_config"));
+    }
+    lb_type_ = LoadBalancerType::PeakEwma;
+    lb_peak_ewma_config_ = config.peak_ewma_lb_config();
+    break;
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
@@ -133,6 +133,8 @@ public:
   const envoy::api::v2::core::Locality& locality() const override { return locality_; }
   uint32_t priority() const override { return priority_; }
   void priority(uint32_t priority) override { priority_ = priority; }
+  void putResponseTime(std::chrono::microseconds response_time, MonotonicTime now) const override;
+  absl::optional<double> responseTimeEwma(MonotonicTime now) const override;
 
 protected:
   ClusterInfoConstSharedPtr cluster_;
@@ -148,6 +150,16 @@ protected:
   Outlier::DetectorHostMonitorPtr outlier_detector_;
   HealthCheckHostMonitorPtr health_checker_;
   std::atomic<uint32_t> priority_;
+
+private:
+  double responseTimeDecay(const envoy::api::v2::Cluster::PeakEwmaLbConfig& config,
+                           MonotonicTime now) const;
+
+  // Peak EWMA of response times in milliseconds, the time it was last updated, as the time since
+  // the MonotonicTime epoch, and whether any response time was recorded yet.
+  mutable std::atomic<double> response_time_ewma_{0};
+  mutable std::atomic<MonotonicTime::rep> response_time_ewma_updated_{0};
+  mutable std::atomic<bool> has_response_time_{false};
 };
 
 /**
@@ -510,12 +522,18 @@ public:
   lbRingHashConfig() const override {
     return lb_ring_hash_config_;
   }
+  const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>&
+  lbPeakEwmaConfig() const override {
+    return lb_peak_ewma_config_;
+  }
   const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>&
   lbOriginalDstConfig() const override {
     return lb_original_dst_config_;
   }
   bool maintenanceMode() const override;
   uint64_t maxRequestsPerConnection() const override { return max_requests_per_connection_; }
+  double perUpstreamPrefetchRatio() const override { return per_upstream_prefetch_ratio_; }
+  uint32_t minWarmConnections() const override { return min_warm_connections_; }
   const std::string& name() const override { return name_; }
   ResourceManager& resourceManager(ResourcePriority priority) const override;
   Network::TransportSocketFactory& transportSocketFactory() const override {
@@ -556,6 +574,8 @@ private:
   const std::string name_;
   const envoy::api::v2::Cluster::DiscoveryType type_;
   const uint64_t max_requests_per_connection_;
+  const double per_upstream_prefetch_ratio_;
+  const uint32_t min_warm_connections_;
   const std::chrono::milliseconds connect_timeout_;
   absl::optional<std::chrono::milliseconds> idle_timeout_;
   const uint32_t per_connection_buffer_limit_bytes_;
@@ -573,6 +593,7 @@ private:
   LoadBalancerType lb_type_;
   absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig> lb_least_request_config_;
   absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
+  absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig> lb_peak_ewma_config_;
   absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
   const bool added_via_api_;
   LoadBalancerSubsetInfoImpl lb_subset_;
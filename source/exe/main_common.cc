@@ -4,8 +4,10 @@
 #include <memory>
 #include <new>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/compiler_requirements.h"
 #include "common/common/perf_annotation.h"
+#include "common/common/regex.h"
 #include "common/event/libevent.h"
 #include "common/http/http2/codec_impl.h"
 #include "common/network/utility.h"
@@ -50,6 +52,9 @@ MainCommonBase::MainCommonBase(const OptionsImpl& options, Event::TimeSystem& ti
   Thread::ThreadFactorySingleton::set(&thread_factory_);
   ares_library_init(ARES_LIB_INIT_ALL);
   Event::Libevent::Global::initialize();
+  Buffer::OwnedImpl::useOldImpl(options_.libeventBufferEnabled());
+  Regex::Utility::setEngine(options_.regexEngine());
+  Regex::Utility::setMaxProgramSize(options_.regexMaxProgramSize());
   RELEASE_ASSERT(Envoy::Server::validateProtoDescriptors(), "");
   Http::Http2::initializeNghttp2Logging();
 
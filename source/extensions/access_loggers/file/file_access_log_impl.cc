@@ -35,8 +35,13 @@ void FileAccessLog::log(const Http::HeaderMap* request_headers,
     }
   }
 
-  log_file_->write(
-      formatter_->format(*request_headers, *response_headers, *response_trailers, stream_info));
+  // Format into a per-thread buffer that keeps its capacity, so that logging a line does not
+  // allocate once the buffer has grown to the typical line size.
+  static thread_local std::string log_line;
+  log_line.clear();
+  formatter_->formatInto(*request_headers, *response_headers, *response_trailers, stream_info,
+                         log_line);
+  log_file_->write(log_line);
 }
 
 } // namespace File
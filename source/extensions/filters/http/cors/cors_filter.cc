@@ -134,7 +134,7 @@ bool CorsFilter::isOriginAllowedRegex(const Http::HeaderString& origin) {
     return false;
   }
   for (const auto& regex : *allowOriginRegexes()) {
-    if (std::regex_match(origin.c_str(), regex)) {
+    if (regex->match(origin.getStringView())) {
       return true;
     }
   }
@@ -150,7 +150,7 @@ const std::list<std::string>* CorsFilter::allowOrigins() {
   return nullptr;
 }
 
-const std::list<std::regex>* CorsFilter::allowOriginRegexes() {
+const std::vector<Regex::CompiledMatcherPtr>* CorsFilter::allowOriginRegexes() {
   for (const auto policy : policies_) {
     if (policy && !policy->allowOriginRegexes().empty()) {
       return &policy->allowOriginRegexes();
@@ -1,27 +1,42 @@
 #include "extensions/transport_sockets/raw_buffer/config.h"
 
+#include "envoy/config/transport_socket/raw_buffer/v2alpha/raw_buffer.pb.h"
+#include "envoy/config/transport_socket/raw_buffer/v2alpha/raw_buffer.pb.validate.h"
 #include "envoy/registry/registry.h"
 
 #include "common/network/raw_buffer_socket.h"
+#include "common/protobuf/utility.h"
 
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
 namespace RawBuffer {
 
+Network::TransportSocketFactoryPtr RawBufferSocketFactory::createFactory(
+    const Protobuf::Message& message,
+    Server::Configuration::TransportSocketFactoryContext& context) {
+  const auto& config = MessageUtil::downcastAndValidate<
+      const envoy::config::transport_socket::raw_buffer::v2alpha::RawBuffer&>(message);
+  return std::make_unique<Network::RawBufferSocketFactory>(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_read_size_bytes,
+                                      Network::RawBufferSocket::DefaultMaxReadSize),
+      context.statsScope());
+}
+
 Network::TransportSocketFactoryPtr UpstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+    const Protobuf::Message& config,
+    Server::Configuration::TransportSocketFactoryContext& context) {
+  return createFactory(config, context);
 }
 
 Network::TransportSocketFactoryPtr DownstreamRawBufferSocketFactory::createTransportSocketFactory(
-    const Protobuf::Message&, Server::Configuration::TransportSocketFactoryContext&,
+    const Protobuf::Message& config, Server::Configuration::TransportSocketFactoryContext& context,
     const std::vector<std::string>&) {
-  return std::make_unique<Network::RawBufferSocketFactory>();
+  return createFactory(config, context);
 }
 
 ProtobufTypes::MessagePtr RawBufferSocketFactory::createEmptyConfigProto() {
-  return std::make_unique<ProtobufWkt::Empty>();
+  return std::make_unique<envoy::config::transport_socket::raw_buffer::v2alpha::RawBuffer>();
 }
 
 REGISTER_FACTORY(UpstreamRawBufferSocketFactory,
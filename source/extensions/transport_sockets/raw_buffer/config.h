@@ -18,6 +18,11 @@ public:
   virtual ~RawBufferSocketFactory() {}
   std::string name() const override { return TransportSocketNames::get().RawBuffer; }
   ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+protected:
+  static Network::TransportSocketFactoryPtr
+  createFactory(const Protobuf::Message& config,
+                Server::Configuration::TransportSocketFactoryContext& context);
 };
 
 class UpstreamRawBufferSocketFactory
@@ -26,6 +26,8 @@ public:
   Network::IoResult doWrite(Buffer::Instance& buffer, bool end_stream) override;
   void onConnected() override;
   const Ssl::Connection* ssl() const override;
+  // The tapper has to observe all bytes, so they can't be relayed around it.
+  bool passthrough() const override { return false; }
 
 private:
   SocketTapConfigSharedPtr config_;
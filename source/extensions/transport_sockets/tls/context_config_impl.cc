@@ -5,6 +5,7 @@
 
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
+#include "common/common/logger.h"
 #include "common/config/datasource.h"
 #include "common/config/tls_context_json.h"
 #include "common/protobuf/utility.h"
@@ -359,7 +360,8 @@ ServerContextConfigImpl::ServerContextConfigImpl(
         }
 
         return ret;
-      }()) {
+      }()),
+      kernel_tls_offload_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, kernel_tls_offload, false)) {
   if ((config.common_tls_context().tls_certificates().size() +
        config.common_tls_context().tls_certificate_sds_secret_configs().size()) == 0) {
     throw EnvoyException("No TLS certificates found for server context");
@@ -367,6 +369,12 @@ ServerContextConfigImpl::ServerContextConfigImpl(
              !config.common_tls_context().tls_certificate_sds_secret_configs().empty()) {
     throw EnvoyException("SDS and non-SDS TLS certificates may not be mixed in server contexts");
   }
+  if (kernel_tls_offload_ && maxProtocolVersion() > TLS1_2_VERSION) {
+    ENVOY_LOG_MISC(warn,
+                   "kernel_tls_offload only applies to TLS 1.2 connections, but "
+                   "tls_maximum_protocol_version allows TLS 1.3, which most clients will "
+                   "negotiate instead. Set tls_maximum_protocol_version to TLSv1_2 to offload.");
+  }
 }
 
 ServerContextConfigImpl::ServerContextConfigImpl(
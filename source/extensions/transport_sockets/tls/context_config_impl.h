@@ -139,6 +139,7 @@ public:
   const std::vector<SessionTicketKey>& sessionTicketKeys() const override {
     return session_ticket_keys_;
   }
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
 
 private:
   static const unsigned DEFAULT_MIN_VERSION;
@@ -148,6 +149,7 @@ private:
 
   const bool require_client_certificate_;
   const std::vector<SessionTicketKey> session_ticket_keys_;
+  const bool kernel_tls_offload_;
 
   static void validateAndAppendKey(std::vector<ServerContextConfig::SessionTicketKey>& keys,
                                    const std::string& key_data);
@@ -34,7 +34,9 @@ namespace Tls {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  COUNTER(ktls_offloaded)                                                                          \
+  COUNTER(ktls_fallback)
 // clang-format on
 
 /**
@@ -73,6 +75,12 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return true if connections should try to offload the encryption of sent data to kernel TLS
+   *         once their handshake completes.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
   // Ssl::Context
   size_t daysUntilFirstCertExpires() const override;
   Envoy::Ssl::CertificateDetailsPtr getCaCertInformation() const override;
@@ -158,6 +166,7 @@ protected:
   std::string ca_file_path_;
   std::string cert_chain_file_path_;
   TimeSource& time_source_;
+  bool kernel_tls_offload_{};
   const unsigned tls_max_version_;
 };
 
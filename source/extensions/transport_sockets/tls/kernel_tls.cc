@@ -0,0 +1,154 @@
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include <sys/socket.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#endif
+
+#include "openssl/mem.h"
+#include "openssl/nid.h"
+
+// Older C library headers lack the socket options for kernel TLS, although the kernel headers
+// define the structures that go with them.
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+#ifdef __linux__
+
+namespace {
+
+// The length of the implicit part of the AES-GCM nonce in TLS 1.2, which the key block holds as
+// the write IV. The explicit part is carried in each record.
+constexpr size_t GcmSaltLength = 4;
+
+// The TLS record content type of alerts, and the close_notify alert that ends a connection.
+constexpr uint8_t AlertRecordType = 21;
+constexpr uint8_t CloseNotifyAlert[] = {1 /* warning */, 0 /* close_notify */};
+
+template <class CryptoInfo>
+bool setTransmitKeys(int fd, uint16_t cipher_type, const uint8_t* key, const uint8_t* salt,
+                     const uint8_t* sequence) {
+  CryptoInfo crypto_info;
+  memset(&crypto_info, 0, sizeof(crypto_info));
+  crypto_info.info.version = TLS_1_2_VERSION;
+  crypto_info.info.cipher_type = cipher_type;
+  memcpy(crypto_info.key, key, sizeof(crypto_info.key));
+  memcpy(crypto_info.salt, salt, sizeof(crypto_info.salt));
+  // BoringSSL uses the record sequence number as the explicit nonce, so the kernel carries on
+  // from the same value.
+  memcpy(crypto_info.iv, sequence, sizeof(crypto_info.iv));
+  memcpy(crypto_info.rec_seq, sequence, sizeof(crypto_info.rec_seq));
+  const int rc = setsockopt(fd, SOL_TLS, TLS_TX, &crypto_info, sizeof(crypto_info));
+  OPENSSL_cleanse(&crypto_info, sizeof(crypto_info));
+  return rc == 0;
+}
+
+} // namespace
+
+bool enableTransmit(SSL* ssl, int fd) {
+  // BoringSSL only exposes the traffic keys of TLS 1.2 connections, through the key block.
+  if (SSL_version(ssl) != TLS1_2_VERSION) {
+    return false;
+  }
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  if (cipher == nullptr) {
+    return false;
+  }
+  size_t key_length;
+  switch (SSL_CIPHER_get_cipher_nid(cipher)) {
+  case NID_aes_128_gcm:
+    key_length = TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+    break;
+  case NID_aes_256_gcm:
+    key_length = TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+    break;
+  default:
+    return false;
+  }
+
+  // AEAD cipher suites have no MAC keys, so the key block holds the client and server write keys
+  // followed by the client and server write IVs.
+  const size_t key_block_length = SSL_get_key_block_len(ssl);
+  if (key_block_length != 2 * (key_length + GcmSaltLength)) {
+    return false;
+  }
+  std::vector<uint8_t> key_block(key_block_length);
+  if (!SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return false;
+  }
+  const bool is_server = SSL_is_server(ssl);
+  const uint8_t* key = key_block.data() + (is_server ? key_length : 0);
+  const uint8_t* salt = key_block.data() + 2 * key_length + (is_server ? GcmSaltLength : 0);
+
+  uint8_t sequence[8];
+  uint64_t write_sequence = SSL_get_write_sequence(ssl);
+  for (int i = sizeof(sequence) - 1; i >= 0; i--) {
+    sequence[i] = write_sequence & 0xff;
+    write_sequence >>= 8;
+  }
+
+  bool enabled = false;
+  // The ULP is attached first. If installing the keys then fails, the socket keeps sending data as
+  // is, so the connection can still fall back to user space encryption.
+  if (setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0) {
+    enabled = key_length == TLS_CIPHER_AES_GCM_128_KEY_SIZE
+                  ? setTransmitKeys<tls12_crypto_info_aes_gcm_128>(fd, TLS_CIPHER_AES_GCM_128, key,
+                                                                   salt, sequence)
+                  : setTransmitKeys<tls12_crypto_info_aes_gcm_256>(fd, TLS_CIPHER_AES_GCM_256, key,
+                                                                   salt, sequence);
+  }
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+  return enabled;
+}
+
+bool sendCloseNotify(int fd) {
+  // Records of types other than application data are sent with the record type in a control
+  // message.
+  char control[CMSG_SPACE(sizeof(AlertRecordType))];
+  memset(control, 0, sizeof(control));
+  iovec iov;
+  iov.iov_base = const_cast<uint8_t*>(CloseNotifyAlert);
+  iov.iov_len = sizeof(CloseNotifyAlert);
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(AlertRecordType));
+  *CMSG_DATA(cmsg) = AlertRecordType;
+  return sendmsg(fd, &message, MSG_NOSIGNAL) == static_cast<ssize_t>(sizeof(CloseNotifyAlert));
+}
+
+#else
+
+bool enableTransmit(SSL*, int) { return false; }
+
+bool sendCloseNotify(int) { return false; }
+
+#endif
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
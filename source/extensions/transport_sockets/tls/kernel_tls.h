@@ -0,0 +1,36 @@
+#pragma once
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+/**
+ * Hands the encryption of data sent on an established TLS connection over to the kernel TLS
+ * module of its socket. On success, plaintext written to the socket goes out as TLS records that
+ * continue the connection's write sequence, and the SSL object must no longer write to it.
+ * @param ssl the connection, which must have completed its handshake and flushed all its writes.
+ * @param fd the TCP socket that the connection runs over.
+ * @return true if the kernel took over encryption. False if the protocol version or cipher suite
+ *         is not supported, or the kernel has no TLS support, in which case the connection can
+ *         carry on encrypting in user space.
+ */
+bool enableTransmit(SSL* ssl, int fd);
+
+/**
+ * Sends a close_notify alert through kernel TLS, for a connection that enableTransmit() succeeded
+ * on. This replaces SSL_shutdown(), which would encrypt the alert with the connection's stale user
+ * space write state.
+ * @param fd the TCP socket that the connection runs over.
+ * @return true if the alert was written to the socket.
+ */
+bool sendCloseNotify(int fd);
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,7 @@
 #include "extensions/transport_sockets/tls/ssl_socket.h"
 
+#include <cstring>
+
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
@@ -7,6 +9,7 @@
 #include "common/common/hex.h"
 #include "common/http/headers.h"
 
+#include "extensions/transport_sockets/tls/kernel_tls.h"
 #include "extensions/transport_sockets/tls/utility.h"
 
 #include "absl/strings/str_replace.h"
@@ -21,6 +24,15 @@ namespace TransportSockets {
 namespace Tls {
 
 namespace {
+// The largest amount of plaintext that fits in one TLS record. Each SSL_write() of up to this many
+// bytes produces a single record.
+constexpr uint64_t MaxRecordSize = 16384;
+
+// A front slice at least this large is encrypted straight out of the buffer, even when that makes
+// the record shorter than MaxRecordSize. Smaller slices are copied together into full size records,
+// since every record carries its own header, MAC and padding.
+constexpr uint64_t MinInPlaceRecordSize = 4096;
+
 // This SslSocket will be used when SSL secret is not fetched from SDS server.
 class NotReadySslSocket : public Network::TransportSocket {
 public:
@@ -35,6 +47,7 @@ public:
   }
   void onConnected() override {}
   const Ssl::Connection* ssl() const override { return nullptr; }
+  bool passthrough() const override { return false; }
 };
 } // namespace
 
@@ -127,6 +140,9 @@ PostIoAction SslSocket::doHandshake() {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     handshake_complete_ = true;
     ctx_->logHandshake(ssl_.get());
+    if (ctx_->kernelTlsOffload()) {
+      enableKernelTls();
+    }
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -147,6 +163,20 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+void SslSocket::enableKernelTls() {
+  // The handshake has flushed its last flight, so the kernel can carry on from the current write
+  // sequence number.
+  if (KernelTls::enableTransmit(ssl_.get(), callbacks_->ioHandle().fd())) {
+    ENVOY_CONN_LOG(debug, "kernel TLS enabled for transmit", callbacks_->connection());
+    kernel_tls_tx_ = true;
+    ctx_->stats().ktls_offloaded_.inc();
+  } else {
+    ENVOY_CONN_LOG(debug, "kernel TLS unavailable: version={} cipher={}", callbacks_->connection(),
+                   SSL_get_version(ssl_.get()), SSL_get_cipher_name(ssl_.get()));
+    ctx_->stats().ktls_fallback_.inc();
+  }
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -179,30 +209,37 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
-  uint64_t bytes_to_write;
-  if (bytes_to_retry_) {
-    bytes_to_write = bytes_to_retry_;
-    bytes_to_retry_ = 0;
-  } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
   }
 
   uint64_t total_bytes_written = 0;
-  while (bytes_to_write > 0) {
+  while (write_buffer.length() > 0) {
     // TODO(mattklein123): As it relates to our fairness efforts, we might want to limit the number
     // of iterations of this loop, either by pure iterations, bytes written, etc.
 
     // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
-    // it again with the same parameters. This is done by tracking last write size, but not write
-    // data, since linearize() will return the same undrained data anyway.
+    // it again with the same parameters. The retried record is still undrained, either at the front
+    // of the buffer or in the scratch record, so only its size needs to be tracked.
+    uint64_t bytes_to_write;
+    const void* record;
+    if (bytes_to_retry_) {
+      bytes_to_write = bytes_to_retry_;
+      bytes_to_retry_ = 0;
+      record = record_in_scratch_ ? record_scratch_.get()
+                                  : prepareRecord(write_buffer, bytes_to_write);
+    } else {
+      bytes_to_write = nextRecordSize(write_buffer);
+      record = prepareRecord(write_buffer, bytes_to_write);
+    }
+
     ASSERT(bytes_to_write <= write_buffer.length());
-    int rc = SSL_write(ssl_.get(), write_buffer.linearize(bytes_to_write), bytes_to_write);
+    int rc = SSL_write(ssl_.get(), record, bytes_to_write);
     ENVOY_CONN_LOG(trace, "ssl write returns: {}", callbacks_->connection(), rc);
     if (rc > 0) {
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
     } else {
       int err = SSL_get_error(ssl_.get(), rc);
       switch (err) {
@@ -227,14 +264,73 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel frames and encrypts whatever is written to the socket, so the buffer goes out as is.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::SysCallIntResult result = write_buffer.write(callbacks_->ioHandle().fd());
+    ENVOY_CONN_LOG(trace, "kernel TLS write returns: {}", callbacks_->connection(), result.rc_);
+    if (result.rc_ == -1) {
+      ENVOY_CONN_LOG(trace, "kernel TLS write error: {} ({})", callbacks_->connection(),
+                     result.errno_, strerror(result.errno_));
+      if (result.errno_ == EAGAIN) {
+        break;
+      }
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    total_bytes_written += result.rc_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
+uint64_t SslSocket::nextRecordSize(Buffer::Instance& write_buffer) {
+  const uint64_t record_size = std::min(write_buffer.length(), MaxRecordSize);
+  Buffer::RawSlice front;
+  write_buffer.getRawSlices(&front, 1);
+  if (front.len_ >= MinInPlaceRecordSize && front.len_ < record_size) {
+    return front.len_;
+  }
+  return record_size;
+}
+
+const void* SslSocket::prepareRecord(Buffer::Instance& write_buffer, uint64_t record_size) {
+  Buffer::RawSlice front;
+  write_buffer.getRawSlices(&front, 1);
+  if (front.len_ >= record_size) {
+    record_in_scratch_ = false;
+    return front.mem_;
+  }
+
+  // The record spans several slices, so copy them into the scratch record. This replaces
+  // linearize(), which would also copy, but into a freshly allocated slice on every call.
+  if (record_scratch_ == nullptr) {
+    record_scratch_.reset(new uint8_t[MaxRecordSize]);
+  }
+  write_buffer.copyOut(0, record_size, record_scratch_.get());
+  record_in_scratch_ = true;
+  return record_scratch_.get();
+}
+
 void SslSocket::onConnected() { ASSERT(!handshake_complete_); }
 
 void SslSocket::shutdownSsl() {
   ASSERT(handshake_complete_);
   if (!shutdown_sent_ && callbacks_->connection().state() != Network::Connection::State::Closed) {
-    int rc = SSL_shutdown(ssl_.get());
-    ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
-    drainErrorQueue();
+    if (kernel_tls_tx_) {
+      // SSL_shutdown() would encrypt the alert with the user space write state, which the kernel
+      // has moved past.
+      const bool sent = KernelTls::sendCloseNotify(callbacks_->ioHandle().fd());
+      ENVOY_CONN_LOG(debug, "kernel TLS shutdown: sent={}", callbacks_->connection(), sent);
+    } else {
+      int rc = SSL_shutdown(ssl_.get());
+      ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
+      drainErrorQueue();
+    }
     shutdown_sent_ = true;
   }
 }
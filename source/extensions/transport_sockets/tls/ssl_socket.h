@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include "envoy/network/connection.h"
@@ -69,6 +70,7 @@ public:
   Network::IoResult doWrite(Buffer::Instance& write_buffer, bool end_stream) override;
   void onConnected() override;
   const Ssl::Connection* ssl() const override { return this; }
+  bool passthrough() const override { return false; }
 
   SSL* rawSslForTest() const { return ssl_.get(); }
 
@@ -76,13 +78,24 @@ private:
   Network::PostIoAction doHandshake();
   void drainErrorQueue();
   void shutdownSsl();
+  void enableKernelTls();
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
+  uint64_t nextRecordSize(Buffer::Instance& write_buffer);
+  const void* prepareRecord(Buffer::Instance& write_buffer, uint64_t record_size);
 
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImplSharedPtr ctx_;
   bssl::UniquePtr<SSL> ssl_;
   bool handshake_complete_{};
   bool shutdown_sent_{};
+  // Set once the kernel encrypts the data written to the socket, after which nothing may be
+  // written through ssl_.
+  bool kernel_tls_tx_{};
   uint64_t bytes_to_retry_{};
+  // Holds a record coalesced from slices smaller than the record. It is allocated on first use, so
+  // connections that only write large slices never pay for it.
+  std::unique_ptr<uint8_t[]> record_scratch_;
+  bool record_in_scratch_{};
   mutable std::string cached_sha_256_peer_certificate_digest_;
   mutable std::string cached_url_encoded_pem_encoded_peer_certificate_;
 };
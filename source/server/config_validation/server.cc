@@ -44,8 +44,9 @@ ValidationInstance::ValidationInstance(const Options& options, Event::TimeSystem
       api_(new Api::ValidationImpl(thread_factory, store, time_system)),
       dispatcher_(api_->allocateDispatcher()),
       singleton_manager_(new Singleton::ManagerImpl(api_->threadFactory().currentThreadId())),
-      access_log_manager_(options.fileFlushIntervalMsec(), *api_, *dispatcher_, access_log_lock,
-                          store),
+      access_log_manager_(options.fileFlushIntervalMsec(), options.fileFlushSizeKb() * 1024ULL,
+                          options.fileBufferLimitKb() * 1024ULL, *api_, *dispatcher_,
+                          access_log_lock, store),
       mutex_tracer_(nullptr), time_system_(time_system) {
   try {
     initialize(options, local_address, component_factory);
@@ -117,10 +117,11 @@ public:
   }
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr,
                                               Network::Address::SocketType,
-                                              const Network::Socket::OptionsSharedPtr&,
-                                              bool) override {
+                                              const Network::Socket::OptionsSharedPtr&, bool,
+                                              uint32_t, uint32_t& num_parent_sockets) override {
     // Returned sockets are not currently used so we can return nothing here safely vs. a
     // validation mock.
+    num_parent_sockets = 0;
     return nullptr;
   }
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType) override {
@@ -129,7 +130,7 @@ public:
   uint64_t nextListenerTag() override { return 0; }
 
   // Server::WorkerFactory
-  WorkerPtr createWorker(OverloadManager&) override {
+  WorkerPtr createWorker(uint32_t, OverloadManager&) override {
     // Returned workers are not currently used so we can return nothing here safely vs. a
     // validation mock.
     return nullptr;
@@ -14,15 +14,30 @@
 namespace Envoy {
 namespace Server {
 
-ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
-    : logger_(logger), dispatcher_(dispatcher), disable_listeners_(false) {}
+ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                                             absl::optional<uint32_t> worker_index)
+    : logger_(logger), dispatcher_(dispatcher), worker_index_(worker_index),
+      per_handler_stat_prefix_(worker_index ? fmt::format("worker_{}.", worker_index.value())
+                                            : "main_thread."),
+      disable_listeners_(false) {}
 
 void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
-  ActiveListenerPtr l(new ActiveListener(*this, config));
-  if (disable_listeners_) {
-    l->listener_->disable();
+  for (Network::Socket& socket : listenSockets(config)) {
+    ActiveListenerPtr l(new ActiveListener(*this, socket, config));
+    if (disable_listeners_) {
+      l->listener_->disable();
+    }
+    listeners_.emplace_back(config.socket().localAddress(), std::move(l));
+  }
+}
+
+std::vector<std::reference_wrapper<Network::Socket>>
+ConnectionHandlerImpl::listenSockets(Network::ListenerConfig& config) {
+  // The main thread's handler accepts on the shared socket.
+  if (!worker_index_) {
+    return {config.socket()};
   }
-  listeners_.emplace_back(config.socket().localAddress(), std::move(l));
+  return config.workerSockets(worker_index_.value());
 }
 
 void ConnectionHandlerImpl::removeListeners(uint64_t listener_tag) {
@@ -73,18 +88,21 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
 }
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
+                                                      Network::Socket& socket,
                                                       Network::ListenerConfig& config)
-    : ActiveListener(
-          parent,
-          parent.dispatcher_.createListener(config.socket(), *this, config.bindToPort(),
-                                            config.handOffRestoredDestinationConnections()),
-          config) {}
+    : ActiveListener(parent,
+                     parent.dispatcher_.createListener(
+                         socket, *this, config.bindToPort(),
+                         config.handOffRestoredDestinationConnections()),
+                     config) {}
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
                                                       Network::ListenerPtr&& listener,
                                                       Network::ListenerConfig& config)
     : parent_(parent), listener_(std::move(listener)),
       stats_(generateStats(config.listenerScope())),
+      per_handler_stats_(
+          generatePerHandlerStats(config.listenerScope(), parent.per_handler_stat_prefix_)),
       listener_filters_timeout_(config.listenerFiltersTimeout()),
       listener_tag_(config.listenerTag()), config_(config) {}
 
@@ -275,10 +293,13 @@ ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listen
   connection_->addConnectionCallbacks(*this);
   listener_.stats_.downstream_cx_total_.inc();
   listener_.stats_.downstream_cx_active_.inc();
+  listener_.per_handler_stats_.downstream_cx_total_.inc();
+  listener_.per_handler_stats_.downstream_cx_active_.inc();
 }
 
 ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
   listener_.stats_.downstream_cx_active_.dec();
+  listener_.per_handler_stats_.downstream_cx_active_.dec();
   listener_.stats_.downstream_cx_destroy_.inc();
   conn_length_->complete();
 }
@@ -287,5 +308,11 @@ ListenerStats ConnectionHandlerImpl::generateStats(Stats::Scope& scope) {
   return {ALL_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
+PerHandlerListenerStats ConnectionHandlerImpl::generatePerHandlerStats(Stats::Scope& scope,
+                                                                       const std::string& prefix) {
+  return {ALL_PER_HANDLER_LISTENER_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                         POOL_GAUGE_PREFIX(scope, prefix))};
+}
+
 } // namespace Server
 } // namespace Envoy
@@ -2,8 +2,10 @@
 
 #include <atomic>
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <memory>
+#include <vector>
 
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
@@ -19,6 +21,7 @@
 #include "common/common/linked_object.h"
 #include "common/common/non_copyable.h"
 
+#include "absl/types/optional.h"
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -42,13 +45,34 @@ struct ListenerStats {
   ALL_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
+// clang-format off
+#define ALL_PER_HANDLER_LISTENER_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(downstream_cx_total)                                                                     \
+  GAUGE  (downstream_cx_active)
+// clang-format on
+
+/**
+ * Wrapper struct for the stats of a listener on a single connection handler. @see stats_macros.h
+ */
+struct PerHandlerListenerStats {
+  ALL_PER_HANDLER_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * Server side connection handler. This is used both by workers as well as the
  * main thread for non-threaded listeners.
  */
 class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
 public:
-  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  /**
+   * @param logger supplies the logger to log connection events to.
+   * @param dispatcher supplies the dispatcher the handler's listeners and connections run on.
+   * @param worker_index supplies the index of the worker owning the handler, which selects the
+   *        listen sockets it accepts on and names its per handler listener stats, or absl::nullopt
+   *        for the main thread's handler.
+   */
+  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                        absl::optional<uint32_t> worker_index);
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
@@ -64,6 +88,8 @@ public:
 private:
   struct ActiveListener;
   ActiveListener* findActiveListenerByAddress(const Network::Address::Instance& address);
+  std::vector<std::reference_wrapper<Network::Socket>>
+  listenSockets(Network::ListenerConfig& config);
 
   struct ActiveConnection;
   typedef std::unique_ptr<ActiveConnection> ActiveConnectionPtr;
@@ -71,10 +97,12 @@ private:
   typedef std::unique_ptr<ActiveSocket> ActiveSocketPtr;
 
   /**
-   * Wrapper for an active listener owned by this handler.
+   * Wrapper for an active listener owned by this handler. A listener config the handler accepts
+   * on more than one socket for has an active listener per socket.
    */
   struct ActiveListener : public Network::ListenerCallbacks {
-    ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
+    ActiveListener(ConnectionHandlerImpl& parent, Network::Socket& socket,
+                   Network::ListenerConfig& config);
 
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerPtr&& listener,
                    Network::ListenerConfig& config);
@@ -100,6 +128,7 @@ private:
     ConnectionHandlerImpl& parent_;
     Network::ListenerPtr listener_;
     ListenerStats stats_;
+    PerHandlerListenerStats per_handler_stats_;
     std::list<ActiveSocketPtr> sockets_;
     std::list<ActiveConnectionPtr> connections_;
     const std::chrono::milliseconds listener_filters_timeout_;
@@ -177,9 +206,13 @@ private:
   };
 
   static ListenerStats generateStats(Stats::Scope& scope);
+  static PerHandlerListenerStats generatePerHandlerStats(Stats::Scope& scope,
+                                                         const std::string& prefix);
 
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
+  const absl::optional<uint32_t> worker_index_;
+  const std::string per_handler_stat_prefix_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
   std::atomic<uint64_t> num_connections_{};
   bool disable_listeners_;
@@ -6,8 +6,10 @@
 #include <sys/un.h>
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/file_event.h"
@@ -29,7 +31,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 10;
+const uint64_t SharedMemory::VERSION = 12;
 
 static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
   BlockMemoryHashSetOptions hash_set_options;
@@ -136,8 +138,8 @@ HotRestartImpl::HotRestartImpl(const Options& options)
         std::make_unique<Stats::RawStatDataSet>(stats_set_options_, options.restartEpoch() == 0,
                                                 shmem_.stats_set_data_, options_.statsOptions());
   }
-  stats_allocator_ = std::make_unique<Stats::RawStatDataAllocator>(stat_lock_, *stats_set_,
-                                                                   options_.statsOptions());
+  stats_allocator_ = std::make_unique<Stats::RawStatDataAllocator>(
+      stat_lock_, *stats_set_, options_.statsOptions(), symbol_table_);
   my_domain_socket_ = bindDomainSocket(options.restartEpoch());
   child_address_ = createDomainSocketAddress((options.restartEpoch() + 1));
   initDomainSocketAddress(&parent_address_);
@@ -199,7 +201,9 @@ void HotRestartImpl::drainParentListeners() {
   shmem_.flags_ &= ~SharedMemory::Flags::INITIALIZING;
 }
 
-int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
+int HotRestartImpl::duplicateParentListenSocket(const std::string& address,
+                                                uint32_t socket_index, uint32_t& num_sockets) {
+  num_sockets = 0;
   if (options_.restartEpoch() == 0 || parent_terminated_) {
     return -1;
   }
@@ -207,9 +211,11 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   RpcGetListenSocketRequest rpc;
   ASSERT(address.length() < sizeof(rpc.address_));
   StringUtil::strlcpy(rpc.address_, address.c_str(), sizeof(rpc.address_));
+  rpc.socket_index_ = socket_index;
   sendMessage(parent_address_, rpc);
   RpcGetListenSocketReply* reply =
       receiveTypedRpc<RpcGetListenSocketReply, RpcMessageType::GetListenSocketReply>();
+  num_sockets = reply->num_sockets_;
   return reply->fd_;
 }
 
@@ -337,7 +343,12 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
       Network::Utility::resolveUrl(std::string(rpc.address_));
   for (const auto& listener : server_->listenerManager().listeners()) {
     if (*listener.get().socket().localAddress() == *addr) {
-      reply.fd_ = listener.get().socket().ioHandle().fd();
+      const std::vector<std::reference_wrapper<Network::Socket>> sockets =
+          listener.get().listenSockets();
+      reply.num_sockets_ = sockets.size();
+      if (rpc.socket_index_ < sockets.size()) {
+        reply.fd_ = sockets[rpc.socket_index_].get().ioHandle().fd();
+      }
       break;
     }
   }
@@ -15,6 +15,7 @@
 
 #include "common/common/assert.h"
 #include "common/stats/raw_stat_data.h"
+#include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
 namespace Server {
@@ -118,7 +119,8 @@ public:
 
   // Server::HotRestart
   void drainParentListeners() override;
-  int duplicateParentListenSocket(const std::string& address) override;
+  int duplicateParentListenSocket(const std::string& address, uint32_t socket_index,
+                                  uint32_t& num_sockets) override;
   void getParentStats(GetParentStatsInfo& info) override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
   void shutdownParentAdmin(ShutdownParentAdminInfo& info) override;
@@ -162,6 +164,7 @@ private:
                       : RpcBase(RpcMessageType::GetListenSocketRequest, sizeof(*this)) {}
 
                   char address_[256]{0};
+                  uint32_t socket_index_{0};
                 });
 
   PACKED_STRUCT(struct RpcGetListenSocketReply
@@ -170,6 +173,8 @@ private:
                       : RpcBase(RpcMessageType::GetListenSocketReply, sizeof(*this)) {}
 
                   int fd_{0};
+                  // The number of sockets the listener has, so that the child can adopt them all.
+                  uint32_t num_sockets_{0};
                 });
 
   PACKED_STRUCT(struct RpcShutdownAdminReply
@@ -210,6 +215,7 @@ private:
   BlockMemoryHashSetOptions stats_set_options_;
   SharedMemory& shmem_;
   std::unique_ptr<Stats::RawStatDataSet> stats_set_ GUARDED_BY(stat_lock_);
+  Stats::SymbolTableImpl symbol_table_;
   std::unique_ptr<Stats::RawStatDataAllocator> stats_allocator_;
   ProcessSharedMutex log_lock_;
   ProcessSharedMutex access_log_lock_;
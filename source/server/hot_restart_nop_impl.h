@@ -6,6 +6,7 @@
 
 #include "common/common/thread.h"
 #include "common/stats/heap_stat_data.h"
+#include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
 namespace Server {
@@ -15,11 +16,14 @@ namespace Server {
  */
 class HotRestartNopImpl : public Server::HotRestart {
 public:
-  HotRestartNopImpl() {}
+  HotRestartNopImpl() : stats_allocator_(symbol_table_) {}
 
   // Server::HotRestart
   void drainParentListeners() override {}
-  int duplicateParentListenSocket(const std::string&) override { return -1; }
+  int duplicateParentListenSocket(const std::string&, uint32_t, uint32_t& num_sockets) override {
+    num_sockets = 0;
+    return -1;
+  }
   void getParentStats(GetParentStatsInfo& info) override { memset(&info, 0, sizeof(info)); }
   void initialize(Event::Dispatcher&, Server::Instance&) override {}
   void shutdownParentAdmin(ShutdownParentAdminInfo&) override {}
@@ -33,6 +37,7 @@ public:
 private:
   Thread::MutexBasicLockable log_lock_;
   Thread::MutexBasicLockable access_log_lock_;
+  Stats::SymbolTableImpl symbol_table_;
   Stats::HeapStatDataAllocator stats_allocator_;
 };
 
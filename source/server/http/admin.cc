@@ -29,6 +29,7 @@
 #include "common/access_log/access_log_formatter.h"
 #include "common/access_log/access_log_impl.h"
 #include "common/buffer/buffer_impl.h"
+#include "common/buffer/slab_pool.h"
 #include "common/common/assert.h"
 #include "common/common/empty_string.h"
 #include "common/common/enum_to_int.h"
@@ -571,6 +572,10 @@ Http::Code AdminImpl::handlerMemory(absl::string_view, Http::HeaderMap& response
   memory.set_total_thread_cache(Memory::Stats::totalThreadCacheBytes());
   memory.set_pageheap_unmapped(Memory::Stats::totalPageHeapUnmapped());
   memory.set_pageheap_free(Memory::Stats::totalPageHeapFree());
+  memory.set_buffer_slab_pool_hits(Buffer::SlabPool::totalHits());
+  memory.set_buffer_slab_pool_misses(Buffer::SlabPool::totalMisses());
+  memory.set_buffer_slab_pool_resident_bytes(Buffer::SlabPool::totalResidentBytes());
+  memory.set_buffer_slab_pool_cached_bytes(Buffer::SlabPool::totalCachedBytes());
   response.add(MessageUtil::getJsonStringFromMessage(memory, true, true)); // pretty-print
   return Http::Code::OK;
 }
@@ -625,15 +630,23 @@ Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& respo
       (params.find("filter") != params.end())
           ? absl::optional<std::regex>{std::regex(params.at("filter"))}
           : absl::nullopt;
+  const std::string prefix = statsPrefix(params);
+
+  if (!has_format && params.find("chunked") != params.end()) {
+    std::make_shared<StatsStreamer>(server_.stats(), StatsStreamer::Format::Text, prefix,
+                                    used_only, regex)
+        ->start(admin_stream);
+    return rc;
+  }
 
   std::map<std::string, uint64_t> all_stats;
-  for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
+  for (const Stats::CounterSharedPtr& counter : server_.stats().countersWithPrefix(prefix)) {
     if (shouldShowMetric(counter, used_only, regex)) {
       all_stats.emplace(counter->name(), counter->value());
     }
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
+  for (const Stats::GaugeSharedPtr& gauge : server_.stats().gaugesWithPrefix(prefix)) {
     if (shouldShowMetric(gauge, used_only, regex)) {
       all_stats.emplace(gauge->name(), gauge->value());
     }
@@ -644,8 +657,8 @@ Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& respo
     if (format_value == "json") {
       response_headers.insertContentType().value().setReference(
           Http::Headers::get().ContentTypeValues.Json);
-      response.add(
-          AdminImpl::statsAsJson(all_stats, server_.stats().histograms(), used_only, regex));
+      response.add(AdminImpl::statsAsJson(
+          all_stats, server_.stats().histogramsWithPrefix(prefix), used_only, regex));
     } else if (format_value == "prometheus") {
       return handlerPrometheusStats(url, response_headers, response, admin_stream);
     } else {
@@ -661,7 +674,8 @@ Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& respo
     // multimap here. This makes sure that duplicate histograms get output. When shared storage is
     // implemented this can be switched back to a normal map.
     std::multimap<std::string, std::string> all_histograms;
-    for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
+    for (const Stats::ParentHistogramSharedPtr& histogram :
+         server_.stats().histogramsWithPrefix(prefix)) {
       if (shouldShowMetric(histogram, used_only, regex)) {
         all_histograms.emplace(histogram->name(), histogram->quantileSummary());
       }
@@ -674,14 +688,28 @@ Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& respo
 }
 
 Http::Code AdminImpl::handlerPrometheusStats(absl::string_view path_and_query, Http::HeaderMap&,
-                                             Buffer::Instance& response, AdminStream&) {
+                                             Buffer::Instance& response,
+                                             AdminStream& admin_stream) {
   const Http::Utility::QueryParams params = Http::Utility::parseQueryString(path_and_query);
   const bool used_only = params.find("usedonly") != params.end();
-  PrometheusStatsFormatter::statsAsPrometheus(server_.stats().counters(), server_.stats().gauges(),
-                                              server_.stats().histograms(), response, used_only);
+  const std::string prefix = statsPrefix(params);
+  if (params.find("chunked") != params.end()) {
+    std::make_shared<StatsStreamer>(server_.stats(), StatsStreamer::Format::Prometheus, prefix,
+                                    used_only, absl::nullopt)
+        ->start(admin_stream);
+    return Http::Code::OK;
+  }
+  PrometheusStatsFormatter::statsAsPrometheus(
+      server_.stats().countersWithPrefix(prefix), server_.stats().gaugesWithPrefix(prefix),
+      server_.stats().histogramsWithPrefix(prefix), response, used_only);
   return Http::Code::OK;
 }
 
+std::string AdminImpl::statsPrefix(const Http::Utility::QueryParams& params) {
+  const auto prefix = params.find("prefix");
+  return prefix != params.end() ? prefix->second : EMPTY_STRING;
+}
+
 std::string PrometheusStatsFormatter::sanitizeName(const std::string& name) {
   // The name must match the regex [a-zA-Z_][a-zA-Z0-9_]* as required by
   // prometheus. Refer to https://prometheus.io/docs/concepts/data_model/.
@@ -708,6 +736,61 @@ std::string PrometheusStatsFormatter::metricName(const std::string& extractedNam
   return sanitizeName(fmt::format("envoy_{0}", extractedName));
 }
 
+void PrometheusStatsFormatter::counterAsPrometheus(
+    const Stats::Counter& counter, std::unordered_set<std::string>& metric_type_tracker,
+    Buffer::Instance& response) {
+  const std::string tags = formattedTags(counter.tags());
+  const std::string metric_name = metricName(counter.tagExtractedName());
+  if (metric_type_tracker.insert(metric_name).second) {
+    response.add(fmt::format("# TYPE {0} counter\n", metric_name));
+  }
+  response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, counter.value()));
+}
+
+void PrometheusStatsFormatter::gaugeAsPrometheus(
+    const Stats::Gauge& gauge, std::unordered_set<std::string>& metric_type_tracker,
+    Buffer::Instance& response) {
+  const std::string tags = formattedTags(gauge.tags());
+  const std::string metric_name = metricName(gauge.tagExtractedName());
+  if (metric_type_tracker.insert(metric_name).second) {
+    response.add(fmt::format("# TYPE {0} gauge\n", metric_name));
+  }
+  response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, gauge.value()));
+}
+
+void PrometheusStatsFormatter::histogramAsPrometheus(
+    const Stats::ParentHistogram& histogram, std::unordered_set<std::string>& metric_type_tracker,
+    Buffer::Instance& response) {
+  const std::vector<Stats::Tag> histogram_tags = histogram.tags();
+  const std::string tags = formattedTags(histogram_tags);
+  const std::string hist_tags = histogram_tags.empty() ? EMPTY_STRING : (tags + ",");
+
+  const std::string metric_name = metricName(histogram.tagExtractedName());
+  if (metric_type_tracker.insert(metric_name).second) {
+    response.add(fmt::format("# TYPE {0} histogram\n", metric_name));
+  }
+
+  const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
+  const std::vector<double>& supported_buckets = stats.supportedBuckets();
+  const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
+  for (size_t i = 0; i < supported_buckets.size(); ++i) {
+    double bucket = supported_buckets[i];
+    uint64_t value = computed_buckets[i];
+    // We want to print the bucket in a fixed point (non-scientific) format. The fmt library
+    // doesn't have a specific modifier to format as a fixed-point value only so we use the
+    // 'g' operator which prints the number in general fixed point format or scientific format
+    // with precision 50 to round the number up to 32 significant digits in fixed point format
+    // which should cover pretty much all cases
+    response.add(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", metric_name, hist_tags,
+                             bucket, value));
+  }
+
+  response.add(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", metric_name, hist_tags,
+                           stats.sampleCount()));
+  response.add(fmt::format("{0}_sum{{{1}}} {2}\n", metric_name, tags, stats.sampleSum()));
+  response.add(fmt::format("{0}_count{{{1}}} {2}\n", metric_name, tags, stats.sampleCount()));
+}
+
 uint64_t PrometheusStatsFormatter::statsAsPrometheus(
     const std::vector<Stats::CounterSharedPtr>& counters,
     const std::vector<Stats::GaugeSharedPtr>& gauges,
@@ -715,69 +798,162 @@ uint64_t PrometheusStatsFormatter::statsAsPrometheus(
     const bool used_only) {
   std::unordered_set<std::string> metric_type_tracker;
   for (const auto& counter : counters) {
-    if (!shouldShowMetric(counter, used_only)) {
-      continue;
-    }
-
-    const std::string tags = formattedTags(counter->tags());
-    const std::string metric_name = metricName(counter->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} counter\n", metric_name));
+    if (shouldShowMetric(counter, used_only)) {
+      counterAsPrometheus(*counter, metric_type_tracker, response);
     }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, counter->value()));
   }
 
   for (const auto& gauge : gauges) {
-    if (!shouldShowMetric(gauge, used_only)) {
-      continue;
+    if (shouldShowMetric(gauge, used_only)) {
+      gaugeAsPrometheus(*gauge, metric_type_tracker, response);
     }
-
-    const std::string tags = formattedTags(gauge->tags());
-    const std::string metric_name = metricName(gauge->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} gauge\n", metric_name));
-    }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, gauge->value()));
   }
 
   for (const auto& histogram : histograms) {
-    if (!shouldShowMetric(histogram, used_only)) {
-      continue;
+    if (shouldShowMetric(histogram, used_only)) {
+      histogramAsPrometheus(*histogram, metric_type_tracker, response);
     }
+  }
 
-    const std::string tags = formattedTags(histogram->tags());
-    const std::string hist_tags = histogram->tags().empty() ? EMPTY_STRING : (tags + ",");
+  return metric_type_tracker.size();
+}
 
-    const std::string metric_name = metricName(histogram->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} histogram\n", metric_name));
+StatsStreamer::StatsStreamer(const Stats::Store& store, Format format, absl::string_view prefix,
+                             bool used_only, const absl::optional<std::regex>& regex,
+                             uint64_t chunk_size)
+    : store_(store), format_(format), prefix_(prefix), used_only_(used_only), regex_(regex),
+      chunk_size_(chunk_size) {}
+
+void StatsStreamer::start(AdminStream& admin_stream) {
+  admin_stream.setEndStreamOnComplete(false);
+  callbacks_ = &admin_stream.getDecoderFilterCallbacks();
+  // The filter callbacks are only valid until the stream is destroyed, which may happen before
+  // all chunks have been written if the client goes away.
+  std::shared_ptr<StatsStreamer> self = shared_from_this();
+  admin_stream.addOnDestroyCallback([self]() -> void {
+    self->callbacks_->removeDownstreamWatermarkCallbacks(*self);
+    self->callbacks_ = nullptr;
+  });
+  callbacks_->addDownstreamWatermarkCallbacks(*this);
+  scheduleNextChunk();
+}
+
+void StatsStreamer::onAboveWriteBufferHighWatermark() { ++high_watermark_count_; }
+
+void StatsStreamer::onBelowWriteBufferLowWatermark() {
+  ASSERT(high_watermark_count_ > 0);
+  --high_watermark_count_;
+  if (phase_ != Phase::Done) {
+    scheduleNextChunk();
+  }
+}
+
+bool StatsStreamer::shouldShowMetric(const Stats::Metric& metric) const {
+  return (!used_only_ || metric.used()) &&
+         (!regex_.has_value() || std::regex_search(metric.name(), regex_.value()));
+}
+
+void StatsStreamer::advance() {
+  // Moves on until there is a stat left to write, snapshotting each kind of stat only when it is
+  // reached and releasing the previous snapshot.
+  while (true) {
+    switch (phase_) {
+    case Phase::Start:
+      counters_ = store_.countersWithPrefix(prefix_);
+      next_stat_ = 0;
+      phase_ = Phase::Counters;
+      break;
+    case Phase::Counters:
+      if (next_stat_ < counters_.size()) {
+        return;
+      }
+      counters_.clear();
+      counters_.shrink_to_fit();
+      gauges_ = store_.gaugesWithPrefix(prefix_);
+      next_stat_ = 0;
+      phase_ = Phase::Gauges;
+      break;
+    case Phase::Gauges:
+      if (next_stat_ < gauges_.size()) {
+        return;
+      }
+      gauges_.clear();
+      gauges_.shrink_to_fit();
+      histograms_ = store_.histogramsWithPrefix(prefix_);
+      next_stat_ = 0;
+      phase_ = Phase::Histograms;
+      break;
+    case Phase::Histograms:
+      if (next_stat_ < histograms_.size()) {
+        return;
+      }
+      histograms_.clear();
+      histograms_.shrink_to_fit();
+      phase_ = Phase::Done;
+      return;
+    case Phase::Done:
+      return;
     }
+  }
+}
+
+void StatsStreamer::nextChunk() {
+  chunk_scheduled_ = false;
+  if (callbacks_ == nullptr) {
+    return;
+  }
 
-    const Stats::HistogramStatistics& stats = histogram->cumulativeStatistics();
-    const std::vector<double>& supported_buckets = stats.supportedBuckets();
-    const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
-    for (size_t i = 0; i < supported_buckets.size(); ++i) {
-      double bucket = supported_buckets[i];
-      uint64_t value = computed_buckets[i];
-      // We want to print the bucket in a fixed point (non-scientific) format. The fmt library
-      // doesn't have a specific modifier to format as a fixed-point value only so we use the
-      // 'g' operator which prints the number in general fixed point format or scientific format
-      // with precision 50 to round the number up to 32 significant digits in fixed point format
-      // which should cover pretty much all cases
-      response.add(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", metric_name, hist_tags,
-                               bucket, value));
+  Buffer::OwnedImpl chunk;
+  advance();
+  while (phase_ != Phase::Done && chunk.length() < chunk_size_) {
+    // Each stat is released from the snapshot as soon as it is written.
+    if (phase_ == Phase::Counters) {
+      const Stats::CounterSharedPtr counter = std::move(counters_[next_stat_++]);
+      if (shouldShowMetric(*counter)) {
+        if (format_ == Format::Prometheus) {
+          PrometheusStatsFormatter::counterAsPrometheus(*counter, metric_type_tracker_, chunk);
+        } else {
+          chunk.add(fmt::format("{}: {}\n", counter->name(), counter->value()));
+        }
+      }
+    } else if (phase_ == Phase::Gauges) {
+      const Stats::GaugeSharedPtr gauge = std::move(gauges_[next_stat_++]);
+      if (shouldShowMetric(*gauge)) {
+        if (format_ == Format::Prometheus) {
+          PrometheusStatsFormatter::gaugeAsPrometheus(*gauge, metric_type_tracker_, chunk);
+        } else {
+          chunk.add(fmt::format("{}: {}\n", gauge->name(), gauge->value()));
+        }
+      }
+    } else {
+      const Stats::ParentHistogramSharedPtr histogram = std::move(histograms_[next_stat_++]);
+      if (shouldShowMetric(*histogram)) {
+        if (format_ == Format::Prometheus) {
+          PrometheusStatsFormatter::histogramAsPrometheus(*histogram, metric_type_tracker_, chunk);
+        } else {
+          chunk.add(fmt::format("{}: {}\n", histogram->name(), histogram->quantileSummary()));
+        }
+      }
     }
+    advance();
+  }
 
-    response.add(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", metric_name, hist_tags,
-                             stats.sampleCount()));
-    response.add(fmt::format("{0}_sum{{{1}}} {2}\n", metric_name, tags, stats.sampleSum()));
-    response.add(fmt::format("{0}_count{{{1}}} {2}\n", metric_name, tags, stats.sampleCount()));
+  const bool end_stream = phase_ == Phase::Done;
+  callbacks_->encodeData(chunk, end_stream);
+  if (!end_stream) {
+    scheduleNextChunk();
   }
+}
 
-  return metric_type_tracker.size();
+void StatsStreamer::scheduleNextChunk() {
+  // While the downstream is backed up, the next chunk waits for onBelowWriteBufferLowWatermark()
+  // rather than growing the downstream buffers.
+  if (callbacks_ == nullptr || chunk_scheduled_ || high_watermark_count_ > 0) {
+    return;
+  }
+  chunk_scheduled_ = true;
+  std::shared_ptr<StatsStreamer> self = shared_from_this();
+  callbacks_->dispatcher().post([self]() -> void { self->nextChunk(); });
 }
 
 std::string
@@ -2,8 +2,11 @@
 
 #include <chrono>
 #include <list>
+#include <memory>
+#include <regex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -16,6 +19,7 @@
 #include "envoy/server/instance.h"
 #include "envoy/server/listener_manager.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/store.h"
 #include "envoy/upstream/outlier_detection.h"
 #include "envoy/upstream/resource_manager.h"
 
@@ -188,6 +192,7 @@ private:
                                  bool used_only,
                                  const absl::optional<std::regex> regex = absl::nullopt,
                                  bool pretty_print = false);
+  static std::string statsPrefix(const Http::Utility::QueryParams& params);
   static std::string
   runtimeAsJson(const std::vector<std::pair<std::string, Runtime::Snapshot::Entry>>& entries);
   std::vector<const UrlHandler*> sortedHandlers() const;
@@ -258,6 +263,12 @@ private:
     Network::FilterChainFactory& filterChainFactory() override { return parent_; }
     Network::Socket& socket() override { return parent_.mutable_socket(); }
     const Network::Socket& socket() const override { return parent_.mutable_socket(); }
+    std::vector<std::reference_wrapper<Network::Socket>> listenSockets() override {
+      return {parent_.mutable_socket()};
+    }
+    std::vector<std::reference_wrapper<Network::Socket>> workerSockets(uint32_t) override {
+      return {parent_.mutable_socket()};
+    }
     bool bindToPort() override { return true; }
     bool handOffRestoredDestinationConnections() const override { return false; }
     uint32_t perConnectionBufferLimitBytes() const override { return 0; }
@@ -375,6 +386,20 @@ public:
                                     const std::vector<Stats::GaugeSharedPtr>& gauges,
                                     const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
                                     Buffer::Instance& response, const bool used_only);
+  /**
+   * Append a single counter, gauge or histogram to the response, preceded by a "# TYPE" line if
+   * its metric name is not yet in metric_type_tracker. This lets callers render stats a few at a
+   * time.
+   */
+  static void counterAsPrometheus(const Stats::Counter& counter,
+                                  std::unordered_set<std::string>& metric_type_tracker,
+                                  Buffer::Instance& response);
+  static void gaugeAsPrometheus(const Stats::Gauge& gauge,
+                                std::unordered_set<std::string>& metric_type_tracker,
+                                Buffer::Instance& response);
+  static void histogramAsPrometheus(const Stats::ParentHistogram& histogram,
+                                    std::unordered_set<std::string>& metric_type_tracker,
+                                    Buffer::Instance& response);
   /**
    * Format the given tags, returning a string as a comma-separated list
    * of <tag_name>="<tag_value>" pairs.
@@ -400,5 +425,58 @@ private:
   }
 };
 
+/**
+ * Streams the stats of a store as the body of an admin response, writing a bounded chunk per
+ * dispatcher iteration so that rendering a very large store neither stalls the main thread nor
+ * buffers the whole response. No chunk is written while the downstream is above its high
+ * watermark. Stats are written in store order rather than sorted by name. Each kind of stat is
+ * snapshotted only once the previous kind has been written.
+ */
+class StatsStreamer : public Http::DownstreamWatermarkCallbacks,
+                      public std::enable_shared_from_this<StatsStreamer> {
+public:
+  enum class Format { Text, Prometheus };
+
+  static const uint64_t DefaultChunkSize = 64 * 1024;
+
+  StatsStreamer(const Stats::Store& store, Format format, absl::string_view prefix, bool used_only,
+                const absl::optional<std::regex>& regex, uint64_t chunk_size = DefaultChunkSize);
+
+  /**
+   * Turn the response of admin_stream into a streaming one and schedule the first chunk. The
+   * response ends after the last chunk, or streaming stops if the stream is destroyed first.
+   */
+  void start(AdminStream& admin_stream);
+
+  // Http::DownstreamWatermarkCallbacks
+  void onAboveWriteBufferHighWatermark() override;
+  void onBelowWriteBufferLowWatermark() override;
+
+private:
+  enum class Phase { Start, Counters, Gauges, Histograms, Done };
+
+  bool shouldShowMetric(const Stats::Metric& metric) const;
+  void advance();
+  void nextChunk();
+  void scheduleNextChunk();
+
+  const Stats::Store& store_;
+  const Format format_;
+  const std::string prefix_;
+  const bool used_only_;
+  const absl::optional<std::regex> regex_;
+  const uint64_t chunk_size_;
+  Phase phase_{Phase::Start};
+  // Only the snapshot of the current phase is non-empty.
+  std::vector<Stats::CounterSharedPtr> counters_;
+  std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+  size_t next_stat_{};
+  std::unordered_set<std::string> metric_type_tracker_;
+  Http::StreamDecoderFilterCallbacks* callbacks_{};
+  uint32_t high_watermark_count_{};
+  bool chunk_scheduled_{};
+};
+
 } // namespace Server
 } // namespace Envoy
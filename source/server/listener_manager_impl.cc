@@ -100,14 +100,15 @@ ProdListenerComponentFactory::createListenerFilterFactoryList_(
 
 Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
     Network::Address::InstanceConstSharedPtr address, Network::Address::SocketType socket_type,
-    const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) {
+    const Network::Socket::OptionsSharedPtr& options, bool bind_to_port, uint32_t socket_index,
+    uint32_t& num_parent_sockets) {
   ASSERT(address->type() == Network::Address::Type::Ip ||
          address->type() == Network::Address::Type::Pipe);
   ASSERT(socket_type == Network::Address::SocketType::Stream ||
          socket_type == Network::Address::SocketType::Datagram);
 
-  // For each listener config we share a single socket among all threaded listeners.
-  // First we try to get the socket from our parent if applicable.
+  // Unless the listener binds a socket per worker, we share a single socket among all threaded
+  // listeners. First we try to get the socket from our parent if applicable.
   if (address->type() == Network::Address::Type::Pipe) {
     if (socket_type != Network::Address::SocketType::Stream) {
       // This could be implemented in the future, since Unix domain sockets
@@ -117,7 +118,8 @@ Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
           fmt::format("socket type {} not supported for pipes", toString(socket_type)));
     }
     const std::string addr = fmt::format("unix://{}", address->asString());
-    const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+    const int fd =
+        server_.hotRestart().duplicateParentListenSocket(addr, socket_index, num_parent_sockets);
     Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>(fd);
     if (io_handle->isOpen()) {
       ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
@@ -130,7 +132,8 @@ Network::SocketSharedPtr ProdListenerComponentFactory::createListenSocket(
                                  ? Network::Utility::TCP_SCHEME
                                  : Network::Utility::UDP_SCHEME;
   const std::string addr = absl::StrCat(scheme, address->asString());
-  const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+  const int fd =
+      server_.hotRestart().duplicateParentListenSocket(addr, socket_index, num_parent_sockets);
   if (fd != -1) {
     ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
     Network::IoHandlePtr io_handle = std::make_unique<Network::IoSocketHandleImpl>(fd);
@@ -161,6 +164,7 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
       listener_scope_(
           parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      reuse_port_(bind_to_port_ && PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, reuse_port, false)),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
@@ -183,6 +187,15 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
         config.tcp_fast_open_queue_length().value()));
   }
 
+  if (reuse_port_) {
+    if (address_->type() == Network::Address::Type::Pipe) {
+      throw EnvoyException(
+          fmt::format("error adding listener '{}': reuse_port is not supported for pipes",
+                      address_->asString()));
+    }
+    addListenSocketOptions(Network::SocketOptionFactory::buildReusePortOptions());
+  }
+
   if (config.socket_options().size() > 0) {
     addListenSocketOptions(
         Network::SocketOptionFactory::buildLiteralOptions(config.socket_options()));
@@ -648,26 +661,53 @@ Init::Manager& ListenerImpl::initManager() {
   }
 }
 
-void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
-  ASSERT(!socket_);
-  socket_ = socket;
-  // Server config validation sets nullptr sockets.
-  if (socket_ && listen_socket_options_) {
-    // 'pre_bind = false' as bind() is never done after this.
-    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket_,
-                                            envoy::api::v2::core::SocketOption::STATE_BOUND);
-    const std::string message =
-        fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
-    if (!ok) {
-      ENVOY_LOG(warn, "{}", message);
-      throw EnvoyException(message);
-    } else {
-      ENVOY_LOG(debug, "{}", message);
-    }
+std::vector<std::reference_wrapper<Network::Socket>> ListenerImpl::listenSockets() {
+  std::vector<std::reference_wrapper<Network::Socket>> sockets;
+  for (const Network::SocketSharedPtr& socket : sockets_) {
+    sockets.push_back(*socket);
+  }
+  return sockets;
+}
 
-    // Add the options to the socket_ so that STATE_LISTENING options can be
-    // set in the worker after listen()/evconnlistener_new() is called.
-    socket_->addOptions(listen_socket_options_);
+std::vector<std::reference_wrapper<Network::Socket>>
+ListenerImpl::workerSockets(uint32_t worker_index) {
+  // Normally there is either a single socket shared by all workers or one socket per worker. A
+  // listener that adopted the sockets of a hot restart parent with a different number of workers
+  // deals them out round robin, so that every socket is accepted on and every worker accepts.
+  if (worker_index >= sockets_.size()) {
+    return {*sockets_[worker_index % sockets_.size()]};
+  }
+  const uint32_t num_workers = std::max(parent_.server_.options().concurrency(), 1U);
+  std::vector<std::reference_wrapper<Network::Socket>> sockets;
+  for (uint32_t i = worker_index; i < sockets_.size(); i += num_workers) {
+    sockets.push_back(*sockets_[i]);
+  }
+  return sockets;
+}
+
+void ListenerImpl::setSockets(const std::vector<Network::SocketSharedPtr>& sockets) {
+  ASSERT(sockets_.empty());
+  ASSERT(!sockets.empty());
+  sockets_ = sockets;
+  for (const Network::SocketSharedPtr& socket : sockets_) {
+    // Server config validation sets nullptr sockets.
+    if (socket && listen_socket_options_) {
+      // 'pre_bind = false' as bind() is never done after this.
+      bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket,
+                                              envoy::api::v2::core::SocketOption::STATE_BOUND);
+      const std::string message =
+          fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
+      if (!ok) {
+        ENVOY_LOG(warn, "{}", message);
+        throw EnvoyException(message);
+      } else {
+        ENVOY_LOG(debug, "{}", message);
+      }
+
+      // Add the options to the socket so that STATE_LISTENING options can be
+      // set in the worker after listen()/evconnlistener_new() is called.
+      socket->addOptions(listen_socket_options_);
+    }
   }
 }
 
@@ -678,7 +718,7 @@ ListenerManagerImpl::ListenerManagerImpl(Instance& server,
       config_tracker_entry_(server.admin().getConfigTracker().add(
           "listeners", [this] { return dumpListenerConfigs(); })) {
   for (uint32_t i = 0; i < server.options().concurrency(); i++) {
-    workers_.emplace_back(worker_factory.createWorker(server.overloadManager()));
+    workers_.emplace_back(worker_factory.createWorker(i, server.overloadManager()));
   }
 }
 
@@ -768,17 +808,29 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     throw EnvoyException(message);
   }
 
+  // Likewise the set of sockets is kept across updates, so whether there is a socket per worker
+  // can not change.
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->reusePort() != new_listener->reusePort()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->reusePort() != new_listener->reusePort())) {
+    const std::string message = fmt::format(
+        "error updating listener: '{}' has a different reuse_port from existing listener", name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+
   bool added = false;
   if (existing_warming_listener != warming_listeners_.end()) {
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
-    new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->setSockets((*existing_warming_listener)->getSockets());
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
-    new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->setSockets((*existing_active_listener)->getSockets());
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -807,22 +859,16 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::SocketSharedPtr draining_listener_socket;
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
-          return *new_listener->address() == *listener.listener_->socket().localAddress();
+          return *new_listener->address() == *listener.listener_->socket().localAddress() &&
+                 new_listener->reusePort() == listener.listener_->reusePort();
         });
-    if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
-    }
 
-    new_listener->setSocket(draining_listener_socket
-                                ? draining_listener_socket
-                                : factory_.createListenSocket(new_listener->address(),
-                                                              new_listener->socketType(),
-                                                              new_listener->listenSocketOptions(),
-                                                              new_listener->bindToPort()));
+    new_listener->setSockets(existing_draining_listener != draining_listeners_.cend()
+                                 ? existing_draining_listener->listener_->getSockets()
+                                 : createListenSockets(*new_listener));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -855,6 +901,37 @@ bool ListenerManagerImpl::hasListenerWithAddress(const ListenerList& list,
   return false;
 }
 
+std::vector<Network::SocketSharedPtr>
+ListenerManagerImpl::createListenSockets(ListenerImpl& listener) {
+  // A listener with reuse_port binds a socket for each worker. The sockets after the first bind to
+  // its address, so that they share its port if the configured port is 0.
+  std::vector<Network::SocketSharedPtr> sockets;
+  uint32_t num_sockets = listener.reusePort() ? workers_.size() : 1;
+  for (uint32_t i = 0; i < num_sockets; i++) {
+    // Server config validation creates nullptr sockets.
+    Network::Address::InstanceConstSharedPtr address =
+        sockets.empty() || sockets.front() == nullptr ? listener.address()
+                                                      : sockets.front()->localAddress();
+    uint32_t num_parent_sockets = 0;
+    sockets.push_back(factory_.createListenSocket(address, listener.socketType(),
+                                                  listener.listenSocketOptions(),
+                                                  listener.bindToPort(), i, num_parent_sockets));
+    if (i == 0 && num_parent_sockets > 0 && num_parent_sockets != num_sockets) {
+      // A hot restart parent has the address bound. All of its sockets are adopted, and no others
+      // are bound, so that no parent socket is left listening without anyone accepting from it
+      // once the parent drains, and no bind fails on a parent socket without SO_REUSEPORT. The
+      // workers then share sockets or accept on several of them, see workerSockets().
+      ENVOY_LOG(warn,
+                "listener '{}' adopts {} listen sockets from the parent process instead of {}, "
+                "so its workers will not each have one socket until the next full restart",
+                listener.name(), num_parent_sockets, num_sockets);
+      stats_.listener_parent_socket_mismatch_.inc();
+      num_sockets = num_parent_sockets;
+    }
+  }
+  return sockets;
+}
+
 void ListenerManagerImpl::drainListener(ListenerImplPtr&& listener) {
   // First add the listener to the draining list.
   std::list<DrainingListener>::iterator draining_it = draining_listeners_.emplace(
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "envoy/api/v2/listener/listener.pb.h"
 #include "envoy/network/filter.h"
@@ -64,7 +66,8 @@ public:
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                               Network::Address::SocketType socket_type,
                                               const Network::Socket::OptionsSharedPtr& options,
-                                              bool bind_to_port) override;
+                                              bool bind_to_port, uint32_t socket_index,
+                                              uint32_t& num_parent_sockets) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
@@ -86,6 +89,7 @@ typedef std::unique_ptr<ListenerImpl> ListenerImplPtr;
   COUNTER(listener_removed)                                                                        \
   COUNTER(listener_create_success)                                                                 \
   COUNTER(listener_create_failure)                                                                 \
+  COUNTER(listener_parent_socket_mismatch)                                                         \
   GAUGE  (total_listeners_warming)                                                                 \
   GAUGE  (total_listeners_active)                                                                  \
   GAUGE  (total_listeners_draining)
@@ -138,6 +142,7 @@ private:
   };
 
   void addListenerToWorker(Worker& worker, ListenerImpl& listener);
+  std::vector<Network::SocketSharedPtr> createListenSockets(ListenerImpl& listener);
   ProtobufTypes::MessagePtr dumpListenerConfigs();
   static ListenerManagerStats generateStats(Stats::Scope& scope);
   static bool hasListenerWithAddress(const ListenerList& list,
@@ -230,11 +235,12 @@ public:
   Network::Address::InstanceConstSharedPtr address() const { return address_; }
   Network::Address::SocketType socketType() const { return socket_type_; }
   const envoy::api::v2::Listener& config() { return config_; }
-  const Network::SocketSharedPtr& getSocket() const { return socket_; }
+  bool reusePort() const { return reuse_port_; }
+  const std::vector<Network::SocketSharedPtr>& getSockets() const { return sockets_; }
   void debugLog(const std::string& message);
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
-  void setSocket(const Network::SocketSharedPtr& socket);
+  void setSockets(const std::vector<Network::SocketSharedPtr>& sockets);
   void setSocketAndOptions(const Network::SocketSharedPtr& socket);
   const Network::Socket::OptionsSharedPtr& listenSocketOptions() { return listen_socket_options_; }
   const std::string& versionInfo() { return version_info_; }
@@ -242,8 +248,11 @@ public:
   // Network::ListenerConfig
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
-  Network::Socket& socket() override { return *socket_; }
-  const Network::Socket& socket() const override { return *socket_; }
+  Network::Socket& socket() override { return *sockets_[0]; }
+  const Network::Socket& socket() const override { return *sockets_[0]; }
+  std::vector<std::reference_wrapper<Network::Socket>> listenSockets() override;
+  std::vector<std::reference_wrapper<Network::Socket>>
+  workerSockets(uint32_t worker_index) override;
   bool bindToPort() override { return bind_to_port_; }
   bool handOffRestoredDestinationConnections() const override {
     return hand_off_restored_destination_connections_;
@@ -389,10 +398,13 @@ private:
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
   Network::Address::SocketType socket_type_;
-  Network::SocketSharedPtr socket_;
+  // A single socket shared by all workers, or one per worker when reuse_port_ is set. Sockets
+  // adopted from a hot restart parent may not be one per worker, see workerSockets().
+  std::vector<Network::SocketSharedPtr> sockets_;
   Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
   Stats::ScopePtr listener_scope_; // Stats with listener named scope.
   const bool bind_to_port_;
+  const bool reuse_port_;
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
   const uint64_t listener_tag_;
@@ -8,6 +8,7 @@
 #include "common/common/fmt.h"
 #include "common/common/logger.h"
 #include "common/common/macros.h"
+#include "common/common/regex.h"
 #include "common/common/version.h"
 #include "common/protobuf/utility.h"
 
@@ -94,6 +95,13 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   TCLAP::ValueArg<uint32_t> file_flush_interval_msec("", "file-flush-interval-msec",
                                                      "Interval for log flushing in msec", false,
                                                      10000, "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> file_flush_size_kb(
+      "", "file-flush-size-kb", "Buffered size in KiB that triggers a log flush", false, 64,
+      "uint32_t", cmd);
+  TCLAP::ValueArg<uint32_t> file_buffer_limit_kb(
+      "", "file-buffer-limit-kb",
+      "Buffered size in KiB above which log writes are dropped (0 for no limit)", false, 0,
+      "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> drain_time_s("", "drain-time-s", "Hot restart drain time in seconds",
                                          false, 600, "uint32_t", cmd);
   TCLAP::ValueArg<uint32_t> parent_shutdown_time_s("", "parent-shutdown-time-s",
@@ -117,6 +125,17 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
                                        "Disable hot restart functionality", cmd, false);
   TCLAP::SwitchArg enable_mutex_tracing(
       "", "enable-mutex-tracing", "Enable mutex contention tracing functionality", cmd, false);
+  TCLAP::ValueArg<bool> use_libevent_buffers("", "use-libevent-buffers",
+                                             "Use the original libevent buffer implementation",
+                                             false, true, "bool", cmd);
+  TCLAP::ValueArg<std::string> regex_engine(
+      "", "regex-engine",
+      "One of 'std' (default; ECMAScript std::regex) or 're2' (linear time RE2) for regular "
+      "expressions in the configuration.",
+      false, "std", "string", cmd);
+  TCLAP::ValueArg<uint32_t> regex_max_program_size(
+      "", "regex-max-program-size", "Largest accepted RE2 program size", false,
+      Regex::Utility::DefaultMaxProgramSize, "uint32_t", cmd);
 
   cmd.setExceptionHandling(false);
   try {
@@ -154,6 +173,19 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
 
   mutex_tracing_enabled_ = enable_mutex_tracing.getValue();
 
+  libevent_buffer_enabled_ = use_libevent_buffers.getValue();
+
+  if (regex_engine.getValue() == "std") {
+    regex_engine_ = Regex::Engine::StdRegex;
+  } else if (regex_engine.getValue() == "re2") {
+    regex_engine_ = Regex::Engine::Re2;
+  } else {
+    const std::string message =
+        fmt::format("error: unknown regex engine '{}'", regex_engine.getValue());
+    throw MalformedArgvException(message);
+  }
+  regex_max_program_size_ = regex_max_program_size.getValue();
+
   log_level_ = default_log_level;
   for (size_t i = 0; i < ARRAY_SIZE(spdlog::level::level_string_views); i++) {
     if (log_level.getValue() == spdlog::level::level_string_views[i]) {
@@ -202,6 +234,8 @@ OptionsImpl::OptionsImpl(int argc, const char* const* argv,
   service_node_ = service_node.getValue();
   service_zone_ = service_zone.getValue();
   file_flush_interval_msec_ = std::chrono::milliseconds(file_flush_interval_msec.getValue());
+  file_flush_size_kb_ = file_flush_size_kb.getValue();
+  file_buffer_limit_kb_ = file_buffer_limit_kb.getValue();
   drain_time_ = std::chrono::seconds(drain_time_s.getValue());
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
   max_stats_ = max_stats.getValue();
@@ -283,6 +317,8 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   }
   command_line_options->mutable_file_flush_interval()->MergeFrom(
       Protobuf::util::TimeUtil::MillisecondsToDuration(fileFlushIntervalMsec().count()));
+  command_line_options->set_file_flush_size_kb(fileFlushSizeKb());
+  command_line_options->set_file_buffer_limit_kb(fileBufferLimitKb());
   command_line_options->mutable_parent_shutdown_time()->MergeFrom(
       Protobuf::util::TimeUtil::SecondsToDuration(parentShutdownTime().count()));
   command_line_options->mutable_drain_time()->MergeFrom(
@@ -292,6 +328,13 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   command_line_options->set_disable_hot_restart(hotRestartDisabled());
   command_line_options->set_enable_mutex_tracing(mutexTracingEnabled());
   command_line_options->set_restart_epoch(restartEpoch());
+  command_line_options->set_use_libevent_buffers(libeventBufferEnabled());
+  if (regexEngine() == Regex::Engine::StdRegex) {
+    command_line_options->set_regex_engine(envoy::admin::v2alpha::CommandLineOptions::StdRegex);
+  } else {
+    command_line_options->set_regex_engine(envoy::admin::v2alpha::CommandLineOptions::Re2);
+  }
+  command_line_options->set_regex_max_program_size(regexMaxProgramSize());
   return command_line_options;
 }
 
@@ -301,8 +344,11 @@ OptionsImpl::OptionsImpl(const std::string& service_cluster, const std::string&
       local_address_ip_version_(Network::Address::IpVersion::v4), log_level_(log_level),
       log_format_(Logger::Logger::DEFAULT_LOG_FORMAT), restart_epoch_(0u),
       service_cluster_(service_cluster), service_node_(service_node), service_zone_(service_zone),
-      file_flush_interval_msec_(10000), drain_time_(600), parent_shutdown_time_(900),
+      file_flush_interval_msec_(10000), file_flush_size_kb_(64), file_buffer_limit_kb_(0),
+      drain_time_(600), parent_shutdown_time_(900),
       mode_(Server::Mode::Serve), max_stats_(ENVOY_DEFAULT_MAX_STATS), hot_restart_disabled_(false),
-      signal_handling_enabled_(true), mutex_tracing_enabled_(false) {}
+      signal_handling_enabled_(true), mutex_tracing_enabled_(false),
+      libevent_buffer_enabled_(true), regex_engine_(Regex::Engine::StdRegex),
+      regex_max_program_size_(Regex::Utility::DefaultMaxProgramSize) {}
 
 } // namespace Envoy
@@ -60,6 +60,10 @@ public:
   void setFileFlushIntervalMsec(std::chrono::milliseconds file_flush_interval_msec) {
     file_flush_interval_msec_ = file_flush_interval_msec;
   }
+  void setFileFlushSizeKb(uint32_t file_flush_size_kb) { file_flush_size_kb_ = file_flush_size_kb; }
+  void setFileBufferLimitKb(uint32_t file_buffer_limit_kb) {
+    file_buffer_limit_kb_ = file_buffer_limit_kb;
+  }
   void setServiceClusterName(const std::string& service_cluster) {
     service_cluster_ = service_cluster;
   }
@@ -73,6 +77,13 @@ public:
   void setSignalHandling(bool signal_handling_enabled) {
     signal_handling_enabled_ = signal_handling_enabled;
   }
+  void setLibeventBufferEnabled(bool libevent_buffer_enabled) {
+    libevent_buffer_enabled_ = libevent_buffer_enabled;
+  }
+  void setRegexEngine(Regex::Engine regex_engine) { regex_engine_ = regex_engine; }
+  void setRegexMaxProgramSize(uint32_t regex_max_program_size) {
+    regex_max_program_size_ = regex_max_program_size;
+  }
 
   // Server::Options
   uint64_t baseId() const override { return base_id_; }
@@ -97,6 +108,8 @@ public:
   std::chrono::milliseconds fileFlushIntervalMsec() const override {
     return file_flush_interval_msec_;
   }
+  uint32_t fileFlushSizeKb() const override { return file_flush_size_kb_; }
+  uint32_t fileBufferLimitKb() const override { return file_buffer_limit_kb_; }
   const std::string& serviceClusterName() const override { return service_cluster_; }
   const std::string& serviceNodeName() const override { return service_node_; }
   const std::string& serviceZone() const override { return service_zone_; }
@@ -105,6 +118,9 @@ public:
   bool hotRestartDisabled() const override { return hot_restart_disabled_; }
   bool signalHandlingEnabled() const override { return signal_handling_enabled_; }
   bool mutexTracingEnabled() const override { return mutex_tracing_enabled_; }
+  bool libeventBufferEnabled() const override { return libevent_buffer_enabled_; }
+  Regex::Engine regexEngine() const override { return regex_engine_; }
+  uint32_t regexMaxProgramSize() const override { return regex_max_program_size_; }
   virtual Server::CommandLineOptionsPtr toCommandLineOptions() const override;
   void parseComponentLogLevels(const std::string& component_log_levels);
   uint32_t count() const;
@@ -129,6 +145,8 @@ private:
   std::string service_node_;
   std::string service_zone_;
   std::chrono::milliseconds file_flush_interval_msec_;
+  uint32_t file_flush_size_kb_;
+  uint32_t file_buffer_limit_kb_;
   std::chrono::seconds drain_time_;
   std::chrono::seconds parent_shutdown_time_;
   Server::Mode mode_;
@@ -137,6 +155,9 @@ private:
   bool hot_restart_disabled_;
   bool signal_handling_enabled_;
   bool mutex_tracing_enabled_;
+  bool libevent_buffer_enabled_;
+  Regex::Engine regex_engine_;
+  uint32_t regex_max_program_size_;
   uint32_t count_;
 };
 
@@ -1,5 +1,6 @@
 #include "server/worker_impl.h"
 
+#include <chrono>
 #include <functional>
 #include <memory>
 
@@ -8,16 +9,23 @@
 #include "envoy/server/configuration.h"
 #include "envoy/thread_local/thread_local.h"
 
+#include "common/buffer/slab_pool.h"
+
 #include "server/connection_handler_impl.h"
 
 namespace Envoy {
 namespace Server {
 
-WorkerPtr ProdWorkerFactory::createWorker(OverloadManager& overload_manager) {
+namespace {
+// How often a worker returns to the heap the buffer slabs it cached but did not reuse.
+constexpr std::chrono::milliseconds SlabPoolReleaseInterval(10000);
+} // namespace
+
+WorkerPtr ProdWorkerFactory::createWorker(uint32_t index, OverloadManager& overload_manager) {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
   return WorkerPtr{new WorkerImpl(
       tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)},
+      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher, index)},
       overload_manager, api_)};
 }
 
@@ -97,8 +105,18 @@ void WorkerImpl::threadRoutine(GuardDog& guard_dog) {
   ENVOY_LOG(debug, "worker entering dispatch loop");
   auto watchdog = guard_dog.createWatchDog(api_.threadFactory().currentThreadId());
   watchdog->startWatchdog(*dispatcher_);
+  slab_pool_release_timer_ = dispatcher_->createTimer([this]() -> void {
+    // The pool is installed for the duration of the dispatch loop, which runs this callback.
+    Buffer::SlabPool* pool = Buffer::SlabPool::threadLocal();
+    if (pool != nullptr) {
+      pool->releaseIdle();
+    }
+    slab_pool_release_timer_->enableTimer(SlabPoolReleaseInterval);
+  });
+  slab_pool_release_timer_->enableTimer(SlabPoolReleaseInterval);
   dispatcher_->run(Event::Dispatcher::RunType::Block);
   ENVOY_LOG(debug, "worker exited dispatch loop");
+  slab_pool_release_timer_.reset();
   guard_dog.stopWatching(watchdog);
 
   // We must close all active connections before we actually exit the thread. This prevents any
@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "envoy/api/api.h"
+#include "envoy/event/timer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/server/guarddog.h"
 #include "envoy/server/listener_manager.h"
@@ -23,7 +24,7 @@ public:
       : tls_(tls), api_(api), hooks_(hooks) {}
 
   // Server::WorkerFactory
-  WorkerPtr createWorker(OverloadManager& overload_manager) override;
+  WorkerPtr createWorker(uint32_t index, OverloadManager& overload_manager) override;
 
 private:
   ThreadLocal::Instance& tls_;
@@ -59,6 +60,7 @@ private:
   Network::ConnectionHandlerPtr handler_;
   Api::Api& api_;
   Thread::ThreadPtr thread_;
+  Event::TimerPtr slab_pool_release_timer_;
 };
 
 } // namespace Server
@@ -579,6 +579,76 @@ TEST(AccessLogFormatterTest, JsonFormatterMultiTokenTest) {
   }
 }
 
+TEST(AccessLogFormatterTest, JsonFormatterEscapingTest) {
+  StreamInfo::MockStreamInfo stream_info;
+  Http::TestHeaderMapImpl request_header{{"quoted", "say \"hi\"\\"}};
+  Http::TestHeaderMapImpl response_header;
+  Http::TestHeaderMapImpl response_trailer;
+
+  std::unordered_map<std::string, std::string> expected_json_map = {
+      {"quoted", "say \"hi\"\\"},
+      {"control", "a\tb\x01"
+                  "c\n"},
+      {"key \"with\" quotes", "plain"}};
+
+  std::unordered_map<std::string, std::string> key_mapping = {
+      {"quoted", "%REQ(quoted)%"},
+      {"control", "a\tb\x01"
+                  "c\n"},
+      {"key \"with\" quotes", "plain"}};
+  JsonFormatterImpl formatter(key_mapping);
+
+  verifyJsonOutput(formatter.format(request_header, response_header, response_trailer, stream_info),
+                   expected_json_map);
+}
+
+TEST(AccessLogFormatterTest, JsonFormatterOutputTest) {
+  StreamInfo::MockStreamInfo stream_info;
+  Http::TestHeaderMapImpl request_header;
+  Http::TestHeaderMapImpl response_header;
+  Http::TestHeaderMapImpl response_trailer;
+
+  absl::optional<Http::Protocol> protocol = Http::Protocol::Http11;
+  EXPECT_CALL(stream_info, protocol()).WillRepeatedly(Return(protocol));
+
+  {
+    std::unordered_map<std::string, std::string> key_mapping = {{"b", "%PROTOCOL%"}, {"a", "1"}};
+    JsonFormatterImpl formatter(key_mapping);
+
+    // Keys are sorted, and formatInto() appends to the output.
+    std::string output = "prefix ";
+    formatter.formatInto(request_header, response_header, response_trailer, stream_info, output);
+    EXPECT_EQ("prefix {\"a\":\"1\",\"b\":\"HTTP/1.1\"}\n", output);
+  }
+
+  {
+    std::unordered_map<std::string, std::string> key_mapping;
+    JsonFormatterImpl formatter(key_mapping);
+    EXPECT_EQ("{}\n",
+              formatter.format(request_header, response_header, response_trailer, stream_info));
+  }
+}
+
+TEST(AccessLogFormatterTest, CompositeFormatterFormatInto) {
+  StreamInfo::MockStreamInfo stream_info;
+  Http::TestHeaderMapImpl request_header{{"first", "GET"}};
+  Http::TestHeaderMapImpl response_header;
+  Http::TestHeaderMapImpl response_trailer;
+
+  absl::optional<uint32_t> response_code{200};
+  EXPECT_CALL(stream_info, responseCode()).WillRepeatedly(Return(response_code));
+
+  FormatterImpl formatter("%REQ(FIRST):2% %RESPONSE_CODE%\n");
+
+  // The same output string can be reused for each line.
+  std::string output;
+  for (int i = 0; i < 2; ++i) {
+    output.clear();
+    formatter.formatInto(request_header, response_header, response_trailer, stream_info, output);
+    EXPECT_EQ("GE 200\n", output);
+  }
+}
+
 TEST(AccessLogFormatterTest, CompositeFormatterSuccess) {
   StreamInfo::MockStreamInfo stream_info;
   Http::TestHeaderMapImpl request_header{{"first", "GET"}, {":path", "/"}};
@@ -14,7 +14,6 @@
 using testing::_;
 using testing::NiceMock;
 using testing::Return;
-using testing::ReturnNew;
 using testing::ReturnRef;
 using testing::Sequence;
 
@@ -26,7 +25,7 @@ class AccessLogManagerImplTest : public testing::Test {
 protected:
   AccessLogManagerImplTest()
       : file_(new NiceMock<Filesystem::MockFile>), thread_factory_(Thread::threadFactoryForTest()),
-        access_log_manager_(timeout_40ms_, api_, dispatcher_, lock_, store_) {
+        access_log_manager_(timeout_40ms_, 64 * 1024, 0, api_, dispatcher_, lock_, store_) {
     EXPECT_CALL(file_system_, createFile("foo"))
         .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(file_))));
 
@@ -46,7 +45,7 @@ protected:
 };
 
 TEST_F(AccessLogManagerImplTest, BadFile) {
-  EXPECT_CALL(dispatcher_, createTimer_(_));
+  EXPECT_CALL(dispatcher_, createTimer_(_)).Times(0);
   EXPECT_CALL(*file_, open_()).WillOnce(Return(Api::SysCallBoolResult{false, 0}));
   EXPECT_THROW(access_log_manager_.createAccessLog("foo"), EnvoyException);
 }
@@ -55,9 +54,9 @@ TEST_F(AccessLogManagerImplTest, flushToLogFilePeriodically) {
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
 
   EXPECT_CALL(*file_, open_()).WillOnce(Return(Api::SysCallBoolResult{true, 0}));
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_));
   AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
 
-  EXPECT_CALL(*timer, enableTimer(timeout_40ms_));
   EXPECT_CALL(*file_, write_(_))
       .WillOnce(Invoke([](absl::string_view data) -> Api::SysCallSizeResult {
         EXPECT_EQ(0, data.compare("test"));
@@ -65,6 +64,8 @@ TEST_F(AccessLogManagerImplTest, flushToLogFilePeriodically) {
       }));
 
   log_file->write("test");
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_));
+  timer->callback_();
 
   {
     Thread::LockGuard lock(file_->write_mutex_);
@@ -97,24 +98,11 @@ TEST_F(AccessLogManagerImplTest, flushToLogFileOnDemand) {
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
 
   EXPECT_CALL(*file_, open_()).WillOnce(Return(Api::SysCallBoolResult{true, 0}));
-  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
-
   EXPECT_CALL(*timer, enableTimer(timeout_40ms_));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
 
-  // The first write to a given file will start the flush thread, which can flush
-  // immediately (race on whether it will or not). So do a write and flush to
-  // get that state out of the way, then test that small writes don't trigger a flush.
-  EXPECT_CALL(*file_, write_(_))
-      .WillOnce(Invoke([](absl::string_view data) -> Api::SysCallSizeResult {
-        return {static_cast<ssize_t>(data.length()), 0};
-      }));
-  log_file->write("prime-it");
-  log_file->flush();
-  uint32_t expected_writes = 1;
-  {
-    Thread::LockGuard lock(file_->write_mutex_);
-    EXPECT_EQ(expected_writes, file_->num_writes_);
-  }
+  // Small writes don't wake up the flush thread, so nothing is written until flush() is called.
+  uint32_t expected_writes = 0;
 
   EXPECT_CALL(*file_, write_(_))
       .WillOnce(Invoke([](absl::string_view data) -> Api::SysCallSizeResult {
@@ -249,13 +237,16 @@ TEST_F(AccessLogManagerImplTest, bigDataChunkShouldBeFlushedWithoutTimer) {
   EXPECT_CALL(*file_, open_()).WillOnce(Return(Api::SysCallBoolResult{true, 0}));
   AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
 
+  // A string bigger than the flush size should be flushed even though the timer never fires.
   EXPECT_CALL(*file_, write_(_))
       .WillOnce(Invoke([](absl::string_view data) -> Api::SysCallSizeResult {
-        EXPECT_EQ(0, data.compare("a"));
+        std::string expected(1024 * 64 + 1, 'b');
+        EXPECT_EQ(0, data.compare(expected));
         return {static_cast<ssize_t>(data.length()), 0};
       }));
 
-  log_file->write("a");
+  std::string big_string(1024 * 64 + 1, 'b');
+  log_file->write(big_string);
 
   {
     Thread::LockGuard lock(file_->write_mutex_);
@@ -263,30 +254,42 @@ TEST_F(AccessLogManagerImplTest, bigDataChunkShouldBeFlushedWithoutTimer) {
       file_->write_event_.wait(file_->write_mutex_);
     }
   }
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(Api::SysCallBoolResult{true, 0}));
+}
+
+TEST_F(AccessLogManagerImplTest, writesOverBufferLimitAreDropped) {
+  AccessLogManagerImpl access_log_manager(timeout_40ms_, 64 * 1024, 10, api_, dispatcher_, lock_,
+                                          store_);
+  EXPECT_CALL(*file_, open_()).WillOnce(Return(Api::SysCallBoolResult{true, 0}));
+  AccessLogFileSharedPtr log_file = access_log_manager.createAccessLog("foo");
+
+  log_file->write("0123456789");
+  log_file->write("a");
+  EXPECT_EQ(1UL, store_.counter("access_log_file.write_dropped").value());
 
-  // First write happens without waiting on thread_flush_. Now make a big string and it should be
-  // flushed even when timer is not enabled
   EXPECT_CALL(*file_, write_(_))
       .WillOnce(Invoke([](absl::string_view data) -> Api::SysCallSizeResult {
-        std::string expected(1024 * 64 + 1, 'b');
-        EXPECT_EQ(0, data.compare(expected));
+        EXPECT_EQ(0, data.compare("0123456789"));
         return {static_cast<ssize_t>(data.length()), 0};
       }));
+  log_file->flush();
 
-  std::string big_string(1024 * 64 + 1, 'b');
-  log_file->write(big_string);
+  // Once the buffered data is written there is room again.
+  log_file->write("b");
+  EXPECT_EQ(1UL, store_.counter("access_log_file.write_dropped").value());
+  EXPECT_EQ(1UL, store_.gauge("access_log_file.write_total_buffered").value());
 
-  {
-    Thread::LockGuard lock(file_->write_mutex_);
-    while (file_->num_writes_ != 2) {
-      file_->write_event_.wait(file_->write_mutex_);
-    }
-  }
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::SysCallSizeResult {
+        EXPECT_EQ(0, data.compare("b"));
+        return {static_cast<ssize_t>(data.length()), 0};
+      }));
   EXPECT_CALL(*file_, close_()).WillOnce(Return(Api::SysCallBoolResult{true, 0}));
 }
 
 TEST_F(AccessLogManagerImplTest, reopenAllFiles) {
-  EXPECT_CALL(dispatcher_, createTimer_(_)).WillRepeatedly(ReturnNew<NiceMock<Event::MockTimer>>());
+  // All files share a single flush timer and thread.
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
 
   EXPECT_CALL(*file_, open_()).Times(2).WillRepeatedly(Return(Api::SysCallBoolResult{true, 0}));
   AccessLogFileSharedPtr log = access_log_manager_.createAccessLog("foo");
@@ -319,6 +322,7 @@ TEST_F(AccessLogManagerImplTest, reopenAllFiles) {
 
   log->write("this is to force reopen");
   log2->write("this is to force reopen");
+  timer->callback_();
 
   {
     Thread::LockGuard lock(file_->open_mutex_);
@@ -12,8 +12,41 @@ static constexpr uint64_t MaxBufferLength = 1024 * 1024;
 static const std::function<void(const void*, size_t, const Buffer::BufferFragmentImpl*)>
     DoNotReleaseFragment = nullptr;
 
+// The first argument of every benchmark selects the buffer implementation under test, so that the
+// evbuffer-based and native slice-based implementations can be compared side by side:
+// 0 selects the native implementation and 1 selects the evbuffer implementation.
+static void selectImplementation(benchmark::State& state) {
+  Buffer::OwnedImpl::useOldImpl(state.range(0) != 0);
+}
+
+// Registers a benchmark for both implementations, with no other arguments.
+static void bothImplementations(benchmark::internal::Benchmark* benchmark) {
+  for (int impl = 0; impl <= 1; impl++) {
+    benchmark->Args({impl});
+  }
+}
+
+// Registers a benchmark for both implementations and a range of data sizes.
+static void testSizes(benchmark::internal::Benchmark* benchmark) {
+  for (int impl = 0; impl <= 1; impl++) {
+    for (int size : {1, 4096, 16384, 65536}) {
+      benchmark->Args({impl, size});
+    }
+  }
+}
+
+// Registers a benchmark for both implementations and a range of small increments.
+static void smallIncrements(benchmark::internal::Benchmark* benchmark) {
+  for (int impl = 0; impl <= 1; impl++) {
+    for (int increment = 1; increment <= 5; increment++) {
+      benchmark->Args({impl, increment});
+    }
+  }
+}
+
 // Test the creation of an empty OwnedImpl.
 static void BufferCreateEmpty(benchmark::State& state) {
+  selectImplementation(state);
   uint64_t length = 0;
   for (auto _ : state) {
     Buffer::OwnedImpl buffer;
@@ -21,11 +54,12 @@ static void BufferCreateEmpty(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(length);
 }
-BENCHMARK(BufferCreateEmpty);
+BENCHMARK(BufferCreateEmpty)->Apply(bothImplementations);
 
 // Test the creation of an OwnedImpl with varying amounts of content.
 static void BufferCreate(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   uint64_t length = 0;
   for (auto _ : state) {
@@ -34,10 +68,11 @@ static void BufferCreate(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(length);
 }
-BENCHMARK(BufferCreate)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferCreate)->Apply(testSizes);
 
 // Grow an OwnedImpl in very small amounts.
 static void BufferAddSmallIncrement(benchmark::State& state) {
+  selectImplementation(state);
   const std::string data("a");
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer;
@@ -54,11 +89,12 @@ static void BufferAddSmallIncrement(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferAddSmallIncrement)->Arg(1)->Arg(2)->Arg(3)->Arg(4)->Arg(5);
+BENCHMARK(BufferAddSmallIncrement)->Apply(smallIncrements);
 
 // Test the appending of varying amounts of content from a string to an OwnedImpl.
 static void BufferAddString(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer(input);
   for (auto _ : state) {
@@ -69,12 +105,13 @@ static void BufferAddString(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferAddString)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferAddString)->Apply(testSizes);
 
 // Variant of BufferAddString that appends from another Buffer::Instance
 // rather than from a string.
 static void BufferAddBuffer(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   const Buffer::OwnedImpl to_add(data);
   Buffer::OwnedImpl buffer(input);
@@ -86,11 +123,12 @@ static void BufferAddBuffer(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferAddBuffer)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferAddBuffer)->Apply(testSizes);
 
 // Test the prepending of varying amounts of content from a string to an OwnedImpl.
 static void BufferPrependString(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer(input);
   for (auto _ : state) {
@@ -101,11 +139,12 @@ static void BufferPrependString(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferPrependString)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferPrependString)->Apply(testSizes);
 
 // Test the prepending of one OwnedImpl to another.
 static void BufferPrependBuffer(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer(input);
   for (auto _ : state) {
@@ -123,10 +162,11 @@ static void BufferPrependBuffer(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferPrependBuffer)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferPrependBuffer)->Apply(testSizes);
 
 static void BufferDrain(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   const Buffer::OwnedImpl to_add(data);
   Buffer::OwnedImpl buffer(input);
@@ -138,7 +178,7 @@ static void BufferDrain(benchmark::State& state) {
   constexpr double DrainCycleRatios[DrainCycleSize] = {0.0, 1.5, 1, 1.5, 0, 2.0, 1.0};
   uint64_t drain_size[DrainCycleSize];
   for (size_t i = 0; i < DrainCycleSize; i++) {
-    drain_size[i] = state.range(0) * DrainCycleRatios[i];
+    drain_size[i] = state.range(1) * DrainCycleRatios[i];
   }
 
   size_t drain_cycle = 0;
@@ -150,26 +190,28 @@ static void BufferDrain(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferDrain)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferDrain)->Apply(testSizes);
 
 // Drain an OwnedImpl in very small amounts.
 static void BufferDrainSmallIncrement(benchmark::State& state) {
+  selectImplementation(state);
   const std::string data(1024 * 1024, 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer(input);
   for (auto _ : state) {
-    buffer.drain(state.range(0));
+    buffer.drain(state.range(1));
     if (buffer.length() == 0) {
       buffer.add(input);
     }
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferDrainSmallIncrement)->Arg(1)->Arg(2)->Arg(3)->Arg(4)->Arg(5);
+BENCHMARK(BufferDrainSmallIncrement)->Apply(smallIncrements);
 
 // Test the moving of content from one OwnedImpl to another.
 static void BufferMove(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer1(input);
   Buffer::OwnedImpl buffer2(input);
@@ -180,13 +222,14 @@ static void BufferMove(benchmark::State& state) {
   uint64_t length = buffer1.length();
   benchmark::DoNotOptimize(length);
 }
-BENCHMARK(BufferMove)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferMove)->Apply(testSizes);
 
 // Test the moving of content from one OwnedImpl to another, one byte at a time, to
 // exercise the (likely inefficient) code path in the implementation that handles
 // partial moves.
 static void BufferMovePartial(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   Buffer::OwnedImpl buffer1(input);
   Buffer::OwnedImpl buffer2(input);
@@ -199,16 +242,17 @@ static void BufferMovePartial(benchmark::State& state) {
   uint64_t length = buffer1.length();
   benchmark::DoNotOptimize(length);
 }
-BENCHMARK(BufferMovePartial)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferMovePartial)->Apply(testSizes);
 
 // Test the reserve+commit cycle, for the special case where the reserved space is
 // fully used (and therefore the commit size equals the reservation size).
 static void BufferReserveCommit(benchmark::State& state) {
+  selectImplementation(state);
   Buffer::OwnedImpl buffer;
   for (auto _ : state) {
     constexpr uint64_t NumSlices = 2;
     Buffer::RawSlice slices[NumSlices];
-    uint64_t slices_used = buffer.reserve(state.range(0), slices, NumSlices);
+    uint64_t slices_used = buffer.reserve(state.range(1), slices, NumSlices);
     uint64_t bytes_to_commit = 0;
     for (uint64_t i = 0; i < slices_used; i++) {
       bytes_to_commit += static_cast<uint64_t>(slices[i].len_);
@@ -220,16 +264,17 @@ static void BufferReserveCommit(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferReserveCommit)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferReserveCommit)->Apply(testSizes);
 
 // Test the reserve+commit cycle, for the common case where the reserved space is
 // only partially used (and therefore the commit size is smaller than the reservation size).
 static void BufferReserveCommitPartial(benchmark::State& state) {
+  selectImplementation(state);
   Buffer::OwnedImpl buffer;
   for (auto _ : state) {
     constexpr uint64_t NumSlices = 2;
     Buffer::RawSlice slices[NumSlices];
-    uint64_t slices_used = buffer.reserve(state.range(0), slices, NumSlices);
+    uint64_t slices_used = buffer.reserve(state.range(1), slices, NumSlices);
     ASSERT(slices_used > 0);
     // Commit one byte from the first slice and nothing from any subsequent slice.
     uint64_t bytes_to_commit = 1;
@@ -241,25 +286,27 @@ static void BufferReserveCommitPartial(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(buffer.length());
 }
-BENCHMARK(BufferReserveCommitPartial)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferReserveCommitPartial)->Apply(testSizes);
 
 // Test the linearization of a buffer in the best case where the data is in one slice.
 static void BufferLinearizeSimple(benchmark::State& state) {
-  const std::string data(state.range(0), 'a');
+  selectImplementation(state);
+  const std::string data(state.range(1), 'a');
   const absl::string_view input(data);
   Buffer::BufferFragmentImpl fragment(input.data(), input.size(), DoNotReleaseFragment);
   Buffer::OwnedImpl buffer;
   for (auto _ : state) {
     buffer.drain(buffer.length());
     buffer.addBufferFragment(fragment);
-    benchmark::DoNotOptimize(buffer.linearize(state.range(0)));
+    benchmark::DoNotOptimize(buffer.linearize(state.range(1)));
   }
 }
-BENCHMARK(BufferLinearizeSimple)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferLinearizeSimple)->Apply(testSizes);
 
 // Test the linearization of a buffer in the general case where the data is spread among
 // many slices.
 static void BufferLinearizeGeneral(benchmark::State& state) {
+  selectImplementation(state);
   static constexpr uint64_t SliceSize = 1024;
   const std::string data(SliceSize, 'a');
   const absl::string_view input(data);
@@ -269,19 +316,20 @@ static void BufferLinearizeGeneral(benchmark::State& state) {
     buffer.drain(buffer.length());
     do {
       buffer.addBufferFragment(fragment);
-    } while (buffer.length() < static_cast<uint64_t>(state.range(0)));
-    benchmark::DoNotOptimize(buffer.linearize(state.range(0)));
+    } while (buffer.length() < static_cast<uint64_t>(state.range(1)));
+    benchmark::DoNotOptimize(buffer.linearize(state.range(1)));
   }
 }
-BENCHMARK(BufferLinearizeGeneral)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferLinearizeGeneral)->Apply(testSizes);
 
 // Test buffer search, for the simple case where there are no partial matches for
 // the pattern in the buffer.
 static void BufferSearch(benchmark::State& state) {
+  selectImplementation(state);
   const std::string Pattern(16, 'b');
   std::string data;
-  data.reserve(state.range(0) + Pattern.length());
-  data += std::string(state.range(0), 'a');
+  data.reserve(state.range(1) + Pattern.length());
+  data += std::string(state.range(1), 'a');
   data += Pattern;
 
   const absl::string_view input(data);
@@ -292,16 +340,17 @@ static void BufferSearch(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(result);
 }
-BENCHMARK(BufferSearch)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferSearch)->Apply(testSizes);
 
 // Test buffer search, for the more challenging case where there are many partial matches
 // for the pattern in the buffer.
 static void BufferSearchPartialMatch(benchmark::State& state) {
+  selectImplementation(state);
   const std::string Pattern(16, 'b');
   const std::string PartialMatch("babbabbbabbbbabbbbbabbbbbbabbbbbbbabbbbbbbba");
   std::string data;
-  size_t num_partial_matches = 1 + state.range(0) / PartialMatch.length();
-  data.reserve(state.range(0) * num_partial_matches + Pattern.length());
+  size_t num_partial_matches = 1 + state.range(1) / PartialMatch.length();
+  data.reserve(state.range(1) * num_partial_matches + Pattern.length());
   for (size_t i = 0; i < num_partial_matches; i++) {
     data += PartialMatch;
   }
@@ -315,7 +364,7 @@ static void BufferSearchPartialMatch(benchmark::State& state) {
   }
   benchmark::DoNotOptimize(result);
 }
-BENCHMARK(BufferSearchPartialMatch)->Arg(1)->Arg(4096)->Arg(16384)->Arg(65536);
+BENCHMARK(BufferSearchPartialMatch)->Apply(testSizes);
 
 } // namespace Envoy
 
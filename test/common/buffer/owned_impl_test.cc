@@ -1,6 +1,7 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/buffer/buffer_impl.h"
 
+#include "test/common/buffer/utility.h"
 #include "test/mocks/api/mocks.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
@@ -15,15 +16,19 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
-class OwnedImplTest : public testing::Test {
+class OwnedImplTest : public BufferImplementationParamTest {
 public:
   bool release_callback_called_ = false;
 };
 
-TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
+INSTANTIATE_TEST_SUITE_P(OwnedImplTest, OwnedImplTest,
+                         testing::ValuesIn({BufferImplementation::Old, BufferImplementation::New}));
+
+TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, nullptr);
   Buffer::OwnedImpl buffer;
+  verifyImplementation(buffer);
   buffer.addBufferFragment(frag);
   EXPECT_EQ(11, buffer.length());
 
@@ -31,7 +36,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
+TEST_P(OwnedImplTest, AddBufferFragmentWithCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
     release_callback_called_ = true;
@@ -49,7 +54,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
+TEST_P(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   char input_stack[] = "hello world";
   char* input = new char[11];
   std::copy(input_stack, input_stack + 11, input);
@@ -74,7 +79,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, Prepend) {
+TEST_P(OwnedImplTest, Prepend) {
   std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
   buffer.add(suffix);
@@ -84,7 +89,7 @@ TEST_F(OwnedImplTest, Prepend) {
   EXPECT_EQ(prefix + suffix, buffer.toString());
 }
 
-TEST_F(OwnedImplTest, PrependToEmptyBuffer) {
+TEST_P(OwnedImplTest, PrependToEmptyBuffer) {
   std::string data = "Hello, World!";
   Buffer::OwnedImpl buffer;
   buffer.prepend(data);
@@ -98,7 +103,7 @@ TEST_F(OwnedImplTest, PrependToEmptyBuffer) {
   EXPECT_EQ(data, buffer.toString());
 }
 
-TEST_F(OwnedImplTest, PrependBuffer) {
+TEST_P(OwnedImplTest, PrependBuffer) {
   std::string suffix = "World!", prefix = "Hello, ";
   Buffer::OwnedImpl buffer;
   buffer.add(suffix);
@@ -112,7 +117,7 @@ TEST_F(OwnedImplTest, PrependBuffer) {
   EXPECT_EQ(0, prefixBuffer.length());
 }
 
-TEST_F(OwnedImplTest, Write) {
+TEST_P(OwnedImplTest, Write) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -150,7 +155,7 @@ TEST_F(OwnedImplTest, Write) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, Read) {
+TEST_P(OwnedImplTest, Read) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -171,7 +176,7 @@ TEST_F(OwnedImplTest, Read) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, ToString) {
+TEST_P(OwnedImplTest, ToString) {
   Buffer::OwnedImpl buffer;
   EXPECT_EQ("", buffer.toString());
   auto append = [&buffer](absl::string_view str) { buffer.add(str.data(), str.size()); };
@@ -189,7 +194,7 @@ TEST_F(OwnedImplTest, ToString) {
 // Regression test for oss-fuzz issue
 // https://bugs.chromium.org/p/oss-fuzz/issues/detail?id=13263, where prepending
 // an empty buffer resulted in a corrupted libevent internal state.
-TEST_F(OwnedImplTest, PrependEmpty) {
+TEST_P(OwnedImplTest, PrependEmpty) {
   Buffer::OwnedImpl buf;
   Buffer::OwnedImpl other_buf;
   char input[] = "foo";
@@ -203,6 +208,179 @@ TEST_F(OwnedImplTest, PrependEmpty) {
   EXPECT_EQ(0, buf.length());
 }
 
+TEST_P(OwnedImplTest, ReserveCommit) {
+  Buffer::OwnedImpl buffer;
+  verifyImplementation(buffer);
+
+  // A reservation that is not committed leaves the buffer unchanged.
+  RawSlice iovecs[2];
+  uint64_t num_reserved = buffer.reserve(1000, iovecs, 2);
+  EXPECT_LE(1, num_reserved);
+  buffer.commit(iovecs, 0);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ(0, buffer.getRawSlices(nullptr, 0));
+
+  // Commit part of a reservation.
+  num_reserved = buffer.reserve(1000, iovecs, 2);
+  ASSERT_EQ(1, num_reserved);
+  EXPECT_LE(1000, iovecs[0].len_);
+  memset(iovecs[0].mem_, 'a', 10);
+  iovecs[0].len_ = 10;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ(std::string(10, 'a'), buffer.toString());
+
+  // Reservations are made at the end of the buffer, after the committed data.
+  num_reserved = buffer.reserve(5, iovecs, 2);
+  ASSERT_EQ(1, num_reserved);
+  memset(iovecs[0].mem_, 'b', 5);
+  iovecs[0].len_ = 5;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ(std::string(10, 'a') + std::string(5, 'b'), buffer.toString());
+}
+
+TEST_P(OwnedImplTest, ReserveCommitMultipleSlices) {
+  Buffer::OwnedImpl buffer;
+  verifyImplementation(buffer);
+
+  // Fill the slices handed out by a large reservation and commit all of them.
+  RawSlice iovecs[4];
+  const uint64_t num_reserved = buffer.reserve(64 * 1024, iovecs, 4);
+  ASSERT_LE(1, num_reserved);
+  std::string expected;
+  for (uint64_t i = 0; i < num_reserved; i++) {
+    memset(iovecs[i].mem_, 'a' + i, iovecs[i].len_);
+    expected.append(iovecs[i].len_, 'a' + i);
+  }
+  buffer.commit(iovecs, num_reserved);
+  EXPECT_EQ(expected.size(), buffer.length());
+  EXPECT_EQ(expected, buffer.toString());
+}
+
+TEST_P(OwnedImplTest, MoveAndDrainAcrossSlices) {
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  verifyImplementation(buffer1);
+
+  const std::string large(20000, 'x');
+  buffer2.add("hello");
+  buffer2.add(large);
+  buffer2.add("world");
+  buffer1.add("prefix");
+  buffer1.move(buffer2, 3);
+  EXPECT_EQ("prefixhel", buffer1.toString());
+  EXPECT_EQ("lo" + large + "world", buffer2.toString());
+
+  buffer1.move(buffer2);
+  EXPECT_EQ(0, buffer2.length());
+  EXPECT_EQ("prefixhello" + large + "world", buffer1.toString());
+
+  buffer1.drain(11 + large.size() - 1);
+  EXPECT_EQ("xworld", buffer1.toString());
+}
+
+TEST_P(OwnedImplTest, Linearize) {
+  Buffer::OwnedImpl buffer;
+  verifyImplementation(buffer);
+
+  char input1[] = "hello ";
+  char input2[] = "world";
+  BufferFragmentImpl frag1(input1, 6, nullptr);
+  BufferFragmentImpl frag2(input2, 5, nullptr);
+  buffer.addBufferFragment(frag1);
+  buffer.addBufferFragment(frag2);
+  EXPECT_EQ(2, buffer.getRawSlices(nullptr, 0));
+
+  // The first slice already contains the requested bytes, so no copy is needed.
+  EXPECT_EQ(input1, buffer.linearize(4));
+
+  const char* linearized = static_cast<const char*>(buffer.linearize(8));
+  EXPECT_EQ("hello wo", std::string(linearized, 8));
+  EXPECT_EQ("hello world", buffer.toString());
+  EXPECT_EQ(11, buffer.length());
+}
+
+TEST_P(OwnedImplTest, Search) {
+  Buffer::OwnedImpl buffer;
+  verifyImplementation(buffer);
+
+  char input1[] = "abcab";
+  char input2[] = "cdabc";
+  BufferFragmentImpl frag1(input1, 5, nullptr);
+  BufferFragmentImpl frag2(input2, 5, nullptr);
+  buffer.addBufferFragment(frag1);
+  buffer.addBufferFragment(frag2);
+
+  EXPECT_EQ(0, buffer.search("abc", 3, 0));
+  // Matches that span slices.
+  EXPECT_EQ(3, buffer.search("abcd", 4, 0));
+  EXPECT_EQ(3, buffer.search("abc", 3, 1));
+  EXPECT_EQ(7, buffer.search("abc", 3, 4));
+  EXPECT_EQ(-1, buffer.search("abc", 3, 8));
+  EXPECT_EQ(-1, buffer.search("abcx", 4, 0));
+  EXPECT_EQ(-1, buffer.search("abc", 3, 11));
+}
+
+TEST_P(OwnedImplTest, PrependLarge) {
+  Buffer::OwnedImpl buffer;
+  verifyImplementation(buffer);
+
+  const std::string large1(10000, 'a');
+  const std::string large2(10000, 'b');
+  buffer.add("suffix");
+  buffer.prepend(large2);
+  buffer.prepend(large1);
+  EXPECT_EQ(large1 + large2 + "suffix", buffer.toString());
+}
+
+// Buffers can be returned by value; the native slice ring must follow the move whether its slices
+// are held inline or in a separately allocated ring.
+TEST_P(OwnedImplTest, MoveConstruct) {
+  char input[] = "0123456789";
+  std::vector<std::unique_ptr<BufferFragmentImpl>> fragments;
+  auto make_buffer = [&input, &fragments](size_t num_fragments) {
+    Buffer::OwnedImpl buffer;
+    for (size_t i = 0; i < num_fragments; ++i) {
+      fragments.push_back(std::make_unique<BufferFragmentImpl>(input + i, 1, nullptr));
+      buffer.addBufferFragment(*fragments.back());
+    }
+    return buffer;
+  };
+
+  Buffer::OwnedImpl small = make_buffer(3);
+  verifyImplementation(small);
+  Buffer::OwnedImpl moved_small(std::move(small));
+  EXPECT_EQ("012", moved_small.toString());
+  if (GetParam() == BufferImplementation::New) {
+    EXPECT_EQ(0, small.length());
+  }
+
+  Buffer::OwnedImpl large = make_buffer(10);
+  Buffer::OwnedImpl moved_large(std::move(large));
+  EXPECT_EQ("0123456789", moved_large.toString());
+  moved_large.add("!");
+  EXPECT_EQ(11, moved_large.length());
+}
+
+// Buffers created before and after switching implementations can still exchange data.
+TEST_P(OwnedImplTest, MoveBetweenImplementations) {
+  Buffer::OwnedImpl buffer1("hello");
+  verifyImplementation(buffer1);
+  OwnedImpl::useOldImpl(GetParam() != BufferImplementation::Old);
+  Buffer::OwnedImpl buffer2(" world");
+  EXPECT_NE(buffer1.usesOldImpl(), buffer2.usesOldImpl());
+
+  buffer1.move(buffer2, 3);
+  EXPECT_EQ("hello wo", buffer1.toString());
+  buffer1.move(buffer2);
+  EXPECT_EQ("hello world", buffer1.toString());
+  EXPECT_EQ(0, buffer2.length());
+
+  buffer2.add("!");
+  buffer2.prepend(buffer1);
+  EXPECT_EQ("hello world!", buffer2.toString());
+  EXPECT_EQ(0, buffer1.length());
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
@@ -0,0 +1,224 @@
+#include "common/buffer/buffer_impl.h"
+#include "common/buffer/slab_pool.h"
+#include "common/buffer/watermark_buffer.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+namespace {
+
+class SlabPoolTest : public testing::Test {
+public:
+  SlabPoolTest() : pool_(4 * SlabPool::PageSize) {
+    previous_pool_ = SlabPool::setThreadLocal(&pool_);
+  }
+
+  ~SlabPoolTest() { SlabPool::setThreadLocal(previous_pool_); }
+
+  SlabPool pool_;
+  SlabPool* previous_pool_;
+};
+
+TEST(SlabPoolNoPoolTest, AllocateWithoutPool) {
+  ASSERT_EQ(nullptr, SlabPool::threadLocal());
+  const uint64_t hits = SlabPool::totalHits();
+  const uint64_t misses = SlabPool::totalMisses();
+  void* block = SlabPool::allocate(100);
+  ASSERT_NE(nullptr, block);
+  SlabPool::deallocate(block);
+  SlabPool::deallocate(nullptr);
+  EXPECT_EQ(hits, SlabPool::totalHits());
+  EXPECT_EQ(misses, SlabPool::totalMisses());
+}
+
+TEST(SlabPoolNoPoolTest, UsableSize) {
+  EXPECT_EQ(SlabPool::PageSize - SlabPool::HeaderSize, SlabPool::usableSize(1));
+  EXPECT_EQ(SlabPool::PageSize - SlabPool::HeaderSize,
+            SlabPool::usableSize(SlabPool::PageSize - SlabPool::HeaderSize));
+  EXPECT_EQ(2 * SlabPool::PageSize - SlabPool::HeaderSize,
+            SlabPool::usableSize(SlabPool::PageSize - SlabPool::HeaderSize + 1));
+}
+
+TEST_F(SlabPoolTest, ReuseReleasedBlocks) {
+  const uint64_t hits = SlabPool::totalHits();
+  const uint64_t misses = SlabPool::totalMisses();
+
+  void* block = SlabPool::allocate(100);
+  EXPECT_EQ(misses + 1, SlabPool::totalMisses());
+  SlabPool::deallocate(block);
+  EXPECT_EQ(SlabPool::PageSize, pool_.cachedBytes());
+
+  // A block of a different size class is not served from the cached block.
+  void* large_block = SlabPool::allocate(2 * SlabPool::PageSize);
+  EXPECT_EQ(misses + 2, SlabPool::totalMisses());
+  SlabPool::deallocate(large_block);
+  EXPECT_EQ(4 * SlabPool::PageSize, pool_.cachedBytes());
+
+  // The most recently released block of the right size is reused.
+  EXPECT_EQ(block, SlabPool::allocate(200));
+  EXPECT_EQ(hits + 1, SlabPool::totalHits());
+  EXPECT_EQ(3 * SlabPool::PageSize, pool_.cachedBytes());
+  SlabPool::deallocate(block);
+}
+
+TEST_F(SlabPoolTest, MaxCachedBytes) {
+  void* block1 = SlabPool::allocate(3 * SlabPool::PageSize - SlabPool::HeaderSize);
+  void* block2 = SlabPool::allocate(2 * SlabPool::PageSize - SlabPool::HeaderSize);
+  SlabPool::deallocate(block1);
+  EXPECT_EQ(3 * SlabPool::PageSize, pool_.cachedBytes());
+
+  // Caching the second block would exceed the pool's limit, so it goes back to the heap.
+  SlabPool::deallocate(block2);
+  EXPECT_EQ(3 * SlabPool::PageSize, pool_.cachedBytes());
+
+  pool_.release();
+  EXPECT_EQ(0, pool_.cachedBytes());
+}
+
+TEST_F(SlabPoolTest, LargeBlocksBypassPool) {
+  const uint64_t misses = SlabPool::totalMisses();
+  void* block = SlabPool::allocate(SlabPool::MaxPooledPages * SlabPool::PageSize);
+  EXPECT_EQ(misses, SlabPool::totalMisses());
+  SlabPool::deallocate(block);
+  EXPECT_EQ(0, pool_.cachedBytes());
+}
+
+// Each pool counts its own hits and misses, and the totals include pools that were destroyed.
+TEST_F(SlabPoolTest, PerPoolCounters) {
+  const uint64_t hits = SlabPool::totalHits();
+  const uint64_t misses = SlabPool::totalMisses();
+  {
+    SlabPool other_pool;
+    SlabPool::setThreadLocal(&other_pool);
+    void* block = SlabPool::allocate(100);
+    SlabPool::deallocate(block);
+    EXPECT_EQ(block, SlabPool::allocate(100));
+    SlabPool::deallocate(block);
+    SlabPool::setThreadLocal(&pool_);
+
+    EXPECT_EQ(1, other_pool.hits());
+    EXPECT_EQ(1, other_pool.misses());
+    EXPECT_EQ(0, pool_.hits());
+    EXPECT_EQ(0, pool_.misses());
+    EXPECT_EQ(hits + 1, SlabPool::totalHits());
+    EXPECT_EQ(misses + 1, SlabPool::totalMisses());
+    EXPECT_EQ(SlabPool::PageSize, SlabPool::totalCachedBytes());
+  }
+  EXPECT_EQ(hits + 1, SlabPool::totalHits());
+  EXPECT_EQ(misses + 1, SlabPool::totalMisses());
+  EXPECT_EQ(0, SlabPool::totalCachedBytes());
+}
+
+// Bytes in use are counted per pool, so a block released on another thread only balances the total.
+TEST_F(SlabPoolTest, InUseBytes) {
+  const uint64_t in_use_bytes = SlabPool::totalInUseBytes();
+  void* block = SlabPool::allocate(SlabPool::PageSize);
+  EXPECT_EQ(in_use_bytes + 2 * SlabPool::PageSize, SlabPool::totalInUseBytes());
+  EXPECT_EQ(in_use_bytes + 2 * SlabPool::PageSize + pool_.cachedBytes(),
+            SlabPool::totalResidentBytes());
+  {
+    SlabPool other_pool;
+    SlabPool::setThreadLocal(&other_pool);
+    SlabPool::deallocate(block);
+    SlabPool::setThreadLocal(&pool_);
+    EXPECT_EQ(in_use_bytes, SlabPool::totalInUseBytes());
+  }
+  EXPECT_EQ(in_use_bytes, SlabPool::totalInUseBytes());
+}
+
+// Blocks cached for a whole interval are released, while blocks reused during it are kept.
+TEST_F(SlabPoolTest, ReleaseIdle) {
+  void* block1 = SlabPool::allocate(100);
+  void* block2 = SlabPool::allocate(100);
+  SlabPool::deallocate(block1);
+  SlabPool::deallocate(block2);
+  EXPECT_EQ(2 * SlabPool::PageSize, pool_.cachedBytes());
+
+  // Nothing has been cached for a full interval yet.
+  pool_.releaseIdle();
+  EXPECT_EQ(2 * SlabPool::PageSize, pool_.cachedBytes());
+
+  // Only one of the two blocks is reused during the next interval.
+  EXPECT_EQ(block2, SlabPool::allocate(100));
+  SlabPool::deallocate(block2);
+  pool_.releaseIdle();
+  EXPECT_EQ(SlabPool::PageSize, pool_.cachedBytes());
+  EXPECT_EQ(block2, SlabPool::allocate(100));
+  SlabPool::deallocate(block2);
+
+  // The remaining block goes unused for an interval.
+  pool_.releaseIdle();
+  EXPECT_EQ(SlabPool::PageSize, pool_.cachedBytes());
+  pool_.releaseIdle();
+  EXPECT_EQ(0, pool_.cachedBytes());
+}
+
+// A low watermark trims the current pool to half its limit, largest blocks first.
+TEST_F(SlabPoolTest, LowWatermarkTrims) {
+  void* small_block = SlabPool::allocate(100);
+  void* large_block = SlabPool::allocate(3 * SlabPool::PageSize - SlabPool::HeaderSize);
+  SlabPool::deallocate(small_block);
+  SlabPool::deallocate(large_block);
+  EXPECT_EQ(4 * SlabPool::PageSize, pool_.cachedBytes());
+
+  SlabPool::onLowWatermark();
+  EXPECT_EQ(SlabPool::PageSize, pool_.cachedBytes());
+  EXPECT_EQ(small_block, SlabPool::allocate(100));
+  SlabPool::deallocate(small_block);
+
+  // Already below half the limit.
+  SlabPool::onLowWatermark();
+  EXPECT_EQ(SlabPool::PageSize, pool_.cachedBytes());
+}
+
+TEST_F(SlabPoolTest, BlocksMoveBetweenPools) {
+  void* block = SlabPool::allocate(100);
+  SlabPool other_pool;
+  SlabPool::setThreadLocal(&other_pool);
+  SlabPool::deallocate(block);
+  EXPECT_EQ(SlabPool::PageSize, other_pool.cachedBytes());
+  EXPECT_EQ(0, pool_.cachedBytes());
+  SlabPool::setThreadLocal(&pool_);
+}
+
+// Draining a buffer that uses the native implementation returns its slices to the pool, and the
+// next buffer reuses them.
+TEST_F(SlabPoolTest, BufferSlicesRecycled) {
+  OwnedImpl::useOldImpl(false);
+  {
+    OwnedImpl buffer;
+    buffer.add(std::string(100, 'a'));
+    EXPECT_EQ(0, pool_.cachedBytes());
+    buffer.drain(buffer.length());
+    EXPECT_EQ(SlabPool::PageSize, pool_.cachedBytes());
+
+    const uint64_t hits = SlabPool::totalHits();
+    OwnedImpl buffer2;
+    buffer2.add(std::string(100, 'b'));
+    EXPECT_EQ(hits + 1, SlabPool::totalHits());
+    EXPECT_EQ(0, pool_.cachedBytes());
+  }
+  EXPECT_EQ(SlabPool::PageSize, pool_.cachedBytes());
+  OwnedImpl::useOldImpl(true);
+}
+
+// A watermark buffer draining below its low watermark trims the pool its slices went back to.
+TEST_F(SlabPoolTest, WatermarkBufferTrimsPool) {
+  OwnedImpl::useOldImpl(false);
+  {
+    WatermarkBuffer buffer([]() -> void {}, []() -> void {});
+    buffer.setWatermarks(2 * SlabPool::PageSize);
+    for (int i = 0; i < 4; i++) {
+      buffer.add(std::string(SlabPool::PageSize - SlabPool::HeaderSize - 64, 'a'));
+    }
+    EXPECT_EQ(0, pool_.cachedBytes());
+    buffer.drain(buffer.length());
+    EXPECT_EQ(2 * SlabPool::PageSize, pool_.cachedBytes());
+  }
+  OwnedImpl::useOldImpl(true);
+}
+
+} // namespace
+} // namespace Buffer
+} // namespace Envoy
@@ -10,6 +10,37 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
+/** Used to specify which OwnedImpl implementation to test. */
+enum class BufferImplementation {
+  Old, // original libevent-based implementation
+  New  // new native implementation
+};
+
+/**
+ * Base class for tests that are parameterized based on BufferImplementation.
+ */
+class BufferImplementationParamTest : public testing::TestWithParam<BufferImplementation> {
+protected:
+  BufferImplementationParamTest() {
+    OwnedImpl::useOldImpl(GetParam() == BufferImplementation::Old);
+  }
+
+  // Restore the default implementation for tests that are not parameterized.
+  ~BufferImplementationParamTest() override { OwnedImpl::useOldImpl(true); }
+
+  /** Verify that a buffer has been constructed using the expected implementation. */
+  void verifyImplementation(const OwnedImpl& buffer) {
+    switch (GetParam()) {
+    case BufferImplementation::Old:
+      ASSERT_TRUE(buffer.usesOldImpl());
+      break;
+    case BufferImplementation::New:
+      ASSERT_FALSE(buffer.usesOldImpl());
+      break;
+    }
+  }
+};
+
 inline void addRepeated(Buffer::Instance& buffer, int n, int8_t value) {
   for (int i = 0; i < n; i++) {
     buffer.add(&value, 1);
@@ -3,6 +3,8 @@
 #include "common/buffer/buffer_impl.h"
 #include "common/buffer/watermark_buffer.h"
 
+#include "test/common/buffer/utility.h"
+
 #include "gtest/gtest.h"
 
 namespace Envoy {
@@ -11,9 +13,12 @@ namespace {
 
 const char TEN_BYTES[] = "0123456789";
 
-class WatermarkBufferTest : public testing::Test {
+class WatermarkBufferTest : public BufferImplementationParamTest {
 public:
-  WatermarkBufferTest() { buffer_.setWatermarks(5, 10); }
+  WatermarkBufferTest() {
+    verifyImplementation(buffer_);
+    buffer_.setWatermarks(5, 10);
+  }
 
   Buffer::WatermarkBuffer buffer_{[&]() -> void { ++times_low_watermark_called_; },
                                   [&]() -> void { ++times_high_watermark_called_; }};
@@ -21,9 +26,12 @@ public:
   uint32_t times_high_watermark_called_{0};
 };
 
-TEST_F(WatermarkBufferTest, TestWatermark) { ASSERT_EQ(10, buffer_.highWatermark()); }
+INSTANTIATE_TEST_SUITE_P(WatermarkBufferTest, WatermarkBufferTest,
+                         testing::ValuesIn({BufferImplementation::Old, BufferImplementation::New}));
+
+TEST_P(WatermarkBufferTest, TestWatermark) { ASSERT_EQ(10, buffer_.highWatermark()); }
 
-TEST_F(WatermarkBufferTest, CopyOut) {
+TEST_P(WatermarkBufferTest, CopyOut) {
   buffer_.add("hello world");
   std::array<char, 5> out;
   buffer_.copyOut(0, out.size(), out.data());
@@ -36,7 +44,7 @@ TEST_F(WatermarkBufferTest, CopyOut) {
   buffer_.copyOut(4, 0, out.data());
 }
 
-TEST_F(WatermarkBufferTest, AddChar) {
+TEST_P(WatermarkBufferTest, AddChar) {
   buffer_.add(TEN_BYTES, 10);
   EXPECT_EQ(0, times_high_watermark_called_);
   buffer_.add("a", 1);
@@ -44,7 +52,7 @@ TEST_F(WatermarkBufferTest, AddChar) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, AddString) {
+TEST_P(WatermarkBufferTest, AddString) {
   buffer_.add(std::string(TEN_BYTES));
   EXPECT_EQ(0, times_high_watermark_called_);
   buffer_.add(std::string("a"));
@@ -52,7 +60,7 @@ TEST_F(WatermarkBufferTest, AddString) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, AddBuffer) {
+TEST_P(WatermarkBufferTest, AddBuffer) {
   OwnedImpl first(TEN_BYTES);
   buffer_.add(first);
   EXPECT_EQ(0, times_high_watermark_called_);
@@ -62,7 +70,7 @@ TEST_F(WatermarkBufferTest, AddBuffer) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, Prepend) {
+TEST_P(WatermarkBufferTest, Prepend) {
   std::string suffix = "World!", prefix = "Hello, ";
 
   buffer_.add(suffix);
@@ -72,7 +80,7 @@ TEST_F(WatermarkBufferTest, Prepend) {
   EXPECT_EQ(suffix.size() + prefix.size(), buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, PrependToEmptyBuffer) {
+TEST_P(WatermarkBufferTest, PrependToEmptyBuffer) {
   std::string suffix = "World!", prefix = "Hello, ";
 
   buffer_.prepend(suffix);
@@ -88,7 +96,7 @@ TEST_F(WatermarkBufferTest, PrependToEmptyBuffer) {
   EXPECT_EQ(suffix.size() + prefix.size(), buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, PrependBuffer) {
+TEST_P(WatermarkBufferTest, PrependBuffer) {
   std::string suffix = "World!", prefix = "Hello, ";
 
   uint32_t prefix_buffer_low_watermark_hits{0};
@@ -109,7 +117,7 @@ TEST_F(WatermarkBufferTest, PrependBuffer) {
   EXPECT_EQ(0, prefixBuffer.length());
 }
 
-TEST_F(WatermarkBufferTest, Commit) {
+TEST_P(WatermarkBufferTest, Commit) {
   buffer_.add(TEN_BYTES, 10);
   EXPECT_EQ(0, times_high_watermark_called_);
   RawSlice out;
@@ -121,7 +129,7 @@ TEST_F(WatermarkBufferTest, Commit) {
   EXPECT_EQ(20, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, Drain) {
+TEST_P(WatermarkBufferTest, Drain) {
   // Draining from above to below the low watermark does nothing if the high
   // watermark never got hit.
   buffer_.add(TEN_BYTES, 10);
@@ -144,7 +152,7 @@ TEST_F(WatermarkBufferTest, Drain) {
   EXPECT_EQ(2, times_high_watermark_called_);
 }
 
-TEST_F(WatermarkBufferTest, MoveFullBuffer) {
+TEST_P(WatermarkBufferTest, MoveFullBuffer) {
   buffer_.add(TEN_BYTES, 10);
   OwnedImpl data("a");
 
@@ -154,7 +162,7 @@ TEST_F(WatermarkBufferTest, MoveFullBuffer) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, MoveOneByte) {
+TEST_P(WatermarkBufferTest, MoveOneByte) {
   buffer_.add(TEN_BYTES, 9);
   OwnedImpl data("ab");
 
@@ -167,7 +175,7 @@ TEST_F(WatermarkBufferTest, MoveOneByte) {
   EXPECT_EQ(11, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, WatermarkFdFunctions) {
+TEST_P(WatermarkBufferTest, WatermarkFdFunctions) {
   int pipe_fds[2] = {0, 0};
   ASSERT_EQ(0, pipe(pipe_fds));
 
@@ -198,7 +206,7 @@ TEST_F(WatermarkBufferTest, WatermarkFdFunctions) {
   EXPECT_EQ(20, buffer_.length());
 }
 
-TEST_F(WatermarkBufferTest, MoveWatermarks) {
+TEST_P(WatermarkBufferTest, MoveWatermarks) {
   buffer_.add(TEN_BYTES, 9);
   EXPECT_EQ(0, times_high_watermark_called_);
   buffer_.setWatermarks(1, 9);
@@ -222,7 +230,7 @@ TEST_F(WatermarkBufferTest, MoveWatermarks) {
   EXPECT_EQ(2, times_low_watermark_called_);
 }
 
-TEST_F(WatermarkBufferTest, GetRawSlices) {
+TEST_P(WatermarkBufferTest, GetRawSlices) {
   buffer_.add(TEN_BYTES, 10);
 
   RawSlice slices[2];
@@ -234,7 +242,7 @@ TEST_F(WatermarkBufferTest, GetRawSlices) {
   EXPECT_EQ(data_pointer, slices[0].mem_);
 }
 
-TEST_F(WatermarkBufferTest, Search) {
+TEST_P(WatermarkBufferTest, Search) {
   buffer_.add(TEN_BYTES, 10);
 
   EXPECT_EQ(1, buffer_.search(&TEN_BYTES[1], 2, 0));
@@ -242,7 +250,7 @@ TEST_F(WatermarkBufferTest, Search) {
   EXPECT_EQ(-1, buffer_.search(&TEN_BYTES[1], 2, 5));
 }
 
-TEST_F(WatermarkBufferTest, MoveBackWithWatermarks) {
+TEST_P(WatermarkBufferTest, MoveBackWithWatermarks) {
   int high_watermark_buffer1 = 0;
   int low_watermark_buffer1 = 0;
   Buffer::WatermarkBuffer buffer1{[&]() -> void { ++low_watermark_buffer1; },
@@ -0,0 +1,80 @@
+#include "envoy/common/exception.h"
+
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+class RegexTest : public testing::TestWithParam<Engine> {
+protected:
+  ~RegexTest() {
+    Utility::setEngine(Engine::StdRegex);
+    Utility::setMaxProgramSize(Utility::DefaultMaxProgramSize);
+  }
+
+  CompiledMatcherPtr parse(const std::string& regex) {
+    return Utility::parseRegex(regex, GetParam());
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(RegexEngines, RegexTest,
+                         testing::Values(Engine::StdRegex, Engine::Re2));
+
+TEST_P(RegexTest, MatchesWholeValue) {
+  CompiledMatcherPtr matcher = parse("/foo/[0-9]+");
+  EXPECT_TRUE(matcher->match("/foo/123"));
+  EXPECT_FALSE(matcher->match("/foo/123/bar"));
+  EXPECT_FALSE(matcher->match("/bar/foo/123"));
+  EXPECT_FALSE(matcher->match("/foo/"));
+}
+
+TEST_P(RegexTest, MatchesStringView) {
+  const std::string value = "/foo/123?bar";
+  CompiledMatcherPtr matcher = parse("/foo/[0-9]+");
+  EXPECT_TRUE(matcher->match(absl::string_view(value).substr(0, value.find('?'))));
+  EXPECT_FALSE(matcher->match(value));
+}
+
+TEST_P(RegexTest, EmptyValue) {
+  EXPECT_TRUE(parse(".*")->match(""));
+  EXPECT_FALSE(parse(".+")->match(""));
+}
+
+TEST_P(RegexTest, InvalidRegex) {
+  EXPECT_THROW_WITH_REGEX(parse("(+invalid)"), EnvoyException, "Invalid regex '\\(\\+invalid\\)'");
+}
+
+TEST_P(RegexTest, ParseWithSelectedEngine) {
+  Utility::setEngine(GetParam());
+  EXPECT_EQ(GetParam(), Utility::engine());
+  EXPECT_TRUE(Utility::parseRegex("a|b")->match("b"));
+}
+
+TEST(Re2Test, ProgramSizeLimit) {
+  const std::string regex = "/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*";
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex(regex, Engine::Re2), EnvoyException,
+                          "RE2 program size of [0-9]+ > max program size of 100");
+
+  Utility::setMaxProgramSize(1000);
+  EXPECT_TRUE(Utility::parseRegex(regex, Engine::Re2)->match("/asdf/a/asdf/b/asdf/c/asdf/d/asdf/e"
+                                                              "/asdf/f/asdf/g/asdf/h"));
+  Utility::setMaxProgramSize(Utility::DefaultMaxProgramSize);
+
+  // The limit only applies to RE2.
+  EXPECT_NO_THROW(Utility::parseRegex(regex, Engine::StdRegex));
+}
+
+TEST(Re2Test, UnsupportedSyntax) {
+  // Backreferences need backtracking, which RE2 does not do.
+  EXPECT_NO_THROW(Utility::parseRegex("(a)\\1", Engine::StdRegex));
+  EXPECT_THROW(Utility::parseRegex("(a)\\1", Engine::Re2), EnvoyException);
+}
+
+} // namespace
+} // namespace Regex
+} // namespace Envoy
@@ -176,6 +176,29 @@ TEST_F(FileSystemImplTest, NonExistingFile) {
   EXPECT_EQ(" new data", contents);
 }
 
+TEST_F(FileSystemImplTest, Writev) {
+  const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
+  ::unlink(new_file_path.c_str());
+
+  {
+    FilePtr file = file_system_.createFile(new_file_path);
+    const Api::SysCallBoolResult open_result = file->open();
+    EXPECT_TRUE(open_result.rc_);
+    std::string first("first ");
+    std::string second("second");
+    iovec iov[2];
+    iov[0].iov_base = &first[0];
+    iov[0].iov_len = first.size();
+    iov[1].iov_base = &second[0];
+    iov[1].iov_len = second.size();
+    const Api::SysCallSizeResult result = file->writev(iov, 2);
+    EXPECT_EQ(first.length() + second.length(), result.rc_);
+  }
+
+  auto contents = TestEnvironment::readFileToStringForTest(new_file_path);
+  EXPECT_EQ("first second", contents);
+}
+
 TEST_F(FileSystemImplTest, Close) {
   const std::string new_file_path = TestEnvironment::temporaryPath("envoy_this_not_exist");
   ::unlink(new_file_path.c_str());
@@ -74,6 +74,14 @@ public:
   MOCK_METHOD0(createCodecClient_, CodecClient*());
   MOCK_METHOD0(onClientDestroy, void());
 
+  size_t freePendingRequests() const { return free_pending_requests_.size(); }
+  bool upstreamReadyEnabled() const { return upstream_ready_enabled_; }
+
+  // Sets a health flag on the pool's host, as a health checker or outlier detector would.
+  void setHostHealthFlag(Upstream::Host::HealthFlag flag) {
+    std::const_pointer_cast<Upstream::Host>(host_)->healthFlagSet(flag);
+  }
+
   void expectClientCreate() {
     test_clients_.emplace_back();
     TestCodecClient& test_client = test_clients_.back();
@@ -289,6 +297,32 @@ TEST_F(Http1ConnPoolImplTest, MultipleRequestAndResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that the connection which became idle most recently is the first one reused.
+ */
+TEST_F(Http1ConnPoolImplTest, MostRecentlyUsedConnectionReused) {
+  cluster_->resetResourceManager(2, 1024, 1024, 1);
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::CreateConnection);
+  r2.startRequest();
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+
+  // Client 1 went idle last, so it serves the next request.
+  ActiveTestRequest r3(*this, 1, ActiveTestRequest::Type::Immediate);
+  r3.startRequest();
+  r3.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test when we overflow max pending requests.
  */
@@ -398,6 +432,61 @@ TEST_F(Http1ConnPoolImplTest, CancelBeforeBound) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a cancelled pending request is recycled for the next queued request.
+ */
+TEST_F(Http1ConnPoolImplTest, PendingRequestReusedAfterCancel) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1);
+  InSequence s;
+
+  NiceMock<Http::MockStreamDecoder> outer_decoder;
+  ConnPoolCallbacks callbacks;
+  conn_pool_.expectClientCreate();
+  Http::ConnectionPool::Cancellable* handle = conn_pool_.newStream(outer_decoder, callbacks);
+  EXPECT_NE(nullptr, handle);
+  handle->cancel();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+
+  NiceMock<Http::MockStreamDecoder> outer_decoder2;
+  ConnPoolCallbacks callbacks2;
+  Http::ConnectionPool::Cancellable* handle2 = conn_pool_.newStream(outer_decoder2, callbacks2);
+  EXPECT_EQ(handle, handle2);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pending_active_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_pending_total_.value());
+  handle2->cancel();
+
+  // Cause the connection to go away.
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that only a bounded number of released pending requests are kept for reuse.
+ */
+TEST_F(Http1ConnPoolImplTest, FreePendingRequestsBounded) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1);
+  InSequence s;
+
+  NiceMock<Http::MockStreamDecoder> outer_decoder;
+  ConnPoolCallbacks callbacks;
+  conn_pool_.expectClientCreate();
+  std::vector<Http::ConnectionPool::Cancellable*> handles;
+  for (size_t i = 0; i < 100; ++i) {
+    handles.push_back(conn_pool_.newStream(outer_decoder, callbacks));
+  }
+  for (Http::ConnectionPool::Cancellable* handle : handles) {
+    handle->cancel();
+  }
+  EXPECT_EQ(64U, conn_pool_.freePendingRequests());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+
+  // Cause the connection to go away.
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test an upstream disconnection while there is a bound request.
  */
@@ -644,6 +733,224 @@ TEST_F(Http1ConnPoolImplTest, ConcurrentConnections) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a prefetch ratio opens a spare connection, which then serves the next request.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchSpareConnection) {
+  cluster_->resetResourceManager(2, 1024, 1024, 1);
+  cluster_->per_upstream_prefetch_ratio_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  // One connection is in use, so a second one is prefetched.
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Immediate);
+  r2.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_prefetch_hit_.value());
+
+  // Prefetching stops at the connection limit.
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+
+  // Connections closed by the host are not replaced.
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that warm connections are kept open and that a request waits for a prefetched connection
+ * that is still connecting rather than opening another one.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchMinWarmConnections) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r2(*this, 1, ActiveTestRequest::Type::Pending);
+
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  r2.expectNewStream();
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r2.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_prefetch_hit_.value());
+
+  // Both connections are in use, which satisfies the warm connection minimum.
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  r1.completeResponse(false);
+  r2.completeResponse(false);
+
+  // Connections closed by the host are not replaced.
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that a warm connection that is closed locally is replaced.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchReplacesClosedWarmConnection) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The idle warm connection is closed locally without any new request arriving.
+  conn_pool_.expectEnableUpstreamReady();
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::LocalClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  r1.completeResponse(false);
+
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that a host refusing the prefetched connection is not reconnected to until a request
+ * arrives.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchNotRetriedAfterConnectFailure) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_connect_fail_.value());
+
+  r1.completeResponse(false);
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+}
+
+/**
+ * Test that the connections drained on a host health failure are not reopened, and that the pool
+ * does not prefetch to the host while it is unhealthy.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchStopsOnHostHealthFailure) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r1.completeResponse(false);
+
+  // This is what ThreadLocalClusterManagerImpl::onHostHealthFailure() does.
+  conn_pool_.setHostHealthFlag(Upstream::Host::HealthFlag::FAILED_ACTIVE_HC);
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.drainConnections();
+  dispatcher_.clearDeferredDeleteList();
+
+  // Drained clients are gone, so the new connection is test client 0 again.
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r2.startRequest();
+  r2.completeResponse(false);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that drained connections are not reopened until the host is picked for a request again.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchSuppressedAfterDrain) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 1;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  conn_pool_.expectAndRunUpstreamReady();
+  r1.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.drainConnections();
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_FALSE(conn_pool_.upstreamReadyEnabled());
+
+  // The next request schedules prefetching again.
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r2.startRequest();
+  conn_pool_.expectAndRunUpstreamReady();
+  r2.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 TEST_F(Http1ConnPoolImplTest, DrainCallback) {
   InSequence s;
   ReadyWatcher drained;
@@ -751,6 +751,24 @@ TEST_P(Http2CodecImplTest, WatermarkUnderEndStream) {
   response_encoder_->encodeHeaders(response_headers, true);
 }
 
+// The client reports the server's concurrent stream limit once the server's SETTINGS arrive.
+TEST_P(Http2CodecImplTest, ClientMaxConcurrentStreams) {
+  initialize();
+
+  TestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  if (server_http2settings_.max_concurrent_streams_ ==
+      Http2Settings::DEFAULT_MAX_CONCURRENT_STREAMS) {
+    // The default is not sent on the wire, so the client still sees no limit.
+    EXPECT_EQ(std::numeric_limits<uint32_t>::max(), client_->maxConcurrentStreams());
+  } else {
+    EXPECT_EQ(server_http2settings_.max_concurrent_streams_, client_->maxConcurrentStreams());
+  }
+}
+
 class Http2CodecImplStreamLimitTest : public Http2CodecImplTest {};
 
 // Regression test for issue #3076.
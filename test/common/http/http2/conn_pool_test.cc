@@ -76,7 +76,8 @@ public:
 
   // Creates a new test client, expecting a new connection to be created and associated
   // with the new client.
-  void expectClientCreate(absl::optional<uint32_t> buffer_limits = {}) {
+  void expectClientCreate(absl::optional<uint32_t> buffer_limits = {},
+                          TestConnPoolImpl* pool = nullptr) {
     test_clients_.emplace_back();
     TestCodecClient& test_client = test_clients_.back();
     test_client.connection_ = new NiceMock<Network::MockClientConnection>();
@@ -95,7 +96,7 @@ public:
       EXPECT_CALL(*cluster_, perConnectionBufferLimitBytes()).WillOnce(Return(*buffer_limits));
       EXPECT_CALL(*test_clients_.back().connection_, setBufferLimits(*buffer_limits));
     }
-    EXPECT_CALL(pool_, createCodecClient_(_))
+    EXPECT_CALL(pool != nullptr ? *pool : pool_, createCodecClient_(_))
         .WillOnce(Invoke([this](Upstream::Host::CreateConnectionData&) -> CodecClient* {
           return test_clients_.back().codec_client_;
         }));
@@ -223,14 +224,14 @@ TEST_F(Http2ConnPoolImplTest, DrainConnections) {
   EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
   r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
 
-  // This will move primary to draining and destroy draining.
+  // This will move the second client to draining alongside the first one.
   pool_.drainConnections();
-  EXPECT_CALL(*this, onClientDestroy());
-  dispatcher_.clearDeferredDeleteList();
+  EXPECT_TRUE(pool_.hasActiveConnections());
 
-  // This will destroy draining.
+  // This will destroy both draining clients.
   test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
-  EXPECT_CALL(*this, onClientDestroy());
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
   dispatcher_.clearDeferredDeleteList();
 }
 
@@ -381,6 +382,9 @@ TEST_F(Http2ConnPoolImplTest, VerifyConnectionTimingStats) {
   test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
   EXPECT_CALL(cluster_->stats_store_,
               deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_length_ms"), _));
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "upstream_cx_http2_peak_concurrent_streams"), 1));
   EXPECT_CALL(*this, onClientDestroy());
   dispatcher_.clearDeferredDeleteList();
 }
@@ -660,6 +664,177 @@ TEST_F(Http2ConnPoolImplTest, GoAway) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
 }
 
+// Verifies that a second connection is opened once the first one reaches the configured
+// concurrent stream limit, and that new streams go to a connection with room.
+TEST_F(Http2ConnPoolImplTest, ConfiguredStreamLimitOpensNewConnection) {
+  InSequence s;
+  cluster_->http2_settings_.max_concurrent_streams_ = 1;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+
+  // The first connection is at its limit, so this request waits for a new connection.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1, false);
+  expectClientConnect(1, r2);
+
+  // Once r1 completes the first connection has room again, while the second is at its limit.
+  completeRequest(r1);
+  ActiveTestRequest r3(*this, 0, true);
+
+  completeRequest(r2);
+  completeRequest(r3);
+  closeClient(0);
+  closeClient(1);
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_http2_total_.value());
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_max_concurrent_streams_.value());
+}
+
+// Verifies that new streams are balanced onto the connection with the fewest active streams.
+TEST_F(Http2ConnPoolImplTest, NewStreamsGoToLeastLoadedConnection) {
+  InSequence s;
+  cluster_->http2_settings_.max_concurrent_streams_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+  ActiveTestRequest r2(*this, 0, true);
+
+  expectClientCreate();
+  ActiveTestRequest r3(*this, 1, false);
+  expectClientConnect(1, r3);
+
+  // Both connections now have room, the first with one active stream and the second with none.
+  completeRequest(r1);
+  completeRequest(r3);
+  ActiveTestRequest r4(*this, 1, true);
+
+  completeRequest(r2);
+  completeRequest(r4);
+  closeClient(0);
+  closeClient(1);
+}
+
+// Verifies that the peer's SETTINGS_MAX_CONCURRENT_STREAMS caps streams per connection, and that
+// requests left pending by it get a new connection.
+TEST_F(Http2ConnPoolImplTest, PeerStreamLimitOpensNewConnection) {
+  InSequence s;
+
+  expectClientCreate();
+  ON_CALL(*test_clients_[0].codec_, maxConcurrentStreams()).WillByDefault(Return(1));
+  ActiveTestRequest r1(*this, 0, false);
+  ActiveTestRequest r2(*this, 0, false);
+
+  // Only r1 fits on the first connection once it is up.
+  expectStreamConnect(0, r1);
+  expectClientCreate();
+  EXPECT_CALL(*test_clients_[0].connect_timer_, disableTimer());
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  expectClientConnect(1, r2);
+
+  completeRequest(r1);
+  completeRequest(r2);
+  closeClient(0);
+  closeClient(1);
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_max_concurrent_streams_.value());
+}
+
+// Verifies that when the connection circuit breaker prevents a new connection, requests wait
+// for a stream on an existing connection.
+TEST_F(Http2ConnPoolImplTest, BusyConnectionServesPendingRequest) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1);
+  InSequence s;
+  cluster_->http2_settings_.max_concurrent_streams_ = 1;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+
+  ActiveTestRequest r2(*this, 0, false);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  // Completing r1 frees a stream on the connection, which r2 then takes.
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectStreamConnect(0, r2);
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  completeRequest(r2);
+  closeClient(0);
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_http2_total_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_max_concurrent_streams_.value());
+}
+
+// Verifies that a connection closing with requests pending only opens a replacement within the
+// connection circuit breaker when other connections remain to serve them.
+TEST_F(Http2ConnPoolImplTest, CloseWithPendingRequestsRespectsConnectionLimit) {
+  cluster_->resetResourceManager(2, 1024, 1024, 1);
+  cluster_->http2_settings_.max_concurrent_streams_ = 1;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0, false);
+  expectClientConnect(0, r1);
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1, false);
+  expectClientConnect(1, r2);
+
+  // Both connections are at their stream limit and no third one may be opened.
+  ActiveTestRequest r3(*this, 0, false);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  // The first connection closing doesn't open another one past the limit either.
+  EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _)).Times(0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  closeClient(0);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  // r3 takes the stream r2 frees on the remaining connection.
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectStreamConnect(1, r3);
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  completeRequest(r3);
+  closeClient(1);
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_http2_total_.value());
+}
+
+// Verifies that destroying the pool with requests pending opens no replacement connections.
+TEST_F(Http2ConnPoolImplTest, DestroyWithPendingRequestsOpensNoConnection) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1);
+  cluster_->http2_settings_.max_concurrent_streams_ = 1;
+  auto pool = std::make_unique<TestConnPoolImpl>(dispatcher_, host_,
+                                                 Upstream::ResourcePriority::Default, nullptr);
+
+  expectClientCreate({}, pool.get());
+  Http::MockStreamDecoder decoder1;
+  ConnPoolCallbacks callbacks1;
+  EXPECT_NE(nullptr, pool->newStream(decoder1, callbacks1));
+  NiceMock<Http::MockStreamEncoder> encoder1;
+  EXPECT_CALL(*test_clients_[0].codec_, newStream(_)).WillOnce(ReturnRef(encoder1));
+  EXPECT_CALL(callbacks1.pool_ready_, ready());
+  EXPECT_CALL(*test_clients_[0].connect_timer_, disableTimer());
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The connection is busy, and the circuit breaker allows no other, so this request waits.
+  Http::MockStreamDecoder decoder2;
+  ConnPoolCallbacks callbacks2;
+  EXPECT_NE(nullptr, pool->newStream(decoder2, callbacks2));
+
+  EXPECT_CALL(dispatcher_, createClientConnection_(_, _, _, _)).Times(0);
+  EXPECT_CALL(*this, onClientDestroy());
+  pool.reset();
+}
+
 TEST_F(Http2ConnPoolImplTest, NoActiveConnectionsByDefault) {
   EXPECT_FALSE(pool_.hasActiveConnections());
 }
@@ -0,0 +1,175 @@
+// Usage: bazel run //test/common/http/http2:shared_conn_pool_benchmark
+
+#include <chrono>
+#include <memory>
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/event/libevent.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+// A stand-in for an upstream HTTP/2 stream. It responds as soon as the request ends, so the timing
+// only covers the pool and, when shared, the handoff between workers.
+class StubStream : public StreamEncoder, public Stream {
+public:
+  StubStream(StreamDecoder& decoder) : decoder_(decoder) {}
+
+  // StreamEncoder
+  void encode100ContinueHeaders(const HeaderMap&) override {}
+  void encodeHeaders(const HeaderMap&, bool end_stream) override {
+    if (end_stream) {
+      decoder_.decodeHeaders(HeaderMapPtr{new HeaderMapImpl{{Headers::get().Status, "200"}}},
+                             true);
+    }
+  }
+  void encodeData(Buffer::Instance&, bool) override {}
+  void encodeTrailers(const HeaderMap&) override {}
+  void encodeMetadata(const MetadataMapVector&) override {}
+  Stream& getStream() override { return *this; }
+
+  // Stream
+  void addCallbacks(StreamCallbacks&) override {}
+  void removeCallbacks(StreamCallbacks&) override {}
+  void resetStream(StreamResetReason) override {}
+  void readDisable(bool) override {}
+  uint32_t bufferLimit() override { return 0; }
+
+private:
+  StreamDecoder& decoder_;
+};
+
+// A pool that binds each stream to a stub stream immediately, as a pool with a ready connection
+// would. Only one stream is in flight at a time.
+class StubPool : public ConnectionPool::Instance {
+public:
+  // ConnectionPool::Instance
+  Http::Protocol protocol() const override { return Http::Protocol::Http2; }
+  void addDrainedCallback(DrainedCb) override {}
+  void drainConnections() override {}
+  bool hasActiveConnections() const override { return false; }
+  ConnectionPool::Cancellable* newStream(StreamDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override {
+    stream_ = std::make_unique<StubStream>(response_decoder);
+    callbacks.onPoolReady(*stream_, nullptr);
+    return nullptr;
+  }
+
+private:
+  std::unique_ptr<StubStream> stream_;
+};
+
+// Sends a header only request once the stream is ready, and exits the dispatcher loop once the
+// response has arrived.
+class Request : public StreamDecoder, public ConnectionPool::Callbacks {
+public:
+  Request(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  // StreamDecoder
+  void decode100ContinueHeaders(HeaderMapPtr&&) override {}
+  void decodeHeaders(HeaderMapPtr&&, bool end_stream) override {
+    if (end_stream) {
+      dispatcher_.exit();
+    }
+  }
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeTrailers(HeaderMapPtr&&) override {}
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+  // ConnectionPool::Callbacks
+  void onPoolFailure(ConnectionPool::PoolFailureReason,
+                     Upstream::HostDescriptionConstSharedPtr) override {
+    dispatcher_.exit();
+  }
+  void onPoolReady(StreamEncoder& encoder, Upstream::HostDescriptionConstSharedPtr) override {
+    encoder.encodeHeaders(headers_, true);
+  }
+
+private:
+  Event::Dispatcher& dispatcher_;
+  HeaderMapImpl headers_{{Headers::get().Method, "GET"},
+                         {Headers::get().Path, "/"},
+                         {Headers::get().Host, "host"}};
+};
+
+// Keeps a dispatcher's event loop running while it has nothing else to do.
+Event::TimerPtr keepAlive(Event::Dispatcher& dispatcher) {
+  Event::TimerPtr timer = dispatcher.createTimer([]() -> void {});
+  timer->enableTimer(std::chrono::hours(1));
+  return timer;
+}
+
+// Times one request and response through the owning worker's pool, without a handoff. This is the
+// baseline for BM_SharedConnPoolRoundTrip.
+void BM_OwnerConnPoolRoundTrip(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher();
+  Event::TimerPtr keep_alive = keepAlive(*dispatcher);
+  StubPool pool;
+  Request request(*dispatcher);
+
+  for (auto _ : state) {
+    pool.newStream(request, request);
+    dispatcher->run(Event::Dispatcher::RunType::Block);
+  }
+}
+BENCHMARK(BM_OwnerConnPoolRoundTrip);
+
+// Times one request and response handed off from a worker to the pool on an owning worker, which
+// runs its own event loop on another thread. The difference from BM_OwnerConnPoolRoundTrip is the
+// latency that sharing connections adds to each stream.
+void BM_SharedConnPoolRoundTrip(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher();
+  Event::DispatcherPtr owner_dispatcher = api->allocateDispatcher();
+  Event::TimerPtr keep_alive = keepAlive(*dispatcher);
+  Event::TimerPtr owner_keep_alive = keepAlive(*owner_dispatcher);
+  StubPool owner_pool;
+  Thread::ThreadPtr owner_thread = api->threadFactory().createThread(
+      [&owner_dispatcher]() -> void { owner_dispatcher->run(Event::Dispatcher::RunType::Block); });
+
+  {
+    SharedConnPoolImpl pool(*dispatcher, *owner_dispatcher,
+                            [&owner_pool]() -> ConnectionPool::Instance* { return &owner_pool; });
+    Request request(*dispatcher);
+
+    for (auto _ : state) {
+      pool.newStream(request, request);
+      dispatcher->run(Event::Dispatcher::RunType::Block);
+    }
+  }
+
+  // Let the owning worker release its side of the last stream before stopping it.
+  owner_dispatcher->post([&owner_dispatcher]() -> void { owner_dispatcher->exit(); });
+  owner_thread->join();
+  owner_keep_alive.reset();
+}
+BENCHMARK(BM_SharedConnPoolRoundTrip);
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_context(spdlog::level::warn,
+                                         Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+  Envoy::Event::Libevent::Global::initialize();
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,300 @@
+#include <list>
+#include <memory>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
+
+#include "test/common/http/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+class Http2SharedConnPoolImplTest : public testing::Test {
+public:
+  Http2SharedConnPoolImplTest() {
+    // Posts are queued so that each test controls when each worker runs.
+    ON_CALL(dispatcher_, post(_)).WillByDefault(Invoke([this](Event::PostCb cb) -> void {
+      posts_.push_back(cb);
+    }));
+    ON_CALL(owner_dispatcher_, post(_)).WillByDefault(Invoke([this](Event::PostCb cb) -> void {
+      owner_posts_.push_back(cb);
+    }));
+    pool_ = std::make_unique<SharedConnPoolImpl>(
+        dispatcher_, owner_dispatcher_, [this]() -> ConnectionPool::Instance* {
+          return owner_pool_available_ ? &owner_pool_ : nullptr;
+        });
+  }
+
+  ~Http2SharedConnPoolImplTest() {
+    pool_.reset();
+    runAll();
+  }
+
+  static void run(std::list<Event::PostCb>& posts) {
+    while (!posts.empty()) {
+      Event::PostCb cb = posts.front();
+      posts.pop_front();
+      cb();
+    }
+  }
+
+  void runWorker() { run(posts_); }
+  void runOwner() { run(owner_posts_); }
+  void runAll() {
+    while (!posts_.empty() || !owner_posts_.empty()) {
+      runOwner();
+      runWorker();
+    }
+  }
+
+  /**
+   * Creates a stream on the worker and lets the owning worker hand it to its pool.
+   */
+  void newStream() {
+    handle_ = pool_->newStream(decoder_, callbacks_);
+    EXPECT_NE(nullptr, handle_);
+    EXPECT_CALL(owner_pool_, newStream(_, _))
+        .WillOnce(Invoke([this](StreamDecoder& decoder, ConnectionPool::Callbacks& callbacks)
+                             -> ConnectionPool::Cancellable* {
+          owner_decoder_ = &decoder;
+          owner_callbacks_ = &callbacks;
+          return &owner_handle_;
+        }));
+    runOwner();
+  }
+
+  /**
+   * Creates a stream and binds it to an upstream stream on the owning worker.
+   */
+  void newReadyStream() {
+    newStream();
+    owner_callbacks_->onPoolReady(owner_encoder_, host_);
+    EXPECT_CALL(callbacks_.pool_ready_, ready());
+    runWorker();
+    ASSERT_NE(nullptr, callbacks_.outer_encoder_);
+  }
+
+  std::list<Event::PostCb> posts_;
+  std::list<Event::PostCb> owner_posts_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  NiceMock<Event::MockDispatcher> owner_dispatcher_;
+  NiceMock<ConnectionPool::MockInstance> owner_pool_;
+  NiceMock<ConnectionPool::MockCancellable> owner_handle_;
+  NiceMock<MockStreamEncoder> owner_encoder_;
+  StreamDecoder* owner_decoder_{};
+  ConnectionPool::Callbacks* owner_callbacks_{};
+  std::shared_ptr<Upstream::MockHostDescription> host_{
+      new NiceMock<Upstream::MockHostDescription>()};
+  bool owner_pool_available_{true};
+  std::unique_ptr<SharedConnPoolImpl> pool_;
+  NiceMock<MockStreamDecoder> decoder_;
+  ConnPoolCallbacks callbacks_;
+  ConnectionPool::Cancellable* handle_{};
+};
+
+/**
+ * Test a request and response handed off to the owning worker.
+ */
+TEST_F(Http2SharedConnPoolImplTest, RequestAndResponse) {
+  EXPECT_EQ(Protocol::Http2, pool_->protocol());
+  newReadyStream();
+  EXPECT_TRUE(pool_->hasActiveConnections());
+  EXPECT_EQ(host_, callbacks_.host_);
+
+  TestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}};
+  callbacks_.outer_encoder_->encodeHeaders(request_headers, true);
+  EXPECT_CALL(owner_encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), true));
+  runOwner();
+
+  HeaderMapPtr response_headers(new TestHeaderMapImpl{{":status", "200"}});
+  owner_decoder_->decodeHeaders(std::move(response_headers), true);
+  EXPECT_CALL(decoder_, decodeHeaders_(_, true));
+  runWorker();
+
+  EXPECT_FALSE(pool_->hasActiveConnections());
+  ReadyWatcher drained;
+  EXPECT_CALL(drained, ready());
+  pool_->addDrainedCallback([&]() -> void { drained.ready(); });
+}
+
+/**
+ * Test that bodies and trailers are relayed in both directions.
+ */
+TEST_F(Http2SharedConnPoolImplTest, BodyAndTrailers) {
+  newReadyStream();
+
+  TestHeaderMapImpl request_headers{{":method", "POST"}, {":path", "/"}};
+  Buffer::OwnedImpl request_body("hello");
+  TestHeaderMapImpl request_trailers{{"foo", "bar"}};
+  callbacks_.outer_encoder_->encodeHeaders(request_headers, false);
+  callbacks_.outer_encoder_->encodeData(request_body, false);
+  callbacks_.outer_encoder_->encodeTrailers(request_trailers);
+  EXPECT_EQ(0, request_body.length());
+
+  EXPECT_CALL(owner_encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), false));
+  EXPECT_CALL(owner_encoder_, encodeData(BufferStringEqual("hello"), false));
+  EXPECT_CALL(owner_encoder_, encodeTrailers(HeaderMapEqualRef(&request_trailers)));
+  runOwner();
+  EXPECT_TRUE(pool_->hasActiveConnections());
+
+  Buffer::OwnedImpl response_body("world");
+  owner_decoder_->decodeHeaders(HeaderMapPtr{new TestHeaderMapImpl{{":status", "200"}}}, false);
+  owner_decoder_->decodeData(response_body, false);
+  owner_decoder_->decodeTrailers(HeaderMapPtr{new TestHeaderMapImpl{{"foo", "bar"}}});
+  EXPECT_EQ(0, response_body.length());
+
+  EXPECT_CALL(decoder_, decodeHeaders_(_, false));
+  EXPECT_CALL(decoder_, decodeData(BufferStringEqual("world"), false));
+  EXPECT_CALL(decoder_, decodeTrailers_(_));
+  runWorker();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+/**
+ * Test cancelling a stream that is still pending on the owning worker.
+ */
+TEST_F(Http2SharedConnPoolImplTest, CancelPending) {
+  newStream();
+
+  handle_->cancel();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+  EXPECT_CALL(owner_handle_, cancel());
+  runOwner();
+}
+
+/**
+ * Test cancelling a stream that the owning worker bound before the cancellation arrived.
+ */
+TEST_F(Http2SharedConnPoolImplTest, CancelAfterBound) {
+  newStream();
+  owner_callbacks_->onPoolReady(owner_encoder_, host_);
+
+  handle_->cancel();
+  EXPECT_CALL(owner_handle_, cancel()).Times(0);
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  runOwner();
+
+  EXPECT_CALL(callbacks_.pool_ready_, ready()).Times(0);
+  runWorker();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+/**
+ * Test a pool failure on the owning worker.
+ */
+TEST_F(Http2SharedConnPoolImplTest, OwnerPoolFailure) {
+  newStream();
+
+  owner_callbacks_->onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, host_);
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runWorker();
+  EXPECT_EQ(host_, callbacks_.host_);
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+/**
+ * Test that a stream fails if the owning worker no longer has a pool for the host.
+ */
+TEST_F(Http2SharedConnPoolImplTest, NoOwnerPool) {
+  owner_pool_available_ = false;
+  pool_->newStream(decoder_, callbacks_);
+  EXPECT_CALL(owner_pool_, newStream(_, _)).Times(0);
+  runOwner();
+
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runWorker();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+/**
+ * Test an upstream reset of a bound stream.
+ */
+TEST_F(Http2SharedConnPoolImplTest, RemoteReset) {
+  newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  owner_encoder_.stream_.resetStream(StreamResetReason::RemoteReset);
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset));
+  runWorker();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+/**
+ * Test a local reset of a bound stream.
+ */
+TEST_F(Http2SharedConnPoolImplTest, LocalReset) {
+  newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::LocalReset));
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_FALSE(pool_->hasActiveConnections());
+
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  runOwner();
+  EXPECT_TRUE(owner_encoder_.stream_.callbacks_.empty());
+}
+
+/**
+ * Test that watermark and read disable calls are relayed.
+ */
+TEST_F(Http2SharedConnPoolImplTest, FlowControl) {
+  newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  owner_encoder_.stream_.runHighWatermarkCallbacks();
+  owner_encoder_.stream_.runLowWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  runWorker();
+
+  callbacks_.outer_encoder_->getStream().readDisable(true);
+  EXPECT_CALL(owner_encoder_.stream_, readDisable(true));
+  runOwner();
+
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+}
+
+/**
+ * Test destroying the pool with pending and bound streams.
+ */
+TEST_F(Http2SharedConnPoolImplTest, DestroyWithActiveStreams) {
+  newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  NiceMock<MockStreamDecoder> decoder2;
+  ConnPoolCallbacks callbacks2;
+  pool_->newStream(decoder2, callbacks2);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::ConnectionTermination));
+  EXPECT_CALL(callbacks2.pool_failure_, ready());
+  pool_.reset();
+
+  // The second stream reaches the owning worker's pool before its cancellation does.
+  EXPECT_CALL(owner_encoder_.stream_, resetStream(StreamResetReason::ConnectionTermination));
+  EXPECT_CALL(owner_pool_, newStream(_, _)).WillOnce(Return(&owner_handle_));
+  EXPECT_CALL(owner_handle_, cancel());
+  runOwner();
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
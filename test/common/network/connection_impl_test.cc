@@ -1,3 +1,6 @@
+#include <fcntl.h>
+#include <sys/socket.h>
+
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -10,8 +13,10 @@
 #include "common/network/connection_impl.h"
 #include "common/network/io_socket_handle_impl.h"
 #include "common/network/listen_socket_impl.h"
+#include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 #include "common/runtime/runtime_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "test/mocks/buffer/mocks.h"
 #include "test/mocks/event/mocks.h"
@@ -35,6 +40,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::Return;
+using testing::ReturnRef;
 using testing::SaveArg;
 using testing::Sequence;
 using testing::StrictMock;
@@ -50,6 +56,91 @@ TEST(RawBufferSocket, TestBasics) {
   EXPECT_EQ("", raw_buffer_socket->protocol());
 }
 
+class RawBufferSocketReadSizeTest : public testing::Test {
+public:
+  RawBufferSocketReadSizeTest() {
+    int fds[2];
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "");
+    RELEASE_ASSERT(::fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0, "");
+    io_handle_ = std::make_unique<IoSocketHandleImpl>(fds[0]);
+    peer_io_handle_ = std::make_unique<IoSocketHandleImpl>(fds[1]);
+    ON_CALL(callbacks_, ioHandle()).WillByDefault(ReturnRef(*io_handle_));
+    socket_.setTransportSocketCallbacks(callbacks_);
+  }
+
+  // Writes the given number of bytes from the peer and reads them back in one read event.
+  void writeAndRead(uint64_t size) {
+    const std::string data(size, 'a');
+    ASSERT_EQ(static_cast<ssize_t>(size), ::write(peer_io_handle_->fd(), data.data(), size));
+    Buffer::OwnedImpl buffer;
+    IoResult result = socket_.doRead(buffer);
+    EXPECT_EQ(PostIoAction::KeepOpen, result.action_);
+    EXPECT_EQ(size, result.bytes_processed_);
+    EXPECT_EQ(size, buffer.length());
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  RawBufferSocketStats stats_{
+      ALL_RAW_BUFFER_SOCKET_STATS(POOL_COUNTER_PREFIX(store_, "raw_buffer."))};
+  IoHandlePtr io_handle_;
+  IoHandlePtr peer_io_handle_;
+  NiceMock<MockTransportSocketCallbacks> callbacks_;
+  RawBufferSocket socket_{64 * 1024, &stats_};
+};
+
+// Test that the read size grows while reads fill it, up to the configured limit.
+TEST_F(RawBufferSocketReadSizeTest, GrowOnFullReads) {
+  EXPECT_EQ(16384UL, socket_.readSize());
+
+  // Reads of 16KiB and 32KiB fill the read size, and the last 16KiB is a short 64KiB read.
+  writeAndRead(64 * 1024);
+  EXPECT_EQ(64UL * 1024, socket_.readSize());
+  EXPECT_EQ(1UL, stats_.read_events_.value());
+  EXPECT_EQ(4UL, stats_.reads_.value());
+
+  // A full read at the limit doesn't grow it any further.
+  writeAndRead(64 * 1024);
+  EXPECT_EQ(64UL * 1024, socket_.readSize());
+  EXPECT_EQ(2UL, stats_.read_events_.value());
+  EXPECT_EQ(6UL, stats_.reads_.value());
+}
+
+// Test that the read size shrinks after small read events, down to the minimum.
+TEST_F(RawBufferSocketReadSizeTest, ShrinkOnShortReads) {
+  writeAndRead(64 * 1024);
+  EXPECT_EQ(64UL * 1024, socket_.readSize());
+
+  const uint64_t expected_sizes[] = {32 * 1024, 16384, 8192, 4096, 4096};
+  for (uint64_t expected_size : expected_sizes) {
+    writeAndRead(100);
+    EXPECT_EQ(expected_size, socket_.readSize());
+  }
+
+  // A read event that is not much smaller than the read size leaves it alone.
+  writeAndRead(2048);
+  EXPECT_EQ(4096UL, socket_.readSize());
+}
+
+// Test that a read asks for no more than the headroom left below the connection's buffer limit.
+TEST_F(RawBufferSocketReadSizeTest, ClampToBufferLimit) {
+  ON_CALL(callbacks_.connection_, bufferLimit()).WillByDefault(Return(20000));
+  Buffer::OwnedImpl buffer;
+  ON_CALL(callbacks_, shouldDrainReadBuffer()).WillByDefault(Invoke([&buffer]() -> bool {
+    return buffer.length() >= 20000;
+  }));
+
+  const std::string data(64 * 1024, 'a');
+  ASSERT_EQ(static_cast<ssize_t>(data.size()),
+            ::write(peer_io_handle_->fd(), data.data(), data.size()));
+  IoResult result = socket_.doRead(buffer);
+  EXPECT_EQ(PostIoAction::KeepOpen, result.action_);
+  // A full 16KiB read, then the remaining 3616 bytes of headroom.
+  EXPECT_EQ(20000UL, result.bytes_processed_);
+  EXPECT_EQ(20000UL, buffer.length());
+  EXPECT_EQ(2UL, stats_.reads_.value());
+  EXPECT_EQ(32UL * 1024, socket_.readSize());
+}
+
 TEST(ConnectionImplUtility, updateBufferStats) {
   StrictMock<Stats::MockCounter> counter;
   StrictMock<Stats::MockGauge> gauge;
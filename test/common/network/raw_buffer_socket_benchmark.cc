@@ -0,0 +1,110 @@
+// Usage: bazel run //test/common/network:raw_buffer_socket_benchmark
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/network/raw_buffer_socket.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+// The amount of data received in each iteration, which is the size of a large download relayed by
+// the TCP proxy.
+constexpr uint64_t TransferSize = 1024 * 1024 * 1024;
+
+// Times receiving a large transfer through a raw buffer socket with the given maximum read size.
+// A separate thread writes into the other end of a socket pair as fast as it can, and the
+// benchmark thread polls for readability and reads, as a worker's event loop does for the
+// downstream connection of a TCP proxy session.
+void BM_RawBufferSocketRead(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Stats::IsolatedStoreImpl store;
+  RawBufferSocketStats stats{
+      ALL_RAW_BUFFER_SOCKET_STATS(POOL_COUNTER_PREFIX(store, "raw_buffer."))};
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    int fds[2];
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "");
+    RELEASE_ASSERT(::fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0, "");
+    IoSocketHandleImpl io_handle(fds[0]);
+    IoSocketHandleImpl peer_io_handle(fds[1]);
+    NiceMock<MockTransportSocketCallbacks> callbacks;
+    ON_CALL(callbacks, ioHandle()).WillByDefault(ReturnRef(io_handle));
+    RawBufferSocket socket(state.range(0), &stats);
+    socket.setTransportSocketCallbacks(callbacks);
+
+    Thread::ThreadPtr writer = api->threadFactory().createThread([&peer_io_handle]() -> void {
+      const std::string chunk(1024 * 1024, 'a');
+      uint64_t written = 0;
+      while (written < TransferSize) {
+        const ssize_t rc = ::write(peer_io_handle.fd(), chunk.data(), chunk.size());
+        RELEASE_ASSERT(rc > 0, "");
+        written += rc;
+      }
+    });
+    state.ResumeTiming();
+
+    Buffer::OwnedImpl buffer;
+    uint64_t received = 0;
+    while (received < TransferSize) {
+      pollfd poll_fd{io_handle.fd(), POLLIN, 0};
+      RELEASE_ASSERT(::poll(&poll_fd, 1, -1) == 1, "");
+      IoResult result = socket.doRead(buffer);
+      RELEASE_ASSERT(result.action_ == PostIoAction::KeepOpen, "");
+      received += result.bytes_processed_;
+      buffer.drain(buffer.length());
+    }
+
+    state.PauseTiming();
+    writer->join();
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(state.iterations() * TransferSize);
+  state.counters["reads_per_event"] =
+      static_cast<double>(stats.reads_.value()) / stats.read_events_.value();
+}
+BENCHMARK(BM_RawBufferSocketRead)
+    ->Arg(16 * 1024)
+    ->Arg(64 * 1024)
+    ->Arg(256 * 1024)
+    ->Arg(1024 * 1024)
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_context(spdlog::level::warn,
+                                         Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
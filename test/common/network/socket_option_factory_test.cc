@@ -69,6 +69,29 @@ TEST_F(SocketOptionFactoryTest, TestBuildSocketMarkOptions) {
                                             envoy::api::v2::core::SocketOption::STATE_PREBIND));
 }
 
+TEST_F(SocketOptionFactoryTest, TestBuildReusePortOptions) {
+
+  // use a shared_ptr due to applyOptions requiring one
+  std::shared_ptr<Socket::Options> options = SocketOptionFactory::buildReusePortOptions();
+
+  const auto expected_option = ENVOY_SOCKET_SO_REUSEPORT;
+  CHECK_OPTION_SUPPORTED(expected_option);
+
+  const int type = expected_option.value().first;
+  const int option = expected_option.value().second;
+  EXPECT_CALL(os_sys_calls_mock_, setsockopt_(_, _, _, _, sizeof(int)))
+      .WillOnce(Invoke([type, option](int, int input_type, int input_option, const void* optval,
+                                      socklen_t) -> int {
+        EXPECT_EQ(1, *static_cast<const int*>(optval));
+        EXPECT_EQ(type, input_type);
+        EXPECT_EQ(option, input_option);
+        return 0;
+      }));
+
+  EXPECT_TRUE(Network::Socket::applyOptions(options, socket_mock_,
+                                            envoy::api::v2::core::SocketOption::STATE_PREBIND));
+}
+
 TEST_F(SocketOptionFactoryTest, TestBuildIpv4TransparentOptions) {
   makeSocketV4();
 
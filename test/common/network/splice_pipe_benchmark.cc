@@ -0,0 +1,190 @@
+// Usage: bazel run //test/common/network:splice_pipe_benchmark
+//
+// Compares the CPU cost of relaying data between two TCP sockets in user space, as the TCP proxy
+// does through its connection buffers, with relaying it through a splice pipe. The cores_per_Gbps
+// counter is the CPU time of the relaying thread for each gigabit relayed.
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/network/splice_pipe.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+// The amount of data relayed in each iteration.
+constexpr uint64_t TransferSize = 1024 * 1024 * 1024;
+
+// The read size of a plaintext connection.
+constexpr uint64_t ReadSize = 16384;
+
+// The size of the pipe, which matches the default connection buffer limit.
+constexpr uint64_t PipeCapacity = 1024 * 1024;
+
+// Connects a pair of TCP sockets over the loopback interface.
+void tcpPair(int fds[2]) {
+  const int listener = ::socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(listener != -1, "");
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_length = sizeof(address);
+  RELEASE_ASSERT(::bind(listener, reinterpret_cast<sockaddr*>(&address), address_length) == 0, "");
+  RELEASE_ASSERT(::listen(listener, 1) == 0, "");
+  RELEASE_ASSERT(
+      ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &address_length) == 0, "");
+  fds[0] = ::socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(::connect(fds[0], reinterpret_cast<sockaddr*>(&address), address_length) == 0,
+                 "");
+  fds[1] = ::accept(listener, nullptr, nullptr);
+  RELEASE_ASSERT(fds[1] != -1, "");
+  ::close(listener);
+}
+
+uint64_t threadCpuNanoseconds() {
+  timespec now;
+  RELEASE_ASSERT(::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0, "");
+  return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+// Waits until the socket is ready for the given poll events.
+void waitFor(int fd, short events) {
+  pollfd poll_fd{fd, events, 0};
+  RELEASE_ASSERT(::poll(&poll_fd, 1, -1) == 1, "");
+}
+
+// Relays through a buffer, reading and writing like a raw buffer socket.
+void relayBuffered(int source, int destination) {
+  Buffer::OwnedImpl buffer;
+  uint64_t relayed = 0;
+  while (relayed < TransferSize) {
+    if (buffer.length() == 0) {
+      waitFor(source, POLLIN);
+      Api::SysCallIntResult result = buffer.read(source, ReadSize);
+      RELEASE_ASSERT(result.rc_ > 0 || result.errno_ == EAGAIN, "");
+    }
+    while (buffer.length() > 0) {
+      Api::SysCallIntResult result = buffer.write(destination);
+      if (result.rc_ == -1) {
+        RELEASE_ASSERT(result.errno_ == EAGAIN, "");
+        waitFor(destination, POLLOUT);
+        continue;
+      }
+      relayed += result.rc_;
+    }
+  }
+}
+
+// Relays through a splice pipe.
+void relaySpliced(int source, int destination) {
+  SplicePipePtr pipe = SplicePipe::create(PipeCapacity);
+  RELEASE_ASSERT(pipe != nullptr, "");
+  uint64_t relayed = 0;
+  while (relayed < TransferSize) {
+    if (pipe->length() == 0) {
+      waitFor(source, POLLIN);
+    }
+    if (!pipe->full()) {
+      Api::SysCallSizeResult result = pipe->fill(source);
+      RELEASE_ASSERT(result.rc_ > 0 || result.errno_ == EAGAIN, "");
+    }
+    if (pipe->length() > 0) {
+      Api::SysCallSizeResult result = pipe->drain(destination);
+      if (result.rc_ == -1) {
+        RELEASE_ASSERT(result.errno_ == EAGAIN, "");
+        waitFor(destination, POLLOUT);
+        continue;
+      }
+      relayed += result.rc_;
+    }
+  }
+}
+
+// Times relaying a large transfer from one TCP connection to another, as the TCP proxy does. A
+// writer thread feeds the source connection and a reader thread drains the destination connection
+// as fast as they can, so the benchmark thread only does the relaying.
+template <void (*Relay)(int, int)> void BM_Relay(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  uint64_t cpu_nanoseconds = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    int source[2];
+    int destination[2];
+    tcpPair(source);
+    tcpPair(destination);
+    RELEASE_ASSERT(::fcntl(source[1], F_SETFL, O_NONBLOCK) == 0, "");
+    RELEASE_ASSERT(::fcntl(destination[0], F_SETFL, O_NONBLOCK) == 0, "");
+
+    Thread::ThreadPtr writer = api->threadFactory().createThread([&source]() -> void {
+      const std::string chunk(1024 * 1024, 'a');
+      uint64_t written = 0;
+      while (written < TransferSize) {
+        const ssize_t rc = ::write(source[0], chunk.data(), chunk.size());
+        RELEASE_ASSERT(rc > 0, "");
+        written += rc;
+      }
+    });
+    Thread::ThreadPtr reader = api->threadFactory().createThread([&destination]() -> void {
+      std::string chunk(1024 * 1024, 0);
+      uint64_t read = 0;
+      while (read < TransferSize) {
+        const ssize_t rc = ::read(destination[1], &chunk[0], chunk.size());
+        RELEASE_ASSERT(rc > 0, "");
+        read += rc;
+      }
+    });
+    state.ResumeTiming();
+
+    const uint64_t start = threadCpuNanoseconds();
+    Relay(source[1], destination[0]);
+    cpu_nanoseconds += threadCpuNanoseconds() - start;
+
+    state.PauseTiming();
+    writer->join();
+    reader->join();
+    for (int fd : {source[0], source[1], destination[0], destination[1]}) {
+      ::close(fd);
+    }
+    state.ResumeTiming();
+  }
+
+  state.SetBytesProcessed(state.iterations() * TransferSize);
+  const double gigabits = state.iterations() * TransferSize * 8 / 1e9;
+  state.counters["cores_per_Gbps"] = cpu_nanoseconds / 1e9 / gigabits;
+}
+BENCHMARK_TEMPLATE(BM_Relay, relayBuffered)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Relay, relaySpliced)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_context(spdlog::level::warn,
+                                         Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,86 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <string>
+
+#include "envoy/api/v2/rds.pb.h"
+
+#include "common/http/header_map_impl.h"
+#include "common/router/config_impl.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Builds a single virtual host with state.range(0) routes. Even routes are exact path routes and
+ * odd routes are prefix routes, so that a request for the last route has to get past all of the
+ * others.
+ */
+static envoy::api::v2::RouteConfiguration genRouteConfig(benchmark::State& state) {
+  envoy::api::v2::RouteConfiguration route_config;
+  auto* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("service");
+  virtual_host->add_domains("*");
+  for (int i = 0; i < state.range(0); ++i) {
+    auto* route = virtual_host->add_routes();
+    if (i % 2 == 0) {
+      route->mutable_match()->set_path(fmt::format("/shelves/{}/books", i));
+    } else {
+      route->mutable_match()->set_prefix(fmt::format("/shelves/{}/", i));
+    }
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  return route_config;
+}
+
+static void routeLookup(benchmark::State& state, const std::string& path) {
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+  ConfigImpl config(genRouteConfig(state), factory_context, false);
+  Http::TestHeaderMapImpl headers{{":authority", "example.com"}, {":path", path}};
+
+  for (auto _ : state) {
+    RouteConstSharedPtr route = config.route(headers, 0);
+    benchmark::DoNotOptimize(route);
+  }
+}
+
+// Request that matches the last (prefix) route in the table.
+static void BM_RouteLookupLastPrefix(benchmark::State& state) {
+  routeLookup(state, fmt::format("/shelves/{}/books/123", state.range(0) - 1));
+}
+BENCHMARK(BM_RouteLookupLastPrefix)->RangeMultiplier(4)->Range(4, 4096);
+
+// Request that matches an exact path route in the middle of the table.
+static void BM_RouteLookupMiddleExact(benchmark::State& state) {
+  routeLookup(state, fmt::format("/shelves/{}/books?page=2", (state.range(0) / 4) * 2));
+}
+BENCHMARK(BM_RouteLookupMiddleExact)->RangeMultiplier(4)->Range(4, 4096);
+
+// Request that does not match any route.
+static void BM_RouteLookupMiss(benchmark::State& state) {
+  routeLookup(state, "/authors/1");
+}
+BENCHMARK(BM_RouteLookupMiss)->RangeMultiplier(4)->Range(4, 4096);
+
+} // namespace Router
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -7,6 +7,7 @@
 
 #include "envoy/server/filter_config.h"
 
+#include "common/common/regex.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
 #include "common/config/well_known_names.h"
@@ -1344,6 +1345,123 @@ TEST_F(RouteMatcherTest, QueryParamMatchedRouting) {
   }
 }
 
+// Virtual hosts with enough routes are matched through the route match index. Verify that the
+// first route in table order still wins when path, regex, header and query parameter routes are
+// mixed.
+TEST_F(RouteMatcherTest, IndexedRoutesPreserveFirstMatch) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: local_service
+    domains: ["*"]
+    routes:
+      - match: { prefix: "/api", headers: [{ name: x-canary, exact_match: "true" }] }
+        route: { cluster: canary }
+      - match: { path: "/api/users" }
+        route: { cluster: users_exact }
+      - match: { regex: "/api/users/[0-9]+" }
+        route: { cluster: users_regex }
+      - match: { prefix: "/api/users", query_parameters: [{ name: debug }] }
+        route: { cluster: users_debug }
+      - match: { prefix: "/api/users" }
+        route: { cluster: users_prefix }
+      - match: { prefix: "/API/", case_sensitive: false }
+        route: { cluster: api_ignore_case }
+      - match: { path: "/Static", case_sensitive: false }
+        route: { cluster: static_exact }
+      - match: { regex: "/static/.*" }
+        route: { cluster: static_regex }
+      - match: { prefix: "/static" }
+        route: { cluster: static_prefix }
+      - match: { prefix: "/" }
+        route: { cluster: default }
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+
+  auto cluster = [&config](const std::string& path) {
+    return config.route(genHeaders("example.com", path, "GET"), 0)->routeEntry()->clusterName();
+  };
+
+  EXPECT_EQ("users_exact", cluster("/api/users"));
+  EXPECT_EQ("users_exact", cluster("/api/users?debug"));
+  EXPECT_EQ("users_regex", cluster("/api/users/42"));
+  EXPECT_EQ("users_debug", cluster("/api/users/abc?debug"));
+  EXPECT_EQ("users_prefix", cluster("/api/users/abc"));
+  EXPECT_EQ("api_ignore_case", cluster("/Api/orders"));
+  EXPECT_EQ("default", cluster("/api"));
+  EXPECT_EQ("static_exact", cluster("/STATIC?v=1"));
+  EXPECT_EQ("static_regex", cluster("/static/app.js"));
+  EXPECT_EQ("static_exact", cluster("/static"));
+  EXPECT_EQ("static_prefix", cluster("/staticfoo"));
+  EXPECT_EQ("default", cluster("/other"));
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("example.com", "/api/users", "GET");
+    headers.addCopy("x-canary", "true");
+    EXPECT_EQ("canary", config.route(headers, 0)->routeEntry()->clusterName());
+  }
+}
+
+TEST_F(RouteMatcherTest, Re2RegexRoutes) {
+  Regex::Utility::setEngine(Regex::Engine::Re2);
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: local_service
+    domains: ["*"]
+    routes:
+      - match: { regex: "/users/[0-9]+" }
+        route: { cluster: users }
+      - match: { prefix: "/", headers: [{ name: x-tenant, regex_match: "[a-z]+" }] }
+        route: { cluster: tenant }
+      - match: { prefix: "/" }
+        route: { cluster: default }
+    virtual_clusters:
+      - pattern: "/users/[0-9]+"
+        name: users
+  )EOF";
+
+  TestConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true);
+  Regex::Utility::setEngine(Regex::Engine::StdRegex);
+
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("example.com", "/users/42?x=1", "GET");
+    const RouteEntry* route = config.route(headers, 0)->routeEntry();
+    EXPECT_EQ("users", route->clusterName());
+    EXPECT_EQ("users", route->virtualCluster(headers)->name());
+  }
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("example.com", "/users/abc", "GET");
+    headers.addCopy("x-tenant", "acme");
+    EXPECT_EQ("tenant", config.route(headers, 0)->routeEntry()->clusterName());
+    EXPECT_EQ("other", config.route(headers, 0)->routeEntry()->virtualCluster(headers)->name());
+  }
+  {
+    Http::TestHeaderMapImpl headers = genHeaders("example.com", "/users/abc", "GET");
+    headers.addCopy("x-tenant", "ACME");
+    EXPECT_EQ("default", config.route(headers, 0)->routeEntry()->clusterName());
+  }
+}
+
+TEST_F(RouteMatcherTest, Re2RegexProgramSizeLimit) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: local_service
+    domains: ["*"]
+    routes:
+      - match: { regex: "/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*/asdf/.*" }
+        route: { cluster: www2 }
+  )EOF";
+
+  // std::regex has no notion of program size.
+  EXPECT_NO_THROW(TestConfigImpl(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true));
+
+  Regex::Utility::setEngine(Regex::Engine::Re2);
+  EXPECT_THROW_WITH_REGEX(
+      TestConfigImpl(parseRouteConfigurationFromV2Yaml(yaml), factory_context_, true),
+      EnvoyException, "RE2 program size of [0-9]+ > max program size of 100");
+  Regex::Utility::setEngine(Regex::Engine::StdRegex);
+}
+
 // Verify the fixes for https://github.com/envoyproxy/envoy/issues/2406
 TEST_F(RouteMatcherTest, InvalidQueryParamMatchedRoutingConfig) {
   std::string value_with_regex_chars = R"EOF(
@@ -0,0 +1,99 @@
+#include "common/router/route_match_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+class RouteMatchIndexTest : public testing::Test {
+protected:
+  RouteMatchIndex::CandidateVector candidates(absl::string_view path) {
+    RouteMatchIndex::CandidateVector result;
+    index_.candidates(path, result);
+    return result;
+  }
+
+  RouteMatchIndex index_;
+};
+
+TEST_F(RouteMatchIndexTest, Empty) { EXPECT_THAT(candidates("/foo"), IsEmpty()); }
+
+TEST_F(RouteMatchIndexTest, Exact) {
+  index_.addExact("/foo", true, 0);
+  index_.addExact("/bar", true, 1);
+  index_.addExact("/foo", true, 2);
+
+  EXPECT_THAT(candidates("/foo"), ElementsAre(0, 2));
+  EXPECT_THAT(candidates("/foo?a=b"), ElementsAre(0, 2));
+  EXPECT_THAT(candidates("/bar"), ElementsAre(1));
+  EXPECT_THAT(candidates("/FOO"), IsEmpty());
+  EXPECT_THAT(candidates("/foo/"), IsEmpty());
+  EXPECT_THAT(candidates("/fo"), IsEmpty());
+}
+
+TEST_F(RouteMatchIndexTest, ExactIgnoreCase) {
+  index_.addExact("/Foo", false, 0);
+  index_.addExact("/foo", true, 1);
+
+  EXPECT_THAT(candidates("/foo"), ElementsAre(0, 1));
+  EXPECT_THAT(candidates("/FOO?Q=1"), ElementsAre(0));
+  EXPECT_THAT(candidates("/fooo"), IsEmpty());
+}
+
+TEST_F(RouteMatchIndexTest, Prefix) {
+  index_.addPrefix("/foo/bar", true, 0);
+  index_.addPrefix("/foo", true, 1);
+  index_.addPrefix("/", true, 2);
+  index_.addPrefix("/fob", true, 3);
+
+  EXPECT_THAT(candidates("/foo/bar/baz"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(candidates("/foo/ba"), ElementsAre(1, 2));
+  EXPECT_THAT(candidates("/fob"), ElementsAre(2, 3));
+  EXPECT_THAT(candidates("/FOO"), ElementsAre(2));
+  EXPECT_THAT(candidates("foo"), IsEmpty());
+}
+
+TEST_F(RouteMatchIndexTest, PrefixIncludesQueryString) {
+  index_.addPrefix("/foo?bar", true, 0);
+
+  EXPECT_THAT(candidates("/foo?bar=1"), ElementsAre(0));
+  EXPECT_THAT(candidates("/foo"), IsEmpty());
+}
+
+TEST_F(RouteMatchIndexTest, PrefixIgnoreCase) {
+  index_.addPrefix("/Foo", false, 0);
+  index_.addPrefix("/foo", true, 1);
+
+  EXPECT_THAT(candidates("/FOO/bar"), ElementsAre(0));
+  EXPECT_THAT(candidates("/foo"), ElementsAre(0, 1));
+}
+
+TEST_F(RouteMatchIndexTest, EmptyPrefix) {
+  index_.addPrefix("", true, 1);
+  index_.addPrefix("", false, 0);
+
+  EXPECT_THAT(candidates(""), ElementsAre(0, 1));
+  EXPECT_THAT(candidates("/anything"), ElementsAre(0, 1));
+}
+
+TEST_F(RouteMatchIndexTest, MixedPreservesRouteOrder) {
+  index_.addPrefix("/", true, 0);
+  index_.addUnindexed(1);
+  index_.addExact("/foo", true, 2);
+  index_.addPrefix("/foo", false, 3);
+  index_.addUnindexed(4);
+  index_.addExact("/FOO", false, 5);
+
+  EXPECT_THAT(candidates("/foo"), ElementsAre(0, 1, 2, 3, 4, 5));
+  EXPECT_THAT(candidates("/bar"), ElementsAre(0, 1, 4));
+  EXPECT_THAT(candidates("/Foo/bar"), ElementsAre(0, 1, 3, 4));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
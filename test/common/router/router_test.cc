@@ -76,11 +76,12 @@ public:
 
 class RouterTestBase : public testing::Test {
 public:
-  RouterTestBase(bool start_child_span, bool suppress_envoy_headers)
+  RouterTestBase(bool start_child_span, bool suppress_envoy_headers,
+                 bool emit_dynamic_stats = true)
       : shadow_writer_(new MockShadowWriter()),
         config_("test.", local_info_, stats_store_, cm_, runtime_, random_,
-                ShadowWriterPtr{shadow_writer_}, true, start_child_span, suppress_envoy_headers,
-                test_time_.timeSystem(), http_context_),
+                ShadowWriterPtr{shadow_writer_}, emit_dynamic_stats, start_child_span,
+                suppress_envoy_headers, test_time_.timeSystem(), http_context_),
         router_(config_) {
     router_.setDecoderFilterCallbacks(callbacks_);
     upstream_locality_.set_zone("to_az");
@@ -249,6 +250,11 @@ public:
   RouterTestSuppressEnvoyHeaders() : RouterTestBase(false, true) {}
 };
 
+class RouterTestNoDynamicStats : public RouterTestBase {
+public:
+  RouterTestNoDynamicStats() : RouterTestBase(false, false, false) {}
+};
+
 TEST_F(RouterTest, RouteNotFound) {
   EXPECT_CALL(callbacks_.stream_info_, setResponseFlag(StreamInfo::ResponseFlag::NoRouteFound));
 
@@ -2112,6 +2118,31 @@ TEST_F(RouterTest, Shadow) {
   EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
 }
 
+// Response times still reach the host and its outlier detector when dynamic stats are disabled, as
+// load balancing and latency ejection use them.
+TEST_F(RouterTestNoDynamicStats, ResponseTimeRecorded) {
+  NiceMock<Http::MockStreamEncoder> encoder;
+  Http::StreamDecoder* response_decoder = nullptr;
+  EXPECT_CALL(cm_.conn_pool_, newStream(_, _))
+      .WillOnce(Invoke([&](Http::StreamDecoder& decoder, Http::ConnectionPool::Callbacks& callbacks)
+                           -> Http::ConnectionPool::Cancellable* {
+        response_decoder = &decoder;
+        callbacks.onPoolReady(encoder, cm_.conn_pool_.host_);
+        return nullptr;
+      }));
+  expectResponseTimerCreate();
+
+  Http::TestHeaderMapImpl headers;
+  HttpTestUtility::addDefaultHeaders(headers);
+  router_.decodeHeaders(headers, true);
+
+  EXPECT_CALL(*cm_.conn_pool_.host_, putResponseTime(_, _));
+  EXPECT_CALL(cm_.conn_pool_.host_->outlier_detector_, putResponseTime(_));
+  Http::HeaderMapPtr response_headers(new Http::TestHeaderMapImpl{{":status", "200"}});
+  response_decoder->decodeHeaders(std::move(response_headers), true);
+  EXPECT_TRUE(verifyHostUpstreamStats(1, 0));
+}
+
 TEST_F(RouterTest, AltStatName) {
   // Also test no upstream timeout here.
   EXPECT_CALL(callbacks_.route_->route_entry_, timeout())
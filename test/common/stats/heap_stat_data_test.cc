@@ -2,6 +2,7 @@
 
 #include "common/stats/heap_stat_data.h"
 #include "common/stats/stats_options_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "test/test_common/logging.h"
 
@@ -15,22 +16,27 @@ namespace {
 // Note: a similar test using RawStatData* is in raw_stat_data_test.cc.
 TEST(HeapStatDataTest, HeapNoTruncate) {
   StatsOptionsImpl stats_options;
-  HeapStatDataAllocator alloc;
+  SymbolTableImpl symbol_table;
+  HeapStatDataAllocator alloc(symbol_table);
   const std::string long_string(stats_options.maxNameLength() + 1, 'A');
+  StatNameTempStorage stat_name(long_string, symbol_table);
   HeapStatData* stat{};
-  EXPECT_NO_LOGS(stat = alloc.alloc(long_string));
-  EXPECT_EQ(stat->key(), long_string);
+  EXPECT_NO_LOGS(stat = alloc.alloc(stat_name.statName()));
+  EXPECT_EQ(long_string, symbol_table.toString(stat->statName()));
   alloc.free(*stat);
 }
 
 // Note: a similar test using RawStatData* is in raw_stat_data_test.cc.
 TEST(HeapStatDataTest, HeapAlloc) {
-  HeapStatDataAllocator alloc;
-  HeapStatData* stat_1 = alloc.alloc("ref_name");
+  SymbolTableImpl symbol_table;
+  HeapStatDataAllocator alloc(symbol_table);
+  StatNameTempStorage ref_name("ref_name", symbol_table);
+  StatNameTempStorage not_ref_name("not_ref_name", symbol_table);
+  HeapStatData* stat_1 = alloc.alloc(ref_name.statName());
   ASSERT_NE(stat_1, nullptr);
-  HeapStatData* stat_2 = alloc.alloc("ref_name");
+  HeapStatData* stat_2 = alloc.alloc(ref_name.statName());
   ASSERT_NE(stat_2, nullptr);
-  HeapStatData* stat_3 = alloc.alloc("not_ref_name");
+  HeapStatData* stat_3 = alloc.alloc(not_ref_name.statName());
   ASSERT_NE(stat_3, nullptr);
   EXPECT_EQ(stat_1, stat_2);
   EXPECT_NE(stat_1, stat_3);
@@ -40,6 +46,22 @@ TEST(HeapStatDataTest, HeapAlloc) {
   alloc.free(*stat_3);
 }
 
+// The stat holds its own reference to the symbols in its name, so the name outlives the
+// storage it was looked up with, and the symbols are released along with the stat.
+TEST(HeapStatDataTest, HeapSymbolRefCounts) {
+  SymbolTableImpl symbol_table;
+  HeapStatDataAllocator alloc(symbol_table);
+  HeapStatData* stat;
+  {
+    StatNameTempStorage stat_name("cluster.foo.upstream_rq_total", symbol_table);
+    stat = alloc.alloc(stat_name.statName());
+  }
+  EXPECT_EQ(3, symbol_table.numSymbols());
+  EXPECT_EQ("cluster.foo.upstream_rq_total", symbol_table.toString(stat->statName()));
+  alloc.free(*stat);
+  EXPECT_EQ(0, symbol_table.numSymbols());
+}
+
 } // namespace
 } // namespace Stats
 } // namespace Envoy
@@ -0,0 +1,104 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+
+#include "common/common/utility.h"
+#include "common/config/well_known_names.h"
+#include "common/stats/tag_extractor_impl.h"
+#include "common/stats/tag_producer_impl.h"
+
+#include "test/common/stats/stat_test_utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+
+// Generates just over 100k stat names, almost all of them cluster stats.
+static std::vector<std::string> sampleStatNames() {
+  std::vector<std::string> names;
+  Stats::TestUtil::forEachSampleStat(
+      1200, [&names](absl::string_view name) { names.push_back(std::string(name)); });
+  return names;
+}
+
+// Applies each extractor whose prefix matches the first token of every name, as
+// TagProducerImpl did before the default extractors were converted to token patterns.
+static void extractAll(const std::vector<Stats::TagExtractorPtr>& extractors,
+                       const std::vector<std::string>& names) {
+  for (const std::string& name : names) {
+    const absl::string_view first_token = absl::string_view(name).substr(0, name.find('.'));
+    std::vector<Stats::Tag> tags;
+    IntervalSetImpl<size_t> remove_characters;
+    for (const Stats::TagExtractorPtr& extractor : extractors) {
+      const absl::string_view prefix = extractor->prefixToken();
+      if (prefix.empty() || prefix == first_token) {
+        extractor->extractTag(name, tags, remove_characters);
+      }
+    }
+    benchmark::DoNotOptimize(StringUtil::removeCharacters(name, remove_characters));
+  }
+}
+
+// Extracts the default tags using only their regexes.
+static void BM_ExtractDefaultTagsRegex(benchmark::State& state) {
+  const std::vector<std::string> names = sampleStatNames();
+  std::vector<Stats::TagExtractorPtr> extractors;
+  for (const auto& desc : Config::TagNames::get().descriptorVec()) {
+    extractors.push_back(
+        Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+  }
+
+  for (auto _ : state) {
+    extractAll(extractors, names);
+  }
+}
+BENCHMARK(BM_ExtractDefaultTagsRegex)->Unit(benchmark::kMillisecond);
+
+// Extracts the default tags using token patterns where they have them, tokenizing each name
+// once per extractor.
+static void BM_ExtractDefaultTagsTokens(benchmark::State& state) {
+  const std::vector<std::string> names = sampleStatNames();
+  std::vector<Stats::TagExtractorPtr> extractors;
+  for (const auto& desc : Config::TagNames::get().descriptorVec()) {
+    if (desc.tokens_.empty()) {
+      extractors.push_back(
+          Stats::TagExtractorImpl::createTagExtractor(desc.name_, desc.regex_, desc.substr_));
+    } else {
+      extractors.push_back(
+          std::make_unique<const Stats::TagExtractorTokensImpl>(desc.name_, desc.tokens_));
+    }
+  }
+
+  for (auto _ : state) {
+    extractAll(extractors, names);
+  }
+}
+BENCHMARK(BM_ExtractDefaultTagsTokens)->Unit(benchmark::kMillisecond);
+
+// Extracts the default tags through TagProducerImpl, which shares one tokenization of each name
+// between its token-pattern extractors.
+static void BM_ProduceDefaultTags(benchmark::State& state) {
+  const std::vector<std::string> names = sampleStatNames();
+  Stats::TagProducerImpl tag_producer{envoy::config::metrics::v2::StatsConfig()};
+
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      std::vector<Stats::Tag> tags;
+      benchmark::DoNotOptimize(tag_producer.produceTags(name, tags));
+    }
+  }
+}
+BENCHMARK(BM_ProduceDefaultTags)->Unit(benchmark::kMillisecond);
+
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
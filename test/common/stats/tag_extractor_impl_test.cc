@@ -115,8 +115,8 @@ public:
     // for this test, however.
     std::list<const TagExtractor*> extractors; // Note push-front is used to reverse order.
     tag_extractors_.forEachExtractorMatching(metric_name,
-                                             [&extractors](const TagExtractorPtr& tag_extractor) {
-                                               extractors.push_front(tag_extractor.get());
+                                             [&extractors](const TagExtractor& tag_extractor) {
+                                               extractors.push_front(&tag_extractor);
                                              });
 
     IntervalSetImpl<size_t> remove_characters;
@@ -351,5 +351,136 @@ TEST(TagExtractorTest, CreateTagExtractorNoRegex) {
                           EnvoyException, "^No regex specified for tag specifier and no default");
 }
 
+// Extracts a tag from stat_name with a token pattern, returning the tag value and the name with
+// the tag removed joined by '|', or "" if the pattern does not match.
+std::string extractTokens(const std::string& pattern, const std::string& stat_name) {
+  TagExtractorTokensImpl tag_extractor("tag", pattern);
+  std::vector<Tag> tags;
+  IntervalSetImpl<size_t> remove_characters;
+  if (!tag_extractor.extractTag(stat_name, tags, remove_characters)) {
+    EXPECT_TRUE(tags.empty());
+    return "";
+  }
+  EXPECT_EQ(1, tags.size());
+  EXPECT_EQ("tag", tags[0].name_);
+  return tags[0].value_ + "|" + StringUtil::removeCharacters(stat_name, remove_characters);
+}
+
+TEST(TagExtractorTokensTest, Elements) {
+  EXPECT_EQ("foo|cluster.upstream_rq_total",
+            extractTokens("cluster.$.*.**", "cluster.foo.upstream_rq_total"));
+  EXPECT_EQ("foo|cluster.a.b.c", extractTokens("cluster.$.*.**", "cluster.foo.a.b.c"));
+  EXPECT_EQ("", extractTokens("cluster.$.*.**", "cluster.foo"));
+  EXPECT_EQ("", extractTokens("cluster.$.*.**", "listener.foo.bar"));
+
+  // '**' prefers as few tokens as possible, so the first 'grpc' is used.
+  EXPECT_EQ("a|cluster.c.grpc.grpc.b.x",
+            extractTokens("cluster.**.grpc.$.*.**", "cluster.c.grpc.a.grpc.b.x"));
+
+  // '$$' captures a run of tokens; at the end of the name the preceding '.' is removed.
+  EXPECT_EQ("a.b|tcp.total", extractTokens("tcp.$$.#", "tcp.a.b.total"));
+  EXPECT_EQ("AES256-SHA|listener.x.ssl.cipher",
+            extractTokens("listener.**.ssl.cipher.$$", "listener.x.ssl.cipher.AES256-SHA"));
+
+  // '#' only matches words.
+  EXPECT_EQ("", extractTokens("tcp.$$.#", "tcp.a.b-c"));
+  EXPECT_EQ("", extractTokens("tcp.$$.#", "tcp.a."));
+
+  // Literal alternatives.
+  EXPECT_EQ("t|http.dynamodb.table.x",
+            extractTokens("http.**.dynamodb.table|error.$.*.**", "http.dynamodb.table.t.x"));
+  EXPECT_EQ("t|http.p.dynamodb.error.x",
+            extractTokens("http.**.dynamodb.table|error.$.*.**", "http.p.dynamodb.error.t.x"));
+  EXPECT_EQ("", extractTokens("http.**.dynamodb.table|error.$.*.**", "http.dynamodb.tables.t.x"));
+
+  // Elements match whole tokens only.
+  EXPECT_EQ("", extractTokens("mongo.**.cmd.$$.#", "mongo.p.xcmd.c.total"));
+}
+
+TEST(TagExtractorTokensTest, PrefixToken) {
+  TagExtractorTokensImpl tag_extractor("tag", "auth.clientssl.$$.#");
+  EXPECT_EQ("tag", tag_extractor.name());
+  EXPECT_EQ("auth", tag_extractor.prefixToken());
+}
+
+TEST(TagExtractorTokensTest, BadPattern) {
+  EXPECT_THROW_WITH_MESSAGE(TagExtractorTokensImpl("", "cluster.$.**"), EnvoyException,
+                            "tag_name cannot be empty");
+  EXPECT_THROW_WITH_MESSAGE(TagExtractorTokensImpl("tag", ""), EnvoyException,
+                            "Tag pattern '' for 'tag' must start with a literal token");
+  EXPECT_THROW_WITH_MESSAGE(TagExtractorTokensImpl("tag", "**.$"), EnvoyException,
+                            "Tag pattern '**.$' for 'tag' must start with a literal token");
+  EXPECT_THROW_WITH_MESSAGE(TagExtractorTokensImpl("tag", "a|b.$"), EnvoyException,
+                            "Tag pattern 'a|b.$' for 'tag' must start with a literal token");
+  EXPECT_THROW_WITH_MESSAGE(TagExtractorTokensImpl("tag", "cluster.**"), EnvoyException,
+                            "Tag pattern 'cluster.**' for 'tag' must capture exactly one value");
+  EXPECT_THROW_WITH_MESSAGE(TagExtractorTokensImpl("tag", "cluster.$.$$"), EnvoyException,
+                            "Tag pattern 'cluster.$.$$' for 'tag' must capture exactly one value");
+}
+
+// Every default token pattern must make the same extraction as the regex it replaces.
+TEST(TagExtractorTokensTest, DefaultPatternsMatchRegexes) {
+  const std::vector<std::string> stat_names = {
+      "cluster.ratelimit.upstream_rq_timeout",
+      "cluster.ratelimit.ssl.ciphers.ECDHE-RSA-AES128-GCM-SHA256",
+      "cluster.grpc_cluster.grpc.grpc_service_1.grpc_method_1.success",
+      "cluster.c.grpc.grpc_method_1.success",
+      "cluster.c.grpc.s.grpc.m.success",
+      "cluster.foo",
+      "cluster..bar",
+      "listener.[__1]_0.ssl.cipher.AES256-SHA",
+      "listener.127.0.0.1_3012.http.http_prefix.downstream_rq_5xx",
+      "listener.127.0.0.1_3012.ssl.cipher.",
+      "mongo.mongo_filter.op_reply",
+      "mongo.mongo_filter.cmd.foo_cmd.reply_size",
+      "mongo.mongo_filter.cmd.foo.cmd.reply_size",
+      "mongo.mongo_filter.collection.bar_collection.query.multi_get",
+      "mongo.mongo_filter.collection.bar_collection.callsite.baz_callsite.query.scatter_get",
+      "mongo.m.collection.c.callsite.s.x.query.total",
+      "ratelimit.foo_ratelimiter.over_limit",
+      "ratelimit.a.b.over_limit",
+      "http.egress_dynamodb_iad.downstream_cx_total",
+      "http.egress_dynamodb_iad.dynamodb.operation.Query.upstream_rq_time",
+      "http.egress_dynamodb_iad.dynamodb.table.bar_table.upstream_rq_time",
+      "http.egress_dynamodb_iad.dynamodb.error.bar_table.BadRequest",
+      "http.egress_dynamodb_iad.dynamodb.table.bar_table.capacity.Query.__partition_id=ABC1234",
+      "http.egress_dynamodb_iad.user_agent.ios.downstream_cx_total",
+      "http.fault_connection_manager.fault.fault_cluster.aborts_injected",
+      "http.f.fault.a.b.aborts_injected",
+      "vhost.vhost_1.vcluster.vcluster_1.upstream_rq_2xx",
+      "vhost.vcluster.upstream_rq_2xx",
+      "auth.clientssl.clientssl_prefix.auth_ip_white_list",
+      "tcp.tcp_prefix.downstream_flow_control_resumed_reading_total",
+      "tcp.tcp_prefix.a-b",
+  };
+
+  for (const auto& desc : Config::TagNames::get().descriptorVec()) {
+    if (desc.tokens_.empty()) {
+      continue;
+    }
+    TagExtractorImpl regex_extractor(desc.name_, desc.regex_);
+    TagExtractorTokensImpl tokens_extractor(desc.name_, desc.tokens_);
+    for (const std::string& stat_name : stat_names) {
+      std::vector<Tag> regex_tags;
+      IntervalSetImpl<size_t> regex_remove_characters;
+      const bool regex_match =
+          regex_extractor.extractTag(stat_name, regex_tags, regex_remove_characters);
+
+      std::vector<Tag> tokens_tags;
+      IntervalSetImpl<size_t> tokens_remove_characters;
+      const bool tokens_match =
+          tokens_extractor.extractTag(stat_name, tokens_tags, tokens_remove_characters);
+
+      ASSERT_EQ(regex_match, tokens_match) << desc.tokens_ << " " << stat_name;
+      if (regex_match) {
+        EXPECT_EQ(regex_tags[0].value_, tokens_tags[0].value_) << desc.tokens_ << " " << stat_name;
+        EXPECT_EQ(StringUtil::removeCharacters(stat_name, regex_remove_characters),
+                  StringUtil::removeCharacters(stat_name, tokens_remove_characters))
+            << desc.tokens_ << " " << stat_name;
+      }
+    }
+  }
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -55,5 +55,22 @@ TEST(TagProducerTest, CheckConstructor) {
       "No regex specified for tag specifier and no default regex for name: 'test_extractor'");
 }
 
+// Token-pattern and regex extractors that share a prefix must produce tags in the order their
+// descriptors are listed, regardless of the extractor kind.
+TEST(TagProducerTest, MixedExtractorsKeepDescriptorOrder) {
+  const envoy::config::metrics::v2::StatsConfig stats_config;
+  const TagProducerImpl tag_producer{stats_config};
+
+  std::vector<Tag> tags;
+  EXPECT_EQ("listener.http.downstream_cx_total",
+            tag_producer.produceTags("listener.127.0.0.1_3012.http.http_prefix.downstream_cx_total",
+                                     tags));
+  ASSERT_EQ(2, tags.size());
+  EXPECT_EQ(Config::TagNames::get().HTTP_CONN_MANAGER_PREFIX, tags[0].name_);
+  EXPECT_EQ("http_prefix", tags[0].value_);
+  EXPECT_EQ(Config::TagNames::get().LISTENER_ADDRESS, tags[1].name_);
+  EXPECT_EQ("127.0.0.1_3012", tags[1].value_);
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -22,7 +22,8 @@ namespace Envoy {
 class ThreadLocalStorePerf {
 public:
   ThreadLocalStorePerf()
-      : store_(options_, heap_alloc_), api_(Api::createApiForTest(store_, time_system_)) {
+      : heap_alloc_(symbol_table_), store_(options_, heap_alloc_),
+        api_(Api::createApiForTest(store_, time_system_)) {
     store_.setTagProducer(std::make_unique<Stats::TagProducerImpl>(stats_config_));
   }
 
@@ -47,6 +48,7 @@ public:
 private:
   Event::SimulatedTimeSystem time_system_;
   Stats::StatsOptionsImpl options_;
+  Stats::SymbolTableImpl symbol_table_;
   Stats::HeapStatDataAllocator heap_alloc_;
   Stats::ThreadLocalStoreImpl store_;
   Api::ApiPtr api_;
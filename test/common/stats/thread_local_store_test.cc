@@ -635,7 +635,8 @@ public:
     store_.reset(); // delete before the allocator.
   }
 
-  HeapStatDataAllocator heap_alloc_;
+  SymbolTableImpl symbol_table_;
+  HeapStatDataAllocator heap_alloc_{symbol_table_};
 };
 
 TEST_F(HeapStatsThreadLocalStoreTest, RemoveRejectedStats) {
@@ -668,6 +669,40 @@ TEST_F(HeapStatsThreadLocalStoreTest, RemoveRejectedStats) {
   histogram.recordValue(42);
 }
 
+TEST_F(HeapStatsThreadLocalStoreTest, StatsWithPrefix) {
+  ScopePtr foo = store_->createScope("cluster.foo.");
+  ScopePtr foo_overlap = store_->createScope("cluster.foo.");
+  ScopePtr foobar = store_->createScope("cluster.foobar.");
+  ScopePtr bar = store_->createScope("cluster.bar.");
+  foo->counter("c1");
+  foo_overlap->counter("c1");
+  foobar->counter("c2");
+  bar->counter("c3");
+  store_->counter("cluster.foo.c4");
+  foo->gauge("g1");
+  bar->gauge("g2");
+  foo->histogram("h1");
+  bar->histogram("h2");
+
+  // Stats in the root scope and in overlapping scopes are found, and de-duplicated.
+  std::vector<std::string> names;
+  for (const CounterSharedPtr& counter : store_->countersWithPrefix("cluster.foo.")) {
+    names.push_back(counter->name());
+  }
+  std::sort(names.begin(), names.end());
+  EXPECT_EQ(std::vector<std::string>({"cluster.foo.c1", "cluster.foo.c4"}), names);
+
+  // A prefix that ends part way through a scope's prefix matches all of its stats.
+  EXPECT_EQ(3, store_->countersWithPrefix("cluster.foo").size());
+  EXPECT_EQ(5, store_->countersWithPrefix("").size()); // Including "stats.overflow".
+  EXPECT_EQ(0, store_->countersWithPrefix("cluster.foo.c1.").size());
+
+  ASSERT_EQ(1, store_->gaugesWithPrefix("cluster.bar.").size());
+  EXPECT_EQ("cluster.bar.g2", store_->gaugesWithPrefix("cluster.bar.")[0]->name());
+  ASSERT_EQ(1, store_->histogramsWithPrefix("cluster.foo.h").size());
+  EXPECT_EQ("cluster.foo.h1", store_->histogramsWithPrefix("cluster.foo.h")[0]->name());
+}
+
 TEST_F(HeapStatsThreadLocalStoreTest, NonHotRestartNoTruncation) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -703,7 +738,7 @@ TEST_F(HeapStatsThreadLocalStoreTest, MemoryWithoutTls) {
       1000, [this](absl::string_view name) { store_->counter(std::string(name)); });
   const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
   EXPECT_LT(start_mem, end_mem);
-  EXPECT_LT(end_mem - start_mem, 28 * million); // actual value: 27203216 as of Oct 29, 2018
+  EXPECT_LT(end_mem - start_mem, 13 * million); // actual value: 12448208 as of Oct 17, 2026
 }
 
 TEST_F(HeapStatsThreadLocalStoreTest, MemoryWithTls) {
@@ -726,7 +761,34 @@ TEST_F(HeapStatsThreadLocalStoreTest, MemoryWithTls) {
       1000, [this](absl::string_view name) { store_->counter(std::string(name)); });
   const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
   EXPECT_LT(start_mem, end_mem);
-  EXPECT_LT(end_mem - start_mem, 31 * million); // actual value: 30482576 as of Oct 29, 2018
+  EXPECT_LT(end_mem - start_mem, 16 * million); // actual value: 15725200 as of Oct 17, 2026
+}
+
+// Tests how much memory each additional cluster's stats consume once the tokens they share with
+// other clusters are in the symbol table.
+TEST_F(HeapStatsThreadLocalStoreTest, MemoryPerCluster) {
+  if (!TestUtil::hasDeterministicMallocStats()) {
+    return;
+  }
+
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  store_->setTagProducer(std::make_unique<TagProducerImpl>(stats_config));
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+  auto make_counter = [this](absl::string_view name) { store_->counter(std::string(name)); };
+
+  // The stats of the first cluster, which are already present below, add the shared tokens.
+  TestUtil::forEachSampleStat(0, make_counter);
+  const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+  if (start_mem == 0) {
+    // Skip this test for platforms where we can't measure memory.
+    return;
+  }
+  TestUtil::forEachSampleStat(1000, make_counter);
+  const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+  EXPECT_LT(start_mem, end_mem);
+  const size_t per_cluster = (end_mem - start_mem) / 1000;
+  ENVOY_LOG_MISC(info, "memory per cluster: {} bytes", per_cluster);
+  EXPECT_LT(per_cluster, 16000); // actual value: 15698 as of Oct 17, 2026
 }
 
 TEST_F(StatsThreadLocalStoreTest, ShuttingDown) {
@@ -944,6 +1006,132 @@ TEST_F(HistogramTest, BasicHistogramUsed) {
   }
 }
 
+// Histograms matching a bucket setting compute statistics for its buckets, and others keep the
+// default buckets.
+TEST_F(HistogramTest, ConfiguredBuckets) {
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  auto* bucket_settings = stats_config.add_histogram_bucket_settings();
+  bucket_settings->mutable_match()->set_prefix("h1");
+  bucket_settings->add_buckets(1);
+  bucket_settings->add_buckets(10);
+  bucket_settings->add_buckets(100);
+  store_->setHistogramSettings(std::make_unique<HistogramSettingsImpl>(stats_config));
+
+  Histogram& h1 = store_->histogram("h1");
+  Histogram& h2 = store_->histogram("h2");
+  for (size_t i = 0; i < 50; ++i) {
+    expectCallAndAccumulate(h1, i);
+  }
+  expectCallAndAccumulate(h2, 1);
+  store_->mergeHistograms([]() -> void {});
+
+  NameHistogramMap name_histogram_map = makeHistogramMap(store_->histograms());
+  EXPECT_EQ("B1: 1, B10: 10, B100: 50",
+            name_histogram_map["h1"]->cumulativeStatistics().bucketSummary());
+  EXPECT_EQ("B1: 1, B10: 10, B100: 50",
+            name_histogram_map["h1"]->intervalStatistics().bucketSummary());
+  EXPECT_EQ(HistogramSettingsImpl::defaultBuckets(),
+            name_histogram_map["h2"]->cumulativeStatistics().supportedBuckets());
+}
+
+// An interval with no recorded values leaves the cumulative statistics alone and empties the
+// interval statistics.
+TEST_F(HistogramTest, IdleIntervalAfterMerge) {
+  Histogram& h1 = store_->histogram("h1");
+  for (size_t i = 0; i < 100; ++i) {
+    expectCallAndAccumulate(h1, i);
+  }
+  EXPECT_EQ(1, validateMerge());
+  EXPECT_EQ(1, validateMerge());
+
+  NameHistogramMap name_histogram_map = makeHistogramMap(store_->histograms());
+  EXPECT_EQ(100, name_histogram_map["h1"]->cumulativeStatistics().sampleCount());
+  EXPECT_EQ(0, name_histogram_map["h1"]->intervalStatistics().sampleCount());
+  EXPECT_TRUE(name_histogram_map["h1"]->used());
+}
+
+// A histogram keeps its buckets when the settings that supplied them are replaced.
+TEST_F(HistogramTest, BucketsOutliveSettings) {
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  auto* bucket_settings = stats_config.add_histogram_bucket_settings();
+  bucket_settings->mutable_match()->set_exact("h1");
+  bucket_settings->add_buckets(1);
+  bucket_settings->add_buckets(10);
+  store_->setHistogramSettings(std::make_unique<HistogramSettingsImpl>(stats_config));
+
+  Histogram& h1 = store_->histogram("h1");
+  store_->setHistogramSettings(std::make_unique<HistogramSettingsImpl>());
+  expectCallAndAccumulate(h1, 5);
+  store_->mergeHistograms([]() -> void {});
+
+  NameHistogramMap name_histogram_map = makeHistogramMap(store_->histograms());
+  EXPECT_EQ("B1: 0, B10: 1", name_histogram_map["h1"]->intervalStatistics().bucketSummary());
+}
+
+// Values recorded into a TLS histogram that is destroyed before the next merge are kept.
+TEST(ThreadLocalHistogramImplTest, DestroyedBeforeMerge) {
+  SymbolTableImpl symbol_table;
+  StatNameTempStorage name("h1", symbol_table);
+  HistogramAccumulatorSharedPtr accumulator = std::make_shared<HistogramAccumulator>();
+  {
+    ThreadLocalHistogramImpl histogram(name.statName(), "h1", {}, symbol_table, accumulator);
+    histogram.recordValue(1);
+    histogram.recordValue(2);
+  }
+
+  histogram_t* merged = hist_alloc();
+  EXPECT_TRUE(accumulator->moveTo(merged));
+  EXPECT_EQ(2, hist_sample_count(merged));
+  hist_free(merged);
+}
+
+// A TLS histogram that recorded nothing since the previous merge leaves the accumulator alone, even
+// though its buckets outlive the merge.
+TEST(ThreadLocalHistogramImplTest, IdleMergeNotPending) {
+  SymbolTableImpl symbol_table;
+  StatNameTempStorage name("h1", symbol_table);
+  HistogramAccumulatorSharedPtr accumulator = std::make_shared<HistogramAccumulator>();
+  histogram_t* merged = hist_alloc();
+  {
+    ThreadLocalHistogramImpl histogram(name.statName(), "h1", {}, symbol_table, accumulator);
+    histogram.recordValue(1);
+    histogram.merge();
+    EXPECT_TRUE(accumulator->moveTo(merged));
+    EXPECT_EQ(1, hist_sample_count(merged));
+
+    histogram.merge();
+    EXPECT_FALSE(accumulator->moveTo(merged));
+  }
+  // Nor does destroying it.
+  EXPECT_FALSE(accumulator->moveTo(merged));
+  hist_free(merged);
+}
+
+TEST(HistogramSettingsImplTest, RejectsUnorderedBuckets) {
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  auto* bucket_settings = stats_config.add_histogram_bucket_settings();
+  bucket_settings->mutable_match()->set_exact("h1");
+  bucket_settings->add_buckets(10);
+  bucket_settings->add_buckets(1);
+  EXPECT_THROW_WITH_MESSAGE(HistogramSettingsImpl settings(stats_config), EnvoyException,
+                            "histogram buckets must be positive and strictly increasing: [10, 1]");
+}
+
+TEST(HistogramSettingsImplTest, FirstMatchWins) {
+  envoy::config::metrics::v2::StatsConfig stats_config;
+  auto* first = stats_config.add_histogram_bucket_settings();
+  first->mutable_match()->set_prefix("cluster.");
+  first->add_buckets(5);
+  auto* second = stats_config.add_histogram_bucket_settings();
+  second->mutable_match()->set_suffix(".upstream_rq_time");
+  second->add_buckets(7);
+  HistogramSettingsImpl settings(stats_config);
+
+  EXPECT_EQ(std::vector<double>({5}), settings.buckets("cluster.foo.upstream_rq_time"));
+  EXPECT_EQ(std::vector<double>({7}), settings.buckets("http.ingress.upstream_rq_time"));
+  EXPECT_EQ(HistogramSettingsImpl::defaultBuckets(), settings.buckets("server.initialization"));
+}
+
 class TruncatingAllocTest : public HeapStatsThreadLocalStoreTest {
 protected:
   TruncatingAllocTest() : test_alloc_(options_), long_name_(options_.maxNameLength() + 1, 'A') {}
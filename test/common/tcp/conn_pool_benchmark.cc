@@ -0,0 +1,129 @@
+// Usage: bazel run //test/common/tcp:conn_pool_benchmark
+
+#include <memory>
+#include <vector>
+
+#include "common/tcp/conn_pool.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::_;
+using testing::InvokeWithoutArgs;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Tcp {
+namespace {
+
+// One in-flight request. It holds its connection once the pool has assigned one.
+struct RequestSlot : public ConnectionPool::Callbacks {
+  // ConnectionPool::Callbacks
+  void onPoolReady(ConnectionPool::ConnectionDataPtr&& conn,
+                   Upstream::HostDescriptionConstSharedPtr) override {
+    conn_data_ = std::move(conn);
+  }
+  void onPoolFailure(ConnectionPool::PoolFailureReason,
+                     Upstream::HostDescriptionConstSharedPtr) override {}
+
+  ConnectionPool::Cancellable* handle_{};
+  ConnectionPool::ConnectionDataPtr conn_data_;
+};
+
+class ConnPoolTester {
+public:
+  ConnPoolTester(uint64_t max_connections)
+      : upstream_ready_timer_(new NiceMock<Event::MockTimer>(&dispatcher_)) {
+    cluster_->resetResourceManager(max_connections, 1 << 20, 1 << 20, 1);
+    ON_CALL(dispatcher_, createClientConnection_(_, _, _, _))
+        .WillByDefault(InvokeWithoutArgs([this]() -> Network::ClientConnection* {
+          connections_.push_back(new NiceMock<Network::MockClientConnection>());
+          return connections_.back();
+        }));
+    pool_ = std::make_unique<ConnPoolImpl>(
+        dispatcher_, Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:9000"),
+        Upstream::ResourcePriority::Default, nullptr, nullptr);
+  }
+
+  void newRequest(RequestSlot& slot) {
+    slot.handle_ = pool_->newConnection(slot);
+    // Connections come up immediately, as they would on a warm upstream.
+    for (; connected_ < connections_.size(); connected_++) {
+      connections_[connected_]->raiseEvent(Network::ConnectionEvent::Connected);
+    }
+  }
+
+  void completeRequest(RequestSlot& slot) {
+    slot.conn_data_.reset();
+    // Released connections serve pending requests on the next dispatcher iteration.
+    upstream_ready_timer_->callback_();
+  }
+
+  void finish(std::vector<RequestSlot>& slots) {
+    for (RequestSlot& slot : slots) {
+      if (slot.conn_data_ == nullptr && slot.handle_ != nullptr) {
+        slot.handle_->cancel(ConnectionPool::CancelPolicy::Default);
+      }
+    }
+    for (RequestSlot& slot : slots) {
+      slot.conn_data_.reset();
+    }
+  }
+
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  NiceMock<Event::MockTimer>* upstream_ready_timer_;
+  std::vector<Network::MockClientConnection*> connections_;
+  size_t connected_{};
+  std::unique_ptr<ConnPoolImpl> pool_;
+};
+
+// Times dispatching one request with state.range(0) requests in flight over at most
+// state.range(1) connections. Each iteration completes the oldest request and issues a new one.
+// A worker serving 10k RPS against a 10ms upstream keeps about 100 requests in flight; with fewer
+// connections than that, the excess requests wait in the pending queue.
+void BM_TcpConnPoolDispatch(benchmark::State& state) {
+  const uint64_t concurrency = state.range(0);
+  ConnPoolTester tester(state.range(1));
+  std::vector<RequestSlot> slots(concurrency);
+  for (RequestSlot& slot : slots) {
+    tester.newRequest(slot);
+  }
+
+  uint64_t next_slot = 0;
+  for (auto _ : state) {
+    RequestSlot& slot = slots[next_slot];
+    tester.completeRequest(slot);
+    tester.newRequest(slot);
+    next_slot = (next_slot + 1) % concurrency;
+  }
+
+  tester.finish(slots);
+}
+BENCHMARK(BM_TcpConnPoolDispatch)
+    ->Args({1, 1})
+    ->Args({100, 100})
+    ->Args({100, 10})
+    ->Args({1000, 100});
+
+} // namespace
+} // namespace Tcp
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_context(spdlog::level::warn,
+                                         Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
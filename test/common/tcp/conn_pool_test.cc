@@ -88,6 +88,14 @@ public:
   MOCK_METHOD0(onConnReleasedForTest, void());
   MOCK_METHOD0(onConnDestroyedForTest, void());
 
+  size_t freePendingRequests() const { return free_pending_requests_.size(); }
+  bool upstreamReadyEnabled() const { return upstream_ready_enabled_; }
+
+  // Sets a health flag on the pool's host, as a health checker or outlier detector would.
+  void setHostHealthFlag(Upstream::Host::HealthFlag flag) {
+    std::const_pointer_cast<Upstream::Host>(host_)->healthFlagSet(flag);
+  }
+
   struct TestConnection {
     Network::MockClientConnection* connection_;
     Event::MockTimer* connect_timer_;
@@ -444,6 +452,32 @@ TEST_F(TcpConnPoolImplTest, MultipleRequestAndResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that the connection which was released most recently is the first one reused.
+ */
+TEST_F(TcpConnPoolImplTest, MostRecentlyReleasedConnectionReused) {
+  cluster_->resetResourceManager(2, 1024, 1024, 1);
+  InSequence s;
+
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+  ActiveTestConn c2(*this, 1, ActiveTestConn::Type::CreateConnection);
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c1.releaseConn();
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c2.releaseConn();
+
+  // Connection 1 was released last, so it is assigned next.
+  ActiveTestConn c3(*this, 1, ActiveTestConn::Type::Immediate);
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c3.releaseConn();
+
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(2);
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Tests ConnectionState assignment, lookup and destruction.
  */
@@ -615,6 +649,66 @@ TEST_F(TcpConnPoolImplTest, CancelBeforeBound) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a cancelled pending request is recycled for the next queued request.
+ */
+TEST_F(TcpConnPoolImplTest, PendingRequestReusedAfterCancel) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1);
+  InSequence s;
+
+  ConnPoolCallbacks callbacks;
+  conn_pool_.expectConnCreate();
+  Tcp::ConnectionPool::Cancellable* handle = conn_pool_.newConnection(callbacks);
+  EXPECT_NE(nullptr, handle);
+  handle->cancel(ConnectionPool::CancelPolicy::Default);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+
+  ConnPoolCallbacks callbacks2;
+  Tcp::ConnectionPool::Cancellable* handle2 = conn_pool_.newConnection(callbacks2);
+  EXPECT_EQ(handle, handle2);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pending_active_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_pending_total_.value());
+
+  // The recycled request is bound to the second caller.
+  EXPECT_CALL(*conn_pool_.test_conns_[0].connect_timer_, disableTimer());
+  EXPECT_CALL(callbacks2.pool_ready_, ready());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  callbacks2.conn_data_.reset();
+
+  // Cause the connection to go away.
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that only a bounded number of released pending requests are kept for reuse.
+ */
+TEST_F(TcpConnPoolImplTest, FreePendingRequestsBounded) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1);
+  InSequence s;
+
+  ConnPoolCallbacks callbacks;
+  conn_pool_.expectConnCreate();
+  std::vector<Tcp::ConnectionPool::Cancellable*> handles;
+  for (size_t i = 0; i < 100; ++i) {
+    handles.push_back(conn_pool_.newConnection(callbacks));
+  }
+  for (Tcp::ConnectionPool::Cancellable* handle : handles) {
+    handle->cancel(ConnectionPool::CancelPolicy::Default);
+  }
+  EXPECT_EQ(64U, conn_pool_.freePendingRequests());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pending_active_.value());
+
+  // Cause the connection to go away.
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Test cancelling before the request is bound to a connection, with connection close.
  */
@@ -795,6 +889,219 @@ TEST_F(TcpConnPoolImplTest, ConcurrentConnections) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that a prefetch ratio opens a spare connection, which is then assigned to the next caller.
+ */
+TEST_F(TcpConnPoolImplTest, PrefetchSpareConnection) {
+  cluster_->resetResourceManager(2, 1024, 1024, 1);
+  cluster_->per_upstream_prefetch_ratio_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+
+  // One connection is in use, so a second one is prefetched.
+  conn_pool_.expectConnCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*conn_pool_.test_conns_[1].connect_timer_, disableTimer());
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c2(*this, 1, ActiveTestConn::Type::Immediate);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_prefetch_hit_.value());
+
+  // Prefetching stops at the connection limit.
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest()).Times(2);
+  c1.releaseConn();
+  c2.releaseConn();
+
+  // Connections closed by the host are not replaced.
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(2);
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that warm connections are kept open and that a caller waits for a prefetched connection
+ * that is still connecting rather than opening another one.
+ */
+TEST_F(TcpConnPoolImplTest, PrefetchMinWarmConnections) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+
+  conn_pool_.expectConnCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c2(*this, 1, ActiveTestConn::Type::Pending);
+  c2.completeConnection();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_prefetch_hit_.value());
+
+  // Both connections are in use, which satisfies the warm connection minimum.
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest()).Times(2);
+  c1.releaseConn();
+  c2.releaseConn();
+
+  // Connections closed by the host are not replaced.
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(2);
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that a warm connection that is closed locally is replaced.
+ */
+TEST_F(TcpConnPoolImplTest, PrefetchReplacesClosedWarmConnection) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+
+  conn_pool_.expectConnCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*conn_pool_.test_conns_[1].connect_timer_, disableTimer());
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // The idle warm connection is closed locally without any new caller arriving.
+  conn_pool_.expectEnableUpstreamReady();
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::LocalClose);
+  dispatcher_.clearDeferredDeleteList();
+
+  conn_pool_.expectConnCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c1.releaseConn();
+
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(2);
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that a host refusing the prefetched connection is not reconnected to until a caller
+ * arrives.
+ */
+TEST_F(TcpConnPoolImplTest, PrefetchNotRetriedAfterConnectFailure) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+
+  conn_pool_.expectConnCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_connect_fail_.value());
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c1.releaseConn();
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+}
+
+/**
+ * Test that the connections drained on a host health failure are not reopened, and that the pool
+ * does not prefetch to the host while it is unhealthy.
+ */
+TEST_F(TcpConnPoolImplTest, PrefetchStopsOnHostHealthFailure) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 2;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+
+  conn_pool_.expectConnCreate();
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_CALL(*conn_pool_.test_conns_[1].connect_timer_, disableTimer());
+  conn_pool_.test_conns_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c1.releaseConn();
+
+  // This is what ThreadLocalClusterManagerImpl::onHostHealthFailure() does.
+  conn_pool_.setHostHealthFlag(Upstream::Host::HealthFlag::FAILED_ACTIVE_HC);
+  EXPECT_CALL(*upstream_ready_timer_, enableTimer(_)).Times(0);
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest()).Times(2);
+  conn_pool_.drainConnections();
+  dispatcher_.clearDeferredDeleteList();
+
+  // Drained connections are gone, so the new connection is test connection 0 again.
+  ActiveTestConn c2(*this, 0, ActiveTestConn::Type::CreateConnection);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c2.releaseConn();
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that drained connections are not reopened until the host is picked by a caller again.
+ */
+TEST_F(TcpConnPoolImplTest, PrefetchSuppressedAfterDrain) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1);
+  cluster_->min_warm_connections_ = 1;
+  InSequence s;
+
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c1(*this, 0, ActiveTestConn::Type::CreateConnection);
+  conn_pool_.expectAndRunUpstreamReady();
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c1.releaseConn();
+
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.drainConnections();
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_FALSE(conn_pool_.upstreamReadyEnabled());
+
+  // The next caller schedules prefetching again.
+  conn_pool_.expectEnableUpstreamReady();
+  ActiveTestConn c2(*this, 0, ActiveTestConn::Type::CreateConnection);
+  conn_pool_.expectAndRunUpstreamReady();
+
+  EXPECT_CALL(conn_pool_, onConnReleasedForTest());
+  c2.releaseConn();
+  EXPECT_CALL(conn_pool_, onConnDestroyedForTest());
+  conn_pool_.test_conns_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 /**
  * Tests ConnectionState lifecycle with multiple concurrent connections.
  */
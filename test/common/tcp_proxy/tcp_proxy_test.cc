@@ -20,6 +20,7 @@
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/server/mocks.h"
+#include "test/mocks/ssl/mocks.h"
 #include "test/mocks/stream_info/mocks.h"
 #include "test/mocks/tcp/mocks.h"
 #include "test/mocks/upstream/host.h"
@@ -842,6 +843,56 @@ TEST_F(TcpProxyTest, IdleTimeout) {
   idle_timer->callback_();
 }
 
+// Tests that data is relayed through the connections when splicing is enabled but a connection uses
+// TLS.
+TEST_F(TcpProxyTest, SpliceFallbackWithTls) {
+  envoy::config::filter::network::tcp_proxy::v2::TcpProxy config = defaultConfig();
+  config.set_splice(true);
+  setup(1, config);
+
+  NiceMock<Ssl::MockConnection> ssl;
+  ON_CALL(filter_callbacks_.connection_, ssl()).WillByDefault(Return(&ssl));
+  EXPECT_CALL(filter_callbacks_.connection_, ioHandle()).Times(0);
+  EXPECT_CALL(*upstream_connections_.at(0), ioHandle()).Times(0);
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().splice_total_.value());
+  EXPECT_EQ(1U, config_->stats().splice_fallback_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
+  filter_->onData(buffer, false);
+
+  Buffer::OwnedImpl response("world");
+  EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), true));
+  upstream_callbacks_->onUpstreamData(response, true);
+}
+
+// Tests that data is relayed through the connections when splicing is enabled but a connection uses
+// a secure transport socket other than TLS, which has no Ssl::Connection (e.g. ALTS).
+TEST_F(TcpProxyTest, SpliceFallbackWithNonTlsSecureTransport) {
+  envoy::config::filter::network::tcp_proxy::v2::TcpProxy config = defaultConfig();
+  config.set_splice(true);
+  setup(1, config);
+
+  ON_CALL(filter_callbacks_.connection_, transportSocketIsPassthrough())
+      .WillByDefault(Return(true));
+  ON_CALL(*upstream_connections_.at(0), transportSocketIsPassthrough())
+      .WillByDefault(Return(false));
+  EXPECT_CALL(filter_callbacks_.connection_, ioHandle()).Times(0);
+  EXPECT_CALL(*upstream_connections_.at(0), ioHandle()).Times(0);
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().splice_total_.value());
+  EXPECT_EQ(1U, config_->stats().splice_fallback_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
+  filter_->onData(buffer, false);
+
+  Buffer::OwnedImpl response("world");
+  EXPECT_CALL(filter_callbacks_.connection_, write(BufferEqual(&response), true));
+  upstream_callbacks_->onUpstreamData(response, true);
+}
+
 // Tests that the idle timer is disabled when the downstream connection is closed.
 TEST_F(TcpProxyTest, IdleTimerDisabledDownstreamClose) {
   envoy::config::filter::network::tcp_proxy::v2::TcpProxy config = defaultConfig();
@@ -203,7 +203,8 @@ public:
         factory_.local_info_, log_manager_, factory_.dispatcher_, admin_, *api_, http_context_);
   }
 
-  void createWithLocalClusterUpdate(const bool enable_merge_window = true) {
+  void createWithLocalClusterUpdate(const bool enable_merge_window = true,
+                                    const bool merge_membership_updates = false) {
     std::string yaml = R"EOF(
   static_resources:
     clusters:
@@ -228,7 +229,14 @@ public:
         update_merge_window: 0s
   )EOF";
 
+    const std::string merge_membership_enabled = R"EOF(
+        merge_membership_updates: true
+  )EOF";
+
     yaml += enable_merge_window ? merge_window_enabled : merge_window_disabled;
+    if (merge_membership_updates) {
+      yaml += merge_membership_enabled;
+    }
 
     const auto& bootstrap = parseBootstrapFromV2Yaml(yaml);
 
@@ -2307,6 +2315,94 @@ TEST_F(ClusterManagerImplTest, MergedUpdatesOutOfWindowDisabled) {
   EXPECT_EQ(0, factory_.stats_.counter("cluster_manager.update_merge_cancelled").value());
 }
 
+// Tests that membership changes are merged into a single net change when
+// merge_membership_updates is set.
+TEST_F(ClusterManagerImplTest, MergedMembershipUpdates) {
+  createWithLocalClusterUpdate(true, true);
+
+  Event::MockTimer* timer = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Cluster& cluster = cluster_manager_->activeClusters().begin()->second;
+  HostVectorSharedPtr hosts(
+      new HostVector(cluster.prioritySet().hostSetsPerPriority()[0]->hosts()));
+  HostsPerLocalitySharedPtr hosts_per_locality = std::make_shared<HostsPerLocalityImpl>();
+  HostSharedPtr removed_host = (*hosts)[0];
+  HostSharedPtr transient_host = makeTestHost(cluster.info(), "tcp://127.0.0.1:11003");
+  HostSharedPtr added_host = makeTestHost(cluster.info(), "tcp://127.0.0.1:11004");
+
+  // Nothing is delivered until the merge window expires, and then only the net change: the host
+  // that was added and removed again within the window is never seen by the workers.
+  EXPECT_CALL(local_hosts_removed_, post(_)).Times(0);
+  EXPECT_CALL(local_cluster_update_, post(_, _, _)).Times(0);
+
+  cluster.prioritySet().updateHosts(
+      0, HostSetImpl::updateHostsParams(hosts, hosts_per_locality, hosts, hosts_per_locality), {},
+      {}, {removed_host}, absl::nullopt);
+  cluster.prioritySet().updateHosts(
+      0, HostSetImpl::updateHostsParams(hosts, hosts_per_locality, hosts, hosts_per_locality), {},
+      {transient_host, added_host}, {}, absl::nullopt);
+  cluster.prioritySet().updateHosts(
+      0, HostSetImpl::updateHostsParams(hosts, hosts_per_locality, hosts, hosts_per_locality), {},
+      {}, {transient_host}, absl::nullopt);
+  EXPECT_EQ(0, factory_.stats_.counter("cluster_manager.cluster_updated").value());
+  EXPECT_EQ(0, factory_.stats_.counter("cluster_manager.cluster_updated_via_merge").value());
+  EXPECT_EQ(2, factory_.stats_.counter("cluster_manager.update_merged").value());
+
+  EXPECT_CALL(local_hosts_removed_, post(_)).WillOnce(Invoke([&](const HostVector& hosts_removed) {
+    EXPECT_EQ(HostVector{removed_host}, hosts_removed);
+  }));
+  EXPECT_CALL(local_cluster_update_, post(_, _, _))
+      .WillOnce(Invoke([&](uint32_t priority, const HostVector& hosts_added,
+                           const HostVector& hosts_removed) -> void {
+        EXPECT_EQ(0, priority);
+        EXPECT_EQ(HostVector{added_host}, hosts_added);
+        EXPECT_EQ(HostVector{removed_host}, hosts_removed);
+      }));
+  timer->callback_();
+  EXPECT_EQ(0, factory_.stats_.counter("cluster_manager.cluster_updated").value());
+  EXPECT_EQ(1, factory_.stats_.counter("cluster_manager.cluster_updated_via_merge").value());
+  EXPECT_EQ(0, factory_.stats_.counter("cluster_manager.update_merge_cancelled").value());
+}
+
+// Tests that pending membership changes are delivered along with an update that arrives out of
+// the merge window.
+TEST_F(ClusterManagerImplTest, MergedMembershipUpdatesOutOfWindow) {
+  createWithLocalClusterUpdate(true, true);
+
+  Event::MockTimer* timer = new NiceMock<Event::MockTimer>(&factory_.dispatcher_);
+  Cluster& cluster = cluster_manager_->activeClusters().begin()->second;
+  HostVectorSharedPtr hosts(
+      new HostVector(cluster.prioritySet().hostSetsPerPriority()[0]->hosts()));
+  HostsPerLocalitySharedPtr hosts_per_locality = std::make_shared<HostsPerLocalityImpl>();
+
+  // The first removal is scheduled.
+  EXPECT_CALL(*timer, enableTimer(_));
+  cluster.prioritySet().updateHosts(
+      0, HostSetImpl::updateHostsParams(hosts, hosts_per_locality, hosts, hosts_per_locality), {},
+      {}, {(*hosts)[0]}, absl::nullopt);
+  EXPECT_EQ(0, factory_.stats_.counter("cluster_manager.cluster_updated").value());
+
+  // The second one is out of the merge window, so both are delivered immediately.
+  EXPECT_CALL(local_hosts_removed_, post(_)).WillOnce(Invoke([&](const HostVector& hosts_removed) {
+    EXPECT_EQ(2, hosts_removed.size());
+  }));
+  EXPECT_CALL(local_cluster_update_, post(_, _, _))
+      .WillOnce(Invoke([](uint32_t priority, const HostVector& hosts_added,
+                          const HostVector& hosts_removed) -> void {
+        EXPECT_EQ(0, priority);
+        EXPECT_EQ(0, hosts_added.size());
+        EXPECT_EQ(2, hosts_removed.size());
+      }));
+  EXPECT_CALL(*timer, disableTimer());
+  time_system_.sleep(std::chrono::seconds(60));
+  cluster.prioritySet().updateHosts(
+      0, HostSetImpl::updateHostsParams(hosts, hosts_per_locality, hosts, hosts_per_locality), {},
+      {}, {(*hosts)[1]}, absl::nullopt);
+  EXPECT_EQ(1, factory_.stats_.counter("cluster_manager.cluster_updated").value());
+  EXPECT_EQ(0, factory_.stats_.counter("cluster_manager.cluster_updated_via_merge").value());
+  EXPECT_EQ(1, factory_.stats_.counter("cluster_manager.update_out_of_merge_window").value());
+  EXPECT_EQ(1, factory_.stats_.counter("cluster_manager.update_merge_cancelled").value());
+}
+
 TEST_F(ClusterManagerImplTest, MergedUpdatesDestroyedOnUpdate) {
   // We create the default cluster, although for this test we won't use it since
   // we can only update dynamic clusters.
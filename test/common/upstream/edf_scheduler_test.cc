@@ -1,3 +1,5 @@
+#include <vector>
+
 #include "common/upstream/edf_scheduler.h"
 
 #include "gtest/gtest.h"
@@ -71,6 +73,73 @@ TEST(EdfSchedulerTest, Expired) {
   EXPECT_EQ(nullptr, sched.pick());
 }
 
+// Validate that removed entries are not picked and that the others keep their place.
+TEST(EdfSchedulerTest, Remove) {
+  EdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 8;
+  std::shared_ptr<uint32_t> entries[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(1, entries[i]);
+  }
+  sched.remove(entries[0]);
+  sched.remove(entries[5]);
+  EXPECT_EQ(num_entries, sched.size());
+
+  for (uint32_t rounds = 0; rounds < 2; ++rounds) {
+    for (uint32_t i = 1; i < num_entries; ++i) {
+      if (i == 5) {
+        continue;
+      }
+      auto p = sched.pick();
+      EXPECT_EQ(i, *p);
+      sched.add(1, p);
+    }
+  }
+  EXPECT_EQ(num_entries - 2, sched.size());
+}
+
+// Validate that an entry added back before it was discarded keeps its deadline.
+TEST(EdfSchedulerTest, RemoveAndAddBack) {
+  EdfScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 4;
+  std::shared_ptr<uint32_t> entries[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(1, entries[i]);
+  }
+  sched.remove(entries[1]);
+  sched.add(1, entries[1]);
+  EXPECT_EQ(num_entries, sched.size());
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    auto p = sched.pick();
+    EXPECT_EQ(i, *p);
+    sched.add(1, p);
+  }
+}
+
+// Validate that forEach() skips expired and removed entries.
+TEST(EdfSchedulerTest, ForEach) {
+  EdfScheduler<uint32_t> sched;
+
+  auto first_entry = std::make_shared<uint32_t>(37);
+  auto second_entry = std::make_shared<uint32_t>(42);
+  {
+    auto expired_entry = std::make_shared<uint32_t>(1);
+    sched.add(1, expired_entry);
+  }
+  sched.add(1, first_entry);
+  sched.add(1, second_entry);
+  sched.remove(second_entry);
+
+  std::vector<uint32_t> entries;
+  sched.forEach([&entries](const std::shared_ptr<uint32_t>& entry) { entries.push_back(*entry); });
+  EXPECT_EQ(std::vector<uint32_t>{37}, entries);
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
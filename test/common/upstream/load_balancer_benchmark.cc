@@ -1,14 +1,21 @@
 // Usage: bazel run //test/common/upstream:load_balancer_benchmark
 
 #include <memory>
+#include <unordered_set>
 
+#include "common/config/metadata.h"
+#include "common/config/well_known_names.h"
+#include "common/memory/stats.h"
 #include "common/runtime/runtime_impl.h"
+#include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/maglev_lb.h"
 #include "common/upstream/ring_hash_lb.h"
+#include "common/upstream/subset_lb.h"
 #include "common/upstream/upstream_impl.h"
 
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "benchmark/benchmark.h"
 
@@ -31,6 +38,42 @@ public:
     priority_set_.updateHosts(
         0, HostSetImpl::updateHostsParams(updated_hosts, nullptr, updated_hosts, nullptr), {},
         hosts, {}, absl::nullopt);
+    hosts_ = hosts;
+  }
+
+  void updateHosts(const HostVector& healthy_hosts, const HostVector& hosts_added,
+                   const HostVector& hosts_removed) {
+    HostVectorConstSharedPtr updated_hosts{new HostVector(hosts_)};
+    HostVectorConstSharedPtr updated_healthy_hosts{new HostVector(healthy_hosts)};
+    priority_set_.updateHosts(0,
+                              HostSetImpl::updateHostsParams(updated_hosts, nullptr,
+                                                             updated_healthy_hosts, nullptr),
+                              {}, hosts_added, hosts_removed, absl::nullopt);
+  }
+
+  // Replaces hosts_to_churn hosts, starting at first_host, with hosts from spare_hosts. The
+  // replaced hosts are moved to spare_hosts.
+  void churnHosts(uint64_t first_host, uint64_t hosts_to_churn, HostVector& spare_hosts) {
+    HostVector hosts_added;
+    HostVector hosts_removed;
+    for (uint64_t i = 0; i < hosts_to_churn; i++) {
+      const uint64_t index = (first_host + i) % hosts_.size();
+      hosts_removed.push_back(hosts_[index]);
+      hosts_added.push_back(spare_hosts[i]);
+      std::swap(hosts_[index], spare_hosts[i]);
+    }
+    updateHosts(hosts_, hosts_added, hosts_removed);
+  }
+
+  // Creates hosts which can be swapped in and out of the host set with churnHosts(), so that none
+  // are created while timing.
+  HostVector makeSpareHosts(uint64_t num_hosts) {
+    HostVector spare_hosts;
+    for (uint64_t i = 0; i < num_hosts; i++) {
+      spare_hosts.push_back(
+          makeTestHost(info_, fmt::format("tcp://10.1.{}.{}:6379", i / 256, i % 256)));
+    }
+    return spare_hosts;
   }
 
   PrioritySetImpl priority_set_;
@@ -40,6 +83,7 @@ public:
   Runtime::RandomGeneratorImpl random_;
   envoy::api::v2::Cluster::CommonLbConfig common_config_;
   std::shared_ptr<MockClusterInfo> info_{new NiceMock<MockClusterInfo>()};
+  HostVector hosts_;
 };
 
 class RingHashTester : public BaseTester {
@@ -66,6 +110,96 @@ public:
   std::unique_ptr<MaglevLoadBalancer> maglev_lb_;
 };
 
+class EdfTester : public BaseTester {
+public:
+  EdfTester(uint64_t num_hosts, bool least_request) : BaseTester(num_hosts) {
+    if (least_request) {
+      lb_ = std::make_unique<LeastRequestLoadBalancer>(priority_set_, nullptr, stats_, runtime_,
+                                                       random_, common_config_, absl::nullopt);
+    } else {
+      lb_ = std::make_unique<RoundRobinLoadBalancer>(priority_set_, nullptr, stats_, runtime_,
+                                                     random_, common_config_);
+    }
+  }
+
+  // Picks one round's worth of hosts, which discards the removed hosts from the schedule.
+  void pickRound() {
+    for (uint64_t i = 0; i < hosts_.size(); i++) {
+      lb_->chooseHost(nullptr);
+    }
+  }
+
+  LoadBalancerPtr lb_;
+};
+
+class LatencyAwareTester : public BaseTester {
+public:
+  LatencyAwareTester(uint64_t num_hosts, bool peak_ewma) : BaseTester(num_hosts) {
+    info_->lb_peak_ewma_config_ = envoy::api::v2::Cluster::PeakEwmaLbConfig();
+    if (peak_ewma) {
+      lb_ = std::make_unique<PeakEwmaLoadBalancer>(priority_set_, nullptr, stats_, runtime_,
+                                                   random_, time_system_, common_config_,
+                                                   absl::nullopt);
+    } else {
+      lb_ = std::make_unique<LeastRequestLoadBalancer>(priority_set_, nullptr, stats_, runtime_,
+                                                       random_, common_config_, absl::nullopt);
+    }
+    for (uint64_t i = 0; i < num_hosts; i += 10) {
+      slow_hosts_.insert(hosts_[i].get());
+    }
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  LoadBalancerPtr lb_;
+  std::unordered_set<const Host*> slow_hosts_;
+};
+
+class SubsetTester : public BaseTester {
+public:
+  // Each of num_keys metadata keys is a subset selector of its own. Key i has i + 2 distinct values
+  // across the hosts, so each host is in num_keys subsets.
+  SubsetTester(uint64_t num_hosts, uint64_t num_keys) : BaseTester(0), num_keys_(num_keys) {
+    envoy::api::v2::Cluster::LbSubsetConfig subset_config;
+    subset_config.set_fallback_policy(envoy::api::v2::Cluster::LbSubsetConfig::ANY_ENDPOINT);
+    for (uint64_t i = 0; i < num_keys; i++) {
+      subset_config.add_subset_selectors()->add_keys(fmt::format("key{}", i));
+    }
+    subset_info_ = std::make_unique<LoadBalancerSubsetInfoImpl>(subset_config);
+
+    for (uint64_t i = 0; i < num_hosts; i++) {
+      hosts_.push_back(makeHost(i, fmt::format("tcp://10.0.{}.{}:6379", i / 256, i % 256)));
+    }
+    updateHosts(hosts_, hosts_, {});
+
+    lb_ = std::make_unique<SubsetLoadBalancer>(
+        LoadBalancerType::RoundRobin, priority_set_, nullptr, stats_, stats_store_, runtime_,
+        random_, *subset_info_, absl::nullopt, absl::nullopt, common_config_);
+  }
+
+  HostSharedPtr makeHost(uint64_t index, const std::string& url) {
+    envoy::api::v2::core::Metadata metadata;
+    for (uint64_t key = 0; key < num_keys_; key++) {
+      Config::Metadata::mutableMetadataValue(metadata, Config::MetadataFilters::get().ENVOY_LB,
+                                             fmt::format("key{}", key))
+          .set_string_value(fmt::format("{}", index % (key + 2)));
+    }
+    return makeTestHost(info_, url, metadata);
+  }
+
+  // Like BaseTester::makeSpareHosts(), with metadata.
+  HostVector makeSpareHosts(uint64_t num_hosts) {
+    HostVector spare_hosts;
+    for (uint64_t i = 0; i < num_hosts; i++) {
+      spare_hosts.push_back(makeHost(i, fmt::format("tcp://10.1.{}.{}:6379", i / 256, i % 256)));
+    }
+    return spare_hosts;
+  }
+
+  const uint64_t num_keys_;
+  std::unique_ptr<LoadBalancerSubsetInfoImpl> subset_info_;
+  std::unique_ptr<SubsetLoadBalancer> lb_;
+};
+
 uint64_t hashInt(uint64_t i) {
   // Hack to hash an integer.
   return HashUtil::xxHash64(absl::string_view(reinterpret_cast<const char*>(&i), sizeof(i)));
@@ -80,7 +214,11 @@ void BM_RingHashLoadBalancerBuildRing(benchmark::State& state) {
     state.ResumeTiming();
 
     // We are only interested in timing the initial ring build.
+    const uint64_t start_mem = Memory::Stats::totalCurrentlyAllocated();
     tester.ring_hash_lb_->initialize();
+    state.PauseTiming();
+    state.counters["memory"] = Memory::Stats::totalCurrentlyAllocated() - start_mem;
+    state.ResumeTiming();
   }
 }
 BENCHMARK(BM_RingHashLoadBalancerBuildRing)
@@ -100,7 +238,11 @@ void BM_MaglevLoadBalancerBuildTable(benchmark::State& state) {
     state.ResumeTiming();
 
     // We are only interested in timing the initial table build.
+    const uint64_t start_mem = Memory::Stats::totalCurrentlyAllocated();
     tester.maglev_lb_->initialize();
+    state.PauseTiming();
+    state.counters["memory"] = Memory::Stats::totalCurrentlyAllocated() - start_mem;
+    state.ResumeTiming();
   }
 }
 BENCHMARK(BM_MaglevLoadBalancerBuildTable)
@@ -359,6 +501,181 @@ BENCHMARK(BM_MaglevLoadBalancerWeighted)
     ->Args({500, 95, 75, 25, 10000})
     ->Unit(benchmark::kMillisecond);
 
+// Replaces hosts_to_churn hosts with new ones on each update, as during a rolling deploy.
+void edfLoadBalancerHostChurn(benchmark::State& state, bool least_request) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t hosts_to_churn = state.range(1);
+  EdfTester tester(num_hosts, least_request);
+  HostVector spare_hosts = tester.makeSpareHosts(hosts_to_churn);
+
+  uint64_t next_host = 0;
+  for (auto _ : state) {
+    tester.churnHosts(next_host, hosts_to_churn, spare_hosts);
+    next_host = (next_host + hosts_to_churn) % num_hosts;
+
+    // We are only interested in timing the update.
+    state.PauseTiming();
+    tester.pickRound();
+    state.ResumeTiming();
+  }
+}
+
+void BM_RoundRobinLoadBalancerHostChurn(benchmark::State& state) {
+  edfLoadBalancerHostChurn(state, false);
+}
+BENCHMARK(BM_RoundRobinLoadBalancerHostChurn)
+    ->Args({500, 1})
+    ->Args({500, 10})
+    ->Args({5000, 1})
+    ->Args({5000, 10})
+    ->Args({5000, 100})
+    ->Args({5000, 5000})
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_LeastRequestLoadBalancerHostChurn(benchmark::State& state) {
+  edfLoadBalancerHostChurn(state, true);
+}
+BENCHMARK(BM_LeastRequestLoadBalancerHostChurn)
+    ->Args({500, 10})
+    ->Args({5000, 10})
+    ->Args({5000, 100})
+    ->Unit(benchmark::kMicrosecond);
+
+// Marks a sliding window of hosts_to_flap hosts unhealthy on each update, as with flapping health
+// checks. Only the healthy host list changes.
+void BM_RoundRobinLoadBalancerHealthFlap(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t hosts_to_flap = state.range(1);
+  EdfTester tester(num_hosts, false);
+
+  uint64_t next_host = 0;
+  for (auto _ : state) {
+    HostVector healthy_hosts;
+    healthy_hosts.reserve(num_hosts);
+    for (uint64_t i = 0; i < num_hosts; i++) {
+      if ((i + num_hosts - next_host) % num_hosts >= hosts_to_flap) {
+        healthy_hosts.push_back(tester.hosts_[i]);
+      }
+    }
+    next_host = (next_host + 1) % num_hosts;
+    tester.updateHosts(healthy_hosts, {}, {});
+
+    // We are only interested in timing the update.
+    state.PauseTiming();
+    tester.pickRound();
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_RoundRobinLoadBalancerHealthFlap)
+    ->Args({500, 10})
+    ->Args({5000, 10})
+    ->Args({5000, 100})
+    ->Unit(benchmark::kMicrosecond);
+
+// Every 10th host responds in 100ms rather than 10ms. Each pick is followed by a response from the
+// picked host, and reports the share of requests which went to slow hosts.
+void latencyAwareLoadBalancerChooseHost(benchmark::State& state, bool peak_ewma) {
+  const uint64_t num_hosts = state.range(0);
+  LatencyAwareTester tester(num_hosts, peak_ewma);
+
+  uint64_t requests = 0;
+  uint64_t slow_host_requests = 0;
+  for (auto _ : state) {
+    for (uint64_t i = 0; i < 1000; i++) {
+      HostConstSharedPtr host = tester.lb_->chooseHost(nullptr);
+      const bool slow = tester.slow_hosts_.count(host.get()) > 0;
+      host->putResponseTime(std::chrono::milliseconds(slow ? 100 : 10),
+                            tester.time_system_.monotonicTime());
+      slow_host_requests += slow;
+    }
+    requests += 1000;
+    tester.time_system_.sleep(std::chrono::milliseconds(10));
+  }
+  state.counters["slow_host_share"] = static_cast<double>(slow_host_requests) / requests;
+}
+
+void BM_LeastRequestLoadBalancerHeterogeneousLatency(benchmark::State& state) {
+  latencyAwareLoadBalancerChooseHost(state, false);
+}
+BENCHMARK(BM_LeastRequestLoadBalancerHeterogeneousLatency)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMicrosecond);
+
+void BM_PeakEwmaLoadBalancerHeterogeneousLatency(benchmark::State& state) {
+  latencyAwareLoadBalancerChooseHost(state, true);
+}
+BENCHMARK(BM_PeakEwmaLoadBalancerHeterogeneousLatency)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMicrosecond);
+
+// Replaces hosts_to_churn hosts with new ones on each update and times rebuilding the ring. The
+// ring is updated from the previous one rather than built from scratch.
+void BM_RingHashLoadBalancerHostChurn(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t hosts_to_churn = state.range(1);
+  RingHashTester tester(num_hosts, state.range(2));
+  tester.ring_hash_lb_->initialize();
+  HostVector spare_hosts = tester.makeSpareHosts(hosts_to_churn);
+
+  uint64_t next_host = 0;
+  for (auto _ : state) {
+    tester.churnHosts(next_host, hosts_to_churn, spare_hosts);
+    next_host = (next_host + hosts_to_churn) % num_hosts;
+  }
+}
+BENCHMARK(BM_RingHashLoadBalancerHostChurn)
+    ->Args({100, 1, 65536})
+    ->Args({500, 1, 65536})
+    ->Args({500, 10, 65536})
+    ->Args({500, 1, 256000})
+    ->Args({500, 10, 256000})
+    ->Args({500, 500, 256000})
+    ->Unit(benchmark::kMillisecond);
+
+// As above for Maglev, whose table is always rebuilt in full.
+void BM_MaglevLoadBalancerHostChurn(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t hosts_to_churn = state.range(1);
+  MaglevTester tester(num_hosts);
+  tester.maglev_lb_->initialize();
+  HostVector spare_hosts = tester.makeSpareHosts(hosts_to_churn);
+
+  uint64_t next_host = 0;
+  for (auto _ : state) {
+    tester.churnHosts(next_host, hosts_to_churn, spare_hosts);
+    next_host = (next_host + hosts_to_churn) % num_hosts;
+  }
+}
+BENCHMARK(BM_MaglevLoadBalancerHostChurn)
+    ->Args({100, 1})
+    ->Args({500, 1})
+    ->Args({500, 10})
+    ->Unit(benchmark::kMillisecond);
+
+// Replaces hosts_to_churn hosts with new ones on each update and times regrouping the hosts into
+// subsets. Only the subsets of the churned hosts are refiltered.
+void BM_SubsetLoadBalancerHostChurn(benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t hosts_to_churn = state.range(1);
+  SubsetTester tester(num_hosts, state.range(2));
+  HostVector spare_hosts = tester.makeSpareHosts(hosts_to_churn);
+
+  uint64_t next_host = 0;
+  for (auto _ : state) {
+    tester.churnHosts(next_host, hosts_to_churn, spare_hosts);
+    next_host = (next_host + hosts_to_churn) % num_hosts;
+  }
+}
+BENCHMARK(BM_SubsetLoadBalancerHostChurn)
+    ->Args({500, 1, 10})
+    ->Args({500, 10, 40})
+    ->Args({5000, 1, 40})
+    ->Args({5000, 10, 40})
+    ->Args({5000, 100, 40})
+    ->Unit(benchmark::kMillisecond);
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
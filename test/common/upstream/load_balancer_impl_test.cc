@@ -11,6 +11,7 @@
 #include "test/common/upstream/utility.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -709,6 +710,60 @@ TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+// Validate that the schedule of a large host set is updated in place: removed hosts are no longer
+// picked, and the schedule carries on where it was rather than starting over.
+TEST_P(RoundRobinLoadBalancerTest, IncrementalRefresh) {
+  HostVector hosts;
+  for (uint32_t i = 0; i < 100; ++i) {
+    hosts.push_back(makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 8000 + i)));
+  }
+  hostSet().healthy_hosts_ = hosts;
+  hostSet().hosts_ = hosts;
+  init(false);
+  for (uint32_t i = 0; i < 50; ++i) {
+    EXPECT_EQ(hosts[i], lb_->chooseHost(nullptr));
+  }
+
+  // Remove 5 hosts which were already picked in this round and one which wasn't, and add 5 new
+  // ones.
+  HostVector hosts_removed = {hosts[0], hosts[1], hosts[2], hosts[3], hosts[4], hosts[60]};
+  HostVector hosts_added;
+  HostVector new_hosts;
+  for (uint32_t i = 5; i < 100; ++i) {
+    if (i != 60) {
+      new_hosts.push_back(hosts[i]);
+    }
+  }
+  for (uint32_t i = 0; i < 5; ++i) {
+    hosts_added.push_back(makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 9000 + i)));
+    new_hosts.push_back(hosts_added.back());
+  }
+  hostSet().healthy_hosts_ = new_hosts;
+  hostSet().hosts_ = new_hosts;
+  hostSet().runCallbacks(hosts_added, hosts_removed);
+
+  // The rest of the round, then the next one with the new hosts scheduled after the hosts that
+  // were picked before the update.
+  HostVector expected;
+  for (uint32_t i = 50; i < 100; ++i) {
+    if (i != 60) {
+      expected.push_back(hosts[i]);
+    }
+  }
+  for (uint32_t i = 5; i < 50; ++i) {
+    expected.push_back(hosts[i]);
+  }
+  expected.insert(expected.end(), hosts_added.begin(), hosts_added.end());
+  for (uint32_t i = 50; i < 100; ++i) {
+    if (i != 60) {
+      expected.push_back(hosts[i]);
+    }
+  }
+  for (const auto& host : expected) {
+    EXPECT_EQ(host, lb_->chooseHost(nullptr));
+  }
+}
+
 TEST_P(RoundRobinLoadBalancerTest, MaxUnhealthyPanic) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
                               makeTestHost(info_, "tcp://127.0.0.1:81")};
@@ -1305,6 +1360,154 @@ TEST_P(LeastRequestLoadBalancerTest, WeightImbalanceCallbacks) {
 INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, LeastRequestLoadBalancerTest,
                          ::testing::Values(true, false));
 
+class PeakEwmaLoadBalancerTest : public LoadBalancerTestBase {
+public:
+  PeakEwmaLoadBalancerTest() {
+    info_->lb_peak_ewma_config_ = envoy::api::v2::Cluster::PeakEwmaLbConfig();
+  }
+
+  void putResponseTime(const HostSharedPtr& host, uint64_t response_time_ms) {
+    host->putResponseTime(std::chrono::milliseconds(response_time_ms),
+                          time_system_.monotonicTime());
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  PeakEwmaLoadBalancer lb_{priority_set_,  nullptr,      stats_, runtime_, random_, time_system_,
+                           common_config_, absl::nullopt};
+};
+
+TEST_P(PeakEwmaLoadBalancerTest, NoHosts) { EXPECT_EQ(nullptr, lb_.chooseHost(nullptr)); }
+
+TEST_P(PeakEwmaLoadBalancerTest, Normal) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  // The faster host wins when neither is busy.
+  putResponseTime(hostSet().healthy_hosts_[0], 100);
+  putResponseTime(hostSet().healthy_hosts_[1], 10);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // Cost scales with active requests: 10ms * 21 is more than 100ms * 1.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(20);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+
+  // A response time spike is reflected right away.
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(0);
+  putResponseTime(hostSet().healthy_hosts_[1], 1000);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+
+  // And is forgotten as faster responses come in.
+  for (int i = 0; i < 10; ++i) {
+    time_system_.sleep(std::chrono::seconds(10));
+    putResponseTime(hostSet().healthy_hosts_[0], 100);
+    putResponseTime(hostSet().healthy_hosts_[1], 10);
+  }
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, UnmeasuredHost) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+  putResponseTime(hostSet().healthy_hosts_[0], 100);
+
+  // A host without a response time is tried while idle.
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // But not while its first request is outstanding.
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(10);
+  hostSet().healthy_hosts_[1]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+}
+
+// Hosts responding in under a millisecond are measured, and not treated as unmeasured.
+TEST_P(PeakEwmaLoadBalancerTest, SubMillisecondResponseTimes) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80"),
+                              makeTestHost(info_, "tcp://127.0.0.1:81")};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+  hostSet().healthy_hosts_[0]->putResponseTime(std::chrono::microseconds(100),
+                                               time_system_.monotonicTime());
+  hostSet().healthy_hosts_[1]->putResponseTime(std::chrono::microseconds(900),
+                                               time_system_.monotonicTime());
+
+  // 0.1ms * 2 is less than 0.9ms * 1.
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(1);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+
+  // 0.1ms * 10 is more than 0.9ms * 1.
+  hostSet().healthy_hosts_[0]->stats().rq_active_.set(9);
+  EXPECT_CALL(random_, random()).WillOnce(Return(0)).WillOnce(Return(2)).WillOnce(Return(3));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, ChoiceCount) {
+  hostSet().healthy_hosts_ = {
+      makeTestHost(info_, "tcp://127.0.0.1:80"), makeTestHost(info_, "tcp://127.0.0.1:81"),
+      makeTestHost(info_, "tcp://127.0.0.1:82"), makeTestHost(info_, "tcp://127.0.0.1:83")};
+  stats_.max_host_weight_.set(1UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+  for (uint64_t i = 0; i < 4; ++i) {
+    putResponseTime(hostSet().healthy_hosts_[i], 40 - 10 * i);
+  }
+
+  envoy::api::v2::Cluster::PeakEwmaLbConfig peak_ewma_config;
+  peak_ewma_config.mutable_choice_count()->set_value(4);
+  PeakEwmaLoadBalancer lb_4{priority_set_, nullptr,        stats_,         runtime_,
+                            random_,       time_system_, common_config_, peak_ewma_config};
+
+  EXPECT_CALL(random_, random())
+      .Times(5)
+      .WillOnce(Return(0))
+      .WillOnce(Return(0))
+      .WillOnce(Return(3))
+      .WillOnce(Return(1))
+      .WillOnce(Return(2));
+  EXPECT_EQ(hostSet().healthy_hosts_[3], lb_4.chooseHost(nullptr));
+}
+
+TEST_P(PeakEwmaLoadBalancerTest, WeightImbalance) {
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", 2)};
+  stats_.max_host_weight_.set(2UL);
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({}, {}); // Trigger callbacks. The added/removed lists are not relevant.
+
+  EXPECT_CALL(random_, random()).WillRepeatedly(Return(0));
+
+  // Idle hosts without response times are picked by weight.
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[0], lb_.chooseHost(nullptr));
+  EXPECT_EQ(hostSet().healthy_hosts_[1], lb_.chooseHost(nullptr));
+
+  // Once the heavier host turns out to be slow, it is hardly picked despite its weight.
+  putResponseTime(hostSet().healthy_hosts_[1], 1000);
+  uint32_t slow_host_picks = 0;
+  for (int i = 0; i < 20; ++i) {
+    if (lb_.chooseHost(nullptr) == hostSet().healthy_hosts_[1]) {
+      ++slow_host_picks;
+    }
+  }
+  EXPECT_LE(slow_host_picks, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(PrimaryOrFailover, PeakEwmaLoadBalancerTest,
+                         ::testing::Values(true, false));
+
 class RandomLoadBalancerTest : public LoadBalancerTestBase {
 public:
   RandomLoadBalancer lb_{priority_set_, nullptr, stats_, runtime_, random_, common_config_};
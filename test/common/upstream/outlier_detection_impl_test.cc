@@ -91,6 +91,18 @@ public:
     }
   }
 
+  void loadResponseTime(HostVector& hosts, int num_rq, uint64_t response_time_ms) {
+    for (uint64_t i = 0; i < hosts.size(); i++) {
+      loadResponseTime(hosts[i], num_rq, response_time_ms);
+    }
+  }
+
+  void loadResponseTime(HostSharedPtr host, int num_rq, uint64_t response_time_ms) {
+    for (int i = 0; i < num_rq; i++) {
+      host->outlierDetector().putResponseTime(std::chrono::milliseconds(response_time_ms));
+    }
+  }
+
   NiceMock<MockClusterMockPrioritySet> cluster_;
   HostVector& hosts_ = cluster_.prioritySet().getMockHostSet(0)->hosts_;
   HostVector& failover_hosts_ = cluster_.prioritySet().getMockHostSet(1)->hosts_;
@@ -562,6 +574,87 @@ TEST_F(OutlierDetectorImplTest, EmptySuccessRate) {
   interval_timer_->callback_();
 }
 
+TEST_F(OutlierDetectorImplTest, BasicFlowLatency) {
+  EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
+  addHosts({
+      "tcp://127.0.0.1:80",
+      "tcp://127.0.0.1:81",
+      "tcp://127.0.0.1:82",
+      "tcp://127.0.0.1:83",
+      "tcp://127.0.0.1:84",
+  });
+
+  envoy::api::v2::cluster::OutlierDetection outlier_detection;
+  outlier_detection.mutable_latency_p99_factor()->set_value(300);
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  std::shared_ptr<DetectorImpl> detector(DetectorImpl::create(
+      cluster_, outlier_detection, dispatcher_, runtime_, time_system_, event_logger_));
+  detector->addChangedStateCb([&](HostSharedPtr host) -> void { checker_.check(host); });
+  EXPECT_EQ(300UL, detector->config().latencyP99Factor());
+  EXPECT_EQ(100UL, detector->config().enforcingLatency());
+  ON_CALL(runtime_.snapshot_, featureEnabled("outlier_detection.enforcing_latency", 100))
+      .WillByDefault(Return(true));
+
+  // Make one host's p99 response time five times that of the others. Response times are read
+  // back as the upper bound of their counter, so 10ms reads as 11ms and 50ms as 55ms.
+  loadResponseTime(hosts_, 100, 10);
+  loadResponseTime(hosts_[4], 100, 50);
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(10000));
+  EXPECT_CALL(checker_, check(hosts_[4]));
+  EXPECT_CALL(*event_logger_,
+              logEject(std::static_pointer_cast<const HostDescription>(hosts_[4]), _,
+                       envoy::data::cluster::v2alpha::OutlierEjectionType::LATENCY, true));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_EQ(11, hosts_[0]->outlierDetector().latencyP99());
+  EXPECT_EQ(55, hosts_[4]->outlierDetector().latencyP99());
+  EXPECT_EQ(11, detector->latencyP99Median());
+  EXPECT_EQ(33, detector->latencyEjectionThreshold());
+  EXPECT_EQ(-1, detector->successRateAverage());
+  EXPECT_TRUE(hosts_[4]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+  EXPECT_EQ(1UL, cluster_.info_->stats_store_.gauge("outlier_detection.ejections_active").value());
+  EXPECT_EQ(1UL,
+            cluster_.info_->stats_store_.counter("outlier_detection.ejections_detected_latency")
+                .value());
+  EXPECT_EQ(1UL,
+            cluster_.info_->stats_store_.counter("outlier_detection.ejections_enforced_latency")
+                .value());
+
+  // Give 3 of the remaining hosts enough request volume but not the 4th. Should not cause an
+  // ejection, since there are not enough hosts.
+  for (uint64_t i = 0; i < 3; i++) {
+    loadResponseTime(hosts_[i], 100, 10);
+  }
+  loadResponseTime(hosts_[3], 50, 50);
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(20000));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_FALSE(hosts_[3]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+  EXPECT_EQ(-1, hosts_[4]->outlierDetector().latencyP99());
+  EXPECT_EQ(-1, detector->latencyP99Median());
+  EXPECT_EQ(-1, detector->latencyEjectionThreshold());
+}
+
+TEST_F(OutlierDetectorImplTest, LatencyNotTracked) {
+  EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
+  addHosts({"tcp://127.0.0.1:80"});
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  std::shared_ptr<DetectorImpl> detector(DetectorImpl::create(
+      cluster_, empty_outlier_detection_, dispatcher_, runtime_, time_system_, event_logger_));
+  ON_CALL(runtime_.snapshot_, getInteger("outlier_detection.success_rate_minimum_hosts", 5))
+      .WillByDefault(Return(0));
+
+  loadResponseTime(hosts_, 200, 10);
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(10000));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_EQ(-1, hosts_[0]->outlierDetector().latencyP99());
+  EXPECT_EQ(-1, detector->latencyP99Median());
+}
+
 TEST_F(OutlierDetectorImplTest, RemoveWhileEjected) {
   EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
   addHosts({"tcp://127.0.0.1:80"});
@@ -592,6 +685,50 @@ TEST_F(OutlierDetectorImplTest, RemoveWhileEjected) {
   interval_timer_->callback_();
 }
 
+// Removing a host moves the last host into its slot. Make sure the moved host is still the one that
+// gets ejected.
+TEST_F(OutlierDetectorImplTest, RemoveHostSlot) {
+  EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
+  addHosts({
+      "tcp://127.0.0.1:80",
+      "tcp://127.0.0.1:81",
+      "tcp://127.0.0.1:82",
+      "tcp://127.0.0.1:83",
+      "tcp://127.0.0.1:84",
+      "tcp://127.0.0.1:85",
+  });
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  std::shared_ptr<DetectorImpl> detector(DetectorImpl::create(
+      cluster_, empty_outlier_detection_, dispatcher_, runtime_, time_system_, event_logger_));
+  detector->addChangedStateCb([&](HostSharedPtr host) -> void { checker_.check(host); });
+
+  HostSharedPtr removed_host = hosts_[1];
+  hosts_.erase(hosts_.begin() + 1);
+  cluster_.prioritySet().getMockHostSet(0)->runCallbacks({}, {removed_host});
+
+  // Turn off 5xx detection to test SR detection in isolation.
+  ON_CALL(runtime_.snapshot_, featureEnabled("outlier_detection.enforcing_consecutive_5xx", 100))
+      .WillByDefault(Return(false));
+  EXPECT_CALL(*event_logger_,
+              logEject(std::static_pointer_cast<const HostDescription>(hosts_[4]), _,
+                       envoy::data::cluster::v2alpha::OutlierEjectionType::CONSECUTIVE_5XX, false))
+      .Times(40);
+
+  loadRq(hosts_, 200, 200);
+  loadRq(hosts_[4], 200, 500);
+
+  time_system_.setMonotonicTime(std::chrono::milliseconds(10000));
+  EXPECT_CALL(checker_, check(hosts_[4]));
+  EXPECT_CALL(*event_logger_,
+              logEject(std::static_pointer_cast<const HostDescription>(hosts_[4]), _,
+                       envoy::data::cluster::v2alpha::OutlierEjectionType::SUCCESS_RATE, true));
+  EXPECT_CALL(*interval_timer_, enableTimer(std::chrono::milliseconds(10000)));
+  interval_timer_->callback_();
+  EXPECT_EQ(50, hosts_[4]->outlierDetector().successRate());
+  EXPECT_EQ(-1, removed_host->outlierDetector().successRate());
+  EXPECT_TRUE(hosts_[4]->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK));
+}
+
 TEST_F(OutlierDetectorImplTest, Overflow) {
   EXPECT_CALL(cluster_.prioritySet(), addMemberUpdateCb(_));
   addHosts({"tcp://127.0.0.1:80", "tcp://127.0.0.1:81"});
@@ -845,21 +982,74 @@ TEST(OutlierDetectionEventLoggerImplTest, All) {
       .WillOnce(SaveArg<0>(&log4));
   event_logger.logUneject(host);
   Json::Factory::loadFromString(log4);
+
+  StringViewSaver log5;
+  EXPECT_CALL(host->outlier_detector_, lastUnejectionTime()).WillOnce(ReturnRef(monotonic_time));
+  EXPECT_CALL(host->outlier_detector_, latencyP99()).WillOnce(Return(55));
+  EXPECT_CALL(detector, latencyP99Median()).WillOnce(Return(11));
+  EXPECT_CALL(detector, latencyEjectionThreshold()).WillOnce(Return(33));
+  EXPECT_CALL(*file,
+              write(absl::string_view(
+                  "{\"type\":\"LATENCY\",\"cluster_name\":\"fake_cluster\","
+                  "\"upstream_url\":\"10.0.0.1:443\",\"action\":\"EJECT\","
+                  "\"num_ejections\":0,\"enforced\":true,\"eject_latency_event\":{"
+                  "\"host_latency_p99_ms\":\"55\",\"cluster_median_latency_p99_ms\":\"11\","
+                  "\"cluster_latency_ejection_threshold_ms\":\"33\"},"
+                  "\"timestamp\":\"2018-12-18T09:00:00Z\",\"secs_since_last_action\":\"30\"}\n")))
+      .WillOnce(SaveArg<0>(&log5));
+  event_logger.logEject(host, detector, envoy::data::cluster::v2alpha::OutlierEjectionType::LATENCY,
+                        true);
+  Json::Factory::loadFromString(log5);
 }
 
 TEST(OutlierUtility, SRThreshold) {
-  std::vector<HostSuccessRatePair> data = {
-      HostSuccessRatePair(nullptr, 50),  HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100), HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100),
-  };
-  double sum = 450;
-
-  Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(sum, data, 1.9);
+  // The -1 entry is a host without a success rate, and is skipped.
+  std::vector<double> data = {50, 100, -1, 100, 100, 100};
+
+  Utility::EjectionPair ejection_pair = Utility::successRateEjectionThreshold(data, 5, 1.9);
   EXPECT_EQ(52.0, ejection_pair.ejection_threshold_);
   EXPECT_EQ(90.0, ejection_pair.success_rate_average_);
 }
 
+TEST(OutlierLatencyAccumulator, Counters) {
+  EXPECT_EQ(0U, LatencyAccumulator::counterIndex(0));
+  EXPECT_EQ(3U, LatencyAccumulator::counterIndex(3));
+  EXPECT_EQ(4U, LatencyAccumulator::counterIndex(4));
+  EXPECT_EQ(8U, LatencyAccumulator::counterIndex(9));
+  EXPECT_EQ(9U, LatencyAccumulator::counterIndex(10));
+  EXPECT_EQ(59U, LatencyAccumulator::counterIndex(65535));
+  EXPECT_EQ(59U, LatencyAccumulator::counterIndex(1 << 30));
+
+  // Every response time is at most the upper bound of its counter, and above the upper bound of
+  // the previous counter.
+  for (uint64_t response_time_ms = 1; response_time_ms < 65536; response_time_ms++) {
+    const uint32_t index = LatencyAccumulator::counterIndex(response_time_ms);
+    EXPECT_LE(response_time_ms, LatencyAccumulator::counterUpperBound(index));
+    EXPECT_GT(response_time_ms, LatencyAccumulator::counterUpperBound(index - 1));
+  }
+}
+
+TEST(OutlierLatencyAccumulator, LatencyP99) {
+  LatencyAccumulator accumulator;
+  LatencyAccumulatorBucket* bucket = accumulator.updateCurrentWriter();
+  bucket->counters_[LatencyAccumulator::counterIndex(10)] += 99;
+  bucket->counters_[LatencyAccumulator::counterIndex(1000)] += 1;
+
+  // Nothing in the last complete interval yet.
+  EXPECT_FALSE(accumulator.getLatencyP99(0));
+
+  accumulator.updateCurrentWriter();
+  EXPECT_FALSE(accumulator.getLatencyP99(101));
+  EXPECT_EQ(11, accumulator.getLatencyP99(100).value());
+
+  // One more slow request moves the p99 to it.
+  bucket = accumulator.updateCurrentWriter();
+  bucket->counters_[LatencyAccumulator::counterIndex(10)] += 98;
+  bucket->counters_[LatencyAccumulator::counterIndex(1000)] += 2;
+  accumulator.updateCurrentWriter();
+  EXPECT_EQ(1023, accumulator.getLatencyP99(100).value());
+}
+
 TEST(DetectorHostMonitorImpl, resultToHttpCode) {
   EXPECT_EQ(Http::Code::OK, DetectorHostMonitorImpl::resultToHttpCode(Result::SUCCESS));
   EXPECT_EQ(Http::Code::GatewayTimeout, DetectorHostMonitorImpl::resultToHttpCode(Result::TIMEOUT));
@@ -684,6 +684,57 @@ TEST_P(RingHashLoadBalancerTest, LopsidedWeightSmallScale) {
   }
 }
 
+// Given a series of host set changes, expect the incrementally updated ring to route the same way
+// as a ring built from scratch for the resulting host set.
+TEST_P(RingHashLoadBalancerTest, IncrementalUpdate) {
+  for (uint32_t i = 0; i < 100; ++i) {
+    hostSet().hosts_.push_back(makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 1000 + i)));
+  }
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+  init();
+
+  // The fresh load balancers stay registered with the priority set, so keep them alive.
+  std::vector<std::unique_ptr<RingHashLoadBalancer>> fresh_lbs;
+  const auto expect_same_as_fresh_ring = [this, &fresh_lbs]() {
+    fresh_lbs.push_back(std::make_unique<RingHashLoadBalancer>(
+        priority_set_, stats_, stats_store_, runtime_, random_, config_, common_config_));
+    fresh_lbs.back()->initialize();
+    LoadBalancerPtr fresh = fresh_lbs.back()->factory()->create();
+    LoadBalancerPtr updated = lb_->factory()->create();
+    for (uint64_t i = 0; i < 4096; ++i) {
+      TestLoadBalancerContext context(i * (std::numeric_limits<uint64_t>::max() / 4096));
+      EXPECT_EQ(fresh->chooseHost(&context), updated->chooseHost(&context));
+    }
+  };
+  EXPECT_EQ(11, lb_->stats().min_hashes_per_host_.value());
+
+  // Remove two hosts and add one.
+  HostSharedPtr added = makeTestHost(info_, "tcp://127.0.0.1:2000");
+  HostVector removed{hostSet().hosts_[10], hostSet().hosts_[50]};
+  hostSet().hosts_.erase(hostSet().hosts_.begin() + 50);
+  hostSet().hosts_.erase(hostSet().hosts_.begin() + 10);
+  hostSet().hosts_.push_back(added);
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({added}, removed);
+  expect_same_as_fresh_ring();
+
+  // Double the weight of a host, then halve it again.
+  hostSet().hosts_[0]->weight(2);
+  hostSet().runCallbacks({}, {});
+  EXPECT_EQ(22, lb_->stats().max_hashes_per_host_.value());
+  expect_same_as_fresh_ring();
+  hostSet().hosts_[0]->weight(1);
+  hostSet().runCallbacks({}, {});
+  EXPECT_EQ(11, lb_->stats().max_hashes_per_host_.value());
+  expect_same_as_fresh_ring();
+
+  // Mark a host unhealthy.
+  hostSet().healthy_hosts_.erase(hostSet().healthy_hosts_.begin() + 20);
+  hostSet().runCallbacks({}, {});
+  expect_same_as_fresh_ring();
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
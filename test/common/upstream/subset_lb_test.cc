@@ -2,6 +2,7 @@
 #include <initializer_list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -797,6 +798,35 @@ TEST_P(SubsetLoadBalancerTest, MetadataChangedHostsAddedRemoved) {
   EXPECT_EQ(host_set_.hosts_[1], lb_->chooseHost(&context_14));
 }
 
+// Hosts whose metadata changed are moved between subsets even when the update also adds hosts,
+// and so doesn't arrive with empty deltas.
+TEST_P(SubsetLoadBalancerTest, MetadataChangedHostsMovedWithOtherHostsAdded) {
+  std::vector<std::set<std::string>> subset_keys = {{"version"}};
+  EXPECT_CALL(subset_info_, subsetKeys()).WillRepeatedly(ReturnRef(subset_keys));
+
+  init({
+      {"tcp://127.0.0.1:80", {{"version", "1.0"}}},
+      {"tcp://127.0.0.1:81", {{"version", "1.1"}}},
+  });
+
+  TestLoadBalancerContext context_10({{"version", "1.0"}});
+  TestLoadBalancerContext context_11({{"version", "1.1"}});
+  TestLoadBalancerContext context_12({{"version", "1.2"}});
+
+  host_set_.hosts_[0]->metadata(buildMetadata("1.1"));
+  modifyHosts({makeHost("tcp://127.0.0.1:82", {{"version", "1.2"}})}, {});
+
+  EXPECT_EQ(2U, stats_.lb_subsets_active_.value());
+  EXPECT_EQ(3U, stats_.lb_subsets_created_.value());
+  EXPECT_EQ(1U, stats_.lb_subsets_removed_.value());
+  EXPECT_EQ(nullptr, lb_->chooseHost(&context_10));
+  EXPECT_EQ(host_set_.hosts_[2], lb_->chooseHost(&context_12));
+
+  const std::set<HostConstSharedPtr> picked{lb_->chooseHost(&context_11),
+                                            lb_->chooseHost(&context_11)};
+  EXPECT_EQ((std::set<HostConstSharedPtr>{host_set_.hosts_[0], host_set_.hosts_[1]}), picked);
+}
+
 TEST_P(SubsetLoadBalancerTest, UpdateRemovingLastSubsetHost) {
   EXPECT_CALL(subset_info_, fallbackPolicy())
       .WillRepeatedly(Return(envoy::api::v2::Cluster::LbSubsetConfig::ANY_ENDPOINT));
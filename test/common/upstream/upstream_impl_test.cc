@@ -1,4 +1,5 @@
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <list>
 #include <string>
@@ -811,6 +812,51 @@ TEST(HostImplTest, Weight) {
   EXPECT_EQ(128U, host->weight());
 }
 
+TEST(HostImplTest, ResponseTimeEwma) {
+  MockClusterMockPrioritySet cluster;
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", 1);
+  const MonotonicTime start{std::chrono::seconds(1000)};
+
+  // Response times are only tracked for the peak EWMA load balancer.
+  host->putResponseTime(std::chrono::milliseconds(100), start);
+  EXPECT_FALSE(host->responseTimeEwma(start).has_value());
+
+  cluster.info_->lb_peak_ewma_config_ = envoy::api::v2::Cluster::PeakEwmaLbConfig();
+  cluster.info_->lb_peak_ewma_config_.value().mutable_decay_time()->set_seconds(1);
+  EXPECT_FALSE(host->responseTimeEwma(start).has_value());
+
+  // The first response time is taken as is, and decays over time.
+  host->putResponseTime(std::chrono::milliseconds(100), start);
+  EXPECT_DOUBLE_EQ(100, host->responseTimeEwma(start).value());
+  EXPECT_DOUBLE_EQ(100 * std::exp(-1),
+                   host->responseTimeEwma(start + std::chrono::seconds(1)).value());
+
+  // Lower response times are averaged in.
+  host->putResponseTime(std::chrono::milliseconds(10), start + std::chrono::seconds(1));
+  EXPECT_DOUBLE_EQ(100 * std::exp(-1) + 10 * (1 - std::exp(-1)),
+                   host->responseTimeEwma(start + std::chrono::seconds(1)).value());
+
+  // Higher response times replace the average.
+  host->putResponseTime(std::chrono::milliseconds(500), start + std::chrono::seconds(2));
+  EXPECT_DOUBLE_EQ(500, host->responseTimeEwma(start + std::chrono::seconds(2)).value());
+}
+
+// Response times below a millisecond are measured rather than rounded down to nothing.
+TEST(HostImplTest, ResponseTimeEwmaSubMillisecond) {
+  MockClusterMockPrioritySet cluster;
+  cluster.info_->lb_peak_ewma_config_ = envoy::api::v2::Cluster::PeakEwmaLbConfig();
+  HostSharedPtr host = makeTestHost(cluster.info_, "tcp://10.0.0.1:1234", 1);
+  const MonotonicTime start{std::chrono::seconds(1000)};
+
+  host->putResponseTime(std::chrono::microseconds(250), start);
+  EXPECT_DOUBLE_EQ(0.25, host->responseTimeEwma(start).value());
+
+  // A zero response time still counts as measured.
+  HostSharedPtr instant_host = makeTestHost(cluster.info_, "tcp://10.0.0.2:1234", 1);
+  instant_host->putResponseTime(std::chrono::microseconds(0), start);
+  EXPECT_DOUBLE_EQ(0, instant_host->responseTimeEwma(start).value());
+}
+
 TEST(HostImplTest, HostnameCanaryAndLocality) {
   MockClusterMockPrioritySet cluster;
   envoy::api::v2::core::Metadata metadata;
@@ -1534,6 +1580,34 @@ TEST_F(ClusterImplTest, CloseConnectionsOnHostHealthFailure) {
               ClusterInfo::Features::CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE);
 }
 
+// Test that the correct feature() is set when share_http2_connections_across_workers is
+// configured.
+TEST_F(ClusterImplTest, ShareHttp2ConnectionsAcrossWorkers) {
+  auto dns_resolver = std::make_shared<Network::MockDnsResolver>();
+
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    http2_protocol_options: {}
+    share_http2_connections_across_workers: true
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+  )EOF";
+  envoy::api::v2::Cluster cluster_config = parseClusterFromV2Yaml(yaml);
+  Envoy::Stats::ScopePtr scope = stats_.createScope(fmt::format(
+      "cluster.{}.", cluster_config.alt_stat_name().empty() ? cluster_config.name()
+                                                            : cluster_config.alt_stat_name()));
+  Envoy::Server::Configuration::TransportSocketFactoryContextImpl factory_context(
+      admin_, ssl_context_manager_, *scope, cm_, local_info_, dispatcher_, random_, stats_,
+      singleton_manager_, tls_, *api_);
+
+  StrictDnsClusterImpl cluster(cluster_config, runtime_, dns_resolver, factory_context,
+                               std::move(scope), false);
+  EXPECT_TRUE(cluster.info()->features() &
+              ClusterInfo::Features::SHARE_HTTP2_CONNECTIONS_ACROSS_WORKERS);
+}
+
 class TestBatchUpdateCb : public PrioritySet::BatchUpdateCb {
 public:
   TestBatchUpdateCb(HostVectorSharedPtr hosts, HostsPerLocalitySharedPtr hosts_per_locality)
@@ -1757,6 +1831,45 @@ TEST_F(ClusterInfoImplTest, EdsServiceNamePopulation) {
                             "eds_cluster_config set in a non-EDS cluster");
 }
 
+// Peak EWMA config is only set for the peak EWMA LB policy, which can't be used with subsets.
+TEST_F(ClusterInfoImplTest, PeakEwmaLbConfig) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: PEAK_EWMA
+    peak_ewma_lb_config:
+      decay_time: 5s
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+  )EOF";
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(LoadBalancerType::PeakEwma, cluster->info()->lbType());
+  ASSERT_TRUE(cluster->info()->lbPeakEwmaConfig().has_value());
+  EXPECT_EQ(5, cluster->info()->lbPeakEwmaConfig().value().decay_time().seconds());
+
+  const std::string round_robin_yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+  )EOF";
+  EXPECT_FALSE(makeCluster(round_robin_yaml)->info()->lbPeakEwmaConfig().has_value());
+
+  const std::string subset_yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: PEAK_EWMA
+    lb_subset_config:
+      subset_selectors:
+        - keys: [ "version" ]
+    hosts: [{ socket_address: { address: foo.bar.com, port_value: 443 }}]
+  )EOF";
+  EXPECT_THROW_WITH_MESSAGE(makeCluster(subset_yaml), EnvoyException,
+                            "cluster: LB type 'peak_ewma' may not be used with lb_subset_config");
+}
+
 // Typed metadata loading throws exception.
 TEST_F(ClusterInfoImplTest, BrokenTypedMetadata) {
   const std::string yaml = R"EOF(
@@ -1,3 +1,4 @@
+#include "common/common/regex.h"
 #include "common/http/header_map_impl.h"
 
 #include "extensions/filters/http/cors/cors_filter.h"
@@ -646,7 +647,7 @@ TEST_F(CorsFilterTest, OptionsRequestMatchingOriginByRegex) {
   };
 
   cors_policy_->allow_origin_.clear();
-  cors_policy_->allow_origin_regex_.emplace_back(std::regex(".*"));
+  cors_policy_->allow_origin_regex_.emplace_back(Regex::Utility::parseRegex(".*"));
 
   EXPECT_CALL(decoder_callbacks_, encodeHeaders_(HeaderMapEqualRef(&response_headers), true));
 
@@ -669,7 +670,7 @@ TEST_F(CorsFilterTest, OptionsRequestNotMatchingOriginByRegex) {
                                           {"access-control-request-method", "GET"}};
 
   cors_policy_->allow_origin_.clear();
-  cors_policy_->allow_origin_regex_.emplace_back(std::regex(".*.envoyproxy.io"));
+  cors_policy_->allow_origin_regex_.emplace_back(Regex::Utility::parseRegex(".*.envoyproxy.io"));
 
   EXPECT_CALL(decoder_callbacks_, encodeHeaders_(_, false)).Times(0);
   EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_.decodeHeaders(request_headers, false));
@@ -52,7 +52,8 @@ public:
   ProxyProtocolTest()
       : api_(Api::createApiForTest(stats_store_)), dispatcher_(api_->allocateDispatcher()),
         socket_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true),
-        connection_handler_(new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_)),
+        connection_handler_(
+            new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_, absl::nullopt)),
         name_("proxy"), filter_chain_(Network::Test::createEmptyFilterChainWithRawBufferSockets()) {
 
     connection_handler_->addListener(*this);
@@ -67,6 +68,12 @@ public:
   Network::FilterChainFactory& filterChainFactory() override { return factory_; }
   Network::Socket& socket() override { return socket_; }
   const Network::Socket& socket() const override { return socket_; }
+  std::vector<std::reference_wrapper<Network::Socket>> listenSockets() override {
+    return {socket_};
+  }
+  std::vector<std::reference_wrapper<Network::Socket>> workerSockets(uint32_t) override {
+    return {socket_};
+  }
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() const override { return 0; }
@@ -874,7 +881,8 @@ public:
         local_dst_address_(Network::Utility::getAddressWithPort(
             *Network::Test::getCanonicalLoopbackAddress(GetParam()),
             socket_.localAddress()->ip()->port())),
-        connection_handler_(new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_)),
+        connection_handler_(
+            new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher_, absl::nullopt)),
         name_("proxy"), filter_chain_(Network::Test::createEmptyFilterChainWithRawBufferSockets()) {
     connection_handler_->addListener(*this);
     conn_ = dispatcher_->createClientConnection(local_dst_address_,
@@ -895,6 +903,12 @@ public:
   Network::FilterChainFactory& filterChainFactory() override { return factory_; }
   Network::Socket& socket() override { return socket_; }
   const Network::Socket& socket() const override { return socket_; }
+  std::vector<std::reference_wrapper<Network::Socket>> listenSockets() override {
+    return {socket_};
+  }
+  std::vector<std::reference_wrapper<Network::Socket>> workerSockets(uint32_t) override {
+    return {socket_};
+  }
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() const override { return 0; }
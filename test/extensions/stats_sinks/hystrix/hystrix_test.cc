@@ -463,15 +463,14 @@ TEST_F(HystrixSinkTest, HistogramTest) {
   auto histogram = std::make_shared<NiceMock<Stats::MockParentHistogram>>();
   histogram->name_ = "cluster." + cluster1_name_ + ".upstream_rq_time";
   const std::string tag_extracted_name = "cluster.upstream_rq_time";
-  ON_CALL(*histogram, tagExtractedName())
-      .WillByDefault(testing::ReturnRefOfCopy(tag_extracted_name));
+  ON_CALL(*histogram, tagExtractedName()).WillByDefault(testing::Return(tag_extracted_name));
   std::vector<Stats::Tag> tags;
   Stats::Tag tag = {
       Config::TagNames::get().CLUSTER_NAME, // name_
       cluster1_name_                        // value_
   };
   tags.emplace_back(tag);
-  ON_CALL(*histogram, tags()).WillByDefault(testing::ReturnRef(tags));
+  ON_CALL(*histogram, tags()).WillByDefault(testing::Return(tags));
 
   histogram->used_ = true;
 
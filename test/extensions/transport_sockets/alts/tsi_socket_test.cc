@@ -200,6 +200,11 @@ TEST_F(TsiSocketTest, DoesNotHaveSsl) {
   EXPECT_EQ(nullptr, socket_.ssl());
 }
 
+TEST_F(TsiSocketTest, IsNotPassthrough) {
+  initialize(nullptr, nullptr);
+  EXPECT_FALSE(client_.tsi_socket_->passthrough());
+}
+
 TEST_F(TsiSocketTest, HandshakeWithoutValidationAndTransferData) {
   // pass a nullptr validator to skip validation.
   initialize(nullptr, nullptr);
@@ -0,0 +1,70 @@
+#include "common/network/raw_buffer_socket.h"
+#include "common/protobuf/protobuf.h"
+
+#include "extensions/transport_sockets/raw_buffer/config.h"
+
+#include "test/mocks/server/mocks.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using Envoy::Server::Configuration::MockTransportSocketFactoryContext;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace RawBuffer {
+namespace {
+
+TEST(UpstreamRawBufferConfigTest, CreateSocketFactory) {
+  NiceMock<MockTransportSocketFactoryContext> factory_context;
+  UpstreamRawBufferSocketFactory factory;
+
+  ProtobufTypes::MessagePtr config = factory.createEmptyConfigProto();
+  auto socket_factory = factory.createTransportSocketFactory(*config, factory_context);
+  EXPECT_FALSE(socket_factory->implementsSecureTransport());
+
+  auto socket = socket_factory->createTransportSocket(nullptr);
+  EXPECT_EQ(Network::RawBufferSocket::DefaultMaxReadSize,
+            dynamic_cast<Network::RawBufferSocket&>(*socket).readSize());
+  EXPECT_EQ(0UL, factory_context.stats_scope_.counter("raw_buffer.reads").value());
+}
+
+TEST(DownstreamRawBufferConfigTest, CreateSocketFactory) {
+  NiceMock<MockTransportSocketFactoryContext> factory_context;
+  DownstreamRawBufferSocketFactory factory;
+
+  ProtobufTypes::MessagePtr config = factory.createEmptyConfigProto();
+  std::string yaml = R"EOF(
+  max_read_size_bytes: 8192
+  )EOF";
+  MessageUtil::loadFromYaml(yaml, *config);
+
+  auto socket_factory = factory.createTransportSocketFactory(*config, factory_context, {});
+  EXPECT_FALSE(socket_factory->implementsSecureTransport());
+
+  // Connections start reading at the configured limit when it is below the default read size.
+  auto socket = socket_factory->createTransportSocket(nullptr);
+  EXPECT_EQ(8192UL, dynamic_cast<Network::RawBufferSocket&>(*socket).readSize());
+}
+
+TEST(DownstreamRawBufferConfigTest, ReadSizeTooSmall) {
+  NiceMock<MockTransportSocketFactoryContext> factory_context;
+  DownstreamRawBufferSocketFactory factory;
+
+  ProtobufTypes::MessagePtr config = factory.createEmptyConfigProto();
+  std::string yaml = R"EOF(
+  max_read_size_bytes: 1024
+  )EOF";
+  MessageUtil::loadFromYaml(yaml, *config);
+
+  EXPECT_THROW(factory.createTransportSocketFactory(*config, factory_context, {}),
+               ProtoValidationException);
+}
+
+} // namespace
+} // namespace RawBuffer
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -18,6 +18,7 @@
 #include "test/mocks/secret/mocks.h"
 #include "test/mocks/server/mocks.h"
 #include "test/test_common/environment.h"
+#include "test/test_common/logging.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
@@ -1058,6 +1059,28 @@ TEST_F(ServerContextConfigImplTest, MultipleTlsCertificates) {
   EXPECT_THAT(tls_certs[1].get().privateKeyPath(), EndsWith("selfsigned_ecdsa_p256_key.pem"));
 }
 
+// Kernel TLS offload only applies to TLS 1.2, so leaving the maximum version at TLS 1.3 warns.
+TEST_F(ServerContextConfigImplTest, KernelTlsOffloadWithTls13) {
+  envoy::api::v2::auth::DownstreamTlsContext tls_context;
+  const std::string tls_certificate_yaml = R"EOF(
+  certificate_chain:
+    filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_cert.pem"
+  private_key:
+    filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+  )EOF";
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(tls_certificate_yaml),
+                            *tls_context.mutable_common_tls_context()->add_tls_certificates());
+  tls_context.mutable_kernel_tls_offload()->set_value(true);
+  EXPECT_LOG_CONTAINS("warn", "kernel_tls_offload only applies to TLS 1.2 connections",
+                      ServerContextConfigImpl server_context_config(tls_context, factory_context_));
+
+  tls_context.mutable_common_tls_context()->mutable_tls_params()->set_tls_maximum_protocol_version(
+      envoy::api::v2::auth::TlsParameters::TLSv1_2);
+  EXPECT_LOG_NOT_CONTAINS("warn", "kernel_tls_offload",
+                          ServerContextConfigImpl server_context_config(tls_context,
+                                                                        factory_context_));
+}
+
 TEST_F(ServerContextConfigImplTest, TlsCertificatesAndSdsConfig) {
   envoy::api::v2::auth::DownstreamTlsContext tls_context;
   EXPECT_THROW_WITH_MESSAGE(
@@ -0,0 +1,166 @@
+// Usage: bazel run //test/extensions/transport_sockets/tls:ssl_socket_benchmark
+//
+// Must be run from the runfiles directory, which bazel run does, so that the test certificates
+// can be found.
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/network/io_socket_handle_impl.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/transport_sockets/tls/context_config_impl.h"
+#include "extensions/transport_sockets/tls/context_manager_impl.h"
+#include "extensions/transport_sockets/tls/ssl_socket.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"
+      private_key:
+        filename: "test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"
+)EOF";
+
+// The size of the response body written in each iteration.
+constexpr uint64_t BodySize = 4 * 1024 * 1024;
+
+// A TLS connection between a server and a client SSL socket over a local socket pair. Both ends
+// are driven by hand from the benchmark thread, so the timing covers encryption, decryption and
+// the socket writes, but no event loop.
+class SslSocketPair {
+public:
+  SslSocketPair() : api_(Api::createApiForTest(store_)), manager_(api_->timeSource()) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+
+    envoy::api::v2::auth::DownstreamTlsContext downstream_tls_context;
+    MessageUtil::loadFromYaml(server_ctx_yaml, downstream_tls_context);
+    server_factory_ = std::make_unique<ServerSslSocketFactory>(
+        std::make_unique<ServerContextConfigImpl>(downstream_tls_context, factory_context_),
+        manager_, store_, std::vector<std::string>{});
+    client_factory_ = std::make_unique<ClientSslSocketFactory>(
+        std::make_unique<ClientContextConfigImpl>(envoy::api::v2::auth::UpstreamTlsContext(),
+                                                  factory_context_),
+        manager_, store_);
+
+    int fds[2];
+    RELEASE_ASSERT(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0, "");
+    for (int fd : fds) {
+      RELEASE_ASSERT(::fcntl(fd, F_SETFL, O_NONBLOCK) == 0, "");
+    }
+    server_io_handle_ = std::make_unique<Network::IoSocketHandleImpl>(fds[0]);
+    client_io_handle_ = std::make_unique<Network::IoSocketHandleImpl>(fds[1]);
+    ON_CALL(server_callbacks_, ioHandle()).WillByDefault(ReturnRef(*server_io_handle_));
+    ON_CALL(client_callbacks_, ioHandle()).WillByDefault(ReturnRef(*client_io_handle_));
+
+    server_ = server_factory_->createTransportSocket(nullptr);
+    client_ = client_factory_->createTransportSocket(nullptr);
+    server_->setTransportSocketCallbacks(server_callbacks_);
+    client_->setTransportSocketCallbacks(client_callbacks_);
+
+    Buffer::OwnedImpl empty;
+    Buffer::OwnedImpl read_buffer;
+    while (!server_->canFlushClose() || !client_->canFlushClose()) {
+      client_->doWrite(empty, false);
+      server_->doRead(read_buffer);
+      server_->doWrite(empty, false);
+      client_->doRead(read_buffer);
+    }
+  }
+
+  // Writes the body from the server to the client, reading on the client whenever the socket
+  // buffer fills up.
+  void transfer(Buffer::Instance& body) {
+    const uint64_t expected = body.length();
+    uint64_t received = 0;
+    while (received < expected) {
+      server_->doWrite(body, false);
+      Buffer::OwnedImpl read_buffer;
+      client_->doRead(read_buffer);
+      received += read_buffer.length();
+    }
+  }
+
+private:
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  ContextManagerImpl manager_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  Network::TransportSocketFactoryPtr server_factory_;
+  Network::TransportSocketFactoryPtr client_factory_;
+  Network::IoHandlePtr server_io_handle_;
+  Network::IoHandlePtr client_io_handle_;
+  NiceMock<Network::MockTransportSocketCallbacks> server_callbacks_;
+  NiceMock<Network::MockTransportSocketCallbacks> client_callbacks_;
+  Network::TransportSocketPtr server_;
+  Network::TransportSocketPtr client_;
+};
+
+// Times a large download through the server socket when the body arrives in slices of the given
+// size, as it does when proxied from an upstream connection. Slices smaller than a TLS record have
+// to be coalesced, while larger ones can be encrypted in place.
+void BM_SslWriteSlices(benchmark::State& state) {
+  SslSocketPair pair;
+  const uint64_t slice_size = state.range(0);
+  const std::string data(BodySize, 'a');
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<std::unique_ptr<Buffer::BufferFragmentImpl>> fragments;
+    Buffer::OwnedImpl body;
+    for (uint64_t offset = 0; offset < BodySize; offset += slice_size) {
+      fragments.emplace_back(std::make_unique<Buffer::BufferFragmentImpl>(
+          data.data() + offset, std::min(slice_size, BodySize - offset), nullptr));
+      body.addBufferFragment(*fragments.back());
+    }
+    state.ResumeTiming();
+
+    pair.transfer(body);
+  }
+  state.SetBytesProcessed(state.iterations() * BodySize);
+}
+BENCHMARK(BM_SslWriteSlices)->Arg(512)->Arg(4096)->Arg(12 * 1024)->Arg(16384)->Arg(64 * 1024);
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_context(spdlog::level::warn,
+                                         Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1,6 +1,11 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <netinet/tcp.h>
+#endif
 
 #include "envoy/network/transport_socket.h"
 
@@ -48,6 +53,11 @@ using testing::Return;
 using testing::ReturnRef;
 using testing::StrictMock;
 
+// Older C library headers lack the socket option that attaches kernel TLS.
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+
 namespace Envoy {
 namespace Extensions {
 namespace TransportSockets {
@@ -639,6 +649,8 @@ protected:
   void testClientSessionResumption(const std::string& server_ctx_yaml,
                                    const std::string& client_ctx_yaml, bool expect_reuse,
                                    const Network::Address::IpVersion version);
+  void testKernelTlsHalfClose(const std::string& client_ctx_yaml,
+                              Stats::IsolatedStoreImpl& server_stats_store);
 
   Event::DispatcherPtr dispatcher_;
 };
@@ -2081,6 +2093,162 @@ TEST_P(SslSocketTest, HalfClose) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Connects a client to a server with kernel TLS offload enabled. The server sends a response and
+// half closes, and the client half closes in turn once it has received all of it.
+void SslSocketTest::testKernelTlsHalfClose(const std::string& client_ctx_yaml,
+                                           Stats::IsolatedStoreImpl& server_stats_store) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"
+    tls_params:
+      tls_maximum_protocol_version: TLSv1_3
+  kernel_tls_offload: true
+)EOF";
+
+  envoy::api::v2::auth::DownstreamTlsContext server_tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context_);
+  ContextManagerImpl manager(time_system_);
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, std::vector<std::string>{});
+
+  Network::TcpListenSocket socket(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr,
+                                  true);
+  Network::MockListenerCallbacks listener_callbacks;
+  Network::MockConnectionHandler connection_handler;
+  Network::ListenerPtr listener =
+      dispatcher_->createListener(socket, listener_callbacks, true, false);
+  std::shared_ptr<Network::MockReadFilter> server_read_filter(new Network::MockReadFilter());
+  std::shared_ptr<Network::MockReadFilter> client_read_filter(new Network::MockReadFilter());
+
+  envoy::api::v2::auth::UpstreamTlsContext tls_context;
+  MessageUtil::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml), tls_context);
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(tls_context, factory_context_);
+  Stats::IsolatedStoreImpl client_stats_store;
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager,
+                                                   client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket.localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(nullptr), nullptr);
+  client_connection->enableHalfClose(true);
+  client_connection->addReadFilter(client_read_filter);
+  client_connection->connect();
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_, _))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+        Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket(nullptr));
+        listener_callbacks.onNewConnection(std::move(new_connection));
+      }));
+  EXPECT_CALL(listener_callbacks, onNewConnection_(_))
+      .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+        server_connection = std::move(conn);
+        server_connection->enableHalfClose(true);
+        server_connection->addReadFilter(server_read_filter);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+
+  const std::string response(64 * 1024, 'a');
+  EXPECT_CALL(*server_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(*client_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        Buffer::OwnedImpl data(response);
+        server_connection->write(data, true);
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+
+  std::string received;
+  EXPECT_CALL(*client_read_filter, onData(_, _))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool end_stream) -> Network::FilterStatus {
+        received.append(data.toString());
+        data.drain(data.length());
+        if (end_stream) {
+          Buffer::OwnedImpl buffer("world");
+          client_connection->write(buffer, true);
+        }
+        return Network::FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(*server_read_filter, onData(BufferStringEqual("world"), true));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(response, received);
+  EXPECT_EQ(0UL, client_stats_store.counter("ssl.ktls_offloaded").value());
+}
+
+namespace {
+
+// Returns whether the kernel accepts the TLS upper layer protocol on a connected TCP socket.
+bool kernelTlsSupported(Network::Address::IpVersion version) {
+#ifdef __linux__
+  Network::TcpListenSocket listen_socket(Network::Test::getCanonicalLoopbackAddress(version),
+                                         nullptr, true);
+  if (::listen(listen_socket.ioHandle().fd(), 1) != 0) {
+    return false;
+  }
+  const Network::Address::InstanceConstSharedPtr& address = listen_socket.localAddress();
+  Network::IoHandlePtr io_handle = address->socket(Network::Address::SocketType::Stream);
+  return ::connect(io_handle->fd(), address->sockAddr(), address->sockAddrLen()) == 0 &&
+         ::setsockopt(io_handle->fd(), SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0;
+#else
+  UNREFERENCED_PARAMETER(version);
+  return false;
+#endif
+}
+
+} // namespace
+
+// A TLS 1.2 AES-GCM connection is offloaded to kernel TLS when the kernel supports it, and the
+// data and the close_notify sent by the kernel reach the client intact.
+TEST_P(SslSocketTest, KernelTlsOffloadHalfClose) {
+  if (!kernelTlsSupported(GetParam())) {
+    GTEST_SKIP() << "kernel TLS is not available";
+  }
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_maximum_protocol_version: TLSv1_2
+        cipher_suites:
+          - ECDHE-RSA-AES128-GCM-SHA256
+  )EOF";
+
+  Stats::IsolatedStoreImpl server_stats_store;
+  testKernelTlsHalfClose(client_ctx_yaml, server_stats_store);
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.ktls_offloaded").value());
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.ktls_fallback").value());
+}
+
+// BoringSSL does not expose the traffic keys of TLS 1.3 connections, so they always fall back to
+// user space encryption, whatever the kernel supports.
+TEST_P(SslSocketTest, KernelTlsFallbackTls13) {
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      tls_params:
+        tls_minimum_protocol_version: TLSv1_3
+        tls_maximum_protocol_version: TLSv1_3
+  )EOF";
+
+  Stats::IsolatedStoreImpl server_stats_store;
+  testKernelTlsHalfClose(client_ctx_yaml, server_stats_store);
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.ktls_offloaded").value());
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.ktls_fallback").value());
+}
+
 TEST_P(SslSocketTest, ClientAuthMultipleCAs) {
   const std::string server_ctx_yaml = R"EOF(
   common_tls_context:
@@ -3733,6 +3901,65 @@ protected:
     EXPECT_EQ(0UL, client_stats_store_.counter("ssl.connection_error").value());
   }
 
+  // Writes a buffer made of slices of the given sizes, which the SSL socket has to turn into
+  // records either in place or by coalescing slices, and checks that the data arrives intact.
+  void fragmentedWriteTest(const std::vector<uint32_t>& slice_sizes) {
+    initialize();
+
+    EXPECT_CALL(listener_callbacks_, onAccept_(_, _))
+        .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket, bool) -> void {
+          Network::ConnectionPtr new_connection = dispatcher_->createServerConnection(
+              std::move(socket), server_ssl_socket_factory_->createTransportSocket(nullptr));
+          listener_callbacks_.onNewConnection(std::move(new_connection));
+        }));
+    EXPECT_CALL(listener_callbacks_, onNewConnection_(_))
+        .WillOnce(Invoke([&](Network::ConnectionPtr& conn) -> void {
+          server_connection_ = std::move(conn);
+          server_connection_->addConnectionCallbacks(server_callbacks_);
+          server_connection_->addReadFilter(read_filter_);
+        }));
+
+    EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::Connected))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+    std::vector<std::string> slices;
+    std::string data_to_write;
+    for (uint32_t slice_size : slice_sizes) {
+      slices.emplace_back(slice_size, static_cast<char>('a' + slices.size() % 26));
+      data_to_write += slices.back();
+    }
+
+    std::string data_read;
+    EXPECT_CALL(*read_filter_, onNewConnection());
+    EXPECT_CALL(*read_filter_, onData(_, _))
+        .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) -> Network::FilterStatus {
+          data_read += data.toString();
+          data.drain(data.length());
+          if (data_read.size() == data_to_write.size()) {
+            server_connection_->close(Network::ConnectionCloseType::FlushWrite);
+          }
+          return Network::FilterStatus::StopIteration;
+        }));
+    EXPECT_CALL(client_callbacks_, onEvent(Network::ConnectionEvent::RemoteClose))
+        .WillOnce(Invoke([&](Network::ConnectionEvent) -> void { dispatcher_->exit(); }));
+
+    // Fragments keep each slice separate, where adding the data would copy it into shared slices.
+    std::vector<std::unique_ptr<Buffer::BufferFragmentImpl>> fragments;
+    Buffer::OwnedImpl data;
+    for (const std::string& slice : slices) {
+      fragments.emplace_back(
+          std::make_unique<Buffer::BufferFragmentImpl>(slice.data(), slice.size(), nullptr));
+      data.addBufferFragment(*fragments.back());
+    }
+    client_connection_->write(data, false);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+    EXPECT_EQ(data_to_write, data_read);
+    EXPECT_EQ(0UL, server_stats_store_.counter("ssl.connection_error").value());
+    EXPECT_EQ(0UL, client_stats_store_.counter("ssl.connection_error").value());
+  }
+
   void singleWriteTest(uint32_t read_buffer_limit, uint32_t bytes_to_write) {
     MockWatermarkBuffer* client_write_buffer = nullptr;
     MockBufferFactory* factory = new StrictMock<MockBufferFactory>;
@@ -3863,6 +4090,14 @@ TEST_P(SslReadBufferLimitTest, SomeLimit) {
   readBufferLimitTest(32 * 1024, 32 * 1024, 256 * 1024, 1, false);
 }
 
+TEST_P(SslReadBufferLimitTest, FragmentedWriteSmallSlices) {
+  fragmentedWriteTest(std::vector<uint32_t>(1024, 100));
+}
+
+TEST_P(SslReadBufferLimitTest, FragmentedWriteMixedSlices) {
+  fragmentedWriteTest({1, 16384, 100, 4096, 3000, 70000, 4095, 20000, 17, 5000, 16385, 1});
+}
+
 TEST_P(SslReadBufferLimitTest, WritesSmallerThanBufferLimit) { singleWriteTest(5 * 1024, 1024); }
 
 TEST_P(SslReadBufferLimitTest, WritesLargerThanBufferLimit) { singleWriteTest(1024, 5 * 1024); }
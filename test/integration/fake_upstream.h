@@ -581,6 +581,12 @@ private:
     Network::FilterChainFactory& filterChainFactory() override { return parent_; }
     Network::Socket& socket() override { return *parent_.socket_; }
     const Network::Socket& socket() const override { return *parent_.socket_; }
+    std::vector<std::reference_wrapper<Network::Socket>> listenSockets() override {
+      return {*parent_.socket_};
+    }
+    std::vector<std::reference_wrapper<Network::Socket>> workerSockets(uint32_t) override {
+      return {*parent_.socket_};
+    }
     bool bindToPort() override { return true; }
     bool handOffRestoredDestinationConnections() const override { return false; }
     uint32_t perConnectionBufferLimitBytes() const override { return 0; }
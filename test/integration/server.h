@@ -139,11 +139,25 @@ public:
     Thread::LockGuard lock(lock_);
     return store_.histograms();
   }
+  std::vector<CounterSharedPtr> countersWithPrefix(absl::string_view prefix) const override {
+    Thread::LockGuard lock(lock_);
+    return store_.countersWithPrefix(prefix);
+  }
+  std::vector<GaugeSharedPtr> gaugesWithPrefix(absl::string_view prefix) const override {
+    Thread::LockGuard lock(lock_);
+    return store_.gaugesWithPrefix(prefix);
+  }
+  std::vector<ParentHistogramSharedPtr>
+  histogramsWithPrefix(absl::string_view prefix) const override {
+    Thread::LockGuard lock(lock_);
+    return store_.histogramsWithPrefix(prefix);
+  }
 
   // Stats::StoreRoot
   void addSink(Sink&) override {}
   void setTagProducer(TagProducerPtr&&) override {}
   void setStatsMatcher(StatsMatcherPtr&&) override {}
+  void setHistogramSettings(HistogramSettingsConstPtr&&) override {}
   void initializeThreading(Event::Dispatcher&, ThreadLocal::Instance&) override {}
   void shutdownThreading() override {}
   void mergeHistograms(PostMergeCb) override {}
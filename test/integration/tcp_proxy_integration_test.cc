@@ -31,6 +31,19 @@ void TcpProxyIntegrationTest::initialize() {
   BaseIntegrationTest::initialize();
 }
 
+void TcpProxyIntegrationTest::enableSplice() {
+  config_helper_.addConfigModifier([&](envoy::config::bootstrap::v2::Bootstrap& bootstrap) -> void {
+    auto* listener = bootstrap.mutable_static_resources()->mutable_listeners(0);
+    auto* filter_chain = listener->mutable_filter_chains(0);
+    auto* config_blob = filter_chain->mutable_filters(0)->mutable_config();
+
+    envoy::config::filter::network::tcp_proxy::v2::TcpProxy tcp_proxy_config;
+    MessageUtil::jsonConvert(*config_blob, tcp_proxy_config);
+    tcp_proxy_config.set_splice(true);
+    MessageUtil::jsonConvert(tcp_proxy_config, *config_blob);
+  });
+}
+
 // Test upstream writing before downstream downstream does.
 TEST_P(TcpProxyIntegrationTest, TcpProxyUpstreamWritesFirst) {
   initialize();
@@ -358,6 +371,69 @@ TEST_P(TcpProxyIntegrationTest, TestIdletimeoutWithLargeOutstandingData) {
   ASSERT_TRUE(fake_upstream_connection->waitForDisconnect(true));
 }
 
+// Test proxying data and half-closes in both directions with splicing.
+TEST_P(TcpProxyIntegrationTest, SpliceHalfClose) {
+  enableSplice();
+  initialize();
+  IntegrationTcpClientPtr tcp_client = makeTcpConnection(lookupPort("tcp_proxy"));
+  tcp_client->write("hello");
+  FakeRawConnectionPtr fake_upstream_connection;
+  ASSERT_TRUE(fake_upstreams_[0]->waitForRawConnection(fake_upstream_connection));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(5));
+
+  ASSERT_TRUE(fake_upstream_connection->write("world"));
+  tcp_client->waitForData("world");
+  tcp_client->write("hello", true);
+  ASSERT_TRUE(fake_upstream_connection->waitForData(10));
+  ASSERT_TRUE(fake_upstream_connection->waitForHalfClose());
+
+  ASSERT_TRUE(fake_upstream_connection->write("world", true));
+  tcp_client->waitForHalfClose();
+  ASSERT_TRUE(fake_upstream_connection->waitForDisconnect());
+  tcp_client->close();
+
+  EXPECT_EQ("worldworld", tcp_client->data());
+  EXPECT_EQ(1, test_server_->counter("tcp.tcp_stats.splice_total")->value());
+  EXPECT_EQ(0, test_server_->counter("tcp.tcp_stats.splice_fallback")->value());
+  EXPECT_EQ(10, test_server_->counter("tcp.tcp_stats.downstream_cx_rx_bytes_total")->value());
+  EXPECT_EQ(10, test_server_->counter("tcp.tcp_stats.downstream_cx_tx_bytes_total")->value());
+}
+
+// Test that splicing applies back pressure when the pipes fill up, and that all data is relayed.
+TEST_P(TcpProxyIntegrationTest, SpliceLargeWrite) {
+  config_helper_.setBufferLimits(1024, 1024);
+  enableSplice();
+  initialize();
+
+  std::string data(1024 * 1024, 'a');
+  IntegrationTcpClientPtr tcp_client = makeTcpConnection(lookupPort("tcp_proxy"));
+  tcp_client->write(data);
+  FakeRawConnectionPtr fake_upstream_connection;
+  ASSERT_TRUE(fake_upstreams_[0]->waitForRawConnection(fake_upstream_connection));
+  ASSERT_TRUE(fake_upstream_connection->waitForData(data.size()));
+  ASSERT_TRUE(fake_upstream_connection->write(data));
+  tcp_client->waitForData(data);
+  tcp_client->close();
+  ASSERT_TRUE(fake_upstream_connection->waitForHalfClose());
+  ASSERT_TRUE(fake_upstream_connection->close());
+  ASSERT_TRUE(fake_upstream_connection->waitForDisconnect());
+
+  EXPECT_EQ(1, test_server_->counter("tcp.tcp_stats.splice_total")->value());
+  uint32_t upstream_pauses =
+      test_server_->counter("cluster.cluster_0.upstream_flow_control_paused_reading_total")
+          ->value();
+  uint32_t upstream_resumes =
+      test_server_->counter("cluster.cluster_0.upstream_flow_control_resumed_reading_total")
+          ->value();
+  EXPECT_EQ(upstream_pauses, upstream_resumes);
+
+  uint32_t downstream_pauses =
+      test_server_->counter("tcp.tcp_stats.downstream_flow_control_paused_reading_total")->value();
+  uint32_t downstream_resumes =
+      test_server_->counter("tcp.tcp_stats.downstream_flow_control_resumed_reading_total")->value();
+  EXPECT_EQ(downstream_pauses, downstream_resumes);
+}
+
 INSTANTIATE_TEST_SUITE_P(IpVersions, TcpProxySslIntegrationTest,
                          testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
                          TestUtility::ipTestParamsToString);
@@ -23,6 +23,7 @@ public:
   }
 
   void initialize() override;
+  void enableSplice();
 };
 
 class TcpProxySslIntegrationTest : public TcpProxyIntegrationTest {
@@ -32,6 +32,24 @@ Api::SysCallSizeResult MockFile::write(absl::string_view buffer) {
   return result;
 }
 
+Api::SysCallSizeResult MockFile::writev(const iovec* iov, int num_iov) {
+  Thread::LockGuard lock(write_mutex_);
+  if (!is_open_) {
+    return {-1, EBADF};
+  }
+
+  // Tests set expectations on write_(), so present the vectored write as one contiguous buffer.
+  std::string buffer;
+  for (int i = 0; i < num_iov; i++) {
+    buffer.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  }
+  const Api::SysCallSizeResult result = write_(buffer);
+  num_writes_++;
+  write_event_.notifyOne();
+
+  return result;
+}
+
 Api::SysCallBoolResult MockFile::close() {
   const Api::SysCallBoolResult result = close_();
   is_open_ = !result.rc_;
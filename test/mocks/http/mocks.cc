@@ -34,7 +34,10 @@ MockServerConnection::MockServerConnection() {
 
 MockServerConnection::~MockServerConnection() {}
 
-MockClientConnection::MockClientConnection() {}
+MockClientConnection::MockClientConnection() {
+  ON_CALL(*this, maxConcurrentStreams())
+      .WillByDefault(Return(std::numeric_limits<uint32_t>::max()));
+}
 MockClientConnection::~MockClientConnection() {}
 
 MockFilterChainFactory::MockFilterChainFactory() {}
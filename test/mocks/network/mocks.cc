@@ -27,6 +27,10 @@ namespace Network {
 MockListenerConfig::MockListenerConfig() {
   ON_CALL(*this, filterChainFactory()).WillByDefault(ReturnRef(filter_chain_factory_));
   ON_CALL(*this, socket()).WillByDefault(ReturnRef(socket_));
+  ON_CALL(*this, listenSockets())
+      .WillByDefault(Return(std::vector<std::reference_wrapper<Socket>>{socket_}));
+  ON_CALL(*this, workerSockets(_))
+      .WillByDefault(Return(std::vector<std::reference_wrapper<Socket>>{socket_}));
   ON_CALL(*this, listenerScope()).WillByDefault(ReturnRef(scope_));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
 }
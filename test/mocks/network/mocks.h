@@ -281,6 +281,8 @@ public:
   MOCK_METHOD0(filterChainFactory, FilterChainFactory&());
   MOCK_METHOD0(socket, Socket&());
   MOCK_CONST_METHOD0(socket, const Socket&());
+  MOCK_METHOD0(listenSockets, std::vector<std::reference_wrapper<Socket>>());
+  MOCK_METHOD1(workerSockets, std::vector<std::reference_wrapper<Socket>>(uint32_t worker_index));
   MOCK_METHOD0(bindToPort, bool());
   MOCK_CONST_METHOD0(handOffRestoredDestinationConnections, bool());
   MOCK_CONST_METHOD0(perConnectionBufferLimitBytes, uint32_t());
@@ -372,6 +374,7 @@ public:
   MOCK_METHOD2(doWrite, IoResult(Buffer::Instance& buffer, bool end_stream));
   MOCK_METHOD0(onConnected, void());
   MOCK_CONST_METHOD0(ssl, const Ssl::Connection*());
+  MOCK_CONST_METHOD0(passthrough, bool());
 
   TransportSocketCallbacks* callbacks_{};
 };
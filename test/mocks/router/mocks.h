@@ -46,7 +46,9 @@ class TestCorsPolicy : public CorsPolicy {
 public:
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; };
+  const std::vector<Regex::CompiledMatcherPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  };
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -56,7 +58,7 @@ public:
   bool shadowEnabled() const override { return shadow_enabled_; };
 
   std::list<std::string> allow_origin_{};
-  std::list<std::regex> allow_origin_regex_{};
+  std::vector<Regex::CompiledMatcherPtr> allow_origin_regex_{};
   std::string allow_methods_{};
   std::string allow_headers_{};
   std::string expose_headers_{};
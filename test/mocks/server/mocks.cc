@@ -34,6 +34,11 @@ MockOptions::MockOptions(const std::string& config_path) : config_path_(config_p
   ON_CALL(*this, hotRestartDisabled()).WillByDefault(ReturnPointee(&hot_restart_disabled_));
   ON_CALL(*this, signalHandlingEnabled()).WillByDefault(ReturnPointee(&signal_handling_enabled_));
   ON_CALL(*this, mutexTracingEnabled()).WillByDefault(ReturnPointee(&mutex_tracing_enabled_));
+  ON_CALL(*this, libeventBufferEnabled()).WillByDefault(ReturnPointee(&libevent_buffer_enabled_));
+  ON_CALL(*this, regexEngine()).WillByDefault(ReturnPointee(&regex_engine_));
+  ON_CALL(*this, regexMaxProgramSize()).WillByDefault(ReturnPointee(&regex_max_program_size_));
+  ON_CALL(*this, fileFlushSizeKb()).WillByDefault(ReturnPointee(&file_flush_size_kb_));
+  ON_CALL(*this, fileBufferLimitKb()).WillByDefault(ReturnPointee(&file_buffer_limit_kb_));
   ON_CALL(*this, toCommandLineOptions()).WillByDefault(Invoke([] {
     return std::make_unique<envoy::admin::v2alpha::CommandLineOptions>();
   }));
@@ -71,7 +76,7 @@ MockGuardDog::MockGuardDog() : watch_dog_(new NiceMock<MockWatchDog>()) {
 }
 MockGuardDog::~MockGuardDog() = default;
 
-MockHotRestart::MockHotRestart() {
+MockHotRestart::MockHotRestart() : stats_allocator_(symbol_table_) {
   ON_CALL(*this, logLock()).WillByDefault(ReturnRef(log_lock_));
   ON_CALL(*this, accessLogLock()).WillByDefault(ReturnRef(access_log_lock_));
   ON_CALL(*this, statsAllocator()).WillByDefault(ReturnRef(stats_allocator_));
@@ -85,16 +90,17 @@ MockOverloadManager::~MockOverloadManager() = default;
 
 MockListenerComponentFactory::MockListenerComponentFactory()
     : socket_(std::make_shared<NiceMock<Network::MockListenSocket>>()) {
-  ON_CALL(*this, createListenSocket(_, _, _, _))
-      .WillByDefault(Invoke(
-          [&](Network::Address::InstanceConstSharedPtr, Network::Address::SocketType,
-              const Network::Socket::OptionsSharedPtr& options, bool) -> Network::SocketSharedPtr {
-            if (!Network::Socket::applyOptions(options, *socket_,
-                                               envoy::api::v2::core::SocketOption::STATE_PREBIND)) {
-              throw EnvoyException("MockListenerComponentFactory: Setting socket options failed");
-            }
-            return socket_;
-          }));
+  ON_CALL(*this, createListenSocket(_, _, _, _, _, _))
+      .WillByDefault(Invoke([&](Network::Address::InstanceConstSharedPtr,
+                                Network::Address::SocketType,
+                                const Network::Socket::OptionsSharedPtr& options, bool, uint32_t,
+                                uint32_t&) -> Network::SocketSharedPtr {
+        if (!Network::Socket::applyOptions(options, *socket_,
+                                           envoy::api::v2::core::SocketOption::STATE_PREBIND)) {
+          throw EnvoyException("MockListenerComponentFactory: Setting socket options failed");
+        }
+        return socket_;
+      }));
 }
 MockListenerComponentFactory::~MockListenerComponentFactory() = default;
 
@@ -189,6 +195,7 @@ MockFactoryContext::~MockFactoryContext() = default;
 MockTransportSocketFactoryContext::MockTransportSocketFactoryContext()
     : secret_manager_(new Secret::SecretManagerImpl()) {
   ON_CALL(*this, api()).WillByDefault(ReturnRef(api_));
+  ON_CALL(*this, statsScope()).WillByDefault(ReturnRef(stats_scope_));
 }
 
 MockTransportSocketFactoryContext::~MockTransportSocketFactoryContext() = default;
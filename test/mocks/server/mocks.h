@@ -70,6 +70,8 @@ public:
   MOCK_CONST_METHOD0(parentShutdownTime, std::chrono::seconds());
   MOCK_CONST_METHOD0(restartEpoch, uint64_t());
   MOCK_CONST_METHOD0(fileFlushIntervalMsec, std::chrono::milliseconds());
+  MOCK_CONST_METHOD0(fileFlushSizeKb, uint32_t());
+  MOCK_CONST_METHOD0(fileBufferLimitKb, uint32_t());
   MOCK_CONST_METHOD0(mode, Mode());
   MOCK_CONST_METHOD0(serviceClusterName, const std::string&());
   MOCK_CONST_METHOD0(serviceNodeName, const std::string&());
@@ -79,6 +81,9 @@ public:
   MOCK_CONST_METHOD0(hotRestartDisabled, bool());
   MOCK_CONST_METHOD0(signalHandlingEnabled, bool());
   MOCK_CONST_METHOD0(mutexTracingEnabled, bool());
+  MOCK_CONST_METHOD0(libeventBufferEnabled, bool());
+  MOCK_CONST_METHOD0(regexEngine, Regex::Engine());
+  MOCK_CONST_METHOD0(regexMaxProgramSize, uint32_t());
   MOCK_CONST_METHOD0(toCommandLineOptions, Server::CommandLineOptionsPtr());
 
   std::string config_path_;
@@ -95,6 +100,11 @@ public:
   bool hot_restart_disabled_{};
   bool signal_handling_enabled_{true};
   bool mutex_tracing_enabled_{};
+  bool libevent_buffer_enabled_{true};
+  Regex::Engine regex_engine_{Regex::Engine::StdRegex};
+  uint32_t regex_max_program_size_{100};
+  uint32_t file_flush_size_kb_{64};
+  uint32_t file_buffer_limit_kb_{};
 };
 
 class MockConfigTracker : public ConfigTracker {
@@ -194,7 +204,8 @@ public:
 
   // Server::HotRestart
   MOCK_METHOD0(drainParentListeners, void());
-  MOCK_METHOD1(duplicateParentListenSocket, int(const std::string& address));
+  MOCK_METHOD3(duplicateParentListenSocket,
+               int(const std::string& address, uint32_t socket_index, uint32_t& num_sockets));
   MOCK_METHOD1(getParentStats, void(GetParentStatsInfo& info));
   MOCK_METHOD2(initialize, void(Event::Dispatcher& dispatcher, Server::Instance& server));
   MOCK_METHOD1(shutdownParentAdmin, void(ShutdownParentAdminInfo& info));
@@ -208,6 +219,7 @@ public:
 private:
   Thread::MutexBasicLockable log_lock_;
   Thread::MutexBasicLockable access_log_lock_;
+  Stats::SymbolTableImpl symbol_table_;
   Stats::HeapStatDataAllocator stats_allocator_;
 };
 
@@ -232,11 +244,12 @@ public:
                std::vector<Network::ListenerFilterFactoryCb>(
                    const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>&,
                    Configuration::ListenerFactoryContext& context));
-  MOCK_METHOD4(createListenSocket,
+  MOCK_METHOD6(createListenSocket,
                Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
                                         Network::Address::SocketType socket_type,
                                         const Network::Socket::OptionsSharedPtr& options,
-                                        bool bind_to_port));
+                                        bool bind_to_port, uint32_t socket_index,
+                                        uint32_t& num_parent_sockets));
   MOCK_METHOD1(createDrainManager_, DrainManager*(envoy::api::v2::Listener::DrainType drain_type));
   MOCK_METHOD0(nextListenerTag, uint64_t());
 
@@ -265,7 +278,9 @@ public:
   ~MockWorkerFactory();
 
   // Server::WorkerFactory
-  WorkerPtr createWorker(OverloadManager&) override { return WorkerPtr{createWorker_()}; }
+  WorkerPtr createWorker(uint32_t, OverloadManager&) override {
+    return WorkerPtr{createWorker_()};
+  }
 
   MOCK_METHOD0(createWorker_, Worker*());
 };
@@ -477,6 +492,7 @@ public:
 
   std::unique_ptr<Secret::SecretManager> secret_manager_;
   testing::NiceMock<Api::MockApi> api_;
+  Stats::IsolatedStoreImpl stats_scope_;
 };
 
 class MockListenerFactoryContext : public MockFactoryContext, public ListenerFactoryContext {
@@ -13,9 +13,22 @@ using testing::ReturnRef;
 namespace Envoy {
 namespace Stats {
 
+MockMetric::MockMetric() {
+  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnPointee(&name_));
+  ON_CALL(*this, tags()).WillByDefault(ReturnPointee(&tags_));
+}
+MockMetric::~MockMetric() {}
+
+StatName MockMetric::statName() const {
+  if (stat_name_storage_ == nullptr || encoded_name_ != name_) {
+    stat_name_storage_.reset();
+    encoded_name_ = name_;
+    stat_name_storage_ = std::make_unique<StatNameTempStorage>(encoded_name_, symbol_table_);
+  }
+  return stat_name_storage_->statName();
+}
+
 MockCounter::MockCounter() {
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
   ON_CALL(*this, used()).WillByDefault(ReturnPointee(&used_));
   ON_CALL(*this, value()).WillByDefault(ReturnPointee(&value_));
   ON_CALL(*this, latch()).WillByDefault(ReturnPointee(&latch_));
@@ -23,8 +36,6 @@ MockCounter::MockCounter() {
 MockCounter::~MockCounter() {}
 
 MockGauge::MockGauge() {
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
   ON_CALL(*this, used()).WillByDefault(ReturnPointee(&used_));
   ON_CALL(*this, value()).WillByDefault(ReturnPointee(&value_));
 }
@@ -36,8 +47,6 @@ MockHistogram::MockHistogram() {
       store_->deliverHistogramToSinks(*this, value);
     }
   }));
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
 }
 
 MockHistogram::~MockHistogram() {}
@@ -48,8 +57,6 @@ MockParentHistogram::MockParentHistogram() {
       store_->deliverHistogramToSinks(*this, value);
     }
   }));
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
   ON_CALL(*this, intervalStatistics()).WillByDefault(ReturnRef(*histogram_stats_));
   ON_CALL(*this, cumulativeStatistics()).WillByDefault(ReturnRef(*histogram_stats_));
   ON_CALL(*this, used()).WillByDefault(ReturnPointee(&used_));
@@ -16,27 +16,47 @@
 
 #include "common/stats/histogram_impl.h"
 #include "common/stats/isolated_store_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 #include "gmock/gmock.h"
 
 namespace Envoy {
 namespace Stats {
 
-class MockCounter : public Counter {
+/**
+ * Common base for the metric mocks. The name is held as a string so that tests can assign it
+ * after construction; statName() encodes it on demand into a symbol table owned by the mock.
+ */
+class MockMetric : public virtual Metric {
 public:
-  MockCounter();
-  ~MockCounter();
+  MockMetric();
+  ~MockMetric();
 
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
   std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
+  StatName statName() const override;
+
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
+
+  std::string name_;
+  std::vector<Tag> tags_;
+
+private:
+  mutable SymbolTableImpl symbol_table_;
+  mutable std::string encoded_name_;
+  mutable std::unique_ptr<StatNameTempStorage> stat_name_storage_;
+};
+
+class MockCounter : public Counter, public MockMetric {
+public:
+  MockCounter();
+  ~MockCounter();
 
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(inc, void());
   MOCK_METHOD0(latch, uint64_t());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
   MOCK_METHOD0(reset, void());
   MOCK_CONST_METHOD0(used, bool());
   MOCK_CONST_METHOD0(value, uint64_t());
@@ -44,25 +64,16 @@ public:
   bool used_;
   uint64_t value_;
   uint64_t latch_;
-  std::string name_;
-  std::vector<Tag> tags_;
 };
 
-class MockGauge : public Gauge {
+class MockGauge : public Gauge, public MockMetric {
 public:
   MockGauge();
   ~MockGauge();
 
-  // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
-  // creates a deadlock in gmock and is an unintended use of mock functions.
-  std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
-
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(dec, void());
   MOCK_METHOD0(inc, void());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
   MOCK_METHOD1(set, void(uint64_t value));
   MOCK_METHOD1(sub, void(uint64_t amount));
   MOCK_CONST_METHOD0(used, bool());
@@ -70,52 +81,33 @@ public:
 
   bool used_;
   uint64_t value_;
-  std::string name_;
-  std::vector<Tag> tags_;
 };
 
-class MockHistogram : public Histogram {
+class MockHistogram : public Histogram, public MockMetric {
 public:
   MockHistogram();
   ~MockHistogram();
 
-  // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
-  // creates a deadlock in gmock and is an unintended use of mock functions.
-  std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
-
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
   MOCK_METHOD1(recordValue, void(uint64_t value));
   MOCK_CONST_METHOD0(used, bool());
 
-  std::string name_;
-  std::vector<Tag> tags_;
   Store* store_;
 };
 
-class MockParentHistogram : public ParentHistogram {
+class MockParentHistogram : public ParentHistogram, public MockMetric {
 public:
   MockParentHistogram();
   ~MockParentHistogram();
 
-  // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
-  // creates a deadlock in gmock and is an unintended use of mock functions.
-  std::string name() const override { return name_; };
-  const char* nameCStr() const override { return name_.c_str(); };
   void merge() override {}
   const std::string quantileSummary() const override { return ""; };
   const std::string bucketSummary() const override { return ""; };
 
   MOCK_CONST_METHOD0(used, bool());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
   MOCK_METHOD1(recordValue, void(uint64_t value));
   MOCK_CONST_METHOD0(cumulativeStatistics, const HistogramStatistics&());
   MOCK_CONST_METHOD0(intervalStatistics, const HistogramStatistics&());
 
-  std::string name_;
-  std::vector<Tag> tags_;
   bool used_;
   Store* store_;
   std::shared_ptr<HistogramStatistics> histogram_stats_ =
@@ -161,6 +153,10 @@ public:
   MOCK_CONST_METHOD0(gauges, std::vector<GaugeSharedPtr>());
   MOCK_METHOD1(histogram, Histogram&(const std::string& name));
   MOCK_CONST_METHOD0(histograms, std::vector<ParentHistogramSharedPtr>());
+  MOCK_CONST_METHOD1(countersWithPrefix, std::vector<CounterSharedPtr>(absl::string_view));
+  MOCK_CONST_METHOD1(gaugesWithPrefix, std::vector<GaugeSharedPtr>(absl::string_view));
+  MOCK_CONST_METHOD1(histogramsWithPrefix,
+                     std::vector<ParentHistogramSharedPtr>(absl::string_view));
   MOCK_CONST_METHOD0(statsOptions, const StatsOptions&());
 
   testing::NiceMock<MockCounter> counter_;
@@ -67,10 +67,14 @@ public:
                      const absl::optional<envoy::api::v2::Cluster::RingHashLbConfig>&());
   MOCK_CONST_METHOD0(lbLeastRequestConfig,
                      const absl::optional<envoy::api::v2::Cluster::LeastRequestLbConfig>&());
+  MOCK_CONST_METHOD0(lbPeakEwmaConfig,
+                     const absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig>&());
   MOCK_CONST_METHOD0(lbOriginalDstConfig,
                      const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>&());
   MOCK_CONST_METHOD0(maintenanceMode, bool());
   MOCK_CONST_METHOD0(maxRequestsPerConnection, uint64_t());
+  MOCK_CONST_METHOD0(perUpstreamPrefetchRatio, double());
+  MOCK_CONST_METHOD0(minWarmConnections, uint32_t());
   MOCK_CONST_METHOD0(name, const std::string&());
   MOCK_CONST_METHOD1(resourceManager, ResourceManager&(ResourcePriority priority));
   MOCK_CONST_METHOD0(transportSocketFactory, Network::TransportSocketFactory&());
@@ -90,6 +94,8 @@ public:
   Http::Http2Settings http2_settings_{};
   ProtocolOptionsConfigConstSharedPtr extension_protocol_options_;
   uint64_t max_requests_per_connection_{};
+  double per_upstream_prefetch_ratio_{1.0};
+  uint32_t min_warm_connections_{};
   NiceMock<Stats::MockIsolatedStatsStore> stats_store_;
   ClusterStats stats_;
   Network::TransportSocketFactoryPtr transport_socket_factory_;
@@ -103,6 +109,7 @@ public:
   envoy::api::v2::Cluster::DiscoveryType type_{envoy::api::v2::Cluster::STRICT_DNS};
   NiceMock<MockLoadBalancerSubsetInfo> lb_subset_;
   absl::optional<envoy::api::v2::Cluster::RingHashLbConfig> lb_ring_hash_config_;
+  absl::optional<envoy::api::v2::Cluster::PeakEwmaLbConfig> lb_peak_ewma_config_;
   absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig> lb_original_dst_config_;
   Network::ConnectionSocket::OptionsSharedPtr cluster_socket_options_;
   envoy::api::v2::Cluster::CommonLbConfig lb_config_;
@@ -29,6 +29,7 @@ public:
   MOCK_METHOD0(lastUnejectionTime, const absl::optional<MonotonicTime>&());
   MOCK_CONST_METHOD0(successRate, double());
   MOCK_METHOD1(successRate, void(double new_success_rate));
+  MOCK_CONST_METHOD0(latencyP99, double());
 };
 
 class MockEventLogger : public EventLogger {
@@ -56,6 +57,8 @@ public:
   MOCK_METHOD1(addChangedStateCb, void(ChangeStateCb cb));
   MOCK_CONST_METHOD0(successRateAverage, double());
   MOCK_CONST_METHOD0(successRateEjectionThreshold, double());
+  MOCK_CONST_METHOD0(latencyP99Median, double());
+  MOCK_CONST_METHOD0(latencyEjectionThreshold, double());
 
   std::list<ChangeStateCb> callbacks_;
 };
@@ -90,6 +93,9 @@ public:
   MOCK_CONST_METHOD0(locality, const envoy::api::v2::core::Locality&());
   MOCK_CONST_METHOD0(priority, uint32_t());
   MOCK_METHOD1(priority, void(uint32_t));
+  MOCK_CONST_METHOD2(putResponseTime,
+                     void(std::chrono::microseconds response_time, MonotonicTime now));
+  MOCK_CONST_METHOD1(responseTimeEwma, absl::optional<double>(MonotonicTime now));
 
   std::string hostname_;
   Network::Address::InstanceConstSharedPtr address_;
@@ -160,6 +166,9 @@ public:
   MOCK_METHOD1(weight, void(uint32_t new_weight));
   MOCK_CONST_METHOD0(used, bool());
   MOCK_METHOD1(used, void(bool new_used));
+  MOCK_CONST_METHOD2(putResponseTime,
+                     void(std::chrono::microseconds response_time, MonotonicTime now));
+  MOCK_CONST_METHOD1(responseTimeEwma, absl::optional<double>(MonotonicTime now));
   MOCK_CONST_METHOD0(locality, const envoy::api::v2::core::Locality&());
   MOCK_CONST_METHOD0(priority, uint32_t());
   MOCK_METHOD1(priority, void(uint32_t));
@@ -19,6 +19,7 @@ using testing::ByRef;
 using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
+using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 
@@ -29,7 +30,7 @@ namespace {
 class ConnectionHandlerTest : public testing::Test, protected Logger::Loggable<Logger::Id::main> {
 public:
   ConnectionHandlerTest()
-      : handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_)),
+      : handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, 0)),
         filter_chain_(Network::Test::createEmptyFilterChainWithRawBufferSockets()) {}
 
   class TestListener : public Network::ListenerConfig, public LinkedObject<TestListener> {
@@ -46,6 +47,16 @@ public:
     Network::FilterChainFactory& filterChainFactory() override { return parent_.factory_; }
     Network::Socket& socket() override { return socket_; }
     const Network::Socket& socket() const override { return socket_; }
+    std::vector<std::reference_wrapper<Network::Socket>> listenSockets() override {
+      return {socket_};
+    }
+    std::vector<std::reference_wrapper<Network::Socket>>
+    workerSockets(uint32_t worker_index) override {
+      worker_socket_index_ = worker_index;
+      std::vector<std::reference_wrapper<Network::Socket>> sockets{socket_};
+      sockets.insert(sockets.end(), extra_worker_sockets_.begin(), extra_worker_sockets_.end());
+      return sockets;
+    }
     bool bindToPort() override { return bind_to_port_; }
     bool handOffRestoredDestinationConnections() const override {
       return hand_off_restored_destination_connections_;
@@ -60,6 +71,8 @@ public:
 
     ConnectionHandlerTest& parent_;
     Network::MockListenSocket socket_;
+    absl::optional<uint32_t> worker_socket_index_;
+    std::vector<std::reference_wrapper<Network::Socket>> extra_worker_sockets_;
     uint64_t tag_;
     bool bind_to_port_;
     const bool hand_off_restored_destination_connections_;
@@ -192,6 +205,59 @@ TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
   handler_.reset();
 }
 
+TEST_F(ConnectionHandlerTest, PerHandlerStats) {
+  InSequence s;
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+  ASSERT_TRUE(test_listener->worker_socket_index_.has_value());
+  EXPECT_EQ(0U, test_listener->worker_socket_index_.value());
+
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection});
+  EXPECT_EQ(1UL, stats_store_.counter("worker_0.downstream_cx_total").value());
+  EXPECT_EQ(1UL, stats_store_.gauge("worker_0.downstream_cx_active").value());
+
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.to_delete_.clear();
+  EXPECT_EQ(1UL, stats_store_.counter("worker_0.downstream_cx_total").value());
+  EXPECT_EQ(0UL, stats_store_.gauge("worker_0.downstream_cx_active").value());
+
+  EXPECT_CALL(*listener, onDestroy());
+}
+
+// A worker given more than one socket for a listener, e.g. sockets adopted from a hot restart
+// parent with more workers, accepts on all of them.
+TEST_F(ConnectionHandlerTest, AcceptOnEveryWorkerSocket) {
+  InSequence s;
+
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  NiceMock<Network::MockListenSocket> extra_socket;
+  test_listener->extra_worker_sockets_.push_back(extra_socket);
+
+  Network::MockListener* listener1 = new NiceMock<Network::MockListener>();
+  Network::MockListener* listener2 = new NiceMock<Network::MockListener>();
+  EXPECT_CALL(dispatcher_, createListener_(Ref(test_listener->socket_), _, _, _))
+      .WillOnce(Return(listener1));
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  EXPECT_CALL(dispatcher_, createListener_(Ref(extra_socket), _, _, _)).WillOnce(Return(listener2));
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  EXPECT_CALL(*listener1, onDestroy());
+  EXPECT_CALL(*listener2, onDestroy());
+  handler_->removeListeners(1);
+}
+
 TEST_F(ConnectionHandlerTest, CloseDuringFilterChainCreate) {
   InSequence s;
 
@@ -1195,6 +1195,18 @@ TEST_P(AdminInstanceTest, GetRequestJson) {
               HasSubstr("application/json"));
 }
 
+TEST_P(AdminInstanceTest, StatsWithPrefix) {
+  server_.stats_store_.counter("cluster.foo.upstream_cx_total").inc();
+  server_.stats_store_.counter("cluster.bar.upstream_cx_total").inc();
+  server_.stats_store_.gauge("cluster.foo.membership_total").set(3);
+
+  Http::HeaderMapImpl header_map;
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(Http::Code::OK, getCallback("/stats?prefix=cluster.foo.", header_map, response));
+  EXPECT_EQ("cluster.foo.membership_total: 3\ncluster.foo.upstream_cx_total: 1\n",
+            response.toString());
+}
+
 TEST_P(AdminInstanceTest, PostRequest) {
   Http::HeaderMapImpl response_headers;
   std::string body;
@@ -1205,6 +1217,130 @@ TEST_P(AdminInstanceTest, PostRequest) {
               HasSubstr("text/plain"));
 }
 
+class StatsStreamerTest : public testing::Test {
+protected:
+  StatsStreamerTest() {
+    ON_CALL(admin_stream_, getDecoderFilterCallbacks()).WillByDefault(ReturnRef(callbacks_));
+    ON_CALL(admin_stream_, addOnDestroyCallback(_))
+        .WillByDefault(Invoke([this](std::function<void()> cb) { on_destroy_ = cb; }));
+    ON_CALL(callbacks_.dispatcher_, post(_))
+        .WillByDefault(Invoke([this](Event::PostCb cb) { posted_.push_back(cb); }));
+    ON_CALL(callbacks_, encodeData(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool end_stream) {
+          EXPECT_FALSE(end_stream_);
+          chunks_.push_back(data.toString());
+          data.drain(data.length());
+          end_stream_ = end_stream;
+        }));
+  }
+
+  void start(StatsStreamer::Format format, absl::string_view prefix, uint64_t chunk_size) {
+    EXPECT_CALL(admin_stream_, setEndStreamOnComplete(false));
+    EXPECT_CALL(callbacks_, addDownstreamWatermarkCallbacks(_));
+    streamer_ =
+        std::make_shared<StatsStreamer>(store_, format, prefix, false, absl::nullopt, chunk_size);
+    streamer_->start(admin_stream_);
+  }
+
+  // Runs one posted callback, as the dispatcher would on its next iteration.
+  bool runPosted() {
+    if (posted_.empty()) {
+      return false;
+    }
+    Event::PostCb cb = posted_.front();
+    posted_.pop_front();
+    cb();
+    return true;
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  NiceMock<MockAdminStream> admin_stream_;
+  NiceMock<Http::MockStreamDecoderFilterCallbacks> callbacks_;
+  std::shared_ptr<StatsStreamer> streamer_;
+  std::function<void()> on_destroy_;
+  std::list<Event::PostCb> posted_;
+  std::vector<std::string> chunks_;
+  bool end_stream_{};
+};
+
+TEST_F(StatsStreamerTest, TextInChunks) {
+  for (int i = 0; i < 10; ++i) {
+    store_.counter(fmt::format("cluster.c{}.upstream_cx_total", i)).add(i);
+  }
+  store_.gauge("server.live").set(1);
+
+  // Nothing is written until the dispatcher runs the first chunk.
+  start(StatsStreamer::Format::Text, "cluster.", 1);
+  EXPECT_TRUE(chunks_.empty());
+
+  while (runPosted()) {
+  }
+  EXPECT_TRUE(end_stream_);
+  // One stat per chunk, in store order, with server.live skipped by the prefix.
+  ASSERT_EQ(10UL, chunks_.size());
+  std::sort(chunks_.begin(), chunks_.end());
+  EXPECT_EQ("cluster.c0.upstream_cx_total: 0\n", chunks_[0]);
+  EXPECT_EQ("cluster.c9.upstream_cx_total: 9\n", chunks_[9]);
+}
+
+TEST_F(StatsStreamerTest, Prometheus) {
+  store_.counter("cluster.upstream_cx_total").inc();
+  store_.gauge("cluster.membership_total").set(2);
+
+  start(StatsStreamer::Format::Prometheus, "", StatsStreamer::DefaultChunkSize);
+  EXPECT_TRUE(runPosted());
+  EXPECT_FALSE(runPosted());
+  EXPECT_TRUE(end_stream_);
+  EXPECT_EQ(std::vector<std::string>({R"EOF(# TYPE envoy_cluster_upstream_cx_total counter
+envoy_cluster_upstream_cx_total{} 1
+# TYPE envoy_cluster_membership_total gauge
+envoy_cluster_membership_total{} 2
+)EOF"}),
+            chunks_);
+}
+
+TEST_F(StatsStreamerTest, StreamDestroyed) {
+  store_.counter("c1");
+  store_.counter("c2");
+
+  start(StatsStreamer::Format::Text, "", 1);
+  EXPECT_TRUE(runPosted());
+  EXPECT_EQ(1UL, chunks_.size());
+
+  EXPECT_CALL(callbacks_, removeDownstreamWatermarkCallbacks(_));
+  on_destroy_();
+  EXPECT_CALL(callbacks_, encodeData(_, _)).Times(0);
+  EXPECT_TRUE(runPosted());
+  EXPECT_FALSE(runPosted());
+  EXPECT_FALSE(end_stream_);
+}
+
+TEST_F(StatsStreamerTest, PausedAboveHighWatermark) {
+  store_.counter("c1");
+  store_.counter("c2");
+  store_.counter("c3");
+
+  start(StatsStreamer::Format::Text, "", 1);
+  EXPECT_TRUE(runPosted());
+  EXPECT_EQ(1UL, chunks_.size());
+
+  // The chunk already scheduled is still written, but no further chunk is scheduled until the
+  // downstream drains below its low watermark.
+  streamer_->onAboveWriteBufferHighWatermark();
+  streamer_->onAboveWriteBufferHighWatermark();
+  EXPECT_TRUE(runPosted());
+  EXPECT_EQ(2UL, chunks_.size());
+  EXPECT_FALSE(runPosted());
+
+  streamer_->onBelowWriteBufferLowWatermark();
+  EXPECT_FALSE(runPosted());
+  streamer_->onBelowWriteBufferLowWatermark();
+  EXPECT_TRUE(runPosted());
+  EXPECT_FALSE(runPosted());
+  EXPECT_EQ(3UL, chunks_.size());
+  EXPECT_TRUE(end_stream_);
+}
+
 class HistogramWrapper {
 public:
   HistogramWrapper() : histogram_(hist_alloc()) {}
@@ -1225,14 +1361,16 @@ private:
 
 class PrometheusStatsFormatterTest : public testing::Test {
 protected:
+  PrometheusStatsFormatterTest() : alloc_(symbol_table_) {}
+
   void addCounter(const std::string& name, std::vector<Stats::Tag> cluster_tags) {
-    std::string tname = std::string(name);
-    counters_.push_back(alloc_.makeCounter(name, std::move(tname), std::move(cluster_tags)));
+    Stats::StatNameTempStorage stat_name(name, symbol_table_);
+    counters_.push_back(alloc_.makeCounter(stat_name.statName(), name, cluster_tags));
   }
 
   void addGauge(const std::string& name, std::vector<Stats::Tag> cluster_tags) {
-    std::string tname = std::string(name);
-    gauges_.push_back(alloc_.makeGauge(name, std::move(tname), std::move(cluster_tags)));
+    Stats::StatNameTempStorage stat_name(name, symbol_table_);
+    gauges_.push_back(alloc_.makeGauge(stat_name.statName(), name, cluster_tags));
   }
 
   void addHistogram(const Stats::ParentHistogramSharedPtr histogram) {
@@ -1240,6 +1378,7 @@ protected:
   }
 
   Stats::StatsOptionsImpl stats_options_;
+  Stats::SymbolTableImpl symbol_table_;
   Stats::HeapStatDataAllocator alloc_;
   std::vector<Stats::CounterSharedPtr> counters_;
   std::vector<Stats::GaugeSharedPtr> gauges_;
@@ -65,9 +65,10 @@ TEST_F(OptionsImplTest, All) {
       "envoy --mode validate --concurrency 2 -c hello --admin-address-path path --restart-epoch 1 "
       "--local-address-ip-version v6 -l info --component-log-level upstream:debug,connection:trace "
       "--service-cluster cluster --service-node node --service-zone zone "
-      "--file-flush-interval-msec 9000 "
+      "--file-flush-interval-msec 9000 --file-flush-size-kb 128 --file-buffer-limit-kb 1024 "
       "--drain-time-s 60 --log-format [%v] --parent-shutdown-time-s 90 --log-path /foo/bar "
-      "--disable-hot-restart");
+      "--disable-hot-restart --use-libevent-buffers false --regex-engine re2 "
+      "--regex-max-program-size 200");
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ(2U, options->concurrency());
   EXPECT_EQ("hello", options->configPath());
@@ -82,9 +83,14 @@ TEST_F(OptionsImplTest, All) {
   EXPECT_EQ("node", options->serviceNodeName());
   EXPECT_EQ("zone", options->serviceZone());
   EXPECT_EQ(std::chrono::milliseconds(9000), options->fileFlushIntervalMsec());
+  EXPECT_EQ(128U, options->fileFlushSizeKb());
+  EXPECT_EQ(1024U, options->fileBufferLimitKb());
   EXPECT_EQ(std::chrono::seconds(60), options->drainTime());
   EXPECT_EQ(std::chrono::seconds(90), options->parentShutdownTime());
   EXPECT_EQ(true, options->hotRestartDisabled());
+  EXPECT_EQ(false, options->libeventBufferEnabled());
+  EXPECT_EQ(Regex::Engine::Re2, options->regexEngine());
+  EXPECT_EQ(200U, options->regexMaxProgramSize());
 
   options = createOptionsImpl("envoy --mode init_only");
   EXPECT_EQ(Server::Mode::InitOnly, options->mode());
@@ -94,6 +100,7 @@ TEST_F(OptionsImplTest, SetAll) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello");
   bool hot_restart_disabled = options->hotRestartDisabled();
   bool signal_handling_enabled = options->signalHandlingEnabled();
+  bool libevent_buffer_enabled = options->libeventBufferEnabled();
   Stats::StatsOptionsImpl stats_options;
   stats_options.max_obj_name_length_ = 54321;
   stats_options.max_stat_suffix_length_ = 1234;
@@ -111,6 +118,8 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setParentShutdownTime(std::chrono::seconds(43));
   options->setRestartEpoch(44);
   options->setFileFlushIntervalMsec(std::chrono::milliseconds(45));
+  options->setFileFlushSizeKb(46);
+  options->setFileBufferLimitKb(47);
   options->setMode(Server::Mode::Validate);
   options->setServiceClusterName("cluster_foo");
   options->setServiceNodeName("node_foo");
@@ -119,6 +128,9 @@ TEST_F(OptionsImplTest, SetAll) {
   options->setStatsOptions(stats_options);
   options->setHotRestartDisabled(!options->hotRestartDisabled());
   options->setSignalHandling(!options->signalHandlingEnabled());
+  options->setLibeventBufferEnabled(!options->libeventBufferEnabled());
+  options->setRegexEngine(Regex::Engine::Re2);
+  options->setRegexMaxProgramSize(1000);
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
@@ -133,6 +145,8 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(std::chrono::seconds(43), options->parentShutdownTime());
   EXPECT_EQ(44, options->restartEpoch());
   EXPECT_EQ(std::chrono::milliseconds(45), options->fileFlushIntervalMsec());
+  EXPECT_EQ(46U, options->fileFlushSizeKb());
+  EXPECT_EQ(47U, options->fileBufferLimitKb());
   EXPECT_EQ(Server::Mode::Validate, options->mode());
   EXPECT_EQ("cluster_foo", options->serviceClusterName());
   EXPECT_EQ("node_foo", options->serviceNodeName());
@@ -142,6 +156,9 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(stats_options.max_stat_suffix_length_, options->statsOptions().maxStatSuffixLength());
   EXPECT_EQ(!hot_restart_disabled, options->hotRestartDisabled());
   EXPECT_EQ(!signal_handling_enabled, options->signalHandlingEnabled());
+  EXPECT_EQ(!libevent_buffer_enabled, options->libeventBufferEnabled());
+  EXPECT_EQ(Regex::Engine::Re2, options->regexEngine());
+  EXPECT_EQ(1000U, options->regexMaxProgramSize());
 
   // Validate that CommandLineOptions is constructed correctly.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -164,6 +181,8 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->restartEpoch(), command_line_options->restart_epoch());
   EXPECT_EQ(options->fileFlushIntervalMsec().count() / 1000,
             command_line_options->file_flush_interval().seconds());
+  EXPECT_EQ(options->fileFlushSizeKb(), command_line_options->file_flush_size_kb());
+  EXPECT_EQ(options->fileBufferLimitKb(), command_line_options->file_buffer_limit_kb());
   EXPECT_EQ(envoy::admin::v2alpha::CommandLineOptions::Validate, command_line_options->mode());
   EXPECT_EQ(options->serviceClusterName(), command_line_options->service_cluster());
   EXPECT_EQ(options->serviceNodeName(), command_line_options->service_node());
@@ -172,6 +191,9 @@ TEST_F(OptionsImplTest, SetAll) {
   EXPECT_EQ(options->statsOptions().maxObjNameLength(), command_line_options->max_obj_name_len());
   EXPECT_EQ(options->hotRestartDisabled(), command_line_options->disable_hot_restart());
   EXPECT_EQ(options->mutexTracingEnabled(), command_line_options->enable_mutex_tracing());
+  EXPECT_EQ(options->libeventBufferEnabled(), command_line_options->use_libevent_buffers());
+  EXPECT_EQ(envoy::admin::v2alpha::CommandLineOptions::Re2, command_line_options->regex_engine());
+  EXPECT_EQ(options->regexMaxProgramSize(), command_line_options->regex_max_program_size());
 }
 
 TEST_F(OptionsImplTest, DefaultParams) {
@@ -182,6 +204,11 @@ TEST_F(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
   EXPECT_EQ(false, options->hotRestartDisabled());
+  EXPECT_EQ(true, options->libeventBufferEnabled());
+  EXPECT_EQ(Regex::Engine::StdRegex, options->regexEngine());
+  EXPECT_EQ(100U, options->regexMaxProgramSize());
+  EXPECT_EQ(64U, options->fileFlushSizeKb());
+  EXPECT_EQ(0U, options->fileBufferLimitKb());
 
   // Validate that CommandLineOptions is constructed correctly with default params.
   Server::CommandLineOptionsPtr command_line_options = options->toCommandLineOptions();
@@ -193,6 +220,8 @@ TEST_F(OptionsImplTest, DefaultParams) {
             command_line_options->local_address_ip_version());
   EXPECT_EQ(envoy::admin::v2alpha::CommandLineOptions::Serve, command_line_options->mode());
   EXPECT_EQ(false, command_line_options->disable_hot_restart());
+  EXPECT_EQ(envoy::admin::v2alpha::CommandLineOptions::StdRegex,
+            command_line_options->regex_engine());
 }
 
 // Validates that the server_info proto is in sync with the options.
@@ -213,6 +242,11 @@ TEST_F(OptionsImplTest, BadCliOption) {
                           MalformedArgvException, "error: unknown IP address version 'foo'");
 }
 
+TEST_F(OptionsImplTest, BadRegexEngineOption) {
+  EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy -c hello --regex-engine pcre"),
+                          MalformedArgvException, "error: unknown regex engine 'pcre'");
+}
+
 TEST_F(OptionsImplTest, BadObjNameLenOption) {
   EXPECT_THROW_WITH_REGEX(createOptionsImpl("envoy --max-obj-name-len 1"), MalformedArgvException,
                           "'max-obj-name-len' value specified");
@@ -296,6 +330,8 @@ TEST_F(OptionsImplTest, SaneTestConstructor) {
   EXPECT_EQ(regular_options_impl->mode(), test_options_impl.mode());
   EXPECT_EQ(regular_options_impl->fileFlushIntervalMsec(),
             test_options_impl.fileFlushIntervalMsec());
+  EXPECT_EQ(regular_options_impl->fileFlushSizeKb(), test_options_impl.fileFlushSizeKb());
+  EXPECT_EQ(regular_options_impl->fileBufferLimitKb(), test_options_impl.fileBufferLimitKb());
   EXPECT_EQ(regular_options_impl->maxStats(), test_options_impl.maxStats());
   EXPECT_EQ(regular_options_impl->statsOptions().maxNameLength(),
             test_options_impl.statsOptions().maxNameLength());
@@ -475,13 +475,14 @@ public:
   };
 
   explicit TestAllocator(const StatsOptions& stats_options)
-      : RawStatDataAllocator(mutex_, hash_set_, stats_options),
+      : RawStatDataAllocator(mutex_, hash_set_, stats_options, symbol_table_),
         block_memory_(std::make_unique<uint8_t[]>(
             RawStatDataSet::numBytes(block_hash_options_, stats_options))),
         hash_set_(block_hash_options_, true /* init */, block_memory_.get(), stats_options) {}
   ~TestAllocator() { EXPECT_EQ(0, hash_set_.size()); }
 
 private:
+  SymbolTableImpl symbol_table_;
   Thread::MutexBasicLockable mutex_;
   TestBlockMemoryHashSetOptions block_hash_options_;
   std::unique_ptr<uint8_t[]> block_memory_;